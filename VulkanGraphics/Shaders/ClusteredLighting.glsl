@@ -0,0 +1,98 @@
+//Shared by the binning shader and the lit mesh shader, the buffers match the descriptor set layout created by
+//VulkanClusteredLightingHandle
+
+//The binning shader writes the cluster lists, the fragment shader defines this as readonly before including the file
+#ifndef CLUSTER_BUFFER_ACCESS
+#define CLUSTER_BUFFER_ACCESS
+#endif
+
+//Matches ClusterConstantsGpu in ClusteredLighting.h
+layout (std140, set = 0, binding = 0) uniform ClusterConstants
+{
+    mat4 view;
+    vec2 tanHalfFov;
+    float nearPlane;
+    float farPlane;
+    float sliceScale;
+    float sliceBias;
+    uint lightCount;
+    float lightRangeScale;
+    //The cluster grid, and the length of the light index list
+    uvec4 gridSize;
+} constants;
+
+//Matches LightGpu in ClusteredLighting.h
+struct Light
+{
+    //World space position, and the distance the light reaches before the range scale
+    vec4 positionRange;
+    //Linear color times intensity, and the cosine of the spot cone's outer angle, below -1 for point lights
+    vec4 colorOuterCos;
+    //World space direction the spot light points in, and the cosine of the cone's inner angle
+    vec4 directionInnerCos;
+};
+
+layout (std430, set = 0, binding = 1) readonly buffer LightBuffer
+{
+    Light lights[];
+};
+
+//The offset of every cluster's lights in the index list, and how many there are
+layout (std430, set = 0, binding = 2) CLUSTER_BUFFER_ACCESS buffer ClusterBuffer
+{
+    uvec2 clusters[];
+};
+
+layout (std430, set = 0, binding = 3) CLUSTER_BUFFER_ACCESS buffer LightIndexBuffer
+{
+    uint lightIndices[];
+};
+
+//The view space depth a slice of the grid starts at
+float SliceDepth(uint slice)
+{
+    return constants.nearPlane * pow(constants.farPlane / constants.nearPlane, float(slice) / float(constants.gridSize.z));
+}
+
+//The slice a view space depth is in, depths outside the near and far planes go to the first and last slice
+uint DepthSlice(float depth)
+{
+    float slice = log(max(depth, 1e-6)) * constants.sliceScale + constants.sliceBias;
+    return min(uint(max(slice, 0.0)), constants.gridSize.z - 1u);
+}
+
+float LightRange(Light light)
+{
+    return light.positionRange.w * constants.lightRangeScale;
+}
+
+//Diffuse light from a point or spot light, fading smoothly to nothing at its range, so a light left out of a cluster
+//it does not reach changes nothing
+vec3 ShadeLight(Light light, vec3 position, vec3 normal)
+{
+    vec3 toLight = light.positionRange.xyz - position;
+    float distanceSquared = dot(toLight, toLight);
+    vec3 direction = toLight * inversesqrt(max(distanceSquared, 1e-8));
+
+    float range = LightRange(light);
+    float falloff = clamp(1.0 - distanceSquared / (range * range), 0.0, 1.0);
+    float spot = smoothstep(light.colorOuterCos.w, light.directionInnerCos.w, dot(-direction, light.directionInnerCos.xyz));
+    return light.colorOuterCos.rgb * (max(dot(normal, direction), 0.0) * falloff * falloff * spot);
+}
+
+//Sums the light of every light listed for the cluster of a world space position. The tile is found from the
+//position's normalized device coordinates instead of gl_FragCoord, so the grid does not depend on the target's size
+vec3 ShadeClusteredLights(vec2 ndc, vec3 position, vec3 normal)
+{
+    uvec3 grid = constants.gridSize.xyz;
+    uvec2 tile = min(uvec2(max((ndc * 0.5 + 0.5) * vec2(grid.xy), vec2(0.0))), grid.xy - 1u);
+    float depth = -(constants.view * vec4(position, 1.0)).z;
+    uvec2 cluster = clusters[tile.x + grid.x * (tile.y + grid.y * DepthSlice(depth))];
+
+    vec3 color = vec3(0.0);
+    for (uint i = 0u; i < cluster.y; ++i)
+    {
+        color += ShadeLight(lights[lightIndices[cluster.x + i]], position, normal);
+    }
+    return color;
+}
@@ -0,0 +1,74 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+//Lights every pixel once from the G-buffer the mesh wrote in the previous subpass. Compiled a second time with
+//CLUSTERED_LIGHTING defined, which adds the lights of the pixel's cluster like MeshClustered.frag does and moves the
+//G-buffer's set after the lights' set. Both are also compiled with CASCADED_SHADOWS defined, which shadows the fixed
+//light like MeshShadowed.frag does from the set after the G-buffer's
+#ifdef CLUSTERED_LIGHTING
+#define CLUSTER_BUFFER_ACCESS readonly
+#include "ClusteredLighting.glsl"
+#define GBUFFER_SET 1
+#else
+#define GBUFFER_SET 0
+#endif
+
+#ifdef CASCADED_SHADOWS
+#define SHADOW_SET (GBUFFER_SET + 1)
+#include "ShadowCascades.glsl"
+#endif
+
+//Match the order of the G-buffer in VulkanGBuffer.h, every input attachment index is also its binding. Each pixel
+//only reads its own texel, which is all an input attachment can read
+layout (input_attachment_index = 0, set = GBUFFER_SET, binding = 0) uniform subpassInput gbufferDepth;
+layout (input_attachment_index = 1, set = GBUFFER_SET, binding = 1) uniform subpassInput gbufferAlbedo;
+layout (input_attachment_index = 2, set = GBUFFER_SET, binding = 2) uniform subpassInput gbufferNormal;
+
+#if defined(CLUSTERED_LIGHTING) || defined(CASCADED_SHADOWS)
+//The inverse of the mesh's view projection matrix, only needed to find the pixel's position for the lights and shadows
+layout (push_constant) uniform DeferredLightingConstants
+{
+    mat4 inverseViewProjection;
+} pushConstants;
+#endif
+
+layout (location = 0) in vec2 fragNdc;
+
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+    //Nothing was drawn where the depth is still the cleared far plane, which keeps the clear colour
+    float depth = subpassLoad(gbufferDepth).r;
+    if (depth >= 1.0)
+    {
+        outColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    vec3 albedo = subpassLoad(gbufferAlbedo).rgb;
+    vec3 normal = normalize(subpassLoad(gbufferNormal).xyz * 2.0 - 1.0);
+
+#if defined(CLUSTERED_LIGHTING) || defined(CASCADED_SHADOWS)
+    //The world position is rebuilt from the depth instead of being stored, which keeps the G-buffer small
+    vec4 position = pushConstants.inverseViewProjection * vec4(fragNdc, depth, 1.0);
+    vec3 worldPosition = position.xyz / position.w;
+#endif
+
+    //The same fixed directional light as the forward mesh shader, the cascades are rendered from its direction
+#ifdef CASCADED_SHADOWS
+    vec3 lightDirection = shadowConstants.lightDirection.xyz;
+#else
+    vec3 lightDirection = normalize(vec3(0.4, 1.0, 0.3));
+#endif
+    float diffuse = max(dot(normal, lightDirection), 0.0);
+#ifdef CASCADED_SHADOWS
+    diffuse *= diffuse > 0.0 ? SampleCascadedShadow(worldPosition, normal) : 1.0;
+#endif
+    vec3 color = albedo * (0.2 + 0.8 * diffuse);
+
+#ifdef CLUSTERED_LIGHTING
+    color = color * 0.15 + albedo * ShadeClusteredLights(fragNdc, worldPosition, normal);
+#endif
+    outColor = vec4(color, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 450
+
+//A single triangle covering the screen, so the lighting subpass shades every pixel exactly once
+
+layout (location = 0) out vec2 fragNdc;
+
+void main()
+{
+    //The vertices are at (-1, -1), (3, -1) and (-1, 3), the part outside the screen is clipped
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    fragNdc = uv * 2.0 - 1.0;
+    gl_Position = vec4(fragNdc, 0.0, 1.0);
+}
@@ -0,0 +1,22 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+//Lights the mesh with the lights the binning pass listed for the fragment's cluster
+
+#define CLUSTER_BUFFER_ACCESS readonly
+#include "ClusteredLighting.glsl"
+
+layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec3 fragWorldPosition;
+layout (location = 2) in vec3 fragNormal;
+layout (location = 3) in vec4 fragClipPosition;
+
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+    //The fixed light of the unlit shader is kept dim, so the parts no light reaches still show their shape
+    vec2 ndc = fragClipPosition.xy / fragClipPosition.w;
+    vec3 color = fragColor * 0.15 + ShadeClusteredLights(ndc, fragWorldPosition, normalize(fragNormal));
+    outColor = vec4(color, 1.0);
+}
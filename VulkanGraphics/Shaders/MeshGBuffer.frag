@@ -0,0 +1,17 @@
+#version 450
+
+//Writes the mesh's surface into the G-buffer, the lighting subpass of the deferred render pass shades it
+
+layout (location = 2) in vec3 fragNormal;
+
+//Match GBUFFER_ALBEDO_FORMAT and GBUFFER_NORMAL_FORMAT in VulkanGBuffer.h
+layout (location = 0) out vec4 outAlbedo;
+layout (location = 1) out vec4 outNormal;
+
+void main()
+{
+    //The mesh has no materials, so its albedo is white like the forward shaders light it. The normal format is
+    //unsigned, so the normal is moved into the 0 to 1 range
+    outAlbedo = vec4(1.0);
+    outNormal = vec4(normalize(fragNormal) * 0.5 + 0.5, 1.0);
+}
@@ -0,0 +1,38 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+//Lights the mesh with the sun, shadowed by the cascades. Compiled a second time with CLUSTERED_LIGHTING defined,
+//which adds the lights of the fragment's cluster like MeshClustered.frag does and moves the cascades' set after the
+//lights' set
+
+#ifdef CLUSTERED_LIGHTING
+#define CLUSTER_BUFFER_ACCESS readonly
+#include "ClusteredLighting.glsl"
+#define SHADOW_SET 1
+#else
+#define SHADOW_SET 0
+#endif
+#include "ShadowCascades.glsl"
+
+layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec3 fragWorldPosition;
+layout (location = 2) in vec3 fragNormal;
+layout (location = 3) in vec4 fragClipPosition;
+
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+    //The same light as the vertex shader's fixed light, whose colour is rebuilt so only its direct part is shadowed.
+    //Surfaces facing away from the sun are dark already and skip the shadow map
+    vec3 normal = normalize(fragNormal);
+    float diffuse = max(dot(normal, shadowConstants.lightDirection.xyz), 0.0);
+    float shadow = diffuse > 0.0 ? SampleCascadedShadow(fragWorldPosition, normal) : 1.0;
+    vec3 color = vec3(0.2 + 0.8 * diffuse * shadow);
+
+#ifdef CLUSTERED_LIGHTING
+    vec2 ndc = fragClipPosition.xy / fragClipPosition.w;
+    color = color * 0.15 + ShadeClusteredLights(ndc, fragWorldPosition, normal);
+#endif
+    outColor = vec4(color, 1.0);
+}
@@ -0,0 +1,22 @@
+//Shared by the vertex shaders compiled with MULTIVIEW defined, the buffer matches the descriptor set layout created by
+//VulkanGraphicsPipelineHandle::CreateMultiviewRenderPass and is filled by VulkanMultiviewTargetsHandle
+#extension GL_EXT_multiview : require
+
+//Must match MULTIVIEW_MAX_VIEWS in VulkanGraphicsPipeline.h
+#define MULTIVIEW_MAX_VIEWS 4
+
+//The shader including the file defines the set the views are bound to, after the sets it already uses
+#ifndef MULTIVIEW_SET
+#define MULTIVIEW_SET 0
+#endif
+
+layout (set = MULTIVIEW_SET, binding = 0) uniform MultiviewViewData
+{
+    mat4 viewProjections[MULTIVIEW_MAX_VIEWS];
+} views;
+
+//The matrix of the view being rendered, every view runs the vertex shader with its own gl_ViewIndex
+mat4 ViewProjection()
+{
+    return views.viewProjections[gl_ViewIndex];
+}
@@ -0,0 +1,23 @@
+#version 450
+
+//The atlas of the draw, the glyph atlas holds a distance field in red and the sprite atlas the sprites' colors
+layout (set = 0, binding = 0) uniform sampler2D atlas;
+
+layout (location = 0) in vec2 fragUv;
+layout (location = 1) in vec4 fragColor;
+layout (location = 2) flat in uint fragDistanceField;
+
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+    vec4 texel = texture(atlas, fragUv);
+
+    //A glyph's edge is where its distance is 0.5, smoothed over about a pixel at whatever size it is drawn. The
+    //derivative is taken before the atlases are told apart, so it is defined for every pixel
+    float distance = texel.r;
+    float edgeWidth = max(fwidth(distance) * 0.5, 1.0 / 255.0);
+    float glyphCoverage = smoothstep(0.5 - edgeWidth, 0.5 + edgeWidth, distance);
+
+    outColor = fragColor * (fragDistanceField != 0u ? vec4(1.0, 1.0, 1.0, glyphCoverage) : texel);
+}
@@ -0,0 +1,33 @@
+#version 450
+
+//Matches OverlayQuadGpu in OverlayBatcher.h, every instance is one quad
+layout (location = 0) in vec4 quadRect;
+layout (location = 1) in vec4 quadUvRect;
+layout (location = 2) in vec4 quadColor;
+
+//Matches OverlayDrawConstants in OverlayBatcher.h
+layout (push_constant) uniform OverlayDrawConstants
+{
+    //Scales a pixel position into the 0 to 2 range across the framebuffer
+    vec2 pixelToClip;
+    uint distanceField;
+    uint padding;
+} draw;
+
+layout (location = 0) out vec2 fragUv;
+layout (location = 1) out vec4 fragColor;
+layout (location = 2) flat out uint fragDistanceField;
+
+//Two triangles per quad, the corners are picked from the instance's rectangles so no index buffer is needed
+const vec2 corners[6] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+    vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+
+void main()
+{
+    vec2 corner = corners[gl_VertexIndex];
+    //Clip space y points down in Vulkan, the same way as pixel rows
+    gl_Position = vec4(mix(quadRect.xy, quadRect.zw, corner) * draw.pixelToClip - 1.0, 0.0, 1.0);
+    fragUv = mix(quadUvRect.xy, quadUvRect.zw, corner);
+    fragColor = quadColor;
+    fragDistanceField = draw.distanceField;
+}
@@ -0,0 +1,13 @@
+#version 450
+
+layout (location = 0) in vec4 fragColor;
+layout (location = 1) in vec2 fragCorner;
+
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+    //Fades towards the edges of the quad, so particles look round
+    float falloff = max(1.0 - dot(fragCorner, fragCorner), 0.0);
+    outColor = vec4(fragColor.rgb, fragColor.a * falloff);
+}
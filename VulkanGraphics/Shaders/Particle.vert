@@ -0,0 +1,49 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+//Compiled a second time with MULTIVIEW defined, the views are bound after the particle buffers. Included first, as
+//the extension it enables has to come before any declaration
+#ifdef MULTIVIEW
+#define MULTIVIEW_SET 1
+#include "Multiview.glsl"
+#endif
+
+//The vertex stage only reads the particles, so it needs no vertex stores feature
+#define PARTICLE_BUFFER_ACCESS readonly
+#include "ParticleCommon.glsl"
+
+//Matches ParticleDrawConstants in VulkanParticleSystem.h, the multiview variant ignores the matrix
+layout (push_constant) uniform ParticleDrawConstants
+{
+    mat4 viewProjection;
+    //Half the size of a particle in clip space at a w of 1
+    vec2 particleSize;
+    uint aliveList;
+    uint maxParticles;
+} draw;
+
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out vec2 fragCorner;
+
+//Two triangles per particle, the vertices are generated so no vertex or index buffer is needed
+const vec2 corners[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+    vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main()
+{
+    uint particleIndex = aliveLists[draw.aliveList * draw.maxParticles + uint(gl_VertexIndex) / 6u];
+    Particle particle = particles[particleIndex];
+    vec2 corner = corners[uint(gl_VertexIndex) % 6u];
+
+    //The corner is offset in clip space scaled by w, so every particle covers the same amount of pixels
+#ifdef MULTIVIEW
+    gl_Position = ViewProjection() * vec4(particle.positionAge.xyz, 1.0);
+#else
+    gl_Position = draw.viewProjection * vec4(particle.positionAge.xyz, 1.0);
+#endif
+    gl_Position.xy += corner * draw.particleSize * gl_Position.w;
+
+    float life = clamp(particle.positionAge.w / particle.velocityLifetime.w, 0.0, 1.0);
+    fragColor = mix(vec4(1.0, 0.85, 0.4, 1.0), vec4(0.9, 0.25, 0.1, 0.0), life);
+    fragCorner = corner;
+}
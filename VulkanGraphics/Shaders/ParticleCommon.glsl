@@ -0,0 +1,52 @@
+//Shared by every particle shader, the buffers match the descriptor set layout created by VulkanParticleSystemHandle
+
+#include "ShaderVariants.glsl"
+
+//Shaders that only read the particles define this as readonly before including the file
+#ifndef PARTICLE_BUFFER_ACCESS
+#define PARTICLE_BUFFER_ACCESS
+#endif
+
+//Matches ParticleGpu in VulkanParticleSystem.h
+struct Particle
+{
+    //Position, and the seconds since the particle was emitted
+    vec4 positionAge;
+    //Velocity, and the seconds the particle lives for
+    vec4 velocityLifetime;
+};
+
+layout (std430, set = 0, binding = 0) PARTICLE_BUFFER_ACCESS buffer ParticleBuffer
+{
+    Particle particles[];
+};
+
+//The indices of the particles that are free to be emitted, the first deadCount of them are valid
+layout (std430, set = 0, binding = 1) PARTICLE_BUFFER_ACCESS buffer DeadListBuffer
+{
+    uint deadList[];
+};
+
+//Two lists of the indices of the live particles, each maxParticles long. The simulation reads one and compacts
+//the survivors into the other, and the lists swap every frame
+layout (std430, set = 0, binding = 2) PARTICLE_BUFFER_ACCESS buffer AliveListBuffer
+{
+    uint aliveLists[];
+};
+
+//Matches ParticleCounters in VulkanParticleSystem.h, the indirect arguments are read straight from this buffer
+layout (std430, set = 0, binding = 3) PARTICLE_BUFFER_ACCESS buffer CounterBuffer
+{
+    uint deadCount;
+    uint aliveCount[2];
+    uint emitCount;
+    //Where the emission pass takes its dead indices from and puts its alive indices, reserved by the begin pass
+    uint emitDeadBase;
+    uint emitAliveBase;
+    uint emitDispatch[3];
+    uint simulateDispatch[3];
+    uint drawVertexCount;
+    uint drawInstanceCount;
+    uint drawFirstVertex;
+    uint drawFirstInstance;
+} counters;
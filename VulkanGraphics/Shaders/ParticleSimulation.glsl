@@ -0,0 +1,31 @@
+//The push constants of the particle compute shaders, included after ParticleCommon.glsl
+
+//Matches ParticleSimulationConstants in VulkanParticleSystem.h
+layout (push_constant) uniform ParticleSimulationConstants
+{
+    vec3 emitterPosition;
+    float emitterRadius;
+    vec3 gravity;
+    float deltaTime;
+    float emitSpeed;
+    float lifetime;
+    uint emitRequest;
+    uint currentList;
+    uint randomSeed;
+    uint maxParticles;
+} simulation;
+
+//PCG hash, a different value for every input is all the emission needs
+uint Hash(uint value)
+{
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+//Returns a value in [0, 1) and advances the seed
+float Random(inout uint seed)
+{
+    seed = Hash(seed);
+    return float(seed) * (1.0 / 4294967296.0);
+}
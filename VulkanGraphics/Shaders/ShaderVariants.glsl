@@ -0,0 +1,6 @@
+//The IDs of the specialization constants, must match the SHADER_CONSTANT defines in ShaderVariant.h.
+//The pipeline sets their values when it is created, so branches on them are folded away by the driver
+#define SHADER_CONSTANT_MESH_OCTAHEDRAL_NORMALS 0
+#define SHADER_CONSTANT_PARTICLE_GROUP_SIZE 1
+#define SHADER_CONSTANT_CLUSTER_GROUP_SIZE 2
+#define SHADER_CONSTANT_CLUSTER_MAX_LIGHTS 3
@@ -0,0 +1,60 @@
+//Shared by the fragment shaders that shadow the sun, the set matches the descriptor set layout created by
+//VulkanShadowCascadesHandle
+
+//Must match SHADOW_CASCADE_COUNT in ShadowCascades.h
+#define SHADOW_CASCADE_COUNT 4
+
+//The receiver is moved this many texels of its cascade along its normal before it is compared, which keeps lit
+//surfaces facing away from the light from shadowing themselves
+#define SHADOW_NORMAL_OFFSET_TEXELS 1.5
+
+//The shader including the file defines the set the cascades are bound to, after the sets it already uses
+#ifndef SHADOW_SET
+#define SHADOW_SET 0
+#endif
+
+//Matches ShadowConstantsGpu in ShadowCascades.h
+layout (std140, set = SHADOW_SET, binding = 0) uniform ShadowConstants
+{
+    mat4 cascadeViewProjections[SHADOW_CASCADE_COUNT];
+    //World space direction towards the sun
+    vec4 lightDirection;
+    //World space size of a texel of every cascade
+    vec4 cascadeTexelSizes;
+} shadowConstants;
+
+//One layer per cascade, the finest first. The sampler compares, so every fetch returns how much of its footprint is lit
+layout (set = SHADOW_SET, binding = 1) uniform sampler2DArrayShadow shadowMap;
+
+//How much of the sun reaches the position, 0 in full shadow. The finest cascade covering the position is used,
+//positions outside every cascade are lit
+float SampleCascadedShadow(vec3 worldPosition, vec3 normal)
+{
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    for (int cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+    {
+        vec3 position = worldPosition + normal * shadowConstants.cascadeTexelSizes[cascade] * SHADOW_NORMAL_OFFSET_TEXELS;
+        //The cascades are orthographic, so w is always 1
+        vec3 clip = (shadowConstants.cascadeViewProjections[cascade] * vec4(position, 1.0)).xyz;
+        vec2 uv = clip.xy * 0.5 + 0.5;
+
+        //The filter reads a texel past the center tap on every side, which has to stay inside the cascade
+        vec2 margin = texelSize * 2.0;
+        if (any(lessThan(uv, margin)) || any(greaterThan(uv, 1.0 - margin)) || clip.z <= 0.0 || clip.z >= 1.0)
+        {
+            continue;
+        }
+
+        //Nine taps of the hardware's bilinear comparison, which softens the edges over about four texels
+        float lit = 0.0;
+        for (int y = -1; y <= 1; ++y)
+        {
+            for (int x = -1; x <= 1; ++x)
+            {
+                lit += texture(shadowMap, vec4(uv + vec2(x, y) * texelSize, float(cascade), clip.z));
+            }
+        }
+        return lit / 9.0;
+    }
+    return 1.0;
+}
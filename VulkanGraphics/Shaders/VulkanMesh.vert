@@ -0,0 +1,72 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "ShaderVariants.glsl"
+
+//Compiled a second time with MULTIVIEW defined, reading the matrix of every view from a uniform buffer
+#ifdef MULTIVIEW
+#include "Multiview.glsl"
+#endif
+
+//Floats for MESH_VERTEX_FORMAT_FLOAT32, normalized 16 bit values expanded by the fetch hardware for the packed formats
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec2 inUV;
+
+//Matches MeshPushConstants in VulkanMesh.h, the multiview variant ignores the matrix
+layout (push_constant) uniform MeshPushConstants
+{
+    mat4 viewProjection;
+    vec3 positionOffset;
+    float padding;
+    vec3 positionScale;
+} pushConstants;
+
+//Set for the packed vertex formats, the pipeline of a float mesh never contains the decoding
+layout (constant_id = SHADER_CONSTANT_MESH_OCTAHEDRAL_NORMALS) const bool octahedralNormals = false;
+
+layout (location = 0) out vec3 fragColor;
+//Only read by the clustered lighting, which finds the fragment's cluster and lights it in world space
+layout (location = 1) out vec3 fragWorldPosition;
+layout (location = 2) out vec3 fragNormal;
+layout (location = 3) out vec4 fragClipPosition;
+
+//Packed positions are quantized to the mesh bounds, float positions use an offset of 0 and a scale of 1
+vec3 DecodePosition(vec3 position)
+{
+    return pushConstants.positionOffset + position * pushConstants.positionScale;
+}
+
+//Octahedral normals only fill the first two components, the fetch hardware sets the third to 0
+vec3 DecodeNormal(vec3 normal)
+{
+    if (!octahedralNormals)
+    {
+        return normalize(normal);
+    }
+
+    vec3 decoded = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));
+    float fold = max(-decoded.z, 0.0);
+    decoded.x += decoded.x >= 0.0 ? -fold : fold;
+    decoded.y += decoded.y >= 0.0 ? -fold : fold;
+    return normalize(decoded);
+}
+
+void main() 
+{
+    vec3 position = DecodePosition(inPosition);
+#ifdef MULTIVIEW
+    gl_Position = ViewProjection() * vec4(position, 1.0);
+#else
+    gl_Position = pushConstants.viewProjection * vec4(position, 1.0);
+#endif
+
+    //A fixed directional light, so the shape of the mesh is visible without materials
+    vec3 normal = DecodeNormal(inNormal);
+    float diffuse = max(dot(normal, normalize(vec3(0.4, 1.0, 0.3))), 0.0);
+    fragColor = vec3(0.2 + 0.8 * diffuse);
+
+    fragWorldPosition = position;
+    fragNormal = normal;
+    fragClipPosition = gl_Position;
+}
\ No newline at end of file
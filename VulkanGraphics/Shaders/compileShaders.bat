@@ -1,5 +1,26 @@
-C:/Dev/VisualStudio/VulkanGraphics/ExternalDependencies/Vulkan/Bin/glslc.exe VulkanTriangle.vert -o vert.spv
+@echo off
+REM Compiles every shader in shaders.list with glslc, taken from the Vulkan SDK that VULKAN_SDK points to or from the PATH
+cd /d "%~dp0"
 
-C:/Dev/VisualStudio/VulkanGraphics/ExternalDependencies/Vulkan/Bin/glslc.exe VulkanTriangle.frag -o frag.spv
+set GLSLC=glslc
+if defined VULKAN_SDK if exist "%VULKAN_SDK%\Bin\glslc.exe" set GLSLC=%VULKAN_SDK%\Bin\glslc.exe
+if "%GLSLC%"=="glslc" (
+	where /q glslc || (
+		echo glslc was not found, install the Vulkan SDK and set VULKAN_SDK or add glslc to the PATH
+		set FAILED=1
+		goto done
+	)
+)
 
-PAUSE
\ No newline at end of file
+set FAILED=
+for /f "usebackq eol=# delims=" %%L in ("shaders.list") do (
+	echo %%L
+	"%GLSLC%" %%L || set FAILED=1
+)
+
+:done
+REM Called with an argument by the pre-build step, which has no console to wait on
+if "%~1"=="" PAUSE
+REM A shader that failed to compile fails the build
+if defined FAILED exit /b 1
+exit /b 0
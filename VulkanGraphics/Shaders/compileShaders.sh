@@ -0,0 +1,27 @@
+#!/bin/sh
+# Compiles every shader in shaders.list with glslc, taken from the Vulkan SDK that VULKAN_SDK points to or from the PATH
+cd "$(dirname "$0")" || exit 1
+
+if [ -n "$VULKAN_SDK" ] && [ -x "$VULKAN_SDK/bin/glslc" ]; then
+	GLSLC="$VULKAN_SDK/bin/glslc"
+elif command -v glslc > /dev/null 2>&1; then
+	GLSLC=glslc
+else
+	echo "glslc was not found, install the Vulkan SDK and set VULKAN_SDK or add glslc to the PATH" >&2
+	exit 1
+fi
+
+failed=0
+while IFS= read -r line || [ -n "$line" ]; do
+	# The list is checked out with Windows line endings as well
+	line=$(printf '%s' "$line" | tr -d '\r')
+	case "$line" in
+		''|'#'*) continue ;;
+	esac
+	echo "$line"
+	# Split on spaces like the batch file does, none of the arguments or names contain any
+	"$GLSLC" $line || failed=1
+done < shaders.list
+
+# A shader that failed to compile fails the script
+exit $failed
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "EngineCore/Jobs/JobSystem.h"
+
+//Jobs created per round of the overhead benchmark, kept under JOB_POOL_SIZE since every job of a round is alive at once
+#define BENCHMARK_JOBS_PER_ROUND 2048
+
+//Items of the scaling benchmark, and how many of them each job of its parallel for works on
+#define BENCHMARK_SCALING_ITEMS (1u << 20)
+#define BENCHMARK_SCALING_BATCH 1024
+
+//Iterations of the busy work done for every item of the scaling benchmark
+#define BENCHMARK_WORK_ITERATIONS 64
+
+//Every benchmark is run this many times and the fastest run is reported, so a single hiccup does not skew the result
+#define BENCHMARK_REPETITIONS 5
+
+static double ElapsedNs(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+//Enough floating point work per item that the scaling benchmark is bound by computation rather than memory
+static float BusyWork(uint32_t item)
+{
+	float value = static_cast<float>(item);
+	for (uint32_t i = 0; i < BENCHMARK_WORK_ITERATIONS; ++i)
+	{
+		value = std::sqrt(value * 1.0001f + 1.0f);
+	}
+	return value;
+}
+
+/*************************************************************************
+* Function Argument 1: The amount of empty jobs to create and run		 *
+* Returns the nanoseconds per job of creating a job as the child of a	 *
+* root job, submitting it and running it, including any stealing		 *
+*************************************************************************/
+static double MeasureJobOverhead(uint32_t jobCount)
+{
+	JobSystem& jobSystem = JobSystem::Get();
+	double bestNs = 0.0;
+	for (uint32_t repetition = 0; repetition < BENCHMARK_REPETITIONS; ++repetition)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t created = 0; created < jobCount; created += BENCHMARK_JOBS_PER_ROUND)
+		{
+			Job* root = jobSystem.CreateJob([]() {});
+			for (uint32_t i = 0; i < BENCHMARK_JOBS_PER_ROUND; ++i)
+			{
+				jobSystem.Run(jobSystem.CreateJob([]() {}, root));
+			}
+			jobSystem.Run(root);
+			jobSystem.Wait(root);
+		}
+		double ns = ElapsedNs(start) / jobCount;
+		bestNs = repetition == 0 ? ns : std::min(bestNs, ns);
+	}
+	return bestNs;
+}
+
+/*************************************************************************
+* Function Argument 1: The length of the chain							 *
+* Returns the nanoseconds per job of a chain where every job depends on	 *
+* the previous one, which measures the latency of a continuation		 *
+* starting rather than throughput										 *
+*************************************************************************/
+static double MeasureDependencyLatency(uint32_t chainLength)
+{
+	JobSystem& jobSystem = JobSystem::Get();
+	double bestNs = 0.0;
+	for (uint32_t repetition = 0; repetition < BENCHMARK_REPETITIONS; ++repetition)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t created = 0; created < chainLength; created += BENCHMARK_JOBS_PER_ROUND)
+		{
+			Job* first = jobSystem.CreateJob([]() {});
+			Job* previous = first;
+			for (uint32_t i = 1; i < BENCHMARK_JOBS_PER_ROUND; ++i)
+			{
+				Job* next = jobSystem.CreateJob([]() {});
+				jobSystem.AddDependency(next, previous);
+				jobSystem.Run(next);
+				previous = next;
+			}
+			jobSystem.Run(first);
+			jobSystem.Wait(previous);
+		}
+		double ns = ElapsedNs(start) / chainLength;
+		bestNs = repetition == 0 ? ns : std::min(bestNs, ns);
+	}
+	return bestNs;
+}
+
+/*****************************************************************************
+* Function Argument 1: The results of every item are written here, so the	 *
+*					   work cannot be optimized away						 *
+* Returns the milliseconds the parallel for over every item took			 *
+*****************************************************************************/
+static double MeasureParallelFor(std::vector<float>& results)
+{
+	JobSystem& jobSystem = JobSystem::Get();
+	float* output = results.data();
+	double bestMs = 0.0;
+	for (uint32_t repetition = 0; repetition < BENCHMARK_REPETITIONS; ++repetition)
+	{
+		auto start = std::chrono::steady_clock::now();
+		jobSystem.ParallelFor(BENCHMARK_SCALING_ITEMS, BENCHMARK_SCALING_BATCH, [output](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				output[i] = BusyWork(i);
+			}
+		});
+		double ms = ElapsedNs(start) / 1e6;
+		bestMs = repetition == 0 ? ms : std::min(bestMs, ms);
+	}
+	return bestMs;
+}
+
+int main(int argc, char** argv)
+{
+	/* Reading the command line */
+	uint32_t maxWorkers = JobSystem::GetDefaultWorkerCount();
+	uint32_t jobCount = 1u << 18;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+		{
+			maxWorkers = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			jobCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			std::cout << "Usage: JobBenchmark [--workers N] [--jobs N]\n";
+			std::cout << "  --workers  the most worker threads to scale up to (default: one per hardware thread, minus one)\n";
+			std::cout << "  --jobs     empty jobs run by the overhead benchmarks (default 262144)\n";
+			return 1;
+		}
+	}
+	//Whole rounds only, so every measurement divides by the amount of jobs that actually ran
+	jobCount = std::max(jobCount / BENCHMARK_JOBS_PER_ROUND, 1u) * BENCHMARK_JOBS_PER_ROUND;
+	/* Command line read */
+
+	//The serial loop is the baseline the scaling is measured against
+	std::vector<float> results(BENCHMARK_SCALING_ITEMS);
+	double serialMs = 0.0;
+	for (uint32_t repetition = 0; repetition < BENCHMARK_REPETITIONS; ++repetition)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < BENCHMARK_SCALING_ITEMS; ++i)
+		{
+			results[i] = BusyWork(i);
+		}
+		double ms = ElapsedNs(start) / 1e6;
+		serialMs = repetition == 0 ? ms : std::min(serialMs, ms);
+	}
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Serial loop: " << serialMs << " ms for " << BENCHMARK_SCALING_ITEMS << " items\n\n";
+	std::cout << "Threads  Job overhead  Dependency latency  Parallel for  Speedup  Efficiency\n";
+
+	/* Running every benchmark with more and more workers */
+	std::vector<uint32_t> workerCounts = { 0 };
+	for (uint32_t workers = 1; workers < maxWorkers; workers *= 2)
+	{
+		workerCounts.push_back(workers);
+	}
+	if (maxWorkers > 0)
+	{
+		workerCounts.push_back(maxWorkers);
+	}
+
+	for (uint32_t workers : workerCounts)
+	{
+		JobSystem::Get().Start(workers);
+		uint32_t threads = JobSystem::Get().GetThreadCount();
+
+		double overheadNs = MeasureJobOverhead(jobCount);
+		double latencyNs = MeasureDependencyLatency(jobCount);
+		double parallelMs = MeasureParallelFor(results);
+		double speedup = serialMs / parallelMs;
+
+		std::cout << std::setw(7) << threads << std::setw(11) << overheadNs << " ns" << std::setw(17) << latencyNs << " ns"
+			<< std::setw(11) << parallelMs << " ms" << std::setw(8) << speedup << "x" << std::setw(11)
+			<< 100.0 * speedup / threads << "%\n";
+
+		JobSystem::Get().Stop();
+	}
+	/* Benchmarks run */
+
+	//Printing a result so the busy work is not optimized away
+	float checksum = 0.0f;
+	for (uint32_t i = 0; i < BENCHMARK_SCALING_ITEMS; i += BENCHMARK_SCALING_BATCH)
+	{
+		checksum += results[i];
+	}
+	std::cout << "\nChecksum: " << checksum << "\n";
+	return 0;
+}
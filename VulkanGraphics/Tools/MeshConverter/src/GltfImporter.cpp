@@ -0,0 +1,611 @@
+#include "GltfImporter.h"
+#include "JsonParser.h"
+#include "EngineCore/Math/VectorMath.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+//Values of the glTF spec
+#define GLTF_GLB_MAGIC 0x46546C67
+#define GLTF_GLB_CHUNK_JSON 0x4E4F534A
+#define GLTF_GLB_CHUNK_BIN 0x004E4942
+#define GLTF_COMPONENT_BYTE 5120
+#define GLTF_COMPONENT_UNSIGNED_BYTE 5121
+#define GLTF_COMPONENT_SHORT 5122
+#define GLTF_COMPONENT_UNSIGNED_SHORT 5123
+#define GLTF_COMPONENT_UNSIGNED_INT 5125
+#define GLTF_COMPONENT_FLOAT 5126
+#define GLTF_MODE_TRIANGLES 4
+
+//Node hierarchies deeper than this are treated as cycles
+#define GLTF_MAX_NODE_DEPTH 64
+
+//The parsed JSON of a glTF file and the contents of all of its buffers
+struct GltfDocument
+{
+	JsonValue json;
+	std::vector<std::vector<uint8_t>> buffers;
+};
+
+//A typed window into a buffer view, as described by an accessor
+struct GltfAccessorView
+{
+	const uint8_t* data = nullptr;
+	uint32_t count = 0;
+	uint32_t componentType = 0;
+	uint32_t componentCount = 0;
+	uint32_t stride = 0;
+	bool normalized = false;
+};
+
+static bool ReadWholeFile(const std::string& filename, std::vector<uint8_t>& contents)
+{
+	std::ifstream file(filename, std::ios::ate | std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	contents.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+	return static_cast<bool>(file);
+}
+
+static bool DecodeBase64(const std::string& text, size_t start, std::vector<uint8_t>& output)
+{
+	uint32_t accumulator = 0;
+	int bits = 0;
+	for (size_t i = start; i < text.size() && text[i] != '='; ++i)
+	{
+		char c = text[i];
+		uint32_t value;
+		if (c >= 'A' && c <= 'Z') value = c - 'A';
+		else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+		else if (c >= '0' && c <= '9') value = c - '0' + 52;
+		else if (c == '+') value = 62;
+		else if (c == '/') value = 63;
+		else return false;
+
+		accumulator = (accumulator << 6) | value;
+		bits += 6;
+		if (bits >= 8)
+		{
+			bits -= 8;
+			output.push_back(static_cast<uint8_t>((accumulator >> bits) & 0xFF));
+		}
+	}
+	return true;
+}
+
+//Decodes the %XX escapes of a relative buffer URI
+static std::string DecodeUri(const std::string& uri)
+{
+	std::string decoded;
+	for (size_t i = 0; i < uri.size(); ++i)
+	{
+		if (uri[i] == '%' && i + 2 < uri.size())
+		{
+			decoded += static_cast<char>(std::strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16));
+			i += 2;
+		}
+		else
+		{
+			decoded += uri[i];
+		}
+	}
+	return decoded;
+}
+
+static bool LoadGltfDocument(const std::string& filename, GltfDocument& document, std::string& error)
+{
+	std::vector<uint8_t> contents;
+	if (!ReadWholeFile(filename, contents))
+	{
+		error = "could not open " + filename;
+		return false;
+	}
+
+	/* Splitting binary glTF into its JSON and binary chunks */
+	const char* jsonText = reinterpret_cast<const char*>(contents.data());
+	size_t jsonLength = contents.size();
+	std::vector<uint8_t> glbBinaryChunk;
+	uint32_t magic = 0;
+	if (contents.size() >= 12)
+	{
+		std::memcpy(&magic, contents.data(), 4);
+	}
+	if (magic == GLTF_GLB_MAGIC)
+	{
+		jsonText = nullptr;
+		size_t offset = 12;
+		while (offset + 8 <= contents.size())
+		{
+			uint32_t chunkLength, chunkType;
+			std::memcpy(&chunkLength, contents.data() + offset, 4);
+			std::memcpy(&chunkType, contents.data() + offset + 4, 4);
+			offset += 8;
+			if (chunkLength > contents.size() - offset)
+			{
+				error = "truncated chunk in " + filename;
+				return false;
+			}
+
+			if (chunkType == GLTF_GLB_CHUNK_JSON && !jsonText)
+			{
+				jsonText = reinterpret_cast<const char*>(contents.data() + offset);
+				jsonLength = chunkLength;
+			}
+			else if (chunkType == GLTF_GLB_CHUNK_BIN && glbBinaryChunk.empty())
+			{
+				glbBinaryChunk.assign(contents.begin() + offset, contents.begin() + offset + chunkLength);
+			}
+			offset += chunkLength;
+		}
+
+		if (!jsonText)
+		{
+			error = filename + " has no JSON chunk";
+			return false;
+		}
+	}
+	/* Chunks split */
+
+	if (!ParseJson(jsonText, jsonLength, document.json, error))
+	{
+		error = filename + ": " + error;
+		return false;
+	}
+
+	/* Loading the buffers */
+	std::string directory = filename.substr(0, filename.find_last_of("/\\") + 1);
+	const JsonValue* buffers = document.json.Find("buffers");
+	if (buffers && buffers->type == JsonValue::Type::Array)
+	{
+		for (const JsonValue& buffer : buffers->array)
+		{
+			document.buffers.emplace_back();
+			std::vector<uint8_t>& data = document.buffers.back();
+			std::string uri = buffer.GetString("uri");
+
+			//Only the first buffer of a .glb file may leave out its uri, it refers to the binary chunk
+			if (uri.empty())
+			{
+				data = glbBinaryChunk;
+			}
+			else if (uri.compare(0, 5, "data:") == 0)
+			{
+				size_t comma = uri.find(',');
+				if (comma == std::string::npos || !DecodeBase64(uri, comma + 1, data))
+				{
+					error = "invalid data uri in " + filename;
+					return false;
+				}
+			}
+			else if (!ReadWholeFile(directory + DecodeUri(uri), data))
+			{
+				error = "could not open buffer " + uri;
+				return false;
+			}
+
+			if (data.size() < static_cast<size_t>(buffer.GetNumber("byteLength", 0.0)))
+			{
+				error = "buffer " + uri + " is shorter than its byteLength";
+				return false;
+			}
+		}
+	}
+	/* Buffers loaded */
+
+	return true;
+}
+
+static bool GetAccessorView(const GltfDocument& document, uint32_t accessorIndex, GltfAccessorView& view, std::string& error)
+{
+	const JsonValue* accessors = document.json.Find("accessors");
+	const JsonValue* bufferViews = document.json.Find("bufferViews");
+	if (!accessors || accessorIndex >= accessors->array.size())
+	{
+		error = "invalid accessor index";
+		return false;
+	}
+
+	const JsonValue& accessor = accessors->array[accessorIndex];
+	const JsonValue* bufferViewIndex = accessor.Find("bufferView");
+	if (accessor.Find("sparse") || !bufferViewIndex || !bufferViews ||
+		static_cast<size_t>(bufferViewIndex->number) >= bufferViews->array.size())
+	{
+		error = "sparse accessors and accessors without buffer views are not supported";
+		return false;
+	}
+
+	/* Reading the accessor's layout */
+	std::string type = accessor.GetString("type");
+	view.componentCount = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+	view.componentType = static_cast<uint32_t>(accessor.GetNumber("componentType", 0.0));
+	view.count = static_cast<uint32_t>(accessor.GetNumber("count", 0.0));
+	const JsonValue* normalized = accessor.Find("normalized");
+	view.normalized = normalized && normalized->boolean;
+
+	uint32_t componentSize = 0;
+	switch (view.componentType)
+	{
+	case GLTF_COMPONENT_BYTE: case GLTF_COMPONENT_UNSIGNED_BYTE: componentSize = 1; break;
+	case GLTF_COMPONENT_SHORT: case GLTF_COMPONENT_UNSIGNED_SHORT: componentSize = 2; break;
+	case GLTF_COMPONENT_UNSIGNED_INT: case GLTF_COMPONENT_FLOAT: componentSize = 4; break;
+	}
+	if (view.componentCount == 0 || componentSize == 0)
+	{
+		error = "unsupported accessor type";
+		return false;
+	}
+	/* Layout read */
+
+	const JsonValue& bufferView = bufferViews->array[static_cast<size_t>(bufferViewIndex->number)];
+	size_t bufferIndex = static_cast<size_t>(bufferView.GetNumber("buffer", 0.0));
+	if (bufferIndex >= document.buffers.size())
+	{
+		error = "invalid buffer index";
+		return false;
+	}
+
+	uint64_t elementSize = static_cast<uint64_t>(componentSize) * view.componentCount;
+	view.stride = static_cast<uint32_t>(bufferView.GetNumber("byteStride", static_cast<double>(elementSize)));
+	uint64_t offset = static_cast<uint64_t>(bufferView.GetNumber("byteOffset", 0.0)) +
+		static_cast<uint64_t>(accessor.GetNumber("byteOffset", 0.0));
+	uint64_t viewEnd = static_cast<uint64_t>(bufferView.GetNumber("byteOffset", 0.0)) +
+		static_cast<uint64_t>(bufferView.GetNumber("byteLength", 0.0));
+
+	//The last element has to end inside both the buffer view and the buffer
+	uint64_t accessedEnd = view.count == 0 ? offset : offset + static_cast<uint64_t>(view.stride) * (view.count - 1) + elementSize;
+	if (accessedEnd > viewEnd || viewEnd > document.buffers[bufferIndex].size())
+	{
+		error = "accessor reads past the end of its buffer view";
+		return false;
+	}
+
+	view.data = document.buffers[bufferIndex].data() + offset;
+	return true;
+}
+
+//Reads one component of an element as a float, applying normalization for integer components
+static float ReadAccessorFloat(const GltfAccessorView& view, uint32_t element, uint32_t component)
+{
+	const uint8_t* source = view.data + static_cast<size_t>(view.stride) * element;
+	switch (view.componentType)
+	{
+	case GLTF_COMPONENT_FLOAT:
+	{
+		float value;
+		std::memcpy(&value, source + component * 4, 4);
+		return value;
+	}
+	case GLTF_COMPONENT_UNSIGNED_BYTE:
+		return view.normalized ? source[component] / 255.0f : source[component];
+	case GLTF_COMPONENT_BYTE:
+	{
+		float value = static_cast<float>(static_cast<int8_t>(source[component]));
+		return view.normalized ? (value / 127.0f < -1.0f ? -1.0f : value / 127.0f) : value;
+	}
+	case GLTF_COMPONENT_UNSIGNED_SHORT:
+	{
+		uint16_t value;
+		std::memcpy(&value, source + component * 2, 2);
+		return view.normalized ? value / 65535.0f : value;
+	}
+	case GLTF_COMPONENT_SHORT:
+	{
+		int16_t value;
+		std::memcpy(&value, source + component * 2, 2);
+		return view.normalized ? (value / 32767.0f < -1.0f ? -1.0f : value / 32767.0f) : value;
+	}
+	default:
+	{
+		uint32_t value;
+		std::memcpy(&value, source + component * 4, 4);
+		return static_cast<float>(value);
+	}
+	}
+}
+
+static uint32_t ReadAccessorIndex(const GltfAccessorView& view, uint32_t element)
+{
+	const uint8_t* source = view.data + static_cast<size_t>(view.stride) * element;
+	switch (view.componentType)
+	{
+	case GLTF_COMPONENT_UNSIGNED_BYTE:
+		return source[0];
+	case GLTF_COMPONENT_UNSIGNED_SHORT:
+	{
+		uint16_t value;
+		std::memcpy(&value, source, 2);
+		return value;
+	}
+	default:
+	{
+		uint32_t value;
+		std::memcpy(&value, source, 4);
+		return value;
+	}
+	}
+}
+
+//Returns the node's transform relative to its parent, from its matrix or from its translation, rotation and scale
+static Mat4 GetNodeLocalTransform(const JsonValue& node)
+{
+	Mat4 transform = Mat4::Identity();
+	const JsonValue* matrix = node.Find("matrix");
+	if (matrix && matrix->array.size() == 16)
+	{
+		//glTF matrices are column major like Mat4
+		for (int i = 0; i < 16; ++i)
+		{
+			transform.m[i] = static_cast<float>(matrix->array[i].number);
+		}
+		return transform;
+	}
+
+	float translation[3] = { 0.0f, 0.0f, 0.0f };
+	float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float scale[3] = { 1.0f, 1.0f, 1.0f };
+	const JsonValue* values[3] = { node.Find("translation"), node.Find("rotation"), node.Find("scale") };
+	float* targets[3] = { translation, rotation, scale };
+	size_t sizes[3] = { 3, 4, 3 };
+	for (int i = 0; i < 3; ++i)
+	{
+		if (values[i] && values[i]->array.size() == sizes[i])
+		{
+			for (size_t j = 0; j < sizes[i]; ++j)
+			{
+				targets[i][j] = static_cast<float>(values[i]->array[j].number);
+			}
+		}
+	}
+
+	/* Building translation * rotation * scale */
+	float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+	float rotationMatrix[9] = {
+		1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w),
+		2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w),
+		2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y) };
+	for (int column = 0; column < 3; ++column)
+	{
+		for (int row = 0; row < 3; ++row)
+		{
+			transform.m[column * 4 + row] = rotationMatrix[column * 3 + row] * scale[column];
+		}
+	}
+	transform.m[12] = translation[0];
+	transform.m[13] = translation[1];
+	transform.m[14] = translation[2];
+	/* Transform built */
+
+	return transform;
+}
+
+static bool AppendPrimitive(const GltfDocument& document, const JsonValue& primitive, const Mat4& worldTransform,
+	ImportedMesh& mesh, std::string& error)
+{
+	if (primitive.GetNumber("mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES)
+	{
+		std::cout << "Skipping a primitive that is not a triangle list\n";
+		return true;
+	}
+
+	const JsonValue* attributes = primitive.Find("attributes");
+	const JsonValue* positionAccessor = attributes ? attributes->Find("POSITION") : nullptr;
+	if (!positionAccessor)
+	{
+		std::cout << "Skipping a primitive without positions\n";
+		return true;
+	}
+
+	/* Reading the vertices */
+	GltfAccessorView positions, normals, uvs;
+	if (!GetAccessorView(document, static_cast<uint32_t>(positionAccessor->number), positions, error))
+	{
+		return false;
+	}
+	const JsonValue* normalAccessor = attributes->Find("NORMAL");
+	const JsonValue* uvAccessor = attributes->Find("TEXCOORD_0");
+	bool hasNormals = normalAccessor && GetAccessorView(document, static_cast<uint32_t>(normalAccessor->number), normals, error) &&
+		normals.count == positions.count;
+	bool hasUvs = uvAccessor && GetAccessorView(document, static_cast<uint32_t>(uvAccessor->number), uvs, error) &&
+		uvs.count == positions.count;
+
+	//Normals use the inverse transpose of the transform, its columns are the cross products of the transform's columns
+	Vec3 columns[3] = { { worldTransform.m[0], worldTransform.m[1], worldTransform.m[2] },
+		{ worldTransform.m[4], worldTransform.m[5], worldTransform.m[6] },
+		{ worldTransform.m[8], worldTransform.m[9], worldTransform.m[10] } };
+	Vec3 normalColumns[3] = { Cross(columns[1], columns[2]), Cross(columns[2], columns[0]), Cross(columns[0], columns[1]) };
+	float determinant = Dot(columns[0], normalColumns[0]);
+	float normalSign = determinant < 0.0f ? -1.0f : 1.0f;
+
+	size_t firstVertex = mesh.vertices.size();
+	for (uint32_t i = 0; i < positions.count; ++i)
+	{
+		MeshVertex vertex{};
+		Vec3 position = TransformPoint(worldTransform, { ReadAccessorFloat(positions, i, 0),
+			ReadAccessorFloat(positions, i, 1), ReadAccessorFloat(positions, i, 2) });
+		vertex.position[0] = position.x;
+		vertex.position[1] = position.y;
+		vertex.position[2] = position.z;
+
+		if (hasNormals)
+		{
+			Vec3 normal = Normalize((normalColumns[0] * ReadAccessorFloat(normals, i, 0) + normalColumns[1] * ReadAccessorFloat(normals, i, 1) +
+				normalColumns[2] * ReadAccessorFloat(normals, i, 2)) * normalSign);
+			vertex.normal[0] = normal.x;
+			vertex.normal[1] = normal.y;
+			vertex.normal[2] = normal.z;
+		}
+		if (hasUvs)
+		{
+			vertex.uv[0] = ReadAccessorFloat(uvs, i, 0);
+			vertex.uv[1] = ReadAccessorFloat(uvs, i, 1);
+		}
+		mesh.vertices.push_back(vertex);
+	}
+	/* Vertices read */
+
+	/* Reading the indices */
+	size_t firstIndex = mesh.indices.size();
+	const JsonValue* indexAccessor = primitive.Find("indices");
+	if (indexAccessor)
+	{
+		GltfAccessorView indices;
+		if (!GetAccessorView(document, static_cast<uint32_t>(indexAccessor->number), indices, error))
+		{
+			return false;
+		}
+		for (uint32_t i = 0; i + 2 < indices.count; i += 3)
+		{
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				uint32_t index = ReadAccessorIndex(indices, i + corner);
+				if (index >= positions.count)
+				{
+					error = "index out of range";
+					return false;
+				}
+				mesh.indices.push_back(static_cast<uint32_t>(firstVertex) + index);
+			}
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i + 2 < positions.count; i += 3)
+		{
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				mesh.indices.push_back(static_cast<uint32_t>(firstVertex + i + corner));
+			}
+		}
+	}
+
+	//Mirroring transforms turn counter clockwise triangles clockwise, so their winding is flipped back
+	if (determinant < 0.0f)
+	{
+		for (size_t i = firstIndex; i + 2 < mesh.indices.size(); i += 3)
+		{
+			std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+		}
+	}
+	/* Indices read */
+
+	if (!hasNormals)
+	{
+		ComputeVertexNormals(mesh, firstVertex, firstIndex);
+	}
+
+	uint32_t materialIndex = static_cast<uint32_t>(primitive.GetNumber("material", 0.0));
+	mesh.submeshes.push_back({ static_cast<uint32_t>(firstIndex), static_cast<uint32_t>(mesh.indices.size() - firstIndex),
+		materialIndex });
+	return true;
+}
+
+static bool AppendMesh(const GltfDocument& document, uint32_t meshIndex, const Mat4& worldTransform, ImportedMesh& mesh,
+	std::string& error)
+{
+	const JsonValue* meshes = document.json.Find("meshes");
+	if (!meshes || meshIndex >= meshes->array.size())
+	{
+		error = "invalid mesh index";
+		return false;
+	}
+
+	const JsonValue* primitives = meshes->array[meshIndex].Find("primitives");
+	if (!primitives)
+	{
+		return true;
+	}
+	for (const JsonValue& primitive : primitives->array)
+	{
+		if (!AppendPrimitive(document, primitive, worldTransform, mesh, error))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool AppendNode(const GltfDocument& document, uint32_t nodeIndex, const Mat4& parentTransform, uint32_t depth,
+	ImportedMesh& mesh, std::string& error)
+{
+	const JsonValue* nodes = document.json.Find("nodes");
+	if (!nodes || nodeIndex >= nodes->array.size() || depth > GLTF_MAX_NODE_DEPTH)
+	{
+		error = "invalid node hierarchy";
+		return false;
+	}
+
+	const JsonValue& node = nodes->array[nodeIndex];
+	Mat4 worldTransform = parentTransform * GetNodeLocalTransform(node);
+
+	const JsonValue* meshIndex = node.Find("mesh");
+	if (meshIndex && !AppendMesh(document, static_cast<uint32_t>(meshIndex->number), worldTransform, mesh, error))
+	{
+		return false;
+	}
+
+	const JsonValue* children = node.Find("children");
+	if (children)
+	{
+		for (const JsonValue& child : children->array)
+		{
+			if (!AppendNode(document, static_cast<uint32_t>(child.number), worldTransform, depth + 1, mesh, error))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool ImportGltf(const std::string& filename, ImportedMesh& mesh, std::string& error)
+{
+	GltfDocument document;
+	if (!LoadGltfDocument(filename, document, error))
+	{
+		return false;
+	}
+
+	const JsonValue* scenes = document.json.Find("scenes");
+	if (scenes && !scenes->array.empty())
+	{
+		size_t sceneIndex = static_cast<size_t>(document.json.GetNumber("scene", 0.0));
+		const JsonValue* rootNodes = sceneIndex < scenes->array.size() ? scenes->array[sceneIndex].Find("nodes") : nullptr;
+		if (rootNodes)
+		{
+			for (const JsonValue& rootNode : rootNodes->array)
+			{
+				if (!AppendNode(document, static_cast<uint32_t>(rootNode.number), Mat4::Identity(), 0, mesh, error))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	else
+	{
+		//Files without scenes are libraries of meshes, every mesh is imported once without a transform
+		const JsonValue* meshes = document.json.Find("meshes");
+		for (uint32_t i = 0; meshes && i < meshes->array.size(); ++i)
+		{
+			if (!AppendMesh(document, i, Mat4::Identity(), mesh, error))
+			{
+				return false;
+			}
+		}
+	}
+
+	if (mesh.indices.empty())
+	{
+		error = filename + " has no triangles";
+		return false;
+	}
+	return true;
+}
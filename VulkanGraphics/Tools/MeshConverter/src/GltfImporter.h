@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string>
+#include "ImportedMesh.h"
+
+//Reads the triangle primitives of a glTF 2.0 file (.gltf with external or embedded buffers, or .glb),
+//baking the node transforms of the default scene into the vertices. Every primitive becomes a submesh
+bool ImportGltf(const std::string& filename, ImportedMesh& mesh, std::string& error);
@@ -0,0 +1,59 @@
+#include "ImportedMesh.h"
+#include "EngineCore/Math/VectorMath.h"
+
+#include <cfloat>
+
+void ComputeVertexNormals(ImportedMesh& mesh, size_t firstVertex, size_t firstIndex)
+{
+	for (size_t i = firstVertex; i < mesh.vertices.size(); ++i)
+	{
+		mesh.vertices[i].normal[0] = mesh.vertices[i].normal[1] = mesh.vertices[i].normal[2] = 0.0f;
+	}
+
+	//The cross product's length is twice the triangle's area, so larger triangles weigh more
+	for (size_t i = firstIndex; i + 2 < mesh.indices.size(); i += 3)
+	{
+		MeshVertex* corners[3] = { &mesh.vertices[mesh.indices[i]], &mesh.vertices[mesh.indices[i + 1]],
+			&mesh.vertices[mesh.indices[i + 2]] };
+		Vec3 p0 = { corners[0]->position[0], corners[0]->position[1], corners[0]->position[2] };
+		Vec3 p1 = { corners[1]->position[0], corners[1]->position[1], corners[1]->position[2] };
+		Vec3 p2 = { corners[2]->position[0], corners[2]->position[1], corners[2]->position[2] };
+		Vec3 faceNormal = Cross(p1 - p0, p2 - p0);
+
+		for (MeshVertex* corner : corners)
+		{
+			corner->normal[0] += faceNormal.x;
+			corner->normal[1] += faceNormal.y;
+			corner->normal[2] += faceNormal.z;
+		}
+	}
+
+	for (size_t i = firstVertex; i < mesh.vertices.size(); ++i)
+	{
+		float* normal = mesh.vertices[i].normal;
+		Vec3 normalized = Normalize({ normal[0], normal[1], normal[2] });
+		normal[0] = normalized.x;
+		normal[1] = normalized.y;
+		normal[2] = normalized.z;
+	}
+}
+
+MeshBounds ComputeIndexedBounds(const ImportedMesh& mesh, uint32_t firstIndex, uint32_t indexCount)
+{
+	MeshBounds bounds = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+	for (uint32_t i = firstIndex; i < firstIndex + indexCount; ++i)
+	{
+		const float* position = mesh.vertices[mesh.indices[i]].position;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			bounds.min[axis] = position[axis] < bounds.min[axis] ? position[axis] : bounds.min[axis];
+			bounds.max[axis] = position[axis] > bounds.max[axis] ? position[axis] : bounds.max[axis];
+		}
+	}
+
+	if (indexCount == 0)
+	{
+		bounds = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+	}
+	return bounds;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "EngineCore/Meshes/MeshFile.h"
+
+//A range of the index list drawn with one material
+struct ImportedSubmesh
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t materialIndex;
+
+	//Filled by BuildLods, the submesh's levels in ImportedMesh::lods
+	uint32_t firstLod = 0;
+	uint32_t lodCount = 0;
+};
+
+//Geometry gathered by an importer, in the engine's vertex layout, before it is written to a mesh file
+struct ImportedMesh
+{
+	std::vector<MeshVertex> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<ImportedSubmesh> submeshes;
+
+	//Only filled when the optimizer is asked to build meshlets
+	std::vector<MeshFileMeshlet> meshlets;
+
+	//Detail levels of every submesh, submeshes without levels are written with their own range as the only one
+	std::vector<MeshFileLod> lods;
+};
+
+//Gives area weighted smooth normals to the vertices from firstVertex on, using the triangles from firstIndex on
+void ComputeVertexNormals(ImportedMesh& mesh, size_t firstVertex, size_t firstIndex);
+
+//Returns the bounds of the vertices referenced by indices [firstIndex, firstIndex + indexCount)
+MeshBounds ComputeIndexedBounds(const ImportedMesh& mesh, uint32_t firstIndex, uint32_t indexCount);
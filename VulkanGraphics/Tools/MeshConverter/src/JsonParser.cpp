@@ -0,0 +1,354 @@
+#include "JsonParser.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+const JsonValue* JsonValue::Find(const char* key) const
+{
+	if (type != Type::Object)
+	{
+		return nullptr;
+	}
+
+	for (const std::pair<std::string, JsonValue>& member : object)
+	{
+		if (member.first == key)
+		{
+			return &member.second;
+		}
+	}
+	return nullptr;
+}
+
+double JsonValue::GetNumber(const char* key, double fallback) const
+{
+	const JsonValue* value = Find(key);
+	return value && value->type == Type::Number ? value->number : fallback;
+}
+
+std::string JsonValue::GetString(const char* key) const
+{
+	const JsonValue* value = Find(key);
+	return value && value->type == Type::String ? value->string : std::string();
+}
+
+/**************************************************************
+* Recursive descent parser over the document's text, glTF	  *
+* files only need the standard grammar, so nothing is relaxed *
+**************************************************************/
+class JsonReader
+{
+public:
+	JsonReader(const char* text, size_t length)
+		:m_text(text), m_end(text + length), m_error()
+	{
+
+	}
+
+	bool ParseValue(JsonValue& value, int depth)
+	{
+		//Deeply nested documents are rejected rather than overflowing the stack
+		if (depth > 256)
+		{
+			return Fail("document is nested too deeply");
+		}
+
+		SkipWhitespace();
+		if (m_text == m_end)
+		{
+			return Fail("unexpected end of document");
+		}
+
+		switch (*m_text)
+		{
+		case '{':
+			return ParseObject(value, depth);
+		case '[':
+			return ParseArray(value, depth);
+		case '"':
+			value.type = JsonValue::Type::String;
+			return ParseString(value.string);
+		case 't':
+			value.type = JsonValue::Type::Bool;
+			value.boolean = true;
+			return ParseLiteral("true");
+		case 'f':
+			value.type = JsonValue::Type::Bool;
+			value.boolean = false;
+			return ParseLiteral("false");
+		case 'n':
+			value.type = JsonValue::Type::Null;
+			return ParseLiteral("null");
+		default:
+			return ParseNumber(value);
+		}
+	}
+
+	bool AtEnd()
+	{
+		SkipWhitespace();
+		return m_text == m_end;
+	}
+
+	inline const std::string& GetError() const { return m_error; }
+private:
+	bool Fail(const char* message)
+	{
+		m_error = message;
+		return false;
+	}
+
+	void SkipWhitespace()
+	{
+		while (m_text != m_end && (*m_text == ' ' || *m_text == '\t' || *m_text == '\n' || *m_text == '\r'))
+		{
+			++m_text;
+		}
+	}
+
+	bool ParseLiteral(const char* literal)
+	{
+		size_t length = std::strlen(literal);
+		if (static_cast<size_t>(m_end - m_text) < length || std::strncmp(m_text, literal, length) != 0)
+		{
+			return Fail("invalid literal");
+		}
+		m_text += length;
+		return true;
+	}
+
+	bool ParseNumber(JsonValue& value)
+	{
+		//strtod stops at the first character that is not part of the number, the document is not null terminated
+		std::string number;
+		while (m_text != m_end && (std::strchr("+-.eE", *m_text) || (*m_text >= '0' && *m_text <= '9')))
+		{
+			number += *m_text++;
+		}
+		if (number.empty())
+		{
+			return Fail("unexpected character");
+		}
+
+		char* numberEnd = nullptr;
+		value.type = JsonValue::Type::Number;
+		value.number = std::strtod(number.c_str(), &numberEnd);
+		return *numberEnd == '\0' ? true : Fail("invalid number");
+	}
+
+	bool ParseHexDigits(uint32_t& codePoint)
+	{
+		if (m_end - m_text < 4)
+		{
+			return Fail("invalid unicode escape");
+		}
+
+		codePoint = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			char c = *m_text++;
+			codePoint <<= 4;
+			if (c >= '0' && c <= '9') codePoint |= c - '0';
+			else if (c >= 'a' && c <= 'f') codePoint |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F') codePoint |= c - 'A' + 10;
+			else return Fail("invalid unicode escape");
+		}
+		return true;
+	}
+
+	bool ParseString(std::string& string)
+	{
+		++m_text;
+		while (m_text != m_end && *m_text != '"')
+		{
+			char c = *m_text++;
+			if (c != '\\')
+			{
+				string += c;
+				continue;
+			}
+
+			if (m_text == m_end)
+			{
+				break;
+			}
+			char escape = *m_text++;
+			switch (escape)
+			{
+			case '"': string += '"'; break;
+			case '\\': string += '\\'; break;
+			case '/': string += '/'; break;
+			case 'b': string += '\b'; break;
+			case 'f': string += '\f'; break;
+			case 'n': string += '\n'; break;
+			case 'r': string += '\r'; break;
+			case 't': string += '\t'; break;
+			case 'u':
+			{
+				uint32_t codePoint;
+				if (!ParseHexDigits(codePoint))
+				{
+					return false;
+				}
+				//Surrogate pairs are combined into a single code point
+				if (codePoint >= 0xD800 && codePoint <= 0xDBFF && m_end - m_text >= 6 && m_text[0] == '\\' && m_text[1] == 'u')
+				{
+					m_text += 2;
+					uint32_t lowSurrogate;
+					if (!ParseHexDigits(lowSurrogate))
+					{
+						return false;
+					}
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+				}
+				AppendUtf8(string, codePoint);
+				break;
+			}
+			default:
+				return Fail("invalid escape sequence");
+			}
+		}
+
+		if (m_text == m_end)
+		{
+			return Fail("unterminated string");
+		}
+		++m_text;
+		return true;
+	}
+
+	static void AppendUtf8(std::string& string, uint32_t codePoint)
+	{
+		if (codePoint < 0x80)
+		{
+			string += static_cast<char>(codePoint);
+		}
+		else if (codePoint < 0x800)
+		{
+			string += static_cast<char>(0xC0 | (codePoint >> 6));
+			string += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000)
+		{
+			string += static_cast<char>(0xE0 | (codePoint >> 12));
+			string += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			string += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else
+		{
+			string += static_cast<char>(0xF0 | (codePoint >> 18));
+			string += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			string += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			string += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+	}
+
+	bool ParseArray(JsonValue& value, int depth)
+	{
+		value.type = JsonValue::Type::Array;
+		++m_text;
+		SkipWhitespace();
+		if (m_text != m_end && *m_text == ']')
+		{
+			++m_text;
+			return true;
+		}
+
+		while (true)
+		{
+			value.array.emplace_back();
+			if (!ParseValue(value.array.back(), depth + 1))
+			{
+				return false;
+			}
+
+			SkipWhitespace();
+			if (m_text == m_end)
+			{
+				return Fail("unterminated array");
+			}
+			if (*m_text == ']')
+			{
+				++m_text;
+				return true;
+			}
+			if (*m_text++ != ',')
+			{
+				return Fail("expected ',' or ']'");
+			}
+		}
+	}
+
+	bool ParseObject(JsonValue& value, int depth)
+	{
+		value.type = JsonValue::Type::Object;
+		++m_text;
+		SkipWhitespace();
+		if (m_text != m_end && *m_text == '}')
+		{
+			++m_text;
+			return true;
+		}
+
+		while (true)
+		{
+			SkipWhitespace();
+			if (m_text == m_end || *m_text != '"')
+			{
+				return Fail("expected member name");
+			}
+
+			value.object.emplace_back();
+			if (!ParseString(value.object.back().first))
+			{
+				return false;
+			}
+
+			SkipWhitespace();
+			if (m_text == m_end || *m_text++ != ':')
+			{
+				return Fail("expected ':'");
+			}
+			if (!ParseValue(value.object.back().second, depth + 1))
+			{
+				return false;
+			}
+
+			SkipWhitespace();
+			if (m_text == m_end)
+			{
+				return Fail("unterminated object");
+			}
+			if (*m_text == '}')
+			{
+				++m_text;
+				return true;
+			}
+			if (*m_text++ != ',')
+			{
+				return Fail("expected ',' or '}'");
+			}
+		}
+	}
+private:
+	const char* m_text;
+	const char* m_end;
+	std::string m_error;
+};
+
+bool ParseJson(const char* text, size_t length, JsonValue& root, std::string& error)
+{
+	JsonReader reader(text, length);
+	if (!reader.ParseValue(root, 0))
+	{
+		error = reader.GetError();
+		return false;
+	}
+	if (!reader.AtEnd())
+	{
+		error = "unexpected data after the document";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+//A parsed JSON value, objects keep their members in file order
+struct JsonValue
+{
+	enum class Type { Null, Bool, Number, String, Array, Object };
+
+	Type type = Type::Null;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> array;
+	std::vector<std::pair<std::string, JsonValue>> object;
+
+	//Returns the member called key, or null if this is not an object or has no such member
+	const JsonValue* Find(const char* key) const;
+
+	//Returns the number stored in member key, or fallback if it is missing or not a number
+	double GetNumber(const char* key, double fallback) const;
+
+	//Returns the string stored in member key, or an empty string
+	std::string GetString(const char* key) const;
+};
+
+//Parses a whole JSON document, returns false and fills error if the text is not valid JSON
+bool ParseJson(const char* text, size_t length, JsonValue& root, std::string& error);
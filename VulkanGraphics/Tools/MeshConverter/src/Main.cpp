@@ -0,0 +1,243 @@
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "GltfImporter.h"
+#include "ObjImporter.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshWriter.h"
+
+//Chooses the packed format that fits the mesh's uvs
+#define VERTEX_FORMAT_AUTO 0xFFFFFFFF
+
+//Returns the extension of the filename in lower case, without the dot
+static std::string GetExtension(const std::string& filename)
+{
+	size_t dot = filename.find_last_of('.');
+	std::string extension = dot == std::string::npos ? "" : filename.substr(dot + 1);
+	for (char& c : extension)
+	{
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+	return extension;
+}
+
+//Picks the importer from the file's extension
+static bool ImportMesh(const std::string& input, ImportedMesh& mesh, std::string& error)
+{
+	std::string extension = GetExtension(input);
+	if (extension == "obj")
+	{
+		return ImportObj(input, mesh, error);
+	}
+	if (extension == "gltf" || extension == "glb")
+	{
+		return ImportGltf(input, mesh, error);
+	}
+
+	error = "unsupported input format ." + extension;
+	return false;
+}
+
+static void PrintUsage()
+{
+	std::cout << "Usage: MeshConverter [options] input.(obj|gltf|glb) output.vmesh\n";
+	std::cout << "       MeshConverter --analyze input...\n";
+	std::cout << "  --vertex-format packed|unorm16|half|float32\n";
+	std::cout << "      packed (default) picks unorm16 uvs when every uv lies inside [0, 1] and half float uvs otherwise\n";
+	std::cout << "  --no-optimize  keeps the source's triangle and vertex order\n";
+	std::cout << "  --meshlets     stores meshlets with culling bounds in the mesh file\n";
+	std::cout << "  --lods N       stores up to N detail levels of every submesh, including full detail (default " << MESH_SIMPLIFIER_MAX_LODS << ", 0 or 1 disables)\n";
+	std::cout << "  --analyze      optimizes every input and prints its ACMR and ATVR before and after, without writing files\n";
+}
+
+//Optimizes every input in memory and prints how the vertex cache statistics change, with the corpus average at the end
+static int AnalyzeCorpus(const std::vector<std::string>& inputs)
+{
+	std::cout << "ACMR and ATVR with a " << MESH_OPTIMIZER_STATISTICS_CACHE_SIZE << " entry FIFO cache\n";
+
+	VertexCacheStatistics totalBefore;
+	VertexCacheStatistics totalAfter;
+	uint32_t analyzed = 0;
+	for (const std::string& input : inputs)
+	{
+		ImportedMesh mesh;
+		std::string error;
+		if (!ImportMesh(input, mesh, error))
+		{
+			std::cout << "  " << input << ": " << error << "\n";
+			continue;
+		}
+
+		VertexCacheStatistics before = AnalyzeVertexCache(mesh);
+		OptimizeMesh(mesh);
+		VertexCacheStatistics after = AnalyzeVertexCache(mesh);
+		std::cout << "  " << input << ": ACMR " << before.acmr << " -> " << after.acmr
+			<< ", ATVR " << before.atvr << " -> " << after.atvr << "\n";
+
+		totalBefore.acmr += before.acmr;
+		totalBefore.atvr += before.atvr;
+		totalAfter.acmr += after.acmr;
+		totalAfter.atvr += after.atvr;
+		++analyzed;
+	}
+
+	if (analyzed == 0)
+	{
+		return 1;
+	}
+	std::cout << "Average of " << analyzed << " meshes: ACMR " << totalBefore.acmr / analyzed << " -> "
+		<< totalAfter.acmr / analyzed << ", ATVR " << totalBefore.atvr / analyzed << " -> " << totalAfter.atvr / analyzed << "\n";
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	/* Reading the command line */
+	uint32_t vertexFormat = VERTEX_FORMAT_AUTO;
+	bool optimize = true;
+	bool meshlets = false;
+	uint32_t lodLevels = MESH_SIMPLIFIER_MAX_LODS;
+	bool analyze = false;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--vertex-format") == 0 && i + 1 < argc)
+		{
+			std::string format = argv[++i];
+			vertexFormat = format == "float32" ? MESH_VERTEX_FORMAT_FLOAT32 :
+				format == "unorm16" ? MESH_VERTEX_FORMAT_PACKED_UNORM16_UV :
+				format == "half" ? MESH_VERTEX_FORMAT_PACKED_HALF_UV : VERTEX_FORMAT_AUTO;
+			if (vertexFormat == VERTEX_FORMAT_AUTO && format != "packed")
+			{
+				PrintUsage();
+				return 1;
+			}
+		}
+		else if (std::strcmp(argv[i], "--no-optimize") == 0)
+		{
+			optimize = false;
+		}
+		else if (std::strcmp(argv[i], "--meshlets") == 0)
+		{
+			meshlets = true;
+		}
+		else if (std::strcmp(argv[i], "--lods") == 0 && i + 1 < argc)
+		{
+			lodLevels = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--analyze") == 0)
+		{
+			analyze = true;
+		}
+		else
+		{
+			files.push_back(argv[i]);
+		}
+	}
+
+	if (analyze && !files.empty())
+	{
+		return AnalyzeCorpus(files);
+	}
+	if (files.size() != 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+	const std::string& input = files[0];
+	const std::string& output = files[1];
+	/* Command line read */
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	ImportedMesh mesh;
+	std::string error;
+	if (!ImportMesh(input, mesh, error))
+	{
+		std::cout << "Failed to import " << input << ": " << error << "\n";
+		return 1;
+	}
+
+	/* Optimizing the mesh for the GPU */
+	VertexCacheStatistics before = AnalyzeVertexCache(mesh);
+	if (optimize)
+	{
+		OptimizeMesh(mesh);
+	}
+
+	//Meshlets are built last, so they start from the optimized triangle order
+	if (meshlets)
+	{
+		BuildMeshlets(mesh);
+	}
+	VertexCacheStatistics after = AnalyzeVertexCache(mesh);
+
+	//Detail levels are appended after the full detail indices, which every statistic below is about
+	size_t fullIndexCount = mesh.indices.size();
+	if (lodLevels > 1)
+	{
+		BuildLods(mesh, lodLevels);
+	}
+	/* Mesh optimized */
+
+	if (vertexFormat == VERTEX_FORMAT_AUTO)
+	{
+		vertexFormat = ChoosePackedVertexFormat(mesh);
+	}
+	if (vertexFormat == MESH_VERTEX_FORMAT_PACKED_UNORM16_UV && ChoosePackedVertexFormat(mesh) != vertexFormat)
+	{
+		std::cout << "Warning: uvs outside [0, 1] are clamped by the unorm16 format\n";
+	}
+
+	MeshWriteStats stats;
+	if (!WriteMeshFile(output, mesh, vertexFormat, stats))
+	{
+		std::cout << "Failed to write " << output << "\n";
+		return 1;
+	}
+
+	double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << input << " -> " << output << "\n";
+	std::cout << "  " << mesh.vertices.size() << " vertices, " << fullIndexCount / 3 << " triangles, "
+		<< mesh.submeshes.size() << " submeshes, " << mesh.meshlets.size() << " meshlets, " << mesh.lods.size() << " detail levels\n";
+	std::cout << "  " << stats.fileSize << " bytes, " << stats.indexSize * 8 << " bit indices, " << elapsedMs << " ms\n";
+	std::cout << "  ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << "\n";
+
+	/* Reporting what the vertex format saves */
+	uint32_t stride = GetMeshVertexStride(vertexFormat);
+	uint64_t unpackedSize = mesh.vertices.size() * sizeof(MeshVertex);
+	std::cout << "  Vertex data: " << stats.vertexDataSize << " bytes at " << stride << " bytes per vertex ("
+		<< unpackedSize << " bytes unpacked, " << 100.0 - 100.0 * stats.vertexDataSize / unpackedSize << "% saved)\n";
+
+	//Without a vertex cache every index fetches a vertex, with a perfect one every vertex is fetched once
+	std::cout << "  Vertex fetch per draw: " << mesh.vertices.size() * stride << " to " << fullIndexCount * stride
+		<< " bytes (" << mesh.vertices.size() * sizeof(MeshVertex) << " to " << fullIndexCount * sizeof(MeshVertex)
+		<< " bytes unpacked)\n";
+
+	if (vertexFormat != MESH_VERTEX_FORMAT_FLOAT32)
+	{
+		std::cout << "  Max error: position " << stats.quantizationError.maxPositionError << ", normal "
+			<< stats.quantizationError.maxNormalError << " degrees, uv " << stats.quantizationError.maxUvError << "\n";
+	}
+	/* Savings reported */
+
+	for (size_t s = 0; s < mesh.submeshes.size() && mesh.lods.size() > mesh.submeshes.size(); ++s)
+	{
+		const ImportedSubmesh& submesh = mesh.submeshes[s];
+		std::cout << "  Submesh " << s << " detail levels:";
+		for (uint32_t level = 0; level < submesh.lodCount; ++level)
+		{
+			const MeshFileLod& lod = mesh.lods[submesh.firstLod + level];
+			std::cout << " " << lod.indexCount / 3 << " (error " << lod.error << ")";
+		}
+		std::cout << "\n";
+	}
+
+	return 0;
+}
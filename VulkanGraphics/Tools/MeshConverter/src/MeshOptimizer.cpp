@@ -0,0 +1,598 @@
+#include "MeshOptimizer.h"
+#include "EngineCore/Math/VectorMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+//Scoring constants of Tom Forsyth's linear speed vertex cache optimization
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+
+#define OPTIMIZER_INVALID_INDEX 0xFFFFFFFF
+
+//Models a FIFO post transform cache, vertices are cached if they were inserted less than a cache size of misses ago
+struct FifoCacheSimulator
+{
+	std::vector<uint32_t> insertionTimes;
+	uint32_t cacheSize;
+	uint32_t time;
+
+	FifoCacheSimulator(size_t vertexCount, uint32_t size)
+		:insertionTimes(vertexCount, 0), cacheSize{size}, time{size + 1}
+	{
+
+	}
+
+	//Returns true if the vertex had to be transformed
+	bool Access(uint32_t vertex)
+	{
+		if (time - insertionTimes[vertex] > cacheSize)
+		{
+			insertionTimes[vertex] = time++;
+			return true;
+		}
+		return false;
+	}
+
+	void Flush()
+	{
+		time += cacheSize + 1;
+	}
+};
+
+static Vec3 GetPosition(const ImportedMesh& mesh, uint32_t vertex)
+{
+	const float* position = mesh.vertices[vertex].position;
+	return { position[0], position[1], position[2] };
+}
+
+//Returns the unnormalized normal of a triangle, its length is twice the triangle's area
+static Vec3 GetTriangleNormal(const ImportedMesh& mesh, const uint32_t* triangle)
+{
+	Vec3 p0 = GetPosition(mesh, triangle[0]);
+	return Cross(GetPosition(mesh, triangle[1]) - p0, GetPosition(mesh, triangle[2]) - p0);
+}
+
+VertexCacheStatistics AnalyzeVertexCache(const ImportedMesh& mesh)
+{
+	VertexCacheStatistics statistics;
+	if (mesh.indices.empty() || mesh.vertices.empty())
+	{
+		return statistics;
+	}
+
+	//Every submesh is its own draw, so nothing stays cached between them
+	FifoCacheSimulator cache(mesh.vertices.size(), MESH_OPTIMIZER_STATISTICS_CACHE_SIZE);
+	uint64_t misses = 0;
+	for (const ImportedSubmesh& submesh : mesh.submeshes)
+	{
+		cache.Flush();
+		for (uint32_t i = submesh.firstIndex; i < submesh.firstIndex + submesh.indexCount; ++i)
+		{
+			misses += cache.Access(mesh.indices[i]) ? 1 : 0;
+		}
+	}
+
+	statistics.acmr = static_cast<float>(misses) / static_cast<float>(mesh.indices.size() / 3);
+	statistics.atvr = static_cast<float>(misses) / static_cast<float>(mesh.vertices.size());
+	return statistics;
+}
+
+static float ForsythVertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+{
+	//Vertices without triangles left are never picked again
+	if (remainingTriangles == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		//The last triangle's vertices get a fixed score, so the next triangle does not just reuse the same edge
+		if (cachePosition < 3)
+		{
+			score = FORSYTH_LAST_TRIANGLE_SCORE;
+		}
+		else
+		{
+			float scaler = 1.0f / (MESH_OPTIMIZER_CACHE_SIZE - 3);
+			score = std::pow(1.0f - (cachePosition - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+		}
+	}
+
+	//Vertices with few triangles left are finished first, so they do not have to be transformed again later
+	return score + FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -FORSYTH_VALENCE_BOOST_POWER);
+}
+
+/******************************************************************************
+* Function Argument 1: The indices of one submesh, reordered in place		  *
+* Function Argument 2: The amount of indices								  *
+* Function Argument 3: The amount of vertices of the whole mesh				  *
+******************************************************************************/
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	/* Building the vertex to triangle adjacency */
+	std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i)
+	{
+		++remainingTriangles[indices[i]];
+	}
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remainingTriangles[v];
+	}
+
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> fillCounts(vertexCount, 0);
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			uint32_t vertex = indices[t * 3 + corner];
+			adjacency[adjacencyOffsets[vertex] + fillCounts[vertex]++] = static_cast<uint32_t>(t);
+		}
+	}
+	/* Adjacency built */
+
+	/* Scoring every vertex and triangle */
+	std::vector<int32_t> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount, 0.0f);
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		vertexScores[v] = ForsythVertexScore(-1, remainingTriangles[v]);
+	}
+
+	std::vector<float> triangleScores(triangleCount, 0.0f);
+	uint32_t bestTriangle = 0;
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+		if (triangleScores[t] > triangleScores[bestTriangle])
+		{
+			bestTriangle = static_cast<uint32_t>(t);
+		}
+	}
+	/* Scoring complete */
+
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	size_t fallbackCursor = 0;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+	{
+		//When no cached vertex has triangles left, the next triangle is taken in the original order
+		if (bestTriangle == OPTIMIZER_INVALID_INDEX)
+		{
+			while (emitted[fallbackCursor])
+			{
+				++fallbackCursor;
+			}
+			bestTriangle = static_cast<uint32_t>(fallbackCursor);
+		}
+
+		/* Emitting the best triangle */
+		const uint32_t* triangle = indices + bestTriangle * 3;
+		emitted[bestTriangle] = true;
+		newCache.clear();
+		for (uint32_t corner = 0; corner < 3; ++corner)
+		{
+			uint32_t vertex = triangle[corner];
+			output.push_back(vertex);
+			if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+			{
+				newCache.push_back(vertex);
+			}
+
+			//Swapping the triangle out of the vertex's active adjacency range
+			uint32_t* begin = adjacency.data() + adjacencyOffsets[vertex];
+			uint32_t* end = begin + remainingTriangles[vertex];
+			uint32_t* found = std::find(begin, end, bestTriangle);
+			if (found != end)
+			{
+				std::swap(*found, *(end - 1));
+				--remainingTriangles[vertex];
+			}
+		}
+		/* Triangle emitted */
+
+		//The triangle's vertices move to the front of the LRU cache, pushing the others back
+		for (uint32_t vertex : cache)
+		{
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+			{
+				newCache.push_back(vertex);
+			}
+		}
+
+		/* Updating the scores of the vertices whose cache position changed */
+		for (size_t i = 0; i < newCache.size(); ++i)
+		{
+			uint32_t vertex = newCache[i];
+			cachePositions[vertex] = i < MESH_OPTIMIZER_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+
+			float score = ForsythVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+			float delta = score - vertexScores[vertex];
+			vertexScores[vertex] = score;
+			for (uint32_t a = 0; a < remainingTriangles[vertex]; ++a)
+			{
+				triangleScores[adjacency[adjacencyOffsets[vertex] + a]] += delta;
+			}
+		}
+		if (newCache.size() > MESH_OPTIMIZER_CACHE_SIZE)
+		{
+			newCache.resize(MESH_OPTIMIZER_CACHE_SIZE);
+		}
+		std::swap(cache, newCache);
+		/* Scores updated */
+
+		//Only triangles touching the cache can have gained score, so the best one is searched for among them
+		bestTriangle = OPTIMIZER_INVALID_INDEX;
+		float bestScore = -1.0f;
+		for (uint32_t vertex : cache)
+		{
+			for (uint32_t a = 0; a < remainingTriangles[vertex]; ++a)
+			{
+				uint32_t candidate = adjacency[adjacencyOffsets[vertex] + a];
+				if (triangleScores[candidate] > bestScore)
+				{
+					bestScore = triangleScores[candidate];
+					bestTriangle = candidate;
+				}
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+//A range of triangles moved as a whole by the overdraw sort
+struct TriangleCluster
+{
+	size_t firstTriangle;
+	size_t triangleCount;
+	float sortKey;
+};
+
+/******************************************************************************
+* Function Argument 1: The mesh the submesh belongs to						  *
+* Function Argument 2: The first index of the submesh						  *
+* Function Argument 3: The amount of indices of the submesh					  *
+******************************************************************************/
+static void OptimizeOverdraw(ImportedMesh& mesh, uint32_t firstIndex, uint32_t indexCount)
+{
+	uint32_t* indices = mesh.indices.data() + firstIndex;
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount < 2)
+	{
+		return;
+	}
+
+	/* Splitting the cache optimized order into clusters */
+	//Hard boundaries are triangles that miss the cache on every vertex, so starting a cluster there costs nothing
+	FifoCacheSimulator cache(mesh.vertices.size(), MESH_OPTIMIZER_STATISTICS_CACHE_SIZE);
+	std::vector<size_t> hardBoundaries = { 0 };
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		uint32_t misses = 0;
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			misses += cache.Access(indices[t * 3 + corner]) ? 1 : 0;
+		}
+		if (misses == 3 && t > 0)
+		{
+			hardBoundaries.push_back(t);
+		}
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	//Soft boundaries split a hard cluster once the part before them is close enough to the cluster's own ACMR
+	std::vector<TriangleCluster> clusters;
+	for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h)
+	{
+		size_t begin = hardBoundaries[h];
+		size_t end = hardBoundaries[h + 1];
+
+		cache.Flush();
+		uint32_t clusterMisses = 0;
+		for (size_t i = begin * 3; i < end * 3; ++i)
+		{
+			clusterMisses += cache.Access(indices[i]) ? 1 : 0;
+		}
+		float targetAcmr = MESH_OPTIMIZER_OVERDRAW_THRESHOLD * clusterMisses / static_cast<float>(end - begin);
+
+		cache.Flush();
+		size_t start = begin;
+		uint32_t misses = 0;
+		for (size_t t = begin; t < end; ++t)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				misses += cache.Access(indices[t * 3 + corner]) ? 1 : 0;
+			}
+			if (t + 1 == end || misses / static_cast<float>(t + 1 - start) <= targetAcmr)
+			{
+				clusters.push_back({ start, t + 1 - start, 0.0f });
+				start = t + 1;
+				misses = 0;
+				cache.Flush();
+			}
+		}
+	}
+	/* Clusters split */
+
+	/* Sorting the clusters by how likely they are to occlude the rest of the submesh */
+	Vec3 submeshCentroid;
+	float submeshArea = 0.0f;
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		const uint32_t* triangle = indices + t * 3;
+		float area = Length(GetTriangleNormal(mesh, triangle));
+		submeshCentroid = submeshCentroid + (GetPosition(mesh, triangle[0]) + GetPosition(mesh, triangle[1]) + GetPosition(mesh, triangle[2])) * (area / 3.0f);
+		submeshArea += area;
+	}
+	submeshCentroid = submeshArea > 0.0f ? submeshCentroid * (1.0f / submeshArea) : submeshCentroid;
+
+	//Clusters far out along their own facing direction are visible from most views and occlude the rest, so they go first
+	for (TriangleCluster& cluster : clusters)
+	{
+		Vec3 centroid;
+		Vec3 normal;
+		float area = 0.0f;
+		for (size_t t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.triangleCount; ++t)
+		{
+			const uint32_t* triangle = indices + t * 3;
+			Vec3 triangleNormal = GetTriangleNormal(mesh, triangle);
+			float triangleArea = Length(triangleNormal);
+			centroid = centroid + (GetPosition(mesh, triangle[0]) + GetPosition(mesh, triangle[1]) + GetPosition(mesh, triangle[2])) * (triangleArea / 3.0f);
+			normal = normal + triangleNormal;
+			area += triangleArea;
+		}
+		centroid = area > 0.0f ? centroid * (1.0f / area) : centroid;
+		cluster.sortKey = Dot(centroid - submeshCentroid, Normalize(normal));
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const TriangleCluster& a, const TriangleCluster& b)
+	{
+		return a.sortKey > b.sortKey;
+	});
+	/* Clusters sorted */
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(indexCount);
+	for (const TriangleCluster& cluster : clusters)
+	{
+		sorted.insert(sorted.end(), indices + cluster.firstTriangle * 3, indices + (cluster.firstTriangle + cluster.triangleCount) * 3);
+	}
+	std::copy(sorted.begin(), sorted.end(), indices);
+}
+
+//Renumbers the vertices in the order the indices first use them and drops the ones no triangle uses
+static void RemapVertexFetch(ImportedMesh& mesh)
+{
+	std::vector<uint32_t> remap(mesh.vertices.size(), OPTIMIZER_INVALID_INDEX);
+	std::vector<MeshVertex> vertices;
+	vertices.reserve(mesh.vertices.size());
+	for (uint32_t& index : mesh.indices)
+	{
+		if (remap[index] == OPTIMIZER_INVALID_INDEX)
+		{
+			remap[index] = static_cast<uint32_t>(vertices.size());
+			vertices.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+	mesh.vertices.swap(vertices);
+}
+
+void OptimizeMesh(ImportedMesh& mesh)
+{
+	for (const ImportedSubmesh& submesh : mesh.submeshes)
+	{
+		OptimizeVertexCache(mesh.indices.data() + submesh.firstIndex, submesh.indexCount, mesh.vertices.size());
+		OptimizeOverdraw(mesh, submesh.firstIndex, submesh.indexCount);
+	}
+	RemapVertexFetch(mesh);
+}
+
+/******************************************************************************
+* Function Argument 1: The mesh the meshlet's indices and vertices belong to  *
+* Function Argument 2: The meshlet, with its index range already filled	  *
+* Function Argument 3: The unique vertices of the meshlet					  *
+******************************************************************************/
+static void ComputeMeshletBounds(const ImportedMesh& mesh, MeshFileMeshlet& meshlet, const std::vector<uint32_t>& vertices)
+{
+	/* Bounding sphere around the center of the vertices' box */
+	Vec3 boxMin = GetPosition(mesh, vertices[0]);
+	Vec3 boxMax = boxMin;
+	for (uint32_t vertex : vertices)
+	{
+		Vec3 position = GetPosition(mesh, vertex);
+		boxMin = { std::min(boxMin.x, position.x), std::min(boxMin.y, position.y), std::min(boxMin.z, position.z) };
+		boxMax = { std::max(boxMax.x, position.x), std::max(boxMax.y, position.y), std::max(boxMax.z, position.z) };
+	}
+	Vec3 center = (boxMin + boxMax) * 0.5f;
+	float radius = 0.0f;
+	for (uint32_t vertex : vertices)
+	{
+		radius = std::max(radius, Length(GetPosition(mesh, vertex) - center));
+	}
+	/* Sphere computed */
+
+	/* Normal cone around the average triangle normal */
+	const uint32_t* indices = mesh.indices.data() + meshlet.firstIndex;
+	Vec3 axis;
+	for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+	{
+		axis = axis + Normalize(GetTriangleNormal(mesh, indices + t * 3));
+	}
+	axis = Normalize(axis);
+
+	float minimumDot = 1.0f;
+	for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+	{
+		Vec3 normal = GetTriangleNormal(mesh, indices + t * 3);
+		if (Length(normal) > 0.0f)
+		{
+			minimumDot = std::min(minimumDot, Dot(axis, Normalize(normal)));
+		}
+	}
+	/* Cone computed */
+
+	meshlet.center[0] = center.x;
+	meshlet.center[1] = center.y;
+	meshlet.center[2] = center.z;
+	meshlet.radius = radius;
+	meshlet.coneAxis[0] = axis.x;
+	meshlet.coneAxis[1] = axis.y;
+	meshlet.coneAxis[2] = axis.z;
+	//If some triangle faces 90 degrees or more away from the axis, the cone would cover every view
+	meshlet.coneCutoff = minimumDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minimumDot * minimumDot);
+}
+
+/*******************************************************************************
+* Function Argument 1: The mesh whose submesh is split, its indices are		   *
+*					   reordered so every meshlet is a contiguous range		   *
+* Function Argument 2: The index of the submesh								   *
+* Function Argument 3: The meshlet each vertex was last added to			   *
+*******************************************************************************/
+static void BuildSubmeshMeshlets(ImportedMesh& mesh, uint32_t submeshIndex, std::vector<uint32_t>& vertexMeshlet)
+{
+	const ImportedSubmesh& submesh = mesh.submeshes[submeshIndex];
+	const uint32_t* indices = mesh.indices.data() + submesh.firstIndex;
+	size_t triangleCount = submesh.indexCount / 3;
+
+	/* Building the vertex to triangle adjacency */
+	std::vector<uint32_t> adjacencyOffsets(mesh.vertices.size() + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i)
+	{
+		++adjacencyOffsets[indices[i] + 1];
+	}
+	for (size_t v = 0; v < mesh.vertices.size(); ++v)
+	{
+		adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> fillCounts(mesh.vertices.size(), 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i)
+	{
+		adjacency[adjacencyOffsets[indices[i]] + fillCounts[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+	/* Adjacency built */
+
+	std::vector<bool> used(triangleCount, false);
+	std::vector<uint32_t> reordered;
+	reordered.reserve(triangleCount * 3);
+	std::vector<uint32_t> meshletVertices;
+	size_t cursor = 0;
+
+	while (reordered.size() < triangleCount * 3)
+	{
+		uint32_t meshletIndex = static_cast<uint32_t>(mesh.meshlets.size());
+		MeshFileMeshlet meshlet{};
+		meshlet.firstIndex = submesh.firstIndex + static_cast<uint32_t>(reordered.size());
+		meshlet.submeshIndex = submeshIndex;
+		meshletVertices.clear();
+
+		//Every meshlet starts from the first unused triangle in the optimized order
+		while (used[cursor])
+		{
+			++cursor;
+		}
+		uint32_t next = static_cast<uint32_t>(cursor);
+
+		while (next != OPTIMIZER_INVALID_INDEX)
+		{
+			/* Adding the triangle to the meshlet */
+			used[next] = true;
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				uint32_t vertex = indices[next * 3 + corner];
+				reordered.push_back(vertex);
+				if (vertexMeshlet[vertex] != meshletIndex)
+				{
+					vertexMeshlet[vertex] = meshletIndex;
+					meshletVertices.push_back(vertex);
+				}
+			}
+			++meshlet.triangleCount;
+			/* Triangle added */
+
+			if (meshlet.triangleCount == MESH_MESHLET_MAX_TRIANGLES)
+			{
+				break;
+			}
+
+			//The meshlet grows through the triangle that adds the fewest new vertices, which keeps it compact,
+			//ties are broken by the optimized order so the vertex cache order is mostly kept
+			next = OPTIMIZER_INVALID_INDEX;
+			uint32_t fewestNewVertices = 3;
+			for (uint32_t vertex : meshletVertices)
+			{
+				for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; ++a)
+				{
+					uint32_t candidate = adjacency[a];
+					if (used[candidate])
+					{
+						continue;
+					}
+
+					uint32_t newVertices = 0;
+					for (uint32_t corner = 0; corner < 3; ++corner)
+					{
+						newVertices += vertexMeshlet[indices[candidate * 3 + corner]] != meshletIndex ? 1 : 0;
+					}
+					if (meshletVertices.size() + newVertices <= MESH_MESHLET_MAX_VERTICES &&
+						(next == OPTIMIZER_INVALID_INDEX || newVertices < fewestNewVertices ||
+						(newVertices == fewestNewVertices && candidate < next)))
+					{
+						next = candidate;
+						fewestNewVertices = newVertices;
+					}
+				}
+			}
+		}
+
+		meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+		mesh.meshlets.push_back(meshlet);
+	}
+
+	std::copy(reordered.begin(), reordered.end(), mesh.indices.begin() + submesh.firstIndex);
+}
+
+void BuildMeshlets(ImportedMesh& mesh)
+{
+	mesh.meshlets.clear();
+
+	//Holds the index of the meshlet each vertex was last added to, so shared vertices are only counted once
+	std::vector<uint32_t> vertexMeshlet(mesh.vertices.size(), OPTIMIZER_INVALID_INDEX);
+	for (uint32_t s = 0; s < mesh.submeshes.size(); ++s)
+	{
+		BuildSubmeshMeshlets(mesh, s, vertexMeshlet);
+	}
+
+	//The triangles moved, so the vertices are renumbered again and the meshlet bounds are computed on the final order
+	RemapVertexFetch(mesh);
+	std::vector<uint32_t> meshletVertices;
+	for (MeshFileMeshlet& meshlet : mesh.meshlets)
+	{
+		meshletVertices.assign(mesh.indices.begin() + meshlet.firstIndex,
+			mesh.indices.begin() + meshlet.firstIndex + meshlet.triangleCount * 3);
+		std::sort(meshletVertices.begin(), meshletVertices.end());
+		meshletVertices.erase(std::unique(meshletVertices.begin(), meshletVertices.end()), meshletVertices.end());
+		ComputeMeshletBounds(mesh, meshlet, meshletVertices);
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "ImportedMesh.h"
+
+//Size of the FIFO cache the statistics are simulated with, a typical post transform cache
+#define MESH_OPTIMIZER_STATISTICS_CACHE_SIZE 16
+
+//Size of the LRU cache the vertex cache optimization models
+#define MESH_OPTIMIZER_CACHE_SIZE 32
+
+//How much worse than the cache optimized order (in ACMR) a cluster may be after overdraw sorting splits it
+#define MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+//Average vertex shader invocations per triangle (ACMR) and per vertex (ATVR), 0.5 and 1.0 are the best possible
+struct VertexCacheStatistics
+{
+	float acmr = 0.0f;
+	float atvr = 0.0f;
+};
+
+//Simulates a FIFO post transform cache over the mesh's indices
+VertexCacheStatistics AnalyzeVertexCache(const ImportedMesh& mesh);
+
+/*************************************************************
+* Reorders the triangles of every submesh for the vertex	 *
+* cache, then reorders clusters of them so likely occluders  *
+* are drawn first, and finally renumbers the vertices in the *
+* order they are first used. Submesh ranges are kept, so	 *
+* the engine draws the result exactly as before				 *
+*************************************************************/
+void OptimizeMesh(ImportedMesh& mesh);
+
+//Reorders the triangles of an index range for the vertex cache, without moving any vertex
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+//Splits every submesh into meshlets of at most MESH_MESHLET_MAX_VERTICES and MESH_MESHLET_MAX_TRIANGLES,
+//with the bounds and normal cones used to cull them. Triangles are regrouped so each meshlet is a contiguous index range
+void BuildMeshlets(ImportedMesh& mesh);
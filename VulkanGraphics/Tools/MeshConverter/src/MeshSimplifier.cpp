@@ -0,0 +1,393 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "EngineCore/Math/VectorMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+//Triangles whose normal would turn by more than this (as a cosine) are treated as flipped
+#define SIMPLIFIER_FLIP_COSINE 0.2f
+
+//Collapse passes are repeated until the target is met or a pass cannot collapse anything
+#define SIMPLIFIER_MAX_PASSES 64
+
+/**************************************************************
+* The sum of squared distances to a set of planes, weighted	  *
+* by the area of the triangles they came from. Stored as the  *
+* upper triangle of the symmetric 4x4 matrix of Garland and	  *
+* Heckbert's quadric error metric							  *
+**************************************************************/
+struct Quadric
+{
+	double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+	double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+	double a22 = 0.0, a23 = 0.0;
+	double a33 = 0.0;
+	double weight = 0.0;
+
+	void AddPlane(const Vec3& normal, double distance, double planeWeight)
+	{
+		double x = normal.x, y = normal.y, z = normal.z;
+		a00 += planeWeight * x * x; a01 += planeWeight * x * y; a02 += planeWeight * x * z; a03 += planeWeight * x * distance;
+		a11 += planeWeight * y * y; a12 += planeWeight * y * z; a13 += planeWeight * y * distance;
+		a22 += planeWeight * z * z; a23 += planeWeight * z * distance;
+		a33 += planeWeight * distance * distance;
+		weight += planeWeight;
+	}
+
+	void Add(const Quadric& other)
+	{
+		a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+		a11 += other.a11; a12 += other.a12; a13 += other.a13;
+		a22 += other.a22; a23 += other.a23;
+		a33 += other.a33;
+		weight += other.weight;
+	}
+
+	//Returns the weighted sum of squared distances from the point to every plane
+	double Evaluate(const Vec3& p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		return a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x +
+			a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y +
+			a22 * z * z + 2.0 * a23 * z + a33;
+	}
+};
+
+//A vertex merged into another, with the error of moving it there
+struct EdgeCollapse
+{
+	uint32_t source;
+	uint32_t target;
+	double error;
+};
+
+static Vec3 GetVertexPosition(const ImportedMesh& mesh, uint32_t vertex)
+{
+	const float* position = mesh.vertices[vertex].position;
+	return { position[0], position[1], position[2] };
+}
+
+//Gives every vertex the index of the first vertex with the same position, so split vertices are recognized as one point
+static void BuildPositionRemap(const ImportedMesh& mesh, std::vector<uint32_t>& remap)
+{
+	struct PositionHash
+	{
+		size_t operator()(const Vec3& p) const
+		{
+			uint32_t bits[3];
+			std::memcpy(bits, &p, sizeof(bits));
+			return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+		}
+	};
+	struct PositionEqual
+	{
+		bool operator()(const Vec3& a, const Vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+	};
+
+	std::unordered_map<Vec3, uint32_t, PositionHash, PositionEqual> firstVertices;
+	remap.resize(mesh.vertices.size());
+	for (uint32_t v = 0; v < mesh.vertices.size(); ++v)
+	{
+		remap[v] = firstVertices.emplace(GetVertexPosition(mesh, v), v).first->second;
+	}
+}
+
+/****************************************************************************
+* Function Argument 1: The mesh whose vertices are referenced				*
+* Function Argument 2: The indices being simplified							*
+* Function Argument 3: The position remap from BuildPositionRemap			*
+* Function Argument 4: Set for vertices that must not move: the ones on a	*
+*					   border of the surface and the ones split by seams	*
+****************************************************************************/
+static void FindLockedVertices(const ImportedMesh& mesh, const std::vector<uint32_t>& indices,
+	const std::vector<uint32_t>& positionRemap, std::vector<bool>& locked)
+{
+	locked.assign(mesh.vertices.size(), false);
+
+	//Vertices sharing a position with a different vertex carry a seam in their normals or uvs
+	std::vector<uint32_t> seamCounts(mesh.vertices.size(), 0);
+	std::vector<bool> counted(mesh.vertices.size(), false);
+	for (uint32_t index : indices)
+	{
+		if (!counted[index])
+		{
+			counted[index] = true;
+			++seamCounts[positionRemap[index]];
+		}
+	}
+
+	//Edges of the surface, counted by position so seams do not look like borders. Borders are used by one triangle only
+	std::unordered_map<uint64_t, uint32_t> edgeCounts;
+	for (size_t t = 0; t + 2 < indices.size(); t += 3)
+	{
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			uint64_t a = positionRemap[indices[t + corner]];
+			uint64_t b = positionRemap[indices[t + (corner + 1) % 3]];
+			++edgeCounts[std::min(a, b) << 32 | std::max(a, b)];
+		}
+	}
+
+	for (uint32_t index : indices)
+	{
+		if (seamCounts[positionRemap[index]] > 1)
+		{
+			locked[index] = true;
+		}
+	}
+	for (size_t t = 0; t + 2 < indices.size(); t += 3)
+	{
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			uint32_t a = indices[t + corner];
+			uint32_t b = indices[t + (corner + 1) % 3];
+			uint64_t pa = positionRemap[a];
+			uint64_t pb = positionRemap[b];
+			if (edgeCounts[std::min(pa, pb) << 32 | std::max(pa, pb)] == 1)
+			{
+				locked[a] = locked[b] = true;
+			}
+		}
+	}
+}
+
+/*********************************************************************************
+* Function Argument 1: The mesh whose vertices are referenced					 *
+* Function Argument 2: The current indices, the collapse is not applied to them	 *
+* Function Argument 3: The start of every vertex's range in adjacency			 *
+* Function Argument 4: The triangles around every vertex						 *
+* Function Argument 5: The collapse that is checked								 *
+*********************************************************************************/
+static bool CollapseFlipsTriangle(const ImportedMesh& mesh, const std::vector<uint32_t>& indices,
+	const std::vector<uint32_t>& adjacencyOffsets, const std::vector<uint32_t>& adjacency, const EdgeCollapse& collapse)
+{
+	Vec3 target = GetVertexPosition(mesh, collapse.target);
+	for (uint32_t a = adjacencyOffsets[collapse.source]; a < adjacencyOffsets[collapse.source + 1]; ++a)
+	{
+		const uint32_t* triangle = indices.data() + adjacency[a] * 3;
+
+		//Triangles on the collapsed edge disappear, so they cannot flip
+		if (triangle[0] == collapse.target || triangle[1] == collapse.target || triangle[2] == collapse.target)
+		{
+			continue;
+		}
+
+		Vec3 before[3];
+		Vec3 after[3];
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			before[corner] = GetVertexPosition(mesh, triangle[corner]);
+			after[corner] = triangle[corner] == collapse.source ? target : before[corner];
+		}
+		Vec3 normalBefore = Cross(before[1] - before[0], before[2] - before[0]);
+		Vec3 normalAfter = Cross(after[1] - after[0], after[2] - after[0]);
+		if (Dot(normalBefore, normalAfter) <= SIMPLIFIER_FLIP_COSINE * Length(normalBefore) * Length(normalAfter))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/****************************************************************************
+* Function Argument 1: The mesh whose vertices are referenced				*
+* Function Argument 2: The triangles to simplify							*
+* Function Argument 3: Stop once this many indices or fewer are left		*
+* Function Argument 4: Filled with the simplified triangles					*
+****************************************************************************/
+float SimplifyIndices(const ImportedMesh& mesh, const std::vector<uint32_t>& indices, size_t targetIndexCount,
+	std::vector<uint32_t>& output)
+{
+	output = indices;
+	size_t vertexCount = mesh.vertices.size();
+
+	std::vector<uint32_t> positionRemap;
+	BuildPositionRemap(mesh, positionRemap);
+	std::vector<bool> locked;
+	FindLockedVertices(mesh, indices, positionRemap, locked);
+
+	/* Accumulating the planes of every vertex's triangles */
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t t = 0; t + 2 < indices.size(); t += 3)
+	{
+		Vec3 p0 = GetVertexPosition(mesh, indices[t]);
+		Vec3 normal = Cross(GetVertexPosition(mesh, indices[t + 1]) - p0, GetVertexPosition(mesh, indices[t + 2]) - p0);
+		float area = Length(normal) * 0.5f;
+		if (area <= 0.0f)
+		{
+			continue;
+		}
+		normal = Normalize(normal);
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			quadrics[indices[t + corner]].AddPlane(normal, -Dot(normal, p0), area);
+		}
+	}
+	/* Planes accumulated */
+
+	double maxError = 0.0;
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<EdgeCollapse> collapses;
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<bool> touched(vertexCount);
+
+	for (uint32_t pass = 0; pass < SIMPLIFIER_MAX_PASSES && output.size() > targetIndexCount; ++pass)
+	{
+		/* Building the vertex to triangle adjacency of the current triangles */
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t index : output)
+		{
+			++adjacencyOffsets[index + 1];
+		}
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		}
+		adjacency.resize(output.size());
+		std::vector<uint32_t> fillCounts(vertexCount, 0);
+		for (size_t i = 0; i < output.size(); ++i)
+		{
+			adjacency[adjacencyOffsets[output[i]] + fillCounts[output[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+		/* Adjacency built */
+
+		/* Ranking every possible collapse by the error it introduces */
+		collapses.clear();
+		for (size_t t = 0; t + 2 < output.size(); t += 3)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				uint32_t a = output[t + corner];
+				uint32_t b = output[t + (corner + 1) % 3];
+				for (int direction = 0; direction < 2; ++direction)
+				{
+					uint32_t source = direction == 0 ? a : b;
+					uint32_t target = direction == 0 ? b : a;
+					if (locked[source])
+					{
+						continue;
+					}
+
+					Quadric combined = quadrics[source];
+					combined.Add(quadrics[target]);
+					double error = combined.weight > 0.0 ? combined.Evaluate(GetVertexPosition(mesh, target)) / combined.weight : 0.0;
+					collapses.push_back({ source, target, std::max(error, 0.0) });
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const EdgeCollapse& a, const EdgeCollapse& b)
+		{
+			return a.error < b.error;
+		});
+		/* Collapses ranked */
+
+		/* Applying the cheapest collapses that do not overlap */
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			remap[v] = v;
+		}
+		std::fill(touched.begin(), touched.end(), false);
+		size_t triangleCount = output.size() / 3;
+		size_t removedTriangles = 0;
+		size_t appliedCollapses = 0;
+
+		for (const EdgeCollapse& collapse : collapses)
+		{
+			if (touched[collapse.source] || touched[collapse.target] ||
+				CollapseFlipsTriangle(mesh, output, adjacencyOffsets, adjacency, collapse))
+			{
+				continue;
+			}
+
+			//Every vertex of the triangles around the source changes shape, so none of them may collapse in this pass
+			for (uint32_t a = adjacencyOffsets[collapse.source]; a < adjacencyOffsets[collapse.source + 1]; ++a)
+			{
+				const uint32_t* triangle = output.data() + adjacency[a] * 3;
+				bool removed = false;
+				for (int corner = 0; corner < 3; ++corner)
+				{
+					touched[triangle[corner]] = true;
+					removed = removed || triangle[corner] == collapse.target;
+				}
+				removedTriangles += removed ? 1 : 0;
+			}
+
+			remap[collapse.source] = collapse.target;
+			quadrics[collapse.target].Add(quadrics[collapse.source]);
+			maxError = std::max(maxError, collapse.error);
+			++appliedCollapses;
+
+			if ((triangleCount - removedTriangles) * 3 <= targetIndexCount)
+			{
+				break;
+			}
+		}
+
+		if (appliedCollapses == 0)
+		{
+			break;
+		}
+		/* Collapses applied */
+
+		//Dropping the triangles that lost an edge
+		size_t written = 0;
+		for (size_t t = 0; t + 2 < output.size(); t += 3)
+		{
+			uint32_t a = remap[output[t]];
+			uint32_t b = remap[output[t + 1]];
+			uint32_t c = remap[output[t + 2]];
+			if (a != b && b != c && a != c)
+			{
+				output[written++] = a;
+				output[written++] = b;
+				output[written++] = c;
+			}
+		}
+		output.resize(written);
+	}
+
+	//The quadric error is a squared distance, averaged over the area of the planes it was built from
+	return static_cast<float>(std::sqrt(maxError));
+}
+
+void BuildLods(ImportedMesh& mesh, uint32_t maxLevels)
+{
+	mesh.lods.clear();
+	std::vector<uint32_t> fullDetail;
+	std::vector<uint32_t> simplified;
+
+	for (ImportedSubmesh& submesh : mesh.submeshes)
+	{
+		submesh.firstLod = static_cast<uint32_t>(mesh.lods.size());
+		submesh.lodCount = 1;
+		mesh.lods.push_back({ submesh.firstIndex, submesh.indexCount, 0.0f, 0 });
+
+		fullDetail.assign(mesh.indices.begin() + submesh.firstIndex, mesh.indices.begin() + submesh.firstIndex + submesh.indexCount);
+		size_t previousCount = fullDetail.size();
+		float previousError = 0.0f;
+
+		for (uint32_t level = 1; level < maxLevels; ++level)
+		{
+			//Every level is simplified from full detail, so its error is measured against the original surface
+			size_t target = static_cast<size_t>(previousCount * MESH_SIMPLIFIER_LOD_REDUCTION) / 3 * 3;
+			float error = SimplifyIndices(mesh, fullDetail, target, simplified);
+			if (simplified.empty() || simplified.size() > previousCount * MESH_SIMPLIFIER_MIN_PROGRESS)
+			{
+				break;
+			}
+
+			OptimizeVertexCache(simplified.data(), simplified.size(), mesh.vertices.size());
+
+			//Coarser levels must never report less error than finer ones, or the selection could skip back and forth
+			previousError = std::max(error, previousError);
+			mesh.lods.push_back({ static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(simplified.size()), previousError, 0 });
+			mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.end());
+			previousCount = simplified.size();
+			++submesh.lodCount;
+		}
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ImportedMesh.h"
+
+//Most detail levels a submesh gets, including full detail
+#define MESH_SIMPLIFIER_MAX_LODS 5
+
+//Every level targets this fraction of the previous level's triangles
+#define MESH_SIMPLIFIER_LOD_REDUCTION 0.5f
+
+//A level that keeps more than this fraction of the previous level's triangles is not worth storing, and ends the chain
+#define MESH_SIMPLIFIER_MIN_PROGRESS 0.8f
+
+/******************************************************************
+* Collapses edges of the triangles in indices until at most		  *
+* targetIndexCount indices are left or no edge can be collapsed	  *
+* without flipping a triangle. Vertices are only ever merged	  *
+* into existing ones, so the result uses the mesh's vertex buffer *
+* as is. Borders and attribute seams are kept in place			  *
+* Returns the geometric error of the result in the mesh's units	  *
+******************************************************************/
+float SimplifyIndices(const ImportedMesh& mesh, const std::vector<uint32_t>& indices, size_t targetIndexCount,
+	std::vector<uint32_t>& output);
+
+//Appends up to maxLevels detail levels of every submesh to the index stream, level 0 being the submesh itself
+void BuildLods(ImportedMesh& mesh, uint32_t maxLevels);
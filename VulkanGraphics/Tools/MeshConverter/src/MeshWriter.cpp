@@ -0,0 +1,104 @@
+#include "MeshWriter.h"
+
+#include <cstring>
+#include <fstream>
+
+//Appends raw bytes to the file image
+static void AppendBytes(std::vector<uint8_t>& image, const void* data, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	image.insert(image.end(), bytes, bytes + size);
+}
+
+//Pads the file image with zeros up to the next stream boundary
+static void PadToStreamAlignment(std::vector<uint8_t>& image)
+{
+	image.resize(static_cast<size_t>(AlignMeshFileOffset(image.size())), 0);
+}
+
+bool WriteMeshFile(const std::string& filename, const ImportedMesh& mesh, uint32_t vertexFormat, MeshWriteStats& stats)
+{
+	/* Initializing the header */
+	MeshFileHeader header{};
+	header.magic = MESH_FILE_MAGIC;
+	header.version = MESH_FILE_VERSION;
+	header.vertexFormat = vertexFormat;
+	header.vertexStride = GetMeshVertexStride(vertexFormat);
+	header.indexSize = mesh.vertices.size() <= 0xFFFF ? 2 : 4;
+	header.submeshCount = static_cast<uint32_t>(mesh.submeshes.size());
+	header.vertexCount = mesh.vertices.size();
+	header.indexCount = mesh.indices.size();
+	header.bounds = ComputeIndexedBounds(mesh, 0, static_cast<uint32_t>(mesh.indices.size()));
+	/* Header complete */
+
+	//The header is written last, once every offset is known
+	std::vector<uint8_t> image(sizeof(MeshFileHeader), 0);
+
+	/* Writing the streams */
+	PadToStreamAlignment(image);
+	header.vertexDataOffset = image.size();
+	std::vector<uint8_t> vertexStream;
+	EncodeVertexStream(mesh, vertexFormat, header.bounds, vertexStream, stats.quantizationError);
+	header.vertexDataSize = vertexStream.size();
+	AppendBytes(image, vertexStream.data(), vertexStream.size());
+
+	PadToStreamAlignment(image);
+	header.indexDataOffset = image.size();
+	header.indexDataSize = mesh.indices.size() * header.indexSize;
+	if (header.indexSize == 2)
+	{
+		for (uint32_t index : mesh.indices)
+		{
+			uint16_t shortIndex = static_cast<uint16_t>(index);
+			AppendBytes(image, &shortIndex, sizeof(shortIndex));
+		}
+	}
+	else
+	{
+		AppendBytes(image, mesh.indices.data(), static_cast<size_t>(header.indexDataSize));
+	}
+
+	PadToStreamAlignment(image);
+	header.submeshTableOffset = image.size();
+	std::vector<MeshFileLod> lods = mesh.lods;
+	for (const ImportedSubmesh& submesh : mesh.submeshes)
+	{
+		MeshFileSubmesh fileSubmesh{};
+		fileSubmesh.firstIndex = submesh.firstIndex;
+		fileSubmesh.indexCount = submesh.indexCount;
+		fileSubmesh.materialIndex = submesh.materialIndex;
+		fileSubmesh.firstLod = submesh.lodCount > 0 ? submesh.firstLod : static_cast<uint32_t>(lods.size());
+		fileSubmesh.lodCount = submesh.lodCount > 0 ? submesh.lodCount : 1;
+		if (submesh.lodCount == 0)
+		{
+			lods.push_back({ submesh.firstIndex, submesh.indexCount, 0.0f, 0 });
+		}
+		fileSubmesh.bounds = ComputeIndexedBounds(mesh, submesh.firstIndex, submesh.indexCount);
+		AppendBytes(image, &fileSubmesh, sizeof(fileSubmesh));
+	}
+
+	PadToStreamAlignment(image);
+	header.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+	header.meshletTableOffset = image.size();
+	AppendBytes(image, mesh.meshlets.data(), mesh.meshlets.size() * sizeof(MeshFileMeshlet));
+
+	PadToStreamAlignment(image);
+	header.lodCount = static_cast<uint32_t>(lods.size());
+	header.lodTableOffset = image.size();
+	AppendBytes(image, lods.data(), lods.size() * sizeof(MeshFileLod));
+	/* Streams written */
+
+	std::memcpy(image.data(), &header, sizeof(header));
+
+	std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+
+	stats.fileSize = image.size();
+	stats.vertexDataSize = header.vertexDataSize;
+	stats.indexSize = header.indexSize;
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include "ImportedMesh.h"
+#include "VertexQuantizer.h"
+
+//Describes a written mesh file, so the converter can report what it produced
+struct MeshWriteStats
+{
+	uint64_t fileSize = 0;
+	uint64_t vertexDataSize = 0;
+	uint32_t indexSize = 0;
+	QuantizationError quantizationError;
+};
+
+//Writes the mesh as a mesh file in one of the MESH_VERTEX_FORMAT layouts,
+//using 16 bit indices whenever every vertex can be addressed with them
+bool WriteMeshFile(const std::string& filename, const ImportedMesh& mesh, uint32_t vertexFormat, MeshWriteStats& stats);
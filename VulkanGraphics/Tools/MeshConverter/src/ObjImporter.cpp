@@ -0,0 +1,223 @@
+#include "ObjImporter.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <unordered_map>
+
+//Identifies a unique vertex of the file: the position, texture coordinate and normal indices of a face corner
+struct ObjCornerKey
+{
+	int position;
+	int uv;
+	int normal;
+
+	bool operator==(const ObjCornerKey& other) const
+	{
+		return position == other.position && uv == other.uv && normal == other.normal;
+	}
+};
+
+struct ObjCornerKeyHash
+{
+	size_t operator()(const ObjCornerKey& key) const
+	{
+		return (static_cast<size_t>(key.position) * 73856093u) ^ (static_cast<size_t>(key.uv) * 19349663u) ^
+			(static_cast<size_t>(key.normal) * 83492791u);
+	}
+};
+
+//Turns a 1 based (or negative, relative to the end) OBJ index into a 0 based one, -1 if it is missing
+static int ResolveObjIndex(const char* text, char** end, size_t count)
+{
+	long index = std::strtol(text, end, 10);
+	if (*end == text)
+	{
+		return -1;
+	}
+	return index < 0 ? static_cast<int>(count) + static_cast<int>(index) : static_cast<int>(index) - 1;
+}
+
+bool ImportObj(const std::string& filename, ImportedMesh& mesh, std::string& error)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		error = "could not open " + filename;
+		return false;
+	}
+
+	std::vector<float> positions;
+	std::vector<float> uvs;
+	std::vector<float> normals;
+	std::unordered_map<ObjCornerKey, uint32_t, ObjCornerKeyHash> cornerVertices;
+	std::unordered_map<std::string, uint32_t> materials;
+	uint32_t currentMaterial = 0;
+	bool missingNormals = false;
+
+	//Starts a new submesh whenever the material changes, empty submeshes are reused
+	auto beginSubmesh = [&mesh](uint32_t materialIndex)
+	{
+		uint32_t firstIndex = static_cast<uint32_t>(mesh.indices.size());
+		if (!mesh.submeshes.empty() && mesh.submeshes.back().indexCount == 0)
+		{
+			mesh.submeshes.back().materialIndex = materialIndex;
+			return;
+		}
+		mesh.submeshes.push_back({ firstIndex, 0, materialIndex });
+	};
+	beginSubmesh(0);
+
+	std::string line;
+	std::vector<uint32_t> polygon;
+	uint64_t lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		++lineNumber;
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+		const char* text = line.c_str();
+		while (*text == ' ' || *text == '\t')
+		{
+			++text;
+		}
+		char* end = nullptr;
+
+		if (text[0] == 'v' && (text[1] == ' ' || text[1] == '\t'))
+		{
+			text += 2;
+			for (int i = 0; i < 3; ++i)
+			{
+				positions.push_back(std::strtof(text, &end));
+				text = end;
+			}
+		}
+		else if (text[0] == 'v' && text[1] == 't')
+		{
+			text += 2;
+			float u = std::strtof(text, &end);
+			float v = std::strtof(end, &end);
+			//OBJ texture coordinates start at the bottom left, Vulkan's at the top left
+			uvs.push_back(u);
+			uvs.push_back(1.0f - v);
+		}
+		else if (text[0] == 'v' && text[1] == 'n')
+		{
+			text += 2;
+			for (int i = 0; i < 3; ++i)
+			{
+				normals.push_back(std::strtof(text, &end));
+				text = end;
+			}
+		}
+		else if (text[0] == 'f' && (text[1] == ' ' || text[1] == '\t'))
+		{
+			/* Reading the corners of the polygon */
+			polygon.clear();
+			text += 2;
+			while (*text)
+			{
+				while (*text == ' ' || *text == '\t' || *text == '\r')
+				{
+					++text;
+				}
+				if (!*text)
+				{
+					break;
+				}
+
+				ObjCornerKey key = { ResolveObjIndex(text, &end, positions.size() / 3), -1, -1 };
+				if (key.position < 0 || key.position >= static_cast<int>(positions.size() / 3))
+				{
+					error = "invalid position index on line " + std::to_string(lineNumber);
+					return false;
+				}
+				text = end;
+				if (*text == '/')
+				{
+					++text;
+					if (*text != '/')
+					{
+						key.uv = ResolveObjIndex(text, &end, uvs.size() / 2);
+						text = end;
+					}
+					if (*text == '/')
+					{
+						++text;
+						key.normal = ResolveObjIndex(text, &end, normals.size() / 3);
+						text = end;
+					}
+				}
+				if (key.uv >= static_cast<int>(uvs.size() / 2) || key.normal >= static_cast<int>(normals.size() / 3))
+				{
+					error = "invalid texture coordinate or normal index on line " + std::to_string(lineNumber);
+					return false;
+				}
+
+				//Corners that share all three indices become a single vertex
+				auto existing = cornerVertices.find(key);
+				if (existing != cornerVertices.end())
+				{
+					polygon.push_back(existing->second);
+					continue;
+				}
+
+				MeshVertex vertex{};
+				for (int i = 0; i < 3; ++i)
+				{
+					vertex.position[i] = positions[key.position * 3 + i];
+					vertex.normal[i] = key.normal >= 0 ? normals[key.normal * 3 + i] : 0.0f;
+				}
+				if (key.uv >= 0)
+				{
+					vertex.uv[0] = uvs[key.uv * 2];
+					vertex.uv[1] = uvs[key.uv * 2 + 1];
+				}
+				missingNormals |= key.normal < 0;
+
+				uint32_t vertexIndex = static_cast<uint32_t>(mesh.vertices.size());
+				mesh.vertices.push_back(vertex);
+				cornerVertices.emplace(key, vertexIndex);
+				polygon.push_back(vertexIndex);
+			}
+			/* Polygon read */
+
+			//OBJ polygons are convex, so a fan around the first corner triangulates them
+			for (size_t i = 1; i + 1 < polygon.size(); ++i)
+			{
+				mesh.indices.push_back(polygon[0]);
+				mesh.indices.push_back(polygon[i]);
+				mesh.indices.push_back(polygon[i + 1]);
+				mesh.submeshes.back().indexCount += 3;
+			}
+		}
+		else if (line.compare(0, 7, "usemtl ") == 0)
+		{
+			std::string materialName = line.substr(7);
+			auto material = materials.emplace(materialName, static_cast<uint32_t>(materials.size())).first;
+			if (material->second != currentMaterial || mesh.submeshes.back().indexCount == 0)
+			{
+				currentMaterial = material->second;
+				beginSubmesh(currentMaterial);
+			}
+		}
+	}
+
+	if (!mesh.submeshes.empty() && mesh.submeshes.back().indexCount == 0)
+	{
+		mesh.submeshes.pop_back();
+	}
+	if (mesh.indices.empty())
+	{
+		error = filename + " has no faces";
+		return false;
+	}
+
+	//Files without normals get smooth ones, files with some normals keep them where they are given
+	if (missingNormals && normals.empty())
+	{
+		ComputeVertexNormals(mesh, 0, 0);
+	}
+	return true;
+}
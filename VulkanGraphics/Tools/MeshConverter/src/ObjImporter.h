@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+#include "ImportedMesh.h"
+
+//Reads the triangles of a Wavefront OBJ file. Polygons are fanned into triangles and every material gets its own submeshes
+bool ImportObj(const std::string& filename, ImportedMesh& mesh, std::string& error);
@@ -0,0 +1,195 @@
+#include "VertexQuantizer.h"
+#include "EngineCore/Math/VectorMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static uint16_t QuantizeUnorm16(float value)
+{
+	float clamped = std::min(std::max(value, 0.0f), 1.0f);
+	return static_cast<uint16_t>(std::lround(clamped * 65535.0f));
+}
+
+static int16_t QuantizeSnorm16(float value)
+{
+	float clamped = std::min(std::max(value, -1.0f), 1.0f);
+	return static_cast<int16_t>(std::lround(clamped * 32767.0f));
+}
+
+//Rounds to the nearest half float, values too large for a half become infinity
+static uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	//NaN stays NaN, everything at or above 65520 rounds to infinity
+	if (magnitude > 0x7F800000)
+	{
+		return sign | 0x7E00;
+	}
+	if (magnitude >= 0x477FF000)
+	{
+		return sign | 0x7C00;
+	}
+
+	//Denormal halves, the implicit bit is shifted in and the rest is rounded to nearest even
+	if (magnitude < 0x38800000)
+	{
+		if (magnitude < 0x33000000)
+		{
+			return sign;
+		}
+		uint32_t exponent = magnitude >> 23;
+		uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+		uint32_t shift = 126 - exponent;
+		uint32_t half = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t midpoint = 1u << (shift - 1);
+		if (remainder > midpoint || (remainder == midpoint && (half & 1)))
+		{
+			++half;
+		}
+		return sign | static_cast<uint16_t>(half);
+	}
+
+	//Normal halves, rebiasing the exponent and rounding the mantissa to nearest even
+	uint32_t rebiased = magnitude - 0x38000000;
+	uint32_t half = rebiased >> 13;
+	uint32_t remainder = rebiased & 0x1FFF;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+	{
+		++half;
+	}
+	return sign | static_cast<uint16_t>(half);
+}
+
+static float HalfToFloat(uint16_t half)
+{
+	uint32_t exponent = (half >> 10) & 0x1F;
+	float mantissa = static_cast<float>(half & 0x3FF);
+	float magnitude = exponent == 0 ? std::ldexp(mantissa, -24) :
+		exponent == 31 ? INFINITY : std::ldexp(mantissa + 1024.0f, static_cast<int>(exponent) - 25);
+	return (half & 0x8000) ? -magnitude : magnitude;
+}
+
+//Projects the normal onto an octahedron and unfolds it into a square, so two values are enough to store it
+static void EncodeOctahedral(const float normal[3], int16_t encoded[2])
+{
+	float length = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+	if (length == 0.0f)
+	{
+		encoded[0] = encoded[1] = 0;
+		return;
+	}
+
+	float x = normal[0] / length;
+	float y = normal[1] / length;
+	if (normal[2] < 0.0f)
+	{
+		float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+	encoded[0] = QuantizeSnorm16(x);
+	encoded[1] = QuantizeSnorm16(y);
+}
+
+//Matches DecodeNormal in VulkanMesh.vert
+static Vec3 DecodeOctahedral(const int16_t encoded[2])
+{
+	Vec3 decoded = { std::max(encoded[0] / 32767.0f, -1.0f), std::max(encoded[1] / 32767.0f, -1.0f), 0.0f };
+	decoded.z = 1.0f - std::fabs(decoded.x) - std::fabs(decoded.y);
+	float fold = std::max(-decoded.z, 0.0f);
+	decoded.x += decoded.x >= 0.0f ? -fold : fold;
+	decoded.y += decoded.y >= 0.0f ? -fold : fold;
+	return Normalize(decoded);
+}
+
+uint32_t ChoosePackedVertexFormat(const ImportedMesh& mesh)
+{
+	for (const MeshVertex& vertex : mesh.vertices)
+	{
+		if (vertex.uv[0] < 0.0f || vertex.uv[0] > 1.0f || vertex.uv[1] < 0.0f || vertex.uv[1] > 1.0f)
+		{
+			return MESH_VERTEX_FORMAT_PACKED_HALF_UV;
+		}
+	}
+	return MESH_VERTEX_FORMAT_PACKED_UNORM16_UV;
+}
+
+/************************************************************************************
+* Function Argument 1: The mesh whose vertices are encoded							*
+* Function Argument 2: One of the MESH_VERTEX_FORMAT defines						*
+* Function Argument 3: The bounds written to the file header, used as the grid of	*
+*					   packed positions												*
+* Function Argument 4: Filled with the encoded vertices								*
+* Function Argument 5: Filled with the largest error of each attribute				*
+************************************************************************************/
+void EncodeVertexStream(const ImportedMesh& mesh, uint32_t vertexFormat, const MeshBounds& bounds,
+	std::vector<uint8_t>& stream, QuantizationError& error)
+{
+	error = QuantizationError();
+	stream.resize(mesh.vertices.size() * GetMeshVertexStride(vertexFormat));
+	if (vertexFormat == MESH_VERTEX_FORMAT_FLOAT32)
+	{
+		std::memcpy(stream.data(), mesh.vertices.data(), stream.size());
+		return;
+	}
+
+	float extent[3];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		extent[axis] = bounds.max[axis] - bounds.min[axis];
+	}
+
+	for (size_t i = 0; i < mesh.vertices.size(); ++i)
+	{
+		const MeshVertex& vertex = mesh.vertices[i];
+		MeshPackedVertex packed{};
+
+		/* Quantizing the position to the bounds */
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float normalized = extent[axis] > 0.0f ? (vertex.position[axis] - bounds.min[axis]) / extent[axis] : 0.0f;
+			packed.position[axis] = QuantizeUnorm16(normalized);
+
+			float decoded = bounds.min[axis] + packed.position[axis] / 65535.0f * extent[axis];
+			error.maxPositionError = std::max(error.maxPositionError, std::fabs(decoded - vertex.position[axis]));
+		}
+		/* Position quantized */
+
+		/* Encoding the normal */
+		EncodeOctahedral(vertex.normal, packed.normal);
+		Vec3 original = Normalize({ vertex.normal[0], vertex.normal[1], vertex.normal[2] });
+		float cosine = std::min(std::max(Dot(original, DecodeOctahedral(packed.normal)), -1.0f), 1.0f);
+		if (Length(original) > 0.0f)
+		{
+			error.maxNormalError = std::max(error.maxNormalError, std::acos(cosine) * 57.2957795f);
+		}
+		/* Normal encoded */
+
+		/* Encoding the texture coordinates */
+		for (int component = 0; component < 2; ++component)
+		{
+			float decoded;
+			if (vertexFormat == MESH_VERTEX_FORMAT_PACKED_UNORM16_UV)
+			{
+				packed.uv[component] = QuantizeUnorm16(vertex.uv[component]);
+				decoded = packed.uv[component] / 65535.0f;
+			}
+			else
+			{
+				packed.uv[component] = FloatToHalf(vertex.uv[component]);
+				decoded = HalfToFloat(packed.uv[component]);
+			}
+			error.maxUvError = std::max(error.maxUvError, std::fabs(decoded - vertex.uv[component]));
+		}
+		/* Texture coordinates encoded */
+
+		std::memcpy(stream.data() + i * sizeof(MeshPackedVertex), &packed, sizeof(packed));
+	}
+}
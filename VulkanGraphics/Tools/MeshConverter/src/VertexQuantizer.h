@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ImportedMesh.h"
+
+//The largest error the quantization introduced, so the converter can report what the savings cost
+struct QuantizationError
+{
+	//In the mesh's units
+	float maxPositionError = 0.0f;
+	//In degrees
+	float maxNormalError = 0.0f;
+	float maxUvError = 0.0f;
+};
+
+//Picks the packed format that can hold the mesh's uvs, UNORM16 if they all lie inside [0, 1] and half floats otherwise
+uint32_t ChoosePackedVertexFormat(const ImportedMesh& mesh);
+
+//Encodes the vertices in one of the MESH_VERTEX_FORMAT layouts, packed positions are quantized to bounds
+void EncodeVertexStream(const ImportedMesh& mesh, uint32_t vertexFormat, const MeshBounds& bounds,
+	std::vector<uint8_t>& stream, QuantizationError& error);
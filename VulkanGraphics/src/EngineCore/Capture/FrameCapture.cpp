@@ -0,0 +1,177 @@
+#include "FrameCapture.h"
+#include "EngineCore/Profiling/TraceRecorder.h"
+
+#include <cstring>
+
+VulkanFrameCaptureHandle::VulkanFrameCaptureHandle()
+	:m_slots(), vk_extent(), m_bgra{false}, m_capturing{false}, m_consumer(), m_frame(), m_capturedFrames{0}
+{
+
+}
+
+/************************************************************************************************
+* Function Argument 1: The device handle is needed to create the readback buffers				*
+* Function Argument 2: The size of the captured images											*
+* Function Argument 3: The format of the captured images, decides if and how they are copied	*
+* Function Argument 4: One readback buffer is created for each frame that can be in flight		*
+************************************************************************************************/
+void VulkanFrameCaptureHandle::CreateFrameCapture(const VulkanDeviceHandle& device, const VkExtent2D& extent,
+	VkFormat format, uint32_t framesInFlight)
+{
+	/* Checking the image format */
+	switch (format)
+	{
+	case VK_FORMAT_B8G8R8A8_SRGB:
+	case VK_FORMAT_B8G8R8A8_UNORM:
+		m_bgra = true;
+		break;
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_R8G8B8A8_UNORM:
+		m_bgra = false;
+		break;
+	default:
+		//Other formats would need converting on the CPU, capture stays unavailable
+		return;
+	}
+	/* Image format checked */
+
+	vk_extent = extent;
+	VkDeviceSize frameSize = static_cast<VkDeviceSize>(vk_extent.width) * vk_extent.height * 4;
+	m_slots.resize(framesInFlight);
+	for (ReadbackSlot& slot : m_slots)
+	{
+		//The CPU reads every byte of the buffer, cached memory makes that much faster where the GPU has it
+		slot.buffer.CreateBuffer(device, frameSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+	}
+}
+
+/*****************************************************************************************
+* Function Argument 1: The frame's command buffer, its render pass has already ended	 *
+* Function Argument 2: The image the frame rendered to									 *
+* Function Argument 3: The layout the render pass left the image in					 *
+* Function Argument 4: The frame slot, its readback buffer receives the copy			 *
+*****************************************************************************************/
+void VulkanFrameCaptureHandle::RecordCapture(const VkCommandBuffer& commandBuffer, const VkImage& image,
+	VkImageLayout imageLayout, uint32_t frameIndex)
+{
+	if (!m_capturing)
+	{
+		return;
+	}
+
+	ReadbackSlot& slot = m_slots[frameIndex];
+	slot.pending = true;
+	slot.frameNumber = m_capturedFrames++;
+
+	/* Moving the image to the transfer source layout */
+	//Even if the render pass already left the image there, its writes still have to be made visible to the copy
+	VkImageMemoryBarrier toTransfer{};
+	toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	toTransfer.oldLayout = imageLayout;
+	toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.image = image;
+	toTransfer.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	toTransfer.subresourceRange.levelCount = 1;
+	toTransfer.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toTransfer);
+	/* Image moved */
+
+	//Rows are tightly packed, so the buffer holds the image exactly as the consumer receives it
+	VkBufferImageCopy region{};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = { vk_extent.width, vk_extent.height, 1 };
+	vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer.GetVulkanSDKBuffer(),
+		1, &region);
+
+	/* Returning the image to its layout and making the copy visible to the CPU */
+	VkImageMemoryBarrier toPrevious = toTransfer;
+	toPrevious.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	toPrevious.dstAccessMask = 0;
+	toPrevious.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	toPrevious.newLayout = imageLayout;
+	uint32_t imageBarrierCount = imageLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL ? 0 : 1;
+
+	VkBufferMemoryBarrier toHost{};
+	toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toHost.buffer = slot.buffer.GetVulkanSDKBuffer();
+	toHost.offset = 0;
+	toHost.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &toHost,
+		imageBarrierCount, &toPrevious);
+	/* Image returned */
+}
+
+/***************************************************************************
+* Function Argument 1: The frame slot whose last submit has just finished *
+***************************************************************************/
+void VulkanFrameCaptureHandle::CollectFrame(uint32_t frameIndex)
+{
+	if (!IsCreated() || !m_slots[frameIndex].pending)
+	{
+		return;
+	}
+
+	TRACE_SCOPE("CollectCapturedFrame");
+	ReadbackSlot& slot = m_slots[frameIndex];
+	slot.pending = false;
+	if (!m_consumer)
+	{
+		return;
+	}
+
+	//The buffer is copied out right away, so the slot can be captured into again by the frame about to be recorded
+	m_frame.frameNumber = slot.frameNumber;
+	m_frame.width = vk_extent.width;
+	m_frame.height = vk_extent.height;
+	m_frame.bgra = m_bgra;
+	m_frame.pixels.resize(static_cast<size_t>(slot.buffer.GetSize()));
+	std::memcpy(m_frame.pixels.data(), slot.buffer.GetMappedData(), m_frame.pixels.size());
+	m_consumer(m_frame);
+}
+
+void VulkanFrameCaptureHandle::CollectAllFrames()
+{
+	//Frame slots are collected oldest first, so the consumer still receives the frames in order
+	while (true)
+	{
+		uint32_t oldestSlot = static_cast<uint32_t>(m_slots.size());
+		for (uint32_t i = 0; i < m_slots.size(); ++i)
+		{
+			if (m_slots[i].pending && (oldestSlot == m_slots.size() ||
+				m_slots[i].frameNumber < m_slots[oldestSlot].frameNumber))
+			{
+				oldestSlot = i;
+			}
+		}
+
+		if (oldestSlot == m_slots.size())
+		{
+			return;
+		}
+		CollectFrame(oldestSlot);
+	}
+}
+
+void VulkanFrameCaptureHandle::Cleanup(const VkDevice& device)
+{
+	for (ReadbackSlot& slot : m_slots)
+	{
+		slot.buffer.Cleanup(device);
+	}
+	m_slots.clear();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include "EngineCore/VulkanHandles/VulkanBuffer.h"
+#include "EngineCore/VulkanHandles/VulkanDevice.h"
+#include "EngineCore/Capture/FrameWriter.h"
+
+//Receives every captured frame on the main thread, it can swap the pixels out to keep them
+typedef std::function<void(CapturedFrame& frame)> FrameCaptureConsumer;
+
+/********************************************************************
+* Copies rendered frames into a ring of host visible readback	    *
+* buffers, one per frame in flight. A buffer is only read		    *
+* once its frame has finished on the GPU, which the frame loop	    *
+* already waits for before reusing the slot, so capturing costs	    *
+* the copy and never a wait on the queue							*
+********************************************************************/
+class VulkanFrameCaptureHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanFrameCaptureHandle();
+
+	//Creates the readback buffers for frames of this size and format, does nothing if the format is not 8 bit RGBA/BGRA.
+	//The images captured must have been created with the transfer source usage
+	void CreateFrameCapture(const VulkanDeviceHandle& device, const VkExtent2D& extent, VkFormat format,
+		uint32_t framesInFlight);
+
+	//While capturing, records the copy of the rendered image into the frame slot's readback buffer.
+	//Recorded after the render pass, the image is left in the layout the render pass left it in
+	void RecordCapture(const VkCommandBuffer& commandBuffer, const VkImage& image, VkImageLayout imageLayout,
+		uint32_t frameIndex);
+
+	//Called once the frame slot's last submit has finished, hands the frame it copied to the consumer
+	void CollectFrame(uint32_t frameIndex);
+
+	//Collects every frame still in the readback buffers, the device must be idle
+	void CollectAllFrames();
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline bool IsCreated() const { return !m_slots.empty(); }
+
+	inline bool IsCapturing() const { return m_capturing; }
+
+	inline uint64_t GetCapturedFrameCount() const { return m_capturedFrames; }
+	/* End member variable getters */
+
+	/* Member variable setters */
+	inline void SetCapturing(bool capturing) { m_capturing = capturing && IsCreated(); }
+
+	inline void SetConsumer(const FrameCaptureConsumer& consumer) { m_consumer = consumer; }
+	/* End member variable setters */
+private:
+	//A readback buffer and the frame last copied into it
+	struct ReadbackSlot
+	{
+		VulkanBufferHandle buffer;
+		bool pending = false;
+		uint64_t frameNumber = 0;
+	};
+private:
+	std::vector<ReadbackSlot> m_slots;
+
+	VkExtent2D vk_extent;
+
+	//Set if the image format stores blue first
+	bool m_bgra;
+
+	bool m_capturing;
+
+	FrameCaptureConsumer m_consumer;
+
+	//Handed to the consumer and reused for every frame, so its pixel buffer is only allocated once
+	CapturedFrame m_frame;
+
+	//Numbers the captured frames, counting only frames that were captured
+	uint64_t m_capturedFrames;
+};
@@ -0,0 +1,334 @@
+#include "FrameWriter.h"
+#include "EngineCore/Profiling/TraceRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+//Table driven CRC32 of the PNG chunks, the table is built on first use
+static uint32_t UpdateCrc(uint32_t crc, const uint8_t* data, size_t size)
+{
+	static const std::vector<uint32_t> table = []()
+	{
+		std::vector<uint32_t> values(256);
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t value = i;
+			for (uint32_t bit = 0; bit < 8; ++bit)
+			{
+				value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+			}
+			values[i] = value;
+		}
+		return values;
+	}();
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+static void AppendBigEndian(std::vector<uint8_t>& bytes, uint32_t value)
+{
+	bytes.push_back(static_cast<uint8_t>(value >> 24));
+	bytes.push_back(static_cast<uint8_t>(value >> 16));
+	bytes.push_back(static_cast<uint8_t>(value >> 8));
+	bytes.push_back(static_cast<uint8_t>(value));
+}
+
+//Writes a chunk with its length, type and CRC around the data
+static void WritePngChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data)
+{
+	std::vector<uint8_t> header;
+	AppendBigEndian(header, static_cast<uint32_t>(data.size()));
+	header.insert(header.end(), type, type + 4);
+
+	uint32_t crc = UpdateCrc(0xFFFFFFFFu, header.data() + 4, 4);
+	crc = UpdateCrc(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+	std::vector<uint8_t> footer;
+	AppendBigEndian(footer, crc);
+
+	file.write(reinterpret_cast<const char*>(header.data()), header.size());
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	file.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+}
+
+FrameWriter::FrameWriter()
+	:m_threads(), m_mutex(), m_frameCondition(), m_spaceCondition(), m_queuedFrames(), m_freePixels(), m_settings(),
+	m_stream(), m_streamHeaderWritten{false}, m_yuvPlanes(), m_stopRequested{false}, m_writtenFrames{0}, m_droppedFrames{0},
+	m_writeNs{0}, m_blockedNs{0}
+{
+
+}
+
+/*********************************************************************
+* Function Argument 1: Where and how the frames are written, the	 *
+*					   directory or file is created if needed		 *
+*********************************************************************/
+void FrameWriter::Start(const FrameWriterSettings& settings)
+{
+	m_settings = settings;
+	std::error_code error;
+	if (settings.format == FrameWriterFormat::Png)
+	{
+		std::filesystem::create_directories(settings.path, error);
+	}
+	else
+	{
+		//Frames of a stream have to be appended in order, so a single thread writes them
+		m_settings.threadCount = 1;
+		std::filesystem::path parent = std::filesystem::path(settings.path).parent_path();
+		if (!parent.empty())
+		{
+			std::filesystem::create_directories(parent, error);
+		}
+		m_stream.open(settings.path, std::ios::binary | std::ios::trunc);
+		m_streamHeaderWritten = false;
+	}
+
+	m_stopRequested = false;
+	for (uint32_t i = 0; i < std::max(m_settings.threadCount, 1u); ++i)
+	{
+		m_threads.emplace_back(&FrameWriter::WriterLoop, this);
+	}
+}
+
+/******************************************************************************
+* Function Argument 1: The frame to write, its pixels are swapped with an	  *
+*					   empty buffer that can be filled with the next frame	  *
+******************************************************************************/
+void FrameWriter::Push(CapturedFrame& frame)
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_queuedFrames.size() >= FRAME_WRITER_MAX_QUEUED_FRAMES)
+		{
+			//Dropping the frame keeps the frame loop from ever waiting on the disk
+			if (m_settings.dropWhenFull)
+			{
+				m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			auto waitStart = std::chrono::steady_clock::now();
+			m_spaceCondition.wait(lock, [this]() { return m_queuedFrames.size() < FRAME_WRITER_MAX_QUEUED_FRAMES; });
+			m_blockedNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - waitStart).count(), std::memory_order_relaxed);
+		}
+
+		m_queuedFrames.push_back(CapturedFrame{ frame.frameNumber, frame.width, frame.height, frame.bgra, {} });
+		m_queuedFrames.back().pixels.swap(frame.pixels);
+		if (!m_freePixels.empty())
+		{
+			frame.pixels.swap(m_freePixels.back());
+			m_freePixels.pop_back();
+		}
+	}
+	m_frameCondition.notify_one();
+}
+
+void FrameWriter::Stop()
+{
+	if (m_threads.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopRequested = true;
+	}
+	m_frameCondition.notify_all();
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+	m_threads.clear();
+
+	if (m_stream.is_open())
+	{
+		m_stream.close();
+	}
+}
+
+void FrameWriter::WriterLoop()
+{
+	TraceRecorder::Get().SetThreadName("Frame writer");
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		m_frameCondition.wait(lock, [this]() { return m_stopRequested || !m_queuedFrames.empty(); });
+		if (m_queuedFrames.empty())
+		{
+			//Only stops once every queued frame has been written
+			return;
+		}
+
+		CapturedFrame frame = std::move(m_queuedFrames.front());
+		m_queuedFrames.pop_front();
+		lock.unlock();
+		m_spaceCondition.notify_one();
+
+		auto writeStart = std::chrono::steady_clock::now();
+		WriteFrame(frame);
+		m_writeNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - writeStart).count(), std::memory_order_relaxed);
+		m_writtenFrames.fetch_add(1, std::memory_order_relaxed);
+
+		lock.lock();
+		m_freePixels.push_back(std::move(frame.pixels));
+	}
+}
+
+/***********************************************************
+* Function Argument 1: The frame taken off the queue	   *
+***********************************************************/
+void FrameWriter::WriteFrame(const CapturedFrame& frame)
+{
+	TRACE_SCOPE("WriteCapturedFrame");
+	switch (m_settings.format)
+	{
+	case FrameWriterFormat::Png:
+	{
+		char filename[32];
+		std::snprintf(filename, sizeof(filename), "Frame_%06llu.png", static_cast<unsigned long long>(frame.frameNumber));
+		WritePng(m_settings.path + "/" + filename, frame);
+		break;
+	}
+	case FrameWriterFormat::Raw:
+		m_stream.write(reinterpret_cast<const char*>(frame.pixels.data()), frame.pixels.size());
+		break;
+	case FrameWriterFormat::Y4m:
+		WriteY4mFrame(frame);
+		break;
+	}
+}
+
+/**********************************************************************
+* Function Argument 1: The frame appended to the stream, every frame  *
+*					   of a stream has the size of the first one	  *
+**********************************************************************/
+void FrameWriter::WriteY4mFrame(const CapturedFrame& frame)
+{
+	if (!m_streamHeaderWritten)
+	{
+		m_stream << "YUV4MPEG2 W" << frame.width << " H" << frame.height << " F" << m_settings.frameRate
+			<< ":1 Ip A1:1 C444 XCOLORRANGE=FULL\n";
+		m_streamHeaderWritten = true;
+	}
+
+	/* Converting the pixels to planes */
+	size_t pixelCount = static_cast<size_t>(frame.width) * frame.height;
+	m_yuvPlanes.resize(pixelCount * 3);
+	uint8_t* yPlane = m_yuvPlanes.data();
+	uint8_t* uPlane = yPlane + pixelCount;
+	uint8_t* vPlane = uPlane + pixelCount;
+	uint32_t red = frame.bgra ? 2 : 0;
+	uint32_t blue = frame.bgra ? 0 : 2;
+	const uint8_t* pixel = frame.pixels.data();
+	for (size_t i = 0; i < pixelCount; ++i, pixel += 4)
+	{
+		//BT.601 full range in 8 bit fixed point, the chroma offsets keep the shifted values positive and pure
+		//blue or red would round up to 256, so chroma is clamped
+		int32_t r = pixel[red];
+		int32_t g = pixel[1];
+		int32_t b = pixel[blue];
+		yPlane[i] = static_cast<uint8_t>((77 * r + 150 * g + 29 * b + 128) >> 8);
+		uPlane[i] = static_cast<uint8_t>(std::min((-43 * r - 85 * g + 128 * b + 32768 + 128) >> 8, 255));
+		vPlane[i] = static_cast<uint8_t>(std::min((128 * r - 107 * g - 21 * b + 32768 + 128) >> 8, 255));
+	}
+	/* Planes converted */
+
+	m_stream << "FRAME\n";
+	m_stream.write(reinterpret_cast<const char*>(m_yuvPlanes.data()), m_yuvPlanes.size());
+}
+
+/************************************************************************
+* Function Argument 1: The path of the PNG file, replaced if it exists  *
+* Function Argument 2: The frame that is written						*
+************************************************************************/
+void FrameWriter::WritePng(const std::string& filename, const CapturedFrame& frame)
+{
+	std::ofstream file(filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+	/* Header chunk */
+	std::vector<uint8_t> header;
+	AppendBigEndian(header, frame.width);
+	AppendBigEndian(header, frame.height);
+	//8 bits per channel, RGB, default compression, filter and no interlacing
+	header.insert(header.end(), { 8, 2, 0, 0, 0 });
+	WritePngChunk(file, "IHDR", header);
+	/* Header written */
+
+	/* Building the image rows */
+	//Every row starts with its filter type, 0 leaves the row as it is
+	size_t rowSize = 1 + static_cast<size_t>(frame.width) * 3;
+	std::vector<uint8_t> rows(rowSize * frame.height);
+	uint32_t red = frame.bgra ? 2 : 0;
+	uint32_t blue = frame.bgra ? 0 : 2;
+	for (uint32_t y = 0; y < frame.height; ++y)
+	{
+		uint8_t* row = rows.data() + y * rowSize;
+		const uint8_t* pixel = frame.pixels.data() + static_cast<size_t>(y) * frame.width * 4;
+		row[0] = 0;
+		for (uint32_t x = 0; x < frame.width; ++x, pixel += 4)
+		{
+			row[1 + x * 3 + 0] = pixel[red];
+			row[1 + x * 3 + 1] = pixel[1];
+			row[1 + x * 3 + 2] = pixel[blue];
+		}
+	}
+	/* Image rows built */
+
+	/* Data chunk */
+	//The rows are stored in uncompressed deflate blocks, compressing would cost far more than the disk space it saves
+	std::vector<uint8_t> data;
+	data.reserve(rows.size() + rows.size() / 65535 * 5 + 16);
+	data.push_back(0x78);
+	data.push_back(0x01);
+	size_t offset = 0;
+	do
+	{
+		size_t blockSize = std::min<size_t>(rows.size() - offset, 65535);
+		bool lastBlock = offset + blockSize == rows.size();
+		data.push_back(lastBlock ? 1 : 0);
+		data.push_back(static_cast<uint8_t>(blockSize));
+		data.push_back(static_cast<uint8_t>(blockSize >> 8));
+		data.push_back(static_cast<uint8_t>(~blockSize));
+		data.push_back(static_cast<uint8_t>(~blockSize >> 8));
+		data.insert(data.end(), rows.begin() + offset, rows.begin() + offset + blockSize);
+		offset += blockSize;
+	} while (offset < rows.size());
+
+	//The zlib stream ends with the Adler32 checksum of the uncompressed rows, the sums cannot overflow
+	//within 5552 bytes, so the modulo is only taken once per run of that many
+	uint32_t adlerLow = 1;
+	uint32_t adlerHigh = 0;
+	for (size_t start = 0; start < rows.size(); start += 5552)
+	{
+		size_t end = std::min<size_t>(rows.size(), start + 5552);
+		for (size_t i = start; i < end; ++i)
+		{
+			adlerLow += rows[i];
+			adlerHigh += adlerLow;
+		}
+		adlerLow %= 65521;
+		adlerHigh %= 65521;
+	}
+	AppendBigEndian(data, (adlerHigh << 16) | adlerLow);
+	WritePngChunk(file, "IDAT", data);
+	/* Data written */
+
+	WritePngChunk(file, "IEND", {});
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Amount of captured frames that can wait for the writer threads, pushing more either drops the frame or waits
+#define FRAME_WRITER_MAX_QUEUED_FRAMES 8
+
+//A frame read back from the GPU, in the byte order of the image it was copied from
+struct CapturedFrame
+{
+	uint64_t frameNumber = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	//Set if the bytes of each pixel are blue, green, red, alpha instead of red, green, blue, alpha
+	bool bgra = false;
+	//Tightly packed rows of 4 byte pixels, top row first
+	std::vector<uint8_t> pixels;
+};
+
+//How the frames are written
+enum class FrameWriterFormat
+{
+	//One RGB PNG file per frame in the output directory
+	Png,
+	//Every frame's pixels appended to the output file as they are, 4 bytes per pixel
+	Raw,
+	//A YUV4MPEG2 video file with full resolution chroma, which video players and encoders read directly
+	Y4m
+};
+
+struct FrameWriterSettings
+{
+	//The directory of a PNG sequence, or the file the raw and Y4M frames are streamed to
+	std::string path;
+	FrameWriterFormat format = FrameWriterFormat::Png;
+	//PNG files are independent and written by this many threads, streamed formats always use a single thread
+	uint32_t threadCount = 1;
+	//Set to drop frames when the queue is full instead of making the caller wait
+	bool dropWhenFull = true;
+	//Written to the Y4M header
+	uint32_t frameRate = 60;
+};
+
+/******************************************************************
+* Writes captured frames to disk on threads of their own, so	  *
+* encoding and disk writes never run on the frame loop. Pixel	  *
+* buffers are recycled: pushing a frame hands an already		  *
+* allocated buffer back to the caller							  *
+******************************************************************/
+class FrameWriter
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	FrameWriter();
+
+	//Creates the output directory or file and starts the writer threads
+	void Start(const FrameWriterSettings& settings);
+
+	//Queues the frame and swaps its pixels with a free buffer. If the writers have fallen too far behind, the frame
+	//is dropped or the call waits for a free place, depending on the settings
+	void Push(CapturedFrame& frame);
+
+	//Writes every queued frame, then stops the writer threads
+	void Stop();
+
+	/* Member variable getters */
+	inline bool IsRunning() const { return !m_threads.empty(); }
+
+	inline const FrameWriterSettings& GetSettings() const { return m_settings; }
+
+	inline uint64_t GetWrittenFrameCount() const { return m_writtenFrames.load(std::memory_order_relaxed); }
+
+	inline uint64_t GetDroppedFrameCount() const { return m_droppedFrames.load(std::memory_order_relaxed); }
+
+	//Time the writer threads spent encoding and writing, summed over the threads
+	inline double GetWriteMs() const { return m_writeNs.load(std::memory_order_relaxed) / 1000000.0; }
+
+	//Time Push spent waiting for a free place in the queue
+	inline double GetBlockedMs() const { return m_blockedNs.load(std::memory_order_relaxed) / 1000000.0; }
+	/* End member variable getters */
+private:
+	void WriterLoop();
+
+	//Called by the writer threads, writes the frame in the format of the settings
+	void WriteFrame(const CapturedFrame& frame);
+
+	//Writes the frame as an 8 bit RGB PNG, the alpha channel of the swapchain carries nothing
+	static void WritePng(const std::string& filename, const CapturedFrame& frame);
+
+	//Converts the frame to full range BT.601 YUV planes and appends it to the Y4M stream, writing the header first
+	void WriteY4mFrame(const CapturedFrame& frame);
+private:
+	std::vector<std::thread> m_threads;
+
+	//Guards the queue, the free buffers and the stop request
+	std::mutex m_mutex;
+	std::condition_variable m_frameCondition;
+	std::condition_variable m_spaceCondition;
+
+	std::deque<CapturedFrame> m_queuedFrames;
+
+	//Pixel buffers of frames already written, handed back to Push callers
+	std::vector<std::vector<uint8_t>> m_freePixels;
+
+	FrameWriterSettings m_settings;
+
+	//The raw or Y4M file, only used by the single writer thread of those formats
+	std::ofstream m_stream;
+	bool m_streamHeaderWritten;
+	std::vector<uint8_t> m_yuvPlanes;
+
+	bool m_stopRequested;
+
+	std::atomic<uint64_t> m_writtenFrames;
+	std::atomic<uint64_t> m_droppedFrames;
+	std::atomic<uint64_t> m_writeNs;
+	std::atomic<uint64_t> m_blockedNs;
+};
@@ -0,0 +1,164 @@
+#include "JobGraph.h"
+#include "EngineCore/Profiling/TraceRecorder.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+
+JobGraph::JobGraph()
+	:m_stages(), m_finishedStages(), m_startTime(), m_totalMs{0.0}
+{
+
+}
+
+/*******************************************************************************************
+* Function Argument 1: The name shown in the timing report and in trace captures, must be  *
+*					   a string literal (or outlive the graph)							   *
+* Function Argument 2: The work of the stage											   *
+* Function Argument 3: The ids of the stages that have to finish before this one starts	   *
+* Function Argument 4: If true the stage runs on the thread that called Run				   *
+*******************************************************************************************/
+uint32_t JobGraph::AddStage(const char* name, std::function<void()> function, std::initializer_list<uint32_t> dependencies,
+	bool mainThread)
+{
+	uint32_t stageId = static_cast<uint32_t>(m_stages.size());
+	for (uint32_t dependency : dependencies)
+	{
+		//Only depending on earlier stages keeps the graph free of cycles
+		if (dependency >= stageId)
+		{
+			__debugbreak();
+		}
+	}
+
+	Stage stage;
+	stage.name = name;
+	stage.function = std::move(function);
+	stage.dependencies = dependencies;
+	stage.mainThread = mainThread;
+	m_stages.push_back(std::move(stage));
+	return stageId;
+}
+
+void JobGraph::Run()
+{
+	JobSystem& jobSystem = JobSystem::Get();
+	m_startTime = std::chrono::steady_clock::now();
+
+	//Atomics cannot be moved, so the flags are sized on construction rather than resized
+	m_finishedStages = std::vector<std::atomic<bool>>(m_stages.size());
+	for (std::atomic<bool>& finished : m_finishedStages)
+	{
+		finished.store(false, std::memory_order_relaxed);
+	}
+
+	/* Creating a job for every stage */
+	//Every stage's job is a child of this one, so it only finishes once all of them have
+	Job* graphJob = jobSystem.CreateJob([]() {});
+	std::vector<Job*> stageJobs(m_stages.size());
+	for (uint32_t s = 0; s < m_stages.size(); ++s)
+	{
+		JobGraph* graph = this;
+		if (m_stages[s].mainThread)
+		{
+			//Only marks the stage as done for the stages depending on it, it is run once this thread has run the stage
+			stageJobs[s] = jobSystem.CreateJob([]() {}, graphJob);
+			continue;
+		}
+
+		stageJobs[s] = jobSystem.CreateJob([graph, s]() { graph->ExecuteStage(s); }, graphJob);
+		for (uint32_t dependency : m_stages[s].dependencies)
+		{
+			jobSystem.AddDependency(stageJobs[s], stageJobs[dependency]);
+		}
+	}
+	/* Stage jobs created */
+
+	//The stages that can already start are submitted right away, the others as their dependencies finish
+	for (uint32_t s = 0; s < m_stages.size(); ++s)
+	{
+		if (!m_stages[s].mainThread)
+		{
+			jobSystem.Run(stageJobs[s]);
+		}
+	}
+	jobSystem.Run(graphJob);
+
+	/* Running the main thread stages and helping with the others until every stage has finished */
+	std::vector<uint32_t> mainThreadStages;
+	for (uint32_t s = 0; s < m_stages.size(); ++s)
+	{
+		if (m_stages[s].mainThread)
+		{
+			mainThreadStages.push_back(s);
+		}
+	}
+
+	while (!jobSystem.IsFinished(graphJob))
+	{
+		auto readyStage = std::find_if(mainThreadStages.begin(), mainThreadStages.end(),
+			[this](uint32_t s) { return AreDependenciesFinished(s); });
+		if (readyStage != mainThreadStages.end())
+		{
+			uint32_t s = *readyStage;
+			mainThreadStages.erase(readyStage);
+			ExecuteStage(s);
+			jobSystem.Run(stageJobs[s]);
+		}
+		else if (!jobSystem.RunPendingJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+	/* Every stage finished */
+
+	m_totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+void JobGraph::ExecuteStage(uint32_t stageId)
+{
+	Stage& stage = m_stages[stageId];
+	auto start = std::chrono::steady_clock::now();
+	{
+		TRACE_SCOPE(stage.name);
+		stage.function();
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	stage.startMs = std::chrono::duration<double, std::milli>(start - m_startTime).count();
+	stage.durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+	stage.threadIndex = JobSystem::GetThreadIndex();
+	m_finishedStages[stageId].store(true, std::memory_order_release);
+}
+
+bool JobGraph::AreDependenciesFinished(uint32_t stageId) const
+{
+	for (uint32_t dependency : m_stages[stageId].dependencies)
+	{
+		if (!m_finishedStages[dependency].load(std::memory_order_acquire))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void JobGraph::LogTimings(std::ostream& stream) const
+{
+	std::vector<const Stage*> stages;
+	for (const Stage& stage : m_stages)
+	{
+		stages.push_back(&stage);
+	}
+	std::sort(stages.begin(), stages.end(), [](const Stage* a, const Stage* b) { return a->startMs < b->startMs; });
+
+	stream << std::fixed << std::setprecision(2);
+	for (const Stage* stage : stages)
+	{
+		stream << "  " << std::left << std::setw(24) << stage->name << std::right << " thread " << std::setw(2)
+			<< stage->threadIndex << "  start " << std::setw(8) << stage->startMs << " ms  took " << std::setw(8)
+			<< stage->durationMs << " ms\n";
+	}
+	stream << "  Total: " << m_totalMs << " ms\n";
+	stream << std::defaultfloat;
+}
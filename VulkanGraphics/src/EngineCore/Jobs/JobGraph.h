@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+#include "EngineCore/Jobs/JobSystem.h"
+
+/*******************************************************************
+* A set of named stages and the stages each one has to wait for.   *
+* Running the graph runs every stage as a job as soon as all of	   *
+* its dependencies have finished, so stages that do not depend on  *
+* each other overlap. Stages that must stay on the calling thread  *
+* (e.g. window creation) are run by it while it waits on the rest. *
+* The start and duration of every stage are kept for a report	   *
+*******************************************************************/
+class JobGraph
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	JobGraph();
+
+	//Adds a stage that runs once every stage in dependencies has finished, returns the id other stages depend on it by.
+	//Stages can only depend on stages added before them
+	uint32_t AddStage(const char* name, std::function<void()> function, std::initializer_list<uint32_t> dependencies = {},
+		bool mainThread = false);
+
+	//Runs every stage and returns once all of them have finished, must be called by a thread of the job system
+	void Run();
+
+	//Prints every stage in the order it started, with the thread it ran on, when it started and how long it took
+	void LogTimings(std::ostream& stream) const;
+
+	/* Member variable getters */
+	//Time from the start of Run until the last stage finished
+	inline double GetTotalMs() const { return m_totalMs; }
+	/* End member variable getters */
+private:
+	struct Stage
+	{
+		const char* name;
+		std::function<void()> function;
+		std::vector<uint32_t> dependencies;
+		bool mainThread;
+
+		//Filled in while the graph runs, relative to the start of Run
+		double startMs = 0.0;
+		double durationMs = 0.0;
+		uint32_t threadIndex = JOB_INVALID_THREAD;
+	};
+
+	//Runs a stage's function and records its timing, on whichever thread picked it up
+	void ExecuteStage(uint32_t stageId);
+
+	//Returns true once every dependency of the stage has finished
+	bool AreDependenciesFinished(uint32_t stageId) const;
+private:
+	std::vector<Stage> m_stages;
+
+	//Set once each stage has returned, main thread stages are started by polling these
+	std::vector<std::atomic<bool>> m_finishedStages;
+
+	std::chrono::steady_clock::time_point m_startTime;
+	double m_totalMs;
+};
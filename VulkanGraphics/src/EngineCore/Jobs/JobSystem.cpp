@@ -0,0 +1,466 @@
+#include "JobSystem.h"
+#include "EngineCore/Profiling/TraceRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+//Set in a job's continuation count once it has finished, continuations added after that have nothing to wait for
+#define JOB_CONTINUATIONS_CLOSED 0x80000000u
+
+//Index of the calling thread in the job system, only threads started by (or starting) the job system have one
+static thread_local uint32_t t_threadIndex = JOB_INVALID_THREAD;
+
+JobQueue::JobQueue()
+	:m_top{0}, m_bottom{0}, m_jobs(JOB_QUEUE_SIZE)
+{
+
+}
+
+bool JobQueue::Push(Job* job)
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_acquire);
+	if (bottom - top >= JOB_QUEUE_SIZE)
+	{
+		return false;
+	}
+
+	m_jobs[bottom & (JOB_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+	//The job has to be visible to thieves before the new bottom is
+	m_bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+Job* JobQueue::Pop()
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	//Thieves must see the lowered bottom before the top is read, or both could take the same job
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		//The deque was already empty
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = m_jobs[bottom & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		//This is the last job, so the owner races the thieves for it through the top
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job* JobQueue::Steal()
+{
+	int64_t top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+	{
+		return nullptr;
+	}
+
+	Job* job = m_jobs[top & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+	//Another thief or the owner got to the job first
+	if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	return job;
+}
+
+JobSystem& JobSystem::Get()
+{
+	static JobSystem jobSystem;
+	return jobSystem;
+}
+
+JobSystem::JobSystem()
+	:m_threads(), m_workers(), m_stopping{false}, m_sleepingWorkers{0}
+{
+
+}
+
+JobSystem::~JobSystem()
+{
+	Stop();
+}
+
+uint32_t JobSystem::GetDefaultWorkerCount()
+{
+	uint32_t hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+uint32_t JobSystem::GetThreadIndex()
+{
+	return t_threadIndex;
+}
+
+/******************************************************************************
+* Function Argument 1: The amount of threads to start, the calling thread	  *
+*					   also runs jobs while it waits on them				  *
+******************************************************************************/
+void JobSystem::Start(uint32_t workerCount)
+{
+	if (!m_threads.empty())
+	{
+		return;
+	}
+
+	uint32_t threadCount = std::min(workerCount + 1, static_cast<uint32_t>(JOB_SYSTEM_MAX_THREADS));
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		JobThread* thread = new JobThread;
+		//Any odd seed works for the xorshift, it only has to differ between threads
+		thread->randomState = i * 2654435761u | 1u;
+		m_threads.push_back(thread);
+	}
+
+	t_threadIndex = 0;
+	m_stopping.store(false, std::memory_order_relaxed);
+	for (uint32_t i = 1; i < threadCount; ++i)
+	{
+		m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+void JobSystem::Stop()
+{
+	if (m_threads.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_stopping.store(true, std::memory_order_release);
+	}
+	m_wakeCondition.notify_all();
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+	m_workers.clear();
+
+	for (JobThread* thread : m_threads)
+	{
+		delete thread;
+	}
+	m_threads.clear();
+	t_threadIndex = JOB_INVALID_THREAD;
+}
+
+/***************************************************************************************
+* Function Argument 1: Called with the job once it runs, the job's data holds the	   *
+*					   captures														   *
+* Function Argument 2: Copied into the job's data									   *
+* Function Argument 3: The size of the data, at most JOB_DATA_SIZE					   *
+* Function Argument 4: The job that only finishes once this one has, or nullptr		   *
+***************************************************************************************/
+Job* JobSystem::CreateJob(JobFunction function, const void* data, size_t dataSize, Job* parent)
+{
+	uint32_t threadIndex = t_threadIndex;
+	if (threadIndex == JOB_INVALID_THREAD || threadIndex >= m_threads.size() || dataSize > JOB_DATA_SIZE)
+	{
+		__debugbreak();
+	}
+
+	/* Taking the next finished job of the thread's ring */
+	JobThread& thread = *m_threads[threadIndex];
+	Job* job = nullptr;
+	//Long running jobs (like the root of a parallel for) are skipped until they have finished
+	for (uint32_t attempt = 0; attempt < JOB_POOL_SIZE && !job; ++attempt)
+	{
+		Job* candidate = &thread.pool[thread.nextPoolIndex++ % JOB_POOL_SIZE];
+		if (candidate->recyclable.load(std::memory_order_acquire))
+		{
+			job = candidate;
+		}
+	}
+
+	//Every job of the ring is still alive
+	if (!job)
+	{
+		__debugbreak();
+	}
+	/* Job taken */
+
+	job->function = function;
+	job->parent = parent;
+	job->unfinishedJobs.store(1, std::memory_order_relaxed);
+	job->pendingDependencies.store(1, std::memory_order_relaxed);
+	job->continuationCount.store(0, std::memory_order_relaxed);
+	job->recyclable.store(false, std::memory_order_relaxed);
+	for (std::atomic<Job*>& continuation : job->continuations)
+	{
+		continuation.store(nullptr, std::memory_order_relaxed);
+	}
+	std::memcpy(job->data, data, dataSize);
+
+	if (parent)
+	{
+		parent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+/*********************************************************************************
+* Function Argument 1: The job that waits, it must not have been run yet		 *
+* Function Argument 2: The job that has to finish first							 *
+*********************************************************************************/
+void JobSystem::AddDependency(Job* job, Job* prerequisite)
+{
+	//Counted before the slot is reserved, so the prerequisite finishing right away cannot start the job early
+	job->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+
+	uint32_t slot = prerequisite->continuationCount.fetch_add(1, std::memory_order_acq_rel);
+	if (slot & JOB_CONTINUATIONS_CLOSED)
+	{
+		//The prerequisite already finished, the job still holds its run count so this never reaches 0
+		job->pendingDependencies.fetch_sub(1, std::memory_order_relaxed);
+		return;
+	}
+	if (slot >= JOB_MAX_CONTINUATIONS)
+	{
+		__debugbreak();
+	}
+	prerequisite->continuations[slot].store(job, std::memory_order_release);
+}
+
+void JobSystem::Run(Job* job)
+{
+	ResolveDependency(job);
+}
+
+void JobSystem::Wait(const Job* job)
+{
+	while (!IsFinished(job))
+	{
+		if (!RunPendingJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool JobSystem::RunPendingJob()
+{
+	Job* job = FindJob(t_threadIndex);
+	if (!job)
+	{
+		return false;
+	}
+
+	Execute(job);
+	return true;
+}
+
+void JobSystem::ResolveDependency(Job* job)
+{
+	if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		Submit(job);
+	}
+}
+
+void JobSystem::Submit(Job* job)
+{
+	uint32_t threadIndex = t_threadIndex;
+	if (threadIndex == JOB_INVALID_THREAD || threadIndex >= m_threads.size())
+	{
+		__debugbreak();
+	}
+
+	//A full deque means the other threads already have plenty to steal, so the job just runs here
+	if (!m_threads[threadIndex]->queue.Push(job))
+	{
+		Execute(job);
+		return;
+	}
+	WakeWorker();
+}
+
+void JobSystem::Execute(Job* job)
+{
+	job->function(*job);
+	Finish(job);
+}
+
+void JobSystem::Finish(Job* job)
+{
+	if (job->unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+	{
+		return;
+	}
+	Job* parent = job->parent;
+
+	/* Starting the jobs that waited on this one */
+	uint32_t count = job->continuationCount.fetch_or(JOB_CONTINUATIONS_CLOSED, std::memory_order_acq_rel);
+	count = std::min(count, static_cast<uint32_t>(JOB_MAX_CONTINUATIONS));
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		//The slot was reserved before the job finished, but its writer may not have stored the job yet
+		Job* continuation = job->continuations[i].load(std::memory_order_acquire);
+		while (!continuation)
+		{
+			std::this_thread::yield();
+			continuation = job->continuations[i].load(std::memory_order_acquire);
+		}
+		ResolveDependency(continuation);
+	}
+	/* Continuations started */
+
+	job->recyclable.store(true, std::memory_order_release);
+	if (parent)
+	{
+		Finish(parent);
+	}
+}
+
+Job* JobSystem::FindJob(uint32_t threadIndex)
+{
+	if (threadIndex == JOB_INVALID_THREAD || threadIndex >= m_threads.size())
+	{
+		return nullptr;
+	}
+
+	JobThread& thread = *m_threads[threadIndex];
+	Job* job = thread.queue.Pop();
+	if (job)
+	{
+		return job;
+	}
+
+	/* Stealing from the other threads, starting at a random one */
+	uint32_t threadCount = static_cast<uint32_t>(m_threads.size());
+	thread.randomState ^= thread.randomState << 13;
+	thread.randomState ^= thread.randomState >> 17;
+	thread.randomState ^= thread.randomState << 5;
+	uint32_t first = thread.randomState % threadCount;
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		uint32_t victim = (first + i) % threadCount;
+		if (victim == threadIndex)
+		{
+			continue;
+		}
+
+		job = m_threads[victim]->queue.Steal();
+		if (job)
+		{
+			return job;
+		}
+	}
+	/* Nothing to steal */
+
+	return nullptr;
+}
+
+void JobSystem::WorkerLoop(uint32_t threadIndex)
+{
+	t_threadIndex = threadIndex;
+	TraceRecorder::Get().SetThreadName("Job worker " + std::to_string(threadIndex));
+
+	uint32_t idleCount = 0;
+	while (!m_stopping.load(std::memory_order_acquire))
+	{
+		Job* job = FindJob(threadIndex);
+		if (job)
+		{
+			Execute(job);
+			idleCount = 0;
+			continue;
+		}
+
+		//Spinning a little first, since more jobs usually follow soon after the last one
+		if (++idleCount < JOB_WORKER_SPIN_COUNT)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		idleCount = 0;
+		Sleep();
+	}
+}
+
+void JobSystem::Sleep()
+{
+	std::unique_lock<std::mutex> lock(m_sleepMutex);
+	m_sleepingWorkers.fetch_add(1, std::memory_order_relaxed);
+	//Pairs with the fence in WakeWorker: either the submitting thread sees this worker sleeping, or this worker sees its job
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	bool anyJobs = false;
+	for (JobThread* thread : m_threads)
+	{
+		anyJobs = anyJobs || !thread->queue.IsEmpty();
+	}
+	if (!anyJobs && !m_stopping.load(std::memory_order_relaxed))
+	{
+		m_wakeCondition.wait_for(lock, std::chrono::milliseconds(JOB_WORKER_SLEEP_MS));
+	}
+
+	m_sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void JobSystem::WakeWorker()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_sleepingWorkers.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	//Taking the lock means the worker is either still looking at the deques or already waiting, so the wake up is not lost
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+	}
+	m_wakeCondition.notify_one();
+}
+
+void JobSystem::ExecuteParallelForRoot(Job& job)
+{
+	const ParallelForData& data = *reinterpret_cast<const ParallelForData*>(job.data);
+	Get().SplitParallelFor(&job, 0, data.count);
+}
+
+void JobSystem::ExecuteParallelForRange(Job& job)
+{
+	const ParallelForRange& range = *reinterpret_cast<const ParallelForRange*>(job.data);
+	Get().SplitParallelFor(range.root, range.begin, range.end);
+}
+
+/***********************************************************************************
+* Function Argument 1: The parallel for's root job, which holds the function and   *
+*					   only finishes once every range split off it has			   *
+* Function Argument 2: The first item of the range								   *
+* Function Argument 3: One past the last item of the range						   *
+***********************************************************************************/
+void JobSystem::SplitParallelFor(Job* root, uint32_t begin, uint32_t end)
+{
+	const ParallelForData& data = *reinterpret_cast<const ParallelForData*>(root->data);
+
+	//Halving the range keeps the biggest pieces at the top of the deque, where thieves take them from
+	while (end - begin > data.batchSize)
+	{
+		uint32_t batches = (end - begin + data.batchSize - 1) / data.batchSize;
+		uint32_t middle = begin + batches / 2 * data.batchSize;
+
+		ParallelForRange range = { root, middle, end };
+		Run(CreateJob(&ExecuteParallelForRange, &range, sizeof(range), root));
+		end = middle;
+	}
+
+	data.invokeRange(data.function, begin, end);
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//Most threads jobs can run on, the thread that starts the job system included
+#define JOB_SYSTEM_MAX_THREADS 64
+
+//Jobs each thread allocates from its ring. Jobs are reused once they have finished, so a job handle stays valid
+//until the thread that created it has created this many more jobs, and no more than this many can be alive at once
+#define JOB_POOL_SIZE 4096
+
+//Capacity of each thread's deque, must be a power of two. Jobs submitted to a full deque run right away
+#define JOB_QUEUE_SIZE 4096
+
+//Bytes of captured state a job function can carry
+#define JOB_DATA_SIZE 64
+
+//Jobs that can wait on the same job before it finishes, a parent job can be used to group more
+#define JOB_MAX_CONTINUATIONS 4
+
+//Idle workers look for work this many times before they go to sleep
+#define JOB_WORKER_SPIN_COUNT 256
+
+//Sleeping workers are woken when jobs are submitted, this timeout only bounds how long a missed wake up can last
+#define JOB_WORKER_SLEEP_MS 10
+
+#define JOB_INVALID_THREAD 0xFFFFFFFF
+
+struct Job;
+typedef void (*JobFunction)(Job& job);
+
+/****************************************************************
+* A single unit of work and the counters that track it. A job   *
+* is finished once its function and every one of its children   *
+* have returned, then the jobs depending on it can start.	    *
+* Handles to jobs are plain pointers into the creating thread's *
+* ring of jobs, so creating one never allocates memory		    *
+****************************************************************/
+struct alignas(64) Job
+{
+	JobFunction function = nullptr;
+	Job* parent = nullptr;
+
+	//The job itself and every child that has not finished yet, the job is finished once this reaches 0
+	std::atomic<int32_t> unfinishedJobs{0};
+
+	//Prerequisites that have not finished yet, plus one until the job is run
+	std::atomic<int32_t> pendingDependencies{0};
+
+	//Jobs waiting on this one, the count's top bit is set once the job has finished and no more can be added
+	std::atomic<uint32_t> continuationCount{0};
+
+	//Set once finishing the job no longer touches it, only then can the ring hand it out again
+	std::atomic<bool> recyclable{true};
+
+	std::atomic<Job*> continuations[JOB_MAX_CONTINUATIONS] = {};
+
+	//The captures of the job's function
+	alignas(16) unsigned char data[JOB_DATA_SIZE] = {};
+};
+
+/********************************************************************
+* A fixed size Chase-Lev work stealing deque. The owning thread	    *
+* pushes and pops jobs at the bottom without taking a lock, other   *
+* threads steal the oldest jobs from the top. Only a race for the   *
+* last job in the deque costs a compare exchange				    *
+********************************************************************/
+class JobQueue
+{
+public:
+	JobQueue();
+
+	//Only called by the owning thread, returns false if the deque is full
+	bool Push(Job* job);
+
+	//Only called by the owning thread, takes the job pushed last
+	Job* Pop();
+
+	//Called by any other thread, takes the job pushed first
+	Job* Steal();
+
+	//May be out of date by the time it returns, only used to decide whether sleeping is worth it
+	inline bool IsEmpty() const
+	{
+		return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+	}
+private:
+	//Kept on separate cache lines, the top is written by thieves and the bottom by the owner
+	alignas(64) std::atomic<int64_t> m_top;
+	alignas(64) std::atomic<int64_t> m_bottom;
+	std::vector<std::atomic<Job*>> m_jobs;
+};
+
+/****************************************************************************
+* Runs jobs on a fixed pool of worker threads, plus the thread that		    *
+* started it while it waits on a job. Every thread owns a deque that the    *
+* jobs it creates are pushed to, threads out of work steal from the others. *
+* Jobs can have children (the parent only finishes after them) and		    *
+* dependencies (the job only starts after them), and only the threads of    *
+* the job system can create and run jobs								    *
+****************************************************************************/
+class JobSystem
+{
+public:
+	//The job system is shared by the whole engine, so there is a single instance of it
+	static JobSystem& Get();
+
+	//One worker for every hardware thread besides the one that starts the job system
+	static uint32_t GetDefaultWorkerCount();
+
+	//Returns the index of the calling thread (0 for the thread that started the job system), or JOB_INVALID_THREAD
+	static uint32_t GetThreadIndex();
+
+	//Makes the calling thread thread 0 and starts workerCount worker threads, does nothing if already started
+	void Start(uint32_t workerCount);
+
+	//Stops and joins the worker threads, every job must have finished
+	void Stop();
+
+	//Creates a job that calls function(job), the job only starts once it is run. The parent, if any, must not have finished
+	Job* CreateJob(JobFunction function, const void* data, size_t dataSize, Job* parent = nullptr);
+
+	//Creates a job that calls a lambda, whose captures are copied into the job so they must be small and trivially copyable
+	template<typename Function>
+	Job* CreateJob(const Function& function, Job* parent = nullptr)
+	{
+		static_assert(sizeof(Function) <= JOB_DATA_SIZE, "The captures of a job must fit in JOB_DATA_SIZE");
+		static_assert(alignof(Function) <= 16, "The captures of a job must not need more than 16 byte alignment");
+		static_assert(std::is_trivially_copyable<Function>::value && std::is_trivially_destructible<Function>::value,
+			"The captures of a job are copied as bytes and never destroyed");
+		return CreateJob(&InvokeFunction<Function>, &function, sizeof(Function), parent);
+	}
+
+	//Creates a job that calls function(begin, end) on ranges of at most batchSize items covering [0, count).
+	//The ranges are split off as other threads steal them, the job finishes once every range has
+	template<typename Function>
+	Job* CreateParallelForJob(uint32_t count, uint32_t batchSize, const Function& function, Job* parent = nullptr)
+	{
+		static_assert(sizeof(Function) <= sizeof(ParallelForData::function), "The captures of a parallel for must fit in its job");
+		static_assert(alignof(Function) <= 16, "The captures of a job must not need more than 16 byte alignment");
+		static_assert(std::is_trivially_copyable<Function>::value && std::is_trivially_destructible<Function>::value,
+			"The captures of a job are copied as bytes and never destroyed");
+
+		ParallelForData data{};
+		data.invokeRange = &InvokeRange<Function>;
+		data.count = count;
+		data.batchSize = batchSize > 0 ? batchSize : 1;
+		new (data.function) Function(function);
+		return CreateJob(&ExecuteParallelForRoot, &data, sizeof(data), parent);
+	}
+
+	//Runs function(begin, end) over [0, count) like CreateParallelForJob, and returns once every range has finished
+	template<typename Function>
+	void ParallelFor(uint32_t count, uint32_t batchSize, const Function& function)
+	{
+		//A single batch is not worth a job
+		if (count <= batchSize)
+		{
+			function(0u, count);
+			return;
+		}
+
+		Job* job = CreateParallelForJob(count, batchSize, function);
+		Run(job);
+		Wait(job);
+	}
+
+	//Makes job wait for prerequisite to finish before it starts. Must be called before job is run,
+	//the prerequisite can already be running or even finished
+	void AddDependency(Job* job, Job* prerequisite);
+
+	//Submits the job to the calling thread's deque once all of its dependencies have finished
+	void Run(Job* job);
+
+	//Runs other jobs on the calling thread until the job has finished
+	void Wait(const Job* job);
+
+	//Runs a single job from the calling thread's deque or stolen from another thread, returns false if none was found
+	bool RunPendingJob();
+
+	inline bool IsFinished(const Job* job) const { return job->unfinishedJobs.load(std::memory_order_acquire) == 0; }
+
+	/* Member variable getters */
+	//Worker threads plus the thread that started the job system, 0 while it is stopped
+	inline uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+	/* End member variable getters */
+private:
+	//The state of one thread of the job system
+	struct JobThread
+	{
+		//Jobs hold atomics, so the ring is sized on construction rather than resized
+		JobThread() : queue(), pool(JOB_POOL_SIZE) {}
+
+		JobQueue queue;
+		std::vector<Job> pool;
+		uint32_t nextPoolIndex = 0;
+		//Picks the first thread to steal from, so thieves do not all start on the same deque
+		uint32_t randomState = 0;
+	};
+
+	//Stored in the data of a parallel for's root job, the jobs running its ranges read it from there
+	struct ParallelForData
+	{
+		void (*invokeRange)(const void* function, uint32_t begin, uint32_t end);
+		uint32_t count;
+		uint32_t batchSize;
+		alignas(16) unsigned char function[JOB_DATA_SIZE - 16];
+	};
+
+	//Stored in the data of every job split off a parallel for
+	struct ParallelForRange
+	{
+		Job* root;
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	JobSystem();
+	~JobSystem();
+
+	template<typename Function>
+	static void InvokeFunction(Job& job)
+	{
+		(*reinterpret_cast<const Function*>(job.data))();
+	}
+
+	template<typename Function>
+	static void InvokeRange(const void* function, uint32_t begin, uint32_t end)
+	{
+		(*reinterpret_cast<const Function*>(function))(begin, end);
+	}
+
+	static void ExecuteParallelForRoot(Job& job);
+
+	static void ExecuteParallelForRange(Job& job);
+
+	//Called by the parallel for jobs to split off half of their range until a single batch is left, then run it
+	void SplitParallelFor(Job* root, uint32_t begin, uint32_t end);
+
+	//Runs on each worker thread, running jobs until the job system is stopped
+	void WorkerLoop(uint32_t threadIndex);
+
+	//Called by idle workers, blocks until a job is submitted or JOB_WORKER_SLEEP_MS have passed
+	void Sleep();
+
+	//Wakes one sleeping worker, if there is any
+	void WakeWorker();
+
+	//Returns a job from the thread's own deque or stolen from another one, or nullptr if every deque is empty
+	Job* FindJob(uint32_t threadIndex);
+
+	//Pushes a job whose dependencies have all finished to the calling thread's deque
+	void Submit(Job* job);
+
+	void Execute(Job* job);
+
+	//Called once a job's function or one of its children returns, finishes the job once nothing of it is left
+	void Finish(Job* job);
+
+	//Called when one of the job's prerequisites has finished (or it was run), submits the job once none are left
+	void ResolveDependency(Job* job);
+private:
+	std::vector<JobThread*> m_threads;
+	std::vector<std::thread> m_workers;
+
+	std::atomic<bool> m_stopping;
+
+	//Workers that are about to sleep or sleeping, read on every submit so they are only woken when needed
+	std::atomic<uint32_t> m_sleepingWorkers;
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wakeCondition;
+};
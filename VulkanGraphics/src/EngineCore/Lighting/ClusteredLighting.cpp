@@ -0,0 +1,318 @@
+#include "ClusteredLighting.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+VulkanClusteredLightingHandle::VulkanClusteredLightingHandle()
+	:m_lightBuffer(), m_constantBuffers(), m_clusterBuffer(), m_lightIndexBuffer(), m_counterBuffer(),
+	vk_descriptorSetLayout{VK_NULL_HANDLE}, vk_descriptorPool{VK_NULL_HANDLE}, vk_descriptorSets(),
+	vk_binningPipelineLayout{VK_NULL_HANDLE}, vk_binningPipeline{VK_NULL_HANDLE}, m_lightCount{0}, m_activeLightCount{0},
+	m_created{false}
+{
+
+}
+
+/****************************************************************************************
+* Function Argument 1: Used to create the buffers									    *
+* Function Argument 2: Makes the set layout and compiles the binning shader			    *
+* Function Argument 3: The cache the binning pipeline is compiled through			    *
+* Function Argument 4: How many lights are created, all of them are lit at first	    *
+* Function Argument 5: How many frames can be recorded before the GPU finishes the oldest *
+* Function Arguments 6 and 7: The sphere the lights are scattered through			    *
+****************************************************************************************/
+void VulkanClusteredLightingHandle::CreateClusteredLighting(const VulkanDeviceHandle& device,
+	VulkanGraphicsPipelineHandle& pipelines, const VkPipelineCache& pipelineCache, uint32_t lightCount,
+	uint32_t framesInFlight, const Vec3& sceneCenter, float sceneRadius)
+{
+	if (!device.IsComputeSupportedOnGraphicsQueue() || lightCount == 0)
+	{
+		return;
+	}
+
+	m_lightCount = std::min(lightCount, CLUSTERED_LIGHTING_MAX_LIGHTS);
+	m_activeLightCount = m_lightCount;
+
+	/* Creating the lighting buffers */
+	//The lights are written once and the camera every frame, both are small enough to be read from host visible memory
+	m_lightBuffer.CreateBuffer(device, sizeof(LightGpu) * m_lightCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_constantBuffers.resize(framesInFlight);
+	for (VulkanBufferHandle& buffer : m_constantBuffers)
+	{
+		buffer.CreateBuffer(device, sizeof(ClusterConstantsGpu), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	}
+
+	//The cluster lists are only touched by the GPU, the counter is cleared with a fill before every binning
+	m_clusterBuffer.CreateBuffer(device, sizeof(uint32_t) * 2 * CLUSTER_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_lightIndexBuffer.CreateBuffer(device, sizeof(uint32_t) * CLUSTER_COUNT * CLUSTER_AVERAGE_LIGHTS,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_counterBuffer.CreateBuffer(device, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	/* Lighting buffers created */
+
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	CreateDescriptorSets(vk_device, pipelines.GetLayoutCache(), framesInFlight);
+	ScatterLights(sceneCenter, sceneRadius);
+
+	/* Creating the binning pipeline */
+	vk_binningPipelineLayout = pipelines.GetReflectedPipelineLayout(vk_device, { "Shaders/clusterBinning.spv" },
+		{ vk_descriptorSetLayout });
+
+	//The group size the dispatch is counted in, and the length of the list every thread collects its cluster's lights in
+	ShaderVariantKey variant;
+	variant.Set(SHADER_CONSTANT_CLUSTER_GROUP_SIZE, CLUSTER_BINNING_GROUP_SIZE)
+		.Set(SHADER_CONSTANT_CLUSTER_MAX_LIGHTS, CLUSTER_MAX_LIGHTS);
+	pipelines.CreateComputePipeline(vk_device, pipelineCache, "Shaders/clusterBinning.spv", vk_binningPipelineLayout,
+		vk_binningPipeline, variant);
+	/* Binning pipeline created */
+
+	m_created = true;
+}
+
+/************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation		*
+* Function Argument 2: Makes and owns the set layout, shared with the mesh pipeline *
+* Function Argument 3: A set is allocated for each frame in flight				    *
+************************************************************************************/
+void VulkanClusteredLightingHandle::CreateDescriptorSets(const VkDevice& device, VulkanLayoutCache& layoutCache,
+	uint32_t framesInFlight)
+{
+	/* Creating the descriptor set layout */
+	//The constants, then the lights, the clusters, the index list and the counter. The fragment shader reads all but
+	//the counter, which only the binning uses
+	VkDescriptorSetLayoutBinding bindings[5]{};
+	for (uint32_t i = 0; i < 5; ++i)
+	{
+		bindings[i].binding = i;
+		bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | (i < 4 ? VK_SHADER_STAGE_FRAGMENT_BIT : 0);
+	}
+
+	vk_descriptorSetLayout = layoutCache.GetDescriptorSetLayout(device,
+		std::vector<VkDescriptorSetLayoutBinding>(bindings, bindings + 5));
+	/* Descriptor set layout created */
+
+	/* Allocating the descriptor sets */
+	VkDescriptorPoolSize poolSizes[2]{};
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSizes[0].descriptorCount = framesInFlight;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSizes[1].descriptorCount = 4 * framesInFlight;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = framesInFlight;
+	poolInfo.poolSizeCount = 2;
+	poolInfo.pPoolSizes = poolSizes;
+
+	VkResult poolResult = vkCreateDescriptorPool(device, &poolInfo, nullptr, &vk_descriptorPool);
+	if (poolResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	std::vector<VkDescriptorSetLayout> setLayouts(framesInFlight, vk_descriptorSetLayout);
+	VkDescriptorSetAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = vk_descriptorPool;
+	allocateInfo.descriptorSetCount = framesInFlight;
+	allocateInfo.pSetLayouts = setLayouts.data();
+
+	vk_descriptorSets.resize(framesInFlight, VK_NULL_HANDLE);
+	VkResult allocateResult = vkAllocateDescriptorSets(device, &allocateInfo, vk_descriptorSets.data());
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	/* Descriptor sets allocated */
+
+	//Only the constants differ between the sets. The cluster lists are shared, the binning of a frame waits for
+	//the previous frame's fragments to be done reading them
+	for (uint32_t frame = 0; frame < framesInFlight; ++frame)
+	{
+		const VulkanBufferHandle* buffers[5] = { &m_constantBuffers[frame], &m_lightBuffer, &m_clusterBuffer,
+			&m_lightIndexBuffer, &m_counterBuffer };
+		VkDescriptorBufferInfo bufferInfos[5]{};
+		VkWriteDescriptorSet writes[5]{};
+		for (uint32_t i = 0; i < 5; ++i)
+		{
+			bufferInfos[i].buffer = buffers[i]->GetVulkanSDKBuffer();
+			bufferInfos[i].offset = 0;
+			bufferInfos[i].range = VK_WHOLE_SIZE;
+
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = vk_descriptorSets[frame];
+			writes[i].dstBinding = i;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = bindings[i].descriptorType;
+			writes[i].pBufferInfo = &bufferInfos[i];
+		}
+		vkUpdateDescriptorSets(device, 5, writes, 0, nullptr);
+	}
+}
+
+/******************************************************************
+* Function Argument 1: The center of the sphere the lights fill   *
+* Function Argument 2: Its radius, the light ranges are sized to it *
+******************************************************************/
+void VulkanClusteredLightingHandle::ScatterLights(const Vec3& sceneCenter, float sceneRadius)
+{
+	//A fixed seed places the lights the same way every launch, so benchmark runs can be compared
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	//Each light's sphere covers CLUSTERED_LIGHTING_COVERAGE times its share of the scene sphere's volume
+	float range = sceneRadius * std::cbrt(CLUSTERED_LIGHTING_COVERAGE / static_cast<float>(m_lightCount));
+
+	LightGpu* lights = static_cast<LightGpu*>(m_lightBuffer.GetMappedData());
+	for (uint32_t i = 0; i < m_lightCount; ++i)
+	{
+		//Rejection sampling keeps the positions uniform inside the sphere instead of bunching up in the corners of a cube
+		Vec3 offset;
+		do
+		{
+			offset = { unit(random), unit(random), unit(random) };
+		} while (Dot(offset, offset) > 1.0f);
+		Vec3 position = sceneCenter + offset * sceneRadius;
+
+		LightGpu& light = lights[i];
+		light.positionRange[0] = position.x;
+		light.positionRange[1] = position.y;
+		light.positionRange[2] = position.z;
+		light.positionRange[3] = range;
+
+		//Bright saturated colors, so the contribution of each light is easy to tell apart
+		float hue = (unit(random) + 1.0f) * 3.0f;
+		light.colorOuterCos[0] = std::min(std::max(std::fabs(hue - 3.0f) - 1.0f, 0.0f), 1.0f) * 2.0f;
+		light.colorOuterCos[1] = std::min(std::max(2.0f - std::fabs(hue - 2.0f), 0.0f), 1.0f) * 2.0f;
+		light.colorOuterCos[2] = std::min(std::max(2.0f - std::fabs(hue - 4.0f), 0.0f), 1.0f) * 2.0f;
+
+		if (i % CLUSTERED_LIGHTING_SPOT_INTERVAL == 0)
+		{
+			//Spot lights point down at the scene, tilted a little to a random side
+			Vec3 direction = Normalize(Vec3{ unit(random) * 0.5f, -1.0f, unit(random) * 0.5f });
+			light.directionInnerCos[0] = direction.x;
+			light.directionInnerCos[1] = direction.y;
+			light.directionInnerCos[2] = direction.z;
+			light.directionInnerCos[3] = std::cos(0.3f);
+			light.colorOuterCos[3] = std::cos(0.5f);
+		}
+		else
+		{
+			//Every direction is inside a cone whose outer cosine is below -1, the spot term is always 1
+			light.directionInnerCos[0] = 0.0f;
+			light.directionInnerCos[1] = -1.0f;
+			light.directionInnerCos[2] = 0.0f;
+			light.directionInnerCos[3] = -1.0f;
+			light.colorOuterCos[3] = -2.0f;
+		}
+	}
+}
+
+void VulkanClusteredLightingHandle::SetActiveLightCount(uint32_t lightCount)
+{
+	m_activeLightCount = std::min(lightCount, m_lightCount);
+}
+
+/*************************************************************************************
+* Function Argument 1: The frame in flight being recorded							 *
+* Function Argument 2: The world to view matrix of the camera						 *
+* Function Arguments 3 and 4: The camera's vertical field of view and aspect ratio   *
+* Function Arguments 5 and 6: The depths the first slice starts and the last one ends *
+*************************************************************************************/
+void VulkanClusteredLightingHandle::Update(uint32_t frameIndex, const Mat4& view, float verticalFov, float aspectRatio,
+	float nearPlane, float farPlane)
+{
+	if (!m_created)
+	{
+		return;
+	}
+
+	ClusterConstantsGpu constants{};
+	std::memcpy(constants.view, view.m, sizeof(constants.view));
+	constants.tanHalfFov[1] = std::tan(verticalFov * 0.5f);
+	constants.tanHalfFov[0] = constants.tanHalfFov[1] * aspectRatio;
+	constants.nearPlane = nearPlane;
+	constants.farPlane = farPlane;
+
+	//Slice k starts at near * (far / near)^(k / CLUSTER_GRID_Z)
+	float logRatio = std::log(farPlane / nearPlane);
+	constants.sliceScale = CLUSTER_GRID_Z / logRatio;
+	constants.sliceBias = -CLUSTER_GRID_Z * std::log(nearPlane) / logRatio;
+
+	//Fewer lights cover the scene as much as the full set by reaching further
+	constants.lightCount = m_activeLightCount;
+	constants.lightRangeScale = m_activeLightCount == 0 ? 1.0f :
+		std::cbrt(static_cast<float>(m_lightCount) / static_cast<float>(m_activeLightCount));
+
+	constants.gridSize[0] = CLUSTER_GRID_X;
+	constants.gridSize[1] = CLUSTER_GRID_Y;
+	constants.gridSize[2] = CLUSTER_GRID_Z;
+	constants.gridSize[3] = CLUSTER_COUNT * CLUSTER_AVERAGE_LIGHTS;
+
+	std::memcpy(m_constantBuffers[frameIndex].GetMappedData(), &constants, sizeof(constants));
+}
+
+/*************************************************************************************
+* Function Argument 1: The frame's command buffer, outside of the render pass		 *
+* Function Argument 2: The binning is timed in a scope of its own					 *
+* Function Argument 3: The frame in flight, whose set holds the frame's camera		 *
+*************************************************************************************/
+void VulkanClusteredLightingHandle::RecordBinning(const VkCommandBuffer& commandBuffer, VulkanGpuProfilerHandle& profiler,
+	uint32_t frameIndex) const
+{
+	if (!m_created)
+	{
+		return;
+	}
+
+	GpuProfileScope binningScope(profiler, commandBuffer, "LightBinning", false);
+
+	//The last frame's fragments have to be done reading the cluster lists before they are written again. Only the
+	//order matters, its binning's writes were already made visible by the barrier that ended it
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+	//Every cluster reserves its part of the index list from this counter
+	vkCmdFillBuffer(commandBuffer, m_counterBuffer.GetVulkanSDKBuffer(), 0, sizeof(uint32_t), 0);
+	VkMemoryBarrier clearBarrier{};
+	clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+		&clearBarrier, 0, nullptr, 0, nullptr);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk_binningPipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk_binningPipelineLayout, 0, 1,
+		&vk_descriptorSets[frameIndex], 0, nullptr);
+	vkCmdDispatch(commandBuffer, (CLUSTER_COUNT + CLUSTER_BINNING_GROUP_SIZE - 1) / CLUSTER_BINNING_GROUP_SIZE, 1, 1);
+
+	//The mesh's fragments read the lists the binning wrote
+	VkMemoryBarrier binningBarrier{};
+	binningBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	binningBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	binningBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1,
+		&binningBarrier, 0, nullptr, 0, nullptr);
+}
+
+void VulkanClusteredLightingHandle::Cleanup(const VkDevice& device)
+{
+	vkDestroyPipeline(device, vk_binningPipeline, nullptr);
+	//Destroying the pool frees the sets allocated from it
+	vkDestroyDescriptorPool(device, vk_descriptorPool, nullptr);
+	m_counterBuffer.Cleanup(device);
+	m_lightIndexBuffer.Cleanup(device);
+	m_clusterBuffer.Cleanup(device);
+	for (VulkanBufferHandle& buffer : m_constantBuffers)
+	{
+		buffer.Cleanup(device);
+	}
+	m_lightBuffer.Cleanup(device);
+	m_created = false;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vector>
+#include "EngineCore/VulkanHandles/VulkanBuffer.h"
+#include "EngineCore/VulkanHandles/VulkanGraphicsPipeline.h"
+#include "EngineCore/Profiling/VulkanGpuProfiler.h"
+#include "EngineCore/Math/VectorMath.h"
+
+//The view frustum is split into this many clusters across, down and in depth. The depth slices grow exponentially,
+//so a cluster covers about as many pixels deep as it does across
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define CLUSTER_COUNT (CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z)
+
+//The most lights a single cluster lists, the binning drops the lights past it
+#define CLUSTER_MAX_LIGHTS 128
+
+//The light index list of every cluster is packed into one buffer, sized for this many lights per cluster on average
+#define CLUSTER_AVERAGE_LIGHTS 32
+
+//Threads per group of the binning shader, each thread bins one cluster and loads one light of each batch
+#define CLUSTER_BINNING_GROUP_SIZE 64
+
+//The most lights the clustered lighting can be created with
+#define CLUSTERED_LIGHTING_MAX_LIGHTS (1u << 14)
+
+//Lights are scattered through the scene's bounding sphere, with ranges sized so that about this many of them
+//reach any point of it however many lights there are
+#define CLUSTERED_LIGHTING_COVERAGE 6.0f
+
+//One light in every this many is a spot light, the others are point lights
+#define CLUSTERED_LIGHTING_SPOT_INTERVAL 4
+
+//Matches Light in ClusteredLighting.glsl
+struct LightGpu
+{
+	//World space position, and the distance the light reaches before the range scale of the frame
+	float positionRange[4];
+	//Linear color times intensity, and the cosine of the spot cone's outer angle, below -1 for point lights
+	float colorOuterCos[4];
+	//World space direction the spot light points in, and the cosine of the cone's inner angle
+	float directionInnerCos[4];
+};
+
+//Matches ClusterConstants in ClusteredLighting.glsl, a uniform buffer laid out with std140
+struct ClusterConstantsGpu
+{
+	float view[16];
+	//How far a view space position can be from the view axis at a depth of 1, horizontally and vertically
+	float tanHalfFov[2];
+	float nearPlane;
+	float farPlane;
+	//The depth slice of a view space depth is log(depth) * sliceScale + sliceBias
+	float sliceScale;
+	float sliceBias;
+	uint32_t lightCount;
+	//Multiplies the range of every light, so the coverage stays the same while the light count changes
+	float lightRangeScale;
+	//The cluster grid, and the length of the light index list
+	uint32_t gridSize[4];
+};
+
+/********************************************************************
+* Clustered forward lighting. The view frustum is divided into a	*
+* grid of clusters, screen tiles cut into exponential depth slices. *
+* Every frame a compute pass tests every light against every		*
+* cluster's view space box and writes a compact list of the lights  *
+* that reach it. The mesh's fragment shader finds its cluster from  *
+* its screen position and depth and only shades the lights listed   *
+* for it, so the shading cost follows how many lights overlap a     *
+* pixel rather than how many lights there are					    *
+********************************************************************/
+class VulkanClusteredLightingHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanClusteredLightingHandle();
+
+	//Creates the light and cluster buffers, a descriptor set for every frame in flight and the binning pipeline, and
+	//scatters the lights through the given sphere. Does nothing if the graphics queue cannot run compute shaders,
+	//the mesh is then drawn without lights
+	void CreateClusteredLighting(const VulkanDeviceHandle& device, VulkanGraphicsPipelineHandle& pipelines,
+		const VkPipelineCache& pipelineCache, uint32_t lightCount, uint32_t framesInFlight, const Vec3& sceneCenter,
+		float sceneRadius);
+
+	//Lights only the first lightCount lights, clamped to the lights created. Their ranges grow as fewer are lit
+	void SetActiveLightCount(uint32_t lightCount);
+
+	//Writes the camera and the light count into the frame's uniform buffer, which the GPU is done reading.
+	//The depth slices are spread between the near and far planes given, which only have to cover the lit scene
+	void Update(uint32_t frameIndex, const Mat4& view, float verticalFov, float aspectRatio, float nearPlane,
+		float farPlane);
+
+	//Records the binning of the lights into the clusters, outside of a render pass and before the mesh is drawn
+	void RecordBinning(const VkCommandBuffer& commandBuffer, VulkanGpuProfilerHandle& profiler,
+		uint32_t frameIndex) const;
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline bool IsCreated() const { return m_created; }
+
+	inline uint32_t GetLightCount() const { return m_lightCount; }
+
+	inline uint32_t GetActiveLightCount() const { return m_activeLightCount; }
+
+	//VK_NULL_HANDLE unless the lighting has been created
+	inline const VkDescriptorSetLayout& GetVulkanSDKSetLayout() const { return vk_descriptorSetLayout; }
+
+	inline const VkDescriptorSet& GetVulkanSDKDescriptorSet(uint32_t frameIndex) const
+	{
+		return vk_descriptorSets[frameIndex];
+	}
+	/* End member variable getters */
+private:
+	//Called by CreateClusteredLighting to create the descriptor sets pointing at the buffers
+	void CreateDescriptorSets(const VkDevice& device, VulkanLayoutCache& layoutCache, uint32_t framesInFlight);
+
+	//Called by CreateClusteredLighting to fill the light buffer with lights of random colors inside the sphere
+	void ScatterLights(const Vec3& sceneCenter, float sceneRadius);
+private:
+	//Written once when the lights are scattered, and only read by the GPU afterwards
+	VulkanBufferHandle m_lightBuffer;
+
+	//A uniform buffer for every frame in flight, so the camera of a frame is never written while the GPU reads it
+	std::vector<VulkanBufferHandle> m_constantBuffers;
+
+	//Filled by the binning pass every frame: the offset and count of every cluster's lights in the index list,
+	//the index list, and the counter the clusters reserve their part of the list with
+	VulkanBufferHandle m_clusterBuffer;
+	VulkanBufferHandle m_lightIndexBuffer;
+	VulkanBufferHandle m_counterBuffer;
+
+	//The set layout and the binning pipeline layout are owned by the layout cache
+	VkDescriptorSetLayout vk_descriptorSetLayout;
+	VkDescriptorPool vk_descriptorPool;
+	std::vector<VkDescriptorSet> vk_descriptorSets;
+
+	VkPipelineLayout vk_binningPipelineLayout;
+	VkPipeline vk_binningPipeline;
+
+	uint32_t m_lightCount;
+	uint32_t m_activeLightCount;
+
+	bool m_created;
+};
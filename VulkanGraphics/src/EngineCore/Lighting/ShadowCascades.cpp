@@ -0,0 +1,471 @@
+#include "ShadowCascades.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+VulkanShadowCascadesHandle::VulkanShadowCascadesHandle()
+	:vk_image{VK_NULL_HANDLE}, vk_memory{VK_NULL_HANDLE}, vk_format{VK_FORMAT_UNDEFINED}, vk_arrayView{VK_NULL_HANDLE},
+	vk_layerViews(), vk_framebuffers(), vk_sampler{VK_NULL_HANDLE}, m_constantBuffers(),
+	vk_descriptorSetLayout{VK_NULL_HANDLE}, vk_descriptorPool{VK_NULL_HANDLE}, vk_descriptorSets(), m_cascades(),
+	m_casterVisibility(), m_renderedCascades{0}, m_renderedCascadeCount{0}, m_lightDirection(), m_lightView(),
+	m_version{0}, m_created{false}
+{
+	//The fixed light of VulkanMesh.vert, which the shadowed shaders rebuild
+	SetLightDirection({ 0.4f, 1.0f, 0.3f });
+}
+
+VkFormat VulkanShadowCascadesHandle::FindShadowMapFormat(const VkPhysicalDevice& physicalDevice)
+{
+	//32 bit float depth is the most precise, every GPU can draw to and sample 16 bit depth
+	const VkFormat candidates[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM };
+	const VkFormatFeatureFlags features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT |
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+	for (VkFormat format : candidates)
+	{
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+		if ((properties.optimalTilingFeatures & features) == features)
+		{
+			return format;
+		}
+	}
+
+	__debugbreak();
+	return VK_FORMAT_UNDEFINED;
+}
+
+/****************************************************************************************
+* Function Argument 1: Used to create the shadow map and the buffers				    *
+* Function Argument 2: Owns the shadow render pass and makes the set layout			    *
+* Function Argument 3: How many frames can be recorded before the GPU finishes the oldest *
+****************************************************************************************/
+void VulkanShadowCascadesHandle::CreateShadowCascades(const VulkanDeviceHandle& device,
+	VulkanGraphicsPipelineHandle& pipelines, uint32_t framesInFlight)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	vk_format = FindShadowMapFormat(device.GetVulkanSDKPhysicalDevice());
+	CreateShadowMap(device, pipelines.GetVulkanSDKShadowRenderPass());
+
+	/* Creating the comparison sampler */
+	//Linear filtering of a comparison returns the lit fraction of the four nearest texels, where the format supports it
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(device.GetVulkanSDKPhysicalDevice(), vk_format, &properties);
+	VkFilter filter = (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ?
+		VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = filter;
+	samplerInfo.minFilter = filter;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	//The shaders never sample outside a cascade, the border only guards the filter's last texel
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+	samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	//A receiver is lit when it is no further from the light than the nearest caster
+	samplerInfo.compareEnable = VK_TRUE;
+	samplerInfo.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = 0.0f;
+
+	VkResult samplerResult = vkCreateSampler(vk_device, &samplerInfo, nullptr, &vk_sampler);
+	if (samplerResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	/* Comparison sampler created */
+
+	//The matrices change whenever a cascade is fitted again, they are small enough to be read from host visible memory
+	m_constantBuffers.resize(framesInFlight);
+	for (VulkanBufferHandle& buffer : m_constantBuffers)
+	{
+		buffer.CreateBuffer(device, sizeof(ShadowConstantsGpu), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	}
+
+	CreateDescriptorSets(vk_device, pipelines.GetLayoutCache(), framesInFlight);
+	m_created = true;
+}
+
+/*************************************************************************************
+* Function Argument 1: The device handle is needed to create the image and find a	 *
+*					   device local memory type for it								 *
+* Function Argument 2: The shadow render pass the framebuffers are created for		 *
+*************************************************************************************/
+void VulkanShadowCascadesHandle::CreateShadowMap(const VulkanDeviceHandle& device, const VkRenderPass& renderPass)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+
+	/* Initializing create info struct for the shadow map */
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = vk_format;
+	imageInfo.extent = { SHADOW_MAP_RESOLUTION, SHADOW_MAP_RESOLUTION, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = SHADOW_CASCADE_COUNT;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	/* Create info struct complete */
+
+	VkResult imageResult = vkCreateImage(vk_device, &imageInfo, nullptr, &vk_image);
+	if (imageResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(vk_device, vk_image, &memoryRequirements);
+
+	VkMemoryAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = memoryRequirements.size;
+	allocateInfo.memoryTypeIndex = device.FindMemoryTypeIndex(memoryRequirements.memoryTypeBits,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	VkResult allocateResult = vkAllocateMemory(vk_device, &allocateInfo, nullptr, &vk_memory);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	vkBindImageMemory(vk_device, vk_image, vk_memory, 0);
+
+	/* Creating the views */
+	//The array view spans every layer, the layer views come after it in the same loop
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = vk_image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	viewInfo.format = vk_format;
+	viewInfo.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, SHADOW_CASCADE_COUNT };
+
+	VkResult viewResult = vkCreateImageView(vk_device, &viewInfo, nullptr, &vk_arrayView);
+	if (viewResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	vk_layerViews.resize(SHADOW_CASCADE_COUNT, VK_NULL_HANDLE);
+	vk_framebuffers.resize(SHADOW_CASCADE_COUNT, VK_NULL_HANDLE);
+	for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+	{
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, cascade, 1 };
+		viewResult = vkCreateImageView(vk_device, &viewInfo, nullptr, &vk_layerViews[cascade]);
+		if (viewResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = renderPass;
+		framebufferInfo.attachmentCount = 1;
+		framebufferInfo.pAttachments = &vk_layerViews[cascade];
+		framebufferInfo.width = SHADOW_MAP_RESOLUTION;
+		framebufferInfo.height = SHADOW_MAP_RESOLUTION;
+		framebufferInfo.layers = 1;
+
+		VkResult framebufferResult = vkCreateFramebuffer(vk_device, &framebufferInfo, nullptr, &vk_framebuffers[cascade]);
+		if (framebufferResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+	/* Views created */
+}
+
+/*************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation		 *
+* Function Argument 2: Makes and owns the set layout, shared with the lit pipelines  *
+* Function Argument 3: A set is allocated for each frame in flight					 *
+*************************************************************************************/
+void VulkanShadowCascadesHandle::CreateDescriptorSets(const VkDevice& device, VulkanLayoutCache& layoutCache,
+	uint32_t framesInFlight)
+{
+	/* Creating the descriptor set layout */
+	//The constants, then the shadow map with its comparison sampler
+	std::vector<VkDescriptorSetLayoutBinding> bindings(2);
+	for (uint32_t i = 0; i < 2; ++i)
+	{
+		bindings[i].binding = i;
+		bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	}
+	vk_descriptorSetLayout = layoutCache.GetDescriptorSetLayout(device, bindings);
+	/* Descriptor set layout created */
+
+	/* Allocating the descriptor sets */
+	VkDescriptorPoolSize poolSizes[2]{};
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSizes[0].descriptorCount = framesInFlight;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[1].descriptorCount = framesInFlight;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = framesInFlight;
+	poolInfo.poolSizeCount = 2;
+	poolInfo.pPoolSizes = poolSizes;
+
+	VkResult poolResult = vkCreateDescriptorPool(device, &poolInfo, nullptr, &vk_descriptorPool);
+	if (poolResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	std::vector<VkDescriptorSetLayout> setLayouts(framesInFlight, vk_descriptorSetLayout);
+	VkDescriptorSetAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = vk_descriptorPool;
+	allocateInfo.descriptorSetCount = framesInFlight;
+	allocateInfo.pSetLayouts = setLayouts.data();
+
+	vk_descriptorSets.resize(framesInFlight, VK_NULL_HANDLE);
+	VkResult allocateResult = vkAllocateDescriptorSets(device, &allocateInfo, vk_descriptorSets.data());
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	/* Descriptor sets allocated */
+
+	//Only the constants differ between the sets. The shadow map is shared, every layer is left read only by the
+	//render pass that draws it, and the first frame draws all of them before anything samples the map
+	for (uint32_t frame = 0; frame < framesInFlight; ++frame)
+	{
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = m_constantBuffers[frame].GetVulkanSDKBuffer();
+		bufferInfo.offset = 0;
+		bufferInfo.range = VK_WHOLE_SIZE;
+
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.sampler = vk_sampler;
+		imageInfo.imageView = vk_arrayView;
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+		VkWriteDescriptorSet writes[2]{};
+		for (uint32_t i = 0; i < 2; ++i)
+		{
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = vk_descriptorSets[frame];
+			writes[i].dstBinding = i;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = bindings[i].descriptorType;
+		}
+		writes[0].pBufferInfo = &bufferInfo;
+		writes[1].pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+	}
+}
+
+void VulkanShadowCascadesHandle::SetLightDirection(const Vec3& lightDirection)
+{
+	Vec3 direction = Normalize(lightDirection);
+	if (Dot(direction, m_lightDirection) >= 1.0f)
+	{
+		return;
+	}
+
+	//The light looks along the opposite of the direction towards it. Any up vector not parallel to it will do, the
+	//cascades are squares that are only ever moved in whole texels of the basis it picks
+	m_lightDirection = direction;
+	Vec3 up = std::fabs(direction.y) > 0.99f ? Vec3{ 0.0f, 0.0f, 1.0f } : Vec3{ 0.0f, 1.0f, 0.0f };
+	m_lightView = LookAt(Vec3{}, Vec3{} - direction, up);
+	++m_version;
+}
+
+void VulkanShadowCascadesHandle::MarkStaticCastersMoved()
+{
+	++m_version;
+}
+
+/*************************************************************************************
+* Function Argument 1: The frame in flight being recorded							 *
+* Function Argument 2: The camera and the scene the cascades are fitted to			 *
+* Function Argument 3: The mesh whose submeshes the changed cascades are culled to	 *
+*************************************************************************************/
+void VulkanShadowCascadesHandle::Update(uint32_t frameIndex, const ShadowViewParameters& view,
+	const VulkanMeshHandle& mesh)
+{
+	if (!m_created)
+	{
+		return;
+	}
+
+	/* Splitting the view into slices */
+	float splits[SHADOW_CASCADE_COUNT + 1];
+	for (uint32_t i = 0; i <= SHADOW_CASCADE_COUNT; ++i)
+	{
+		float fraction = static_cast<float>(i) / SHADOW_CASCADE_COUNT;
+		float logarithmicSplit = view.nearPlane * std::pow(view.farPlane / view.nearPlane, fraction);
+		float evenSplit = view.nearPlane + (view.farPlane - view.nearPlane) * fraction;
+		splits[i] = SHADOW_CASCADE_SPLIT_LAMBDA * logarithmicSplit + (1.0f - SHADOW_CASCADE_SPLIT_LAMBDA) * evenSplit;
+	}
+	/* View split */
+
+	//A slice's corners at a depth d are d * sqrt(slopeSquared) away from the view axis
+	Vec3 forward = Normalize(view.cameraTarget - view.cameraPosition);
+	float tanHalfFovY = std::tan(view.verticalFov * 0.5f);
+	float tanHalfFovX = tanHalfFovY * view.aspectRatio;
+	float slopeSquared = tanHalfFovX * tanHalfFovX + tanHalfFovY * tanHalfFovY;
+
+	//Every cascade spans the whole scene in depth, so the casters between a slice and the sun are never clipped
+	float sceneDepth = -TransformPoint(m_lightView, view.sceneCenter).z;
+	float nearDepth = sceneDepth - view.sceneRadius;
+	float farDepth = sceneDepth + view.sceneRadius;
+	float sizeStep = view.sceneRadius * SHADOW_SIZE_STEP;
+
+	ShadowConstantsGpu constants{};
+	m_renderedCascades = 0;
+	m_renderedCascadeCount = 0;
+	for (uint32_t c = 0; c < SHADOW_CASCADE_COUNT; ++c)
+	{
+		/* Fitting a sphere around the slice */
+		//The sphere through the near and far corners is centered on the view axis, past the far plane it is the far
+		//plane's circle. A sphere keeps its size however the camera turns, so the cascade's texels do too
+		float sliceNear = splits[c];
+		float sliceFar = splits[c + 1];
+		float centerDistance = std::min(0.5f * (sliceNear + sliceFar) * (1.0f + slopeSquared), sliceFar);
+		float farOffset = sliceFar - centerDistance;
+		float radius = std::sqrt(farOffset * farOffset + slopeSquared * sliceFar * sliceFar);
+		Vec3 lightCenter = TransformPoint(m_lightView, view.cameraPosition + forward * centerDistance);
+		/* Sphere fitted */
+
+		/* Keeping the cascade if its layer still covers the slice */
+		//A cascade is fitted again once its slice leaves it or is a margin smaller than it, so the layer never wastes
+		//most of its resolution. The nearer cascades have no margin and follow every texel the camera moves. Snapping
+		//moved the layer by up to half a texel, which a still camera must not count as leaving it
+		CascadeState& cascade = m_cascades[c];
+		float margin = c >= SHADOW_FIRST_CACHED_CASCADE ? SHADOW_CACHE_MARGIN : 1.0f;
+		float halfSize = std::ceil(radius * margin / sizeStep) * sizeStep;
+		float coveredHalfSize = cascade.halfSize * (1.0f + 1.0f / SHADOW_MAP_RESOLUTION);
+		bool covered = cascade.rendered && cascade.version == m_version && cascade.nearDepth == nearDepth &&
+			cascade.farDepth == farDepth && halfSize * margin >= cascade.halfSize &&
+			std::fabs(lightCenter.x - cascade.center[0]) + radius <= coveredHalfSize &&
+			std::fabs(lightCenter.y - cascade.center[1]) + radius <= coveredHalfSize;
+		/* Cascade checked */
+
+		if (!covered)
+		{
+			//Moving the cascade in whole texels keeps every texel over the same part of the world, so the shadow
+			//edges do not shimmer while the camera moves
+			float texelSize = 2.0f * halfSize / SHADOW_MAP_RESOLUTION;
+			cascade.center[0] = std::round(lightCenter.x / texelSize) * texelSize;
+			cascade.center[1] = std::round(lightCenter.y / texelSize) * texelSize;
+			cascade.halfSize = halfSize;
+			cascade.nearDepth = nearDepth;
+			cascade.farDepth = farDepth;
+			cascade.version = m_version;
+			cascade.rendered = true;
+			cascade.viewProjection = Orthographic(cascade.center[0] - halfSize, cascade.center[0] + halfSize,
+				cascade.center[1] - halfSize, cascade.center[1] + halfSize, nearDepth, farDepth) * m_lightView;
+
+			//Only the casters inside the cascade are drawn into it
+			Plane planes[6];
+			ExtractFrustumPlanes(cascade.viewProjection, planes);
+			mesh.CullSubmeshes(planes, m_casterVisibility[c]);
+
+			m_renderedCascades |= 1u << c;
+			++m_renderedCascadeCount;
+		}
+
+		std::memcpy(constants.cascadeViewProjections[c], cascade.viewProjection.m, sizeof(constants.cascadeViewProjections[c]));
+		constants.cascadeTexelSizes[c] = 2.0f * cascade.halfSize / SHADOW_MAP_RESOLUTION;
+	}
+
+	constants.lightDirection[0] = m_lightDirection.x;
+	constants.lightDirection[1] = m_lightDirection.y;
+	constants.lightDirection[2] = m_lightDirection.z;
+	std::memcpy(m_constantBuffers[frameIndex].GetMappedData(), &constants, sizeof(constants));
+}
+
+/*************************************************************************************
+* Function Argument 1: The frame's command buffer, outside of the render pass		 *
+* Function Argument 2: Holds the shadow render pass and the mesh's depth pipeline	 *
+* Function Argument 3: The cascades are timed in a scope of their own				 *
+* Function Argument 4: The mesh casting the shadows									 *
+*************************************************************************************/
+void VulkanShadowCascadesHandle::RecordShadowMaps(const VkCommandBuffer& commandBuffer,
+	const VulkanGraphicsPipelineHandle& pipelines, VulkanGpuProfilerHandle& profiler, const VulkanMeshHandle& mesh) const
+{
+	if (!m_created || m_renderedCascades == 0)
+	{
+		return;
+	}
+
+	//Every cascade is its own render pass, so the scope wraps them all and records no statistics
+	GpuProfileScope shadowScope(profiler, commandBuffer, "ShadowMaps", false);
+
+	VkViewport viewport{};
+	viewport.width = static_cast<float>(SHADOW_MAP_RESOLUTION);
+	viewport.height = static_cast<float>(SHADOW_MAP_RESOLUTION);
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	VkRect2D scissor{};
+	scissor.extent = { SHADOW_MAP_RESOLUTION, SHADOW_MAP_RESOLUTION };
+
+	VkClearValue clearValue{};
+	clearValue.depthStencil = { 1.0f, 0 };
+
+	const VkPipelineLayout& pipelineLayout = pipelines.GetVulkanSDKShadowMeshPipelineLayout();
+	MeshPushConstants pushConstants{};
+	mesh.FillDecodeConstants(pushConstants);
+	for (uint32_t c = 0; c < SHADOW_CASCADE_COUNT; ++c)
+	{
+		if (!(m_renderedCascades & (1u << c)))
+		{
+			continue;
+		}
+
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = pipelines.GetVulkanSDKShadowRenderPass();
+		renderPassInfo.framebuffer = vk_framebuffers[c];
+		renderPassInfo.renderArea.extent = scissor.extent;
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.clearValueCount = 1;
+		renderPassInfo.pClearValues = &clearValue;
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines.GetVulkanSDKShadowMeshPipeline());
+
+		//The cascade's matrix takes the place of the camera's, the decoding parameters are the mesh's as usual
+		std::memcpy(pushConstants.viewProjection, m_cascades[c].viewProjection.m, sizeof(pushConstants.viewProjection));
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants),
+			&pushConstants);
+		mesh.RecordDraw(commandBuffer, m_casterVisibility[c]);
+
+		vkCmdEndRenderPass(commandBuffer);
+	}
+}
+
+void VulkanShadowCascadesHandle::Cleanup(const VkDevice& device)
+{
+	//Destroying the pool frees the sets allocated from it
+	vkDestroyDescriptorPool(device, vk_descriptorPool, nullptr);
+	for (VulkanBufferHandle& buffer : m_constantBuffers)
+	{
+		buffer.Cleanup(device);
+	}
+	vkDestroySampler(device, vk_sampler, nullptr);
+	for (VkFramebuffer framebuffer : vk_framebuffers)
+	{
+		vkDestroyFramebuffer(device, framebuffer, nullptr);
+	}
+	for (VkImageView layerView : vk_layerViews)
+	{
+		vkDestroyImageView(device, layerView, nullptr);
+	}
+	vkDestroyImageView(device, vk_arrayView, nullptr);
+	vkDestroyImage(device, vk_image, nullptr);
+	vkFreeMemory(device, vk_memory, nullptr);
+	m_created = false;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <vector>
+#include "EngineCore/VulkanHandles/VulkanBuffer.h"
+#include "EngineCore/VulkanHandles/VulkanGraphicsPipeline.h"
+#include "EngineCore/Profiling/VulkanGpuProfiler.h"
+#include "EngineCore/Meshes/VulkanMesh.h"
+#include "EngineCore/Math/VectorMath.h"
+
+//The view is split into this many cascades, each a layer of the shadow map covering a slice further from the camera.
+//Must match SHADOW_CASCADE_COUNT in ShadowCascades.glsl, which reads the texel sizes of the cascades as a vec4
+#define SHADOW_CASCADE_COUNT 4u
+
+//Width and height of every cascade's layer
+#define SHADOW_MAP_RESOLUTION 2048u
+
+//Spreads the slices between an even split of the depth range (0) and a logarithmic one (1), where every slice is as
+//many times deeper than the previous one, so the texels of every cascade cover about as many pixels
+#define SHADOW_CASCADE_SPLIT_LAMBDA 0.75f
+
+//The cascades from this one on are far enough that the camera rarely leaves them, they are fitted with a margin
+//and kept until their slice leaves it. The nearer ones are fitted tightly, so they follow any camera movement
+#define SHADOW_FIRST_CACHED_CASCADE 2u
+
+//How much larger than its slice a cached cascade is fitted, and how much smaller the slice may get before the cascade
+//is fitted again to use its resolution
+#define SHADOW_CACHE_MARGIN 1.5f
+
+//The half size of every cascade is rounded up to a multiple of this fraction of the scene radius, so it stays the
+//same while the camera moves a little and the world size of its texels does not change from frame to frame
+#define SHADOW_SIZE_STEP (1.0f / 64.0f)
+
+static_assert(SHADOW_CASCADE_COUNT == 4u, "The shaders read the cascades' texel sizes as a vec4");
+
+//Matches ShadowConstants in ShadowCascades.glsl, a uniform buffer laid out with std140
+struct ShadowConstantsGpu
+{
+	float cascadeViewProjections[SHADOW_CASCADE_COUNT][16];
+	//World space direction towards the sun
+	float lightDirection[4];
+	//World space size of a texel of every cascade
+	float cascadeTexelSizes[SHADOW_CASCADE_COUNT];
+};
+
+//The camera whose view the cascades cover, and the scene that casts the shadows
+struct ShadowViewParameters
+{
+	Vec3 cameraPosition;
+	Vec3 cameraTarget;
+	float verticalFov = 0.0f;
+	float aspectRatio = 1.0f;
+	//The slices are spread between these depths, which only have to cover the shadowed scene
+	float nearPlane = 0.0f;
+	float farPlane = 0.0f;
+	//Every caster is inside the sphere, the depth range of the cascades spans it so no caster is clipped
+	Vec3 sceneCenter;
+	float sceneRadius = 1.0f;
+};
+
+/********************************************************************
+* Cascaded shadow maps of the sun. The camera's view is split into  *
+* slices by depth and every slice gets a layer of the shadow map,	*
+* fitted around it from the light's direction. A cascade is only	*
+* rendered again when its fit changes, the light turns or a static  *
+* caster moves, and only the casters inside it are drawn, so the	*
+* cost of the shadows follows what changed in the scene rather than *
+* its size. The far cascades are fitted with a margin, so they are  *
+* rendered again far less often than the camera moves				*
+********************************************************************/
+class VulkanShadowCascadesHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanShadowCascadesHandle();
+
+	//Returns a depth format that can be both drawn to and sampled, the shadow render pass is created with it
+	static VkFormat FindShadowMapFormat(const VkPhysicalDevice& physicalDevice);
+
+	//Creates the shadow map with a framebuffer for every cascade, the comparison sampler, and a uniform buffer and
+	//descriptor set for every frame in flight. The shadow render pass must already exist
+	void CreateShadowCascades(const VulkanDeviceHandle& device, VulkanGraphicsPipelineHandle& pipelines,
+		uint32_t framesInFlight);
+
+	//Turns the sun, every cascade is rendered again from the new direction
+	void SetLightDirection(const Vec3& lightDirection);
+
+	//Called when a caster that does not move every frame has moved, every cascade is rendered again
+	void MarkStaticCastersMoved();
+
+	//Fits the cascades around the camera's view, culls the casters of the cascades whose fit changed and writes the
+	//matrices into the frame's uniform buffer, which the GPU is done reading
+	void Update(uint32_t frameIndex, const ShadowViewParameters& view, const VulkanMeshHandle& mesh);
+
+	//Records the cascades Update found changed, outside of a render pass and before the mesh is drawn. The casters
+	//are drawn at the detail levels the camera selected
+	void RecordShadowMaps(const VkCommandBuffer& commandBuffer, const VulkanGraphicsPipelineHandle& pipelines,
+		VulkanGpuProfilerHandle& profiler, const VulkanMeshHandle& mesh) const;
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline bool IsCreated() const { return m_created; }
+
+	//How many cascades the last Update found changed, the ones the frame renders
+	inline uint32_t GetRenderedCascadeCount() const { return m_renderedCascadeCount; }
+
+	//VK_NULL_HANDLE unless the cascades have been created
+	inline const VkDescriptorSetLayout& GetVulkanSDKSetLayout() const { return vk_descriptorSetLayout; }
+
+	inline const VkDescriptorSet& GetVulkanSDKDescriptorSet(uint32_t frameIndex) const
+	{
+		return vk_descriptorSets[frameIndex];
+	}
+	/* End member variable getters */
+private:
+	//What a cascade's layer was last rendered with, it is kept as long as its slice stays inside it
+	struct CascadeState
+	{
+		Mat4 viewProjection;
+		//The center of the cascade in the light's view space, snapped to whole texels, and half its width
+		float center[2] = { 0.0f, 0.0f };
+		float halfSize = 0.0f;
+		//The depth range of the scene from the light, which changes with the scene sphere
+		float nearDepth = 0.0f;
+		float farDepth = 0.0f;
+		//The version of the light and the static casters the layer was rendered with
+		uint32_t version = 0;
+		bool rendered = false;
+	};
+
+	//Called by CreateShadowCascades to create the layered image, its views and a framebuffer for every layer
+	void CreateShadowMap(const VulkanDeviceHandle& device, const VkRenderPass& renderPass);
+
+	//Called by CreateShadowCascades to create the descriptor sets pointing at the buffers and the shadow map
+	void CreateDescriptorSets(const VkDevice& device, VulkanLayoutCache& layoutCache, uint32_t framesInFlight);
+private:
+	VkImage vk_image;
+	VkDeviceMemory vk_memory;
+	VkFormat vk_format;
+	//Sampled by the lit passes through the view of every layer, each framebuffer renders through the view of its layer
+	VkImageView vk_arrayView;
+	std::vector<VkImageView> vk_layerViews;
+	std::vector<VkFramebuffer> vk_framebuffers;
+	//Compares the receiver's depth with the map's, filtered linearly where the format allows it
+	VkSampler vk_sampler;
+
+	//A uniform buffer for every frame in flight, so the matrices of a frame are never written while the GPU reads them
+	std::vector<VulkanBufferHandle> m_constantBuffers;
+
+	//The set layout is owned by the layout cache
+	VkDescriptorSetLayout vk_descriptorSetLayout;
+	VkDescriptorPool vk_descriptorPool;
+	std::vector<VkDescriptorSet> vk_descriptorSets;
+
+	CascadeState m_cascades[SHADOW_CASCADE_COUNT];
+	//The submeshes each cascade draws, only filled again when the cascade is rendered again
+	std::vector<uint8_t> m_casterVisibility[SHADOW_CASCADE_COUNT];
+	//One bit per cascade rendered by the frame being recorded
+	uint32_t m_renderedCascades;
+	uint32_t m_renderedCascadeCount;
+
+	Vec3 m_lightDirection;
+	//The light's view, rotating the world so the sun looks down its -z axis
+	Mat4 m_lightView;
+	//Changed whenever the light turns or a static caster moves, a cascade rendered with another version is rendered again
+	uint32_t m_version;
+
+	bool m_created;
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cmath>
+
+//Small vector and matrix types, matrices are column major so they can be copied straight into GLSL mat4s
+struct Vec3
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+};
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+
+inline Vec3 operator*(const Vec3& v, float s) { return { v.x * s, v.y * s, v.z * s }; }
+
+inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+inline Vec3 Cross(const Vec3& a, const Vec3& b)
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+inline float Length(const Vec3& v) { return std::sqrt(Dot(v, v)); }
+
+//Returns the zero vector unchanged instead of dividing by zero
+inline Vec3 Normalize(const Vec3& v)
+{
+	float length = Length(v);
+	return length > 0.0f ? v * (1.0f / length) : v;
+}
+
+//The points p with Dot(normal, p) + distance >= 0 are on the inner side of the plane
+struct Plane
+{
+	Vec3 normal;
+	float distance = 0.0f;
+};
+
+struct Mat4
+{
+	//m[column * 4 + row]
+	float m[16] = {};
+
+	static inline Mat4 Identity()
+	{
+		Mat4 result;
+		result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1.0f;
+		return result;
+	}
+};
+
+inline Mat4 operator*(const Mat4& a, const Mat4& b)
+{
+	Mat4 result;
+	for (int column = 0; column < 4; ++column)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < 4; ++k)
+			{
+				sum += a.m[k * 4 + row] * b.m[column * 4 + k];
+			}
+			result.m[column * 4 + row] = sum;
+		}
+	}
+	return result;
+}
+
+inline Vec3 TransformPoint(const Mat4& matrix, const Vec3& p)
+{
+	return { matrix.m[0] * p.x + matrix.m[4] * p.y + matrix.m[8] * p.z + matrix.m[12],
+		matrix.m[1] * p.x + matrix.m[5] * p.y + matrix.m[9] * p.z + matrix.m[13],
+		matrix.m[2] * p.x + matrix.m[6] * p.y + matrix.m[10] * p.z + matrix.m[14] };
+}
+
+//Ignores the translation, the result is not normalized
+inline Vec3 TransformDirection(const Mat4& matrix, const Vec3& d)
+{
+	return { matrix.m[0] * d.x + matrix.m[4] * d.y + matrix.m[8] * d.z,
+		matrix.m[1] * d.x + matrix.m[5] * d.y + matrix.m[9] * d.z,
+		matrix.m[2] * d.x + matrix.m[6] * d.y + matrix.m[10] * d.z };
+}
+
+//Right handed view matrix looking from eye towards target
+inline Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+{
+	Vec3 forward = Normalize(target - eye);
+	Vec3 right = Normalize(Cross(forward, up));
+	Vec3 cameraUp = Cross(right, forward);
+
+	Mat4 result = Mat4::Identity();
+	result.m[0] = right.x; result.m[4] = right.y; result.m[8] = right.z;
+	result.m[1] = cameraUp.x; result.m[5] = cameraUp.y; result.m[9] = cameraUp.z;
+	result.m[2] = -forward.x; result.m[6] = -forward.y; result.m[10] = -forward.z;
+	result.m[12] = -Dot(right, eye);
+	result.m[13] = -Dot(cameraUp, eye);
+	result.m[14] = Dot(forward, eye);
+	return result;
+}
+
+//Fills the six planes of the frustum of a view projection matrix (left, right, bottom, top, near, far), facing inwards and normalized
+inline void ExtractFrustumPlanes(const Mat4& viewProjection, Plane planes[6])
+{
+	//Every plane is a sum or a difference of the matrix's rows, for depth in Vulkan's 0 to 1 range
+	const float* m = viewProjection.m;
+	float rows[4][4];
+	for (int row = 0; row < 4; ++row)
+	{
+		for (int column = 0; column < 4; ++column)
+		{
+			rows[row][column] = m[column * 4 + row];
+		}
+	}
+
+	//-w <= x <= w, -w <= y <= w and 0 <= z <= w, so the near plane is the only one without the w row
+	const int axes[6] = { 0, 0, 1, 1, 2, 2 };
+	const float signs[6] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+	const float wScales[6] = { 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+	for (int i = 0; i < 6; ++i)
+	{
+		float w = wScales[i];
+		float sign = signs[i];
+		const float* axis = rows[axes[i]];
+		Vec3 normal = { w * rows[3][0] + sign * axis[0], w * rows[3][1] + sign * axis[1], w * rows[3][2] + sign * axis[2] };
+		float distance = w * rows[3][3] + sign * axis[3];
+
+		float length = Length(normal);
+		float scale = length > 0.0f ? 1.0f / length : 0.0f;
+		planes[i] = { normal * scale, distance * scale };
+	}
+}
+
+//Perspective projection for Vulkan's clip space: y points down and depth goes from 0 (near) to 1 (far)
+inline Mat4 Perspective(float verticalFovRadians, float aspectRatio, float nearPlane, float farPlane)
+{
+	float focalLength = 1.0f / std::tan(verticalFovRadians * 0.5f);
+
+	Mat4 result;
+	result.m[0] = focalLength / aspectRatio;
+	result.m[5] = -focalLength;
+	result.m[10] = farPlane / (nearPlane - farPlane);
+	result.m[11] = -1.0f;
+	result.m[14] = (nearPlane * farPlane) / (nearPlane - farPlane);
+	return result;
+}
+
+//Orthographic projection of the view space box between the given bounds, for the same clip space as Perspective.
+//The near and far planes are distances in front of the view and may be negative
+inline Mat4 Orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane)
+{
+	Mat4 result;
+	result.m[0] = 2.0f / (right - left);
+	result.m[5] = -2.0f / (top - bottom);
+	result.m[10] = 1.0f / (nearPlane - farPlane);
+	result.m[12] = -(right + left) / (right - left);
+	result.m[13] = (top + bottom) / (top - bottom);
+	result.m[14] = nearPlane / (nearPlane - farPlane);
+	result.m[15] = 1.0f;
+	return result;
+}
+
+//General inverse from the 2x2 determinants of the first two and last two columns, a singular matrix gives zeros.
+//Inverting commutes with transposing, so the array is read the same way whichever order it is stored in
+inline Mat4 Inverse(const Mat4& matrix)
+{
+	const float* a = matrix.m;
+	float s0 = a[0] * a[5] - a[4] * a[1];
+	float s1 = a[0] * a[6] - a[4] * a[2];
+	float s2 = a[0] * a[7] - a[4] * a[3];
+	float s3 = a[1] * a[6] - a[5] * a[2];
+	float s4 = a[1] * a[7] - a[5] * a[3];
+	float s5 = a[2] * a[7] - a[6] * a[3];
+	float c0 = a[8] * a[13] - a[12] * a[9];
+	float c1 = a[8] * a[14] - a[12] * a[10];
+	float c2 = a[8] * a[15] - a[12] * a[11];
+	float c3 = a[9] * a[14] - a[13] * a[10];
+	float c4 = a[9] * a[15] - a[13] * a[11];
+	float c5 = a[10] * a[15] - a[14] * a[11];
+
+	float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	float scale = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+
+	Mat4 result;
+	float* b = result.m;
+	b[0] = (a[5] * c5 - a[6] * c4 + a[7] * c3) * scale;
+	b[1] = (-a[1] * c5 + a[2] * c4 - a[3] * c3) * scale;
+	b[2] = (a[13] * s5 - a[14] * s4 + a[15] * s3) * scale;
+	b[3] = (-a[9] * s5 + a[10] * s4 - a[11] * s3) * scale;
+	b[4] = (-a[4] * c5 + a[6] * c2 - a[7] * c1) * scale;
+	b[5] = (a[0] * c5 - a[2] * c2 + a[3] * c1) * scale;
+	b[6] = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * scale;
+	b[7] = (a[8] * s5 - a[10] * s2 + a[11] * s1) * scale;
+	b[8] = (a[4] * c4 - a[5] * c2 + a[7] * c0) * scale;
+	b[9] = (-a[0] * c4 + a[1] * c2 - a[3] * c0) * scale;
+	b[10] = (a[12] * s4 - a[13] * s2 + a[15] * s0) * scale;
+	b[11] = (-a[8] * s4 + a[9] * s2 - a[11] * s0) * scale;
+	b[12] = (-a[4] * c3 + a[5] * c1 - a[6] * c0) * scale;
+	b[13] = (a[0] * c3 - a[1] * c1 + a[2] * c0) * scale;
+	b[14] = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * scale;
+	b[15] = (a[8] * s3 - a[9] * s1 + a[10] * s0) * scale;
+	return result;
+}
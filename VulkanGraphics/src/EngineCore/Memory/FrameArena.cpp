@@ -0,0 +1,185 @@
+#include "FrameArena.h"
+#include "EngineCore/Memory/HeapCounter.h"
+#include "EngineCore/Jobs/JobSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+LinearArena::LinearArena()
+	:m_block{nullptr}, m_capacity{0}, m_offset{0}, m_overflowBlocks(), m_overflowBytes{0},
+	m_allocationCount{0}, m_allocatedBytes{0}, m_overflowCount{0}
+{
+
+}
+
+LinearArena::~LinearArena()
+{
+	Cleanup();
+}
+
+void LinearArena::CreateArena(size_t capacity)
+{
+	Cleanup();
+	m_block = static_cast<uint8_t*>(::operator new(capacity));
+	m_capacity = capacity;
+}
+
+/*******************************************************************************
+* Function Argument 1: The amount of bytes to allocate						   *
+* Function Argument 2: The alignment of the allocation, a power of two		   *
+*******************************************************************************/
+void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+	//The padding depends on the block's address, not just the offset, since the block is only aligned for any scalar
+	uintptr_t current = reinterpret_cast<uintptr_t>(m_block) + m_offset;
+	uintptr_t aligned = (current + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	size_t padding = static_cast<size_t>(aligned - current);
+
+	++m_allocationCount;
+	if (m_block != nullptr && m_offset + padding + size <= m_capacity)
+	{
+		m_offset += padding + size;
+		m_allocatedBytes += padding + size;
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	/* Overflowing to the heap */
+	//Enough is remembered for the block to fit this allocation aligned the worst way at the next reset
+	size_t overflowSize = size + alignment - 1;
+	uint8_t* overflowBlock = static_cast<uint8_t*>(::operator new(overflowSize));
+	m_overflowBlocks.push_back(overflowBlock);
+	m_overflowBytes += overflowSize;
+	m_allocatedBytes += overflowSize;
+	++m_overflowCount;
+
+	uintptr_t overflowAddress = reinterpret_cast<uintptr_t>(overflowBlock);
+	return reinterpret_cast<void*>((overflowAddress + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+	/* Overflow allocated */
+}
+
+void LinearArena::Reset()
+{
+	//Only frames that overflowed have anything to free, the block then grows once to fit the whole frame
+	if (!m_overflowBlocks.empty())
+	{
+		for (void* overflowBlock : m_overflowBlocks)
+		{
+			::operator delete(overflowBlock);
+		}
+		m_overflowBlocks.clear();
+
+		size_t capacity = std::max(m_capacity * 2, m_offset + m_overflowBytes);
+		::operator delete(m_block);
+		m_block = static_cast<uint8_t*>(::operator new(capacity));
+		m_capacity = capacity;
+		m_overflowBytes = 0;
+	}
+
+	m_offset = 0;
+	m_allocationCount = 0;
+	m_allocatedBytes = 0;
+	m_overflowCount = 0;
+}
+
+void LinearArena::Cleanup()
+{
+	for (void* overflowBlock : m_overflowBlocks)
+	{
+		::operator delete(overflowBlock);
+	}
+	m_overflowBlocks.clear();
+	m_overflowBytes = 0;
+
+	::operator delete(m_block);
+	m_block = nullptr;
+	m_capacity = 0;
+	m_offset = 0;
+}
+
+FrameArena& FrameArena::Get()
+{
+	static FrameArena frameArena;
+	return frameArena;
+}
+
+FrameArena::FrameArena()
+	:m_arenas(), m_threadCount{0}, m_frameSlots{0}, m_currentSlot{0}, m_frameStarted{false},
+	m_frameStartHeapAllocations{0}, m_frameStartHeapFrees{0}, m_lastFrameStatistics()
+{
+
+}
+
+/************************************************************************
+* Function Argument 1: The amount of frames in flight, a frame's memory *
+*					   stays valid until its slot is begun again		*
+************************************************************************/
+void FrameArena::CreateFrameArena(uint32_t frameSlots)
+{
+	m_threadCount = JobSystem::Get().GetThreadCount();
+	m_frameSlots = frameSlots;
+	m_arenas.reset(new LinearArena[m_threadCount * m_frameSlots]);
+	for (uint32_t i = 0; i < m_threadCount * m_frameSlots; ++i)
+	{
+		m_arenas[i].CreateArena(FRAME_ARENA_INITIAL_SIZE);
+	}
+	m_currentSlot = 0;
+	m_frameStarted = false;
+}
+
+void FrameArena::BeginFrame(uint32_t frameSlot)
+{
+	/* Gathering what the previous frame allocated */
+	uint64_t heapAllocations = GetHeapAllocationCount();
+	uint64_t heapFrees = GetHeapFreeCount();
+	if (m_frameStarted)
+	{
+		FrameArenaStatistics statistics;
+		for (uint32_t thread = 0; thread < m_threadCount; ++thread)
+		{
+			const LinearArena& arena = GetArena(thread, m_currentSlot);
+			statistics.allocationCount += arena.GetAllocationCount();
+			statistics.allocatedBytes += arena.GetAllocatedBytes();
+			statistics.overflowCount += arena.GetOverflowCount();
+		}
+		statistics.heapAllocations = heapAllocations - m_frameStartHeapAllocations;
+		statistics.heapFrees = heapFrees - m_frameStartHeapFrees;
+		m_lastFrameStatistics = statistics;
+	}
+	/* Previous frame gathered */
+
+	//The slot's last frame has finished on the GPU and on every thread, nothing refers to its memory any more
+	for (uint32_t thread = 0; thread < m_threadCount; ++thread)
+	{
+		GetArena(thread, frameSlot).Reset();
+	}
+	m_currentSlot = frameSlot;
+	m_frameStarted = true;
+
+	//Read after the resets, an arena growing to fit an overflow is counted as an overflow of the frame before
+	m_frameStartHeapAllocations = GetHeapAllocationCount();
+	m_frameStartHeapFrees = GetHeapFreeCount();
+}
+
+/*******************************************************************************
+* Function Argument 1: The amount of bytes to allocate						   *
+* Function Argument 2: The alignment of the allocation, a power of two		   *
+*******************************************************************************/
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	uint32_t threadIndex = JobSystem::GetThreadIndex();
+	//Threads outside the job system have no arena, and an arena that was never created has no slots
+	if (threadIndex >= m_threadCount)
+	{
+		__debugbreak();
+	}
+	return GetArena(threadIndex, m_currentSlot).Allocate(size, alignment);
+}
+
+void FrameArena::Cleanup()
+{
+	m_arenas.reset();
+	m_threadCount = 0;
+	m_frameSlots = 0;
+	m_frameStarted = false;
+}
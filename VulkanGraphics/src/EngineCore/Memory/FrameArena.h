@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//Bytes every thread starts with in each frame slot, a slot grows to the largest frame it has seen if a frame needs more
+#define FRAME_ARENA_INITIAL_SIZE (256ull * 1024)
+
+//Each thread's arenas start on their own cache line, so threads bumping their offsets do not share lines
+#define FRAME_ARENA_CACHE_LINE 64
+
+//What was allocated during a single frame
+struct FrameArenaStatistics
+{
+	//Allocations made from the arenas by every thread, and the bytes they took including alignment padding
+	uint64_t allocationCount = 0;
+	uint64_t allocatedBytes = 0;
+	//Allocations that did not fit in their arena and went to the heap. The arena grows to fit them at its next reset,
+	//so these only happen while the frames warm up
+	uint64_t overflowCount = 0;
+
+	//Calls to the global operator new and delete made by any thread during the frame, arena or not
+	uint64_t heapAllocations = 0;
+	uint64_t heapFrees = 0;
+};
+
+/*******************************************************************
+* A single block of memory that allocations are bumped out of and  *
+* that is freed all at once. An allocation that does not fit gets  *
+* a heap block of its own, and the next reset replaces the block   *
+* with one large enough for everything, so after the first frames  *
+* a reset is O(1) and allocating never touches the heap			   *
+*******************************************************************/
+class alignas(FRAME_ARENA_CACHE_LINE) LinearArena
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	LinearArena();
+
+	~LinearArena();
+
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	void CreateArena(size_t capacity);
+
+	//Returns memory aligned to alignment (a power of two), which stays valid until the next reset
+	void* Allocate(size_t size, size_t alignment);
+
+	//Frees every allocation at once and clears the counters
+	void Reset();
+
+	void Cleanup();
+
+	/* Member variable getters */
+	inline size_t GetCapacity() const { return m_capacity; }
+
+	inline uint64_t GetAllocationCount() const { return m_allocationCount; }
+
+	inline uint64_t GetAllocatedBytes() const { return m_allocatedBytes; }
+
+	inline uint64_t GetOverflowCount() const { return m_overflowCount; }
+	/* End member variable getters */
+private:
+	uint8_t* m_block;
+	size_t m_capacity;
+	size_t m_offset;
+
+	//Allocations that did not fit in the block, and their total size the block grows by at the next reset
+	std::vector<void*> m_overflowBlocks;
+	size_t m_overflowBytes;
+
+	uint64_t m_allocationCount;
+	uint64_t m_allocatedBytes;
+	uint64_t m_overflowCount;
+};
+
+/*******************************************************************
+* Memory for data that only lives for a frame. Every thread of the *
+* job system has its own arena in every frame slot, so allocating  *
+* needs no lock, and a slot's arenas are only reset when the slot  *
+* begins its next frame, so memory handed to work that runs until  *
+* the slot's fence signals stays valid. Only threads of the job	   *
+* system can allocate from it									   *
+*******************************************************************/
+class FrameArena
+{
+public:
+	//Frame memory is shared by the whole engine, so there is a single instance of it
+	static FrameArena& Get();
+
+	//Creates an arena for every thread of the job system in every frame slot, the job system must already be started
+	void CreateFrameArena(uint32_t frameSlots);
+
+	//Resets the slot's arenas and makes it the slot allocations come from. Must be called by the thread that started
+	//the job system once the slot's fence has signalled, and while no job of the previous frame is still allocating
+	void BeginFrame(uint32_t frameSlot);
+
+	//Returns memory from the calling thread's arena of the current frame slot, valid until the slot begins its next frame
+	void* Allocate(size_t size, size_t alignment);
+
+	void Cleanup();
+
+	/* Member variable getters */
+	//Filled in by BeginFrame with what the frame before it allocated
+	inline const FrameArenaStatistics& GetLastFrameStatistics() const { return m_lastFrameStatistics; }
+	/* End member variable getters */
+private:
+	FrameArena();
+
+	inline LinearArena& GetArena(uint32_t threadIndex, uint32_t frameSlot) { return m_arenas[threadIndex * m_frameSlots + frameSlot]; }
+private:
+	//One arena per thread per frame slot, indexed by thread first
+	std::unique_ptr<LinearArena[]> m_arenas;
+	uint32_t m_threadCount;
+	uint32_t m_frameSlots;
+
+	//Only changed by BeginFrame, before the jobs of the frame are run
+	uint32_t m_currentSlot;
+	bool m_frameStarted;
+
+	//Heap counts when the current frame began, to tell how many calls the frame made
+	uint64_t m_frameStartHeapAllocations;
+	uint64_t m_frameStartHeapFrees;
+	FrameArenaStatistics m_lastFrameStatistics;
+};
+
+/*******************************************************************
+* Standard library allocator that takes its memory from the frame  *
+* arena, for containers that are filled and thrown away within a   *
+* frame. Freeing does nothing, the memory is reclaimed when the	   *
+* frame slot comes around again, so grow containers with reserve   *
+* rather than with many small reallocations						   *
+*******************************************************************/
+template<typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameAllocator() noexcept
+	{
+
+	}
+
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>&) noexcept
+	{
+
+	}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(FrameArena::Get().Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, size_t) noexcept
+	{
+
+	}
+};
+
+//Every frame allocator takes from the same arena, so memory from one can be given back to any other
+template<typename T, typename U>
+inline bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) { return true; }
+
+template<typename T, typename U>
+inline bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) { return false; }
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -0,0 +1,138 @@
+#include "HeapCounter.h"
+
+#ifdef HEAP_COUNTER_ENABLED
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+//Constant initialized, so they are already valid for allocations made by other static initializers
+static std::atomic<uint64_t> s_heapAllocations{0};
+static std::atomic<uint64_t> s_heapFrees{0};
+
+uint64_t GetHeapAllocationCount()
+{
+	return s_heapAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t GetHeapFreeCount()
+{
+	return s_heapFrees.load(std::memory_order_relaxed);
+}
+
+/* Replacing the global allocation functions */
+//The nothrow and sized versions of the standard library call these, so they are counted too
+void* operator new(std::size_t size)
+{
+	s_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	//malloc may return null for 0 bytes, but new has to return a unique pointer
+	void* memory = std::malloc(size ? size : 1);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	if (memory != nullptr)
+	{
+		s_heapFrees.fetch_add(1, std::memory_order_relaxed);
+		std::free(memory);
+	}
+}
+
+void operator delete[](void* memory) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	operator delete(memory);
+}
+/* Global allocation functions replaced */
+
+/* Replacing the over-aligned allocation functions */
+//Types aligned past what malloc guarantees, like the cache line aligned arenas, are allocated through these. Without
+//them the default versions would allocate uncounted and be freed in ways the replaced delete does not expect
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	s_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	size_t alignmentBytes = static_cast<size_t>(alignment);
+	size = size ? size : 1;
+#ifdef _WIN32
+	void* memory = _aligned_malloc(size, alignmentBytes);
+#else
+	//aligned_alloc only takes sizes that are a multiple of the alignment
+	void* memory = std::aligned_alloc(alignmentBytes, (size + alignmentBytes - 1) & ~(alignmentBytes - 1));
+#endif
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	if (memory != nullptr)
+	{
+		s_heapFrees.fetch_add(1, std::memory_order_relaxed);
+		//Memory from _aligned_malloc has to go back through _aligned_free, aligned_alloc's can be freed as usual
+#ifdef _WIN32
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
+/* Over-aligned allocation functions replaced */
+
+#else
+
+uint64_t GetHeapAllocationCount()
+{
+	return 0;
+}
+
+uint64_t GetHeapFreeCount()
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+//Counting puts an atomic add on every allocation of every thread, so it is only on in debug builds unless a profiling
+//build defines HEAP_COUNTER_ENABLED itself
+#if defined(_DEBUG) && !defined(HEAP_COUNTER_ENABLED)
+#define HEAP_COUNTER_ENABLED
+#endif
+
+//With HEAP_COUNTER_ENABLED the global operator new and delete are replaced in HeapCounter.cpp to count every heap
+//allocation and free made through them by any thread, so a stretch of code can be checked for allocations by comparing
+//the counts around it
+
+//Allocations made through operator new and new[] since the program started, always 0 without HEAP_COUNTER_ENABLED
+uint64_t GetHeapAllocationCount();
+
+//Frees of non null pointers made through operator delete and delete[] since the program started, always 0 without
+//HEAP_COUNTER_ENABLED
+uint64_t GetHeapFreeCount();
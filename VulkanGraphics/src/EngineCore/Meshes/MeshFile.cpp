@@ -0,0 +1,66 @@
+#include "MeshFile.h"
+
+//Returns true if [offset, offset + size) lies inside a file of fileSize bytes, without overflowing
+static bool IsRangeInFile(uint64_t offset, uint64_t size, uint64_t fileSize)
+{
+	return offset <= fileSize && size <= fileSize - offset;
+}
+
+bool ValidateMeshFile(const uint8_t* data, uint64_t size)
+{
+	if (!data || size < sizeof(MeshFileHeader))
+	{
+		return false;
+	}
+
+	const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(data);
+	if (header->magic != MESH_FILE_MAGIC || header->version != MESH_FILE_VERSION)
+	{
+		return false;
+	}
+
+	//Empty streams cannot be turned into buffers, and the stride must be the one the pipeline is built for
+	if ((header->indexSize != 2 && header->indexSize != 4) || header->vertexStride == 0 ||
+		header->vertexStride != GetMeshVertexStride(header->vertexFormat) ||
+		header->vertexCount == 0 || header->indexCount == 0)
+	{
+		return false;
+	}
+
+	//The stream sizes must match the counts, otherwise draws could read past the end of the buffers
+	if (header->vertexDataSize != header->vertexCount * header->vertexStride ||
+		header->indexDataSize != header->indexCount * header->indexSize)
+	{
+		return false;
+	}
+
+	if (!IsRangeInFile(header->vertexDataOffset, header->vertexDataSize, size) ||
+		!IsRangeInFile(header->indexDataOffset, header->indexDataSize, size) ||
+		!IsRangeInFile(header->submeshTableOffset, static_cast<uint64_t>(header->submeshCount) * sizeof(MeshFileSubmesh), size) ||
+		!IsRangeInFile(header->meshletTableOffset, static_cast<uint64_t>(header->meshletCount) * sizeof(MeshFileMeshlet), size) ||
+		!IsRangeInFile(header->lodTableOffset, static_cast<uint64_t>(header->lodCount) * sizeof(MeshFileLod), size))
+	{
+		return false;
+	}
+
+	//Every range the draw path reads must lie inside the tables and streams it indexes
+	const MeshFileSubmesh* submeshes = reinterpret_cast<const MeshFileSubmesh*>(data + header->submeshTableOffset);
+	for (uint32_t i = 0; i < header->submeshCount; ++i)
+	{
+		if (!IsRangeInFile(submeshes[i].firstIndex, submeshes[i].indexCount, header->indexCount) ||
+			submeshes[i].lodCount == 0 || !IsRangeInFile(submeshes[i].firstLod, submeshes[i].lodCount, header->lodCount))
+		{
+			return false;
+		}
+	}
+
+	const MeshFileLod* lods = reinterpret_cast<const MeshFileLod*>(data + header->lodTableOffset);
+	for (uint32_t i = 0; i < header->lodCount; ++i)
+	{
+		if (!IsRangeInFile(lods[i].firstIndex, lods[i].indexCount, header->indexCount))
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+
+//"VMSH" read as a little endian integer, the first four bytes of every mesh file
+#define MESH_FILE_MAGIC 0x48534D56
+#define MESH_FILE_VERSION 3
+
+//Every stream and table starts at a multiple of this, so a mapped file can be copied into GPU buffers as is
+#define MESH_FILE_STREAM_ALIGNMENT 256
+
+//Limits of a single meshlet, matching what mesh shaders are commonly dispatched with
+#define MESH_MESHLET_MAX_VERTICES 64
+#define MESH_MESHLET_MAX_TRIANGLES 124
+
+//Vertices stored as MeshVertex, with full precision positions, normals and texture coordinates
+#define MESH_VERTEX_FORMAT_FLOAT32 0
+
+//Vertices stored as MeshPackedVertex, with UNORM16 texture coordinates. Only used when every uv lies inside [0, 1]
+#define MESH_VERTEX_FORMAT_PACKED_UNORM16_UV 1
+
+//Vertices stored as MeshPackedVertex, with half float texture coordinates for uvs that repeat outside [0, 1]
+#define MESH_VERTEX_FORMAT_PACKED_HALF_UV 2
+
+//Axis aligned bounding box
+struct MeshBounds
+{
+	float min[3];
+	float max[3];
+};
+
+//The vertex layout of MESH_VERTEX_FORMAT_FLOAT32
+struct MeshVertex
+{
+	float position[3];
+	float normal[3];
+	float uv[2];
+};
+
+/**********************************************************************
+* The vertex layout of the packed formats, half the size of			  *
+* MeshVertex. Positions are UNORM16 inside the mesh bounds and are	  *
+* dequantized with them in the vertex shader, normals are octahedral  *
+* encoded into two SNORM16 values									  *
+**********************************************************************/
+struct MeshPackedVertex
+{
+	//The fourth component only pads the position to a format every GPU can fetch
+	uint16_t position[4];
+	int16_t normal[2];
+	uint16_t uv[2];
+};
+
+//A range of the index stream drawn with a single material, at full detail
+struct MeshFileSubmesh
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t materialIndex;
+
+	//The submesh's detail levels in the LOD table, from full detail to coarsest. Level 0 is the submesh's own range
+	uint32_t lodCount;
+	uint32_t firstLod;
+	uint32_t padding;
+
+	MeshBounds bounds;
+};
+
+//A simplified version of a submesh, drawn from the same vertices with its own range of the index stream
+struct MeshFileLod
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+
+	//How far (in the mesh's units) the simplified surface may lie from the full detail one
+	float error;
+	uint32_t padding;
+};
+
+/***********************************************************************
+* A cluster of at most MESH_MESHLET_MAX_VERTICES vertices and		   *
+* MESH_MESHLET_MAX_TRIANGLES triangles, stored as a contiguous range   *
+* of its submesh's indices so the regular draw path is unaffected.	   *
+* Its bounds and normal cone allow culling whole clusters at once	   *
+***********************************************************************/
+struct MeshFileMeshlet
+{
+	uint32_t firstIndex;
+	uint32_t triangleCount;
+	uint32_t vertexCount;
+	uint32_t submeshIndex;
+
+	//Bounding sphere
+	float center[3];
+	float radius;
+
+	//Average facing direction, and the sine of the largest angle between it and a triangle's normal.
+	//Every triangle faces away from the camera if dot(center - camera, coneAxis) >= coneCutoff * length(center - camera) + radius.
+	//A cutoff of 1 means the triangles face too many directions for the meshlet to ever be culled
+	float coneAxis[3];
+	float coneCutoff;
+};
+
+/**********************************************************************
+* The header at the start of a mesh file. The vertex stream, the	  *
+* index stream and the submesh table follow it, each aligned to		  *
+* MESH_FILE_STREAM_ALIGNMENT and stored exactly as the GPU reads them *
+* so loading a mesh never parses or converts anything				  *
+**********************************************************************/
+struct MeshFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+
+	//One of the MESH_VERTEX_FORMAT defines, and the size of a single vertex in bytes
+	uint32_t vertexFormat;
+	uint32_t vertexStride;
+
+	//2 or 4 bytes per index
+	uint32_t indexSize;
+	uint32_t submeshCount;
+
+	uint64_t vertexCount;
+	uint64_t indexCount;
+
+	//Offsets from the start of the file and sizes in bytes of each stream
+	uint64_t vertexDataOffset;
+	uint64_t vertexDataSize;
+	uint64_t indexDataOffset;
+	uint64_t indexDataSize;
+	uint64_t submeshTableOffset;
+
+	//Bounds of the whole mesh, also the grid the positions of packed formats are quantized to
+	MeshBounds bounds;
+
+	//The meshlet table follows the submesh table, it is empty unless the converter was asked for meshlets
+	uint32_t meshletCount;
+	uint32_t meshletPadding;
+	uint64_t meshletTableOffset;
+
+	//Every submesh has at least one entry in the LOD table
+	uint32_t lodCount;
+	uint32_t lodPadding;
+	uint64_t lodTableOffset;
+};
+
+//Returns the size of a single vertex of a MESH_VERTEX_FORMAT, or 0 if the format is unknown
+inline uint32_t GetMeshVertexStride(uint32_t vertexFormat)
+{
+	switch (vertexFormat)
+	{
+	case MESH_VERTEX_FORMAT_FLOAT32:
+		return sizeof(MeshVertex);
+	case MESH_VERTEX_FORMAT_PACKED_UNORM16_UV:
+	case MESH_VERTEX_FORMAT_PACKED_HALF_UV:
+		return sizeof(MeshPackedVertex);
+	default:
+		return 0;
+	}
+}
+
+//Checks the header of a mapped file and that every stream it points to lies inside the file
+bool ValidateMeshFile(const uint8_t* data, uint64_t size);
+
+//Rounds a file offset up to the next stream boundary
+inline uint64_t AlignMeshFileOffset(uint64_t offset)
+{
+	return (offset + MESH_FILE_STREAM_ALIGNMENT - 1) & ~static_cast<uint64_t>(MESH_FILE_STREAM_ALIGNMENT - 1);
+}
@@ -0,0 +1,433 @@
+#include "VulkanMesh.h"
+#include "EngineCore/Profiling/TraceRecorder.h"
+#include "EngineCore/VulkanHandles/VertexLayout.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+//Locations match the inputs of VulkanMesh.vert. Normalized formats are expanded to floats by the fetch hardware,
+//so the shader only has to apply the mesh's dequantization and decode the octahedral normals
+static constexpr auto meshVertexLayout = MakeVertexLayout<MeshVertex>({
+	VERTEX_ATTRIBUTE(MeshVertex, position, 0),
+	VERTEX_ATTRIBUTE(MeshVertex, normal, 1),
+	VERTEX_ATTRIBUTE(MeshVertex, uv, 2) });
+
+static constexpr auto meshPackedUnormUvVertexLayout = MakeVertexLayout<MeshPackedVertex>({
+	VERTEX_ATTRIBUTE_FORMAT(MeshPackedVertex, position, 0, VK_FORMAT_R16G16B16A16_UNORM),
+	VERTEX_ATTRIBUTE_FORMAT(MeshPackedVertex, normal, 1, VK_FORMAT_R16G16_SNORM),
+	VERTEX_ATTRIBUTE_FORMAT(MeshPackedVertex, uv, 2, VK_FORMAT_R16G16_UNORM) });
+
+static constexpr auto meshPackedHalfUvVertexLayout = MakeVertexLayout<MeshPackedVertex>({
+	VERTEX_ATTRIBUTE_FORMAT(MeshPackedVertex, position, 0, VK_FORMAT_R16G16B16A16_UNORM),
+	VERTEX_ATTRIBUTE_FORMAT(MeshPackedVertex, normal, 1, VK_FORMAT_R16G16_SNORM),
+	VERTEX_ATTRIBUTE_FORMAT(MeshPackedVertex, uv, 2, VK_FORMAT_R16G16_SFLOAT) });
+
+static_assert(meshVertexLayout.FormatsMatchMembers() && meshPackedUnormUvVertexLayout.FormatsMatchMembers() &&
+	meshPackedHalfUvVertexLayout.FormatsMatchMembers(), "A mesh vertex format does not match its member");
+static_assert(meshVertexLayout.OffsetsAligned() && meshPackedUnormUvVertexLayout.OffsetsAligned() &&
+	meshPackedHalfUvVertexLayout.OffsetsAligned(), "A mesh vertex member is not aligned");
+static_assert(meshVertexLayout.LocationsUnique() && meshPackedUnormUvVertexLayout.LocationsUnique() &&
+	meshPackedHalfUvVertexLayout.LocationsUnique(), "Two mesh vertex members share a shader location");
+static_assert(sizeof(MeshPackedVertex) * 2 == sizeof(MeshVertex), "The packed vertex is no longer half the size");
+
+//Every view culls a submesh by the sphere around its bounds
+static void GetSubmeshSphere(const MeshFileSubmesh& submesh, Vec3& center, float& radius)
+{
+	Vec3 boundsMin = { submesh.bounds.min[0], submesh.bounds.min[1], submesh.bounds.min[2] };
+	Vec3 boundsMax = { submesh.bounds.max[0], submesh.bounds.max[1], submesh.bounds.max[2] };
+	center = (boundsMin + boundsMax) * 0.5f;
+	radius = Length(boundsMax - boundsMin) * 0.5f;
+}
+
+//A sphere is culled once it is entirely outside one of the planes
+static bool IsSphereInsidePlanes(const Plane (&planes)[6], const Vec3& center, float radius)
+{
+	bool visible = true;
+	for (const Plane& plane : planes)
+	{
+		visible = visible && Dot(plane.normal, center) + plane.distance >= -radius;
+	}
+	return visible;
+}
+
+VulkanMeshHandle::VulkanMeshHandle()
+	:m_vertexBuffer(), m_indexBuffer(), m_submeshes(), m_meshlets(), m_lods(),
+	m_selectedLods(), m_fullTriangleCount{0}, m_bounds(), m_vertexFormat{MESH_VERTEX_FORMAT_FLOAT32},
+	m_vertexCount{0}, vk_indexType{VK_INDEX_TYPE_UINT32}, m_loaded{false}
+{
+
+}
+
+/********************************************************************************************
+* Function Argument 1: The device handle is needed to create the buffers and submit copies  *
+* Function Argument 2: A command pool of the graphics queue family, used for the copies	    *
+* Function Argument 3: The mesh file written by the MeshConverter tool					    *
+********************************************************************************************/
+bool VulkanMeshHandle::LoadMesh(const VulkanDeviceHandle& device, const VkCommandPool& commandPool,
+	const std::string& filename)
+{
+	TRACE_SCOPE("LoadMesh");
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+
+	MappedFile file;
+	if (!file.Open(filename) || !ValidateMeshFile(file.GetData(), file.GetSize()))
+	{
+		return false;
+	}
+
+	/* Reading the tables straight out of the mapping */
+	const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(file.GetData());
+	const MeshFileSubmesh* submeshes = reinterpret_cast<const MeshFileSubmesh*>(file.GetData() + header->submeshTableOffset);
+	m_submeshes.assign(submeshes, submeshes + header->submeshCount);
+	const MeshFileMeshlet* meshlets = reinterpret_cast<const MeshFileMeshlet*>(file.GetData() + header->meshletTableOffset);
+	m_meshlets.assign(meshlets, meshlets + header->meshletCount);
+	const MeshFileLod* lods = reinterpret_cast<const MeshFileLod*>(file.GetData() + header->lodTableOffset);
+	m_lods.assign(lods, lods + header->lodCount);
+
+	//Every submesh starts at full detail until the first selection
+	m_selectedLods.assign(m_submeshes.size(), 0);
+	m_fullTriangleCount = 0;
+	for (const MeshFileSubmesh& submesh : m_submeshes)
+	{
+		m_fullTriangleCount += submesh.indexCount / 3;
+	}
+	m_bounds = header->bounds;
+	m_vertexFormat = header->vertexFormat;
+	m_vertexCount = header->vertexCount;
+	vk_indexType = header->indexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	/* Tables read */
+
+	m_vertexBuffer.CreateBuffer(device, header->vertexDataSize,
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_indexBuffer.CreateBuffer(device, header->indexDataSize,
+		VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	/* Creating the upload context */
+	UploadContext context;
+	context.stagingBuffer.CreateBuffer(device, MESH_UPLOAD_CHUNK_SIZE * 2, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	VkCommandBufferAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 2;
+
+	VkResult allocateResult = vkAllocateCommandBuffers(vk_device, &allocateInfo, context.vk_commandBuffers);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	for (VkFence& fence : context.vk_fences)
+	{
+		VkResult fenceResult = vkCreateFence(vk_device, &fenceInfo, nullptr, &fence);
+		if (fenceResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+	/* Upload context created */
+
+	UploadStream(device, context, file.GetData() + header->vertexDataOffset, header->vertexDataSize,
+		m_vertexBuffer.GetVulkanSDKBuffer());
+	UploadStream(device, context, file.GetData() + header->indexDataOffset, header->indexDataSize,
+		m_indexBuffer.GetVulkanSDKBuffer());
+
+	//Waiting for the last chunks before the staging memory and the mapping go away
+	for (uint32_t half = 0; half < 2; ++half)
+	{
+		if (context.submitted[half])
+		{
+			vkWaitForFences(vk_device, 1, &context.vk_fences[half], VK_TRUE, UINT64_MAX);
+		}
+		vkDestroyFence(vk_device, context.vk_fences[half], nullptr);
+	}
+	vkFreeCommandBuffers(vk_device, commandPool, 2, context.vk_commandBuffers);
+	context.stagingBuffer.Cleanup(vk_device);
+
+	std::cout << "Loaded " << filename << ": " << header->vertexCount << " vertices of " << header->vertexStride
+		<< " bytes, " << header->vertexDataSize / 1024 << " KB of vertex data ("
+		<< header->vertexCount * sizeof(MeshVertex) / 1024 << " KB unpacked)\n";
+
+	m_loaded = true;
+	return true;
+}
+
+/*****************************************************************************************
+* Function Argument 1: The device handle is needed to wait on fences and submit copies	 *
+* Function Argument 2: The staging halves and their command buffers					     *
+* Function Argument 3: The start of the stream inside the file mapping				     *
+* Function Argument 4: The size of the stream in bytes								     *
+* Function Argument 5: The device local buffer the stream is copied into			     *
+*****************************************************************************************/
+void VulkanMeshHandle::UploadStream(const VulkanDeviceHandle& device, UploadContext& context,
+	const uint8_t* source, uint64_t size, const VkBuffer& destination)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+
+	for (uint64_t offset = 0; offset < size; offset += MESH_UPLOAD_CHUNK_SIZE)
+	{
+		uint32_t half = context.nextHalf;
+		context.nextHalf ^= 1;
+		uint64_t chunkSize = std::min<uint64_t>(MESH_UPLOAD_CHUNK_SIZE, size - offset);
+
+		//The other half keeps the GPU busy while this one waits for its previous copy and is refilled
+		if (context.submitted[half])
+		{
+			vkWaitForFences(vk_device, 1, &context.vk_fences[half], VK_TRUE, UINT64_MAX);
+			vkResetFences(vk_device, 1, &context.vk_fences[half]);
+		}
+
+		//Touching the mapping is what reads the file, so this copy is the only pass over the data on the CPU
+		VkDeviceSize stagingOffset = half * MESH_UPLOAD_CHUNK_SIZE;
+		std::memcpy(static_cast<uint8_t*>(context.stagingBuffer.GetMappedData()) + stagingOffset, source + offset, chunkSize);
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		const VkCommandBuffer& commandBuffer = context.vk_commandBuffers[half];
+		vkResetCommandBuffer(commandBuffer, 0);
+		VkResult beginResult = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		if (beginResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+
+		VkBufferCopy copyRegion{};
+		copyRegion.srcOffset = stagingOffset;
+		copyRegion.dstOffset = offset;
+		copyRegion.size = chunkSize;
+		vkCmdCopyBuffer(commandBuffer, context.stagingBuffer.GetVulkanSDKBuffer(), destination, 1, &copyRegion);
+
+		VkResult endResult = vkEndCommandBuffer(commandBuffer);
+		if (endResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		VkResult submitResult = vkQueueSubmit(device.GetVulkanSDKGraphicsQueue(), 1, &submitInfo, context.vk_fences[half]);
+		if (submitResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+		context.submitted[half] = true;
+	}
+}
+
+/*****************************************************************************
+* Function Argument 1: One of the MESH_VERTEX_FORMAT defines				 *
+* Function Argument 2: Filled with the single interleaved vertex binding	 *
+* Function Argument 3: Filled with one attribute per vertex shader input	 *
+*****************************************************************************/
+void VulkanMeshHandle::GetVertexInputDescription(uint32_t vertexFormat,
+	std::vector<VkVertexInputBindingDescription>& bindings, std::vector<VkVertexInputAttributeDescription>& attributes)
+{
+	bindings.clear();
+	attributes.clear();
+
+	//Vertices are interleaved in a single stream, with the layouts built at compile time above
+	switch (vertexFormat)
+	{
+	case MESH_VERTEX_FORMAT_FLOAT32:
+		meshVertexLayout.FillVertexInput(bindings, attributes);
+		break;
+	case MESH_VERTEX_FORMAT_PACKED_UNORM16_UV:
+		meshPackedUnormUvVertexLayout.FillVertexInput(bindings, attributes);
+		break;
+	case MESH_VERTEX_FORMAT_PACKED_HALF_UV:
+		meshPackedHalfUvVertexLayout.FillVertexInput(bindings, attributes);
+		break;
+	default:
+		__debugbreak();
+		break;
+	}
+}
+
+/*****************************************************************************
+* Function Argument 1: One of the MESH_VERTEX_FORMAT defines				 *
+* Function Argument 2: Receives the constants of the mesh shaders			 *
+*****************************************************************************/
+void VulkanMeshHandle::GetShaderVariant(uint32_t vertexFormat, ShaderVariantKey& variant)
+{
+	//Every packed format stores octahedral normals
+	variant.Set(SHADER_CONSTANT_MESH_OCTAHEDRAL_NORMALS, vertexFormat != MESH_VERTEX_FORMAT_FLOAT32 ? 1 : 0);
+}
+
+void VulkanMeshHandle::FillDecodeConstants(MeshPushConstants& pushConstants) const
+{
+	bool packed = m_vertexFormat != MESH_VERTEX_FORMAT_FLOAT32;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		pushConstants.positionOffset[axis] = packed ? m_bounds.min[axis] : 0.0f;
+		pushConstants.positionScale[axis] = packed ? m_bounds.max[axis] - m_bounds.min[axis] : 1.0f;
+	}
+}
+
+/***********************************************************************************
+* Function Argument 1: The frustum, camera position and error threshold to use	   *
+* Function Argument 2: One byte per submesh, the range's bytes are set to 1 if	   *
+*					   the submesh is visible and 0 if it is culled				   *
+* Function Argument 3: The first submesh of the range							   *
+* Function Argument 4: One past the last submesh of the range					   *
+***********************************************************************************/
+void VulkanMeshHandle::CullAndSelectLods(const MeshViewParameters& view, FrameVector<uint8_t>& visibleSubmeshes,
+	uint32_t firstSubmesh, uint32_t endSubmesh)
+{
+	float errorThresholdPixels = view.errorThresholdPixels;
+	for (uint32_t s = firstSubmesh; s < endSubmesh && s < m_submeshes.size(); ++s)
+	{
+		const MeshFileSubmesh& submesh = m_submeshes[s];
+		const MeshFileLod* lods = m_lods.data() + submesh.firstLod;
+
+		Vec3 center;
+		float radius;
+		GetSubmeshSphere(submesh, center, radius);
+		bool visible = IsSphereInsidePlanes(view.frustumPlanes, center, radius);
+		visibleSubmeshes[s] = visible ? 1 : 0;
+		//Culled submeshes keep their level, so they come back at the same detail they left at
+		if (!visible)
+		{
+			continue;
+		}
+
+		/* Projecting the errors from the nearest point of the submesh's bounding sphere */
+		//Inside the sphere every level is treated as if it was seen from very close, which always picks full detail
+		float distance = std::max(Length(view.cameraPosition - center) - radius, 1e-4f);
+		float pixelsPerUnit = view.projectionScale / distance;
+		/* Errors projected */
+
+		//The errors grow with each level, so the search walks from the coarsest level towards full detail
+		uint32_t current = m_selectedLods[s];
+		uint32_t coarsest = 0;
+		for (uint32_t level = submesh.lodCount; level-- > 0;)
+		{
+			if (lods[level].error * pixelsPerUnit <= errorThresholdPixels * (1.0f - MESH_LOD_HYSTERESIS))
+			{
+				coarsest = level;
+				break;
+			}
+		}
+
+		if (coarsest > current)
+		{
+			current = coarsest;
+		}
+		else if (lods[current].error * pixelsPerUnit > errorThresholdPixels * (1.0f + MESH_LOD_HYSTERESIS))
+		{
+			//Refining straight to the level that fits the threshold, rather than one level per frame
+			while (current > 0 && lods[current].error * pixelsPerUnit > errorThresholdPixels)
+			{
+				--current;
+			}
+		}
+
+		m_selectedLods[s] = current;
+	}
+}
+
+/*************************************************************************************
+* Function Argument 1: The planes of the view, facing inwards						 *
+* Function Argument 2: Resized to the submesh count, each byte is set to 1 if the	 *
+*					   submesh is inside the planes and 0 if it is culled			 *
+*************************************************************************************/
+void VulkanMeshHandle::CullSubmeshes(const Plane (&planes)[6], std::vector<uint8_t>& visibleSubmeshes) const
+{
+	visibleSubmeshes.resize(m_submeshes.size());
+	for (size_t s = 0; s < m_submeshes.size(); ++s)
+	{
+		Vec3 center;
+		float radius;
+		GetSubmeshSphere(m_submeshes[s], center, radius);
+		visibleSubmeshes[s] = IsSphereInsidePlanes(planes, center, radius) ? 1 : 0;
+	}
+}
+
+/*************************************************************************************
+* Function Argument 1: The visibility CullAndSelectLods filled for the camera		 *
+* Function Argument 2: Filled with the index range of every visible submesh			 *
+*************************************************************************************/
+void VulkanMeshHandle::BuildDrawList(const FrameVector<uint8_t>& visibleSubmeshes, FrameVector<MeshDrawRange>& draws) const
+{
+	//Reserved up front, the frame arena does not take back what a growing vector leaves behind
+	draws.clear();
+	draws.reserve(m_submeshes.size());
+	for (size_t s = 0; s < m_submeshes.size(); ++s)
+	{
+		if (!visibleSubmeshes[s])
+		{
+			continue;
+		}
+
+		const MeshFileLod& lod = m_lods[m_submeshes[s].firstLod + m_selectedLods[s]];
+		draws.push_back({ lod.firstIndex, lod.indexCount });
+	}
+}
+
+void VulkanMeshHandle::RecordDraw(const VkCommandBuffer& commandBuffer, const FrameVector<MeshDrawRange>& draws) const
+{
+	VkDeviceSize vertexOffset = 0;
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_vertexBuffer.GetVulkanSDKBuffer(), &vertexOffset);
+	vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer.GetVulkanSDKBuffer(), 0, vk_indexType);
+
+	//Every level shares the submesh's vertices, only the index range changes
+	for (const MeshDrawRange& draw : draws)
+	{
+		vkCmdDrawIndexed(commandBuffer, draw.indexCount, 1, draw.firstIndex, 0, 0);
+	}
+}
+
+void VulkanMeshHandle::RecordDraw(const VkCommandBuffer& commandBuffer, const std::vector<uint8_t>& visibleSubmeshes) const
+{
+	VkDeviceSize vertexOffset = 0;
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_vertexBuffer.GetVulkanSDKBuffer(), &vertexOffset);
+	vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer.GetVulkanSDKBuffer(), 0, vk_indexType);
+
+	//Every level shares the submesh's vertices, only the index range changes
+	for (size_t s = 0; s < m_submeshes.size(); ++s)
+	{
+		if (!visibleSubmeshes[s])
+		{
+			continue;
+		}
+
+		const MeshFileLod& lod = m_lods[m_submeshes[s].firstLod + m_selectedLods[s]];
+		vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
+	}
+}
+
+uint64_t VulkanMeshHandle::CountDrawTriangles(const FrameVector<MeshDrawRange>& draws)
+{
+	uint64_t triangles = 0;
+	for (const MeshDrawRange& draw : draws)
+	{
+		triangles += draw.indexCount / 3;
+	}
+	return triangles;
+}
+
+void VulkanMeshHandle::Cleanup(const VkDevice& device)
+{
+	if (!m_loaded)
+	{
+		return;
+	}
+
+	m_vertexBuffer.Cleanup(device);
+	m_indexBuffer.Cleanup(device);
+	m_submeshes.clear();
+	m_meshlets.clear();
+	m_lods.clear();
+	m_selectedLods.clear();
+	m_loaded = false;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "EngineCore/VulkanHandles/VulkanBuffer.h"
+#include "EngineCore/VulkanHandles/ShaderVariant.h"
+#include "EngineCore/Meshes/MeshFile.h"
+#include "EngineCore/Platform/MappedFile.h"
+#include "EngineCore/Math/VectorMath.h"
+#include "EngineCore/Memory/FrameArena.h"
+
+//Size of each half of the upload staging buffer. One half is filled from the mapping while the GPU copies the other
+#define MESH_UPLOAD_CHUNK_SIZE (16ull * 1024 * 1024)
+
+//A detail level is only switched to a coarser one once its projected error is this fraction below the threshold,
+//and only switched to a finer one once it is this fraction above it, so levels do not flicker at the boundary
+#define MESH_LOD_HYSTERESIS 0.25f
+
+//Submeshes culled and given a detail level by each job of the culling parallel for
+#define MESH_CULLING_BATCH_SIZE 64
+
+//The camera the submeshes are culled and their detail levels picked for
+struct MeshViewParameters
+{
+	Mat4 viewProjection;
+	Plane frustumPlanes[6];
+	Vec3 cameraPosition;
+	//Converts an error at a distance of one unit to pixels: screen height / (2 * tan(fov / 2))
+	float projectionScale = 0.0f;
+	//The largest error a detail level may show on screen, in pixels
+	float errorThresholdPixels = 0.0f;
+};
+
+//One submesh the camera sees, drawn at its selected detail level
+struct MeshDrawRange
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+};
+
+//Matches the push constant block of VulkanMesh.vert
+struct MeshPushConstants
+{
+	float viewProjection[16];
+
+	//Packed positions are offset + unorm * scale, float positions use an offset of 0 and a scale of 1
+	float positionOffset[3];
+	//Whether the normals are octahedral encoded is a constant of the pipeline, see GetShaderVariant
+	float padding;
+	float positionScale[3];
+};
+
+/*****************************************************************
+* Holds the device local vertex and index buffers of a mesh	     *
+* loaded from a mesh file, and the submeshes drawn from them.    *
+* The file is memory mapped and its streams are copied straight  *
+* from the mapping into staging memory, so loading is bound by   *
+* disk bandwidth rather than parsing							 *
+*****************************************************************/
+class VulkanMeshHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanMeshHandle();
+
+	//Maps the mesh file and uploads its streams, returns false if the file is missing or not a valid mesh file
+	bool LoadMesh(const VulkanDeviceHandle& device, const VkCommandPool& commandPool, const std::string& filename);
+
+	void Cleanup(const VkDevice& device);
+
+	//Culls the submeshes in [firstSubmesh, endSubmesh) against the view frustum, and picks the coarsest detail level
+	//of every visible one whose error stays under the view's threshold. The visibility holds one byte per submesh, so
+	//ranges that do not overlap can be processed by different threads at the same time
+	void CullAndSelectLods(const MeshViewParameters& view, FrameVector<uint8_t>& visibleSubmeshes, uint32_t firstSubmesh,
+		uint32_t endSubmesh);
+
+	//Culls every submesh against the planes of another view than the camera's, like a shadow cascade, into a visibility
+	//that outlives the frame. The camera's detail levels are left untouched
+	void CullSubmeshes(const Plane (&planes)[6], std::vector<uint8_t>& visibleSubmeshes) const;
+
+	//Turns the camera's visibility into the index range of every visible submesh at its selected detail level, once
+	//culling has finished, so every target and view of the frame draws the same list
+	void BuildDrawList(const FrameVector<uint8_t>& visibleSubmeshes, FrameVector<MeshDrawRange>& draws) const;
+
+	//Binds the vertex and index buffers and draws the list, the pipeline must already be bound
+	void RecordDraw(const VkCommandBuffer& commandBuffer, const FrameVector<MeshDrawRange>& draws) const;
+
+	//Draws the submeshes of a visibility CullSubmeshes filled instead of the camera's, at the camera's detail levels
+	void RecordDraw(const VkCommandBuffer& commandBuffer, const std::vector<uint8_t>& visibleSubmeshes) const;
+
+	//Returns the triangles RecordDraw draws for the list
+	static uint64_t CountDrawTriangles(const FrameVector<MeshDrawRange>& draws);
+
+	//Fills the decoding parameters of the mesh's vertex format, the view projection matrix is left untouched
+	void FillDecodeConstants(MeshPushConstants& pushConstants) const;
+
+	//Fills the vertex input bindings and attributes the mesh pipeline needs to read a vertex format
+	static void GetVertexInputDescription(uint32_t vertexFormat, std::vector<VkVertexInputBindingDescription>& bindings,
+		std::vector<VkVertexInputAttributeDescription>& attributes);
+
+	//Sets the constants that compile the decoding of a vertex format into the mesh pipeline
+	static void GetShaderVariant(uint32_t vertexFormat, ShaderVariantKey& variant);
+
+	/* Member variable getters */
+	inline bool IsLoaded() const { return m_loaded; }
+
+	inline const MeshBounds& GetBounds() const { return m_bounds; }
+
+	inline const std::vector<MeshFileSubmesh>& GetSubmeshes() const { return m_submeshes; }
+
+	//Empty unless the mesh was converted with meshlets
+	inline const std::vector<MeshFileMeshlet>& GetMeshlets() const { return m_meshlets; }
+
+	inline uint32_t GetVertexFormat() const { return m_vertexFormat; }
+
+	inline uint32_t GetVertexStride() const { return GetMeshVertexStride(m_vertexFormat); }
+
+	inline uint64_t GetVertexCount() const { return m_vertexCount; }
+
+	inline const std::vector<uint32_t>& GetSelectedLods() const { return m_selectedLods; }
+
+	//Triangles of every submesh at full detail
+	inline uint64_t GetFullTriangleCount() const { return m_fullTriangleCount; }
+
+	inline const VkBuffer& GetVulkanSDKVertexBuffer() const { return m_vertexBuffer.GetVulkanSDKBuffer(); }
+
+	inline const VkBuffer& GetVulkanSDKIndexBuffer() const { return m_indexBuffer.GetVulkanSDKBuffer(); }
+
+	inline VkIndexType GetIndexType() const { return vk_indexType; }
+	/* End member variable getters */
+private:
+	//Holds the staging buffer halves and the command buffers and fences used to copy out of them
+	struct UploadContext
+	{
+		VulkanBufferHandle stagingBuffer;
+		VkCommandBuffer vk_commandBuffers[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+		VkFence vk_fences[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+		//Set once a half has been submitted, so its fence must be waited on before it is refilled
+		bool submitted[2] = { false, false };
+		uint32_t nextHalf = 0;
+	};
+
+	//Called by LoadMesh to copy one stream of the mapping into a device local buffer, chunk by chunk
+	void UploadStream(const VulkanDeviceHandle& device, UploadContext& context, const uint8_t* source,
+		uint64_t size, const VkBuffer& destination);
+private:
+	VulkanBufferHandle m_vertexBuffer;
+	VulkanBufferHandle m_indexBuffer;
+
+	std::vector<MeshFileSubmesh> m_submeshes;
+	std::vector<MeshFileMeshlet> m_meshlets;
+	std::vector<MeshFileLod> m_lods;
+
+	//Index into the submesh's levels (not into m_lods) of the level each submesh is drawn at
+	std::vector<uint32_t> m_selectedLods;
+	uint64_t m_fullTriangleCount;
+	MeshBounds m_bounds;
+
+	uint32_t m_vertexFormat;
+	uint64_t m_vertexCount;
+	VkIndexType vk_indexType;
+
+	bool m_loaded;
+};
@@ -0,0 +1,209 @@
+#include "OverlayAtlases.h"
+
+#include <algorithm>
+#include <cmath>
+
+//The strokes of every glyph, on the grid of OverlayAtlases.h. A stroke is a line through the points of a run of
+//digit pairs, column then row, and strokes are separated by spaces. A stroke of a single point is a dot
+struct GlyphStrokes
+{
+	char character;
+	const char* strokes;
+};
+
+static const GlyphStrokes glyphStrokes[] = {
+	{ '!', "2024 26" }, { '"', "1011 3031" }, { '#', "1016 3036 0242 0444" },
+	{ '$', "413010010213334445361605 2026" }, { '%', "0640 01 45" }, { '&', "4612112031320405162644" },
+	{ '\'', "2021" }, { '(', "30121436" }, { ')', "10323416" }, { '*', "2125 0244 0442" }, { '+', "0343 2125" },
+	{ ',', "252617" }, { '-', "1333" }, { '.', "26" }, { '/', "4006" },
+	{ '0', "103041453616050110 4105" }, { '1', "112026 1636" }, { '2', "01103041420646" },
+	{ '3', "01103041423313 334445361605" }, { '4', "36300444" }, { '5', "4000033344453606" },
+	{ '6', "30100105163645443303" }, { '7', "004016" }, { '8', "103041423313020110 1304051636454433" },
+	{ '9', "43130201103041453616" },
+	{ ':', "22 25" }, { ';', "22 252617" }, { '<', "400346" }, { '=', "0242 0444" }, { '>', "004306" },
+	{ '?', "01103041422324 26" },
+	{ 'A', "0602204246 0343" }, { 'B', "0006 003041423303 3344453606" }, { 'C', "4130100105163645" },
+	{ 'D', "00062644422000" }, { 'E', "40000646 0333" }, { 'F', "400006 0333" },
+	{ 'G', "41301001051636454323" }, { 'H', "0006 4046 0343" }, { 'I', "1030 2026 1636" },
+	{ 'J', "4045361605" }, { 'K', "0006 4004 1346" }, { 'L', "000646" }, { 'M', "0600234046" },
+	{ 'N', "06004640" }, { 'O', "103041453616050110" }, { 'P', "06003041423303" },
+	{ 'Q', "103041453616050110 2446" }, { 'R', "06003041423303 2346" }, { 'S', "413010010213334445361605" },
+	{ 'T', "0040 2026" }, { 'U', "000516364540" }, { 'V', "002640" }, { 'W', "0016233640" },
+	{ 'X', "0046 4006" }, { 'Y', "0023 4023 2326" }, { 'Z', "00400646" },
+	{ '[', "30101636" }, { '\\', "0046" }, { ']', "10303616" }, { '^', "022042" }, { '_', "0747" },
+	{ '`', "1021" }, { '|', "2026" } };
+
+//A line of a glyph in texels of its cell
+struct GlyphSegment
+{
+	float start[2];
+	float end[2];
+};
+
+static float DistanceToSegment(const GlyphSegment& segment, float x, float y)
+{
+	float edge[2] = { segment.end[0] - segment.start[0], segment.end[1] - segment.start[1] };
+	float toPoint[2] = { x - segment.start[0], y - segment.start[1] };
+	float lengthSquared = edge[0] * edge[0] + edge[1] * edge[1];
+	//A dot's segment has no length, its nearest point is its only one
+	float t = lengthSquared > 0.0f ?
+		std::clamp((toPoint[0] * edge[0] + toPoint[1] * edge[1]) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+	float dx = toPoint[0] - edge[0] * t;
+	float dy = toPoint[1] - edge[1] * t;
+	return std::sqrt(dx * dx + dy * dy);
+}
+
+//Turns a glyph's strokes into the segments of its lines, in texels of its cell
+static void ParseGlyphStrokes(const char* strokes, std::vector<GlyphSegment>& segments)
+{
+	segments.clear();
+	const char* stroke = strokes;
+	while (*stroke != '\0')
+	{
+		const char* strokeEnd = stroke;
+		while (*strokeEnd != '\0' && *strokeEnd != ' ')
+		{
+			++strokeEnd;
+		}
+
+		float previous[2] = { 0.0f, 0.0f };
+		for (const char* point = stroke; point + 1 < strokeEnd; point += 2)
+		{
+			float position[2] = {
+				static_cast<float>(GLYPH_CELL_MARGIN + (point[0] - '0') * GLYPH_TEXELS_PER_UNIT),
+				static_cast<float>(GLYPH_CELL_MARGIN + (point[1] - '0') * GLYPH_TEXELS_PER_UNIT) };
+			//The first point of a stroke only starts a line, unless it is the stroke's only point
+			if (point != stroke || strokeEnd - stroke == 2)
+			{
+				const float* start = point == stroke ? position : previous;
+				segments.push_back({ { start[0], start[1] }, { position[0], position[1] } });
+			}
+			previous[0] = position[0];
+			previous[1] = position[1];
+		}
+
+		stroke = *strokeEnd == ' ' ? strokeEnd + 1 : strokeEnd;
+	}
+}
+
+/*******************************************************************************
+* Function Argument 1: Receives GLYPH_ATLAS_WIDTH * GLYPH_ATLAS_HEIGHT bytes  *
+*******************************************************************************/
+void BuildGlyphAtlas(std::vector<uint8_t>& texels)
+{
+	//Texels far from every stroke read 0, fully outside
+	texels.assign(GLYPH_ATLAS_WIDTH * GLYPH_ATLAS_HEIGHT, 0);
+
+	const float halfWidth = GLYPH_STROKE_HALF_WIDTH_UNITS * GLYPH_TEXELS_PER_UNIT;
+	std::vector<GlyphSegment> segments;
+	for (const GlyphStrokes& glyph : glyphStrokes)
+	{
+		ParseGlyphStrokes(glyph.strokes, segments);
+		uint32_t cell = static_cast<uint32_t>(glyph.character) - GLYPH_FIRST_CHARACTER;
+		uint32_t cellX = (cell % GLYPH_ATLAS_COLUMNS) * GLYPH_CELL_WIDTH;
+		uint32_t cellY = (cell / GLYPH_ATLAS_COLUMNS) * GLYPH_CELL_HEIGHT;
+
+		//The distance is measured from every texel's center to the nearest stroke, the strokes have round ends
+		for (uint32_t y = 0; y < GLYPH_CELL_HEIGHT; ++y)
+		{
+			for (uint32_t x = 0; x < GLYPH_CELL_WIDTH; ++x)
+			{
+				float nearest = static_cast<float>(GLYPH_CELL_WIDTH + GLYPH_CELL_HEIGHT);
+				for (const GlyphSegment& segment : segments)
+				{
+					nearest = std::min(nearest, DistanceToSegment(segment, x + 0.5f, y + 0.5f));
+				}
+				float value = 0.5f - (nearest - halfWidth) / (2.0f * GLYPH_DISTANCE_RANGE_TEXELS);
+				texels[(cellY + y) * GLYPH_ATLAS_WIDTH + cellX + x] =
+					static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+			}
+		}
+	}
+}
+
+/*******************************************************************
+* Function Argument 1: Receives the cell of every 7 bit character  *
+*******************************************************************/
+void BuildGlyphCellTable(uint32_t (&cells)[128])
+{
+	bool hasGlyph[128] = {};
+	for (const GlyphStrokes& glyph : glyphStrokes)
+	{
+		hasGlyph[static_cast<uint32_t>(glyph.character)] = true;
+	}
+
+	for (uint32_t character = 0; character < 128; ++character)
+	{
+		uint32_t drawn = character;
+		if (character >= 'a' && character <= 'z')
+		{
+			drawn = character - 'a' + 'A';
+		}
+		if (character < GLYPH_FIRST_CHARACTER || character >= GLYPH_FIRST_CHARACTER + GLYPH_CHARACTER_COUNT)
+		{
+			drawn = ' ';
+		}
+		else if (drawn != ' ' && !hasGlyph[drawn])
+		{
+			drawn = '?';
+		}
+		cells[character] = drawn - GLYPH_FIRST_CHARACTER;
+	}
+}
+
+/*******************************************************************************
+* Function Argument 1: Receives SPRITE_ATLAS_WIDTH * SPRITE_ATLAS_HEIGHT * 4  *
+*					   bytes												  *
+*******************************************************************************/
+void BuildSpriteAtlas(std::vector<uint8_t>& texels)
+{
+	texels.assign(SPRITE_ATLAS_WIDTH * SPRITE_ATLAS_HEIGHT * 4, 255);
+
+	//Every shape but the solid one stays inside a texel of its cell's edge, so filtering never reaches the next cell
+	const float center = SPRITE_CELL_SIZE * 0.5f;
+	const float radius = center - 2.0f;
+	const float ringWidth = 4.0f;
+	const float cornerRadius = 10.0f;
+	for (uint32_t sprite = 0; sprite < static_cast<uint32_t>(OverlaySprite::Count); ++sprite)
+	{
+		for (uint32_t y = 0; y < SPRITE_CELL_SIZE; ++y)
+		{
+			for (uint32_t x = 0; x < SPRITE_CELL_SIZE; ++x)
+			{
+				float dx = x + 0.5f - center;
+				float dy = y + 0.5f - center;
+				float distance = std::sqrt(dx * dx + dy * dy);
+
+				//The coverage of a texel is how far inside the shape's edge its center is, up to one texel
+				float coverage = 1.0f;
+				switch (static_cast<OverlaySprite>(sprite))
+				{
+				case OverlaySprite::Circle:
+					coverage = radius - distance + 0.5f;
+					break;
+				case OverlaySprite::Ring:
+					coverage = std::min(radius - distance, distance - (radius - ringWidth)) + 0.5f;
+					break;
+				case OverlaySprite::RoundedBox:
+				{
+					float cornerX = std::max(std::fabs(dx) - (radius - cornerRadius), 0.0f);
+					float cornerY = std::max(std::fabs(dy) - (radius - cornerRadius), 0.0f);
+					coverage = cornerRadius - std::sqrt(cornerX * cornerX + cornerY * cornerY) + 0.5f;
+					break;
+				}
+				case OverlaySprite::Glow:
+				{
+					float falloff = std::max(1.0f - distance / radius, 0.0f);
+					coverage = falloff * falloff;
+					break;
+				}
+				default:
+					break;
+				}
+
+				uint32_t texel = y * SPRITE_ATLAS_WIDTH + sprite * SPRITE_CELL_SIZE + x;
+				texels[texel * 4 + 3] = static_cast<uint8_t>(std::clamp(coverage, 0.0f, 1.0f) * 255.0f + 0.5f);
+			}
+		}
+	}
+}
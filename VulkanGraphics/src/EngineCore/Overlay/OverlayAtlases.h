@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//The glyph atlas has a cell for every printable ASCII character, starting at the space, in rows of this many cells
+#define GLYPH_FIRST_CHARACTER 32u
+#define GLYPH_CHARACTER_COUNT 95u
+#define GLYPH_ATLAS_COLUMNS 16u
+#define GLYPH_ATLAS_ROWS 6u
+
+//The glyphs are strokes on a grid 4 units wide and 6 units from the top of the capitals down to the baseline, with
+//descenders 1 unit below it. A unit covers this many texels of a cell
+#define GLYPH_TEXELS_PER_UNIT 5u
+#define GLYPH_CELL_WIDTH 32u
+#define GLYPH_CELL_HEIGHT 48u
+//Texels from the top left corner of a cell to the origin of its grid, room for the distance field around the strokes
+#define GLYPH_CELL_MARGIN 6u
+#define GLYPH_ATLAS_WIDTH (GLYPH_ATLAS_COLUMNS * GLYPH_CELL_WIDTH)
+#define GLYPH_ATLAS_HEIGHT (GLYPH_ATLAS_ROWS * GLYPH_CELL_HEIGHT)
+
+//The text is monospaced, every glyph moves the pen by the same advance and lines are the same distance apart
+#define GLYPH_CAP_HEIGHT_UNITS 6.0f
+#define GLYPH_ADVANCE_UNITS 5.0f
+#define GLYPH_LINE_HEIGHT_UNITS 9.0f
+#define GLYPH_STROKE_HALF_WIDTH_UNITS 0.45f
+
+//The distance field goes from 1 this many texels inside a stroke's edge to 0 this many texels outside it, so 0.5 is
+//the edge at any scale the glyph is drawn at
+#define GLYPH_DISTANCE_RANGE_TEXELS 6.0f
+
+//The shapes of the sprite atlas, each is white with its coverage in alpha, so the quad's color tints it
+enum class OverlaySprite : uint32_t
+{
+	Solid,
+	Circle,
+	Ring,
+	RoundedBox,
+	//Fades from opaque in the center to transparent at the edge, meant to be drawn additively
+	Glow,
+	Count
+};
+
+//The sprites are cells of this size side by side in a single row
+#define SPRITE_CELL_SIZE 64u
+#define SPRITE_ATLAS_WIDTH (SPRITE_CELL_SIZE * static_cast<uint32_t>(OverlaySprite::Count))
+#define SPRITE_ATLAS_HEIGHT SPRITE_CELL_SIZE
+
+//Fills the glyph atlas with one byte of distance per texel. The cell of a character is its code minus
+//GLYPH_FIRST_CHARACTER, the cells of the characters without a glyph are left empty
+void BuildGlyphAtlas(std::vector<uint8_t>& texels);
+
+//Fills in the cell drawn for every 7 bit character: lowercase letters are drawn with their capital's glyph and
+//the other characters without one with the glyph of '?'. Control characters get the empty cell of the space
+void BuildGlyphCellTable(uint32_t (&cells)[128]);
+
+//Fills the sprite atlas with four bytes of RGBA per texel
+void BuildSpriteAtlas(std::vector<uint8_t>& texels);
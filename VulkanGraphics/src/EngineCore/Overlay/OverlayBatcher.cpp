@@ -0,0 +1,637 @@
+#include "OverlayBatcher.h"
+#include "EngineCore/VulkanHandles/VertexLayout.h"
+
+#include <algorithm>
+#include <cstring>
+
+//Locations match the inputs of Overlay.vert. Every quad is one instance, the six vertices of its two triangles
+//read the same quad and pick their corner by index
+static constexpr auto overlayQuadLayout = MakeVertexLayout<OverlayQuadGpu>({
+	VERTEX_ATTRIBUTE(OverlayQuadGpu, rect, 0),
+	VERTEX_ATTRIBUTE(OverlayQuadGpu, uvRect, 1),
+	VERTEX_ATTRIBUTE_FORMAT(OverlayQuadGpu, color, 2, VK_FORMAT_R8G8B8A8_UNORM) }, 0, VK_VERTEX_INPUT_RATE_INSTANCE);
+
+static_assert(overlayQuadLayout.FormatsMatchMembers(), "An overlay quad format does not match its member");
+static_assert(overlayQuadLayout.OffsetsAligned(), "An overlay quad member is not aligned");
+static_assert(overlayQuadLayout.LocationsUnique(), "Two overlay quad members share a shader location");
+
+VulkanOverlayBatcherHandle::VulkanOverlayBatcherHandle()
+	:vk_atlasImages{}, vk_atlasMemory{}, vk_atlasViews{}, m_atlasExtents{}, vk_sampler{VK_NULL_HANDLE},
+	m_stagingBuffer(), m_atlasStagingOffsets{}, m_vertexRing(), vk_descriptorSetLayout{VK_NULL_HANDLE},
+	vk_descriptorPool{VK_NULL_HANDLE}, vk_descriptorSets{}, m_imageQuad{}, vk_imageView{VK_NULL_HANDLE},
+	vk_imageSampler{VK_NULL_HANDLE}, vk_imageSets(), m_imageSetViews(), m_imageSetSamplers(), m_batches(), m_quadCount{0},
+	m_flushedRanges(), m_flushedImageRanges(), m_flushedQuadCount{0}, m_flushedDrawCount{0}, m_droppedQuadCount{0}, m_glyphUvRects{}, m_glyphVisible{},
+	m_spriteUvRects{}, m_needsUpload{false}, m_created{false}
+{
+
+}
+
+/****************************************************************************************
+* Function Argument 1: Used to create the atlases and the buffers					    *
+* Function Argument 2: The overlay pipelines are created in it, and it makes the set    *
+*					   layout they share with the atlases' sets						    *
+* Function Argument 3: The cache the pipelines are compiled through					    *
+* Function Argument 4: How many frames can be recorded before the GPU finishes the oldest *
+****************************************************************************************/
+void VulkanOverlayBatcherHandle::CreateOverlayBatcher(const VulkanDeviceHandle& device,
+	VulkanGraphicsPipelineHandle& pipelines, const VkPipelineCache& pipelineCache, uint32_t framesInFlight)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	CreateAtlases(device);
+
+	/* Creating the sampler */
+	//The glyphs' distances are filtered linearly so the edges stay smooth when text is drawn larger than the atlas
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = VK_FILTER_LINEAR;
+	samplerInfo.minFilter = VK_FILTER_LINEAR;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = 0.0f;
+
+	VkResult samplerResult = vkCreateSampler(vk_device, &samplerInfo, nullptr, &vk_sampler);
+	if (samplerResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	/* Sampler created */
+
+	//Rewritten every frame and read once by the GPU, so it lives in device local memory the CPU can write to
+	//directly where there is any, and in host memory otherwise
+	m_vertexRing.CreateBuffer(device, sizeof(OverlayQuadGpu) * OVERLAY_MAX_QUADS * framesInFlight,
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_flushedRanges.assign(framesInFlight * OVERLAY_BATCH_COUNT, OverlayBatchRange{ 0, 0 });
+	m_flushedImageRanges.assign(framesInFlight, OverlayBatchRange{ 0, 0 });
+
+	CreateDescriptorSets(vk_device, pipelines.GetLayoutCache(), framesInFlight);
+
+	std::vector<VkVertexInputBindingDescription> vertexBindings;
+	std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+	overlayQuadLayout.FillVertexInput(vertexBindings, vertexAttributes);
+	pipelines.CreateOverlayPipelines(vk_device, pipelineCache, vertexBindings, vertexAttributes, vk_descriptorSetLayout);
+
+	/* Working out the texture coordinates */
+	//A glyph's quad covers its whole cell, so the distance field around the strokes is drawn with it
+	uint32_t glyphCells[128];
+	BuildGlyphCellTable(glyphCells);
+	for (uint32_t character = 0; character < 128; ++character)
+	{
+		uint32_t cell = glyphCells[character];
+		float u = static_cast<float>((cell % GLYPH_ATLAS_COLUMNS) * GLYPH_CELL_WIDTH);
+		float v = static_cast<float>((cell / GLYPH_ATLAS_COLUMNS) * GLYPH_CELL_HEIGHT);
+		m_glyphUvRects[character][0] = u / GLYPH_ATLAS_WIDTH;
+		m_glyphUvRects[character][1] = v / GLYPH_ATLAS_HEIGHT;
+		m_glyphUvRects[character][2] = (u + GLYPH_CELL_WIDTH) / GLYPH_ATLAS_WIDTH;
+		m_glyphUvRects[character][3] = (v + GLYPH_CELL_HEIGHT) / GLYPH_ATLAS_HEIGHT;
+		//The space's cell is empty, and so is every character drawn with it
+		m_glyphVisible[character] = cell != 0;
+	}
+
+	//The sprites' quads stop half a texel inside their cells, so filtering never reads the next sprite
+	for (uint32_t sprite = 0; sprite < static_cast<uint32_t>(OverlaySprite::Count); ++sprite)
+	{
+		m_spriteUvRects[sprite][0] = (sprite * SPRITE_CELL_SIZE + 0.5f) / SPRITE_ATLAS_WIDTH;
+		m_spriteUvRects[sprite][1] = 0.5f / SPRITE_ATLAS_HEIGHT;
+		m_spriteUvRects[sprite][2] = ((sprite + 1) * SPRITE_CELL_SIZE - 0.5f) / SPRITE_ATLAS_WIDTH;
+		m_spriteUvRects[sprite][3] = (SPRITE_ATLAS_HEIGHT - 0.5f) / SPRITE_ATLAS_HEIGHT;
+	}
+	/* Texture coordinates worked out */
+
+	m_needsUpload = true;
+	m_created = true;
+}
+
+/************************************************************************************
+* Function Argument 1: Used to create the staging buffer and the atlas images		*
+************************************************************************************/
+void VulkanOverlayBatcherHandle::CreateAtlases(const VulkanDeviceHandle& device)
+{
+	std::vector<uint8_t> spriteTexels;
+	std::vector<uint8_t> glyphTexels;
+	BuildSpriteAtlas(spriteTexels);
+	BuildGlyphAtlas(glyphTexels);
+
+	//Both sizes are multiples of 4, so the second atlas starts where a copy may start
+	const uint32_t sprites = static_cast<uint32_t>(OverlayAtlas::Sprites);
+	const uint32_t glyphs = static_cast<uint32_t>(OverlayAtlas::Glyphs);
+	m_atlasStagingOffsets[sprites] = 0;
+	m_atlasStagingOffsets[glyphs] = spriteTexels.size();
+	m_stagingBuffer.CreateBuffer(device, spriteTexels.size() + glyphTexels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	uint8_t* staging = static_cast<uint8_t*>(m_stagingBuffer.GetMappedData());
+	std::memcpy(staging + m_atlasStagingOffsets[sprites], spriteTexels.data(), spriteTexels.size());
+	std::memcpy(staging + m_atlasStagingOffsets[glyphs], glyphTexels.data(), glyphTexels.size());
+
+	//A single channel is all the distance field needs, a quarter of the memory the sprites' colors take
+	CreateAtlasImage(device, OverlayAtlas::Sprites, VK_FORMAT_R8G8B8A8_UNORM, SPRITE_ATLAS_WIDTH, SPRITE_ATLAS_HEIGHT);
+	CreateAtlasImage(device, OverlayAtlas::Glyphs, VK_FORMAT_R8_UNORM, GLYPH_ATLAS_WIDTH, GLYPH_ATLAS_HEIGHT);
+}
+
+/*************************************************************************************
+* Function Argument 1: The device handle is needed to create the image and find a	 *
+*					   device local memory type for it								 *
+* Function Argument 2: The atlas whose image is created								 *
+* Function Argument 3: The format of the atlas's texels								 *
+* Function Argument 4: The width of the atlas in texels								 *
+* Function Argument 5: The height of the atlas in texels							 *
+*************************************************************************************/
+void VulkanOverlayBatcherHandle::CreateAtlasImage(const VulkanDeviceHandle& device, OverlayAtlas atlas,
+	VkFormat format, uint32_t width, uint32_t height)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	const uint32_t index = static_cast<uint32_t>(atlas);
+	m_atlasExtents[index] = { width, height };
+
+	/* Initializing create info struct for the atlas */
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = format;
+	imageInfo.extent = { width, height, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	/* Create info struct complete */
+
+	VkResult imageResult = vkCreateImage(vk_device, &imageInfo, nullptr, &vk_atlasImages[index]);
+	if (imageResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(vk_device, vk_atlasImages[index], &memoryRequirements);
+
+	VkMemoryAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = memoryRequirements.size;
+	allocateInfo.memoryTypeIndex = device.FindMemoryTypeIndex(memoryRequirements.memoryTypeBits,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	VkResult allocateResult = vkAllocateMemory(vk_device, &allocateInfo, nullptr, &vk_atlasMemory[index]);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	vkBindImageMemory(vk_device, vk_atlasImages[index], vk_atlasMemory[index], 0);
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = vk_atlasImages[index];
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = format;
+	viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	VkResult viewResult = vkCreateImageView(vk_device, &viewInfo, nullptr, &vk_atlasViews[index]);
+	if (viewResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+}
+
+/*************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation		 *
+* Function Argument 2: Makes and owns the set layout, shared with the pipelines		 *
+* Function Argument 3: How many image sets to allocate, one per frame in flight		 *
+*************************************************************************************/
+void VulkanOverlayBatcherHandle::CreateDescriptorSets(const VkDevice& device, VulkanLayoutCache& layoutCache,
+	uint32_t framesInFlight)
+{
+	const uint32_t atlasCount = static_cast<uint32_t>(OverlayAtlas::Count);
+
+	/* Creating the descriptor set layout */
+	std::vector<VkDescriptorSetLayoutBinding> bindings(1);
+	bindings[0].binding = 0;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[0].descriptorCount = 1;
+	bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	vk_descriptorSetLayout = layoutCache.GetDescriptorSetLayout(device, bindings);
+	/* Descriptor set layout created */
+
+	/* Allocating the descriptor sets */
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSize.descriptorCount = atlasCount + framesInFlight;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = atlasCount + framesInFlight;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+
+	VkResult poolResult = vkCreateDescriptorPool(device, &poolInfo, nullptr, &vk_descriptorPool);
+	if (poolResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	std::vector<VkDescriptorSetLayout> setLayouts(atlasCount + framesInFlight, vk_descriptorSetLayout);
+	std::vector<VkDescriptorSet> sets(setLayouts.size());
+	VkDescriptorSetAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = vk_descriptorPool;
+	allocateInfo.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());
+	allocateInfo.pSetLayouts = setLayouts.data();
+
+	VkResult allocateResult = vkAllocateDescriptorSets(device, &allocateInfo, sets.data());
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	std::copy(sets.begin(), sets.begin() + atlasCount, vk_descriptorSets);
+	//The image sets are written by Flush, once an image is set
+	vk_imageSets.assign(sets.begin() + atlasCount, sets.end());
+	m_imageSetViews.assign(framesInFlight, VK_NULL_HANDLE);
+	m_imageSetSamplers.assign(framesInFlight, VK_NULL_HANDLE);
+	/* Descriptor sets allocated */
+
+	//The atlases are uploaded before the first draw samples them and never change afterwards
+	for (uint32_t atlas = 0; atlas < atlasCount; ++atlas)
+	{
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.sampler = vk_sampler;
+		imageInfo.imageView = vk_atlasViews[atlas];
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = vk_descriptorSets[atlas];
+		write.dstBinding = 0;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+	}
+}
+
+void VulkanOverlayBatcherHandle::Begin()
+{
+	for (std::vector<OverlayQuadGpu>& batch : m_batches)
+	{
+		batch.clear();
+	}
+	m_quadCount = 0;
+	m_droppedQuadCount = 0;
+	vk_imageView = VK_NULL_HANDLE;
+	vk_imageSampler = VK_NULL_HANDLE;
+}
+
+/*******************************************************************************
+* Function Argument 1: The atlas the quads are drawn from					   *
+* Function Argument 2: How the quads are blended over the frame				   *
+* Function Argument 3: How many quads to append								   *
+*******************************************************************************/
+OverlayQuadGpu* VulkanOverlayBatcherHandle::ReserveQuads(OverlayAtlas atlas, OverlayBlend blend, uint32_t quadCount)
+{
+	if (!m_created || quadCount == 0)
+	{
+		return nullptr;
+	}
+	//The ring has room for OVERLAY_MAX_QUADS quads per frame, whichever batches they are in
+	if (m_quadCount + quadCount > OVERLAY_MAX_QUADS)
+	{
+		m_droppedQuadCount += quadCount;
+		return nullptr;
+	}
+	m_quadCount += quadCount;
+
+	std::vector<OverlayQuadGpu>& batch =
+		m_batches[static_cast<uint32_t>(atlas) * static_cast<uint32_t>(OverlayBlend::Count) + static_cast<uint32_t>(blend)];
+	size_t first = batch.size();
+	batch.resize(first + quadCount);
+	return batch.data() + first;
+}
+
+/**************************************************************************************
+* Function Argument 1: The left edge of the sprite, in pixels						  *
+* Function Argument 2: The top edge of the sprite, in pixels						  *
+* Function Argument 3: The width of the sprite, in pixels							  *
+* Function Argument 4: The height of the sprite, in pixels							  *
+* Function Argument 5: The shape drawn, stretched over the rectangle				  *
+* Function Argument 6: Multiplies the sprite's color, see PackOverlayColor			  *
+* Function Argument 7: How the sprite is blended over the frame						  *
+**************************************************************************************/
+void VulkanOverlayBatcherHandle::AddSprite(float x, float y, float width, float height, OverlaySprite sprite,
+	uint32_t color, OverlayBlend blend)
+{
+	OverlayQuadGpu* quad = ReserveQuads(OverlayAtlas::Sprites, blend, 1);
+	if (quad == nullptr)
+	{
+		return;
+	}
+
+	quad->rect[0] = x;
+	quad->rect[1] = y;
+	quad->rect[2] = x + width;
+	quad->rect[3] = y + height;
+	std::memcpy(quad->uvRect, m_spriteUvRects[static_cast<uint32_t>(sprite)], sizeof(quad->uvRect));
+	quad->color = color;
+}
+
+/**************************************************************************************
+* Function Argument 1: The left edge of the text, in pixels							  *
+* Function Argument 2: The top of the first line's capitals, in pixels				  *
+* Function Argument 3: The height of the capitals, in pixels						  *
+* Function Argument 4: The text, ended by a null character							  *
+* Function Argument 5: The color of the glyphs, see PackOverlayColor				  *
+* Function Argument 6: How the glyphs are blended over the frame					  *
+**************************************************************************************/
+float VulkanOverlayBatcherHandle::AddText(float x, float y, float height, const char* text, uint32_t color,
+	OverlayBlend blend)
+{
+	//A unit of the glyph grid in pixels. The quads cover whole cells, whose grid starts a margin in from their corner
+	const float unit = height / GLYPH_CAP_HEIGHT_UNITS;
+	const float texel = unit / GLYPH_TEXELS_PER_UNIT;
+	const float cellOffset = GLYPH_CELL_MARGIN * texel;
+	const float cellWidth = GLYPH_CELL_WIDTH * texel;
+	const float cellHeight = GLYPH_CELL_HEIGHT * texel;
+	const float advance = GLYPH_ADVANCE_UNITS * unit;
+	const float lineHeight = GLYPH_LINE_HEIGHT_UNITS * unit;
+
+	/* Counting the glyphs */
+	//The quads are reserved all at once, so the whole text is either drawn or dropped
+	uint32_t glyphCount = 0;
+	for (const char* character = text; *character != '\0'; ++character)
+	{
+		uint32_t code = static_cast<unsigned char>(*character);
+		glyphCount += code >= 128 || m_glyphVisible[code] ? 1 : 0;
+	}
+	OverlayQuadGpu* quad = ReserveQuads(OverlayAtlas::Glyphs, blend, glyphCount);
+	/* Glyphs counted */
+
+	float penX = x;
+	float lineTop = y;
+	float longestLine = 0.0f;
+	for (const char* character = text; *character != '\0'; ++character)
+	{
+		if (*character == '\n')
+		{
+			longestLine = std::max(longestLine, penX - x);
+			penX = x;
+			lineTop += lineHeight;
+			continue;
+		}
+
+		//Characters past 7 bits have no glyph of their own, they are drawn like the others without one
+		uint32_t code = static_cast<unsigned char>(*character);
+		if (code >= 128)
+		{
+			code = '?';
+		}
+		if (quad != nullptr && m_glyphVisible[code])
+		{
+			quad->rect[0] = penX - cellOffset;
+			quad->rect[1] = lineTop - cellOffset;
+			quad->rect[2] = quad->rect[0] + cellWidth;
+			quad->rect[3] = quad->rect[1] + cellHeight;
+			std::memcpy(quad->uvRect, m_glyphUvRects[code], sizeof(quad->uvRect));
+			quad->color = color;
+			++quad;
+		}
+		penX += advance;
+	}
+
+	return std::max(longestLine, penX - x);
+}
+
+/**************************************************************************************
+* Function Argument 1: The left edge of the image, in pixels						  *
+* Function Argument 2: The top edge of the image, in pixels							  *
+* Function Argument 3: The width of the image, in pixels							  *
+* Function Argument 4: The height of the image, in pixels							  *
+* Function Argument 5: The view of the image, in the shader read only layout		  *
+* Function Argument 6: The sampler the image is read with							  *
+* Function Argument 7: Multiplies the image's color, see PackOverlayColor			  *
+**************************************************************************************/
+void VulkanOverlayBatcherHandle::SetImage(float x, float y, float width, float height, VkImageView imageView,
+	VkSampler sampler, uint32_t color)
+{
+	if (!m_created || imageView == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	m_imageQuad.rect[0] = x;
+	m_imageQuad.rect[1] = y;
+	m_imageQuad.rect[2] = x + width;
+	m_imageQuad.rect[3] = y + height;
+	m_imageQuad.uvRect[0] = 0.0f;
+	m_imageQuad.uvRect[1] = 0.0f;
+	m_imageQuad.uvRect[2] = 1.0f;
+	m_imageQuad.uvRect[3] = 1.0f;
+	m_imageQuad.color = color;
+	vk_imageView = imageView;
+	vk_imageSampler = sampler;
+}
+
+/*******************************************************************************
+* Function Argument 1: Used to point the frame's image set at the image		   *
+* Function Argument 2: The frame in flight whose part of the ring is written   *
+*******************************************************************************/
+void VulkanOverlayBatcherHandle::Flush(const VkDevice& device, uint32_t frameIndex)
+{
+	if (!m_created)
+	{
+		return;
+	}
+
+	//The batches are written one after another in the order they are drawn, each a run the vertex fetch reads in order
+	OverlayQuadGpu* ring = static_cast<OverlayQuadGpu*>(m_vertexRing.GetMappedData()) + frameIndex * OVERLAY_MAX_QUADS;
+	OverlayBatchRange* ranges = m_flushedRanges.data() + frameIndex * OVERLAY_BATCH_COUNT;
+	uint32_t firstQuad = 0;
+	uint32_t drawCount = 0;
+	for (uint32_t batch = 0; batch < OVERLAY_BATCH_COUNT; ++batch)
+	{
+		uint32_t quadCount = static_cast<uint32_t>(m_batches[batch].size());
+		if (quadCount != 0)
+		{
+			std::memcpy(ring + firstQuad, m_batches[batch].data(), sizeof(OverlayQuadGpu) * quadCount);
+			++drawCount;
+		}
+		ranges[batch] = { firstQuad, quadCount };
+		firstQuad += quadCount;
+	}
+
+	//The image goes after the batches, in the room left in the frame's part of the ring
+	OverlayBatchRange& imageRange = m_flushedImageRanges[frameIndex];
+	imageRange = { firstQuad, 0 };
+	if (vk_imageView != VK_NULL_HANDLE && firstQuad < OVERLAY_MAX_QUADS)
+	{
+		ring[firstQuad] = m_imageQuad;
+		imageRange.quadCount = 1;
+		++firstQuad;
+		++drawCount;
+
+		//The GPU is done with the frame's last use of its set, so it can be rewritten now
+		if (m_imageSetViews[frameIndex] != vk_imageView || m_imageSetSamplers[frameIndex] != vk_imageSampler)
+		{
+			VkDescriptorImageInfo imageInfo{};
+			imageInfo.sampler = vk_imageSampler;
+			imageInfo.imageView = vk_imageView;
+			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = vk_imageSets[frameIndex];
+			write.dstBinding = 0;
+			write.descriptorCount = 1;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			write.pImageInfo = &imageInfo;
+			vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+			m_imageSetViews[frameIndex] = vk_imageView;
+			m_imageSetSamplers[frameIndex] = vk_imageSampler;
+		}
+	}
+	else if (vk_imageView != VK_NULL_HANDLE)
+	{
+		++m_droppedQuadCount;
+	}
+
+	m_flushedQuadCount = firstQuad;
+	m_flushedDrawCount = drawCount;
+}
+
+/*******************************************************************************
+* Function Argument 1: The frame's command buffer, outside of any render pass  *
+*******************************************************************************/
+void VulkanOverlayBatcherHandle::RecordUpload(const VkCommandBuffer& commandBuffer)
+{
+	if (!m_created || !m_needsUpload)
+	{
+		return;
+	}
+
+	const uint32_t atlasCount = static_cast<uint32_t>(OverlayAtlas::Count);
+	VkImageMemoryBarrier barriers[static_cast<uint32_t>(OverlayAtlas::Count)]{};
+	for (uint32_t atlas = 0; atlas < atlasCount; ++atlas)
+	{
+		barriers[atlas].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barriers[atlas].srcAccessMask = 0;
+		barriers[atlas].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barriers[atlas].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barriers[atlas].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[atlas].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[atlas].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[atlas].image = vk_atlasImages[atlas];
+		barriers[atlas].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	}
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
+		0, nullptr, atlasCount, barriers);
+
+	for (uint32_t atlas = 0; atlas < atlasCount; ++atlas)
+	{
+		VkBufferImageCopy region{};
+		region.bufferOffset = m_atlasStagingOffsets[atlas];
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageExtent = { m_atlasExtents[atlas].width, m_atlasExtents[atlas].height, 1 };
+		vkCmdCopyBufferToImage(commandBuffer, m_stagingBuffer.GetVulkanSDKBuffer(), vk_atlasImages[atlas],
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+	}
+
+	//Only the overlay's fragment shader ever reads the atlases
+	for (VkImageMemoryBarrier& barrier : barriers)
+	{
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0,
+		nullptr, 0, nullptr, atlasCount, barriers);
+
+	m_needsUpload = false;
+}
+
+/*************************************************************************************
+* Function Argument 1: The frame's command buffer, inside the render pass			 *
+* Function Argument 2: Holds the overlay pipelines									 *
+* Function Argument 3: The size of the framebuffer, the quads are placed in pixels	 *
+* Function Argument 4: The frame in flight whose part of the ring is drawn			 *
+* Function Argument 5: Whether the deferred render pass is being recorded			 *
+*************************************************************************************/
+void VulkanOverlayBatcherHandle::RecordDraw(const VkCommandBuffer& commandBuffer,
+	const VulkanGraphicsPipelineHandle& pipelines, const VkExtent2D& extent, uint32_t frameIndex, bool deferred) const
+{
+	if (!m_created || m_flushedQuadCount == 0)
+	{
+		return;
+	}
+
+	//Every batch of the frame is read from the same binding, each draw starts at its first quad through firstInstance
+	VkDeviceSize ringOffset = sizeof(OverlayQuadGpu) * OVERLAY_MAX_QUADS * frameIndex;
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_vertexRing.GetVulkanSDKBuffer(), &ringOffset);
+
+	OverlayDrawConstants drawConstants{};
+	drawConstants.pixelToClip[0] = 2.0f / static_cast<float>(extent.width);
+	drawConstants.pixelToClip[1] = 2.0f / static_cast<float>(extent.height);
+
+	//Both pipelines share the layout, so the atlas's set stays bound when the blend state changes
+	const VkPipelineLayout& pipelineLayout = deferred ? pipelines.GetVulkanSDKDeferredOverlayPipelineLayout() :
+		pipelines.GetVulkanSDKOverlayPipelineLayout();
+	const OverlayBatchRange* ranges = m_flushedRanges.data() + frameIndex * OVERLAY_BATCH_COUNT;
+	for (uint32_t atlas = 0; atlas < static_cast<uint32_t>(OverlayAtlas::Count); ++atlas)
+	{
+		bool atlasBound = false;
+		for (uint32_t blend = 0; blend < static_cast<uint32_t>(OverlayBlend::Count); ++blend)
+		{
+			const OverlayBatchRange& range = ranges[atlas * static_cast<uint32_t>(OverlayBlend::Count) + blend];
+			if (range.quadCount == 0)
+			{
+				continue;
+			}
+
+			bool additive = blend == static_cast<uint32_t>(OverlayBlend::Additive);
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deferred ?
+				(additive ? pipelines.GetVulkanSDKDeferredAdditiveOverlayPipeline() : pipelines.GetVulkanSDKDeferredOverlayPipeline()) :
+				(additive ? pipelines.GetVulkanSDKAdditiveOverlayPipeline() : pipelines.GetVulkanSDKOverlayPipeline()));
+			if (!atlasBound)
+			{
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+					&vk_descriptorSets[atlas], 0, nullptr);
+				drawConstants.distanceField = atlas == static_cast<uint32_t>(OverlayAtlas::Glyphs) ? 1 : 0;
+				vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+					sizeof(OverlayDrawConstants), &drawConstants);
+				atlasBound = true;
+			}
+			vkCmdDraw(commandBuffer, 6, range.quadCount, 0, range.firstQuad);
+		}
+
+		//The image lands on the panels drawn from the sprites, and under the text
+		const OverlayBatchRange& imageRange = m_flushedImageRanges[frameIndex];
+		if (atlas == static_cast<uint32_t>(OverlayAtlas::Sprites) && imageRange.quadCount != 0)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deferred ?
+				pipelines.GetVulkanSDKDeferredOverlayPipeline() : pipelines.GetVulkanSDKOverlayPipeline());
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+				&vk_imageSets[frameIndex], 0, nullptr);
+			drawConstants.distanceField = 0;
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+				sizeof(OverlayDrawConstants), &drawConstants);
+			vkCmdDraw(commandBuffer, 6, 1, 0, imageRange.firstQuad);
+		}
+	}
+}
+
+void VulkanOverlayBatcherHandle::Cleanup(const VkDevice& device)
+{
+	//Destroying the pool frees the sets allocated from it
+	vkDestroyDescriptorPool(device, vk_descriptorPool, nullptr);
+	vkDestroySampler(device, vk_sampler, nullptr);
+	for (uint32_t atlas = 0; atlas < static_cast<uint32_t>(OverlayAtlas::Count); ++atlas)
+	{
+		vkDestroyImageView(device, vk_atlasViews[atlas], nullptr);
+		vkDestroyImage(device, vk_atlasImages[atlas], nullptr);
+		vkFreeMemory(device, vk_atlasMemory[atlas], nullptr);
+	}
+	m_vertexRing.Cleanup(device);
+	m_stagingBuffer.Cleanup(device);
+	m_created = false;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <vector>
+#include "EngineCore/VulkanHandles/VulkanBuffer.h"
+#include "EngineCore/VulkanHandles/VulkanGraphicsPipeline.h"
+#include "EngineCore/Overlay/OverlayAtlases.h"
+
+//The most quads a frame can draw, the ones added past it are dropped and counted
+#define OVERLAY_MAX_QUADS (1u << 16)
+
+//The atlases the quads are drawn from. The sprites are drawn first, so text always lands on the panels behind it
+enum class OverlayAtlas : uint32_t
+{
+	Sprites,
+	Glyphs,
+	Count
+};
+
+//How a quad is blended over the frame, the alpha blended quads of an atlas are drawn before its additive ones
+enum class OverlayBlend : uint32_t
+{
+	Alpha,
+	Additive,
+	Count
+};
+
+//Quads are batched by atlas and blend state, every batch that has quads is one draw
+#define OVERLAY_BATCH_COUNT (static_cast<uint32_t>(OverlayAtlas::Count) * static_cast<uint32_t>(OverlayBlend::Count))
+
+//One quad in the vertex ring, read once per instance by Overlay.vert
+struct OverlayQuadGpu
+{
+	//Top left and bottom right corners, in pixels from the framebuffer's top left corner
+	float rect[4];
+	//The matching corners in the atlas, in texture coordinates
+	float uvRect[4];
+	//Red in the lowest byte up to alpha in the highest, read as normalized components
+	uint32_t color;
+};
+
+//Matches the push constant block of Overlay.vert
+struct OverlayDrawConstants
+{
+	//Scales a pixel position into the 0 to 2 range across the framebuffer
+	float pixelToClip[2];
+	//Whether the atlas holds distance fields, which the fragment shader turns into coverage
+	uint32_t distanceField;
+	uint32_t padding;
+};
+
+//Packs a color with components from 0 to 1 the way OverlayQuadGpu stores it
+inline uint32_t PackOverlayColor(float red, float green, float blue, float alpha)
+{
+	auto toByte = [](float component)
+	{
+		return static_cast<uint32_t>((component < 0.0f ? 0.0f : component > 1.0f ? 1.0f : component) * 255.0f + 0.5f);
+	};
+	return toByte(red) | (toByte(green) << 8) | (toByte(blue) << 16) | (toByte(alpha) << 24);
+}
+
+/********************************************************************
+* Batches the 2D sprites and text drawn over the frame. While the   *
+* frame is built, quads are appended to a list per atlas and blend  *
+* state, then the lists are copied one after another into the		*
+* frame's part of a persistently mapped vertex ring, so each list	*
+* is drawn with a single instanced draw however many quads it has.  *
+* Text is drawn from a distance field atlas and stays sharp at any  *
+* size, so tens of thousands of glyphs still take a few draws		*
+********************************************************************/
+class VulkanOverlayBatcherHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanOverlayBatcherHandle();
+
+	//Builds the atlases into a staging buffer the first frame uploads, and creates the atlas images, the vertex ring
+	//with a part for every frame in flight, the descriptor set of every atlas and the overlay pipelines
+	void CreateOverlayBatcher(const VulkanDeviceHandle& device, VulkanGraphicsPipelineHandle& pipelines,
+		const VkPipelineCache& pipelineCache, uint32_t framesInFlight);
+
+	//Starts the quads of a new frame, the lists keep their memory so a steady overlay allocates nothing
+	void Begin();
+
+	//Adds a sprite covering the rectangle, in pixels from the framebuffer's top left corner
+	void AddSprite(float x, float y, float width, float height, OverlaySprite sprite, uint32_t color,
+		OverlayBlend blend = OverlayBlend::Alpha);
+
+	//Adds a quad for every glyph of the text, with the top of its first line at y. The height is the height of the
+	//capitals in pixels, and lines break at '\n'. Returns how far the pen moved along the longest line
+	float AddText(float x, float y, float height, const char* text, uint32_t color,
+		OverlayBlend blend = OverlayBlend::Alpha);
+
+	//Draws a whole image over the rectangle, alpha blended between the sprites and the text. A frame draws a single
+	//image, the last one set since Begin. The view must stay alive until the frames drawing it have finished
+	void SetImage(float x, float y, float width, float height, VkImageView imageView, VkSampler sampler, uint32_t color);
+
+	//Copies the quads added since Begin into the frame's part of the vertex ring, which the GPU is done reading,
+	//sorted by atlas and blend state, and points the frame's image set at the image set since Begin
+	void Flush(const VkDevice& device, uint32_t frameIndex);
+
+	//Copies the atlases into their images the first time it is recorded, outside of a render pass and before RecordDraw
+	void RecordUpload(const VkCommandBuffer& commandBuffer);
+
+	//Draws the frame's flushed quads inside the main render pass, or the lighting subpass of the deferred one
+	void RecordDraw(const VkCommandBuffer& commandBuffer, const VulkanGraphicsPipelineHandle& pipelines,
+		const VkExtent2D& extent, uint32_t frameIndex, bool deferred) const;
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline bool IsCreated() const { return m_created; }
+
+	//The quads and draws of the last flush, and the quads added since Begin that did not fit in the ring
+	inline uint32_t GetFlushedQuadCount() const { return m_flushedQuadCount; }
+
+	inline uint32_t GetFlushedDrawCount() const { return m_flushedDrawCount; }
+
+	inline uint32_t GetDroppedQuadCount() const { return m_droppedQuadCount; }
+	/* End member variable getters */
+private:
+	//The quads of one atlas and blend state in a frame's part of the ring
+	struct OverlayBatchRange
+	{
+		uint32_t firstQuad;
+		uint32_t quadCount;
+	};
+
+	//Called by CreateOverlayBatcher to build both atlases into the staging buffer and create their images
+	void CreateAtlases(const VulkanDeviceHandle& device);
+
+	//Called by CreateAtlases to create a sampled image the staging buffer is copied into, and its view
+	void CreateAtlasImage(const VulkanDeviceHandle& device, OverlayAtlas atlas, VkFormat format, uint32_t width,
+		uint32_t height);
+
+	//Called by CreateOverlayBatcher to create the descriptor set of every atlas, and the image set of every frame in flight
+	void CreateDescriptorSets(const VkDevice& device, VulkanLayoutCache& layoutCache, uint32_t framesInFlight);
+
+	//Appends the quads to the list of their atlas and blend state and returns the first of them to be filled in.
+	//Returns null and counts them as dropped if they do not fit in the frame's OVERLAY_MAX_QUADS
+	OverlayQuadGpu* ReserveQuads(OverlayAtlas atlas, OverlayBlend blend, uint32_t quadCount);
+private:
+	//Built on the CPU once, uploaded by the first frame and only sampled afterwards
+	VkImage vk_atlasImages[static_cast<uint32_t>(OverlayAtlas::Count)];
+	VkDeviceMemory vk_atlasMemory[static_cast<uint32_t>(OverlayAtlas::Count)];
+	VkImageView vk_atlasViews[static_cast<uint32_t>(OverlayAtlas::Count)];
+	VkExtent2D m_atlasExtents[static_cast<uint32_t>(OverlayAtlas::Count)];
+	VkSampler vk_sampler;
+
+	//Holds the texels of both atlases one after the other, kept until cleanup as it is only a few hundred KB
+	VulkanBufferHandle m_stagingBuffer;
+	VkDeviceSize m_atlasStagingOffsets[static_cast<uint32_t>(OverlayAtlas::Count)];
+
+	//OVERLAY_MAX_QUADS quads for every frame in flight, written by the CPU and read by the vertex fetch
+	VulkanBufferHandle m_vertexRing;
+
+	//The set layout is owned by the layout cache, both atlases are read through it
+	VkDescriptorSetLayout vk_descriptorSetLayout;
+	VkDescriptorPool vk_descriptorPool;
+	VkDescriptorSet vk_descriptorSets[static_cast<uint32_t>(OverlayAtlas::Count)];
+
+	//The image set since Begin, and a set per frame in flight for it, rewritten only when the image or sampler changes
+	OverlayQuadGpu m_imageQuad;
+	VkImageView vk_imageView;
+	VkSampler vk_imageSampler;
+	std::vector<VkDescriptorSet> vk_imageSets;
+	std::vector<VkImageView> m_imageSetViews;
+	std::vector<VkSampler> m_imageSetSamplers;
+
+	//The quads added since Begin, one list per atlas and blend state
+	std::vector<OverlayQuadGpu> m_batches[OVERLAY_BATCH_COUNT];
+	uint32_t m_quadCount;
+
+	//Where every batch of every frame in flight was flushed to, OVERLAY_BATCH_COUNT ranges per frame, and the quad of
+	//every frame's image
+	std::vector<OverlayBatchRange> m_flushedRanges;
+	std::vector<OverlayBatchRange> m_flushedImageRanges;
+	uint32_t m_flushedQuadCount;
+	uint32_t m_flushedDrawCount;
+	uint32_t m_droppedQuadCount;
+
+	//The texture coordinates of every character's glyph and of every sprite, worked out once from the atlases' layout
+	float m_glyphUvRects[128][4];
+	bool m_glyphVisible[128];
+	float m_spriteUvRects[static_cast<uint32_t>(OverlaySprite::Count)][4];
+
+	bool m_needsUpload;
+
+	bool m_created;
+};
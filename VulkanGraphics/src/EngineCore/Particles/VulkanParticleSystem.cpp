@@ -0,0 +1,324 @@
+#include "VulkanParticleSystem.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+VulkanParticleSystemHandle::VulkanParticleSystemHandle()
+	:m_particleBuffer(), m_deadListBuffer(), m_aliveListBuffer(), m_counterBuffer(), vk_descriptorSetLayout{VK_NULL_HANDLE},
+	vk_descriptorPool{VK_NULL_HANDLE}, vk_descriptorSet{VK_NULL_HANDLE}, vk_computePipelineLayout{VK_NULL_HANDLE},
+	vk_initPipeline{VK_NULL_HANDLE}, vk_beginPipeline{VK_NULL_HANDLE}, vk_emitPipeline{VK_NULL_HANDLE},
+	vk_simulatePipeline{VK_NULL_HANDLE}, vk_finishPipeline{VK_NULL_HANDLE}, m_emitter(), m_simulationConstants(),
+	m_emitAccumulator{0.0f}, m_maxParticles{0}, m_currentList{0}, m_needsInitialization{true}, m_created{false}
+{
+
+}
+
+/****************************************************************************************
+* Function Argument 1: Used to create the buffers in device local memory				*
+* Function Argument 2: The particle draw pipeline is created in it, next to the other   *
+*					   pipelines of the render pass, and it compiles the compute shaders *
+* Function Argument 3: The cache the pipelines are compiled through					    *
+* Function Argument 4: The most particles that can be alive at once					    *
+****************************************************************************************/
+void VulkanParticleSystemHandle::CreateParticleSystem(const VulkanDeviceHandle& device,
+	VulkanGraphicsPipelineHandle& pipelines, const VkPipelineCache& pipelineCache, uint32_t maxParticles)
+{
+	if (!device.IsComputeSupportedOnGraphicsQueue())
+	{
+		return;
+	}
+
+	//Every dispatch covers all the particles along x, so the particle count is limited by the groups a dispatch can have
+	uint64_t maxGroups = device.GetPhysicalDeviceProperties().limits.maxComputeWorkGroupCount[0];
+	m_maxParticles = static_cast<uint32_t>(std::min<uint64_t>(maxParticles, maxGroups * PARTICLE_GROUP_SIZE));
+
+	/* Creating the particle buffers */
+	//Nothing but the GPU touches them, so they all live in device local memory
+	m_particleBuffer.CreateBuffer(device, sizeof(ParticleGpu) * m_maxParticles, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_deadListBuffer.CreateBuffer(device, sizeof(uint32_t) * m_maxParticles, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_aliveListBuffer.CreateBuffer(device, sizeof(uint32_t) * m_maxParticles * 2, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_counterBuffer.CreateBuffer(device, sizeof(ParticleCounters),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	/* Particle buffers created */
+
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	CreateDescriptorSet(vk_device, pipelines.GetLayoutCache());
+	CreateComputePipelines(vk_device, pipelines, pipelineCache);
+	pipelines.CreateParticlePipeline(vk_device, pipelineCache, vk_descriptorSetLayout);
+
+	m_simulationConstants.maxParticles = m_maxParticles;
+	m_currentList = 0;
+	m_needsInitialization = true;
+	m_created = true;
+}
+
+/********************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation  *
+* Function Argument 2: Makes and owns the set layout, shared with the pipelines *
+********************************************************************************/
+void VulkanParticleSystemHandle::CreateDescriptorSet(const VkDevice& device, VulkanLayoutCache& layoutCache)
+{
+	/* Creating the descriptor set layout */
+	//The compute shaders read and write every buffer, the vertex shader reads the particles and the alive lists
+	VkDescriptorSetLayoutBinding bindings[4]{};
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		bindings[i].binding = i;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+	}
+
+	vk_descriptorSetLayout = layoutCache.GetDescriptorSetLayout(device,
+		std::vector<VkDescriptorSetLayoutBinding>(bindings, bindings + 4));
+	/* Descriptor set layout created */
+
+	/* Allocating the descriptor set */
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = 4;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = 1;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+
+	VkResult poolResult = vkCreateDescriptorPool(device, &poolInfo, nullptr, &vk_descriptorPool);
+	if (poolResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	VkDescriptorSetAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = vk_descriptorPool;
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts = &vk_descriptorSetLayout;
+
+	VkResult allocateResult = vkAllocateDescriptorSets(device, &allocateInfo, &vk_descriptorSet);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	/* Descriptor set allocated */
+
+	//The buffers never change, so the set is written once and used by every frame
+	const VulkanBufferHandle* buffers[4] = { &m_particleBuffer, &m_deadListBuffer, &m_aliveListBuffer, &m_counterBuffer };
+	VkDescriptorBufferInfo bufferInfos[4]{};
+	VkWriteDescriptorSet writes[4]{};
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		bufferInfos[i].buffer = buffers[i]->GetVulkanSDKBuffer();
+		bufferInfos[i].offset = 0;
+		bufferInfos[i].range = VK_WHOLE_SIZE;
+
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = vk_descriptorSet;
+		writes[i].dstBinding = i;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[i].pBufferInfo = &bufferInfos[i];
+	}
+	vkUpdateDescriptorSets(device, 4, writes, 0, nullptr);
+}
+
+/****************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for pipeline creation     *
+* Function Argument 2: Holds the shader code read at startup and compiles the shaders   *
+* Function Argument 3: The cache the pipelines are compiled through					    *
+****************************************************************************************/
+void VulkanParticleSystemHandle::CreateComputePipelines(const VkDevice& device, VulkanGraphicsPipelineHandle& pipelines,
+	const VkPipelineCache& pipelineCache)
+{
+	//Every pass binds the same set and pushes the same constants, so they share the layout of their combined interface
+	vk_computePipelineLayout = pipelines.GetReflectedPipelineLayout(device, { "Shaders/particleInit.spv",
+		"Shaders/particleBegin.spv", "Shaders/particleEmit.spv", "Shaders/particleSimulate.spv", "Shaders/particleFinish.spv" },
+		{ vk_descriptorSetLayout });
+
+	//The group size the dispatches below are counted in, and the one the begin pass sizes the indirect dispatches with
+	ShaderVariantKey variant;
+	variant.Set(SHADER_CONSTANT_PARTICLE_GROUP_SIZE, PARTICLE_GROUP_SIZE);
+
+	pipelines.CreateComputePipeline(device, pipelineCache, "Shaders/particleInit.spv", vk_computePipelineLayout, vk_initPipeline,
+		variant);
+	pipelines.CreateComputePipeline(device, pipelineCache, "Shaders/particleBegin.spv", vk_computePipelineLayout, vk_beginPipeline,
+		variant);
+	pipelines.CreateComputePipeline(device, pipelineCache, "Shaders/particleEmit.spv", vk_computePipelineLayout, vk_emitPipeline,
+		variant);
+	pipelines.CreateComputePipeline(device, pipelineCache, "Shaders/particleSimulate.spv", vk_computePipelineLayout,
+		vk_simulatePipeline, variant);
+	pipelines.CreateComputePipeline(device, pipelineCache, "Shaders/particleFinish.spv", vk_computePipelineLayout, vk_finishPipeline);
+}
+
+void VulkanParticleSystemHandle::Update(float deltaSeconds)
+{
+	if (!m_created)
+	{
+		return;
+	}
+
+	float step = std::min(deltaSeconds, PARTICLE_MAX_STEP_SECONDS);
+
+	//The emission is only requested here, the GPU clamps it to the particles that are actually free
+	m_emitAccumulator += m_emitter.emitRate * step;
+	uint32_t emitRequest = static_cast<uint32_t>(std::min(m_emitAccumulator, static_cast<float>(m_maxParticles)));
+	m_emitAccumulator = std::min(m_emitAccumulator - static_cast<float>(emitRequest), 1.0f);
+
+	ParticleSimulationConstants& constants = m_simulationConstants;
+	constants.emitterPosition[0] = m_emitter.position.x;
+	constants.emitterPosition[1] = m_emitter.position.y;
+	constants.emitterPosition[2] = m_emitter.position.z;
+	constants.emitterRadius = m_emitter.radius;
+	constants.gravity[0] = m_emitter.gravity.x;
+	constants.gravity[1] = m_emitter.gravity.y;
+	constants.gravity[2] = m_emitter.gravity.z;
+	constants.deltaTime = step;
+	constants.emitSpeed = m_emitter.speed;
+	constants.lifetime = m_emitter.lifetime;
+	constants.emitRequest = emitRequest;
+	//Only has to differ between frames, the shaders hash it with the thread index
+	++constants.randomSeed;
+}
+
+/*************************************************************************************
+* Function Argument 1: The frame's command buffer, outside of the render pass		 *
+* Function Argument 2: The passes are timed in a scope of their own					 *
+*************************************************************************************/
+void VulkanParticleSystemHandle::RecordSimulation(const VkCommandBuffer& commandBuffer, VulkanGpuProfilerHandle& profiler)
+{
+	if (!m_created)
+	{
+		return;
+	}
+
+	GpuProfileScope particleScope(profiler, commandBuffer, "Particles", false);
+
+	//The last frame's draw has to be done reading the lists and the counters before they are written again,
+	//and its simulation's writes have to be visible to this one's
+	VkMemoryBarrier previousFrameBarrier{};
+	previousFrameBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	previousFrameBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	previousFrameBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &previousFrameBarrier, 0, nullptr, 0, nullptr);
+
+	m_simulationConstants.currentList = m_currentList;
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk_computePipelineLayout, 0, 1, &vk_descriptorSet,
+		0, nullptr);
+	vkCmdPushConstants(commandBuffer, vk_computePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+		sizeof(ParticleSimulationConstants), &m_simulationConstants);
+
+	if (m_needsInitialization)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk_initPipeline);
+		vkCmdDispatch(commandBuffer, (m_maxParticles + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE, 1, 1);
+		RecordComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+		m_needsInitialization = false;
+	}
+
+	//Sizes the emission and simulation dispatches from the counts on the GPU
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk_beginPipeline);
+	vkCmdDispatch(commandBuffer, 1, 1, 1);
+	RecordComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+		VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk_emitPipeline);
+	vkCmdDispatchIndirect(commandBuffer, m_counterBuffer.GetVulkanSDKBuffer(), offsetof(ParticleCounters, emitDispatch));
+	RecordComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+	//Moves the live particles and compacts the survivors into the other alive list
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk_simulatePipeline);
+	vkCmdDispatchIndirect(commandBuffer, m_counterBuffer.GetVulkanSDKBuffer(), offsetof(ParticleCounters, simulateDispatch));
+	RecordComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+	//Writes the draw of the survivors
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk_finishPipeline);
+	vkCmdDispatch(commandBuffer, 1, 1, 1);
+	RecordComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+		VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+
+	//The survivors are in the other list now, which is the one drawn and the one the next frame simulates
+	m_currentList = 1 - m_currentList;
+}
+
+/*************************************************************************************
+* Function Argument 1: The frame's command buffer, inside the render pass			 *
+* Function Argument 2: Holds the particle draw pipeline								 *
+* Function Argument 3: The camera the particles are drawn from						 *
+* Function Argument 4: The size of the framebuffer, the particles are sized in pixels *
+* Function Argument 5: The multiview set, VK_NULL_HANDLE outside of that render pass *
+* Function Argument 6: Whether the deferred render pass is being recorded			 *
+*************************************************************************************/
+void VulkanParticleSystemHandle::RecordDraw(const VkCommandBuffer& commandBuffer, const VulkanGraphicsPipelineHandle& pipelines,
+	const Mat4& viewProjection, const VkExtent2D& extent, const VkDescriptorSet& multiviewSet, bool deferred) const
+{
+	if (!m_created)
+	{
+		return;
+	}
+
+	ParticleDrawConstants drawConstants{};
+	std::memcpy(drawConstants.viewProjection, viewProjection.m, sizeof(drawConstants.viewProjection));
+	//Clip space spans 2 units across the framebuffer, and the size is a diameter while the constant is a half size
+	drawConstants.particleSize[0] = m_emitter.sizePixels / static_cast<float>(extent.width);
+	drawConstants.particleSize[1] = m_emitter.sizePixels / static_cast<float>(extent.height);
+	drawConstants.aliveList = m_currentList;
+	drawConstants.maxParticles = m_maxParticles;
+
+	//The multiview variant takes the matrices from the set after the particle buffers, the one in the constants is unused
+	const bool multiview = multiviewSet != VK_NULL_HANDLE;
+	const VkPipelineLayout& pipelineLayout = multiview ? pipelines.GetVulkanSDKMultiviewParticlePipelineLayout() :
+		deferred ? pipelines.GetVulkanSDKDeferredParticlePipelineLayout() : pipelines.GetVulkanSDKParticlePipelineLayout();
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, multiview ?
+		pipelines.GetVulkanSDKMultiviewParticlePipeline() : deferred ? pipelines.GetVulkanSDKDeferredParticlePipeline() :
+		pipelines.GetVulkanSDKParticlePipeline());
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &vk_descriptorSet, 0, nullptr);
+	if (multiview)
+	{
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &multiviewSet, 0, nullptr);
+	}
+	vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ParticleDrawConstants), &drawConstants);
+	vkCmdDrawIndirect(commandBuffer, m_counterBuffer.GetVulkanSDKBuffer(), offsetof(ParticleCounters, draw), 1,
+		sizeof(VkDrawIndirectCommand));
+}
+
+/*****************************************************************************
+* Function Argument 1: The command buffer the barrier is recorded into		 *
+* Function Argument 2: The stages that wait for the compute shaders			 *
+* Function Argument 3: How those stages access what the compute shaders wrote *
+*****************************************************************************/
+void VulkanParticleSystemHandle::RecordComputeBarrier(const VkCommandBuffer& commandBuffer, VkPipelineStageFlags dstStages,
+	VkAccessFlags dstAccess)
+{
+	//A global barrier rather than one per buffer, every pass touches most of the buffers anyway
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = dstAccess;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void VulkanParticleSystemHandle::Cleanup(const VkDevice& device)
+{
+	vkDestroyPipeline(device, vk_initPipeline, nullptr);
+	vkDestroyPipeline(device, vk_beginPipeline, nullptr);
+	vkDestroyPipeline(device, vk_emitPipeline, nullptr);
+	vkDestroyPipeline(device, vk_simulatePipeline, nullptr);
+	vkDestroyPipeline(device, vk_finishPipeline, nullptr);
+	//Destroying the pool frees the set allocated from it
+	vkDestroyDescriptorPool(device, vk_descriptorPool, nullptr);
+	m_counterBuffer.Cleanup(device);
+	m_aliveListBuffer.Cleanup(device);
+	m_deadListBuffer.Cleanup(device);
+	m_particleBuffer.Cleanup(device);
+	m_created = false;
+}
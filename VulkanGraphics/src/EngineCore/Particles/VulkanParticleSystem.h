@@ -0,0 +1,165 @@
+#pragma once
+
+#include "EngineCore/VulkanHandles/VulkanBuffer.h"
+#include "EngineCore/VulkanHandles/VulkanGraphicsPipeline.h"
+#include "EngineCore/Profiling/VulkanGpuProfiler.h"
+#include "EngineCore/Math/VectorMath.h"
+
+//Threads per group of the particle compute shaders, given to them as a specialization constant
+#define PARTICLE_GROUP_SIZE 256
+
+//The emission of a frame is based on at most this many seconds, so a long hitch does not emit a burst of particles
+#define PARTICLE_MAX_STEP_SECONDS 0.1f
+
+//Matches Particle in ParticleCommon.glsl
+struct ParticleGpu
+{
+	//Position, and the seconds since the particle was emitted
+	float positionAge[4];
+	//Velocity, and the seconds the particle lives for
+	float velocityLifetime[4];
+};
+
+//Matches CounterBuffer in ParticleCommon.glsl. Only the GPU reads and writes it, the indirect commands are read from it
+struct ParticleCounters
+{
+	uint32_t deadCount;
+	uint32_t aliveCount[2];
+	uint32_t emitCount;
+	uint32_t emitDeadBase;
+	uint32_t emitAliveBase;
+	VkDispatchIndirectCommand emitDispatch;
+	VkDispatchIndirectCommand simulateDispatch;
+	VkDrawIndirectCommand draw;
+};
+
+//Matches the push constant block of ParticleSimulation.glsl
+struct ParticleSimulationConstants
+{
+	float emitterPosition[3];
+	float emitterRadius;
+	float gravity[3];
+	float deltaTime;
+	float emitSpeed;
+	float lifetime;
+	uint32_t emitRequest;
+	uint32_t currentList;
+	uint32_t randomSeed;
+	uint32_t maxParticles;
+};
+
+//Matches the push constant block of Particle.vert
+struct ParticleDrawConstants
+{
+	float viewProjection[16];
+	//Half the size of a particle in clip space at a w of 1
+	float particleSize[2];
+	uint32_t aliveList;
+	uint32_t maxParticles;
+};
+
+//Where and how particles are emitted
+struct ParticleEmitterSettings
+{
+	Vec3 position;
+	//Particles are emitted from a horizontal disc of this radius around the position
+	float radius = 0.1f;
+	//Particles emitted per second, emission stops while every particle is alive
+	float emitRate = 0.0f;
+	//Particles live between half of this and this many seconds
+	float lifetime = 1.0f;
+	//Particles leave the emitter upwards in a narrow cone, at around this speed
+	float speed = 1.0f;
+	Vec3 gravity = { 0.0f, -9.81f, 0.0f };
+	//Every particle covers a square of this many pixels, however far away it is
+	float sizePixels = 2.0f;
+};
+
+/******************************************************************
+* Particles that live entirely on the GPU. Every frame, compute	  *
+* shaders emit particles into free slots taken from a dead list,  *
+* move the live ones and compact the survivors into the other of  *
+* two alive lists, returning the dead to the dead list. The counts *
+* stay in a GPU buffer that the dispatches and the draw read their *
+* sizes from indirectly, so the CPU records the same few commands *
+* however many particles there are and never reads anything back  *
+******************************************************************/
+class VulkanParticleSystemHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanParticleSystemHandle();
+
+	//Creates the particle buffers, the descriptor set the shaders read them through, and the compute and draw pipelines.
+	//Does nothing if the graphics queue cannot run compute shaders, the particles are then never simulated or drawn
+	void CreateParticleSystem(const VulkanDeviceHandle& device, VulkanGraphicsPipelineHandle& pipelines,
+		const VkPipelineCache& pipelineCache, uint32_t maxParticles);
+
+	//Works out how many particles the frame emits, which is all the CPU does for the particles
+	void Update(float deltaSeconds);
+
+	//Records the emission, simulation and compaction, outside of a render pass and before RecordDraw
+	void RecordSimulation(const VkCommandBuffer& commandBuffer, VulkanGpuProfilerHandle& profiler);
+
+	//Draws every live particle with a single indirect draw, inside the render pass. Inside the multiview render pass,
+	//the set holding the matrix of every view is passed, otherwise VK_NULL_HANDLE. Inside the deferred render pass,
+	//the particles are drawn in the lighting subpass
+	void RecordDraw(const VkCommandBuffer& commandBuffer, const VulkanGraphicsPipelineHandle& pipelines,
+		const Mat4& viewProjection, const VkExtent2D& extent, const VkDescriptorSet& multiviewSet, bool deferred) const;
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters and setters */
+	inline bool IsCreated() const { return m_created; }
+
+	inline uint32_t GetMaxParticles() const { return m_maxParticles; }
+
+	inline void SetEmitter(const ParticleEmitterSettings& emitter) { m_emitter = emitter; }
+	/* End member variable getters and setters */
+private:
+	//Called by CreateParticleSystem to create the buffers, and the descriptor set pointing at them
+	void CreateDescriptorSet(const VkDevice& device, VulkanLayoutCache& layoutCache);
+
+	//Called by CreateParticleSystem to create the compute pipelines and their layout
+	void CreateComputePipelines(const VkDevice& device, VulkanGraphicsPipelineHandle& pipelines,
+		const VkPipelineCache& pipelineCache);
+
+	//Makes the writes of the compute shaders recorded so far visible to the given stages
+	static void RecordComputeBarrier(const VkCommandBuffer& commandBuffer, VkPipelineStageFlags dstStages,
+		VkAccessFlags dstAccess);
+private:
+	VulkanBufferHandle m_particleBuffer;
+	VulkanBufferHandle m_deadListBuffer;
+	//Both alive lists, one after the other
+	VulkanBufferHandle m_aliveListBuffer;
+	VulkanBufferHandle m_counterBuffer;
+
+	//The set layout and the compute pipeline layout are owned by the layout cache
+	VkDescriptorSetLayout vk_descriptorSetLayout;
+	VkDescriptorPool vk_descriptorPool;
+	VkDescriptorSet vk_descriptorSet;
+
+	//Every compute pass shares the layout, so the descriptor set and push constants are only bound once a frame
+	VkPipelineLayout vk_computePipelineLayout;
+	VkPipeline vk_initPipeline;
+	VkPipeline vk_beginPipeline;
+	VkPipeline vk_emitPipeline;
+	VkPipeline vk_simulatePipeline;
+	VkPipeline vk_finishPipeline;
+
+	ParticleEmitterSettings m_emitter;
+	ParticleSimulationConstants m_simulationConstants;
+
+	//Fractions of a particle that were due but not emitted yet, so low emission rates still emit at high frame rates
+	float m_emitAccumulator;
+
+	uint32_t m_maxParticles;
+
+	//The alive list the next simulation reads, the GPU flips between the lists in the same order the frames are recorded
+	uint32_t m_currentList;
+
+	//The dead list is filled on the GPU by the first simulation recorded
+	bool m_needsInitialization;
+
+	bool m_created;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/*****************************************************************
+* Maps a whole file into the address space as read only memory.  *
+* Pages are only read from disk when they are first touched, so  *
+* copying out of the mapping streams the file at disk speed with *
+* no intermediate buffers									     *
+*****************************************************************/
+class MappedFile
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	MappedFile();
+
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//Maps the file, hinting the OS that it will be read sequentially. Returns false if it could not be opened or mapped
+	bool Open(const std::string& filename);
+
+	//Unmaps the file, pointers into the mapping become invalid
+	void Close();
+
+	/* Member variable getters */
+	inline const uint8_t* GetData() const { return m_data; }
+
+	inline uint64_t GetSize() const { return m_size; }
+
+	inline bool IsOpen() const { return m_data != nullptr; }
+	/* End member variable getters */
+private:
+	const uint8_t* m_data;
+	uint64_t m_size;
+
+	//The file and mapping handles on Windows, the file descriptor elsewhere
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#else
+	int m_fileDescriptor;
+#endif
+};
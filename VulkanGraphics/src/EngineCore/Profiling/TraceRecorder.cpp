@@ -0,0 +1,226 @@
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <iomanip>
+
+//Process ids used to split the CPU threads and the GPU queue into separate rows of the trace
+#define TRACE_CPU_PROCESS_ID 1
+#define TRACE_GPU_PROCESS_ID 2
+
+TraceThreadBuffer::TraceThreadBuffer(uint32_t threadId, const std::string& threadName)
+	:m_events(TRACE_BUFFER_CAPACITY), m_writeIndex{0}, m_readIndex{0}, m_droppedEvents{0},
+	m_threadId{threadId}, m_threadName(threadName)
+{
+
+}
+
+void TraceThreadBuffer::Push(const TraceEvent& event)
+{
+	uint64_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+	//If the buffer is full, the event is dropped rather than waiting for the writer thread
+	if (writeIndex - m_readIndex.load(std::memory_order_acquire) >= TRACE_BUFFER_CAPACITY)
+	{
+		m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	m_events[writeIndex % TRACE_BUFFER_CAPACITY] = event;
+	//Publishing the event to the writer thread only after it has been fully written
+	m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+}
+
+TraceRecorder& TraceRecorder::Get()
+{
+	static TraceRecorder recorder;
+	return recorder;
+}
+
+TraceRecorder::TraceRecorder()
+	:m_capturing{false}, m_threadBuffers(), m_nextThreadId{1}, m_gpuBuffer(0, "Graphics queue"),
+	m_file(), m_firstEvent{true}, m_namedThreads(), m_captureStartNs{0}, m_stopWriter{false}
+{
+
+}
+
+TraceRecorder::~TraceRecorder()
+{
+	EndCapture();
+
+	for (TraceThreadBuffer* buffer : m_threadBuffers)
+	{
+		delete buffer;
+	}
+}
+
+TraceThreadBuffer& TraceRecorder::GetThreadBuffer()
+{
+	//Every thread caches its own buffer, so the registry is only locked the first time
+	thread_local TraceThreadBuffer* threadBuffer = nullptr;
+	if (!threadBuffer)
+	{
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		uint32_t threadId = m_nextThreadId++;
+		threadBuffer = new TraceThreadBuffer(threadId, "Thread " + std::to_string(threadId));
+		m_threadBuffers.push_back(threadBuffer);
+	}
+	return *threadBuffer;
+}
+
+void TraceRecorder::SetThreadName(const std::string& threadName)
+{
+	TraceThreadBuffer& buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	buffer.SetThreadName(threadName);
+}
+
+/**************************************************************************
+* Function Argument 1: The name of the region, must be a string literal   *
+* Function Argument 2: The time the region started, taken from Now()	  *
+* Function Argument 3: The time the region ended, taken from Now()		  *
+**************************************************************************/
+void TraceRecorder::RecordCpuEvent(const char* name, uint64_t startNs, uint64_t endNs)
+{
+	if (!IsCapturing())
+	{
+		return;
+	}
+
+	GetThreadBuffer().Push({ name, "CPU", startNs, endNs - startNs });
+}
+
+/*****************************************************************************************
+* Function Argument 1: The name of the GPU profiler scope								 *
+* Function Argument 2: The time the scope started, already converted to the CPU's clock  *
+* Function Argument 3: The time the scope ended, already converted to the CPU's clock	 *
+*****************************************************************************************/
+void TraceRecorder::RecordGpuEvent(const char* name, uint64_t startNs, uint64_t endNs)
+{
+	if (!IsCapturing())
+	{
+		return;
+	}
+
+	m_gpuBuffer.Push({ name, "GPU", startNs, endNs > startNs ? endNs - startNs : 0 });
+}
+
+void TraceRecorder::BeginCapture(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+	if (m_capturing.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	m_file.open(filename, std::ios::out | std::ios::trunc);
+	if (!m_file.is_open())
+	{
+		return;
+	}
+
+	/* Resetting the capture state */
+	//Timestamps are written in microseconds with nanosecond precision, no matter how long the capture runs
+	m_file << std::fixed << std::setprecision(3);
+	m_file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	m_firstEvent = true;
+	m_namedThreads.clear();
+	m_captureStartNs = Now();
+	WriteThreadName(TRACE_GPU_PROCESS_ID, m_gpuBuffer.GetThreadId(), m_gpuBuffer.GetThreadName());
+	/* Capture state reset */
+
+	//Events left over from a previous capture are thrown away
+	{
+		std::lock_guard<std::mutex> buffersLock(m_buffersMutex);
+		for (TraceThreadBuffer* buffer : m_threadBuffers)
+		{
+			buffer->Drain([](const TraceEvent&) {});
+		}
+		m_gpuBuffer.Drain([](const TraceEvent&) {});
+	}
+
+	m_stopWriter = false;
+	m_capturing.store(true, std::memory_order_relaxed);
+	m_writerThread = std::thread(&TraceRecorder::WriterLoop, this);
+}
+
+void TraceRecorder::EndCapture()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_fileMutex);
+		if (!m_capturing.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		m_capturing.store(false, std::memory_order_relaxed);
+		m_stopWriter = true;
+	}
+	m_writerCondition.notify_one();
+	m_writerThread.join();
+
+	//The writer thread has stopped, so the last events are written here
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+	WritePendingEvents();
+	m_file << "\n]}\n";
+	m_file.close();
+}
+
+void TraceRecorder::WriterLoop()
+{
+	std::unique_lock<std::mutex> lock(m_fileMutex);
+	while (!m_stopWriter)
+	{
+		m_writerCondition.wait_for(lock, std::chrono::milliseconds(TRACE_WRITER_INTERVAL_MS));
+		WritePendingEvents();
+	}
+}
+
+void TraceRecorder::WritePendingEvents()
+{
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	for (TraceThreadBuffer* buffer : m_threadBuffers)
+	{
+		uint32_t threadId = buffer->GetThreadId();
+		//Naming the thread's track the first time it is seen in this capture
+		if (std::find(m_namedThreads.begin(), m_namedThreads.end(), threadId) == m_namedThreads.end())
+		{
+			WriteThreadName(TRACE_CPU_PROCESS_ID, threadId, buffer->GetThreadName());
+			m_namedThreads.push_back(threadId);
+		}
+
+		buffer->Drain([this, threadId](const TraceEvent& event)
+		{
+			WriteEvent(TRACE_CPU_PROCESS_ID, threadId, event);
+		});
+	}
+
+	uint32_t gpuThreadId = m_gpuBuffer.GetThreadId();
+	m_gpuBuffer.Drain([this, gpuThreadId](const TraceEvent& event)
+	{
+		WriteEvent(TRACE_GPU_PROCESS_ID, gpuThreadId, event);
+	});
+
+	m_file.flush();
+}
+
+void TraceRecorder::WriteThreadName(uint32_t processId, uint32_t threadId, const std::string& name)
+{
+	m_file << (m_firstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << processId
+		<< ",\"tid\":" << threadId << ",\"args\":{\"name\":\"" << name << "\"}}";
+	m_firstEvent = false;
+}
+
+void TraceRecorder::WriteEvent(uint32_t processId, uint32_t threadId, const TraceEvent& event)
+{
+	//GPU results arrive a few frames late, so they can belong to frames recorded before the capture started
+	if (event.startNs < m_captureStartNs)
+	{
+		return;
+	}
+
+	//Chrome traces use microseconds
+	double timestampUs = static_cast<double>(event.startNs - m_captureStartNs) / 1000.0;
+	double durationUs = static_cast<double>(event.durationNs) / 1000.0;
+	m_file << (m_firstEvent ? "" : ",\n") << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+		<< "\",\"ph\":\"X\",\"pid\":" << processId << ",\"tid\":" << threadId
+		<< ",\"ts\":" << timestampUs << ",\"dur\":" << durationUs << '}';
+	m_firstEvent = false;
+}
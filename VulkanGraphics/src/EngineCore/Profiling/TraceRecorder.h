@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Amount of events each thread can record before the writer thread drains them, extra events are dropped
+#define TRACE_BUFFER_CAPACITY 16384
+
+//How often (in milliseconds) the writer thread streams recorded events to the trace file
+#define TRACE_WRITER_INTERVAL_MS 100
+
+//Holds a single timed region, names are never copied so they must be string literals (or outlive the capture)
+struct TraceEvent
+{
+	const char* name;
+	const char* category;
+	uint64_t startNs;
+	uint64_t durationNs;
+};
+
+/**************************************************************
+* Holds the events recorded by a single thread. Only the      *
+* owning thread writes to it and only the writer thread reads *
+* from it, so appending an event never takes a lock           *
+**************************************************************/
+class TraceThreadBuffer
+{
+public:
+	TraceThreadBuffer(uint32_t threadId, const std::string& threadName);
+
+	//Called by the owning thread, drops the event if the writer thread has fallen behind
+	void Push(const TraceEvent& event);
+
+	//Called by the writer thread, passes every event that has not been read yet to the callback
+	template<typename Callback>
+	void Drain(Callback&& callback)
+	{
+		uint64_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+		uint64_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+		for (; readIndex < writeIndex; ++readIndex)
+		{
+			callback(m_events[readIndex % TRACE_BUFFER_CAPACITY]);
+		}
+		m_readIndex.store(readIndex, std::memory_order_release);
+	}
+
+	/* Member variable getters */
+	inline uint32_t GetThreadId() const { return m_threadId; }
+
+	inline const std::string& GetThreadName() const { return m_threadName; }
+
+	inline uint64_t GetDroppedEventCount() const { return m_droppedEvents.load(std::memory_order_relaxed); }
+	/* End member variable getters */
+
+	inline void SetThreadName(const std::string& threadName) { m_threadName = threadName; }
+private:
+	std::vector<TraceEvent> m_events;
+
+	//Only written by the owning thread
+	std::atomic<uint64_t> m_writeIndex;
+	//Only written by the writer thread
+	std::atomic<uint64_t> m_readIndex;
+
+	std::atomic<uint64_t> m_droppedEvents;
+
+	uint32_t m_threadId;
+	std::string m_threadName;
+};
+
+/*******************************************************************
+* Records CPU regions from every thread and GPU regions from the   *
+* GPU profiler, and streams them to a Chrome trace JSON file that  *
+* can be opened in chrome://tracing or Perfetto. While no capture  *
+* is running, recording a region costs a single relaxed load       *
+*******************************************************************/
+class TraceRecorder
+{
+public:
+	//The recorder is shared by every thread, so there is a single instance of it
+	static TraceRecorder& Get();
+
+	//Returns the current time of the clock used by every trace event, in nanoseconds
+	static inline uint64_t Now()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	inline bool IsCapturing() const { return m_capturing.load(std::memory_order_relaxed); }
+
+	//Opens the trace file and starts the writer thread, does nothing if a capture is already running
+	void BeginCapture(const std::string& filename);
+
+	//Stops recording, writes the remaining events and closes the trace file
+	void EndCapture();
+
+	//Records a CPU region on the calling thread's buffer
+	void RecordCpuEvent(const char* name, uint64_t startNs, uint64_t endNs);
+
+	//Records a GPU region, must always be called from the same thread (the one resolving GPU profiler results)
+	void RecordGpuEvent(const char* name, uint64_t startNs, uint64_t endNs);
+
+	//Gives the calling thread a name that will be shown on its track in the trace
+	void SetThreadName(const std::string& threadName);
+private:
+	TraceRecorder();
+	~TraceRecorder();
+
+	//Returns the calling thread's buffer, creating and registering it the first time the thread records something
+	TraceThreadBuffer& GetThreadBuffer();
+
+	//Runs on the writer thread, streaming events to the file until the capture ends
+	void WriterLoop();
+
+	//Writes every event that has not been written yet, must be called with m_fileMutex locked
+	void WritePendingEvents();
+
+	//Writes the metadata event that names a thread's track
+	void WriteThreadName(uint32_t processId, uint32_t threadId, const std::string& name);
+
+	//Writes a single complete event, starting it with a comma if it is not the first event in the file
+	void WriteEvent(uint32_t processId, uint32_t threadId, const TraceEvent& event);
+private:
+	std::atomic<bool> m_capturing;
+
+	//Protects m_threadBuffers, only locked when a thread records its first event and when the writer drains
+	std::mutex m_buffersMutex;
+	std::vector<TraceThreadBuffer*> m_threadBuffers;
+	uint32_t m_nextThreadId;
+
+	//GPU events are kept on their own track, in a separate process row of the trace
+	TraceThreadBuffer m_gpuBuffer;
+
+	//Protects the file and the writer state
+	std::mutex m_fileMutex;
+	std::ofstream m_file;
+	bool m_firstEvent;
+	//Threads whose track has already been named in the current capture
+	std::vector<uint32_t> m_namedThreads;
+	//Events that started before this time belong to a previous capture and are skipped
+	uint64_t m_captureStartNs;
+
+	std::thread m_writerThread;
+	std::condition_variable m_writerCondition;
+	bool m_stopWriter;
+};
+
+/*******************************************************
+* Records the time between its construction and its    *
+* destruction as a CPU region, if a capture is running  *
+*******************************************************/
+class TraceScope
+{
+public:
+	explicit TraceScope(const char* name)
+		:m_name(name), m_startNs{0}
+	{
+		if (TraceRecorder::Get().IsCapturing())
+		{
+			m_startNs = TraceRecorder::Now();
+		}
+	}
+
+	~TraceScope()
+	{
+		if (m_startNs)
+		{
+			TraceRecorder::Get().RecordCpuEvent(m_name, m_startNs, TraceRecorder::Now());
+		}
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+private:
+	const char* m_name;
+	uint64_t m_startNs;
+};
+
+//Defining ENGINE_TRACING_DISABLED removes every trace scope from the build
+#ifndef ENGINE_TRACING_DISABLED
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name)
+#endif
@@ -0,0 +1,463 @@
+#include "VulkanGpuProfiler.h"
+#include "TraceRecorder.h"
+#include "EngineCore/Memory/FrameArena.h"
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+//The statistics gathered for every scope, the order of the bits is the order the results are written in
+#define GPU_PROFILER_STATISTICS_FLAGS (VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |\
+	VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |\
+	VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT)
+#define GPU_PROFILER_STATISTICS_COUNT 5
+
+VulkanGpuProfilerHandle::VulkanGpuProfilerHandle()
+	:m_frames(), m_recordingFrame{0}, m_frameCounter{0}, m_openScopes(),
+	m_activeStatisticsScope{GPU_PROFILER_INVALID_INDEX}, m_timestampPeriod{1.0}, m_timestampMask{0},
+	m_timestampsSupported{false}, m_pipelineStatisticsSupported{false},
+	m_cmdBeginDebugLabel{nullptr}, m_cmdEndDebugLabel{nullptr}, m_getCalibratedTimestamps{nullptr},
+	m_hostTimeDomain{VK_TIME_DOMAIN_DEVICE_EXT}, m_hostTickNs{1.0}, m_calibrationTimestamp{0}, m_calibrationCpuNs{0},
+	m_latestFrame()
+{
+
+}
+
+/*************************************************************************************************
+* Function Argument 1: The instance handle is needed to load the debug utils label functions     *
+* Function Argument 2: The device handle is needed for query pool creation and to check if the   *
+*					   GPU supports timestamps and pipeline statistics							 *
+* Function Argument 3: The amount of frames that can be recorded before the first one completes, *
+*					   one set of query pools is created for each one							 *
+*************************************************************************************************/
+void VulkanGpuProfilerHandle::CreateGpuProfiler(const VulkanInstanceHandle& instance,
+	const VulkanDeviceHandle& device, uint32_t framesInFlight)
+{
+	/* Checking what the GPU supports */
+	m_timestampsSupported = device.GetGraphicsQueueTimestampValidBits() > 0;
+	m_pipelineStatisticsSupported = device.GetEnabledDeviceFeatures().pipelineStatisticsQuery == VK_TRUE;
+	m_timestampPeriod = static_cast<double>(device.GetPhysicalDeviceProperties().limits.timestampPeriod);
+	//Bits above the valid bits of the queue are undefined, so they are masked out of every timestamp
+	uint32_t validBits = device.GetGraphicsQueueTimestampValidBits();
+	m_timestampMask = validBits >= 64 ? ~0ULL : ((1ULL << validBits) - 1);
+	/* GPU support checked */
+
+	//Debug labels are not needed for timing, they only make the scopes visible in tools like RenderDoc
+	if (instance.IsExtensionEnabled(VK_EXT_DEBUG_UTILS_EXTENSION_NAME))
+	{
+		m_cmdBeginDebugLabel = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(
+			vkGetInstanceProcAddr(instance.GetVulkanSDKInstance(), "vkCmdBeginDebugUtilsLabelEXT"));
+		m_cmdEndDebugLabel = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(
+			vkGetInstanceProcAddr(instance.GetVulkanSDKInstance(), "vkCmdEndDebugUtilsLabelEXT"));
+	}
+
+	SetupCalibratedTimestamps(instance, device);
+
+	m_frames.resize(framesInFlight);
+	for (FrameQueries& frame : m_frames)
+	{
+		CreateFrameQueryPools(device.GetVulkanSDKLogicalDevice(), frame);
+	}
+	m_openScopes.reserve(GPU_PROFILER_MAX_SCOPES);
+}
+
+void VulkanGpuProfilerHandle::CreateFrameQueryPools(const VkDevice& device, FrameQueries& frame)
+{
+	frame.scopes.reserve(GPU_PROFILER_MAX_SCOPES);
+
+	if (m_timestampsSupported)
+	{
+		/* Initializing create info struct for the timestamp query pool */
+		VkQueryPoolCreateInfo timestampPoolInfo{};
+		timestampPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		timestampPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		//Every scope writes a begin and an end timestamp
+		timestampPoolInfo.queryCount = GPU_PROFILER_MAX_SCOPES * 2;
+		/* Create info struct complete */
+
+		VkResult timestampPoolResult = vkCreateQueryPool(device, &timestampPoolInfo, nullptr, &frame.vk_timestampPool);
+		if (timestampPoolResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+
+	if (m_pipelineStatisticsSupported)
+	{
+		/* Initializing create info struct for the pipeline statistics query pool */
+		VkQueryPoolCreateInfo statisticsPoolInfo{};
+		statisticsPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		statisticsPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+		statisticsPoolInfo.queryCount = GPU_PROFILER_MAX_SCOPES;
+		statisticsPoolInfo.pipelineStatistics = GPU_PROFILER_STATISTICS_FLAGS;
+		/* Create info struct complete */
+
+		VkResult statisticsPoolResult = vkCreateQueryPool(device, &statisticsPoolInfo, nullptr, &frame.vk_statisticsPool);
+		if (statisticsPoolResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+}
+
+/***********************************************************************************************
+* Function Argument 1: The instance handle is needed to load the time domain query function	   *
+* Function Argument 2: The device handle is needed to check if the extension was enabled	   *
+***********************************************************************************************/
+void VulkanGpuProfilerHandle::SetupCalibratedTimestamps(const VulkanInstanceHandle& instance,
+	const VulkanDeviceHandle& device)
+{
+	if (!m_timestampsSupported || !device.IsExtensionEnabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+	{
+		return;
+	}
+
+	//The CPU side of the calibration must use the same clock as std::chrono::steady_clock
+#ifdef _WIN32
+	VkTimeDomainEXT hostTimeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_hostTickNs = 1000000000.0 / static_cast<double>(frequency.QuadPart);
+#else
+	VkTimeDomainEXT hostTimeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+	m_hostTickNs = 1.0;
+#endif
+
+	/* Checking if the GPU can calibrate against the CPU's clock */
+	PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT getTimeDomains = 
+		reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(vkGetInstanceProcAddr(
+			instance.GetVulkanSDKInstance(), "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+	if (!getTimeDomains)
+	{
+		return;
+	}
+	uint32_t timeDomainCount = 0;
+	getTimeDomains(device.GetVulkanSDKPhysicalDevice(), &timeDomainCount, nullptr);
+	std::vector<VkTimeDomainEXT> timeDomains(timeDomainCount);
+	getTimeDomains(device.GetVulkanSDKPhysicalDevice(), &timeDomainCount, timeDomains.data());
+
+	bool deviceDomainFound = false;
+	bool hostDomainFound = false;
+	for (VkTimeDomainEXT timeDomain : timeDomains)
+	{
+		deviceDomainFound |= timeDomain == VK_TIME_DOMAIN_DEVICE_EXT;
+		hostDomainFound |= timeDomain == hostTimeDomain;
+	}
+	if (!deviceDomainFound || !hostDomainFound)
+	{
+		return;
+	}
+	/* Time domains checked */
+
+	m_hostTimeDomain = hostTimeDomain;
+	m_getCalibratedTimestamps = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(
+		vkGetDeviceProcAddr(device.GetVulkanSDKLogicalDevice(), "vkGetCalibratedTimestampsEXT"));
+}
+
+/**********************************************************************************************
+* Function Argument 1: The Vulkan SDK device is needed to read the calibrated timestamps	  *
+* Function Argument 2: The last timestamp written by the frame that is being resolved		  *
+**********************************************************************************************/
+void VulkanGpuProfilerHandle::CalibrateClocks(const VkDevice& device, uint64_t lastFrameTimestamp)
+{
+	if (m_getCalibratedTimestamps)
+	{
+		VkCalibratedTimestampInfoEXT timestampInfos[2]{};
+		timestampInfos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		timestampInfos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+		timestampInfos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		timestampInfos[1].timeDomain = m_hostTimeDomain;
+
+		uint64_t timestamps[2];
+		uint64_t maxDeviation;
+		if (m_getCalibratedTimestamps(device, 2, timestampInfos, timestamps, &maxDeviation) == VK_SUCCESS)
+		{
+			m_calibrationTimestamp = timestamps[0] & m_timestampMask;
+			m_calibrationCpuNs = static_cast<uint64_t>(static_cast<double>(timestamps[1]) * m_hostTickNs);
+			return;
+		}
+	}
+
+	//Without calibrated timestamps, the end of the frame is assumed to be now, since its fence has just signalled.
+	//This places GPU work slightly late if the CPU reached the fence after the GPU was already done
+	m_calibrationTimestamp = lastFrameTimestamp;
+	m_calibrationCpuNs = TraceRecorder::Now();
+}
+
+uint64_t VulkanGpuProfilerHandle::ConvertToCpuClock(uint64_t timestamp) const
+{
+	double deltaNs = (static_cast<double>(timestamp) - static_cast<double>(m_calibrationTimestamp)) * m_timestampPeriod;
+	return static_cast<uint64_t>(static_cast<double>(m_calibrationCpuNs) + deltaNs);
+}
+
+/****************************************************************************************
+* Function Argument 1: The Vulkan SDK device is needed to read the query pool results   *
+* Function Argument 2: The frame in flight whose fence has just signalled				*
+****************************************************************************************/
+void VulkanGpuProfilerHandle::ResolveFrame(const VkDevice& device, uint32_t frameIndex)
+{
+	FrameQueries& frame = m_frames[frameIndex];
+	if (!frame.pendingResults)
+	{
+		return;
+	}
+	frame.pendingResults = false;
+
+	uint32_t scopeCount = static_cast<uint32_t>(frame.scopes.size());
+
+	/* Reading back the query results */
+	//The frame's fence has signalled, so all queries are available and no wait flag is needed
+	FrameVector<uint64_t> timestamps(scopeCount * 2, 0);
+	if (m_timestampsSupported && scopeCount)
+	{
+		VkResult timestampResult = vkGetQueryPoolResults(device, frame.vk_timestampPool, 0, scopeCount * 2,
+			timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		//Results that are not ready are simply skipped, this should never happen after the fence has signalled
+		if (timestampResult != VK_SUCCESS)
+		{
+			return;
+		}
+	}
+
+	FrameVector<uint64_t> statistics(frame.statisticsQueryCount * GPU_PROFILER_STATISTICS_COUNT, 0);
+	if (frame.statisticsQueryCount)
+	{
+		VkResult statisticsResult = vkGetQueryPoolResults(device, frame.vk_statisticsPool, 0, frame.statisticsQueryCount,
+			statistics.size() * sizeof(uint64_t), statistics.data(), GPU_PROFILER_STATISTICS_COUNT * sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT);
+		if (statisticsResult != VK_SUCCESS)
+		{
+			return;
+		}
+	}
+	/* Query results read */
+
+	if (m_timestampsSupported && scopeCount)
+	{
+		uint64_t lastFrameTimestamp = 0;
+		for (uint32_t i = 0; i < scopeCount; ++i)
+		{
+			lastFrameTimestamp = (std::max)(lastFrameTimestamp, timestamps[i * 2 + 1] & m_timestampMask);
+		}
+		CalibrateClocks(device, lastFrameTimestamp);
+	}
+	bool capturing = TraceRecorder::Get().IsCapturing();
+
+	/* Building the scope tree */
+	m_latestFrame.frameNumber = frame.frameNumber;
+	m_latestFrame.scopes.resize(scopeCount);
+	m_latestFrame.roots.clear();
+	for (uint32_t i = 0; i < scopeCount; ++i)
+	{
+		const ScopeRecord& record = frame.scopes[i];
+		GpuProfileScopeResult& result = m_latestFrame.scopes[i];
+		result.name = record.name;
+		result.parent = record.parent;
+		result.depth = record.depth;
+		result.children.clear();
+
+		uint64_t begin = timestamps[i * 2] & m_timestampMask;
+		uint64_t end = timestamps[i * 2 + 1] & m_timestampMask;
+		result.gpuTimeMs = end > begin ? static_cast<double>(end - begin) * m_timestampPeriod / 1000000.0 : 0.0;
+		if (m_timestampsSupported)
+		{
+			result.cpuClockBeginNs = ConvertToCpuClock(begin);
+			result.cpuClockEndNs = ConvertToCpuClock(end);
+			if (capturing)
+			{
+				TraceRecorder::Get().RecordGpuEvent(record.name, result.cpuClockBeginNs, result.cpuClockEndNs);
+			}
+		}
+
+		result.hasPipelineStatistics = record.statisticsQuery != GPU_PROFILER_INVALID_INDEX;
+		if (result.hasPipelineStatistics)
+		{
+			const uint64_t* values = &statistics[record.statisticsQuery * GPU_PROFILER_STATISTICS_COUNT];
+			result.statistics.inputAssemblyVertices = values[0];
+			result.statistics.vertexShaderInvocations = values[1];
+			result.statistics.clippingInvocations = values[2];
+			result.statistics.clippingPrimitives = values[3];
+			result.statistics.fragmentShaderInvocations = values[4];
+		}
+
+		//Parents are always recorded before their children, so the parent's node already exists
+		if (record.parent == GPU_PROFILER_INVALID_INDEX)
+		{
+			m_latestFrame.roots.push_back(i);
+		}
+		else
+		{
+			m_latestFrame.scopes[record.parent].children.push_back(i);
+		}
+	}
+	m_latestFrame.valid = true;
+	/* Scope tree complete */
+}
+
+/**********************************************************************************************
+* Function Argument 1: The command buffer of the frame, which must be in the recording state  *
+* Function Argument 2: The frame in flight that is being recorded							  *
+**********************************************************************************************/
+void VulkanGpuProfilerHandle::BeginFrame(const VkCommandBuffer& commandBuffer, uint32_t frameIndex)
+{
+	m_recordingFrame = frameIndex;
+	FrameQueries& frame = m_frames[frameIndex];
+	frame.scopes.clear();
+	frame.statisticsQueryCount = 0;
+	frame.frameNumber = m_frameCounter++;
+	m_openScopes.clear();
+	m_activeStatisticsScope = GPU_PROFILER_INVALID_INDEX;
+
+	//Queries have to be reset before they are written again
+	if (m_timestampsSupported)
+	{
+		vkCmdResetQueryPool(commandBuffer, frame.vk_timestampPool, 0, GPU_PROFILER_MAX_SCOPES * 2);
+	}
+	if (m_pipelineStatisticsSupported)
+	{
+		vkCmdResetQueryPool(commandBuffer, frame.vk_statisticsPool, 0, GPU_PROFILER_MAX_SCOPES);
+	}
+}
+
+void VulkanGpuProfilerHandle::EndFrame()
+{
+	//Every scope must have been closed before the frame ends
+	if (!m_openScopes.empty())
+	{
+		__debugbreak();
+	}
+
+	m_frames[m_recordingFrame].pendingResults = true;
+}
+
+/**********************************************************************************************
+* Function Argument 1: The command buffer that the scope's commands are recorded in			  *
+* Function Argument 2: The name of the scope, must stay valid until the frame is resolved	  *
+* Function Argument 3: True if pipeline statistics should be gathered for the scope. Ignored  *
+*					   if not supported or if an enclosing scope already gathers them		  *
+**********************************************************************************************/
+void VulkanGpuProfilerHandle::BeginScope(const VkCommandBuffer& commandBuffer, const char* name,
+	bool pipelineStatistics)
+{
+	FrameQueries& frame = m_frames[m_recordingFrame];
+	//Running out of scopes means GPU_PROFILER_MAX_SCOPES needs to be increased
+	if (frame.scopes.size() >= GPU_PROFILER_MAX_SCOPES)
+	{
+		__debugbreak();
+	}
+
+	/* Recording the scope */
+	uint32_t scopeIndex = static_cast<uint32_t>(frame.scopes.size());
+	ScopeRecord record{};
+	record.name = name;
+	record.parent = m_openScopes.empty() ? GPU_PROFILER_INVALID_INDEX : m_openScopes.back();
+	record.depth = static_cast<uint32_t>(m_openScopes.size());
+	record.statisticsQuery = GPU_PROFILER_INVALID_INDEX;
+	//Only one pipeline statistics query can be active at a time, so nested scopes inherit the enclosing one
+	if (pipelineStatistics && m_pipelineStatisticsSupported && m_activeStatisticsScope == GPU_PROFILER_INVALID_INDEX)
+	{
+		record.statisticsQuery = frame.statisticsQueryCount++;
+		m_activeStatisticsScope = scopeIndex;
+	}
+	frame.scopes.push_back(record);
+	m_openScopes.push_back(scopeIndex);
+	/* Scope recorded */
+
+	if (m_cmdBeginDebugLabel)
+	{
+		VkDebugUtilsLabelEXT label{};
+		label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+		label.pLabelName = name;
+		m_cmdBeginDebugLabel(commandBuffer, &label);
+	}
+
+	//The begin timestamp is written as soon as all previous commands have started
+	if (m_timestampsSupported)
+	{
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.vk_timestampPool, scopeIndex * 2);
+	}
+
+	if (record.statisticsQuery != GPU_PROFILER_INVALID_INDEX)
+	{
+		vkCmdBeginQuery(commandBuffer, frame.vk_statisticsPool, record.statisticsQuery, 0);
+	}
+}
+
+/*****************************************************************************************************
+* Function Argument 1: The command buffer that the scope's commands are recorded in, the scope must  *
+*					   end in the same render pass instance (or outside of a render pass) it began in *
+*****************************************************************************************************/
+void VulkanGpuProfilerHandle::EndScope(const VkCommandBuffer& commandBuffer)
+{
+	FrameQueries& frame = m_frames[m_recordingFrame];
+	uint32_t scopeIndex = m_openScopes.back();
+	m_openScopes.pop_back();
+	const ScopeRecord& record = frame.scopes[scopeIndex];
+
+	if (record.statisticsQuery != GPU_PROFILER_INVALID_INDEX)
+	{
+		vkCmdEndQuery(commandBuffer, frame.vk_statisticsPool, record.statisticsQuery);
+		m_activeStatisticsScope = GPU_PROFILER_INVALID_INDEX;
+	}
+
+	//The end timestamp is written once all previous commands have completed
+	if (m_timestampsSupported)
+	{
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.vk_timestampPool, scopeIndex * 2 + 1);
+	}
+
+	if (m_cmdEndDebugLabel)
+	{
+		m_cmdEndDebugLabel(commandBuffer);
+	}
+}
+
+void VulkanGpuProfilerHandle::LogFrame(std::ostream& stream) const
+{
+	if (!m_latestFrame.valid)
+	{
+		return;
+	}
+
+	stream << "GPU frame " << m_latestFrame.frameNumber << '\n';
+	for (uint32_t root : m_latestFrame.roots)
+	{
+		LogScope(stream, root);
+	}
+}
+
+void VulkanGpuProfilerHandle::LogScope(std::ostream& stream, uint32_t scopeIndex) const
+{
+	const GpuProfileScopeResult& scope = m_latestFrame.scopes[scopeIndex];
+
+	stream << std::string((scope.depth + 1) * 2, ' ') << scope.name << " : " << scope.gpuTimeMs << " ms";
+	if (scope.hasPipelineStatistics)
+	{
+		stream << " (vertices " << scope.statistics.inputAssemblyVertices
+			<< ", vertex invocations " << scope.statistics.vertexShaderInvocations
+			<< ", clipping invocations " << scope.statistics.clippingInvocations
+			<< ", clipping primitives " << scope.statistics.clippingPrimitives
+			<< ", fragment invocations " << scope.statistics.fragmentShaderInvocations << ')';
+	}
+	stream << '\n';
+
+	for (uint32_t child : scope.children)
+	{
+		LogScope(stream, child);
+	}
+}
+
+void VulkanGpuProfilerHandle::Cleanup(const VkDevice& device)
+{
+	for (const FrameQueries& frame : m_frames)
+	{
+		if (frame.vk_timestampPool != VK_NULL_HANDLE)
+		{
+			vkDestroyQueryPool(device, frame.vk_timestampPool, nullptr);
+		}
+		if (frame.vk_statisticsPool != VK_NULL_HANDLE)
+		{
+			vkDestroyQueryPool(device, frame.vk_statisticsPool, nullptr);
+		}
+	}
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include "EngineCore/VulkanHandles/VulkanDevice.h"
+
+//Maximum amount of scopes that can be recorded in a single frame
+#define GPU_PROFILER_MAX_SCOPES 128
+
+//Used for scope and query indices that do not point to anything (e.g. the parent of a root scope)
+#define GPU_PROFILER_INVALID_INDEX 0xFFFFFFFF
+
+//Holds the pipeline statistics gathered for a single scope
+struct GpuPipelineStatistics
+{
+	uint64_t inputAssemblyVertices = 0;
+	uint64_t vertexShaderInvocations = 0;
+	uint64_t clippingInvocations = 0;
+	uint64_t clippingPrimitives = 0;
+	uint64_t fragmentShaderInvocations = 0;
+};
+
+//Holds the results of a single scope, as a node of the frame's scope tree
+struct GpuProfileScopeResult
+{
+	std::string name;
+
+	//Index of the enclosing scope in the frame's scope array, or GPU_PROFILER_INVALID_INDEX for root scopes
+	uint32_t parent = GPU_PROFILER_INVALID_INDEX;
+	//Indices of the scopes directly nested inside this one, in recording order
+	std::vector<uint32_t> children;
+	uint32_t depth = 0;
+
+	//Time between the scope's begin and end timestamps, 0 if the queue does not support timestamps
+	double gpuTimeMs = 0.0;
+
+	//The scope's begin and end timestamps converted to the CPU's clock (TraceRecorder::Now), in nanoseconds
+	uint64_t cpuClockBeginNs = 0;
+	uint64_t cpuClockEndNs = 0;
+
+	//Only valid if hasPipelineStatistics is true
+	bool hasPipelineStatistics = false;
+	GpuPipelineStatistics statistics;
+};
+
+//Holds the scope tree of one completed frame
+struct GpuProfileFrame
+{
+	//Number of the frame these results belong to (counted from the start of the application)
+	uint64_t frameNumber = 0;
+
+	//Holds every scope recorded in the frame, parents are always stored before their children
+	std::vector<GpuProfileScopeResult> scopes;
+
+	//Indices of the scopes that have no parent
+	std::vector<uint32_t> roots;
+
+	bool valid = false;
+};
+
+/*******************************************************************
+* Holds the query pools used to time command buffer regions on     *
+* the GPU. There is one set of pools per frame in flight, so       *
+* results are only read after that frame's fence has signalled,    *
+* which means that reading them back never stalls the CPU          *
+*******************************************************************/
+class VulkanGpuProfilerHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanGpuProfilerHandle();
+
+	//Creates a timestamp query pool and, if supported, a pipeline statistics query pool for every frame in flight
+	void CreateGpuProfiler(const VulkanInstanceHandle& instance, const VulkanDeviceHandle& device,
+		uint32_t framesInFlight);
+
+	void Cleanup(const VkDevice& device);
+
+	//Reads back the results of the last frame recorded in frameIndex. Must be called after that frame's fence has signalled
+	void ResolveFrame(const VkDevice& device, uint32_t frameIndex);
+
+	//Resets the queries of frameIndex. Must be called at the start of the command buffer, outside of a render pass
+	void BeginFrame(const VkCommandBuffer& commandBuffer, uint32_t frameIndex);
+
+	//Should be called after the last scope of a frame has ended, before the command buffer ends
+	void EndFrame();
+
+	//Writes the begin timestamp of a scope, nested in the scope that is currently open (if any)
+	void BeginScope(const VkCommandBuffer& commandBuffer, const char* name, bool pipelineStatistics);
+
+	//Writes the end timestamp of the scope that was opened last
+	void EndScope(const VkCommandBuffer& commandBuffer);
+
+	//Prints the scope tree of the latest resolved frame
+	void LogFrame(std::ostream& stream) const;
+
+	/* Member variable getters */
+	inline const GpuProfileFrame& GetLatestFrame() const { return m_latestFrame; }
+
+	inline bool ArePipelineStatisticsSupported() const { return m_pipelineStatisticsSupported; }
+	/* End member variable getters */
+private:
+	//Holds the information about a scope that is needed until its results are read back
+	struct ScopeRecord
+	{
+		const char* name;
+		uint32_t parent;
+		uint32_t depth;
+		//Index of the scope's pipeline statistics query, or GPU_PROFILER_INVALID_INDEX if it has none
+		uint32_t statisticsQuery;
+	};
+
+	//Holds the query pools and the recorded scopes of a single frame in flight
+	struct FrameQueries
+	{
+		VkQueryPool vk_timestampPool = VK_NULL_HANDLE;
+		VkQueryPool vk_statisticsPool = VK_NULL_HANDLE;
+
+		std::vector<ScopeRecord> scopes;
+		uint32_t statisticsQueryCount = 0;
+
+		uint64_t frameNumber = 0;
+		//True if queries were written for this frame in flight and their results have not been read yet
+		bool pendingResults = false;
+	};
+
+	//Called by CreateGpuProfiler to create the query pools of a single frame in flight
+	void CreateFrameQueryPools(const VkDevice& device, FrameQueries& frame);
+
+	//Called by LogFrame for every scope, to print it and then its children
+	void LogScope(std::ostream& stream, uint32_t scopeIndex) const;
+
+	//Called by CreateGpuProfiler to load VK_EXT_calibrated_timestamps, if it was enabled and the CPU clock is supported
+	void SetupCalibratedTimestamps(const VulkanInstanceHandle& instance, const VulkanDeviceHandle& device);
+
+	//Called by ResolveFrame to find a GPU timestamp and CPU time pair that refer to the same moment
+	void CalibrateClocks(const VkDevice& device, uint64_t lastFrameTimestamp);
+
+	//Converts a GPU timestamp to the CPU's clock, using the latest calibration
+	uint64_t ConvertToCpuClock(uint64_t timestamp) const;
+private:
+	//Holds the query pools and scopes of every frame in flight
+	std::vector<FrameQueries> m_frames;
+
+	//Index of the frame in flight that is currently being recorded
+	uint32_t m_recordingFrame;
+
+	//Counts every frame recorded since the profiler was created
+	uint64_t m_frameCounter;
+
+	//Indices of the scopes that are currently open in the recording frame, innermost scope last
+	std::vector<uint32_t> m_openScopes;
+
+	//Index of the scope that currently has an active pipeline statistics query, statistics queries cannot be nested
+	uint32_t m_activeStatisticsScope;
+
+	//Nanoseconds per timestamp tick, taken from the device limits
+	double m_timestampPeriod;
+
+	//Mask applied to timestamps, based on the valid bits of the graphics queue
+	uint64_t m_timestampMask;
+
+	bool m_timestampsSupported;
+	bool m_pipelineStatisticsSupported;
+
+	//Loaded from VK_EXT_debug_utils, so that scopes also show up as labels in external tools. Null if not available
+	PFN_vkCmdBeginDebugUtilsLabelEXT m_cmdBeginDebugLabel;
+	PFN_vkCmdEndDebugUtilsLabelEXT m_cmdEndDebugLabel;
+
+	//Loaded from VK_EXT_calibrated_timestamps, null if not available
+	PFN_vkGetCalibratedTimestampsEXT m_getCalibratedTimestamps;
+
+	//The time domain of the CPU's clock (performance counter or monotonic clock) and its length of a tick
+	VkTimeDomainEXT m_hostTimeDomain;
+	double m_hostTickNs;
+
+	//The latest GPU timestamp and CPU time (in nanoseconds) that refer to the same moment
+	uint64_t m_calibrationTimestamp;
+	uint64_t m_calibrationCpuNs;
+
+	//Results of the latest frame that was read back
+	GpuProfileFrame m_latestFrame;
+};
+
+/**************************************************************
+* Opens a profiler scope when constructed and closes it when  *
+* it goes out of scope, so that scopes always nest correctly  *
+**************************************************************/
+class GpuProfileScope
+{
+public:
+	GpuProfileScope(VulkanGpuProfilerHandle& profiler, const VkCommandBuffer& commandBuffer,
+		const char* name, bool pipelineStatistics = false)
+		:m_profiler(profiler), vk_commandBuffer(commandBuffer)
+	{
+		m_profiler.BeginScope(vk_commandBuffer, name, pipelineStatistics);
+	}
+
+	~GpuProfileScope()
+	{
+		m_profiler.EndScope(vk_commandBuffer);
+	}
+
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+private:
+	VulkanGpuProfilerHandle& m_profiler;
+
+	VkCommandBuffer vk_commandBuffer;
+};
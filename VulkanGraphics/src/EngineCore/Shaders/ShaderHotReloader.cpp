@@ -0,0 +1,399 @@
+#include "ShaderHotReloader.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "EngineCore/Profiling/TraceRecorder.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+ShaderHotReloader::ShaderHotReloader()
+	:m_thread(), m_mutex(), m_stopCondition(), m_stopRequested{false}, m_commands(), m_compiler(), m_watchedFiles(),
+	m_inotify{-1}, m_stopEvent{-1}, m_watchedDirectories(), m_shaderDirectory(),
+	vk_device{VK_NULL_HANDLE}, vk_pipelineCache{VK_NULL_HANDLE}, m_pipelines{nullptr}
+{
+
+}
+#else
+ShaderHotReloader::ShaderHotReloader()
+	:m_thread(), m_mutex(), m_stopCondition(), m_stopRequested{false}, m_commands(), m_compiler(), m_watchedFiles(), m_shaderDirectory(),
+	vk_device{VK_NULL_HANDLE}, vk_pipelineCache{VK_NULL_HANDLE}, m_pipelines{nullptr}
+{
+
+}
+#endif
+
+/************************************************************************************
+* Function Argument 1: The device the rebuilt pipelines are created with			*
+* Function Argument 2: The cache they are compiled through, which guards itself	    *
+* Function Argument 3: Holds the pipelines and swaps the rebuilt ones in			*
+* Function Argument 4: The directory of the sources, the shader list and the		    *
+*					   SPIR-V the pipelines read									*
+************************************************************************************/
+bool ShaderHotReloader::Start(const VkDevice& device, const VkPipelineCache& pipelineCache,
+	VulkanGraphicsPipelineHandle& pipelines, const std::string& shaderDirectory)
+{
+	m_shaderDirectory = shaderDirectory;
+	if (!ReadShaderList(GetShaderPath(SHADER_COMPILE_LIST)))
+	{
+		return false;
+	}
+	m_compiler = FindCompiler();
+
+	vk_device = device;
+	vk_pipelineCache = pipelineCache;
+	m_pipelines = &pipelines;
+	m_stopRequested = false;
+
+#ifdef __linux__
+	//Without both the thread polls
+	m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	m_stopEvent = m_inotify < 0 ? -1 : eventfd(0, EFD_CLOEXEC);
+	if (m_inotify >= 0 && m_stopEvent < 0)
+	{
+		close(m_inotify);
+		m_inotify = -1;
+	}
+#endif
+
+	//The current write times are the baseline, so nothing is compiled until a file is saved
+	std::set<std::string> changedFiles;
+	FindChangedFiles(changedFiles);
+
+	m_thread = std::thread(&ShaderHotReloader::WatchLoop, this);
+	return true;
+}
+
+void ShaderHotReloader::Stop()
+{
+	if (!m_thread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopRequested = true;
+	}
+	m_stopCondition.notify_one();
+#ifdef __linux__
+	if (m_stopEvent >= 0)
+	{
+		uint64_t wake = 1;
+		ssize_t written = write(m_stopEvent, &wake, sizeof(wake));
+		static_cast<void>(written);
+	}
+#endif
+	m_thread.join();
+
+#ifdef __linux__
+	if (m_inotify >= 0)
+	{
+		close(m_inotify);
+		close(m_stopEvent);
+	}
+	m_inotify = -1;
+	m_stopEvent = -1;
+	m_watchedDirectories.clear();
+#endif
+}
+
+void ShaderHotReloader::WatchLoop()
+{
+	TraceRecorder::Get().SetThreadName("Shader hot reload");
+	while (WaitForChanges())
+	{
+		std::set<std::string> changedFiles;
+		FindChangedFiles(changedFiles);
+		if (changedFiles.empty())
+		{
+			continue;
+		}
+
+		/* Compiling the shaders using the changed files */
+		TRACE_SCOPE("ShaderHotReload");
+		auto reloadStart = std::chrono::steady_clock::now();
+		std::vector<std::string> compiledFiles;
+		for (const ShaderCompileCommand& command : m_commands)
+		{
+			std::set<std::string> sourceFiles;
+			sourceFiles.insert(command.sourceFile);
+			FindIncludes(command.sourceFile, sourceFiles);
+
+			bool changed = false;
+			for (const std::string& sourceFile : sourceFiles)
+			{
+				changed = changed || changedFiles.count(sourceFile) != 0;
+			}
+			//A shader that fails to compile keeps its last SPIR-V, and its pipelines stay as they are
+			if (changed && Compile(command))
+			{
+				compiledFiles.push_back(GetShaderPath(command.outputFile));
+			}
+		}
+		/* Shaders compiled */
+
+		if (compiledFiles.empty())
+		{
+			continue;
+		}
+		uint32_t rebuiltCount = m_pipelines->RebuildPipelines(vk_device, vk_pipelineCache, compiledFiles);
+		double reloadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reloadStart).count();
+		std::cout << "Shader hot reload: compiled " << compiledFiles.size() << " shaders and rebuilt " << rebuiltCount
+			<< " pipelines in " << reloadMs << " ms\n";
+	}
+}
+
+bool ShaderHotReloader::WaitForChanges()
+{
+#ifdef __linux__
+	if (m_inotify >= 0)
+	{
+		pollfd descriptors[2] = { { m_inotify, POLLIN, 0 }, { m_stopEvent, POLLIN, 0 } };
+		if (poll(descriptors, 2, -1) >= 0)
+		{
+			if (descriptors[1].revents != 0)
+			{
+				return false;
+			}
+
+			//The events only wake the thread, FindChangedFiles tells which sources were written. Those of the SPIR-V
+			//written by the compiler wake it as well and find nothing
+			char events[4096];
+			while (read(m_inotify, events, sizeof(events)) > 0)
+			{
+			}
+			return true;
+		}
+		//Interrupted, waits like the other systems this once
+	}
+#endif
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_stopCondition.wait_for(lock, std::chrono::milliseconds(SHADER_HOT_RELOAD_POLL_MS),
+		[this]() { return m_stopRequested; });
+	return !m_stopRequested;
+}
+
+bool ShaderHotReloader::ReadShaderList(const std::string& filename)
+{
+	std::ifstream list(filename);
+	if (!list.is_open())
+	{
+		return false;
+	}
+
+	//Every shader's line reads: [arguments] source -o output
+	std::string line;
+	while (std::getline(list, line))
+	{
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+
+		//A carriage return left by Windows line endings is whitespace, so it is dropped with the spaces
+		std::istringstream words(line);
+		std::vector<std::string> tokens;
+		std::string token;
+		while (words >> token)
+		{
+			tokens.push_back(token);
+		}
+
+		size_t outputFlag = 0;
+		while (outputFlag < tokens.size() && tokens[outputFlag] != "-o")
+		{
+			++outputFlag;
+		}
+		if (outputFlag < 1 || outputFlag + 1 >= tokens.size())
+		{
+			continue;
+		}
+
+		ShaderCompileCommand command;
+		command.arguments.assign(tokens.begin(), tokens.begin() + (outputFlag - 1));
+		command.sourceFile = tokens[outputFlag - 1];
+		command.outputFile = tokens[outputFlag + 1];
+		m_commands.push_back(command);
+	}
+	return !m_commands.empty();
+}
+
+std::string ShaderHotReloader::FindCompiler()
+{
+	/* Looking in the Vulkan SDK */
+#ifdef _WIN32
+	//getenv is deprecated by the MSVC runtime in favour of the copying version
+	char* sdkDirectory = nullptr;
+	size_t length = 0;
+	std::string sdk;
+	if (_dupenv_s(&sdkDirectory, &length, "VULKAN_SDK") == 0 && sdkDirectory != nullptr)
+	{
+		sdk = sdkDirectory;
+	}
+	std::free(sdkDirectory);
+	std::filesystem::path compiler = std::filesystem::path(sdk) / "Bin" / "glslc.exe";
+#else
+	const char* sdkDirectory = std::getenv("VULKAN_SDK");
+	std::string sdk = sdkDirectory != nullptr ? sdkDirectory : "";
+	std::filesystem::path compiler = std::filesystem::path(sdk) / "bin" / "glslc";
+#endif
+	std::error_code error;
+	if (!sdk.empty() && std::filesystem::exists(compiler, error))
+	{
+		return compiler.string();
+	}
+	/* Vulkan SDK checked */
+
+	//The shell the commands run in finds it on the PATH
+	return "glslc";
+}
+
+void ShaderHotReloader::FindIncludes(const std::string& sourceFile, std::set<std::string>& includes) const
+{
+	auto watchedFile = m_watchedFiles.find(sourceFile);
+	if (watchedFile == m_watchedFiles.end())
+	{
+		return;
+	}
+
+	for (const std::string& include : watchedFile->second.includes)
+	{
+		//Inserted before recursing, so files including each other do not recurse forever
+		if (includes.insert(include).second)
+		{
+			FindIncludes(include, includes);
+		}
+	}
+}
+
+std::vector<std::string> ShaderHotReloader::ReadIncludes(const std::string& sourceFile) const
+{
+	std::vector<std::string> includes;
+	std::ifstream source(GetShaderPath(sourceFile));
+	std::string line;
+	while (std::getline(source, line))
+	{
+		//Only the quoted includes of the shader directory, as used with the Google include directive
+		size_t directive = line.find("#include");
+		size_t open = line.find('"', directive);
+		size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+		if (directive == std::string::npos || close == std::string::npos)
+		{
+			continue;
+		}
+
+		includes.push_back(line.substr(open + 1, close - open - 1));
+	}
+	return includes;
+}
+
+void ShaderHotReloader::FindChangedFiles(std::set<std::string>& changedFiles)
+{
+	//Walks the include graph from every source, so an include added by a written file is watched from then on
+	std::vector<std::string> pendingFiles;
+	for (const ShaderCompileCommand& command : m_commands)
+	{
+		pendingFiles.push_back(command.sourceFile);
+	}
+
+	std::set<std::string> checkedFiles;
+	while (!pendingFiles.empty())
+	{
+		std::string filename = pendingFiles.back();
+		pendingFiles.pop_back();
+		if (!checkedFiles.insert(filename).second)
+		{
+			continue;
+		}
+
+		//A file being saved can briefly be missing, it is checked again next time with its old includes
+		std::error_code error;
+		std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(GetShaderPath(filename), error);
+		auto watchedFile = m_watchedFiles.find(filename);
+		if (!error && watchedFile == m_watchedFiles.end())
+		{
+			watchedFile = m_watchedFiles.emplace(filename, WatchedFile{ writeTime, ReadIncludes(filename) }).first;
+#ifdef __linux__
+			WatchDirectory(filename);
+#endif
+		}
+		else if (!error && watchedFile->second.writeTime != writeTime)
+		{
+			changedFiles.insert(filename);
+			watchedFile->second = WatchedFile{ writeTime, ReadIncludes(filename) };
+		}
+
+		if (watchedFile != m_watchedFiles.end())
+		{
+			const std::vector<std::string>& includes = watchedFile->second.includes;
+			pendingFiles.insert(pendingFiles.end(), includes.begin(), includes.end());
+		}
+	}
+}
+
+bool ShaderHotReloader::Compile(const ShaderCompileCommand& command) const
+{
+	//Run from the shader directory like the scripts, so the includes and outputs resolve the same way. Windows' cd
+	//only changes drive with /d
+#ifdef _WIN32
+	std::string commandLine = "cd /d " + Quote(m_shaderDirectory) + " && " + Quote(m_compiler);
+#else
+	std::string commandLine = "cd " + Quote(m_shaderDirectory) + " && " + Quote(m_compiler);
+#endif
+	for (const std::string& argument : command.arguments)
+	{
+		commandLine += ' ' + Quote(argument);
+	}
+	commandLine += ' ' + Quote(command.sourceFile) + " -o " + Quote(command.outputFile);
+
+	int result = std::system(commandLine.c_str());
+	if (result != 0)
+	{
+		std::cout << "Shader hot reload: " << command.sourceFile << " failed to compile, keeping the previous version\n";
+		return false;
+	}
+	return true;
+}
+
+std::string ShaderHotReloader::Quote(const std::string& text)
+{
+#ifdef _WIN32
+	//cmd expands nothing between double quotes but variables, which the list and paths do not use
+	return '"' + text + '"';
+#else
+	//Nothing is expanded between single quotes, one inside is closed, escaped and opened again
+	std::string quoted = "'";
+	for (char character : text)
+	{
+		quoted += character == '\'' ? std::string("'\\''") : std::string(1, character);
+	}
+	return quoted + "'";
+#endif
+}
+
+std::string ShaderHotReloader::GetShaderPath(const std::string& filename) const
+{
+	return m_shaderDirectory + '/' + filename;
+}
+
+#ifdef __linux__
+void ShaderHotReloader::WatchDirectory(const std::string& filename)
+{
+	std::string directory = std::filesystem::path(GetShaderPath(filename)).parent_path().string();
+	if (m_inotify >= 0 && m_watchedDirectories.insert(directory).second)
+	{
+		//An editor saving through a temporary file renames it over the old one, others write it in place
+		inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	}
+}
+#endif
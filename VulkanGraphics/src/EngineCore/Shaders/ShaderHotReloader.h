@@ -0,0 +1,126 @@
+#pragma once
+
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "EngineCore/VulkanHandles/VulkanGraphicsPipeline.h"
+
+//How often the shader sources are checked for changes, in milliseconds. On Linux inotify wakes the thread when a file
+//of a watched directory is written instead
+#define SHADER_HOT_RELOAD_POLL_MS 250
+
+//The list in the shader directory with the glslc arguments of every shader, which the compile scripts read as well,
+//so a shader is compiled again the same way it was built
+#define SHADER_COMPILE_LIST "shaders.list"
+
+/*****************************************************************
+* Watches the GLSL sources of every shader on a thread of its	 *
+* own, and once one of them or a file it includes is saved,	 *
+* compiles it again with its line from the shader list		 *
+* and rebuilds the pipelines using it. The frame loop only swaps *
+* the finished pipelines in, so editing shaders never stalls it  *
+*****************************************************************/
+class ShaderHotReloader
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	ShaderHotReloader();
+
+	//Reads the shader list of the shader directory and starts watching the sources it compiles. Returns false
+	//without starting if the list could not be read
+	bool Start(const VkDevice& device, const VkPipelineCache& pipelineCache, VulkanGraphicsPipelineHandle& pipelines,
+		const std::string& shaderDirectory);
+
+	//Waits for a compile in progress to finish, then stops the thread
+	void Stop();
+
+	/* Member variable getters */
+	inline bool IsRunning() const { return m_thread.joinable(); }
+	/* End member variable getters */
+private:
+	//One line of the shader list
+	struct ShaderCompileCommand
+	{
+		//Everything before the source, such as the macros of a variant
+		std::vector<std::string> arguments;
+		std::string sourceFile;
+		std::string outputFile;
+	};
+
+	//A source or include, with what it included when it was last read
+	struct WatchedFile
+	{
+		std::filesystem::file_time_type writeTime;
+		std::vector<std::string> includes;
+	};
+
+	void WatchLoop();
+
+	//Blocks until a watched file may have been written, returns false once Stop was called
+	bool WaitForChanges();
+
+	//Called by Start to fill the compile commands, skipping the empty and comment lines
+	bool ReadShaderList(const std::string& filename);
+
+	//Returns the glslc of the Vulkan SDK the VULKAN_SDK environment variable points to, or glslc to be found on the
+	//PATH if there is none
+	static std::string FindCompiler();
+
+	//Adds every file the source includes to the set, including those included by its includes, as they were when the
+	//files were last read
+	void FindIncludes(const std::string& sourceFile, std::set<std::string>& includes) const;
+
+	//Returns the files the source includes directly
+	std::vector<std::string> ReadIncludes(const std::string& sourceFile) const;
+
+	//Adds every watched file written since the last check to the set, and remembers the new write times. Only the
+	//written files are read again for their includes
+	void FindChangedFiles(std::set<std::string>& changedFiles);
+
+	//Runs the compiler from the shader directory and prints its errors, returns false if it failed
+	bool Compile(const ShaderCompileCommand& command) const;
+
+	//Quotes a path or argument of the command line, so the shell neither splits nor expands it
+	static std::string Quote(const std::string& text);
+
+#ifdef __linux__
+	//Called by FindChangedFiles for every new file, so writes to its directory wake the thread
+	void WatchDirectory(const std::string& filename);
+#endif
+
+	//The path the pipelines read a file of the shader directory with
+	std::string GetShaderPath(const std::string& filename) const;
+private:
+	std::thread m_thread;
+
+	//Guards the stop request, which wakes the thread from its wait between checks
+	std::mutex m_mutex;
+	std::condition_variable m_stopCondition;
+	bool m_stopRequested;
+
+	std::vector<ShaderCompileCommand> m_commands;
+	std::string m_compiler;
+
+	//Every source and include seen, by their name in the shader directory
+	std::unordered_map<std::string, WatchedFile> m_watchedFiles;
+
+#ifdef __linux__
+	//The inotify instance and the directories it watches, and the event Stop writes to wake the thread. Polls like the
+	//other systems if inotify could not be set up
+	int m_inotify;
+	int m_stopEvent;
+	std::set<std::string> m_watchedDirectories;
+#endif
+
+	std::string m_shaderDirectory;
+
+	//Pipelines are rebuilt on the thread, with the device and cache the frames use
+	VkDevice vk_device;
+	VkPipelineCache vk_pipelineCache;
+	VulkanGraphicsPipelineHandle* m_pipelines;
+};
@@ -0,0 +1,133 @@
+#include "TextureFile.h"
+
+#include <cmath>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+//Converts an 8 bit sRGB value to linear, so that mips are averaged in linear space
+static float SrgbToLinear(uint8_t value)
+{
+	float normalized = static_cast<float>(value) / 255.0f;
+	return normalized <= 0.04045f ? normalized / 12.92f : std::pow((normalized + 0.055f) / 1.055f, 2.4f);
+}
+
+static uint8_t LinearToSrgb(float value)
+{
+	float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	float scaled = srgb * 255.0f + 0.5f;
+	return static_cast<uint8_t>(scaled < 0.0f ? 0.0f : (scaled > 255.0f ? 255.0f : scaled));
+}
+
+uint64_t GetTextureMipRangeSize(const TextureFileHeader& header, uint32_t firstMip, uint32_t endMip)
+{
+	uint64_t size = 0;
+	for (uint32_t mip = firstMip; mip < endMip; ++mip)
+	{
+		size += header.mipSizes[mip];
+	}
+	return size;
+}
+
+bool ReadTextureFileHeader(std::ifstream& file, TextureFileHeader& header)
+{
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof(TextureFileHeader));
+	if (!file || header.magic != TEXTURE_FILE_MAGIC || header.version != TEXTURE_FILE_VERSION)
+	{
+		return false;
+	}
+
+	return header.mipCount > 0 && header.mipCount <= TEXTURE_FILE_MAX_MIPS && header.width > 0 && header.height > 0;
+}
+
+/***********************************************************************************
+* Function Argument 1: The texture file, opened in binary mode					   *
+* Function Argument 2: The header read from the same file						   *
+* Function Argument 3: The first (finest) mip to read							   *
+* Function Argument 4: One past the last mip to read							   *
+* Function Argument 5: Where the mips are written, usually mapped staging memory   *
+***********************************************************************************/
+bool ReadTextureFileMips(std::ifstream& file, const TextureFileHeader& header, uint32_t firstMip, uint32_t endMip,
+	void* destination)
+{
+	//Mips are stored contiguously, so a range of them is read with a single call
+	file.seekg(static_cast<std::streamoff>(header.mipOffsets[firstMip]));
+	file.read(static_cast<char*>(destination), static_cast<std::streamsize>(GetTextureMipRangeSize(header, firstMip, endMip)));
+	return static_cast<bool>(file);
+}
+
+bool WriteTextureFile(const std::string& filename, uint32_t width, uint32_t height, const uint8_t* rgbaPixels)
+{
+	/* Building the mip chain */
+	std::vector<std::vector<uint8_t>> mips;
+	mips.emplace_back(rgbaPixels, rgbaPixels + static_cast<size_t>(width) * height * 4);
+	uint32_t mipWidth = width;
+	uint32_t mipHeight = height;
+	while ((mipWidth > 1 || mipHeight > 1) && mips.size() < TEXTURE_FILE_MAX_MIPS)
+	{
+		uint32_t nextWidth = GetTextureMipExtent(mipWidth, 1);
+		uint32_t nextHeight = GetTextureMipExtent(mipHeight, 1);
+		const std::vector<uint8_t>& source = mips.back();
+		std::vector<uint8_t> next(static_cast<size_t>(nextWidth) * nextHeight * 4);
+
+		for (uint32_t y = 0; y < nextHeight; ++y)
+		{
+			for (uint32_t x = 0; x < nextWidth; ++x)
+			{
+				//Odd sized mips clamp the second sample to the edge
+				uint32_t x0 = x * 2, x1 = (x * 2 + 1 < mipWidth) ? x * 2 + 1 : x * 2;
+				uint32_t y0 = y * 2, y1 = (y * 2 + 1 < mipHeight) ? y * 2 + 1 : y * 2;
+				for (uint32_t channel = 0; channel < 4; ++channel)
+				{
+					auto texel = [&](uint32_t sx, uint32_t sy) { return source[(static_cast<size_t>(sy) * mipWidth + sx) * 4 + channel]; };
+					uint8_t* output = &next[(static_cast<size_t>(y) * nextWidth + x) * 4 + channel];
+					//Alpha is stored linearly, only the colour channels are sRGB encoded
+					if (channel == 3)
+					{
+						*output = static_cast<uint8_t>((texel(x0, y0) + texel(x1, y0) + texel(x0, y1) + texel(x1, y1) + 2) / 4);
+					}
+					else
+					{
+						*output = LinearToSrgb((SrgbToLinear(texel(x0, y0)) + SrgbToLinear(texel(x1, y0)) +
+							SrgbToLinear(texel(x0, y1)) + SrgbToLinear(texel(x1, y1))) * 0.25f);
+					}
+				}
+			}
+		}
+
+		mips.push_back(std::move(next));
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+	}
+	/* Mip chain built */
+
+	/* Filling the header */
+	TextureFileHeader header{};
+	header.magic = TEXTURE_FILE_MAGIC;
+	header.version = TEXTURE_FILE_VERSION;
+	header.format = static_cast<uint32_t>(VK_FORMAT_R8G8B8A8_SRGB);
+	header.width = width;
+	header.height = height;
+	header.mipCount = static_cast<uint32_t>(mips.size());
+	uint64_t offset = sizeof(TextureFileHeader);
+	for (uint32_t mip = 0; mip < header.mipCount; ++mip)
+	{
+		header.mipOffsets[mip] = offset;
+		header.mipSizes[mip] = mips[mip].size();
+		offset += mips[mip].size();
+	}
+	/* Header filled */
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(TextureFileHeader));
+	for (const std::vector<uint8_t>& mip : mips)
+	{
+		file.write(reinterpret_cast<const char*>(mip.data()), static_cast<std::streamsize>(mip.size()));
+	}
+	return static_cast<bool>(file);
+}
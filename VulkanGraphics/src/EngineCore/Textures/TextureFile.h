@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+//"VTEX" read as a little endian integer, the first four bytes of every texture file
+#define TEXTURE_FILE_MAGIC 0x58455456
+#define TEXTURE_FILE_VERSION 1
+
+//A 32768x32768 texture has 16 mips, so every texture the GPU can sample fits in the header
+#define TEXTURE_FILE_MAX_MIPS 16
+
+/*****************************************************************
+* The header at the start of a texture file. The mips follow it, *
+* finest mip first, already in the layout vkCmdCopyBufferToImage *
+* expects, so loading a range of mips is a single read straight  *
+* into a staging buffer with no decoding on the CPU              *
+*****************************************************************/
+struct TextureFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+
+	//The VkFormat of the texels, each mip is tightly packed in this format
+	uint32_t format;
+
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+
+	//Offset of each mip from the start of the file, and its size in bytes
+	uint64_t mipOffsets[TEXTURE_FILE_MAX_MIPS];
+	uint64_t mipSizes[TEXTURE_FILE_MAX_MIPS];
+};
+
+//Returns the width or height of a mip, mips never get smaller than a single texel
+inline uint32_t GetTextureMipExtent(uint32_t extent, uint32_t mip)
+{
+	return (extent >> mip) > 0 ? (extent >> mip) : 1;
+}
+
+//Returns the size in bytes of the mips in [firstMip, endMip)
+uint64_t GetTextureMipRangeSize(const TextureFileHeader& header, uint32_t firstMip, uint32_t endMip);
+
+//Reads and validates the header, returns false if the file is not a texture file this version can read
+bool ReadTextureFileHeader(std::ifstream& file, TextureFileHeader& header);
+
+//Reads the mips in [firstMip, endMip) into destination, which must hold GetTextureMipRangeSize bytes
+bool ReadTextureFileMips(std::ifstream& file, const TextureFileHeader& header, uint32_t firstMip, uint32_t endMip,
+	void* destination);
+
+//Builds the full mip chain of an sRGB RGBA8 image with a box filter and writes it as a texture file
+bool WriteTextureFile(const std::string& filename, uint32_t width, uint32_t height, const uint8_t* rgbaPixels);
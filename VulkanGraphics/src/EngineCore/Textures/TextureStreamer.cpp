@@ -0,0 +1,820 @@
+#include "TextureStreamer.h"
+#include "EngineCore/Profiling/TraceRecorder.h"
+#include "EngineCore/Jobs/JobSystem.h"
+#include "EngineCore/Memory/FrameArena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+//Returns the first mip whose width and height both fit in TEXTURE_STREAMING_RESIDENT_MIP_SIZE
+static uint32_t FindTailMip(const TextureFileHeader& header)
+{
+	uint32_t mip = 0;
+	while (mip + 1 < header.mipCount &&
+		(GetTextureMipExtent(header.width, mip) > TEXTURE_STREAMING_RESIDENT_MIP_SIZE ||
+		GetTextureMipExtent(header.height, mip) > TEXTURE_STREAMING_RESIDENT_MIP_SIZE))
+	{
+		++mip;
+	}
+	return mip;
+}
+
+TextureStreamer::TextureStreamer()
+	:m_textures(), m_frameNumber{0}, m_deletionQueue{nullptr}, m_graphicsTimeline{nullptr}, m_residentBytes{0}, m_reservedBytes{0},
+	m_queuedJobs(), m_finishedJobs(), m_collectedJobs(), m_runningReads{0}, m_readyChanges(), m_deferredChanges(),
+	m_stagingBuffer(), m_stagingAllocations(), m_stagingHead{0}, vk_uploadCommandPool{VK_NULL_HANDLE},
+	m_uploadSlots(), vk_sampler{VK_NULL_HANDLE}
+{
+
+}
+
+/***********************************************************************************************
+* Function Argument 1: The device handle is needed to create the staging buffer, the upload    *
+*					   command buffers and the sampler										   *
+* Function Argument 2: Replaced images are released to it, so they are only destroyed once	   *
+*					   the frames that may still sample them have finished					   *
+* Function Argument 3: Tracks the uploads instead of fences, if the device has timelines	   *
+***********************************************************************************************/
+void TextureStreamer::CreateTextureStreamer(const VulkanDeviceHandle& device, VulkanDeletionQueue& deletionQueue,
+	VulkanQueueTimeline& graphicsTimeline)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	m_deletionQueue = &deletionQueue;
+	m_graphicsTimeline = &graphicsTimeline;
+
+	//Coherent memory means the read jobs' writes never have to be flushed
+	m_stagingBuffer.CreateBuffer(device, TEXTURE_STREAMING_STAGING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	/* Initializing create info struct for the upload command pool */
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	//Uploads are submitted to the graphics queue, so no queue ownership transfers are needed
+	poolInfo.queueFamilyIndex = device.GetQueueFamilyGraphicsIndex();
+	/* Create info struct complete */
+
+	VkResult poolResult = vkCreateCommandPool(vk_device, &poolInfo, nullptr, &vk_uploadCommandPool);
+	if (poolResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	m_uploadSlots.resize(TEXTURE_STREAMING_MAX_UPLOADS);
+	for (UploadSlot& slot : m_uploadSlots)
+	{
+		VkCommandBufferAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool = vk_uploadCommandPool;
+		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocateInfo.commandBufferCount = 1;
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		VkResult allocateResult = vkAllocateCommandBuffers(vk_device, &allocateInfo, &slot.vk_commandBuffer);
+		//With timeline semaphores every upload signals a value of the graphics timeline instead
+		VkResult fenceResult = VK_SUCCESS;
+		if (!device.AreTimelineSemaphoresEnabled())
+		{
+			fenceResult = vkCreateFence(vk_device, &fenceInfo, nullptr, &slot.vk_fence);
+		}
+		if (allocateResult != VK_SUCCESS || fenceResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+
+	/* Initializing create info struct for the sampler */
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = VK_FILTER_LINEAR;
+	samplerInfo.minFilter = VK_FILTER_LINEAR;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.anisotropyEnable = VK_FALSE;
+	samplerInfo.compareEnable = VK_FALSE;
+	samplerInfo.minLod = 0.0f;
+	//Each image only holds its resident mips, so the sampler never needs to clamp to them
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	samplerInfo.unnormalizedCoordinates = VK_FALSE;
+	/* Create info struct complete */
+
+	VkResult samplerResult = vkCreateSampler(vk_device, &samplerInfo, nullptr, &vk_sampler);
+	if (samplerResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+}
+
+void TextureStreamer::Cleanup(const VkDevice& device)
+{
+	//Reads that have not started are dropped, the ones already reading still write into the staging buffer
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_queuedJobs.clear();
+	}
+	while (m_runningReads.load(std::memory_order_acquire) > 0)
+	{
+		if (!JobSystem::Get().RunPendingJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+	m_finishedJobs.clear();
+	m_collectedJobs.clear();
+
+	//Images of uploads that never got swapped in are released with the textures' images, the deletion queue
+	//destroys them all once it is cleaned up
+	for (UploadSlot& slot : m_uploadSlots)
+	{
+		for (PendingImage& image : slot.images)
+		{
+			m_deletionQueue->Release<VkImageView, vkDestroyImageView>(image.vk_imageView);
+			m_deletionQueue->Release<VkImage, vkDestroyImage>(image.vk_image);
+			m_deletionQueue->Release<VkDeviceMemory, vkFreeMemory>(image.vk_memory);
+		}
+		vkDestroyFence(device, slot.vk_fence, nullptr);
+	}
+	m_uploadSlots.clear();
+	m_textures.clear();
+
+	vkDestroyCommandPool(device, vk_uploadCommandPool, nullptr);
+	vkDestroySampler(device, vk_sampler, nullptr);
+	m_stagingBuffer.Cleanup(device);
+}
+
+uint32_t TextureStreamer::RegisterTexture(const std::string& filename)
+{
+	uint32_t textureId = static_cast<uint32_t>(m_textures.size());
+
+	StreamedTexture texture;
+	texture.filename = filename;
+	//Nothing can be resident or requested until the header tells how many mips there are
+	texture.residentMip = TEXTURE_FILE_MAX_MIPS;
+	texture.requestedMip = TEXTURE_FILE_MAX_MIPS;
+	texture.operationPending = true;
+	m_textures.push_back(std::move(texture));
+
+	StreamingJob job;
+	job.textureId = textureId;
+	job.filename = filename;
+	job.loadsTail = true;
+	QueueRead(std::move(job));
+
+	return textureId;
+}
+
+/**************************************************************************************
+* Function Argument 1: The id returned by RegisterTexture							  *
+* Function Argument 2: The finest mip the texture is sampled at this frame			  *
+* Function Argument 3: How important the texture is (e.g. its screen coverage), loads *
+*					   with a higher priority are scheduled first					  *
+**************************************************************************************/
+void TextureStreamer::RequestMip(uint32_t textureId, uint32_t mip, float priority)
+{
+	if (textureId >= m_textures.size())
+	{
+		return;
+	}
+
+	StreamedTexture& texture = m_textures[textureId];
+	texture.requestedMip = std::min(texture.requestedMip, mip);
+	texture.priority = std::max(texture.priority, priority);
+	texture.lastUsedFrame = m_frameNumber;
+}
+
+uint32_t TextureStreamer::ComputeMipForScreenSize(uint32_t textureId, float screenPixels) const
+{
+	const StreamedTexture& texture = m_textures[textureId];
+	if (!texture.headerLoaded)
+	{
+		return 0;
+	}
+
+	uint32_t lastMip = texture.header.mipCount - 1;
+	if (screenPixels <= 0.0f)
+	{
+		return lastMip;
+	}
+
+	//Every mip halves the texels across the texture, so the mip is the log2 of texels per pixel
+	float texelsPerPixel = static_cast<float>(std::max(texture.header.width, texture.header.height)) / screenPixels;
+	if (texelsPerPixel <= 1.0f)
+	{
+		return 0;
+	}
+	return std::min(static_cast<uint32_t>(std::floor(std::log2(texelsPerPixel))), lastMip);
+}
+
+void TextureStreamer::Update(const VulkanDeviceHandle& device)
+{
+	TRACE_SCOPE("TextureStreaming");
+	++m_frameNumber;
+
+	CompleteUploads(device.GetVulkanSDKLogicalDevice());
+	CollectFinishedJobs();
+	ScheduleRequests();
+	SubmitResidencyChanges(device);
+
+	//Usage feedback only lasts a single frame, textures that are not requested again only need their tail
+	for (StreamedTexture& texture : m_textures)
+	{
+		texture.requestedMip = texture.headerLoaded ? texture.tailMip : TEXTURE_FILE_MAX_MIPS;
+		texture.priority = 0.0f;
+	}
+}
+
+void TextureStreamer::QueueRead(StreamingJob&& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_queuedJobs.push_back(std::move(job));
+	}
+	m_runningReads.fetch_add(1, std::memory_order_relaxed);
+
+	//Every job reads whichever read is oldest, so the reads still start in the order they were queued.
+	//The read blocks the worker it runs on, which the other workers make up for by stealing its work
+	JobSystem& jobSystem = JobSystem::Get();
+	jobSystem.Run(jobSystem.CreateJob([this]() { ReadNextQueuedJob(); }));
+}
+
+void TextureStreamer::ReadNextQueuedJob()
+{
+	StreamingJob job;
+	bool jobFound = false;
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		if (!m_queuedJobs.empty())
+		{
+			job = std::move(m_queuedJobs.front());
+			m_queuedJobs.pop_front();
+			jobFound = true;
+		}
+	}
+
+	//Cleanup empties the queue, the reads dropped by it still have their job run
+	if (jobFound)
+	{
+		{
+			TRACE_SCOPE("ReadTextureMips");
+			ExecuteJob(job);
+		}
+
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_finishedJobs.push_back(std::move(job));
+	}
+
+	m_runningReads.fetch_sub(1, std::memory_order_release);
+}
+
+void TextureStreamer::ExecuteJob(StreamingJob& job)
+{
+	std::ifstream file(job.filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	if (job.loadsTail)
+	{
+		if (!ReadTextureFileHeader(file, job.header))
+		{
+			return;
+		}
+		job.firstMip = FindTailMip(job.header);
+		job.endMip = job.header.mipCount;
+		job.tailData.resize(GetTextureMipRangeSize(job.header, job.firstMip, job.endMip));
+		job.succeeded = ReadTextureFileMips(file, job.header, job.firstMip, job.endMip, job.tailData.data());
+	}
+	else
+	{
+		//The render thread reserved this region of the staging buffer, nothing else touches it until the upload completes
+		uint8_t* destination = static_cast<uint8_t*>(m_stagingBuffer.GetMappedData()) + job.stagingOffset;
+		job.succeeded = ReadTextureFileMips(file, job.header, job.firstMip, job.endMip, destination);
+	}
+}
+
+void TextureStreamer::CollectFinishedJobs()
+{
+	m_collectedJobs.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_collectedJobs.swap(m_finishedJobs);
+	}
+
+	for (StreamingJob& job : m_collectedJobs)
+	{
+		StreamedTexture& texture = m_textures[job.textureId];
+		if (!job.succeeded)
+		{
+			std::cout << "Failed to stream texture " << job.filename << '\n';
+			if (!job.loadsTail)
+			{
+				FreeStaging(job.stagingOffset);
+				m_reservedBytes -= job.reservedBytes;
+			}
+			//A texture whose tail failed to load stays pending, so nothing is ever scheduled for it
+			texture.operationPending = job.loadsTail;
+			continue;
+		}
+
+		if (job.loadsTail)
+		{
+			texture.header = job.header;
+			texture.headerLoaded = true;
+			texture.tailMip = job.firstMip;
+			texture.residentMip = job.header.mipCount;
+			texture.requestedMip = std::min(texture.requestedMip, texture.tailMip);
+			m_readyChanges.push_back({ job.textureId, job.firstMip, false, 0, 0, std::move(job.tailData) });
+		}
+		else
+		{
+			m_readyChanges.push_back({ job.textureId, job.firstMip, true, job.stagingOffset, job.reservedBytes, {} });
+		}
+	}
+}
+
+void TextureStreamer::ScheduleRequests()
+{
+	/* Gathering the textures that need finer mips than they have */
+	FrameVector<uint32_t> requests;
+	requests.reserve(m_textures.size());
+	for (uint32_t i = 0; i < m_textures.size(); ++i)
+	{
+		const StreamedTexture& texture = m_textures[i];
+		if (texture.headerLoaded && !texture.operationPending && texture.requestedMip < texture.residentMip)
+		{
+			requests.push_back(i);
+		}
+	}
+
+	//The textures missing the most mips relative to their importance are loaded first
+	std::sort(requests.begin(), requests.end(), [this](uint32_t a, uint32_t b)
+	{
+		const StreamedTexture& textureA = m_textures[a];
+		const StreamedTexture& textureB = m_textures[b];
+		float scoreA = textureA.priority * static_cast<float>(textureA.residentMip - textureA.requestedMip);
+		float scoreB = textureB.priority * static_cast<float>(textureB.residentMip - textureB.requestedMip);
+		return scoreA > scoreB;
+	});
+	/* Requests gathered */
+
+	for (uint32_t textureId : requests)
+	{
+		StreamedTexture& texture = m_textures[textureId];
+
+		//A single load has to fit in the staging buffer, the remaining mips are loaded by later requests
+		uint32_t firstMip = texture.requestedMip;
+		VkDeviceSize loadSize = GetTextureMipRangeSize(texture.header, firstMip, texture.residentMip);
+		while (loadSize > TEXTURE_STREAMING_STAGING_SIZE && firstMip < texture.residentMip)
+		{
+			++firstMip;
+			loadSize = GetTextureMipRangeSize(texture.header, firstMip, texture.residentMip);
+		}
+		if (firstMip == texture.residentMip)
+		{
+			continue;
+		}
+
+		//Over budget, the load waits until enough older mips have been evicted
+		if (m_residentBytes + m_reservedBytes + loadSize > TEXTURE_STREAMING_BUDGET_BYTES)
+		{
+			EvictForRequest(m_residentBytes + m_reservedBytes + loadSize - TEXTURE_STREAMING_BUDGET_BYTES,
+				texture.lastUsedFrame);
+			break;
+		}
+
+		VkDeviceSize stagingOffset;
+		if (!AllocateStaging(loadSize, stagingOffset))
+		{
+			break;
+		}
+
+		m_reservedBytes += loadSize;
+		texture.operationPending = true;
+
+		StreamingJob job;
+		job.textureId = textureId;
+		job.filename = texture.filename;
+		job.firstMip = firstMip;
+		job.endMip = texture.residentMip;
+		job.stagingOffset = stagingOffset;
+		job.reservedBytes = loadSize;
+		job.header = texture.header;
+		QueueRead(std::move(job));
+	}
+}
+
+/*******************************************************************************************
+* Function Argument 1: The amount of bytes that must be freed for the request to fit	   *
+* Function Argument 2: The last frame the requesting texture was used in, only textures    *
+*					   used less recently (or holding finer mips than they need) are evicted *
+*******************************************************************************************/
+void TextureStreamer::EvictForRequest(VkDeviceSize neededBytes, uint64_t requesterLastUsedFrame)
+{
+	FrameVector<uint32_t> candidates;
+	candidates.reserve(m_textures.size());
+	for (uint32_t i = 0; i < m_textures.size(); ++i)
+	{
+		const StreamedTexture& texture = m_textures[i];
+		bool evictable = texture.headerLoaded && !texture.operationPending && texture.residentMip < texture.tailMip;
+		bool notNeeded = texture.lastUsedFrame < requesterLastUsedFrame || texture.residentMip < texture.requestedMip;
+		if (evictable && notNeeded)
+		{
+			candidates.push_back(i);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b)
+	{
+		return m_textures[a].lastUsedFrame < m_textures[b].lastUsedFrame;
+	});
+
+	//Only the finest mip of each texture is dropped at a time, so textures degrade gradually
+	VkDeviceSize freedBytes = 0;
+	for (uint32_t textureId : candidates)
+	{
+		if (freedBytes >= neededBytes)
+		{
+			break;
+		}
+
+		StreamedTexture& texture = m_textures[textureId];
+		texture.operationPending = true;
+		freedBytes += texture.header.mipSizes[texture.residentMip];
+		m_readyChanges.push_back({ textureId, texture.residentMip + 1, false, 0, 0, {} });
+	}
+}
+
+void TextureStreamer::SubmitResidencyChanges(const VulkanDeviceHandle& device)
+{
+	if (m_readyChanges.empty())
+	{
+		return;
+	}
+
+	auto freeSlot = std::find_if(m_uploadSlots.begin(), m_uploadSlots.end(),
+		[](const UploadSlot& slot) { return !slot.inFlight; });
+	if (freeSlot == m_uploadSlots.end())
+	{
+		return;
+	}
+	UploadSlot& slot = *freeSlot;
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkResetCommandBuffer(slot.vk_commandBuffer, 0);
+	VkResult beginResult = vkBeginCommandBuffer(slot.vk_commandBuffer, &beginInfo);
+	if (beginResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	m_deferredChanges.clear();
+	for (ResidencyChange& change : m_readyChanges)
+	{
+		//The tail of a new texture is copied into staging here, the worker could not know where it would fit
+		if (!change.tailData.empty())
+		{
+			if (!AllocateStaging(change.tailData.size(), change.stagingOffset))
+			{
+				m_deferredChanges.push_back(std::move(change));
+				continue;
+			}
+			std::memcpy(static_cast<uint8_t*>(m_stagingBuffer.GetMappedData()) + change.stagingOffset,
+				change.tailData.data(), change.tailData.size());
+			change.hasStagingData = true;
+			change.tailData.clear();
+		}
+
+		if (change.hasStagingData)
+		{
+			slot.stagingOffsets.push_back(change.stagingOffset);
+		}
+		slot.images.push_back(RecordResidencyChange(device, slot.vk_commandBuffer, change));
+	}
+	m_readyChanges.swap(m_deferredChanges);
+
+	VkResult endResult = vkEndCommandBuffer(slot.vk_commandBuffer);
+	if (endResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	if (slot.images.empty())
+	{
+		return;
+	}
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &slot.vk_commandBuffer;
+
+	/* Signalling the upload's completion */
+	VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+	VkFence uploadFence = VK_NULL_HANDLE;
+	if (m_graphicsTimeline->IsCreated())
+	{
+		//Taken right before the submit, so the values reach the queue in the order they were handed out
+		slot.timelineValue = m_graphicsTimeline->NextSignalValue();
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &slot.timelineValue;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &m_graphicsTimeline->GetVulkanSDKSemaphore();
+	}
+	else
+	{
+		vkResetFences(device.GetVulkanSDKLogicalDevice(), 1, &slot.vk_fence);
+		uploadFence = slot.vk_fence;
+	}
+	/* Completion signal chosen */
+
+	VkResult submitResult = vkQueueSubmit(device.GetVulkanSDKGraphicsQueue(), 1, &submitInfo, uploadFence);
+	if (submitResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	slot.inFlight = true;
+}
+
+/***************************************************************************************************
+* Function Argument 1: The device handle is needed to create the new image and find its memory type *
+* Function Argument 2: The upload command buffer the copies are recorded into					   *
+* Function Argument 3: The texture and the mips it will hold once the change is complete		   *
+***************************************************************************************************/
+TextureStreamer::PendingImage TextureStreamer::RecordResidencyChange(const VulkanDeviceHandle& device,
+	const VkCommandBuffer& commandBuffer, const ResidencyChange& change)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	const StreamedTexture& texture = m_textures[change.textureId];
+	const TextureFileHeader& header = texture.header;
+	uint32_t oldMip = texture.residentMip;
+	uint32_t newMip = change.newResidentMip;
+	uint32_t mipLevels = header.mipCount - newMip;
+	VkFormat format = static_cast<VkFormat>(header.format);
+
+	PendingImage pendingImage{ change.textureId, newMip, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, 0,
+		change.reservedBytes };
+
+	/* Initializing create info struct for the image holding the new resident mips */
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = format;
+	imageInfo.extent.width = GetTextureMipExtent(header.width, newMip);
+	imageInfo.extent.height = GetTextureMipExtent(header.height, newMip);
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = mipLevels;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	//The image is a copy source the next time its residency changes
+	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	/* Create info struct complete */
+
+	VkResult imageResult = vkCreateImage(vk_device, &imageInfo, nullptr, &pendingImage.vk_image);
+	if (imageResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(vk_device, pendingImage.vk_image, &memoryRequirements);
+
+	VkMemoryAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = memoryRequirements.size;
+	allocateInfo.memoryTypeIndex = device.FindMemoryTypeIndex(memoryRequirements.memoryTypeBits,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	VkResult allocateResult = vkAllocateMemory(vk_device, &allocateInfo, nullptr, &pendingImage.vk_memory);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	vkBindImageMemory(vk_device, pendingImage.vk_image, pendingImage.vk_memory, 0);
+	pendingImage.memorySize = memoryRequirements.size;
+
+	/* Preparing both images for the copies */
+	VkImageMemoryBarrier toTransfer[2]{};
+	toTransfer[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	toTransfer[0].srcAccessMask = 0;
+	toTransfer[0].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	toTransfer[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	toTransfer[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	toTransfer[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer[0].image = pendingImage.vk_image;
+	toTransfer[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 };
+
+	//Frames submitted before this upload may still be sampling the old image
+	toTransfer[1] = toTransfer[0];
+	toTransfer[1].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	toTransfer[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	toTransfer[1].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	toTransfer[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	toTransfer[1].image = texture.image.Get();
+	toTransfer[1].subresourceRange.levelCount = header.mipCount - oldMip;
+
+	uint32_t barrierCount = texture.image.Get() != VK_NULL_HANDLE ? 2 : 1;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, barrierCount, toTransfer);
+	/* Images prepared */
+
+	//The mips both images share are copied on the GPU, they never go back through the CPU
+	if (texture.image.Get() != VK_NULL_HANDLE)
+	{
+		FrameVector<VkImageCopy> imageCopies;
+		for (uint32_t mip = std::max(newMip, oldMip); mip < header.mipCount; ++mip)
+		{
+			VkImageCopy imageCopy{};
+			imageCopy.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - oldMip, 0, 1 };
+			imageCopy.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - newMip, 0, 1 };
+			imageCopy.extent = { GetTextureMipExtent(header.width, mip), GetTextureMipExtent(header.height, mip), 1 };
+			imageCopies.push_back(imageCopy);
+		}
+		vkCmdCopyImage(commandBuffer, texture.image.Get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pendingImage.vk_image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(imageCopies.size()), imageCopies.data());
+	}
+
+	//The newly loaded mips come from the staging buffer, in the same order they are stored in the file
+	if (change.hasStagingData)
+	{
+		FrameVector<VkBufferImageCopy> bufferCopies;
+		VkDeviceSize bufferOffset = change.stagingOffset;
+		for (uint32_t mip = newMip; mip < std::min(oldMip, header.mipCount); ++mip)
+		{
+			VkBufferImageCopy bufferCopy{};
+			bufferCopy.bufferOffset = bufferOffset;
+			bufferCopy.bufferRowLength = 0;
+			bufferCopy.bufferImageHeight = 0;
+			bufferCopy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - newMip, 0, 1 };
+			bufferCopy.imageOffset = { 0, 0, 0 };
+			bufferCopy.imageExtent = { GetTextureMipExtent(header.width, mip), GetTextureMipExtent(header.height, mip), 1 };
+			bufferCopies.push_back(bufferCopy);
+			bufferOffset += header.mipSizes[mip];
+		}
+		vkCmdCopyBufferToImage(commandBuffer, m_stagingBuffer.GetVulkanSDKBuffer(), pendingImage.vk_image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(bufferCopies.size()), bufferCopies.data());
+	}
+
+	/* Returning both images to the layout shaders sample them in */
+	VkImageMemoryBarrier toShaderRead[2] = { toTransfer[0], toTransfer[1] };
+	toShaderRead[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	toShaderRead[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	toShaderRead[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	toShaderRead[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	//The old image keeps being used by the frames recorded until the upload's fence signals
+	toShaderRead[1].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	toShaderRead[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	toShaderRead[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	toShaderRead[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, barrierCount, toShaderRead);
+	/* Images returned */
+
+	/* Initializing create info struct for the new image view */
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = pendingImage.vk_image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = format;
+	viewInfo.components = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+		VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+	viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 };
+	/* Create info struct complete */
+
+	VkResult viewResult = vkCreateImageView(vk_device, &viewInfo, nullptr, &pendingImage.vk_imageView);
+	if (viewResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	return pendingImage;
+}
+
+void TextureStreamer::CompleteUploads(const VkDevice& device)
+{
+	for (UploadSlot& slot : m_uploadSlots)
+	{
+		if (!slot.inFlight)
+		{
+			continue;
+		}
+
+		bool uploadComplete = m_graphicsTimeline->IsCreated() ? m_graphicsTimeline->IsComplete(device, slot.timelineValue) :
+			vkGetFenceStatus(device, slot.vk_fence) == VK_SUCCESS;
+		if (!uploadComplete)
+		{
+			continue;
+		}
+
+		for (PendingImage& image : slot.images)
+		{
+			StreamedTexture& texture = m_textures[image.textureId];
+			if (texture.image.Get() != VK_NULL_HANDLE)
+			{
+				m_residentBytes -= texture.memorySize;
+			}
+
+			//Frames recorded before this one may still sample the old image, assigning the new one releases it
+			//to the deletion queue rather than destroying it
+			texture.imageView = VulkanUniqueImageView(m_deletionQueue, image.vk_imageView);
+			texture.image = VulkanUniqueImage(m_deletionQueue, image.vk_image);
+			texture.memory = VulkanUniqueDeviceMemory(m_deletionQueue, image.vk_memory);
+			texture.memorySize = image.memorySize;
+			texture.residentMip = image.newResidentMip;
+			texture.operationPending = false;
+			m_residentBytes += image.memorySize;
+			m_reservedBytes -= image.reservedBytes;
+		}
+
+		for (VkDeviceSize stagingOffset : slot.stagingOffsets)
+		{
+			FreeStaging(stagingOffset);
+		}
+
+		slot.images.clear();
+		slot.stagingOffsets.clear();
+		slot.inFlight = false;
+	}
+}
+
+bool TextureStreamer::AllocateStaging(VkDeviceSize size, VkDeviceSize& offset)
+{
+	size = (size + TEXTURE_STREAMING_STAGING_ALIGNMENT - 1) & ~static_cast<VkDeviceSize>(TEXTURE_STREAMING_STAGING_ALIGNMENT - 1);
+	if (size > TEXTURE_STREAMING_STAGING_SIZE)
+	{
+		return false;
+	}
+
+	if (m_stagingAllocations.empty())
+	{
+		m_stagingHead = 0;
+	}
+
+	/* Finding a free region of the ring */
+	VkDeviceSize tail = m_stagingAllocations.empty() ? 0 : m_stagingAllocations.front().offset;
+	if (m_stagingAllocations.empty() || m_stagingHead > tail)
+	{
+		//The free space is split between the end of the buffer and its start, before the oldest allocation
+		if (m_stagingHead + size <= TEXTURE_STREAMING_STAGING_SIZE)
+		{
+			offset = m_stagingHead;
+		}
+		else if (size <= tail)
+		{
+			offset = 0;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	else
+	{
+		//The ring has wrapped around, the only free space is between the newest and the oldest allocation
+		if (m_stagingHead + size > tail)
+		{
+			return false;
+		}
+		offset = m_stagingHead;
+	}
+	/* Free region found */
+
+	m_stagingAllocations.push_back({ offset, size, false });
+	m_stagingHead = offset + size;
+	return true;
+}
+
+void TextureStreamer::FreeStaging(VkDeviceSize offset)
+{
+	for (StagingAllocation& allocation : m_stagingAllocations)
+	{
+		if (allocation.offset == offset && !allocation.freed)
+		{
+			allocation.freed = true;
+			break;
+		}
+	}
+
+	while (!m_stagingAllocations.empty() && m_stagingAllocations.front().freed)
+	{
+		m_stagingAllocations.pop_front();
+	}
+}
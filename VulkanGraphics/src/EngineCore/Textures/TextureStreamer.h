@@ -0,0 +1,242 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "EngineCore/VulkanHandles/VulkanBuffer.h"
+#include "EngineCore/VulkanHandles/VulkanDeletionQueue.h"
+#include "EngineCore/VulkanHandles/VulkanQueueTimeline.h"
+#include "EngineCore/Textures/TextureFile.h"
+
+//Maximum amount of device memory the streamed textures can use, the always resident mips included
+#define TEXTURE_STREAMING_BUDGET_BYTES (256ull * 1024 * 1024)
+
+//Mips whose width and height are both at most this size are loaded on registration and never evicted
+#define TEXTURE_STREAMING_RESIDENT_MIP_SIZE 64
+
+//Size of the staging buffer the read jobs write mips into, a single load can never be larger than this
+#define TEXTURE_STREAMING_STAGING_SIZE (64ull * 1024 * 1024)
+
+//Staging allocations are aligned so that every texel block size and optimalBufferCopyOffsetAlignment are respected
+#define TEXTURE_STREAMING_STAGING_ALIGNMENT 256
+
+//Amount of upload command buffers that can be executing on the GPU at the same time
+#define TEXTURE_STREAMING_MAX_UPLOADS 4
+
+#define TEXTURE_STREAMING_INVALID_ID 0xFFFFFFFF
+
+/**************************************************************************
+* Streams texture mips in and out of device memory. The coarse mips of    *
+* every texture stay resident, finer mips are loaded when the renderer    *
+* reports that they are needed on screen. Loads are ordered by priority   *
+* and kept under a memory budget by evicting the finest mips of the least *
+* recently used textures. Disk reads run as jobs of the job system that   *
+* write straight into a mapped staging buffer, the render thread only	  *
+* records the copies, so it never waits on the disk or on the GPU		  *
+**************************************************************************/
+class TextureStreamer
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	TextureStreamer();
+
+	//Creates the staging buffer, the upload command buffers and the sampler
+	void CreateTextureStreamer(const VulkanDeviceHandle& device, VulkanDeletionQueue& deletionQueue,
+		VulkanQueueTimeline& graphicsTimeline);
+
+	//Waits for the running read jobs and releases every texture to the deletion queue, the device must be idle
+	void Cleanup(const VkDevice& device);
+
+	//Starts loading the resident mips of a texture file in the background and returns the texture's id
+	uint32_t RegisterTexture(const std::string& filename);
+
+	//Usage feedback from the renderer: the texture was drawn this frame and needs mips down to (and including) mip
+	void RequestMip(uint32_t textureId, uint32_t mip, float priority = 1.0f);
+
+	//Returns the mip whose texels are closest to one per pixel when the texture covers screenPixels pixels across
+	uint32_t ComputeMipForScreenSize(uint32_t textureId, float screenPixels) const;
+
+	//Called once per frame after the frame's fence wait: finishes completed uploads, then schedules new loads and evictions
+	void Update(const VulkanDeviceHandle& device);
+
+	/* Member variable getters */
+	//Returns VK_NULL_HANDLE until the resident mips of the texture have been uploaded
+	inline VkImageView GetImageView(uint32_t textureId) const { return m_textures[textureId].imageView.Get(); }
+
+	//Returns the finest mip currently in device memory, the image view's mip 0 is this mip
+	inline uint32_t GetResidentMip(uint32_t textureId) const { return m_textures[textureId].residentMip; }
+
+	inline const VkSampler& GetVulkanSDKSampler() const { return vk_sampler; }
+
+	inline VkDeviceSize GetResidentBytes() const { return m_residentBytes; }
+
+	inline uint32_t GetTextureCount() const { return static_cast<uint32_t>(m_textures.size()); }
+	/* End member variable getters */
+private:
+	//Holds the state of a single registered texture
+	struct StreamedTexture
+	{
+		std::string filename;
+
+		//Only valid once headerLoaded is true
+		TextureFileHeader header = {};
+		bool headerLoaded = false;
+
+		//The first mip of the always resident tail
+		uint32_t tailMip = 0;
+		//The finest mip in device memory, equal to the mip count while nothing is resident
+		uint32_t residentMip = 0;
+		//The finest mip requested by the renderer this frame
+		uint32_t requestedMip = 0;
+		float priority = 0.0f;
+		uint64_t lastUsedFrame = 0;
+
+		//True while a load or an eviction of this texture is being worked on
+		bool operationPending = false;
+
+		//The image only holds the mips from residentMip to the end of the chain. Replacing them releases the
+		//old ones to the deletion queue, since frames recorded before may still sample them
+		VulkanUniqueImageView imageView;
+		VulkanUniqueImage image;
+		VulkanUniqueDeviceMemory memory;
+		VkDeviceSize memorySize = 0;
+	};
+
+	//A disk read run as a job, and its result once it is done
+	struct StreamingJob
+	{
+		uint32_t textureId = 0;
+		std::string filename;
+		//True for the first load of a texture, which also reads the header
+		bool loadsTail = false;
+		uint32_t firstMip = 0;
+		uint32_t endMip = 0;
+		//Where the mips are read to for mip loads, tail loads use tailData since their size is not known yet
+		VkDeviceSize stagingOffset = 0;
+		VkDeviceSize reservedBytes = 0;
+		TextureFileHeader header = {};
+		std::vector<uint8_t> tailData;
+		bool succeeded = false;
+	};
+
+	//A change of a texture's resident mips that is ready to be recorded on the GPU
+	struct ResidencyChange
+	{
+		uint32_t textureId;
+		uint32_t newResidentMip;
+		//True if the mips from newResidentMip to the current resident mip were read into staging
+		bool hasStagingData;
+		VkDeviceSize stagingOffset;
+		//Budget estimate reserved when the change was scheduled, released once it completes
+		VkDeviceSize reservedBytes;
+		//The resident mips of a newly registered texture, copied into staging once there is space for them
+		std::vector<uint8_t> tailData;
+	};
+
+	//The image that replaces a texture's current one once its upload has finished on the GPU
+	struct PendingImage
+	{
+		uint32_t textureId;
+		uint32_t newResidentMip;
+		VkImage vk_image;
+		VkDeviceMemory vk_memory;
+		VkImageView vk_imageView;
+		VkDeviceSize memorySize;
+		VkDeviceSize reservedBytes;
+	};
+
+	//A command buffer used to upload one batch of residency changes, and the fence or graphics timeline value
+	//that tells when the upload has finished
+	struct UploadSlot
+	{
+		VkCommandBuffer vk_commandBuffer = VK_NULL_HANDLE;
+		VkFence vk_fence = VK_NULL_HANDLE;
+		uint64_t timelineValue = 0;
+		bool inFlight = false;
+		std::vector<PendingImage> images;
+		std::vector<VkDeviceSize> stagingOffsets;
+	};
+
+	//A region of the staging ring, regions are freed in any order but only reused once everything before them is free
+	struct StagingAllocation
+	{
+		VkDeviceSize offset;
+		VkDeviceSize size;
+		bool freed;
+	};
+
+	//Queues a disk read and runs a job of the job system to execute it
+	void QueueRead(StreamingJob&& job);
+
+	//Runs as a job of the job system, reading the mips of the oldest queued read
+	void ReadNextQueuedJob();
+
+	//Called by ReadNextQueuedJob to do the actual disk read of a job
+	void ExecuteJob(StreamingJob& job);
+
+	//Called by Update to swap in the images of uploads the GPU has finished
+	void CompleteUploads(const VkDevice& device);
+
+	//Called by Update to turn finished disk reads into residency changes
+	void CollectFinishedJobs();
+
+	//Called by Update to pick the textures that need finer mips, in priority order, evicting others when over budget
+	void ScheduleRequests();
+
+	//Called by ScheduleRequests to queue the eviction of the finest mip of least recently used textures
+	void EvictForRequest(VkDeviceSize neededBytes, uint64_t requesterLastUsedFrame);
+
+	//Called by Update to record and submit the copies of every ready residency change
+	void SubmitResidencyChanges(const VulkanDeviceHandle& device);
+
+	//Called by SubmitResidencyChanges to create the new image and record the copies of a single change
+	PendingImage RecordResidencyChange(const VulkanDeviceHandle& device, const VkCommandBuffer& commandBuffer,
+		const ResidencyChange& change);
+
+	//Returns false if the staging ring does not have size contiguous free bytes
+	bool AllocateStaging(VkDeviceSize size, VkDeviceSize& offset);
+
+	void FreeStaging(VkDeviceSize offset);
+private:
+	std::vector<StreamedTexture> m_textures;
+
+	//Counts the calls to Update, used to track when textures were last used
+	uint64_t m_frameNumber;
+
+	//Replaced images are handed to it, it destroys them once the frames that may sample them have finished
+	VulkanDeletionQueue* m_deletionQueue;
+
+	//Uploads signal the graphics queue's timeline if it was created, otherwise their slot's fence
+	VulkanQueueTimeline* m_graphicsTimeline;
+
+	//Memory used by the images in device memory, and the estimated growth of the loads that are still running
+	VkDeviceSize m_residentBytes;
+	VkDeviceSize m_reservedBytes;
+
+	/* Read job state */
+	std::mutex m_jobMutex;
+	std::deque<StreamingJob> m_queuedJobs;
+	std::vector<StreamingJob> m_finishedJobs;
+	//Swapped with m_finishedJobs every frame, so both keep their capacity instead of being reallocated
+	std::vector<StreamingJob> m_collectedJobs;
+	//Read jobs that have been run but not returned yet, Cleanup waits for them before freeing the staging buffer
+	std::atomic<uint32_t> m_runningReads;
+	/* End read job state */
+
+	//Residency changes waiting for a free upload slot or staging space
+	std::vector<ResidencyChange> m_readyChanges;
+	//The changes that could not be recorded this time, swapped with m_readyChanges for the same reason
+	std::vector<ResidencyChange> m_deferredChanges;
+
+	//Mapped host memory that the read jobs write mips into and the uploads copy from
+	VulkanBufferHandle m_stagingBuffer;
+	std::deque<StagingAllocation> m_stagingAllocations;
+	VkDeviceSize m_stagingHead;
+
+	VkCommandPool vk_uploadCommandPool;
+	std::vector<UploadSlot> m_uploadSlots;
+
+	VkSampler vk_sampler;
+};
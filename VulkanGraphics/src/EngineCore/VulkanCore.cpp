@@ -1,51 +1,402 @@
 #include "VulkanCore.h"
 
+#include <cstdio>
+#include <filesystem>
+
 VulkanTriangle::VulkanTriangle()
-	:m_windowHandle(), m_vulkanInstance(), m_vulkanSurface(),
-	m_vulkanDevice(), m_vulkanSwapchain(), m_vulkanImageViews(),
-	m_vulkanPipeline()
+	:m_windows(), m_vulkanInstance(), m_vulkanDevice(),
+	m_vulkanPipeline(), m_pipelineCache(), m_shaderHotReloader(), m_offscreenTargets(), m_offscreenDepthBuffer(), m_offscreenGBuffer(),
+	m_multiviewTargets(),
+	m_deletionQueue(), m_gpuProfiler(), m_sceneMesh(),
+	m_startTime(std::chrono::steady_clock::now()), m_meshView(), m_drawnMeshTriangles{0}, m_textureStreamer(), m_particleSystem(),
+	m_clusteredLighting(), m_shadowCascades(), m_overlay(), m_hudTextureId{TEXTURE_STREAMING_INVALID_ID}, m_frameCapture(), m_frameWriter(), m_options(),
+	m_lastFrameTime(m_startTime), m_sceneSeconds{0.0f}, m_gpuWaitMsSum{0.0}, m_readbackMsSum{0.0}, m_recordingMsSum{0.0},
+	m_recordedFrames{0}, m_overlayBuildMsSum{0.0}, m_overlayBuiltFrames{0}, m_lightBenchmarkStep{0}, m_lightBenchmarkFrames{0}, m_lightBenchmarkSamples{0},
+	m_lightBinningMsSum{0.0}, m_lightMainPassMsSum{0.0}, m_lightFrameMsSum{0.0}, m_framesInFlight{MAX_FRAMES_IN_FLIGHT}, m_currentFrame{0}, m_traceKeyWasPressed{false},
+	m_frameCaptureKeyWasPressed{false}, m_firstFramePresented{false}
 {
 
 }
 
 void VulkanTriangle::VulkanInit()
 {
-	//The window will be created first, since its used in vulkan instance creation
-	m_windowHandle.CreateGlfwWindow();
+	//Every stage only waits for the stages it actually needs, so reading files and compiling pipelines
+	//overlap the device and swapchain setup instead of running one after another
+	JobGraph startup;
+
+	m_deletionQueue.CreateDeletionQueue(m_framesInFlight);
+
+	/* Stages that need no device */
+	//Glfw has to be initialized on the main thread, the windows are used in vulkan instance creation
+	uint32_t window = startup.AddStage("CreateWindow", [this]()
+	{
+		for (uint32_t i = 0; i < m_windows.size(); ++i)
+		{
+			m_windows[i].window.CreateGlfwWindow(!IsBatchMode(), i);
+		}
+	}, {}, true);
+
+	uint32_t pipelineCacheFile = startup.AddStage("ReadPipelineCache", [this]()
+	{
+		m_pipelineCache.ReadCacheFile(PIPELINE_CACHE_FILENAME);
+	});
+	/* Stages without a device added */
 
+	/* Device stages */
 	//The instance is created first as the Vulkan SDK cannot be accessed without it
-	m_vulkanInstance.CreateVulkanInstance(m_windowHandle);
+	uint32_t instance = startup.AddStage("CreateInstance", [this]()
+	{
+		m_vulkanInstance.CreateVulkanInstance(m_windows[0].window);
+	}, { window });
+
+	//After the instance, the surfaces will be created
+	uint32_t surface = startup.AddStage("CreateSurface", [this]()
+	{
+		for (PresentWindow& presentWindow : m_windows)
+		{
+			presentWindow.surface.CreateVulkanSurface(presentWindow.window, m_vulkanInstance.GetVulkanSDKInstance());
+		}
+	}, { instance });
+
+	//The logical device is created after the surface, as it needs the surface to find the device's swapchain support details.
+	//The GPU is chosen with the primary window, the other windows only have to be presentable from the same queue
+	uint32_t device = startup.AddStage("CreateDevice", [this]()
+	{
+		m_vulkanDevice.CreateVulkanLogicalDevice(m_vulkanInstance, m_windows[0].surface.GetVulkanSDKSurface());
+		for (const PresentWindow& presentWindow : m_windows)
+		{
+			if (!m_vulkanDevice.CanPresentToSurface(presentWindow.surface.GetVulkanSDKSurface()))
+			{
+				__debugbreak();
+			}
+		}
+	}, { surface });
+
+	//Falls back to a single view if the device or a window cannot do multiview. Every stage reading the multiview
+	//count depends on this one, as it may change it
+	uint32_t multiview = startup.AddStage("ChooseMultiview", [this]()
+	{
+		if (m_options.multiviewCount != 0 && !CheckMultiviewSupport())
+		{
+			m_options.multiviewCount = 0;
+		}
+	}, { device });
+	/* Device stages added */
+
+	//Only the shaders of the features the options turn on are read, so only they have to be compiled. The multiview
+	//ones are only read once the device has been found to support it
+	uint32_t shaders = startup.AddStage("ReadShaderFiles", [this]()
+	{
+		ShaderFileGroups groups;
+		groups.multiview = m_options.multiviewCount != 0;
+		groups.clusteredLighting = m_options.lightCount != 0;
+		groups.deferred = m_options.deferred;
+		groups.shadows = m_options.shadows;
+		groups.overlay = m_options.hud;
+		m_vulkanPipeline.ReadShaderFiles(groups);
+	}, { multiview });
 
-	//After the instance, the surface will be created
-	m_vulkanSurface.CreateVulkanSurface(m_windowHandle, m_vulkanInstance.GetVulkanSDKInstance());
+	/* Pipeline stages */
+	//The formats the swapchain and the depth buffer will use are known from the device's support details,
+	//so the render pass and the pipelines do not wait for either of them to be created
+	uint32_t renderPass = startup.AddStage("CreateRenderPass", [this]()
+	{
+		VkFormat swapchainFormat = VulkanSwapchainHandle::ChooseSwapchainSurfaceFormat(
+			m_vulkanDevice.GetSwapchainSupportDetails().formats).format;
+		VkFormat depthFormat = VulkanDepthBufferHandle::FindDepthFormat(m_vulkanDevice.GetVulkanSDKPhysicalDevice());
+		//Batch frames are only ever copied out, so they are left ready for the copy instead of the present
+		VkImageLayout colorFinalLayout = IsBatchMode() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		m_vulkanPipeline.CreateRenderPass(swapchainFormat, depthFormat, m_vulkanDevice.GetVulkanSDKLogicalDevice(),
+			colorFinalLayout);
+		if (m_options.deferred)
+		{
+			m_vulkanPipeline.CreateDeferredRenderPass(swapchainFormat, depthFormat,
+				m_vulkanDevice.GetVulkanSDKLogicalDevice(), colorFinalLayout);
+		}
+
+		if (m_options.multiviewCount != 0)
+		{
+			m_vulkanPipeline.CreateMultiviewRenderPass(swapchainFormat, depthFormat,
+				m_vulkanDevice.GetVulkanSDKLogicalDevice(), m_options.multiviewCount);
+		}
+		//The views of the multiview render pass are never shadowed, so there is no shadow render pass with multiview
+		if (m_options.shadows && m_options.multiviewCount == 0)
+		{
+			m_vulkanPipeline.CreateShadowRenderPass(
+				VulkanShadowCascadesHandle::FindShadowMapFormat(m_vulkanDevice.GetVulkanSDKPhysicalDevice()),
+				m_vulkanDevice.GetVulkanSDKLogicalDevice());
+		}
+	}, { device, multiview });
 
-	//The logical device is created after the surface, as it needs the surface to find the device's swapchain support details
-	m_vulkanDevice.CreateVulkanLogicalDevice(m_vulkanInstance, m_vulkanSurface.GetVulkanSDKSurface());
+	uint32_t pipelineCache = startup.AddStage("CreatePipelineCache", [this]()
+	{
+		m_pipelineCache.CreatePipelineCache(m_vulkanDevice);
+	}, { device, pipelineCacheFile });
 
-	//The swaphcain is created after the surface, as it needs the device, the window and the surface for its creation
-	m_vulkanSwapchain.CreateSwapchain(m_vulkanSurface.GetVulkanSDKSurface(),
-		m_vulkanDevice, m_windowHandle);
+	startup.AddStage("CreateGraphicsPipeline", [this]()
+	{
+		m_vulkanPipeline.CreateGraphicsPipeline(m_vulkanDevice.GetVulkanSDKLogicalDevice(),
+			m_pipelineCache.GetVulkanSDKPipelineCache());
+	}, { renderPass, shaders, pipelineCache });
+	/* Pipeline stages added */
 
-	//The image views are created after the swaphcain, as they are based on the swaphcain images
-	m_vulkanImageViews.CreateImageViews(m_vulkanSwapchain, m_vulkanDevice.GetVulkanSDKLogicalDevice());
+	/* Swapchain stages */
+	//The swaphcains are created after the surfaces, as they need the device, the window and the surface for their creation
+	uint32_t swapchain = startup.AddStage("CreateSwapchain", [this]()
+	{
+		for (PresentWindow& presentWindow : m_windows)
+		{
+			presentWindow.swapchain.CreateSwapchain(presentWindow.surface.GetVulkanSDKSurface(), m_vulkanDevice,
+				presentWindow.window);
+			//Every window is drawn with the same render pass, so their swapchains must all have its format
+			if (presentWindow.swapchain.GetSwapchainImageFormat() != m_windows[0].swapchain.GetSwapchainImageFormat())
+			{
+				__debugbreak();
+			}
+		}
+	}, { device });
 
-	//Creating the render pass before the graphics pipeline, 
-	//as it needs to be passed in the pipeline's create info struct
-	m_vulkanPipeline.CreateRenderPass(m_vulkanSwapchain.GetSwapchainImageFormat(), 
-		m_vulkanDevice.GetVulkanSDKLogicalDevice());
+	//The image views are created after the swaphcains, as they are based on the swaphcain images
+	uint32_t imageViews = startup.AddStage("CreateImageViews", [this]()
+	{
+		for (PresentWindow& presentWindow : m_windows)
+		{
+			presentWindow.imageViews.CreateImageViews(presentWindow.swapchain, m_vulkanDevice.GetVulkanSDKLogicalDevice());
+		}
+	}, { swapchain });
 
-	//Creating the graphics pipeline after the render pass
-	m_vulkanPipeline.CreateGraphicsPipeline(m_vulkanDevice.GetVulkanSDKLogicalDevice(), 
-		m_vulkanSwapchain.GetSwapchainExtent());
+	//Each depth buffer is the same size as the swapchain images it is attached next to. Deferred shading attaches
+	//the G-buffer's depth instead
+	uint32_t depthBuffer = startup.AddStage("CreateDepthBuffer", [this]()
+	{
+		if (m_options.deferred)
+		{
+			return;
+		}
+		for (PresentWindow& presentWindow : m_windows)
+		{
+			presentWindow.depthBuffer.CreateDepthBuffer(m_vulkanDevice, presentWindow.swapchain.GetSwapchainExtent());
+		}
+	}, { swapchain });
 
-	//Creating the framebuffers based on the image views and each compatible with our render pass
-	m_vulkanFramebuffers.CreateFramebuffers(m_vulkanImageViews.GetVulkanSDKImageViews(),
-		m_vulkanPipeline.GetVulkanSDKRenderPass(), m_vulkanSwapchain.GetSwapchainExtent(),
-		m_vulkanDevice.GetVulkanSDKLogicalDevice());
+	//Every window gets a G-buffer of its swapchain's size, batch mode one of the batch frames' size shared by the
+	//offscreen images like their depth buffer. Its set is allocated with the layout the deferred render pass made
+	uint32_t gbuffer = startup.AddStage("CreateGBuffer", [this]()
+	{
+		if (!m_options.deferred)
+		{
+			return;
+		}
+		const VkDescriptorSetLayout& inputSetLayout = m_vulkanPipeline.GetVulkanSDKGBufferSetLayout();
+		for (PresentWindow& presentWindow : m_windows)
+		{
+			presentWindow.gbuffer.CreateGBuffer(m_vulkanDevice, presentWindow.swapchain.GetSwapchainExtent(), inputSetLayout);
+		}
+		if (IsBatchMode())
+		{
+			m_offscreenGBuffer.CreateGBuffer(m_vulkanDevice, GetRenderExtent(), inputSetLayout);
+		}
+		std::cout << "Deferred shading G-buffer in " << (m_windows[0].gbuffer.IsLazilyAllocated() ?
+			"lazily allocated" : "device local") << " memory\n";
+	}, { swapchain, renderPass });
 
-	m_vulkanCommandBuffer.CreateCommandBuffer(m_vulkanDevice);
+	//Frames are copied out of the images they render into, so the readback buffers have their size and format
+	startup.AddStage("CreateFrameCapture", [this]()
+	{
+		const VulkanSwapchainHandle& primarySwapchain = m_windows[0].swapchain;
+		if (IsBatchMode() || (primarySwapchain.GetSwapchainImageUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+		{
+			m_frameCapture.CreateFrameCapture(m_vulkanDevice, GetRenderExtent(), primarySwapchain.GetSwapchainImageFormat(),
+				m_framesInFlight);
+		}
+		m_frameCapture.SetConsumer([this](CapturedFrame& frame) { m_frameWriter.Push(frame); });
+	}, { swapchain });
+
+	//Batch mode renders into offscreen images of the swapchain's format, one for each frame in flight, which share
+	//a depth buffer of their size
+	uint32_t offscreenTargets = startup.AddStage("CreateOffscreenTargets", [this]()
+	{
+		if (IsBatchMode())
+		{
+			m_offscreenTargets.CreateOffscreenTargets(m_vulkanDevice, GetRenderExtent(),
+				m_windows[0].swapchain.GetSwapchainImageFormat(), m_framesInFlight);
+			m_offscreenDepthBuffer.CreateDepthBuffer(m_vulkanDevice, GetRenderExtent());
+		}
+	}, { swapchain });
+
+	//The views split the width of the frame between them, so their side by side blit is not stretched
+	startup.AddStage("CreateMultiviewTargets", [this]()
+	{
+		if (m_options.multiviewCount != 0)
+		{
+			VkExtent2D renderExtent = GetRenderExtent();
+			VkExtent2D viewExtent = { renderExtent.width / m_options.multiviewCount, renderExtent.height };
+			m_multiviewTargets.CreateMultiviewTargets(m_vulkanDevice, m_vulkanPipeline, viewExtent,
+				m_windows[0].swapchain.GetSwapchainImageFormat(),
+				VulkanDepthBufferHandle::FindDepthFormat(m_vulkanDevice.GetVulkanSDKPhysicalDevice()),
+				m_options.multiviewCount, m_framesInFlight);
+		}
+	}, { swapchain, renderPass });
+
+	//Creating the framebuffers based on the image views and each compatible with our render pass, or with the
+	//deferred render pass, which attaches the G-buffer after the image view instead of the depth buffer
+	startup.AddStage("CreateFramebuffers", [this]()
+	{
+		const VkRenderPass& vk_renderPass = m_options.deferred ? m_vulkanPipeline.GetVulkanSDKDeferredRenderPass() :
+			m_vulkanPipeline.GetVulkanSDKRenderPass();
+		for (PresentWindow& presentWindow : m_windows)
+		{
+			CreateWindowFramebuffers(presentWindow);
+		}
+		m_offscreenFramebuffers.CreateFramebuffers(m_offscreenTargets.GetVulkanSDKImageViews(),
+			m_options.deferred ? m_offscreenGBuffer.GetVulkanSDKImageViews() :
+			std::vector<VkImageView>{ m_offscreenDepthBuffer.GetVulkanSDKImageView() }, vk_renderPass,
+			m_offscreenTargets.GetExtent(), m_vulkanDevice.GetVulkanSDKLogicalDevice());
+	}, { imageViews, depthBuffer, gbuffer, renderPass, offscreenTargets });
+	/* Swapchain stages added */
+
+	/* Mesh stages */
+	uint32_t commandBuffers = startup.AddStage("CreateCommandBuffers", [this]()
+	{
+		m_vulkanCommandBuffer.CreateCommandBuffer(m_vulkanDevice, m_framesInFlight);
+	}, { device });
+
+	//The mesh is optional, without it the triangle is drawn and the mesh pipeline is never created.
+	//Loading submits to the graphics queue, so it is the only stage allowed to use the queue
+	uint32_t mesh = startup.AddStage("LoadMesh", [this]()
+	{
+		m_sceneMesh.LoadMesh(m_vulkanDevice, m_vulkanCommandBuffer.GetVulkanSDKCommandPool(), SCENE_MESH_FILENAME);
+	}, { commandBuffers });
+
+	//The lights are scattered through the mesh's bounds, so they wait for it to load. The clusters are only binned for
+	//the single view camera, so multiview draws the mesh unlit
+	uint32_t clusteredLighting = startup.AddStage("CreateClusteredLighting", [this]()
+	{
+		if (m_options.lightCount == 0 || !m_sceneMesh.IsLoaded())
+		{
+			return;
+		}
+		if (m_options.multiviewCount != 0)
+		{
+			std::cout << "Clustered lighting is not drawn with multiview, drawing the mesh unlit\n";
+			return;
+		}
+
+		Vec3 center;
+		float radius;
+		GetSceneSphere(center, radius);
+		m_clusteredLighting.CreateClusteredLighting(m_vulkanDevice, m_vulkanPipeline,
+			m_pipelineCache.GetVulkanSDKPipelineCache(), m_options.lightCount, m_framesInFlight, center, radius);
+		if (m_options.lightBenchmark)
+		{
+			m_clusteredLighting.SetActiveLightCount(LIGHT_BENCHMARK_FIRST_COUNT);
+		}
+	}, { mesh, renderPass, shaders, pipelineCache });
+
+	//Only the mesh casts shadows, so without it there is nothing to render into the cascades
+	uint32_t shadowCascades = startup.AddStage("CreateShadowCascades", [this]()
+	{
+		if (!m_options.shadows || !m_sceneMesh.IsLoaded())
+		{
+			return;
+		}
+		if (m_options.multiviewCount != 0)
+		{
+			std::cout << "Shadows are not drawn with multiview, drawing the mesh unshadowed\n";
+			return;
+		}
+
+		m_shadowCascades.CreateShadowCascades(m_vulkanDevice, m_vulkanPipeline, m_framesInFlight);
+	}, { mesh, renderPass });
+
+	startup.AddStage("CreateMeshPipeline", [this]()
+	{
+		if (!m_sceneMesh.IsLoaded())
+		{
+			return;
+		}
+
+		std::vector<VkVertexInputBindingDescription> vertexBindings;
+		std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+		VulkanMeshHandle::GetVertexInputDescription(m_sceneMesh.GetVertexFormat(), vertexBindings, vertexAttributes);
+		ShaderVariantKey variant;
+		VulkanMeshHandle::GetShaderVariant(m_sceneMesh.GetVertexFormat(), variant);
+		m_vulkanPipeline.CreateMeshPipeline(m_vulkanDevice.GetVulkanSDKLogicalDevice(),
+			m_pipelineCache.GetVulkanSDKPipelineCache(), vertexBindings, vertexAttributes, variant,
+			m_clusteredLighting.GetVulkanSDKSetLayout(), m_shadowCascades.GetVulkanSDKSetLayout());
+	}, { mesh, renderPass, shaders, pipelineCache, clusteredLighting, shadowCascades });
+	/* Mesh stages added */
+
+	//The particle buffers are filled on the GPU by the first frame, so creating them does not use the queue
+	startup.AddStage("CreateParticleSystem", [this]()
+	{
+		uint32_t maxParticles = m_options.particleStress ? PARTICLE_STRESS_COUNT : SCENE_PARTICLE_COUNT;
+		m_particleSystem.CreateParticleSystem(m_vulkanDevice, m_vulkanPipeline, m_pipelineCache.GetVulkanSDKPipelineCache(),
+			maxParticles);
+	}, { renderPass, shaders, pipelineCache });
+
+	//The atlases are uploaded by the first frame, like the particle buffers, so creating them does not use the queue
+	uint32_t overlay = startup.AddStage("CreateOverlay", [this]()
+	{
+		if (!m_options.hud)
+		{
+			return;
+		}
+		if (m_options.multiviewCount != 0)
+		{
+			std::cout << "The HUD is not drawn with multiview, drawing the scene without it\n";
+			return;
+		}
 
-	m_vulkanSyncObjects.CreateSyncObjects(m_vulkanDevice.GetVulkanSDKLogicalDevice());
+		m_overlay.CreateOverlayBatcher(m_vulkanDevice, m_vulkanPipeline, m_pipelineCache.GetVulkanSDKPipelineCache(),
+			m_framesInFlight);
+	}, { renderPass, shaders, pipelineCache });
+
+	uint32_t syncObjects = startup.AddStage("CreateSyncObjects", [this]()
+	{
+		m_vulkanSyncObjects.CreateSyncObjects(m_vulkanDevice, m_framesInFlight, static_cast<uint32_t>(m_windows.size()));
+	}, { device });
+
+	startup.AddStage("CreateGpuProfiler", [this]()
+	{
+		m_gpuProfiler.CreateGpuProfiler(m_vulkanInstance, m_vulkanDevice, m_framesInFlight);
+	}, { device });
+
+	//The HUD is the only thing sampling streamed textures, without it the streamer is not created
+	uint32_t textureStreamer = startup.AddStage("CreateTextureStreamer", [this]()
+	{
+		if (!m_options.hud)
+		{
+			return;
+		}
+		m_textureStreamer.CreateTextureStreamer(m_vulkanDevice, m_deletionQueue, m_vulkanSyncObjects.GetGraphicsTimeline());
+	}, { device, syncObjects });
+
+	//Only the resident mips are read here, on a job of their own, the finer ones are streamed in once the HUD asks for them
+	startup.AddStage("LoadHudTexture", [this]()
+	{
+		if (!m_overlay.IsCreated())
+		{
+			return;
+		}
+		if (!std::filesystem::exists(HUD_TEXTURE_FILENAME) && !WriteHudTextureFile(HUD_TEXTURE_FILENAME))
+		{
+			std::cout << "Could not write " << HUD_TEXTURE_FILENAME << ", drawing the HUD without its texture\n";
+			return;
+		}
+		m_hudTextureId = m_textureStreamer.RegisterTexture(HUD_TEXTURE_FILENAME);
+	}, { overlay, textureStreamer });
+
+	startup.Run();
+
+	std::cout << "Startup stages (pipeline cache " << (m_pipelineCache.IsWarm() ? "warm" : "cold") << "):\n";
+	startup.LogTimings(std::cout);
+	VulkanLayoutCache& layoutCache = m_vulkanPipeline.GetLayoutCache();
+	std::cout << "Layout cache : " << layoutCache.GetCreatedCount() << " layouts created, " << layoutCache.GetReusedCount()
+		<< " requests reused one\n";
+
+	//The emitter is sized to the mesh, which is only known once it has loaded
+	ConfigureParticleEmitter();
 }
 
 std::vector<char> VulkanTriangle::ReadFile(const std::string& filename)
@@ -75,91 +426,1113 @@ void VulkanTriangle::VulkanDestroy()
 	/**************************************************************************************
 	* Vulkan objects will have to be cleaned up in opposite order to their initialization *
 	**************************************************************************************/
+	m_textureStreamer.Cleanup(device);
+	//The device is idle, so every released handle can be destroyed, the streamer's images included
+	m_deletionQueue.Cleanup(device);
+	m_gpuProfiler.Cleanup(device);
 	m_vulkanSyncObjects.Cleanup(device);
+	m_frameCapture.Cleanup(device);
+	m_sceneMesh.Cleanup(device);
+	m_particleSystem.Cleanup(device);
+	m_clusteredLighting.Cleanup(device);
+	m_shadowCascades.Cleanup(device);
+	m_overlay.Cleanup(device);
 	m_vulkanCommandBuffer.Cleanup(device);
-	m_vulkanFramebuffers.Cleanup(device);
+	for (PresentWindow& presentWindow : m_windows)
+	{
+		presentWindow.framebuffers.Cleanup(device);
+	}
+	m_offscreenFramebuffers.Cleanup(device);
+	m_offscreenDepthBuffer.Cleanup(device);
+	m_offscreenGBuffer.Cleanup(device);
+	m_offscreenTargets.Cleanup(device);
+	m_multiviewTargets.Cleanup(device);
+	//Saved so the next launch starts with every pipeline compiled by this one
+	m_pipelineCache.WriteCacheFile(device, PIPELINE_CACHE_FILENAME);
+	m_pipelineCache.Cleanup(device);
 	m_vulkanPipeline.Cleanup(device);
-	m_vulkanImageViews.Cleanup(device);
-	m_vulkanSwapchain.Cleanup(device);
+	for (PresentWindow& presentWindow : m_windows)
+	{
+		presentWindow.depthBuffer.Cleanup(device);
+		presentWindow.gbuffer.Cleanup(device);
+		presentWindow.imageViews.Cleanup(device);
+		presentWindow.swapchain.Cleanup(device);
+	}
 	m_vulkanDevice.Cleanup();
-	m_vulkanSurface.Cleanup(m_vulkanInstance.GetVulkanSDKInstance());
+	for (PresentWindow& presentWindow : m_windows)
+	{
+		presentWindow.surface.Cleanup(m_vulkanInstance.GetVulkanSDKInstance());
+	}
 	m_vulkanInstance.Cleanup();
-	m_windowHandle.Cleanup();
+	for (PresentWindow& presentWindow : m_windows)
+	{
+		presentWindow.window.Cleanup();
+	}
+	GlfwWindowHandle::TerminateGlfw();
 }
 
-void VulkanTriangle::RunTriangle()
+void VulkanTriangle::RunTriangle(const ApplicationOptions& options)
 {
+	m_options = options;
+	//The benchmark creates every light up front, and lights more of them at every step
+	if (m_options.lightBenchmark)
+	{
+		m_options.lightCount = CLUSTERED_LIGHTING_MAX_LIGHTS;
+	}
+	//The views of the multiview render pass have no G-buffer of their own, decided before any stage reads the option
+	if (m_options.deferred && m_options.multiviewCount != 0)
+	{
+		std::cout << "Deferred shading is not drawn with multiview, drawing forward\n";
+		m_options.deferred = false;
+	}
+	m_framesInFlight = IsBatchMode() ? BATCH_FRAMES_IN_FLIGHT : MAX_FRAMES_IN_FLIGHT;
+	m_windows.resize(IsBatchMode() ? 1 : m_options.windowCount);
+	TraceRecorder::Get().SetThreadName("Main thread");
+	//The job system runs before anything else, so initialization can already use it
+	JobSystem::Get().Start(JobSystem::GetDefaultWorkerCount());
+	FrameArena::Get().CreateFrameArena(m_framesInFlight);
 	VulkanInit();
-	while (!m_windowHandle.CheckIfWindowShouldClose())
+	if (IsBatchMode())
 	{
-		m_windowHandle.CheckEvents();
+		RunBatch();
+	}
+	else
+	{
+		if (m_options.shaderHotReload)
+		{
+			if (m_shaderHotReloader.Start(m_vulkanDevice.GetVulkanSDKLogicalDevice(),
+				m_pipelineCache.GetVulkanSDKPipelineCache(), m_vulkanPipeline, SHADER_DIRECTORY))
+			{
+				std::cout << "Watching the shaders in " << SHADER_DIRECTORY << " for changes\n";
+			}
+			else
+			{
+				std::cout << "Shader hot reload needs " << SHADER_DIRECTORY << '/' << SHADER_COMPILE_LIST << '\n';
+			}
+		}
+
+		while (!IsAnyWindowClosing())
+		{
+			{
+				TRACE_SCOPE("PollEvents");
+				m_windows[0].window.CheckEvents();
+			}
+			CheckTraceCaptureKey();
+			CheckFrameCaptureKey();
+			DrawFrame();
+		}
+		//A rebuild still running finishes first, the pipelines it leaves unswapped are destroyed with the others
+		m_shaderHotReloader.Stop();
+		vkDeviceWaitIdle(m_vulkanDevice.GetVulkanSDKLogicalDevice());
+		//The frames still in flight when the window closed are written as well
+		m_frameCapture.CollectAllFrames();
+		m_frameWriter.Stop();
+	}
+	TraceRecorder::Get().EndCapture();
+	VulkanDestroy();
+	FrameArena::Get().Cleanup();
+	JobSystem::Get().Stop();
+}
+
+void VulkanTriangle::RunBatch()
+{
+	if (!m_frameCapture.IsCreated())
+	{
+		std::cout << "Batch mode needs an 8 bit RGBA or BGRA swapchain format\n";
+		return;
+	}
+
+	/* Starting the writers */
+	FrameWriterSettings settings;
+	settings.format = m_options.batchFormat;
+	settings.path = m_options.batchOutput;
+	if (settings.path.empty())
+	{
+		settings.path = settings.format == FrameWriterFormat::Png ? BATCH_DEFAULT_PNG_OUTPUT :
+			settings.format == FrameWriterFormat::Raw ? BATCH_DEFAULT_RAW_OUTPUT : BATCH_DEFAULT_Y4M_OUTPUT;
+	}
+	settings.threadCount = settings.format == FrameWriterFormat::Png ? BATCH_PNG_WRITER_THREADS : 1;
+	//Every frame of the sequence has to reach the disk, so the frame loop waits for the writers instead of dropping
+	settings.dropWhenFull = false;
+	settings.frameRate = BATCH_FRAME_RATE;
+	m_frameWriter.Start(settings);
+	m_frameCapture.SetCapturing(true);
+	/* Writers started */
+
+	VkExtent2D extent = GetRenderExtent();
+	std::cout << "Rendering " << m_options.batchFrameCount << " frames of " << extent.width << 'x' << extent.height
+		<< " to " << settings.path << " with " << m_framesInFlight << " frames in flight\n";
+
+	auto batchStart = std::chrono::steady_clock::now();
+	for (uint32_t frame = 0; frame < m_options.batchFrameCount && !IsAnyWindowClosing(); ++frame)
+	{
+		m_windows[0].window.CheckEvents();
 		DrawFrame();
 	}
+
+	//The last frames in flight are collected once the GPU has finished them, and written before the clock stops
 	vkDeviceWaitIdle(m_vulkanDevice.GetVulkanSDKLogicalDevice());
-	VulkanDestroy();
+	auto readbackStart = std::chrono::steady_clock::now();
+	m_frameCapture.CollectAllFrames();
+	m_readbackMsSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readbackStart).count();
+	m_frameWriter.Stop();
+	LogBatchStatistics(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batchStart).count());
+}
+
+void VulkanTriangle::LogBatchStatistics(double totalMs) const
+{
+	uint64_t frames = m_frameWriter.GetWrittenFrameCount();
+	if (!frames)
+	{
+		return;
+	}
+
+	/* Splitting the main thread's time per frame */
+	//Pushing a frame to the writers is part of collecting it, so the time spent waiting for them is taken out
+	double frameMs = totalMs / frames;
+	double gpuWaitMs = m_gpuWaitMsSum / frames;
+	double writerWaitMs = m_frameWriter.GetBlockedMs() / frames;
+	double readbackMs = m_readbackMsSum / frames - writerWaitMs;
+	double cpuMs = frameMs - gpuWaitMs - writerWaitMs - readbackMs;
+	/* Time split */
+
+	//Whatever the main thread waited on the most is what limits the frame rate
+	const char* bottleneck = "CPU recording";
+	double bottleneckMs = cpuMs;
+	if (gpuWaitMs > bottleneckMs)
+	{
+		bottleneck = "GPU";
+		bottleneckMs = gpuWaitMs;
+	}
+	if (readbackMs > bottleneckMs)
+	{
+		bottleneck = "readback";
+		bottleneckMs = readbackMs;
+	}
+	if (writerWaitMs > bottleneckMs)
+	{
+		bottleneck = "disk";
+	}
+
+	double gpuFrameMs = 0.0;
+	for (const GpuProfileScopeResult& scope : m_gpuProfiler.GetLatestFrame().scopes)
+	{
+		if (scope.name == "Frame")
+		{
+			gpuFrameMs = scope.gpuTimeMs;
+		}
+	}
+
+	const FrameWriterSettings& settings = m_frameWriter.GetSettings();
+	std::cout << "Batch : " << frames << " frames in " << totalMs / 1000.0 << " s, " << frames * 1000.0 / totalMs
+		<< " frames/s\n";
+	std::cout << "  Per frame : " << gpuWaitMs << " ms waiting for the GPU (" << gpuFrameMs << " ms GPU time), " << readbackMs
+		<< " ms reading back, " << writerWaitMs << " ms waiting for the writers, " << cpuMs << " ms recording\n";
+	std::cout << "  Writers : " << m_frameWriter.GetWriteMs() / frames << " ms per frame over " << settings.threadCount
+		<< " threads\n";
+	std::cout << "  Bottleneck : " << bottleneck << '\n';
+	if (settings.format == FrameWriterFormat::Raw)
+	{
+		VkExtent2D extent = GetRenderExtent();
+		VkFormat format = m_windows[0].swapchain.GetSwapchainImageFormat();
+		std::cout << "  Raw frames are " << extent.width << 'x' << extent.height << ' '
+			<< (format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM ? "bgra" : "rgba") << '\n';
+	}
+}
+
+VkExtent2D VulkanTriangle::GetRenderExtent() const
+{
+	if (IsBatchMode())
+	{
+		return { BATCH_FRAME_WIDTH, BATCH_FRAME_HEIGHT };
+	}
+	return m_windows[0].swapchain.GetSwapchainExtent();
+}
+
+bool VulkanTriangle::IsAnyWindowClosing() const
+{
+	for (const PresentWindow& presentWindow : m_windows)
+	{
+		if (presentWindow.window.CheckIfWindowShouldClose())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void VulkanTriangle::CheckTraceCaptureKey()
+{
+	bool traceKeyPressed = m_windows[0].window.IsKeyPressed(TRACE_CAPTURE_KEY);
+	if (traceKeyPressed && !m_traceKeyWasPressed)
+	{
+		if (TraceRecorder::Get().IsCapturing())
+		{
+			TraceRecorder::Get().EndCapture();
+			std::cout << "Trace written to " << TRACE_CAPTURE_FILENAME << '\n';
+		}
+		else
+		{
+			TraceRecorder::Get().BeginCapture(TRACE_CAPTURE_FILENAME);
+		}
+	}
+	m_traceKeyWasPressed = traceKeyPressed;
+}
+
+void VulkanTriangle::CheckFrameCaptureKey()
+{
+	bool captureKeyPressed = m_windows[0].window.IsKeyPressed(FRAME_CAPTURE_KEY);
+	if (captureKeyPressed && !m_frameCaptureKeyWasPressed)
+	{
+		if (m_frameCapture.IsCapturing())
+		{
+			m_frameCapture.SetCapturing(false);
+			std::cout << "Frame capture stopped, " << m_frameCapture.GetCapturedFrameCount() << " frames captured, "
+				<< m_frameWriter.GetDroppedFrameCount() << " dropped by the writer\n";
+		}
+		else if (!m_frameCapture.IsCreated())
+		{
+			std::cout << "Frame capture is not available, the swapchain images cannot be copied\n";
+		}
+		else
+		{
+			//The writer only runs once the first capture starts, and keeps running until shutdown
+			if (!m_frameWriter.IsRunning())
+			{
+				FrameWriterSettings settings;
+				settings.path = FRAME_CAPTURE_DIRECTORY;
+				m_frameWriter.Start(settings);
+			}
+			m_frameCapture.SetCapturing(true);
+			std::cout << "Capturing frames to " << FRAME_CAPTURE_DIRECTORY << '\n';
+		}
+	}
+	m_frameCaptureKeyWasPressed = captureKeyPressed;
+}
+
+void VulkanTriangle::GetSceneSphere(Vec3& center, float& radius) const
+{
+	center = Vec3{};
+	radius = 1.0f;
+	if (!m_sceneMesh.IsLoaded())
+	{
+		return;
+	}
+
+	const MeshBounds& bounds = m_sceneMesh.GetBounds();
+	Vec3 boundsMin = { bounds.min[0], bounds.min[1], bounds.min[2] };
+	Vec3 boundsMax = { bounds.max[0], bounds.max[1], bounds.max[2] };
+	center = (boundsMin + boundsMax) * 0.5f;
+	radius = Length(boundsMax - boundsMin) * 0.5f;
+	if (radius <= 0.0f)
+	{
+		radius = 1.0f;
+	}
+}
+
+void VulkanTriangle::ConfigureParticleEmitter()
+{
+	Vec3 center;
+	float radius;
+	GetSceneSphere(center, radius);
+
+	//Particles rise about one radius above the top of the scene in the first second, then fall past it
+	ParticleEmitterSettings emitter;
+	emitter.position = center + Vec3{ 0.0f, radius, 0.0f };
+	emitter.lifetime = SCENE_PARTICLE_LIFETIME;
+	emitter.speed = radius * 2.0f;
+	emitter.gravity = { 0.0f, -radius * 2.0f, 0.0f };
+	if (m_options.particleStress)
+	{
+		//Emitting faster than particles die keeps the pool full, the GPU stops emitting once no particle is free
+		emitter.radius = radius * 0.5f;
+		emitter.emitRate = 2.0f * PARTICLE_STRESS_COUNT / SCENE_PARTICLE_LIFETIME;
+		emitter.sizePixels = 1.0f;
+	}
+	else
+	{
+		emitter.radius = radius * 0.05f;
+		emitter.emitRate = SCENE_PARTICLE_COUNT / SCENE_PARTICLE_LIFETIME;
+		emitter.sizePixels = 3.0f;
+	}
+	m_particleSystem.SetEmitter(emitter);
+}
+
+bool VulkanTriangle::CheckMultiviewSupport() const
+{
+	if (!m_vulkanDevice.IsMultiviewEnabled())
+	{
+		std::cout << "Multiview is not supported by the device, rendering a single view\n";
+		return false;
+	}
+	if (m_options.multiviewCount > m_vulkanDevice.GetMaxMultiviewViewCount())
+	{
+		std::cout << "The device renders at most " << m_vulkanDevice.GetMaxMultiviewViewCount()
+			<< " views with multiview, rendering a single view\n";
+		return false;
+	}
+
+	//The views are blitted into the presented images, batch mode's offscreen images can always be blitted to
+	if (!IsBatchMode())
+	{
+		for (const PresentWindow& presentWindow : m_windows)
+		{
+			SwapchainSupportDetails details = m_vulkanDevice.QuerySurfaceSupportDetails(
+				presentWindow.surface.GetVulkanSDKSurface());
+			if (!(details.surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+			{
+				std::cout << "A window's images cannot be blitted to, rendering a single view\n";
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+Mat4 VulkanTriangle::ComputeMeshViewProjection(Vec3& eyePosition, Mat4* viewProjections) const
+{
+	//Without a mesh the camera orbits the unit sphere, so the particles still have a camera to be drawn from
+	Vec3 center;
+	float radius;
+	GetSceneSphere(center, radius);
+
+	//The camera slowly moves out and back in while it orbits, so the mesh is seen at every detail level
+	float zoom = 0.5f - 0.5f * std::cos(m_sceneSeconds * SCENE_CAMERA_ZOOM_SPEED);
+	float distance = radius * (SCENE_CAMERA_DISTANCE + zoom * (SCENE_CAMERA_FAR_DISTANCE - SCENE_CAMERA_DISTANCE));
+	float angle = m_sceneSeconds * SCENE_CAMERA_ORBIT_SPEED;
+	eyePosition = center + Vec3{ std::sin(angle) * distance, radius * 0.5f, std::cos(angle) * distance };
+
+	const Vec3 up = { 0.0f, 1.0f, 0.0f };
+	uint32_t viewCount = m_options.multiviewCount;
+	VkExtent2D extent = viewCount != 0 ? m_multiviewTargets.GetViewExtent() : GetRenderExtent();
+	float aspectRatio = static_cast<float>(extent.width) / static_cast<float>(extent.height);
+	if (viewCount == 0)
+	{
+		Mat4 projection = Perspective(SCENE_CAMERA_FOV, aspectRatio, radius * 0.01f, distance + radius * 2.0f);
+		return projection * LookAt(eyePosition, center, up);
+	}
+
+	/* Placing the views */
+	//The views look in parallel from a line through the camera, the way a pair of eyes does
+	Vec3 forward = Normalize(center - eyePosition);
+	Vec3 right = Normalize(Cross(forward, up));
+	float separation = radius * MULTIVIEW_VIEW_SEPARATION;
+	float halfSpan = 0.5f * static_cast<float>(viewCount - 1) * separation;
+	Mat4 projection = Perspective(SCENE_CAMERA_FOV, aspectRatio, radius * 0.01f, distance + radius * 2.0f);
+	for (uint32_t i = 0; i < viewCount; ++i)
+	{
+		Vec3 offset = right * (static_cast<float>(i) * separation - halfSpan);
+		viewProjections[i] = projection * LookAt(eyePosition + offset, center + offset, up);
+	}
+	/* Views placed */
+
+	//Backed up far enough for its horizontal field of view to reach the outermost views, with the far plane
+	//pushed out by the same amount, the culling frustum holds every view's
+	float backOffset = halfSpan / (std::tan(SCENE_CAMERA_FOV * 0.5f) * aspectRatio);
+	Mat4 cullProjection = Perspective(SCENE_CAMERA_FOV, aspectRatio, radius * 0.01f,
+		distance + backOffset + radius * 2.0f);
+	return cullProjection * LookAt(eyePosition - forward * backOffset, center, up);
+}
+
+void VulkanTriangle::LogMeshStatistics() const
+{
+	if (!m_sceneMesh.IsLoaded())
+	{
+		return;
+	}
+
+	std::cout << "  Mesh LODs : " << m_drawnMeshTriangles << " of " << m_sceneMesh.GetFullTriangleCount()
+		<< " triangles\n";
+
+	//A cascade is only rendered again when its fit changed, a still camera renders none
+	if (m_shadowCascades.IsCreated())
+	{
+		std::cout << "  Shadow cascades : " << m_shadowCascades.GetRenderedCascadeCount() << " of " << SHADOW_CASCADE_COUNT
+			<< " rendered\n";
+	}
+
+	//Every vertex shader invocation fetches one whole vertex, the post transform cache already removed the repeats
+	for (const GpuProfileScopeResult& scope : m_gpuProfiler.GetLatestFrame().scopes)
+	{
+		if (scope.hasPipelineStatistics && scope.name == "MainPass")
+		{
+			uint64_t invocations = scope.statistics.vertexShaderInvocations;
+			std::cout << "  Mesh vertex fetch : " << invocations * m_sceneMesh.GetVertexStride() / 1024 << " KB at "
+				<< m_sceneMesh.GetVertexStride() << " bytes per vertex (" << invocations * sizeof(MeshVertex) / 1024
+				<< " KB unpacked)\n";
+		}
+	}
+}
+
+void VulkanTriangle::LogFrameMemoryStatistics() const
+{
+	//Once the frames have warmed up the arena should not overflow and the heap should not be touched at all
+	const FrameArenaStatistics& statistics = FrameArena::Get().GetLastFrameStatistics();
+	std::cout << "  Frame arena : " << statistics.allocationCount << " allocations, " << statistics.allocatedBytes / 1024
+		<< " KB, " << statistics.overflowCount << " overflows\n";
+#ifdef HEAP_COUNTER_ENABLED
+	std::cout << "  Heap : " << statistics.heapAllocations << " allocations, " << statistics.heapFrees << " frees\n";
+#endif
+}
+
+void VulkanTriangle::LogParticleStressStatistics()
+{
+	//The simulation passes have a scope of their own, the particles' draw is part of the main pass
+	double simulationGpuMs = 0.0;
+	double frameGpuMs = 0.0;
+	for (const GpuProfileScopeResult& scope : m_gpuProfiler.GetLatestFrame().scopes)
+	{
+		if (scope.name == "Particles")
+		{
+			simulationGpuMs = scope.gpuTimeMs;
+		}
+		else if (scope.name == "Frame")
+		{
+			frameGpuMs = scope.gpuTimeMs;
+		}
+	}
+
+	double recordingMs = m_recordedFrames ? m_recordingMsSum / m_recordedFrames : 0.0;
+	std::cout << "Particle stress : " << m_particleSystem.GetMaxParticles() << " particles, simulation " << simulationGpuMs
+		<< " ms and frame " << frameGpuMs << " ms on the GPU, recording " << recordingMs << " ms on the CPU\n";
+	m_recordingMsSum = 0.0;
+	m_recordedFrames = 0;
+}
+
+void VulkanTriangle::BuildOverlay(float deltaSeconds)
+{
+	if (!m_overlay.IsCreated())
+	{
+		return;
+	}
+
+	TRACE_SCOPE("BuildOverlay");
+	auto buildStart = std::chrono::steady_clock::now();
+	m_overlay.Begin();
+
+	double frameGpuMs = 0.0;
+	for (const GpuProfileScopeResult& scope : m_gpuProfiler.GetLatestFrame().scopes)
+	{
+		if (scope.name == "Frame")
+		{
+			frameGpuMs = scope.gpuTimeMs;
+		}
+	}
+
+	/* Adding the statistics panel */
+	//The culling of this frame has not started yet, so the mesh still holds the detail levels the last frame drew,
+	//as do the cascades and the overlay
+	const uint32_t textColor = PackOverlayColor(0.9f, 0.95f, 1.0f, 1.0f);
+	const float lineHeight = HUD_TEXT_HEIGHT * GLYPH_LINE_HEIGHT_UNITS / GLYPH_CAP_HEIGHT_UNITS;
+	float textX = HUD_MARGIN * 2.0f;
+	float textY = HUD_MARGIN * 2.0f;
+	float panelWidth = 0.0f;
+	char line[128];
+
+	std::snprintf(line, sizeof(line), "CPU frame %.2f ms", deltaSeconds * 1000.0f);
+	panelWidth = std::max(panelWidth, m_overlay.AddText(textX, textY, HUD_TEXT_HEIGHT, line, textColor));
+	textY += lineHeight;
+	std::snprintf(line, sizeof(line), "GPU frame %.2f ms", frameGpuMs);
+	panelWidth = std::max(panelWidth, m_overlay.AddText(textX, textY, HUD_TEXT_HEIGHT, line, textColor));
+	textY += lineHeight;
+	if (m_sceneMesh.IsLoaded())
+	{
+		std::snprintf(line, sizeof(line), "Triangles %llu",
+			static_cast<unsigned long long>(m_drawnMeshTriangles));
+		panelWidth = std::max(panelWidth, m_overlay.AddText(textX, textY, HUD_TEXT_HEIGHT, line, textColor));
+		textY += lineHeight;
+	}
+	if (m_shadowCascades.IsCreated())
+	{
+		std::snprintf(line, sizeof(line), "Shadow cascades %u of %u", m_shadowCascades.GetRenderedCascadeCount(),
+			SHADOW_CASCADE_COUNT);
+		panelWidth = std::max(panelWidth, m_overlay.AddText(textX, textY, HUD_TEXT_HEIGHT, line, textColor));
+		textY += lineHeight;
+	}
+	std::snprintf(line, sizeof(line), "Overlay %u quads in %u draws", m_overlay.GetFlushedQuadCount(),
+		m_overlay.GetFlushedDrawCount());
+	panelWidth = std::max(panelWidth, m_overlay.AddText(textX, textY, HUD_TEXT_HEIGHT, line, textColor));
+	textY += lineHeight;
+
+	//Added after the text it holds, the sprites are still drawn behind it. The light in its corner pulses once a second
+	float panelHeight = textY - lineHeight + HUD_TEXT_HEIGHT + HUD_MARGIN;
+	m_overlay.AddSprite(HUD_MARGIN, HUD_MARGIN, panelWidth + HUD_MARGIN * 2.0f, panelHeight,
+		OverlaySprite::RoundedBox, PackOverlayColor(0.05f, 0.08f, 0.12f, 0.75f));
+	float pulse = 0.5f + 0.5f * std::sin(m_sceneSeconds * 6.2831853f);
+	m_overlay.AddSprite(panelWidth + HUD_MARGIN * 2.0f, HUD_MARGIN * 0.5f, HUD_MARGIN * 2.0f, HUD_MARGIN * 2.0f,
+		OverlaySprite::Glow, PackOverlayColor(0.2f, 1.0f, 0.4f, 0.5f + 0.5f * pulse), OverlayBlend::Additive);
+	/* Statistics panel added */
+
+	/* Adding the streamed texture */
+	if (m_hudTextureId != TEXTURE_STREAMING_INVALID_ID)
+	{
+		//The texture grows and shrinks in the bottom right corner, and the mip its size on screen needs is the
+		//streamer's usage feedback. It is drawn from whatever mips are resident until the finer ones arrive
+		VkExtent2D extent = GetRenderExtent();
+		float largest = std::max(std::min(extent.width, extent.height) * 0.5f, HUD_TEXTURE_MIN_PIXELS);
+		float size = HUD_TEXTURE_MIN_PIXELS + (largest - HUD_TEXTURE_MIN_PIXELS) * (0.5f - 0.5f * std::cos(m_sceneSeconds * 0.5f));
+		m_textureStreamer.RequestMip(m_hudTextureId, m_textureStreamer.ComputeMipForScreenSize(m_hudTextureId, size),
+			size / largest);
+		m_overlay.SetImage(extent.width - HUD_MARGIN - size, extent.height - HUD_MARGIN - size, size, size,
+			m_textureStreamer.GetImageView(m_hudTextureId), m_textureStreamer.GetVulkanSDKSampler(),
+			PackOverlayColor(1.0f, 1.0f, 1.0f, 1.0f));
+
+		//Drawn under the texture, which is usually sharp by the time a mip finer than needed would show
+		std::snprintf(line, sizeof(line), "Texture mip %u, %llu KB resident", m_textureStreamer.GetResidentMip(m_hudTextureId),
+			static_cast<unsigned long long>(m_textureStreamer.GetResidentBytes() / 1024));
+		m_overlay.AddText(extent.width - HUD_MARGIN - size, extent.height - HUD_MARGIN - size - HUD_TEXT_HEIGHT * 1.5f,
+			HUD_TEXT_HEIGHT, line, textColor);
+	}
+	/* Streamed texture added */
+
+	/* Adding the stress scene */
+	if (m_options.hudStress)
+	{
+		//Columns of small text fill the frame below the panel, and what does not fit is clipped by the rasterizer
+		VkExtent2D extent = GetRenderExtent();
+		const float stressHeight = HUD_TEXT_HEIGHT * 0.5f;
+		const float stressLineHeight = stressHeight * GLYPH_LINE_HEIGHT_UNITS / GLYPH_CAP_HEIGHT_UNITS;
+		const float stressTop = HUD_MARGIN * 2.0f + panelHeight;
+		uint32_t linesPerColumn = std::max(static_cast<uint32_t>((extent.height - stressTop) / stressLineHeight), 1u);
+		float columnX = HUD_MARGIN;
+		float columnWidth = 0.0f;
+		for (uint32_t i = 0; i < HUD_STRESS_TEXT_LINES; ++i)
+		{
+			if (i != 0 && i % linesPerColumn == 0)
+			{
+				columnX += columnWidth + HUD_MARGIN;
+				columnWidth = 0.0f;
+			}
+			std::snprintf(line, sizeof(line), "Line %04u the quick brown fox jumps over the lazy dog", i);
+			columnWidth = std::max(columnWidth, m_overlay.AddText(columnX, stressTop + (i % linesPerColumn) * stressLineHeight,
+				stressHeight, line, PackOverlayColor(0.6f, 0.8f, 1.0f, 0.8f)));
+		}
+
+		//The glows orbit the center of the frame on curves of their own, so they overlap and their light adds up
+		float centerX = extent.width * 0.5f;
+		float centerY = extent.height * 0.5f;
+		float size = HUD_MARGIN * 3.0f;
+		for (uint32_t i = 0; i < HUD_STRESS_GLOW_SPRITES; ++i)
+		{
+			float phase = static_cast<float>(i) / HUD_STRESS_GLOW_SPRITES * 6.2831853f;
+			float x = centerX + centerX * 0.8f * std::sin(phase * 3.0f + m_sceneSeconds);
+			float y = centerY + centerY * 0.8f * std::cos(phase * 2.0f + m_sceneSeconds * 0.7f);
+			m_overlay.AddSprite(x - size * 0.5f, y - size * 0.5f, size, size, OverlaySprite::Glow,
+				PackOverlayColor(0.5f + 0.5f * std::sin(phase), 0.3f, 0.5f + 0.5f * std::cos(phase), 0.25f),
+				OverlayBlend::Additive);
+		}
+	}
+	/* Stress scene added */
+
+	m_overlay.Flush(m_vulkanDevice.GetVulkanSDKLogicalDevice(), m_currentFrame);
+	m_overlayBuildMsSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+	++m_overlayBuiltFrames;
+}
+
+void VulkanTriangle::LogOverlayStressStatistics()
+{
+	double overlayGpuMs = 0.0;
+	for (const GpuProfileScopeResult& scope : m_gpuProfiler.GetLatestFrame().scopes)
+	{
+		if (scope.name == "Overlay")
+		{
+			overlayGpuMs += scope.gpuTimeMs;
+		}
+	}
+
+	double buildMs = m_overlayBuiltFrames ? m_overlayBuildMsSum / m_overlayBuiltFrames : 0.0;
+	std::cout << "Overlay stress : " << m_overlay.GetFlushedQuadCount() << " quads in " << m_overlay.GetFlushedDrawCount()
+		<< " draws, " << m_overlay.GetDroppedQuadCount() << " dropped, building " << buildMs << " ms on the CPU and drawing "
+		<< overlayGpuMs << " ms on the GPU\n";
+	m_overlayBuildMsSum = 0.0;
+	m_overlayBuiltFrames = 0;
+}
+
+/*******************************************************************************
+* Function Argument 1: The texture file to write, its directory is created	   *
+*******************************************************************************/
+bool VulkanTriangle::WriteHudTextureFile(const std::string& filename)
+{
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+	if (!directory.empty())
+	{
+		std::filesystem::create_directories(directory, error);
+	}
+
+	//Fine grid lines over a checkerboard over a gradient: the lines blur away in the coarser mips and then the
+	//checkerboard does, so the resident mip shows on screen
+	std::vector<uint8_t> pixels(static_cast<size_t>(HUD_TEXTURE_SIZE) * HUD_TEXTURE_SIZE * 4);
+	for (uint32_t y = 0; y < HUD_TEXTURE_SIZE; ++y)
+	{
+		for (uint32_t x = 0; x < HUD_TEXTURE_SIZE; ++x)
+		{
+			uint8_t* pixel = &pixels[(static_cast<size_t>(y) * HUD_TEXTURE_SIZE + x) * 4];
+			bool gridLine = x % 16 == 0 || y % 16 == 0;
+			bool darkCell = ((x / 128) + (y / 128)) % 2 == 0;
+			float shade = gridLine ? 1.0f : (darkCell ? 0.35f : 0.75f);
+			pixel[0] = static_cast<uint8_t>(shade * (64 + x * 191 / HUD_TEXTURE_SIZE));
+			pixel[1] = static_cast<uint8_t>(shade * (64 + y * 191 / HUD_TEXTURE_SIZE));
+			pixel[2] = static_cast<uint8_t>(shade * 200);
+			pixel[3] = 255;
+		}
+	}
+	return WriteTextureFile(filename, HUD_TEXTURE_SIZE, HUD_TEXTURE_SIZE, pixels.data());
+}
+
+void VulkanTriangle::UpdateLightBenchmark()
+{
+	//Every step has run once the next count would be more lights than there are
+	uint32_t lightCount = LIGHT_BENCHMARK_FIRST_COUNT << m_lightBenchmarkStep;
+	if (!m_options.lightBenchmark || !m_clusteredLighting.IsCreated() || lightCount > m_clusteredLighting.GetLightCount())
+	{
+		return;
+	}
+
+	//The latest profiled frame was recorded a few frames ago, the warm up leaves out the ones of the previous step
+	const GpuProfileFrame& frame = m_gpuProfiler.GetLatestFrame();
+	if (frame.valid && m_lightBenchmarkFrames >= LIGHT_BENCHMARK_WARMUP_FRAMES)
+	{
+		//Every window has a main pass of its own, the lit pixels of all of them count
+		for (const GpuProfileScopeResult& scope : frame.scopes)
+		{
+			if (scope.name == "LightBinning")
+			{
+				m_lightBinningMsSum += scope.gpuTimeMs;
+			}
+			else if (scope.name == "MainPass")
+			{
+				m_lightMainPassMsSum += scope.gpuTimeMs;
+			}
+			else if (scope.name == "Frame")
+			{
+				m_lightFrameMsSum += scope.gpuTimeMs;
+			}
+		}
+		++m_lightBenchmarkSamples;
+	}
+
+	if (++m_lightBenchmarkFrames < LIGHT_BENCHMARK_STEP_FRAMES)
+	{
+		return;
+	}
+
+	double samples = m_lightBenchmarkSamples ? static_cast<double>(m_lightBenchmarkSamples) : 1.0;
+	std::cout << "Light benchmark : " << lightCount << " lights, binning " << m_lightBinningMsSum / samples
+		<< " ms, main pass " << m_lightMainPassMsSum / samples << " ms and frame " << m_lightFrameMsSum / samples
+		<< " ms on the GPU\n";
+
+	m_lightBenchmarkFrames = 0;
+	m_lightBenchmarkSamples = 0;
+	m_lightBinningMsSum = 0.0;
+	m_lightMainPassMsSum = 0.0;
+	m_lightFrameMsSum = 0.0;
+	++m_lightBenchmarkStep;
+	if ((LIGHT_BENCHMARK_FIRST_COUNT << m_lightBenchmarkStep) > m_clusteredLighting.GetLightCount())
+	{
+		std::cout << "Light benchmark done\n";
+		return;
+	}
+	m_clusteredLighting.SetActiveLightCount(LIGHT_BENCHMARK_FIRST_COUNT << m_lightBenchmarkStep);
+}
+
+/*******************************************************************************
+* Function Argument 1: The index of the window whose swapchain was reported out *
+*					   of date or suboptimal									*
+*******************************************************************************/
+void VulkanTriangle::RecreateWindowSwapchain(uint32_t windowIndex)
+{
+	PresentWindow& presentWindow = m_windows[windowIndex];
+	presentWindow.window.WaitWhileMinimized();
+
+	//Every frame in flight may still render into or present the old images, and this is rare enough to simply wait
+	const VkDevice& device = m_vulkanDevice.GetVulkanSDKLogicalDevice();
+	vkDeviceWaitIdle(device);
+
+	/* Destroying the window's swapchain and everything sized from it */
+	presentWindow.framebuffers.Cleanup(device);
+	if (m_options.deferred)
+	{
+		presentWindow.gbuffer.Cleanup(device);
+	}
+	else
+	{
+		presentWindow.depthBuffer.Cleanup(device);
+	}
+	presentWindow.imageViews.Cleanup(device);
+	presentWindow.swapchain.Cleanup(device);
+	/* Window's swapchain destroyed */
+
+	/* Creating them again in the order the startup stages do */
+	VkExtent2D oldExtent = GetRenderExtent();
+	presentWindow.swapchain.CreateSwapchain(presentWindow.surface.GetVulkanSDKSurface(), m_vulkanDevice,
+		presentWindow.window);
+	if (presentWindow.swapchain.GetSwapchainImageFormat() != m_windows[0].swapchain.GetSwapchainImageFormat())
+	{
+		__debugbreak();
+	}
+	presentWindow.imageViews.CreateImageViews(presentWindow.swapchain, device);
+	if (m_options.deferred)
+	{
+		presentWindow.gbuffer.CreateGBuffer(m_vulkanDevice, presentWindow.swapchain.GetSwapchainExtent(),
+			m_vulkanPipeline.GetVulkanSDKGBufferSetLayout());
+	}
+	else
+	{
+		presentWindow.depthBuffer.CreateDepthBuffer(m_vulkanDevice, presentWindow.swapchain.GetSwapchainExtent());
+	}
+	CreateWindowFramebuffers(presentWindow);
+	/* Window's swapchain created */
+
+	//The readback buffers are sized for the primary window's images, so they follow it if its size changed. The frames
+	//already copied out are handed over first
+	VkExtent2D newExtent = GetRenderExtent();
+	if (windowIndex == 0 && m_frameCapture.IsCreated() &&
+		(newExtent.width != oldExtent.width || newExtent.height != oldExtent.height))
+	{
+		bool capturing = m_frameCapture.IsCapturing();
+		m_frameCapture.CollectAllFrames();
+		m_frameCapture.Cleanup(device);
+		m_frameCapture.CreateFrameCapture(m_vulkanDevice, newExtent, presentWindow.swapchain.GetSwapchainImageFormat(),
+			m_framesInFlight);
+		m_frameCapture.SetCapturing(capturing);
+	}
+}
+
+/***********************************************************************
+* Function Argument 1: The window whose image views and depth buffer or *
+*					   G-buffer have been created						*
+***********************************************************************/
+void VulkanTriangle::CreateWindowFramebuffers(PresentWindow& presentWindow)
+{
+	const VkRenderPass& vk_renderPass = m_options.deferred ? m_vulkanPipeline.GetVulkanSDKDeferredRenderPass() :
+		m_vulkanPipeline.GetVulkanSDKRenderPass();
+	presentWindow.framebuffers.CreateFramebuffers(presentWindow.imageViews.GetVulkanSDKImageViews(),
+		m_options.deferred ? presentWindow.gbuffer.GetVulkanSDKImageViews() :
+		std::vector<VkImageView>{ presentWindow.depthBuffer.GetVulkanSDKImageView() }, vk_renderPass,
+		presentWindow.swapchain.GetSwapchainExtent(), m_vulkanDevice.GetVulkanSDKLogicalDevice());
 }
 
 void VulkanTriangle::DrawFrame()
 {
-	//Waiting for the previous frame and reseting the fence when we get the signal
-	vkWaitForFences(m_vulkanDevice.GetVulkanSDKLogicalDevice(), 1, &m_vulkanSyncObjects.vk_inFlightFence,
-		VK_TRUE, UINT64_MAX);
-	vkResetFences(m_vulkanDevice.GetVulkanSDKLogicalDevice(), 1, &m_vulkanSyncObjects.vk_inFlightFence);
+	TRACE_SCOPE("DrawFrame");
 
-	//We'll need an image index to give to the present queue later
-	uint32_t imageIndex;
-	vkAcquireNextImageKHR(m_vulkanDevice.GetVulkanSDKLogicalDevice(), m_vulkanSwapchain.GetVulkanSDKSwapchain(),
-		UINT64_MAX, m_vulkanSyncObjects.vk_imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+	//Waiting for the last frame that used this frame's resources
+	{
+		TRACE_SCOPE("WaitForFrame");
+		auto waitStart = std::chrono::steady_clock::now();
+		m_vulkanSyncObjects.WaitForFrame(m_vulkanDevice.GetVulkanSDKLogicalDevice(), m_currentFrame);
+		m_gpuWaitMsSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+	}
 
-	//Resetting the command buffer and recording it
-	vkResetCommandBuffer(m_vulkanCommandBuffer.GetVulkanSDKCommandBuffer(), 0);
-	m_vulkanCommandBuffer.RecordCommandBuffer(m_vulkanSwapchain, m_vulkanPipeline, m_vulkanFramebuffers, imageIndex);
+	//Everything released before this frame slot was last submitted is no longer used by the GPU
+	m_deletionQueue.DestroyFrame(m_vulkanDevice.GetVulkanSDKLogicalDevice(), m_currentFrame);
 
-	//Create the submit info needed to submit the queue
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	//Pipelines rebuilt by the hot reload thread replace the old ones before this frame records, the old ones stay
+	//alive for the frames still in flight
+	m_vulkanPipeline.SwapRebuiltPipelines(m_deletionQueue);
 
-	//Specifying that an image should become available before executing color attachment
-	VkSemaphore waitSemaphores[] = { m_vulkanSyncObjects.vk_imageAvailableSemaphore };
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
+	//Every job of the last frame has finished and so has the GPU work of this slot, its transient memory is free again
+	FrameArena::Get().BeginFrame(m_currentFrame);
 
-	//Passing the command buffer which has already been recorded
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &m_vulkanCommandBuffer.GetVulkanSDKCommandBuffer();
+	//The copy this slot's last submit made is complete, and has to be taken before this frame records a new one
+	auto readbackStart = std::chrono::steady_clock::now();
+	m_frameCapture.CollectFrame(m_currentFrame);
+	m_readbackMsSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readbackStart).count();
 
-	//Specifying that a signal should be sent that render has finished once the queue is done
-	VkSemaphore signalSemaphores[] = { m_vulkanSyncObjects.vk_renderFinishedSemaphore };
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = signalSemaphores;
+	//The frame's fence has signalled, so its profiler results can be read without waiting
+	m_gpuProfiler.ResolveFrame(m_vulkanDevice.GetVulkanSDKLogicalDevice(), m_currentFrame);
+#ifdef _DEBUG
+	if (m_gpuProfiler.GetLatestFrame().valid && 
+		m_gpuProfiler.GetLatestFrame().frameNumber % GPU_PROFILER_LOG_INTERVAL == 0)
+	{
+		m_gpuProfiler.LogFrame(std::cout);
+		LogMeshStatistics();
+		LogFrameMemoryStatistics();
+	}
+#endif
+	if (m_options.particleStress && m_gpuProfiler.GetLatestFrame().valid &&
+		m_gpuProfiler.GetLatestFrame().frameNumber % GPU_PROFILER_LOG_INTERVAL == 0)
+	{
+		LogParticleStressStatistics();
+	}
+	if (m_options.hudStress && m_overlay.IsCreated() && m_gpuProfiler.GetLatestFrame().valid &&
+		m_gpuProfiler.GetLatestFrame().frameNumber % GPU_PROFILER_LOG_INTERVAL == 0)
+	{
+		LogOverlayStressStatistics();
+	}
+	UpdateLightBenchmark();
 
-	vkQueueSubmit(m_vulkanDevice.GetVulkanSDKGraphicsQueue(), 1, &submitInfo, m_vulkanSyncObjects.vk_inFlightFence);
+	//The particles move by the time since the last frame started, and the GPU moves them while the frame is recorded.
+	//Batch frames are spaced by a fixed step instead, so the sequence is the same however fast it renders
+	auto frameTime = std::chrono::steady_clock::now();
+	float deltaSeconds = std::chrono::duration<float>(frameTime - m_lastFrameTime).count();
+	if (IsBatchMode())
+	{
+		deltaSeconds = 1.0f / BATCH_FRAME_RATE;
+		m_sceneSeconds += deltaSeconds;
+	}
+	else
+	{
+		m_sceneSeconds = std::chrono::duration<float>(frameTime - m_startTime).count();
+	}
+	//The light benchmark holds the camera still, so every light count is measured from the same view
+	if (m_options.lightBenchmark)
+	{
+		m_sceneSeconds = 0.0f;
+	}
+	m_particleSystem.Update(deltaSeconds);
+	m_lastFrameTime = frameTime;
+	BuildOverlay(deltaSeconds);
+
+	/* Culling the mesh from where the camera is this frame */
+	//The detail levels are picked from the center of the views, which are all about as far from the mesh
+	Mat4 viewProjections[MULTIVIEW_MAX_VIEWS];
+	m_meshView.viewProjection = ComputeMeshViewProjection(m_meshView.cameraPosition, viewProjections);
+	if (m_multiviewTargets.IsCreated())
+	{
+		m_multiviewTargets.WriteViewMatrices(m_currentFrame, viewProjections, m_multiviewTargets.GetViewCount());
+	}
+	ExtractFrustumPlanes(m_meshView.viewProjection, m_meshView.frustumPlanes);
+	if (m_clusteredLighting.IsCreated() || m_shadowCascades.IsCreated())
+	{
+		//The depth slices of the clusters and the cascades only span the scene sphere, which holds the mesh and every
+		//light, so none are spent on the empty space in front of it
+		Vec3 center;
+		float radius;
+		GetSceneSphere(center, radius);
+		float eyeDistance = Length(m_meshView.cameraPosition - center);
+		VkExtent2D extent = GetRenderExtent();
+		float aspectRatio = static_cast<float>(extent.width) / static_cast<float>(extent.height);
+		float nearPlane = std::max(eyeDistance - radius, radius * 0.01f);
+		float farPlane = eyeDistance + radius;
+		if (m_clusteredLighting.IsCreated())
+		{
+			m_clusteredLighting.Update(m_currentFrame, LookAt(m_meshView.cameraPosition, center, { 0.0f, 1.0f, 0.0f }),
+				SCENE_CAMERA_FOV, aspectRatio, nearPlane, farPlane);
+		}
+		if (m_shadowCascades.IsCreated())
+		{
+			ShadowViewParameters shadowView;
+			shadowView.cameraPosition = m_meshView.cameraPosition;
+			shadowView.cameraTarget = center;
+			shadowView.verticalFov = SCENE_CAMERA_FOV;
+			shadowView.aspectRatio = aspectRatio;
+			shadowView.nearPlane = nearPlane;
+			shadowView.farPlane = farPlane;
+			shadowView.sceneCenter = center;
+			shadowView.sceneRadius = radius;
+			m_shadowCascades.Update(m_currentFrame, shadowView, m_sceneMesh);
+		}
+	}
+	m_meshView.projectionScale = GetRenderExtent().height / (2.0f * std::tan(SCENE_CAMERA_FOV * 0.5f));
+	m_meshView.errorThresholdPixels = MESH_LOD_ERROR_THRESHOLD_PIXELS;
+
+	//The submeshes are split across the workers, each range picks the visibility and detail levels of its own submeshes.
+	//The visibility and the lists built from it only live for the frame, so they come from the frame arena
+	JobSystem& jobSystem = JobSystem::Get();
+	uint32_t submeshCount = m_sceneMesh.IsLoaded() ? static_cast<uint32_t>(m_sceneMesh.GetSubmeshes().size()) : 0;
+	FrameVector<uint8_t> visibleSubmeshes(submeshCount, 0);
+	FrameDrawList drawList;
+	Job* cullJob = jobSystem.CreateParallelForJob(submeshCount, MESH_CULLING_BATCH_SIZE,
+		[this, &visibleSubmeshes](uint32_t begin, uint32_t end)
+	{
+		m_sceneMesh.CullAndSelectLods(m_meshView, visibleSubmeshes, begin, end);
+	});
+	jobSystem.Run(cullJob);
+	/* Culling started */
+
+	/* Choosing the images the frame renders into */
+	//Windows whose swapchain still gave an image but no longer matches their surface, rebuilt once it is presented
+	bool suboptimalWindows[MAX_WINDOW_COUNT] = {};
+	drawList.targets.reserve(IsBatchMode() ? 1 : m_windows.size());
+	if (IsBatchMode())
+	{
+		//Each frame in flight has an offscreen image of its own, nothing has to be acquired
+		FrameRenderTarget target{};
+		target.vk_framebuffer = m_offscreenFramebuffers.GetVulkanSDKFramebuffers()[m_currentFrame];
+		target.vk_image = m_offscreenTargets.GetVulkanSDKImages()[m_currentFrame];
+		target.vk_extent = GetRenderExtent();
+		target.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		target.vk_gbufferSet = m_offscreenGBuffer.GetVulkanSDKDescriptorSet();
+		drawList.targets.push_back(target);
+	}
+	else
+	{
+		//Every window acquires an image, the single submit waits for all of them to be available
+		TRACE_SCOPE("AcquireImage");
+		for (uint32_t i = 0; i < m_windows.size(); ++i)
+		{
+			PresentWindow& presentWindow = m_windows[i];
+			const VkSemaphore& imageAvailableSemaphore = m_vulkanSyncObjects.GetImageAvailableSemaphore(m_currentFrame, i);
+			VkResult acquireResult = vkAcquireNextImageKHR(m_vulkanDevice.GetVulkanSDKLogicalDevice(),
+				presentWindow.swapchain.GetVulkanSDKSwapchain(), UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE,
+				&presentWindow.imageIndex);
+			//An out of date swapchain gives no image and leaves the semaphore unsignalled, so only this window is
+			//rebuilt and acquires again. The windows before it keep the images they acquired, and the submit still
+			//waits on one signalled semaphore per window
+			while (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+			{
+				RecreateWindowSwapchain(i);
+				acquireResult = vkAcquireNextImageKHR(m_vulkanDevice.GetVulkanSDKLogicalDevice(),
+					presentWindow.swapchain.GetVulkanSDKSwapchain(), UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE,
+					&presentWindow.imageIndex);
+			}
+			if (acquireResult == VK_SUBOPTIMAL_KHR)
+			{
+				suboptimalWindows[i] = true;
+			}
+			else if (acquireResult != VK_SUCCESS)
+			{
+				__debugbreak();
+			}
+
+			FrameRenderTarget target{};
+			target.vk_framebuffer = presentWindow.framebuffers.GetVulkanSDKFramebuffers()[presentWindow.imageIndex];
+			target.vk_image = presentWindow.swapchain.GetSwapchainImages()[presentWindow.imageIndex];
+			target.vk_extent = presentWindow.swapchain.GetSwapchainExtent();
+			target.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+			target.vk_gbufferSet = presentWindow.gbuffer.GetVulkanSDKDescriptorSet();
+			drawList.targets.push_back(target);
+		}
+	}
+	/* Images chosen */
+
+	//Resetting the command buffer and recording it once culling has finished. Every window is drawn into the same
+	//command buffer, so the particles are simulated once and the frame is a single submit
+	Job* recordJob = jobSystem.CreateJob([this, &visibleSubmeshes, &drawList]()
+	{
+		TRACE_SCOPE("RecordCommandBuffer");
+		auto recordStart = std::chrono::steady_clock::now();
+		if (m_sceneMesh.IsLoaded())
+		{
+			m_sceneMesh.BuildDrawList(visibleSubmeshes, drawList.meshDraws);
+			m_drawnMeshTriangles = VulkanMeshHandle::CountDrawTriangles(drawList.meshDraws);
+		}
+		vkResetCommandBuffer(m_vulkanCommandBuffer.GetVulkanSDKCommandBuffer(m_currentFrame), 0);
+		m_vulkanCommandBuffer.RecordCommandBuffer(m_vulkanPipeline, drawList, m_gpuProfiler, m_sceneMesh,
+			m_particleSystem, m_clusteredLighting, m_shadowCascades, m_overlay, m_frameCapture, m_multiviewTargets,
+			m_meshView.viewProjection, m_currentFrame);
+		//Read on the main thread once it has waited for this job
+		m_recordingMsSum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+		++m_recordedFrames;
+	});
+	jobSystem.AddDependency(recordJob, cullJob);
+	jobSystem.Run(recordJob);
+
+	//Texture uploads are recorded into the streamer's own command pool while the frame is being recorded. The HUD's
+	//set was written with the view this frame samples, and a view swapped out now goes to the deletion queue, which
+	//keeps it until the frame has finished. With no texture registered there is nothing to stream
+	if (m_textureStreamer.GetTextureCount() != 0)
+	{
+		m_textureStreamer.Update(m_vulkanDevice);
+	}
+
+	{
+		TRACE_SCOPE("WaitForRecording");
+		jobSystem.Wait(recordJob);
+	}
+
+	{
+		TRACE_SCOPE("QueueSubmit");
+		m_vulkanSyncObjects.SubmitFrame(m_vulkanDevice.GetVulkanSDKGraphicsQueue(),
+			m_vulkanCommandBuffer.GetVulkanSDKCommandBuffer(m_currentFrame), m_currentFrame,
+			IsBatchMode() ? 0 : static_cast<uint32_t>(m_windows.size()));
+	}
+	m_deletionQueue.SubmitFrame(m_currentFrame);
+
+	//Batch frames are never presented, the next one starts as soon as a frame slot is free
+	if (IsBatchMode())
+	{
+		m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
+		return;
+	}
 
-	//Now that graphics has been submitted, the frame can be presented back to the swapchain
+	//Now that graphics has been submitted, the frame can be presented back to the swapchains
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
-	//The presentation should wait for rendering operations to finish
+	//The presentation should wait for rendering operations to finish, one submit rendered every window
 	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = signalSemaphores;
+	presentInfo.pWaitSemaphores = &m_vulkanSyncObjects.vk_renderFinishedSemaphores[m_currentFrame];
 
-	//Submitting the swapchain and the image index
-	VkSwapchainKHR swapchains[] = { m_vulkanSwapchain.GetVulkanSDKSwapchain() };
-	presentInfo.swapchainCount = 1;
+	//Every window's swapchain and image index is presented with one call
+	VkSwapchainKHR swapchains[MAX_WINDOW_COUNT];
+	uint32_t imageIndices[MAX_WINDOW_COUNT];
+	for (uint32_t i = 0; i < m_windows.size(); ++i)
+	{
+		swapchains[i] = m_windows[i].swapchain.GetVulkanSDKSwapchain();
+		imageIndices[i] = m_windows[i].imageIndex;
+	}
+	presentInfo.swapchainCount = static_cast<uint32_t>(m_windows.size());
 	presentInfo.pSwapchains = swapchains;
-	presentInfo.pImageIndices = &imageIndex;
+	presentInfo.pImageIndices = imageIndices;
+	//The call's own result only reports one of the windows, each window's result tells whether its swapchain is stale
+	VkResult presentResults[MAX_WINDOW_COUNT];
+	presentInfo.pResults = presentResults;
+
+	VkResult presentResult;
+	{
+		TRACE_SCOPE("QueuePresent");
+		presentResult = vkQueuePresentKHR(m_vulkanDevice.GetVulkanSDKPresentQueue(), &presentInfo);
+	}
+	if (presentResult != VK_SUCCESS && presentResult != VK_SUBOPTIMAL_KHR && presentResult != VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		__debugbreak();
+	}
+
+	//Only the windows that reported their swapchain as stale are rebuilt, the next frame acquires from the new one
+	for (uint32_t i = 0; i < m_windows.size(); ++i)
+	{
+		if (presentResults[i] == VK_ERROR_OUT_OF_DATE_KHR || presentResults[i] == VK_SUBOPTIMAL_KHR ||
+			suboptimalWindows[i])
+		{
+			RecreateWindowSwapchain(i);
+		}
+		else if (presentResults[i] != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+
+	//Startup is only over once the first frame is on its way to the screen
+	if (!m_firstFramePresented)
+	{
+		m_firstFramePresented = true;
+		double firstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+		std::cout << "Time to first frame: " << firstFrameMs << " ms\n";
+	}
 
-	vkQueuePresentKHR(m_vulkanDevice.GetVulkanSDKPresentQueue(), &presentInfo);
+	//Moving on to the next frame in flight
+	m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
 }
 
 
 
 
 
-void VulkanSyncObjectsHandle::CreateSyncObjects(const VkDevice& device)
+VulkanSyncObjectsHandle::VulkanSyncObjectsHandle()
+	:vk_imageAvailableSemaphores(), vk_renderFinishedSemaphores(), vk_inFlightFences(), m_graphicsTimeline(),
+	m_frameTimelineValues(), m_windowCount{1}
+{
+
+}
+
+/***************************************************************************************************
+* Function Argument 1: The device handle is needed to create the sync objects and to check if they *
+*					   can be timeline semaphores												   *
+* Function Argument 2: How many frames can be in flight at once									   *
+* Function Argument 3: How many windows every frame is presented to								   *
+***************************************************************************************************/
+void VulkanSyncObjectsHandle::CreateSyncObjects(const VulkanDeviceHandle& device, uint32_t framesInFlight,
+	uint32_t windowCount)
 {
+	m_windowCount = windowCount;
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	m_graphicsTimeline.CreateQueueTimeline(device);
+	//Value 0 is reached from the start, so the first wait of every frame slot returns right away
+	m_frameTimelineValues.assign(framesInFlight, 0);
+
 	VkSemaphoreCreateInfo semaphoreInfo{};
 	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
@@ -168,11 +1541,119 @@ void VulkanSyncObjectsHandle::CreateSyncObjects(const VkDevice& device)
 	//Create the fence into the signaled state so that we don't wait infinitely for the first frame
 	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-	VkResult imageViewSemaphoreSuccess = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &vk_imageAvailableSemaphore);
-	VkResult renderSemaphoreSuccess = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &vk_renderFinishedSemaphore);
-	VkResult frameFenceSuccess = vkCreateFence(device, &fenceInfo, nullptr, &vk_inFlightFence);
+	//Every frame in flight gets its own set of sync objects
+	vk_imageAvailableSemaphores.resize(framesInFlight * windowCount);
+	vk_renderFinishedSemaphores.resize(framesInFlight);
+	vk_inFlightFences.resize(m_graphicsTimeline.IsCreated() ? 0 : framesInFlight, VK_NULL_HANDLE);
+	for (VkSemaphore& imageAvailableSemaphore : vk_imageAvailableSemaphores)
+	{
+		VkResult imageViewSemaphoreSuccess = vkCreateSemaphore(vk_device, &semaphoreInfo, nullptr, &imageAvailableSemaphore);
+		if (imageViewSemaphoreSuccess != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+	for (uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		VkResult renderSemaphoreSuccess = vkCreateSemaphore(vk_device, &semaphoreInfo, nullptr, &vk_renderFinishedSemaphores[i]);
+		VkResult frameFenceSuccess = VK_SUCCESS;
+		if (!m_graphicsTimeline.IsCreated())
+		{
+			frameFenceSuccess = vkCreateFence(vk_device, &fenceInfo, nullptr, &vk_inFlightFences[i]);
+		}
+
+		if (renderSemaphoreSuccess != VK_SUCCESS || frameFenceSuccess != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+}
+
+/******************************************************************
+* Function Argument 1: The logical device the sync objects are on *
+* Function Argument 2: The frame slot about to be recorded again  *
+******************************************************************/
+void VulkanSyncObjectsHandle::WaitForFrame(const VkDevice& device, uint32_t frameIndex)
+{
+	//The timeline is never reset, the next submit of this slot simply signals a higher value
+	if (m_graphicsTimeline.IsCreated())
+	{
+		m_graphicsTimeline.Wait(device, m_frameTimelineValues[frameIndex]);
+		return;
+	}
+
+	//Reseting the fence once we get the signal, so the next submit of this slot can signal it again
+	vkWaitForFences(device, 1, &vk_inFlightFences[frameIndex], VK_TRUE, UINT64_MAX);
+	vkResetFences(device, 1, &vk_inFlightFences[frameIndex]);
+}
+
+/************************************************************************
+* Function Argument 1: The graphics queue the frame is rendered on      *
+* Function Argument 2: The frame's recorded command buffer              *
+* Function Argument 3: The frame slot the command buffer belongs to     *
+* Function Argument 4: How many windows acquired an image the frame     *
+*					   renders into and presents afterwards, 0 for	    *
+*					   offscreen frames									*
+************************************************************************/
+void VulkanSyncObjectsHandle::SubmitFrame(const VkQueue& queue, const VkCommandBuffer& commandBuffer, uint32_t frameIndex,
+	uint32_t presentedWindows)
+{
+	bool presented = presentedWindows != 0;
+
+	//Create the submit info needed to submit the queue
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+	//Specifying that every window's image should become available before executing color attachment.
+	//Offscreen frames never acquired an image, so there is nothing to wait for
+	VkPipelineStageFlags waitStages[MAX_WINDOW_COUNT];
+	for (uint32_t i = 0; i < presentedWindows; ++i)
+	{
+		waitStages[i] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	}
+	submitInfo.waitSemaphoreCount = presentedWindows;
+	submitInfo.pWaitSemaphores = &vk_imageAvailableSemaphores[frameIndex * m_windowCount];
+	submitInfo.pWaitDstStageMask = waitStages;
+
+	//Passing the command buffer which has already been recorded
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	//Specifying that a signal should be sent that render has finished once the queue is done
+	//Only a presented frame needs it, the others start their signal list at the timeline
+	VkSemaphore signalSemaphores[] = { vk_renderFinishedSemaphores[frameIndex], VK_NULL_HANDLE };
+	uint32_t firstSignal = presented ? 0 : 1;
+	submitInfo.signalSemaphoreCount = presented ? 1 : 0;
+	submitInfo.pSignalSemaphores = signalSemaphores + firstSignal;
 
-	if (imageViewSemaphoreSuccess != VK_SUCCESS || renderSemaphoreSuccess != VK_SUCCESS || frameFenceSuccess != VK_SUCCESS)
+	/* Signalling the frame's completion */
+	//Binary semaphores ignore their values, they only need a slot in the value arrays
+	uint64_t waitValues[MAX_WINDOW_COUNT]{};
+	uint64_t signalValues[] = { 0, 0 };
+	VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+	VkFence frameFence = VK_NULL_HANDLE;
+	if (m_graphicsTimeline.IsCreated())
+	{
+		m_frameTimelineValues[frameIndex] = m_graphicsTimeline.NextSignalValue();
+		signalSemaphores[1] = m_graphicsTimeline.GetVulkanSDKSemaphore();
+		signalValues[1] = m_frameTimelineValues[frameIndex];
+		submitInfo.signalSemaphoreCount = 2 - firstSignal;
+
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+		timelineInfo.pWaitSemaphoreValues = waitValues;
+		timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+		timelineInfo.pSignalSemaphoreValues = signalValues + firstSignal;
+		submitInfo.pNext = &timelineInfo;
+	}
+	else
+	{
+		frameFence = vk_inFlightFences[frameIndex];
+	}
+	/* Completion signal chosen */
+
+	VkResult submitResult = vkQueueSubmit(queue, 1, &submitInfo, frameFence);
+	if (submitResult != VK_SUCCESS)
 	{
 		__debugbreak();
 	}
@@ -180,7 +1661,17 @@ void VulkanSyncObjectsHandle::CreateSyncObjects(const VkDevice& device)
 
 void VulkanSyncObjectsHandle::Cleanup(const VkDevice& device)
 {
-	vkDestroySemaphore(device, vk_imageAvailableSemaphore, nullptr);
-	vkDestroySemaphore(device, vk_renderFinishedSemaphore, nullptr);
-	vkDestroyFence(device, vk_inFlightFence, nullptr);
-}
\ No newline at end of file
+	for (VkSemaphore semaphore : vk_imageAvailableSemaphores)
+	{
+		vkDestroySemaphore(device, semaphore, nullptr);
+	}
+	for (VkSemaphore semaphore : vk_renderFinishedSemaphores)
+	{
+		vkDestroySemaphore(device, semaphore, nullptr);
+	}
+	for (VkFence fence : vk_inFlightFences)
+	{
+		vkDestroyFence(device, fence, nullptr);
+	}
+	m_graphicsTimeline.Cleanup(device);
+}
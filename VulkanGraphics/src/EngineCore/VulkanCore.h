@@ -7,12 +7,212 @@
 #include "EngineCore/VulkanHandles/VulkanSwapchain.h"
 #include "EngineCore/VulkanHandles/VulkanImageViews.h"
 #include "EngineCore/VulkanHandles/VulkanGraphicsPipeline.h"
+#include "EngineCore/VulkanHandles/VulkanDepthBuffer.h"
+#include "EngineCore/VulkanHandles/VulkanGBuffer.h"
+#include "EngineCore/VulkanHandles/VulkanOffscreenTargets.h"
+#include "EngineCore/VulkanHandles/VulkanMultiviewTargets.h"
+#include "EngineCore/VulkanHandles/VulkanPipelineCache.h"
+#include "EngineCore/VulkanHandles/VulkanDeletionQueue.h"
+#include "EngineCore/VulkanHandles/VulkanQueueTimeline.h"
+#include "EngineCore/Profiling/VulkanGpuProfiler.h"
+#include "EngineCore/Profiling/TraceRecorder.h"
+#include "EngineCore/Textures/TextureStreamer.h"
+#include "EngineCore/Meshes/VulkanMesh.h"
+#include "EngineCore/Particles/VulkanParticleSystem.h"
+#include "EngineCore/Lighting/ClusteredLighting.h"
+#include "EngineCore/Lighting/ShadowCascades.h"
+#include "EngineCore/Overlay/OverlayBatcher.h"
+#include "EngineCore/Capture/FrameCapture.h"
+#include "EngineCore/Shaders/ShaderHotReloader.h"
+#include "EngineCore/Math/VectorMath.h"
+#include "EngineCore/Jobs/JobSystem.h"
+#include "EngineCore/Jobs/JobGraph.h"
+#include "EngineCore/Memory/FrameArena.h"
+#include "EngineCore/Memory/HeapCounter.h"
+#include <chrono>
 
 
 
 #define PRIMARY_WINDOW_WIDTH 720
 #define PRIMARY_WINDOW_HEIGHT 560
 
+//How many frames can be recorded by the CPU while the GPU is still working on previous ones
+#define MAX_FRAMES_IN_FLIGHT 2
+
+//Started with this argument followed by a count, that many windows show the scene. They share the device and
+//the pipelines, their frames are recorded into one command buffer and presented with one call
+#define WINDOW_COUNT_ARGUMENT "--windows"
+#define MAX_WINDOW_COUNT 4
+
+//Started with this argument followed by a view count, the scene is rendered from that many cameras in a single
+//multiview render pass and the views are shown side by side, 2 views make a stereo pair. The cameras are this many
+//times the scene's bounding radius apart
+#define MULTIVIEW_ARGUMENT "--multiview"
+#define MULTIVIEW_VIEW_SEPARATION 0.1f
+
+//Started with this argument, the mesh is drawn with deferred shading: its surface is written into a G-buffer and every
+//pixel is lit once from it, in the second subpass of the same render pass. Multiview keeps drawing forward
+#define DEFERRED_ARGUMENT "--deferred"
+
+//Started with this argument, the mesh casts shadows from the sun through cascaded shadow maps, forward or deferred.
+//Multiview draws without them
+#define SHADOWS_ARGUMENT "--shadows"
+
+//Started with this argument, a panel of frame statistics is drawn over the scene by the overlay. Multiview draws
+//without it
+#define HUD_ARGUMENT "--hud"
+#define HUD_TEXT_HEIGHT 12.0f
+#define HUD_MARGIN 12.0f
+
+//Started with this argument, the overlay also draws this many lines of text and glowing sprites every frame, and its
+//timings are printed in every build
+#define HUD_STRESS_ARGUMENT "--hud-stress"
+#define HUD_STRESS_TEXT_LINES 1000u
+#define HUD_STRESS_GLOW_SPRITES 2000u
+
+//The HUD shows a texture streamed from this file, which is generated if it is missing. Its size on screen keeps
+//changing between these bounds, so the mips it needs are requested from the streamer every frame
+#define HUD_TEXTURE_FILENAME "Textures/HudPreview.vtex"
+#define HUD_TEXTURE_SIZE 2048u
+#define HUD_TEXTURE_MIN_PIXELS 48.0f
+
+//How often (in frames) the GPU profiler results are printed in debug builds
+#define GPU_PROFILER_LOG_INTERVAL 1000
+
+//The pipeline cache is read from this file on startup and written back to it on shutdown
+#define PIPELINE_CACHE_FILENAME "PipelineCache.bin"
+
+//Started with this argument, the shader sources in SHADER_DIRECTORY are compiled again whenever they are saved,
+//and the pipelines using them are swapped for rebuilt ones between frames
+#define SHADER_HOT_RELOAD_ARGUMENT "--hot-reload"
+#define SHADER_DIRECTORY "Shaders"
+
+//If this mesh file exists it is drawn instead of the triangle, mesh files are written by the MeshConverter tool
+#define SCENE_MESH_FILENAME "Meshes/Scene.vmesh"
+
+//The camera orbits the scene mesh at this many times its bounding radius, at this many radians per second
+#define SCENE_CAMERA_DISTANCE 2.5f
+#define SCENE_CAMERA_ORBIT_SPEED 0.5f
+
+//While orbiting, the camera moves out to this many times the bounding radius and back, at this many radians per second
+#define SCENE_CAMERA_FAR_DISTANCE 40.0f
+#define SCENE_CAMERA_ZOOM_SPEED 0.2f
+
+//Vertical field of view of the scene camera, in radians
+#define SCENE_CAMERA_FOV 1.0471975f
+
+//The largest error (in pixels) a mesh's selected detail level may show on screen
+#define MESH_LOD_ERROR_THRESHOLD_PIXELS 1.0f
+
+//Pressing this key starts a trace capture, pressing it again writes the capture to TRACE_CAPTURE_FILENAME
+#define TRACE_CAPTURE_KEY GLFW_KEY_F12
+#define TRACE_CAPTURE_FILENAME "VulkanGraphicsTrace.json"
+
+//Pressing this key starts capturing every presented frame into FRAME_CAPTURE_DIRECTORY, pressing it again stops
+#define FRAME_CAPTURE_KEY GLFW_KEY_F11
+#define FRAME_CAPTURE_DIRECTORY "Captures"
+
+//A fountain of particles rises from the top of the scene, this many at most, each living up to this many seconds
+#define SCENE_PARTICLE_COUNT (1u << 16)
+#define SCENE_PARTICLE_LIFETIME 3.0f
+
+//Started with this argument, the fountain keeps this many particles alive and its timings are printed in every build
+#define PARTICLE_STRESS_ARGUMENT "--particle-stress"
+#define PARTICLE_STRESS_COUNT (1u << 22)
+
+//Started with this argument followed by a count, the mesh is lit by that many point and spot lights, binned into
+//clusters every frame. Multiview draws the mesh unlit
+#define LIGHT_COUNT_ARGUMENT "--lights"
+
+//Started with this argument, CLUSTERED_LIGHTING_MAX_LIGHTS lights are created and the camera holds still. The lit count
+//starts at LIGHT_BENCHMARK_FIRST_COUNT and doubles every LIGHT_BENCHMARK_STEP_FRAMES frames until every light is lit,
+//and the GPU time of each count is printed, leaving out the first LIGHT_BENCHMARK_WARMUP_FRAMES frames of a step
+#define LIGHT_BENCHMARK_ARGUMENT "--light-benchmark"
+#define LIGHT_BENCHMARK_FIRST_COUNT 64u
+#define LIGHT_BENCHMARK_STEP_FRAMES 300
+#define LIGHT_BENCHMARK_WARMUP_FRAMES 30
+
+//Started with this argument followed by a frame count, that many frames are rendered offscreen at a fixed time step
+//as fast as the GPU allows, and written to disk instead of being presented
+#define BATCH_ARGUMENT "--batch"
+//Followed by png, raw or y4m, png by default
+#define BATCH_FORMAT_ARGUMENT "--batch-format"
+//Followed by the output directory of a PNG sequence or the output file of the raw and Y4M formats
+#define BATCH_OUTPUT_ARGUMENT "--batch-output"
+#define BATCH_DEFAULT_PNG_OUTPUT "BatchFrames"
+#define BATCH_DEFAULT_RAW_OUTPUT "BatchFrames.raw"
+#define BATCH_DEFAULT_Y4M_OUTPUT "BatchFrames.y4m"
+
+//Size of the batch frames and the scene time between two of them
+#define BATCH_FRAME_WIDTH 1280
+#define BATCH_FRAME_HEIGHT 720
+#define BATCH_FRAME_RATE 60
+
+//Batch frames are never presented, so many more of them can be in flight to keep the GPU fed
+#define BATCH_FRAMES_IN_FLIGHT 8
+
+//PNG files are encoded by this many writer threads in batch mode
+#define BATCH_PNG_WRITER_THREADS 3
+
+//The options main reads from the command line
+struct ApplicationOptions
+{
+	//Runs the particle stress scene, to benchmark the particle system
+	bool particleStress = false;
+
+	//Lights the mesh with this many clustered lights, 0 draws it unlit
+	uint32_t lightCount = 0;
+
+	//Measures the clustered lighting at light counts from a few to CLUSTERED_LIGHTING_MAX_LIGHTS
+	bool lightBenchmark = false;
+
+	//Recompiles saved shaders and rebuilds their pipelines while the interactive loop runs
+	bool shaderHotReload = false;
+
+	//How many windows the interactive loop presents to, batch mode always has a single hidden one
+	uint32_t windowCount = 1;
+
+	//How many views the multiview render pass renders, 0 renders a single view without multiview
+	uint32_t multiviewCount = 0;
+
+	//Draws through the deferred render pass and the G-buffer instead of the main render pass
+	bool deferred = false;
+
+	//Shadows the mesh from the sun with the cascaded shadow maps
+	bool shadows = false;
+
+	//Draws the statistics panel over the scene, and the overlay stress scene on top of it
+	bool hud = false;
+	bool hudStress = false;
+
+	//Renders this many frames in batch mode, 0 runs the interactive loop
+	uint32_t batchFrameCount = 0;
+	FrameWriterFormat batchFormat = FrameWriterFormat::Png;
+	//Empty picks the default output of the format
+	std::string batchOutput;
+};
+
+//The image a frame renders into, a swapchain image or one of the batch mode's offscreen targets
+struct FrameRenderTarget
+{
+	VkFramebuffer vk_framebuffer;
+	VkImage vk_image;
+	VkExtent2D vk_extent;
+	//The layout the render pass leaves the image in
+	VkImageLayout finalLayout;
+	//The input attachment set of the G-buffer the framebuffer attaches, VK_NULL_HANDLE unless it is deferred
+	VkDescriptorSet vk_gbufferSet;
+};
+
+//What a frame draws, built by DrawFrame in the frame arena and thrown away with it
+struct FrameDrawList
+{
+	//The images the frame renders into, one for each window or the batch mode's offscreen image
+	FrameVector<FrameRenderTarget> targets;
+	//The submeshes the camera sees, drawn into every target or view
+	FrameVector<MeshDrawRange> meshDraws;
+};
+
 /**************************************************
 * Holds an array that stores all the framebuffers *
 * created based on the image views				  *
@@ -20,8 +220,9 @@
 class VulkanFramebufferHandle
 {
 public:
-	//Fills the array of framebuffers by creating one based on specific image views and render pass
-	void CreateFramebuffers(const std::vector<VkImageView>& imageViews,
+	//Fills the array of framebuffers by creating one based on specific image views and render pass. The shared
+	//attachments follow the image view in every framebuffer, the depth buffer or the G-buffer
+	void CreateFramebuffers(const std::vector<VkImageView>& imageViews, const std::vector<VkImageView>& sharedAttachments,
 		const VkRenderPass& renderPass, const VkExtent2D& swapchainExtent,
 		const VkDevice& device);
 
@@ -38,50 +239,152 @@ private:
 };
 
 
+//Everything a window needs of its own to be presented to, the device and the pipelines are shared by every window
+struct PresentWindow
+{
+	GlfwWindowHandle window;
+	VulkanSurfaceHandle surface;
+	VulkanSwapchainHandle swapchain;
+	VulkanImageViewsHandle imageViews;
+	//Each window has a depth buffer of its swapchain's size, or a G-buffer holding the depth with deferred shading
+	VulkanDepthBufferHandle depthBuffer;
+	VulkanGBufferHandle gbuffer;
+	VulkanFramebufferHandle framebuffers;
+
+	//The swapchain image acquired for the frame being recorded
+	uint32_t imageIndex = 0;
+};
+
+
 /******************************************************************
 * Holds the command buffers used to make various vulkan commands, *
-* and the command pool that allocates them						  *
+* one for each frame in flight, and the command pool that         *
+* allocates them												  *
 ******************************************************************/
 class VulkanCommandBufferHandle
 {
 public:
-	//Creates the command buffer and the command pool
-	void CreateCommandBuffer(const VulkanDeviceHandle& device);
+	//Creates the command pool and one command buffer per frame in flight
+	void CreateCommandBuffer(const VulkanDeviceHandle& device, uint32_t framesInFlight);
 
 	void Cleanup(const VkDevice& device);
 
-	void RecordCommandBuffer(const VulkanSwapchainHandle& swapchain, 
-		const VulkanGraphicsPipelineHandle& graphicsPipeline,const VulkanFramebufferHandle& framebuffer,
-		uint32_t imageIndex);
+	//Simulates the particles, bins the lights and renders the shadow cascades that changed, then draws the mesh if it is loaded (otherwise the triangle), the
+	//particles and the overlay into every target, one render pass each, deferred for the targets with a G-buffer, and copies the first target's image out if
+	//frames are being captured. If the multiview targets are created, the scene is drawn once into all their views and blitted to every target, without the overlay
+	void RecordCommandBuffer(const VulkanGraphicsPipelineHandle& graphicsPipeline,
+		const FrameDrawList& drawList, VulkanGpuProfilerHandle& profiler, const VulkanMeshHandle& mesh,
+		VulkanParticleSystemHandle& particles, const VulkanClusteredLightingHandle& lighting,
+		const VulkanShadowCascadesHandle& shadows, VulkanOverlayBatcherHandle& overlay, VulkanFrameCaptureHandle& capture,
+		const VulkanMultiviewTargetsHandle& multiviewTargets, const Mat4& viewProjection, uint32_t currentFrame);
 
 	inline const VkCommandPool& GetVulkanSDKCommandPool() const { return vk_commandPool; }
 
-	inline const VkCommandBuffer& GetVulkanSDKCommandBuffer() const { return vk_commandBuffer; }
+	inline const VkCommandBuffer& GetVulkanSDKCommandBuffer(uint32_t currentFrame) const 
+	{ 
+		return vk_commandBuffers[currentFrame]; 
+	}
 private:
-	//Called by CreateCommandBuffer to create the command pool before creating the command buffer
+	//Called by RecordCommandBuffer for every target, to begin its render pass, bind the pipeline and draw
+	void RecordRenderPass(const VkCommandBuffer& vk_commandBuffer, const FrameRenderTarget& target,
+		const VulkanGraphicsPipelineHandle& graphicsPipeline, VulkanGpuProfilerHandle& profiler,
+		const VulkanMeshHandle& mesh, const FrameVector<MeshDrawRange>& meshDraws, const VulkanParticleSystemHandle& particles,
+		const VulkanOverlayBatcherHandle& overlay, const Mat4& viewProjection, const VkDescriptorSet& lightingSet,
+		const VkDescriptorSet& shadowSet, uint32_t currentFrame);
+
+	//Called by RecordCommandBuffer instead of RecordRenderPass for a target with a G-buffer, to write the mesh into it
+	//and light it in the next subpass
+	void RecordDeferredPass(const VkCommandBuffer& vk_commandBuffer, const FrameRenderTarget& target,
+		const VulkanGraphicsPipelineHandle& graphicsPipeline, VulkanGpuProfilerHandle& profiler,
+		const VulkanMeshHandle& mesh, const FrameVector<MeshDrawRange>& meshDraws, const VulkanParticleSystemHandle& particles,
+		const VulkanOverlayBatcherHandle& overlay, const Mat4& viewProjection, const VkDescriptorSet& lightingSet,
+		const VkDescriptorSet& shadowSet, uint32_t currentFrame);
+
+	//Called by RecordCommandBuffer instead of RecordRenderPass when multiview is used, to draw every view at once
+	void RecordMultiviewPass(const VkCommandBuffer& vk_commandBuffer, const VulkanMultiviewTargetsHandle& multiviewTargets,
+		const VulkanGraphicsPipelineHandle& graphicsPipeline, VulkanGpuProfilerHandle& profiler,
+		const VulkanMeshHandle& mesh, const FrameVector<MeshDrawRange>& meshDraws,
+		const VulkanParticleSystemHandle& particles, const Mat4& viewProjection, uint32_t currentFrame);
+
+	//Called once a render pass has begun, to bind the pipelines and draw. The multiview set is VK_NULL_HANDLE outside
+	//of the multiview render pass, the lighting set is VK_NULL_HANDLE if the mesh is drawn unlit and the shadow set
+	//if it is drawn without shadows
+	void RecordDrawCommands(const VkCommandBuffer& vk_commandBuffer, const VkExtent2D& extent,
+		const VulkanGraphicsPipelineHandle& graphicsPipeline, const VulkanMeshHandle& mesh,
+		const FrameVector<MeshDrawRange>& meshDraws, const VulkanParticleSystemHandle& particles,
+		const Mat4& viewProjection, const VkDescriptorSet& multiviewSet,
+		const VkDescriptorSet& lightingSet, const VkDescriptorSet& shadowSet);
+
+	//Sets the dynamic viewport and scissor to cover the whole extent
+	void RecordViewport(const VkCommandBuffer& vk_commandBuffer, const VkExtent2D& extent);
+
+	//Called by CreateCommandBuffer to create the command pool before creating the command buffers
 	void CreateCommandPool(const VulkanDeviceHandle& device);
 
-	//Called by CreateCommandBuffer to create the actual command buffer after the command pool
-	void CreateCommandBufferInner(const VkDevice& device);
+	//Called by CreateCommandBuffer to create the actual command buffers after the command pool
+	void CreateCommandBufferInner(const VkDevice& device, uint32_t framesInFlight);
 private:
 	//Holds the command pool
 	VkCommandPool vk_commandPool;
 
-	VkCommandBuffer vk_commandBuffer;
+	//Holds one command buffer for each frame in flight
+	std::vector<VkCommandBuffer> vk_commandBuffers;
 };
 
 
 
+/************************************************************
+* Holds the semaphores used to synchronize each frame in    *
+* flight with the swapchains, and what tells the CPU that   *
+* a frame has finished: the graphics queue's timeline if    *
+* the device has timeline semaphores, a fence per frame if  *
+* not                                                       *
+************************************************************/
 class VulkanSyncObjectsHandle
 {
 public:
-	void CreateSyncObjects(const VkDevice& device);
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanSyncObjectsHandle();
+
+	//Every frame in flight gets an image available semaphore for each window, and one render finished semaphore
+	//that the single present of all the windows waits for
+	void CreateSyncObjects(const VulkanDeviceHandle& device, uint32_t framesInFlight, uint32_t windowCount);
+
+	//Blocks until the GPU has finished the last frame submitted from this frame slot
+	void WaitForFrame(const VkDevice& device, uint32_t frameIndex);
+
+	//Submits the frame's command buffer, signalling that the frame has finished for WaitForFrame. A presented frame
+	//also waits for the images of the first presentedWindows windows to be available, and signals that rendering
+	//has finished for the present
+	void SubmitFrame(const VkQueue& queue, const VkCommandBuffer& commandBuffer, uint32_t frameIndex,
+		uint32_t presentedWindows);
 
 	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline VulkanQueueTimeline& GetGraphicsTimeline() { return m_graphicsTimeline; }
+
+	inline const VkSemaphore& GetImageAvailableSemaphore(uint32_t frameIndex, uint32_t windowIndex) const
+	{
+		return vk_imageAvailableSemaphores[frameIndex * m_windowCount + windowIndex];
+	}
+	/* End member variable getters */
 public:
-	VkSemaphore vk_imageAvailableSemaphore;
-	VkSemaphore vk_renderFinishedSemaphore;
-	VkFence vk_inFlightFence;
+	//Binary semaphores, the swapchain can only acquire and present with them. The image available semaphores
+	//of one frame in flight are next to each other, one for each window
+	std::vector<VkSemaphore> vk_imageAvailableSemaphores;
+	std::vector<VkSemaphore> vk_renderFinishedSemaphores;
+
+	//Only created without timeline semaphores
+	std::vector<VkFence> vk_inFlightFences;
+private:
+	//Counts every submit to the graphics queue, frames and texture uploads alike
+	VulkanQueueTimeline m_graphicsTimeline;
+
+	//The timeline value the last submit of each frame slot signals
+	std::vector<uint64_t> m_frameTimelineValues;
+
+	uint32_t m_windowCount;
 };
 
 
@@ -97,43 +400,194 @@ public:
 	VulkanTriangle();
 
 	//Used in the main loop to excecute all the rendering operations that this class is responsible for
-	void RunTriangle();
+	void RunTriangle(const ApplicationOptions& options);
 
 private:
 	void VulkanInit();
 
 	void DrawFrame();
 
+	//Waits for the device to be idle and creates the window's swapchain again, with its image views, depth buffer or
+	//G-buffer and framebuffers sized from it. The other windows keep theirs
+	void RecreateWindowSwapchain(uint32_t windowIndex);
+
+	//Creates the window's framebuffers from its image views and its depth buffer or G-buffer, compatible with the
+	//render pass the frames use
+	void CreateWindowFramebuffers(PresentWindow& presentWindow);
+
+	//Returns true once any of the windows has been asked to close, which closes all of them
+	bool IsAnyWindowClosing() const;
+
+	//Starts or stops a trace capture when the capture key is pressed
+	void CheckTraceCaptureKey();
+
+	//Starts or stops capturing frames when the frame capture key is pressed
+	void CheckFrameCaptureKey();
+
+	//Renders the batch frames offscreen as fast as possible, writing them to disk, then prints where the time went
+	void RunBatch();
+
+	//Prints the frame rate a batch run sustained and which stage limited it
+	void LogBatchStatistics(double totalMs) const;
+
+	inline bool IsBatchMode() const { return m_options.batchFrameCount != 0; }
+
+	//The size of the images the frames render into, the primary window's swapchain's or the batch frames'
+	VkExtent2D GetRenderExtent() const;
+
+	//Returns a sphere around the scene mesh, or the unit sphere if there is no mesh
+	void GetSceneSphere(Vec3& center, float& radius) const;
+
+	//Places the particle fountain on top of the scene, sized for the normal or the stress scene
+	void ConfigureParticleEmitter();
+
+	//Returns the view projection matrix of a camera orbiting the mesh, sized to fit its bounds, and the camera's position.
+	//With multiview, also fills the matrix of every view, placed side by side around that camera, and the returned
+	//matrix is moved back until its frustum holds all of theirs so it can cull for every view at once
+	Mat4 ComputeMeshViewProjection(Vec3& eyePosition, Mat4* viewProjections) const;
+
+	//Returns false with the reason printed if the multiview render pass cannot be used with this device and its windows
+	bool CheckMultiviewSupport() const;
+
+	//Prints how many triangles the visible submeshes draw at their selected detail levels, and how many bytes of vertex data
+	//the mesh draws of the latest profiled frame fetched
+	void LogMeshStatistics() const;
+
+	//Prints what the last frame allocated from the frame arena and from the heap
+	void LogFrameMemoryStatistics() const;
+
+	//Prints the GPU time of the particle simulation and the CPU time of recording the frame, averaged since the last print
+	void LogParticleStressStatistics();
+
+	//Adds the frame's statistics panel, and the stress scene's text and sprites, to the overlay and flushes it
+	void BuildOverlay(float deltaSeconds);
+
+	//Prints the quads and draws of the overlay, the CPU time of building it averaged since the last print and its GPU time
+	void LogOverlayStressStatistics();
+
+	//Writes the texture the HUD streams, a pattern whose every mip looks different, returns false if it failed
+	static bool WriteHudTextureFile(const std::string& filename);
+
+	//Sums the GPU time of the latest profiled frame into the light benchmark's current step, and once the step has
+	//run its frames, prints its averages and lights more lights
+	void UpdateLightBenchmark();
+
 	static std::vector<char> ReadFile(const std::string& filename);
 
 	//Cleans up all of the vulkan handles that were explicitly created
 	void VulkanDestroy();
 
 private:
-	//Used to initialize the window system and interface with it
-	GlfwWindowHandle m_windowHandle;
+	//The windows and everything each one needs to be presented to. The first is the primary window: the instance
+	//and the GPU are chosen with it, its keys are read and its frames are captured
+	std::vector<PresentWindow> m_windows;
 
 	//Used to initialize the instance and access when it's needed
 	VulkanInstanceHandle m_vulkanInstance;
 
-	//Used to initialize the window surface for vulkan and access when it's needed
-	VulkanSurfaceHandle m_vulkanSurface;
-
 	//Used to intialize the vulkan device, interface with it and its queues and access support details of the GPU
 	VulkanDeviceHandle m_vulkanDevice;
 
-	//Used to initialize the swapchain, interface with it and access its details and images
-	VulkanSwapchainHandle m_vulkanSwapchain;
-
-	//Used to initialize the image views, and interface with the array that holds them
-	VulkanImageViewsHandle m_vulkanImageViews;
-
 	//Initializes the render pass and the graphics pipeline and sets them according to the application's needs
 	VulkanGraphicsPipelineHandle m_vulkanPipeline;
 
-	VulkanFramebufferHandle m_vulkanFramebuffers;
+	//Every pipeline is compiled through it, so pipelines compiled by a previous launch are not compiled again
+	VulkanPipelineCacheHandle m_pipelineCache;
+
+	//Only started with the hot reload argument, rebuilds pipelines on its own thread for DrawFrame to swap in
+	ShaderHotReloader m_shaderHotReloader;
+
+	//Batch mode renders into these instead of the swapchain images
+	VulkanOffscreenTargetsHandle m_offscreenTargets;
+	VulkanDepthBufferHandle m_offscreenDepthBuffer;
+	VulkanGBufferHandle m_offscreenGBuffer;
+	VulkanFramebufferHandle m_offscreenFramebuffers;
+
+	//Only created with multiview, every view is rendered into it and then blitted to the frame's images
+	VulkanMultiviewTargetsHandle m_multiviewTargets;
 
 	VulkanCommandBufferHandle m_vulkanCommandBuffer;
 
 	VulkanSyncObjectsHandle m_vulkanSyncObjects;
+
+	//Destroys the handles released while rendering once the frames that may use them have finished
+	VulkanDeletionQueue m_deletionQueue;
+
+	//Times the regions of the command buffers on the GPU
+	VulkanGpuProfilerHandle m_gpuProfiler;
+
+	//The scene mesh, only drawn if SCENE_MESH_FILENAME could be loaded
+	VulkanMeshHandle m_sceneMesh;
+
+	//Used to animate the camera orbiting the scene mesh
+	std::chrono::steady_clock::time_point m_startTime;
+
+	//The camera of the frame being recorded, read by the culling and recording jobs
+	MeshViewParameters m_meshView;
+	//Triangles of the mesh's draw list in the last recorded frame, shown by the HUD and the mesh statistics
+	uint64_t m_drawnMeshTriangles;
+
+	//Keeps the coarse mips of every texture resident and streams finer mips in as they are requested
+	TextureStreamer m_textureStreamer;
+
+	//Simulated and drawn entirely on the GPU, the CPU only decides how many particles each frame emits
+	VulkanParticleSystemHandle m_particleSystem;
+
+	//Only created with lights and without multiview, bins the lights into clusters for the mesh to be lit by
+	VulkanClusteredLightingHandle m_clusteredLighting;
+
+	//Only created with shadows, a mesh and without multiview, the mesh is shadowed from the sun by it
+	VulkanShadowCascadesHandle m_shadowCascades;
+
+	//Only created with the HUD and without multiview, batches the 2D sprites and text drawn over the scene
+	VulkanOverlayBatcherHandle m_overlay;
+
+	//The texture the HUD draws through the streamer, TEXTURE_STREAMING_INVALID_ID without the overlay
+	uint32_t m_hudTextureId;
+
+	//Copies presented frames out while capturing, and the thread that writes them to disk
+	VulkanFrameCaptureHandle m_frameCapture;
+	FrameWriter m_frameWriter;
+
+	ApplicationOptions m_options;
+
+	//When the last frame started, the particles are moved by the time between frames
+	std::chrono::steady_clock::time_point m_lastFrameTime;
+
+	//Seconds of scene animation shown by the frame being recorded, fixed steps in batch mode
+	float m_sceneSeconds;
+
+	//Time the main thread spent waiting for frames to finish on the GPU and copying them out of the readback buffers
+	double m_gpuWaitMsSum;
+	double m_readbackMsSum;
+
+	//Time spent recording command buffers since the last stress print, and the frames it covers
+	double m_recordingMsSum;
+	uint32_t m_recordedFrames;
+
+	//Time spent building the overlay since the last overlay stress print, and the frames it covers
+	double m_overlayBuildMsSum;
+	uint32_t m_overlayBuiltFrames;
+
+	//The light benchmark's step, how many frames it has run, and the GPU times summed over the frames after its warm up
+	uint32_t m_lightBenchmarkStep;
+	uint32_t m_lightBenchmarkFrames;
+	uint32_t m_lightBenchmarkSamples;
+	double m_lightBinningMsSum;
+	double m_lightMainPassMsSum;
+	double m_lightFrameMsSum;
+
+	//How many frames can be in flight, MAX_FRAMES_IN_FLIGHT or BATCH_FRAMES_IN_FLIGHT
+	uint32_t m_framesInFlight;
+
+	//Index of the frame in flight that is currently being recorded
+	uint32_t m_currentFrame;
+
+	//Used to detect the moment the trace capture key is pressed, rather than every frame it is held down
+	bool m_traceKeyWasPressed;
+
+	bool m_frameCaptureKeyWasPressed;
+
+	//Set once the first frame has been presented and the time it took since startup printed
+	bool m_firstFramePresented;
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "ShaderVariant.h"
+
+#include <cstring>
+
+ShaderVariantKey::ShaderVariantKey()
+	:m_values(), m_setMask{0}
+{
+
+}
+
+ShaderVariantKey& ShaderVariantKey::Set(uint32_t constantId, uint32_t value)
+{
+	if (constantId >= SHADER_VARIANT_MAX_CONSTANTS)
+	{
+		__debugbreak();
+		return *this;
+	}
+
+	m_values[constantId] = value;
+	m_setMask |= 1u << constantId;
+	return *this;
+}
+
+ShaderVariantKey& ShaderVariantKey::SetFloat(uint32_t constantId, float value)
+{
+	uint32_t bits = 0;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return Set(constantId, bits);
+}
+
+/********************************************************************************
+* Function Argument 1: The specialization info passed to the shader stages     *
+* Function Argument 2: Receives a map entry for every constant the key sets    *
+********************************************************************************/
+void ShaderVariantKey::FillSpecializationInfo(VkSpecializationInfo& specializationInfo,
+	VkSpecializationMapEntry mapEntries[SHADER_VARIANT_MAX_CONSTANTS]) const
+{
+	uint32_t entryCount = 0;
+	for (uint32_t constantId = 0; constantId < SHADER_VARIANT_MAX_CONSTANTS; ++constantId)
+	{
+		if (m_setMask & (1u << constantId))
+		{
+			mapEntries[entryCount].constantID = constantId;
+			mapEntries[entryCount].offset = constantId * sizeof(uint32_t);
+			mapEntries[entryCount].size = sizeof(uint32_t);
+			++entryCount;
+		}
+	}
+
+	specializationInfo.mapEntryCount = entryCount;
+	specializationInfo.pMapEntries = mapEntries;
+	specializationInfo.dataSize = sizeof(m_values);
+	specializationInfo.pData = m_values;
+}
+
+bool ShaderVariantKey::operator==(const ShaderVariantKey& other) const
+{
+	//Values that are not set are always 0, so the arrays can be compared whole
+	return m_setMask == other.m_setMask && std::memcmp(m_values, other.m_values, sizeof(m_values)) == 0;
+}
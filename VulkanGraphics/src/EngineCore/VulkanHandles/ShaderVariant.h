@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include "VulkanDevice.h"
+
+//The IDs of the specialization constants the shaders declare, matching the ones in ShaderVariants.glsl.
+//A pipeline whose shaders do not declare a constant it sets is unaffected by it
+#define SHADER_CONSTANT_MESH_OCTAHEDRAL_NORMALS 0
+#define SHADER_CONSTANT_PARTICLE_GROUP_SIZE 1
+#define SHADER_CONSTANT_CLUSTER_GROUP_SIZE 2
+#define SHADER_CONSTANT_CLUSTER_MAX_LIGHTS 3
+
+//Every constant ID is below this
+#define SHADER_VARIANT_MAX_CONSTANTS 8
+
+/*****************************************************************
+* Says which variant of its shaders a pipeline is created with:	 *
+* the value of every specialization constant it sets, by ID.	 *
+* Constants it leaves unset keep the default written in the	     *
+* shader. The driver compiles the pipeline with the values as	 *
+* constants, so branches on them cost nothing at runtime		 *
+*****************************************************************/
+class ShaderVariantKey
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	ShaderVariantKey();
+
+	//Sets an integer, unsigned or boolean constant, booleans are 0 or 1. Returns the key so values can be chained
+	ShaderVariantKey& Set(uint32_t constantId, uint32_t value);
+
+	ShaderVariantKey& SetFloat(uint32_t constantId, float value);
+
+	//Points the specialization info at the key's values, with a map entry for every constant set. The entries are
+	//written into the array passed in, and both it and the key have to outlive the pipeline creation
+	void FillSpecializationInfo(VkSpecializationInfo& specializationInfo,
+		VkSpecializationMapEntry mapEntries[SHADER_VARIANT_MAX_CONSTANTS]) const;
+
+	bool operator==(const ShaderVariantKey& other) const;
+
+	/* Member variable getters */
+	//Bit N is set if the constant with ID N has a value
+	inline uint32_t GetSetMask() const { return m_setMask; }
+	/* End member variable getters */
+private:
+	//Every constant is 4 bytes, and is kept at the offset of its ID
+	uint32_t m_values[SHADER_VARIANT_MAX_CONSTANTS];
+
+	uint32_t m_setMask;
+};
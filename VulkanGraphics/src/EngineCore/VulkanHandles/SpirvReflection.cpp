@@ -0,0 +1,434 @@
+#include "SpirvReflection.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+//The first word of every SPIR-V module, the words after it are the version, generator, id bound and a reserved 0
+#define SPIRV_MAGIC 0x07230203
+#define SPIRV_HEADER_WORDS 5
+
+/* SPIR-V opcodes read by the reflection */
+#define SPIRV_OP_ENTRY_POINT 15
+#define SPIRV_OP_TYPE_BOOL 20
+#define SPIRV_OP_TYPE_INT 21
+#define SPIRV_OP_TYPE_FLOAT 22
+#define SPIRV_OP_TYPE_VECTOR 23
+#define SPIRV_OP_TYPE_MATRIX 24
+#define SPIRV_OP_TYPE_IMAGE 25
+#define SPIRV_OP_TYPE_SAMPLER 26
+#define SPIRV_OP_TYPE_SAMPLED_IMAGE 27
+#define SPIRV_OP_TYPE_ARRAY 28
+#define SPIRV_OP_TYPE_RUNTIME_ARRAY 29
+#define SPIRV_OP_TYPE_STRUCT 30
+#define SPIRV_OP_TYPE_POINTER 32
+#define SPIRV_OP_CONSTANT 43
+#define SPIRV_OP_VARIABLE 59
+#define SPIRV_OP_DECORATE 71
+#define SPIRV_OP_MEMBER_DECORATE 72
+/* End SPIR-V opcodes */
+
+/* SPIR-V decorations, storage classes and image dimensions */
+#define SPIRV_DECORATION_BUFFER_BLOCK 3
+#define SPIRV_DECORATION_ARRAY_STRIDE 6
+#define SPIRV_DECORATION_MATRIX_STRIDE 7
+#define SPIRV_DECORATION_BUILT_IN 11
+#define SPIRV_DECORATION_LOCATION 30
+#define SPIRV_DECORATION_BINDING 33
+#define SPIRV_DECORATION_DESCRIPTOR_SET 34
+#define SPIRV_DECORATION_OFFSET 35
+
+#define SPIRV_STORAGE_UNIFORM_CONSTANT 0
+#define SPIRV_STORAGE_INPUT 1
+#define SPIRV_STORAGE_UNIFORM 2
+#define SPIRV_STORAGE_PUSH_CONSTANT 9
+#define SPIRV_STORAGE_STORAGE_BUFFER 12
+
+#define SPIRV_DIM_BUFFER 5
+#define SPIRV_DIM_SUBPASS_DATA 6
+/* End SPIR-V enums */
+
+//Everything the reflection needs to know about an id, filled in as its instructions are read
+struct SpirvId
+{
+	uint32_t opcode = 0;
+	//The operands after the result id, or after the result type and id for constants and variables
+	std::vector<uint32_t> operands;
+
+	bool hasSet = false;
+	bool hasBinding = false;
+	bool hasLocation = false;
+	bool builtIn = false;
+	bool bufferBlock = false;
+	uint32_t set = 0;
+	uint32_t binding = 0;
+	uint32_t location = 0;
+	uint32_t arrayStride = 0;
+
+	//Per struct member, 0 if the member has no such decoration
+	std::vector<uint32_t> memberOffsets;
+	std::vector<uint32_t> memberMatrixStrides;
+};
+
+//Returns the bytes a type takes in a block, following its offset, array stride and matrix stride decorations
+static uint32_t GetTypeSize(const std::unordered_map<uint32_t, SpirvId>& ids, uint32_t typeId, uint32_t matrixStride)
+{
+	auto type = ids.find(typeId);
+	if (type == ids.end())
+	{
+		return 0;
+	}
+
+	const std::vector<uint32_t>& operands = type->second.operands;
+	switch (type->second.opcode)
+	{
+	case SPIRV_OP_TYPE_BOOL:
+		return 4;
+	case SPIRV_OP_TYPE_INT:
+	case SPIRV_OP_TYPE_FLOAT:
+		return operands[0] / 8;
+	case SPIRV_OP_TYPE_VECTOR:
+		return GetTypeSize(ids, operands[0], 0) * operands[1];
+	case SPIRV_OP_TYPE_MATRIX:
+		return (matrixStride != 0 ? matrixStride : GetTypeSize(ids, operands[0], 0)) * operands[1];
+	case SPIRV_OP_TYPE_ARRAY:
+	{
+		//Constants keep their type in front of their value
+		auto length = ids.find(operands[1]);
+		uint32_t count = length != ids.end() && length->second.operands.size() > 1 ? length->second.operands[1] : 0;
+		uint32_t stride = type->second.arrayStride != 0 ? type->second.arrayStride : GetTypeSize(ids, operands[0], matrixStride);
+		return stride * count;
+	}
+	case SPIRV_OP_TYPE_STRUCT:
+	{
+		//The block ends where its furthest member does, members without an offset are not laid out in memory
+		uint32_t size = 0;
+		for (size_t member = 0; member < operands.size(); ++member)
+		{
+			if (member < type->second.memberOffsets.size())
+			{
+				uint32_t memberStride = member < type->second.memberMatrixStrides.size() ?
+					type->second.memberMatrixStrides[member] : 0;
+				size = std::max(size, type->second.memberOffsets[member] + GetTypeSize(ids, operands[member], memberStride));
+			}
+		}
+		return size;
+	}
+	default:
+		//Runtime arrays have no size of their own
+		return 0;
+	}
+}
+
+//Returns the format of one to four 32 bit components of a scalar or vector type, 0 for any other type
+static VkFormat GetInputFormat(const std::unordered_map<uint32_t, SpirvId>& ids, uint32_t typeId)
+{
+	static const VkFormat floatFormats[4] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT,
+		VK_FORMAT_R32G32B32A32_SFLOAT };
+	static const VkFormat intFormats[4] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT,
+		VK_FORMAT_R32G32B32A32_SINT };
+	static const VkFormat uintFormats[4] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT,
+		VK_FORMAT_R32G32B32A32_UINT };
+
+	auto type = ids.find(typeId);
+	if (type == ids.end())
+	{
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	uint32_t componentCount = 1;
+	if (type->second.opcode == SPIRV_OP_TYPE_VECTOR)
+	{
+		componentCount = type->second.operands[1];
+		type = ids.find(type->second.operands[0]);
+	}
+	if (type == ids.end() || componentCount < 1 || componentCount > 4)
+	{
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	if (type->second.opcode == SPIRV_OP_TYPE_FLOAT)
+	{
+		return floatFormats[componentCount - 1];
+	}
+	if (type->second.opcode == SPIRV_OP_TYPE_INT)
+	{
+		//The second operand is the signedness
+		return type->second.operands[1] != 0 ? intFormats[componentCount - 1] : uintFormats[componentCount - 1];
+	}
+	return VK_FORMAT_UNDEFINED;
+}
+
+/******************************************************************************
+* Function Argument 1: The id table of the module							  *
+* Function Argument 2: The type the variable points to, arrays stripped		  *
+* Function Argument 3: The storage class of the variable					  *
+* Function Argument 4: Receives the descriptor type of the variable			  *
+******************************************************************************/
+static bool GetDescriptorType(const std::unordered_map<uint32_t, SpirvId>& ids, const SpirvId& type, uint32_t storageClass,
+	VkDescriptorType& descriptorType)
+{
+	if (storageClass == SPIRV_STORAGE_STORAGE_BUFFER)
+	{
+		descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		return true;
+	}
+	if (storageClass == SPIRV_STORAGE_UNIFORM)
+	{
+		//Before SPIR-V 1.3 storage buffers were uniform blocks decorated as buffer blocks
+		descriptorType = type.bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		return true;
+	}
+	if (storageClass != SPIRV_STORAGE_UNIFORM_CONSTANT)
+	{
+		return false;
+	}
+
+	const SpirvId* image = &type;
+	if (type.opcode == SPIRV_OP_TYPE_SAMPLED_IMAGE)
+	{
+		auto sampledImage = ids.find(type.operands[0]);
+		if (sampledImage == ids.end())
+		{
+			return false;
+		}
+		image = &sampledImage->second;
+	}
+
+	if (type.opcode == SPIRV_OP_TYPE_SAMPLER)
+	{
+		descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+		return true;
+	}
+	if (image->opcode != SPIRV_OP_TYPE_IMAGE)
+	{
+		return false;
+	}
+
+	//The image operands are the sampled type, dimension, depth, arrayed, multisampled and sampled, 2 meaning storage
+	uint32_t dimension = image->operands[1];
+	bool storage = image->operands[5] == 2;
+	if (dimension == SPIRV_DIM_SUBPASS_DATA)
+	{
+		descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+	}
+	else if (dimension == SPIRV_DIM_BUFFER)
+	{
+		descriptorType = storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+	}
+	else if (storage)
+	{
+		descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	}
+	else
+	{
+		descriptorType = type.opcode == SPIRV_OP_TYPE_SAMPLED_IMAGE ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER :
+			VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	}
+	return true;
+}
+
+/*******************************************************************************
+* Function Argument 1: The code of a SPIR-V module, as read from its file	   *
+* Function Argument 2: Receives the interface of the module's entry point	   *
+*******************************************************************************/
+bool ReflectSpirv(const std::vector<char>& code, ShaderReflection& reflection)
+{
+	reflection.stage = VK_SHADER_STAGE_VERTEX_BIT;
+	reflection.descriptors.clear();
+	reflection.pushConstantSize = 0;
+	reflection.vertexInputs.clear();
+
+	if (code.size() % sizeof(uint32_t) != 0 || code.size() < SPIRV_HEADER_WORDS * sizeof(uint32_t))
+	{
+		return false;
+	}
+
+	//The file may not be aligned for words, so they are copied out
+	std::vector<uint32_t> words(code.size() / sizeof(uint32_t));
+	std::memcpy(words.data(), code.data(), code.size());
+	if (words[0] != SPIRV_MAGIC)
+	{
+		return false;
+	}
+
+	/* Reading the instructions */
+	std::unordered_map<uint32_t, SpirvId> ids;
+	std::vector<uint32_t> variables;
+	bool foundEntryPoint = false;
+	uint32_t executionModel = 0;
+	for (size_t word = SPIRV_HEADER_WORDS; word < words.size();)
+	{
+		uint32_t wordCount = words[word] >> 16;
+		uint32_t opcode = words[word] & 0xFFFF;
+		if (wordCount == 0 || word + wordCount > words.size())
+		{
+			return false;
+		}
+		const uint32_t* operands = &words[word + 1];
+		uint32_t operandCount = wordCount - 1;
+
+		switch (opcode)
+		{
+		case SPIRV_OP_ENTRY_POINT:
+			if (!foundEntryPoint && operandCount >= 1)
+			{
+				executionModel = operands[0];
+				foundEntryPoint = true;
+			}
+			break;
+		case SPIRV_OP_DECORATE:
+			if (operandCount >= 2)
+			{
+				SpirvId& target = ids[operands[0]];
+				uint32_t literal = operandCount >= 3 ? operands[2] : 0;
+				switch (operands[1])
+				{
+				case SPIRV_DECORATION_BUFFER_BLOCK: target.bufferBlock = true; break;
+				case SPIRV_DECORATION_ARRAY_STRIDE: target.arrayStride = literal; break;
+				case SPIRV_DECORATION_BUILT_IN: target.builtIn = true; break;
+				case SPIRV_DECORATION_LOCATION: target.location = literal; target.hasLocation = true; break;
+				case SPIRV_DECORATION_BINDING: target.binding = literal; target.hasBinding = true; break;
+				case SPIRV_DECORATION_DESCRIPTOR_SET: target.set = literal; target.hasSet = true; break;
+				default: break;
+				}
+			}
+			break;
+		case SPIRV_OP_MEMBER_DECORATE:
+			if (operandCount >= 4 && (operands[2] == SPIRV_DECORATION_OFFSET || operands[2] == SPIRV_DECORATION_MATRIX_STRIDE))
+			{
+				SpirvId& target = ids[operands[0]];
+				std::vector<uint32_t>& values = operands[2] == SPIRV_DECORATION_OFFSET ? target.memberOffsets :
+					target.memberMatrixStrides;
+				if (values.size() <= operands[1])
+				{
+					values.resize(operands[1] + 1, 0);
+				}
+				values[operands[1]] = operands[3];
+			}
+			break;
+		case SPIRV_OP_TYPE_BOOL:
+		case SPIRV_OP_TYPE_INT:
+		case SPIRV_OP_TYPE_FLOAT:
+		case SPIRV_OP_TYPE_VECTOR:
+		case SPIRV_OP_TYPE_MATRIX:
+		case SPIRV_OP_TYPE_IMAGE:
+		case SPIRV_OP_TYPE_SAMPLER:
+		case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+		case SPIRV_OP_TYPE_ARRAY:
+		case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+		case SPIRV_OP_TYPE_STRUCT:
+		case SPIRV_OP_TYPE_POINTER:
+			if (operandCount >= 1)
+			{
+				SpirvId& type = ids[operands[0]];
+				type.opcode = opcode;
+				type.operands.assign(operands + 1, operands + operandCount);
+			}
+			break;
+		case SPIRV_OP_CONSTANT:
+		case SPIRV_OP_VARIABLE:
+			if (operandCount >= 3)
+			{
+				//Variables keep their pointer type and storage class, constants their type and value
+				SpirvId& id = ids[operands[1]];
+				id.opcode = opcode;
+				id.operands.assign(operands + 2, operands + operandCount);
+				id.operands.insert(id.operands.begin(), operands[0]);
+				if (opcode == SPIRV_OP_VARIABLE)
+				{
+					variables.push_back(operands[1]);
+				}
+			}
+			break;
+		default:
+			break;
+		}
+
+		word += wordCount;
+	}
+	/* Instructions read */
+
+	if (!foundEntryPoint)
+	{
+		return false;
+	}
+
+	//Execution models are numbered in the same order as the first six shader stage bits
+	const VkShaderStageFlagBits stages[] = { VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+		VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, VK_SHADER_STAGE_GEOMETRY_BIT, VK_SHADER_STAGE_FRAGMENT_BIT,
+		VK_SHADER_STAGE_COMPUTE_BIT };
+	if (executionModel >= sizeof(stages) / sizeof(stages[0]))
+	{
+		return false;
+	}
+	reflection.stage = stages[executionModel];
+
+	/* Reflecting the variables */
+	for (uint32_t variableId : variables)
+	{
+		const SpirvId& variable = ids[variableId];
+		//The operands of a variable are its pointer type and storage class
+		uint32_t storageClass = variable.operands[1];
+		auto pointer = ids.find(variable.operands[0]);
+		if (pointer == ids.end() || pointer->second.opcode != SPIRV_OP_TYPE_POINTER)
+		{
+			return false;
+		}
+		uint32_t pointeeId = pointer->second.operands[1];
+
+		if (storageClass == SPIRV_STORAGE_PUSH_CONSTANT)
+		{
+			reflection.pushConstantSize = std::max(reflection.pushConstantSize, GetTypeSize(ids, pointeeId, 0));
+			continue;
+		}
+
+		if (storageClass == SPIRV_STORAGE_INPUT)
+		{
+			if (reflection.stage == VK_SHADER_STAGE_VERTEX_BIT && variable.hasLocation && !variable.builtIn)
+			{
+				reflection.vertexInputs.push_back({ variable.location, GetInputFormat(ids, pointeeId) });
+			}
+			continue;
+		}
+
+		if (!variable.hasBinding)
+		{
+			continue;
+		}
+
+		/* Describing the descriptor */
+		//An array of resources is a single binding with a descriptor per element
+		uint32_t descriptorCount = 1;
+		auto type = ids.find(pointeeId);
+		if (type != ids.end() && type->second.opcode == SPIRV_OP_TYPE_ARRAY)
+		{
+			auto length = ids.find(type->second.operands[1]);
+			descriptorCount = length != ids.end() && length->second.operands.size() > 1 ? length->second.operands[1] : 1;
+			type = ids.find(type->second.operands[0]);
+		}
+
+		VkDescriptorType descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		if (type == ids.end() || !GetDescriptorType(ids, type->second, storageClass, descriptorType))
+		{
+			return false;
+		}
+
+		ShaderDescriptorBinding descriptor{};
+		descriptor.set = variable.hasSet ? variable.set : 0;
+		descriptor.binding.binding = variable.binding;
+		descriptor.binding.descriptorType = descriptorType;
+		descriptor.binding.descriptorCount = descriptorCount;
+		descriptor.binding.stageFlags = reflection.stage;
+		reflection.descriptors.push_back(descriptor);
+		/* Descriptor described */
+	}
+	/* Variables reflected */
+
+	std::sort(reflection.descriptors.begin(), reflection.descriptors.end(),
+		[](const ShaderDescriptorBinding& a, const ShaderDescriptorBinding& b)
+		{
+			return a.set != b.set ? a.set < b.set : a.binding.binding < b.binding.binding;
+		});
+	return true;
+}
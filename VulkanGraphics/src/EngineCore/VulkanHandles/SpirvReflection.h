@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "VulkanDevice.h"
+
+//A descriptor binding a shader declares, and the set it is in
+struct ShaderDescriptorBinding
+{
+	uint32_t set;
+	//The stage flags only hold the stage of the shader it was reflected from
+	VkDescriptorSetLayoutBinding binding;
+};
+
+//An input of a vertex shader, with the format of the 32 bit components it is declared with. A vertex buffer can
+//store it packed, as long as the fetch hardware expands it to the same component type
+struct ShaderVertexInput
+{
+	uint32_t location;
+	VkFormat format;
+};
+
+/*******************************************************************
+* The interface of a SPIR-V module, read from its decorations	   *
+* and types instead of being written out next to every pipeline	   *
+*******************************************************************/
+struct ShaderReflection
+{
+	VkShaderStageFlagBits stage;
+
+	std::vector<ShaderDescriptorBinding> descriptors;
+
+	//The size of the push constant block, 0 if the shader has none. Its members are counted from offset 0
+	uint32_t pushConstantSize;
+
+	//Empty for every stage but the vertex stage, built-in inputs are left out
+	std::vector<ShaderVertexInput> vertexInputs;
+};
+
+//Reads the stage, descriptors, push constants and vertex inputs of the module's first entry point.
+//Returns false if the code is not valid SPIR-V or uses a resource type no descriptor type matches
+bool ReflectSpirv(const std::vector<char>& code, ShaderReflection& reflection);
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "VulkanDevice.h"
+
+//Attribute offsets and vertex strides are kept to a multiple of this, which every GPU fetches without splitting reads
+#define VERTEX_ATTRIBUTE_ALIGNMENT 4
+
+//Describes a vertex struct member read with the default format of its type, see VertexMemberFormat
+#define VERTEX_ATTRIBUTE(Vertex, member, location) \
+	VertexAttributeLayout{ location, VertexMemberFormat<decltype(Vertex::member)>::format, \
+		static_cast<uint32_t>(offsetof(Vertex, member)), static_cast<uint32_t>(sizeof(Vertex::member)) }
+
+//Describes a vertex struct member read with the given format, needed by the packed types whose bits can be
+//normalized, scaled or integers
+#define VERTEX_ATTRIBUTE_FORMAT(Vertex, member, location, vertexFormat) \
+	VertexAttributeLayout{ location, vertexFormat, static_cast<uint32_t>(offsetof(Vertex, member)), \
+		static_cast<uint32_t>(sizeof(Vertex::member)) }
+
+//The bytes the fetch hardware reads for a vertex format, 0 for the formats vertex layouts do not use
+constexpr uint32_t GetVertexFormatSize(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SNORM:
+	case VK_FORMAT_R8G8B8A8_UINT:
+	case VK_FORMAT_R16G16_UNORM:
+	case VK_FORMAT_R16G16_SNORM:
+	case VK_FORMAT_R16G16_UINT:
+	case VK_FORMAT_R16G16_SINT:
+	case VK_FORMAT_R16G16_SFLOAT:
+	case VK_FORMAT_R32_SFLOAT:
+	case VK_FORMAT_R32_UINT:
+	case VK_FORMAT_R32_SINT:
+		return 4;
+	case VK_FORMAT_R16G16B16A16_UNORM:
+	case VK_FORMAT_R16G16B16A16_SNORM:
+	case VK_FORMAT_R16G16B16A16_UINT:
+	case VK_FORMAT_R16G16B16A16_SINT:
+	case VK_FORMAT_R16G16B16A16_SFLOAT:
+	case VK_FORMAT_R32G32_SFLOAT:
+	case VK_FORMAT_R32G32_UINT:
+	case VK_FORMAT_R32G32_SINT:
+		return 8;
+	case VK_FORMAT_R32G32B32_SFLOAT:
+	case VK_FORMAT_R32G32B32_UINT:
+	case VK_FORMAT_R32G32B32_SINT:
+		return 12;
+	case VK_FORMAT_R32G32B32A32_SFLOAT:
+	case VK_FORMAT_R32G32B32A32_UINT:
+	case VK_FORMAT_R32G32B32A32_SINT:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+//The formats of one to four 32 bit components of a type. Smaller types have none, as the same bits can be read
+//several ways, so their members have to name a format
+template<typename Component>
+struct VertexComponentFormats;
+
+template<>
+struct VertexComponentFormats<float>
+{
+	static constexpr VkFormat formats[4] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT,
+		VK_FORMAT_R32G32B32A32_SFLOAT };
+};
+
+template<>
+struct VertexComponentFormats<int32_t>
+{
+	static constexpr VkFormat formats[4] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT,
+		VK_FORMAT_R32G32B32A32_SINT };
+};
+
+template<>
+struct VertexComponentFormats<uint32_t>
+{
+	static constexpr VkFormat formats[4] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT,
+		VK_FORMAT_R32G32B32A32_UINT };
+};
+
+//The default format of a vertex struct member, a single component or an array of up to four
+template<typename Member>
+struct VertexMemberFormat
+{
+	static constexpr VkFormat format = VertexComponentFormats<Member>::formats[0];
+};
+
+template<typename Component, size_t Count>
+struct VertexMemberFormat<Component[Count]>
+{
+	static_assert(Count >= 1 && Count <= 4, "A vertex attribute has one to four components");
+	static constexpr VkFormat format = VertexComponentFormats<Component>::formats[Count - 1];
+};
+
+//One attribute of a vertex layout, made by VERTEX_ATTRIBUTE or VERTEX_ATTRIBUTE_FORMAT
+struct VertexAttributeLayout
+{
+	uint32_t location;
+	VkFormat format;
+	uint32_t offset;
+	//The size of the member, which the format has to read exactly
+	uint32_t memberSize;
+};
+
+/*******************************************************************
+* The vertex input binding and attributes of a C++ vertex struct,  *
+* built at compile time from its member declarations. The checks   *
+* below are meant for static_assert where the layout is defined,   *
+* so a struct and its formats can not drift apart unnoticed		   *
+*******************************************************************/
+template<typename Vertex, size_t AttributeCount>
+class VertexLayout
+{
+	static_assert(std::is_standard_layout<Vertex>::value, "Vertex offsets are only defined for standard layout structs");
+	static_assert(sizeof(Vertex) % VERTEX_ATTRIBUTE_ALIGNMENT == 0, "The vertex stride is not aligned");
+	static_assert(AttributeCount > 0, "A vertex layout needs at least one attribute");
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	constexpr VertexLayout(const VertexAttributeLayout (&attributes)[AttributeCount], uint32_t binding,
+		VkVertexInputRate inputRate)
+		:vk_binding{ binding, static_cast<uint32_t>(sizeof(Vertex)), inputRate }, vk_attributes{},
+		m_formatsMatchMembers{true}, m_offsetsAligned{true}, m_locationsUnique{true}
+	{
+		for (size_t i = 0; i < AttributeCount; ++i)
+		{
+			vk_attributes[i].location = attributes[i].location;
+			vk_attributes[i].binding = binding;
+			vk_attributes[i].format = attributes[i].format;
+			vk_attributes[i].offset = attributes[i].offset;
+
+			m_formatsMatchMembers = m_formatsMatchMembers && GetVertexFormatSize(attributes[i].format) == attributes[i].memberSize;
+			m_offsetsAligned = m_offsetsAligned && attributes[i].offset % VERTEX_ATTRIBUTE_ALIGNMENT == 0;
+			for (size_t j = 0; j < i; ++j)
+			{
+				m_locationsUnique = m_locationsUnique && attributes[j].location != attributes[i].location;
+			}
+		}
+	}
+
+	//Appends the binding and attributes to the ones of a pipeline description
+	void FillVertexInput(std::vector<VkVertexInputBindingDescription>& bindings,
+		std::vector<VkVertexInputAttributeDescription>& attributes) const
+	{
+		bindings.push_back(vk_binding);
+		attributes.insert(attributes.end(), vk_attributes, vk_attributes + AttributeCount);
+	}
+
+	/* Member variable getters */
+	constexpr const VkVertexInputBindingDescription& GetVulkanSDKBinding() const { return vk_binding; }
+
+	constexpr const VkVertexInputAttributeDescription* GetVulkanSDKAttributes() const { return vk_attributes; }
+
+	constexpr uint32_t GetAttributeCount() const { return static_cast<uint32_t>(AttributeCount); }
+
+	//Whether every format reads exactly the bytes of its member, so a packed member can not be read as the wrong type
+	constexpr bool FormatsMatchMembers() const { return m_formatsMatchMembers; }
+
+	constexpr bool OffsetsAligned() const { return m_offsetsAligned; }
+
+	constexpr bool LocationsUnique() const { return m_locationsUnique; }
+	/* End member variable getters */
+private:
+	VkVertexInputBindingDescription vk_binding;
+	VkVertexInputAttributeDescription vk_attributes[AttributeCount];
+
+	bool m_formatsMatchMembers;
+	bool m_offsetsAligned;
+	bool m_locationsUnique;
+};
+
+/***********************************************************************
+* Function Argument 1: The attributes of the vertex struct, in any	   *
+*					   order										   *
+* Function Argument 2: The vertex buffer binding they are read from	   *
+* Function Argument 3: Whether the binding advances per vertex or per  *
+*					   instance										   *
+***********************************************************************/
+template<typename Vertex, size_t AttributeCount>
+constexpr VertexLayout<Vertex, AttributeCount> MakeVertexLayout(const VertexAttributeLayout (&attributes)[AttributeCount],
+	uint32_t binding = 0, VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX)
+{
+	return VertexLayout<Vertex, AttributeCount>(attributes, binding, inputRate);
+}
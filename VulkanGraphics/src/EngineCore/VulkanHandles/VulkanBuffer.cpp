@@ -0,0 +1,80 @@
+#include "VulkanBuffer.h"
+
+VulkanBufferHandle::VulkanBufferHandle()
+	:vk_buffer{VK_NULL_HANDLE}, vk_memory{VK_NULL_HANDLE}, m_mappedData{nullptr}, m_size{0}
+{
+
+}
+
+/*************************************************************************************
+* Function Argument 1: The device handle is needed to create the buffer and to find  *
+*					   a memory type with the requested properties					 *
+* Function Argument 2: The size of the buffer in bytes								 *
+* Function Argument 3: How the buffer will be used (transfer source, vertex etc)	 *
+* Function Argument 4: The properties of the memory the buffer is bound to			 *
+* Function Argument 5: Extra properties the memory gets if a memory type has them   *
+*************************************************************************************/
+void VulkanBufferHandle::CreateBuffer(const VulkanDeviceHandle& device, VkDeviceSize size,
+	VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryProperties, VkMemoryPropertyFlags preferredProperties)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	m_size = size;
+
+	/* Initializing create info struct for the buffer */
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	/* Create info struct complete */
+
+	VkResult bufferResult = vkCreateBuffer(vk_device, &bufferInfo, nullptr, &vk_buffer);
+	if (bufferResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(vk_device, vk_buffer, &memoryRequirements);
+
+	/* Initializing allocate info struct for the buffer's memory */
+	VkMemoryAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = memoryRequirements.size;
+	if (!preferredProperties || !device.TryFindMemoryTypeIndex(memoryRequirements.memoryTypeBits,
+		memoryProperties | preferredProperties, allocateInfo.memoryTypeIndex))
+	{
+		allocateInfo.memoryTypeIndex = device.FindMemoryTypeIndex(memoryRequirements.memoryTypeBits, memoryProperties);
+	}
+	/* Allocate info struct complete */
+
+	VkResult allocateResult = vkAllocateMemory(vk_device, &allocateInfo, nullptr, &vk_memory);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	vkBindBufferMemory(vk_device, vk_buffer, vk_memory, 0);
+
+	if (memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		VkResult mapResult = vkMapMemory(vk_device, vk_memory, 0, VK_WHOLE_SIZE, 0, &m_mappedData);
+		if (mapResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+}
+
+void VulkanBufferHandle::Cleanup(const VkDevice& device)
+{
+	if (m_mappedData)
+	{
+		vkUnmapMemory(device, vk_memory);
+		m_mappedData = nullptr;
+	}
+	vkDestroyBuffer(device, vk_buffer, nullptr);
+	vkFreeMemory(device, vk_memory, nullptr);
+	vk_buffer = VK_NULL_HANDLE;
+	vk_memory = VK_NULL_HANDLE;
+}
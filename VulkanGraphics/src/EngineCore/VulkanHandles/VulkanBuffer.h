@@ -0,0 +1,41 @@
+#pragma once
+
+#include "VulkanDevice.h"
+
+/****************************************************************
+* Holds a vulkan SDK buffer and the memory bound to it. Buffers *
+* created in host visible memory stay mapped for their whole    *
+* lifetime, so the CPU can write into them at any time          *
+****************************************************************/
+class VulkanBufferHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanBufferHandle();
+
+	//Creates the buffer, allocates its memory and maps it if the memory is host visible. The preferred properties
+	//are added to the required ones if a memory type has them all
+	void CreateBuffer(const VulkanDeviceHandle& device, VkDeviceSize size, VkBufferUsageFlags usage,
+		VkMemoryPropertyFlags memoryProperties, VkMemoryPropertyFlags preferredProperties = 0);
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline const VkBuffer& GetVulkanSDKBuffer() const { return vk_buffer; }
+
+	inline const VkDeviceMemory& GetVulkanSDKMemory() const { return vk_memory; }
+
+	//Null if the buffer's memory is not host visible
+	inline void* GetMappedData() const { return m_mappedData; }
+
+	inline VkDeviceSize GetSize() const { return m_size; }
+	/* End member variable getters */
+private:
+	VkBuffer vk_buffer;
+
+	VkDeviceMemory vk_memory;
+
+	void* m_mappedData;
+
+	VkDeviceSize m_size;
+};
@@ -1,15 +1,22 @@
 #include "EngineCore/VulkanCore.h"
 
-void VulkanCommandBufferHandle::CreateCommandBuffer(const VulkanDeviceHandle& device)
+#include <cstring>
+
+void VulkanCommandBufferHandle::CreateCommandBuffer(const VulkanDeviceHandle& device, uint32_t framesInFlight)
 {
 	CreateCommandPool(device);
-	CreateCommandBufferInner(device.GetVulkanSDKLogicalDevice());
+	CreateCommandBufferInner(device.GetVulkanSDKLogicalDevice(), framesInFlight);
 }
 
-void VulkanCommandBufferHandle::RecordCommandBuffer(const VulkanSwapchainHandle& swapchain,
-	const VulkanGraphicsPipelineHandle& graphicsPipeline, const VulkanFramebufferHandle& framebuffer,
-	uint32_t imageIndex)
+void VulkanCommandBufferHandle::RecordCommandBuffer(const VulkanGraphicsPipelineHandle& graphicsPipeline,
+	const FrameDrawList& drawList, VulkanGpuProfilerHandle& profiler, const VulkanMeshHandle& mesh,
+	VulkanParticleSystemHandle& particles, const VulkanClusteredLightingHandle& lighting,
+	const VulkanShadowCascadesHandle& shadows, VulkanOverlayBatcherHandle& overlay, VulkanFrameCaptureHandle& capture,
+	const VulkanMultiviewTargetsHandle& multiviewTargets, const Mat4& viewProjection, uint32_t currentFrame)
 {
+	//Every frame in flight records into its own command buffer
+	const VkCommandBuffer& vk_commandBuffer = vk_commandBuffers[currentFrame];
+
 	//Starting the command buffer
 	VkCommandBufferBeginInfo commandBufferBegin{};
 	commandBufferBegin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -22,47 +29,302 @@ void VulkanCommandBufferHandle::RecordCommandBuffer(const VulkanSwapchainHandle&
 		__debugbreak();
 	}
 
+	//The profiler's queries are reset before the render pass, so that they can be written during it
+	profiler.BeginFrame(vk_commandBuffer, currentFrame);
+	profiler.BeginScope(vk_commandBuffer, "Frame", false);
+
+	//Compute work cannot be recorded inside a render pass, so the particles are simulated before any begins,
+	//once for all the targets
+	particles.RecordSimulation(vk_commandBuffer, profiler);
+	lighting.RecordBinning(vk_commandBuffer, profiler, currentFrame);
+	shadows.RecordShadowMaps(vk_commandBuffer, graphicsPipeline, profiler, mesh);
+	overlay.RecordUpload(vk_commandBuffer);
+
+	if (multiviewTargets.IsCreated())
+	{
+		//The scene is recorded once for every view, then each target shows the views side by side
+		RecordMultiviewPass(vk_commandBuffer, multiviewTargets, graphicsPipeline, profiler, mesh, drawList.meshDraws,
+			particles, viewProjection, currentFrame);
+		for (const FrameRenderTarget& target : drawList.targets)
+		{
+			multiviewTargets.RecordPresentBlit(vk_commandBuffer, target.vk_image, target.vk_extent, target.finalLayout);
+		}
+	}
+	else
+	{
+		//Every target shows the same camera, so they all read the clusters binned once for it
+		VkDescriptorSet lightingSet = lighting.IsCreated() ? lighting.GetVulkanSDKDescriptorSet(currentFrame) :
+			VK_NULL_HANDLE;
+		VkDescriptorSet shadowSet = shadows.IsCreated() ? shadows.GetVulkanSDKDescriptorSet(currentFrame) :
+			VK_NULL_HANDLE;
+		for (const FrameRenderTarget& target : drawList.targets)
+		{
+			if (target.vk_gbufferSet != VK_NULL_HANDLE)
+			{
+				RecordDeferredPass(vk_commandBuffer, target, graphicsPipeline, profiler, mesh, drawList.meshDraws,
+					particles, overlay, viewProjection, lightingSet, shadowSet, currentFrame);
+			}
+			else
+			{
+				RecordRenderPass(vk_commandBuffer, target, graphicsPipeline, profiler, mesh, drawList.meshDraws,
+					particles, overlay, viewProjection, lightingSet, shadowSet, currentFrame);
+			}
+		}
+	}
+
+	//The render pass has left the image ready to present or copy, the capture puts it back the way it found it.
+	//Only the first target, the primary window or the batch frame, is captured
+	capture.RecordCapture(vk_commandBuffer, drawList.targets[0].vk_image, drawList.targets[0].finalLayout, currentFrame);
+	profiler.EndScope(vk_commandBuffer);
+	profiler.EndFrame();
+
+	VkResult endCommandBufferResult = vkEndCommandBuffer(vk_commandBuffer);
+	if (endCommandBufferResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+}
+
+void VulkanCommandBufferHandle::RecordRenderPass(const VkCommandBuffer& vk_commandBuffer, const FrameRenderTarget& target,
+	const VulkanGraphicsPipelineHandle& graphicsPipeline, VulkanGpuProfilerHandle& profiler,
+	const VulkanMeshHandle& mesh, const FrameVector<MeshDrawRange>& meshDraws, const VulkanParticleSystemHandle& particles,
+	const VulkanOverlayBatcherHandle& overlay, const Mat4& viewProjection, const VkDescriptorSet& lightingSet,
+	const VkDescriptorSet& shadowSet, uint32_t currentFrame)
+{
 	//Starting the render pass
 	VkRenderPassBeginInfo renderPassInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	renderPassInfo.renderPass = graphicsPipeline.GetVulkanSDKRenderPass();
-	renderPassInfo.framebuffer = (framebuffer.GetVulkanSDKFramebuffers())[imageIndex];
-	renderPassInfo.renderArea.extent = swapchain.GetSwapchainExtent();
+	renderPassInfo.framebuffer = target.vk_framebuffer;
+	renderPassInfo.renderArea.extent = target.vk_extent;
 	renderPassInfo.renderArea.offset = { 0, 0 };
 
-	VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };
-	renderPassInfo.clearValueCount = 1;
-	renderPassInfo.pClearValues = &clearColor;
+	//The color attachment is cleared to black and the depth attachment to the far plane
+	VkClearValue clearValues[2]{};
+	clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
+	clearValues[1].depthStencil = { 1.0f, 0 };
+	renderPassInfo.clearValueCount = 2;
+	renderPassInfo.pClearValues = clearValues;
 
 	vkCmdBeginRenderPass(vk_commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-	//Starting the vulkan pipeline
-	vkCmdBindPipeline(vk_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline.GetVulkanSDKGraphicsPipeline());
+	//Statistics queries must begin and end in the same render pass, so this scope is nested inside it
+	{
+		GpuProfileScope mainPassScope(profiler, vk_commandBuffer, "MainPass", true);
+		RecordDrawCommands(vk_commandBuffer, target.vk_extent, graphicsPipeline, mesh, meshDraws, particles,
+			viewProjection, VK_NULL_HANDLE, lightingSet, shadowSet);
+
+		//Drawn last and without depth, so it lands over the scene and the particles
+		GpuProfileScope overlayScope(profiler, vk_commandBuffer, "Overlay", false);
+		overlay.RecordDraw(vk_commandBuffer, graphicsPipeline, target.vk_extent, currentFrame, false);
+	}
+
+	vkCmdEndRenderPass(vk_commandBuffer);
+}
+
+void VulkanCommandBufferHandle::RecordDeferredPass(const VkCommandBuffer& vk_commandBuffer, const FrameRenderTarget& target,
+	const VulkanGraphicsPipelineHandle& graphicsPipeline, VulkanGpuProfilerHandle& profiler,
+	const VulkanMeshHandle& mesh, const FrameVector<MeshDrawRange>& meshDraws, const VulkanParticleSystemHandle& particles,
+	const VulkanOverlayBatcherHandle& overlay, const Mat4& viewProjection, const VkDescriptorSet& lightingSet,
+	const VkDescriptorSet& shadowSet, uint32_t currentFrame)
+{
+	VkRenderPassBeginInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = graphicsPipeline.GetVulkanSDKDeferredRenderPass();
+	renderPassInfo.framebuffer = target.vk_framebuffer;
+	renderPassInfo.renderArea.extent = target.vk_extent;
+	renderPassInfo.renderArea.offset = { 0, 0 };
+
+	//The colour and depth are cleared like in the main render pass, the G-buffer's albedo and normal to zero
+	VkClearValue clearValues[1 + GBUFFER_ATTACHMENT_COUNT]{};
+	clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
+	clearValues[1].depthStencil = { 1.0f, 0 };
+	renderPassInfo.clearValueCount = 1 + GBUFFER_ATTACHMENT_COUNT;
+	renderPassInfo.pClearValues = clearValues;
+
+	//Keeps the name of the main render pass's scope so the light benchmark times either pass. Statistics queries
+	//cannot span subpasses, so only the scope of each subpass records them
+	GpuProfileScope mainPassScope(profiler, vk_commandBuffer, "MainPass", false);
+	vkCmdBeginRenderPass(vk_commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	RecordViewport(vk_commandBuffer, target.vk_extent);
+
+	/* Writing the G-buffer */
+	if (mesh.IsLoaded())
+	{
+		GpuProfileScope gbufferScope(profiler, vk_commandBuffer, "GBufferPass", true);
+		const VkPipelineLayout& pipelineLayout = graphicsPipeline.GetVulkanSDKGBufferMeshPipelineLayout();
+		vkCmdBindPipeline(vk_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline.GetVulkanSDKGBufferMeshPipeline());
+		MeshPushConstants pushConstants{};
+		std::memcpy(pushConstants.viewProjection, viewProjection.m, sizeof(pushConstants.viewProjection));
+		mesh.FillDecodeConstants(pushConstants);
+		vkCmdPushConstants(vk_commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants),
+			&pushConstants);
+		mesh.RecordDraw(vk_commandBuffer, meshDraws);
+	}
+	/* G-buffer written */
+
+	vkCmdNextSubpass(vk_commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+
+	/* Lighting the G-buffer and drawing the unlit geometry */
+	{
+		GpuProfileScope lightingScope(profiler, vk_commandBuffer, "LightingPass", true);
+		if (mesh.IsLoaded())
+		{
+			//The clustered variant reads the lights from the set before the G-buffer's, the shadowed variant the
+			//cascades from the set after it
+			const VkPipelineLayout& pipelineLayout = graphicsPipeline.GetVulkanSDKDeferredLightingPipelineLayout();
+			vkCmdBindPipeline(vk_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+				graphicsPipeline.GetVulkanSDKDeferredLightingPipeline());
+			const bool lit = lightingSet != VK_NULL_HANDLE;
+			const bool shadowed = shadowSet != VK_NULL_HANDLE;
+			VkDescriptorSet sets[3];
+			uint32_t setCount = 0;
+			if (lit)
+			{
+				sets[setCount++] = lightingSet;
+			}
+			sets[setCount++] = target.vk_gbufferSet;
+			if (shadowed)
+			{
+				sets[setCount++] = shadowSet;
+			}
+			vkCmdBindDescriptorSets(vk_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, setCount, sets,
+				0, nullptr);
+			//The lights and the cascades need the pixel's world position, rebuilt from its depth through the inverse of
+			//the camera's matrix
+			if (lit || shadowed)
+			{
+				Mat4 inverseViewProjection = Inverse(viewProjection);
+				vkCmdPushConstants(vk_commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(Mat4),
+					inverseViewProjection.m);
+			}
+			vkCmdDraw(vk_commandBuffer, 3, 1, 0, 0);
+		}
+		else
+		{
+			vkCmdBindPipeline(vk_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline.GetVulkanSDKDeferredPipeline());
+			vkCmdDraw(vk_commandBuffer, 3, 1, 0, 0);
+		}
+
+		particles.RecordDraw(vk_commandBuffer, graphicsPipeline, viewProjection, target.vk_extent, VK_NULL_HANDLE, true);
 
+		GpuProfileScope overlayScope(profiler, vk_commandBuffer, "Overlay", false);
+		overlay.RecordDraw(vk_commandBuffer, graphicsPipeline, target.vk_extent, currentFrame, true);
+	}
+	/* G-buffer lit */
+
+	vkCmdEndRenderPass(vk_commandBuffer);
+}
+
+void VulkanCommandBufferHandle::RecordMultiviewPass(const VkCommandBuffer& vk_commandBuffer,
+	const VulkanMultiviewTargetsHandle& multiviewTargets, const VulkanGraphicsPipelineHandle& graphicsPipeline,
+	VulkanGpuProfilerHandle& profiler, const VulkanMeshHandle& mesh, const FrameVector<MeshDrawRange>& meshDraws,
+	const VulkanParticleSystemHandle& particles, const Mat4& viewProjection, uint32_t currentFrame)
+{
+	//Inside a multiview render pass every query uses one index per view, which the profiler does not allocate,
+	//so the scope wraps the whole pass and records no statistics
+	GpuProfileScope multiviewPassScope(profiler, vk_commandBuffer, "MultiviewPass", false);
+
+	VkRenderPassBeginInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = graphicsPipeline.GetVulkanSDKMultiviewRenderPass();
+	renderPassInfo.framebuffer = multiviewTargets.GetVulkanSDKFramebuffer();
+	renderPassInfo.renderArea.extent = multiviewTargets.GetViewExtent();
+	renderPassInfo.renderArea.offset = { 0, 0 };
+
+	//Every layer is cleared the same way as the single view targets
+	VkClearValue clearValues[2]{};
+	clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
+	clearValues[1].depthStencil = { 1.0f, 0 };
+	renderPassInfo.clearValueCount = 2;
+	renderPassInfo.pClearValues = clearValues;
+
+	vkCmdBeginRenderPass(vk_commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+	RecordDrawCommands(vk_commandBuffer, multiviewTargets.GetViewExtent(), graphicsPipeline, mesh, meshDraws, particles,
+		viewProjection, multiviewTargets.GetVulkanSDKDescriptorSet(currentFrame), VK_NULL_HANDLE, VK_NULL_HANDLE);
+
+	vkCmdEndRenderPass(vk_commandBuffer);
+}
+
+void VulkanCommandBufferHandle::RecordDrawCommands(const VkCommandBuffer& vk_commandBuffer,
+	const VkExtent2D& extent, const VulkanGraphicsPipelineHandle& graphicsPipeline, const VulkanMeshHandle& mesh,
+	const FrameVector<MeshDrawRange>& meshDraws, const VulkanParticleSystemHandle& particles, const Mat4& viewProjection,
+	const VkDescriptorSet& multiviewSet,
+	const VkDescriptorSet& lightingSet, const VkDescriptorSet& shadowSet)
+{
+	const bool multiview = multiviewSet != VK_NULL_HANDLE;
+
+	RecordViewport(vk_commandBuffer, extent);
+
+	if (mesh.IsLoaded())
+	{
+		//The multiview variant still takes the decoding parameters as push constants, only the matrices move to the set
+		const VkPipelineLayout& pipelineLayout = multiview ? graphicsPipeline.GetVulkanSDKMultiviewMeshPipelineLayout() :
+			graphicsPipeline.GetVulkanSDKMeshPipelineLayout();
+		vkCmdBindPipeline(vk_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, multiview ?
+			graphicsPipeline.GetVulkanSDKMultiviewMeshPipeline() : graphicsPipeline.GetVulkanSDKMeshPipeline());
+		if (multiview)
+		{
+			vkCmdBindDescriptorSets(vk_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &multiviewSet,
+				0, nullptr);
+		}
+		else
+		{
+			//The lit and shadowed variants take the lights' set first and the cascades' set after it, each from set 0
+			//when the other is not used
+			VkDescriptorSet sets[2];
+			uint32_t setCount = 0;
+			if (lightingSet != VK_NULL_HANDLE)
+			{
+				sets[setCount++] = lightingSet;
+			}
+			if (shadowSet != VK_NULL_HANDLE)
+			{
+				sets[setCount++] = shadowSet;
+			}
+			if (setCount != 0)
+			{
+				vkCmdBindDescriptorSets(vk_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, setCount,
+					sets, 0, nullptr);
+			}
+		}
+		MeshPushConstants pushConstants{};
+		std::memcpy(pushConstants.viewProjection, viewProjection.m, sizeof(pushConstants.viewProjection));
+		mesh.FillDecodeConstants(pushConstants);
+		vkCmdPushConstants(vk_commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants),
+			&pushConstants);
+		mesh.RecordDraw(vk_commandBuffer, meshDraws);
+	}
+	else
+	{
+		//Starting the vulkan pipeline
+		vkCmdBindPipeline(vk_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, multiview ?
+			graphicsPipeline.GetVulkanSDKMultiviewPipeline() : graphicsPipeline.GetVulkanSDKGraphicsPipeline());
+
+		//Start drawing
+		vkCmdDraw(vk_commandBuffer, 3, 1, 0, 0);
+	}
+
+	//Drawn last, they are tested against the depth of everything else but do not write it
+	particles.RecordDraw(vk_commandBuffer, graphicsPipeline, viewProjection, extent, multiviewSet, false);
+}
+
+void VulkanCommandBufferHandle::RecordViewport(const VkCommandBuffer& vk_commandBuffer, const VkExtent2D& extent)
+{
 	VkViewport viewport{};
 	viewport.x = 0.0f;
 	viewport.y = 0.0f;
-	viewport.width = static_cast<float>(swapchain.GetSwapchainExtent().width);
-	viewport.height = static_cast<float>(swapchain.GetSwapchainExtent().height);
+	viewport.width = static_cast<float>(extent.width);
+	viewport.height = static_cast<float>(extent.height);
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
 	vkCmdSetViewport(vk_commandBuffer, 0, 1, &viewport);
 
 	VkRect2D scissor{};
 	scissor.offset = { 0, 0 };
-	scissor.extent = swapchain.GetSwapchainExtent();
+	scissor.extent = extent;
 	vkCmdSetScissor(vk_commandBuffer, 0, 1, &scissor);
-
-	//Start drawing
-	vkCmdDraw(vk_commandBuffer, 3, 1, 0, 0);
-
-	//Ending the render pass and the command buffer
-	vkCmdEndRenderPass(vk_commandBuffer);
-	VkResult endCommandBufferResult = vkEndCommandBuffer(vk_commandBuffer);
-	if (endCommandBufferResult != VK_SUCCESS)
-	{
-		__debugbreak();
-	}
 }
 
 void VulkanCommandBufferHandle::CreateCommandPool(const VulkanDeviceHandle& device)
@@ -83,15 +345,16 @@ void VulkanCommandBufferHandle::CreateCommandPool(const VulkanDeviceHandle& devi
 	}
 }
 
-void VulkanCommandBufferHandle::CreateCommandBufferInner(const VkDevice& device)
+void VulkanCommandBufferHandle::CreateCommandBufferInner(const VkDevice& device, uint32_t framesInFlight)
 {
 	VkCommandBufferAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	allocInfo.commandPool = vk_commandPool;
 	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandBufferCount = 1;
+	allocInfo.commandBufferCount = framesInFlight;
 
-	VkResult commandBufferResult = vkAllocateCommandBuffers(device, &allocInfo, &vk_commandBuffer);
+	vk_commandBuffers.resize(framesInFlight);
+	VkResult commandBufferResult = vkAllocateCommandBuffers(device, &allocInfo, vk_commandBuffers.data());
 	if (commandBufferResult != VK_SUCCESS)
 	{
 		__debugbreak();
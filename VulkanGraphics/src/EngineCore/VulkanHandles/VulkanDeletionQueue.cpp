@@ -0,0 +1,62 @@
+#include "VulkanDeletionQueue.h"
+
+VulkanDeletionQueue::VulkanDeletionQueue()
+	:m_mutex(), m_pendingDeletions(), m_frameDeletions()
+{
+
+}
+
+void VulkanDeletionQueue::CreateDeletionQueue(uint32_t framesInFlight)
+{
+	m_frameDeletions.resize(framesInFlight);
+}
+
+void VulkanDeletionQueue::SubmitFrame(uint32_t frameIndex)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	//The slot's list was emptied when its fence was waited on, right before this frame was recorded
+	std::vector<PendingDeletion>& frameDeletions = m_frameDeletions[frameIndex];
+	frameDeletions.insert(frameDeletions.end(), m_pendingDeletions.begin(), m_pendingDeletions.end());
+	m_pendingDeletions.clear();
+}
+
+/*****************************************************************************
+* Function Argument 1: The device the handles were created with				 *
+* Function Argument 2: The frame slot whose fence has just been waited on	 *
+*****************************************************************************/
+void VulkanDeletionQueue::DestroyFrame(const VkDevice& device, uint32_t frameIndex)
+{
+	//Swapped out so the handles are destroyed without holding the lock
+	std::vector<PendingDeletion> deletions;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		deletions.swap(m_frameDeletions[frameIndex]);
+	}
+	DestroyAll(device, deletions);
+
+	//Handing the (now empty) storage back, so the slot does not allocate again next frame
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_frameDeletions[frameIndex].empty())
+	{
+		m_frameDeletions[frameIndex].swap(deletions);
+	}
+}
+
+void VulkanDeletionQueue::Cleanup(const VkDevice& device)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (std::vector<PendingDeletion>& frameDeletions : m_frameDeletions)
+	{
+		DestroyAll(device, frameDeletions);
+	}
+	DestroyAll(device, m_pendingDeletions);
+}
+
+void VulkanDeletionQueue::DestroyAll(const VkDevice& device, std::vector<PendingDeletion>& deletions)
+{
+	for (const PendingDeletion& deletion : deletions)
+	{
+		deletion.destroy(device, deletion.handle);
+	}
+	deletions.clear();
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "VulkanDevice.h"
+
+//The signature shared by every vkDestroy* and vkFree* function of a device child object
+template<typename Handle>
+using VulkanDestroyFunction = void (VKAPI_PTR*)(VkDevice device, Handle handle, const VkAllocationCallbacks* allocator);
+
+/******************************************************************
+* Destroys handles released at runtime only once the GPU is done  *
+* with them. A released handle waits in the pending list until    *
+* the next frame is submitted, then in that frame slot's list	  *
+* until the slot's fence signals. Nothing waits on the device, and *
+* frames still in flight never lose a resource they are using	  *
+******************************************************************/
+class VulkanDeletionQueue
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanDeletionQueue();
+
+	//Creates one deletion list per frame in flight
+	void CreateDeletionQueue(uint32_t framesInFlight);
+
+	//Queues a handle for destruction, can be called from any thread. The handle must not be used by work submitted
+	//after this call, work submitted before it may still be running
+	template<typename Handle, VulkanDestroyFunction<Handle> Destroy>
+	void Release(Handle handle)
+	{
+		if (handle == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		//Non dispatchable handles are pointers on 64 bit and integers on 32 bit, both fit in 64 bits
+		static_assert(sizeof(Handle) <= sizeof(uint64_t), "Vulkan handles fit in 64 bits");
+		uint64_t bits = 0;
+		std::memcpy(&bits, &handle, sizeof(Handle));
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingDeletions.push_back({ bits, &DestroyHandle<Handle, Destroy> });
+	}
+
+	//Called right after a frame is submitted, its fence now also covers every handle released before the submit
+	void SubmitFrame(uint32_t frameIndex);
+
+	//Called once the frame's fence has signalled, destroys the handles released before that frame was submitted
+	void DestroyFrame(const VkDevice& device, uint32_t frameIndex);
+
+	//Destroys every handle that was released, the device must be idle
+	void Cleanup(const VkDevice& device);
+private:
+	struct PendingDeletion
+	{
+		uint64_t handle;
+		void (*destroy)(const VkDevice& device, uint64_t handle);
+	};
+
+	template<typename Handle, VulkanDestroyFunction<Handle> Destroy>
+	static void DestroyHandle(const VkDevice& device, uint64_t bits)
+	{
+		Handle handle;
+		std::memcpy(&handle, &bits, sizeof(Handle));
+		Destroy(device, handle, nullptr);
+	}
+
+	//Destroys the handles in the order they were released, so views go before their images and images before their memory
+	static void DestroyAll(const VkDevice& device, std::vector<PendingDeletion>& deletions);
+private:
+	//Releases can come from jobs, so the lists are guarded
+	std::mutex m_mutex;
+
+	//Released since the last submit, not covered by any fence yet
+	std::vector<PendingDeletion> m_pendingDeletions;
+
+	//Released before each frame slot's last submit, destroyed once that slot's fence signals
+	std::vector<std::vector<PendingDeletion>> m_frameDeletions;
+};
+
+/******************************************************************
+* Owns a single Vulkan handle and releases it to a deletion queue *
+* when it is destroyed, reset or assigned a new handle, so a	  *
+* resource replaced at runtime is freed once the frames using it  *
+* have finished. Can be moved but not copied					  *
+******************************************************************/
+template<typename Handle, VulkanDestroyFunction<Handle> Destroy>
+class VulkanUniqueHandle
+{
+public:
+	VulkanUniqueHandle()
+		:m_deletionQueue{nullptr}, vk_handle{VK_NULL_HANDLE}
+	{
+
+	}
+
+	VulkanUniqueHandle(VulkanDeletionQueue* deletionQueue, Handle handle)
+		:m_deletionQueue{deletionQueue}, vk_handle{handle}
+	{
+
+	}
+
+	VulkanUniqueHandle(VulkanUniqueHandle&& other) noexcept
+		:m_deletionQueue{other.m_deletionQueue}, vk_handle{other.vk_handle}
+	{
+		other.vk_handle = VK_NULL_HANDLE;
+	}
+
+	VulkanUniqueHandle& operator=(VulkanUniqueHandle&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+			m_deletionQueue = other.m_deletionQueue;
+			vk_handle = other.vk_handle;
+			other.vk_handle = VK_NULL_HANDLE;
+		}
+		return *this;
+	}
+
+	VulkanUniqueHandle(const VulkanUniqueHandle&) = delete;
+	VulkanUniqueHandle& operator=(const VulkanUniqueHandle&) = delete;
+
+	~VulkanUniqueHandle()
+	{
+		Reset();
+	}
+
+	//Hands the handle to the deletion queue, the handle reads VK_NULL_HANDLE afterwards
+	void Reset()
+	{
+		if (vk_handle != VK_NULL_HANDLE)
+		{
+			m_deletionQueue->Release<Handle, Destroy>(vk_handle);
+			vk_handle = VK_NULL_HANDLE;
+		}
+	}
+
+	/* Member variable getters */
+	inline const Handle& Get() const { return vk_handle; }
+	/* End member variable getters */
+private:
+	VulkanDeletionQueue* m_deletionQueue;
+
+	Handle vk_handle;
+};
+
+typedef VulkanUniqueHandle<VkBuffer, vkDestroyBuffer> VulkanUniqueBuffer;
+typedef VulkanUniqueHandle<VkImage, vkDestroyImage> VulkanUniqueImage;
+typedef VulkanUniqueHandle<VkImageView, vkDestroyImageView> VulkanUniqueImageView;
+typedef VulkanUniqueHandle<VkDeviceMemory, vkFreeMemory> VulkanUniqueDeviceMemory;
+typedef VulkanUniqueHandle<VkSampler, vkDestroySampler> VulkanUniqueSampler;
+typedef VulkanUniqueHandle<VkPipeline, vkDestroyPipeline> VulkanUniquePipeline;
+typedef VulkanUniqueHandle<VkPipelineLayout, vkDestroyPipelineLayout> VulkanUniquePipelineLayout;
+typedef VulkanUniqueHandle<VkFramebuffer, vkDestroyFramebuffer> VulkanUniqueFramebuffer;
+typedef VulkanUniqueHandle<VkSwapchainKHR, vkDestroySwapchainKHR> VulkanUniqueSwapchain;
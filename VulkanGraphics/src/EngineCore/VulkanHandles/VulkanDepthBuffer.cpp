@@ -0,0 +1,96 @@
+#include "VulkanDepthBuffer.h"
+
+VulkanDepthBufferHandle::VulkanDepthBufferHandle()
+	:vk_image{VK_NULL_HANDLE}, vk_memory{VK_NULL_HANDLE}, vk_imageView{VK_NULL_HANDLE}, vk_format{VK_FORMAT_UNDEFINED}
+{
+
+}
+
+VkFormat VulkanDepthBufferHandle::FindDepthFormat(const VkPhysicalDevice& physicalDevice)
+{
+	//Ordered by preference, 32 bit float depth without stencil is the most precise
+	const VkFormat candidates[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT };
+	for (VkFormat format : candidates)
+	{
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+		if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+		{
+			return format;
+		}
+	}
+
+	//Every GPU has to support at least one of the formats above
+	__debugbreak();
+	return VK_FORMAT_UNDEFINED;
+}
+
+/**********************************************************************************
+* Function Argument 1: The device handle is needed to pick the format, create the *
+*					   image and find a device local memory type for it			  *
+* Function Argument 2: The depth buffer has to be the same size as the swapchain  *
+**********************************************************************************/
+void VulkanDepthBufferHandle::CreateDepthBuffer(const VulkanDeviceHandle& device, const VkExtent2D& swapchainExtent)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	vk_format = FindDepthFormat(device.GetVulkanSDKPhysicalDevice());
+
+	/* Initializing create info struct for the depth image */
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = vk_format;
+	imageInfo.extent = { swapchainExtent.width, swapchainExtent.height, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	/* Create info struct complete */
+
+	VkResult imageResult = vkCreateImage(vk_device, &imageInfo, nullptr, &vk_image);
+	if (imageResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(vk_device, vk_image, &memoryRequirements);
+
+	VkMemoryAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = memoryRequirements.size;
+	allocateInfo.memoryTypeIndex = device.FindMemoryTypeIndex(memoryRequirements.memoryTypeBits,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	VkResult allocateResult = vkAllocateMemory(vk_device, &allocateInfo, nullptr, &vk_memory);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	vkBindImageMemory(vk_device, vk_image, vk_memory, 0);
+
+	/* Initializing create info struct for the depth image view */
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = vk_image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = vk_format;
+	viewInfo.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+	/* Create info struct complete */
+
+	VkResult viewResult = vkCreateImageView(vk_device, &viewInfo, nullptr, &vk_imageView);
+	if (viewResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+}
+
+void VulkanDepthBufferHandle::Cleanup(const VkDevice& device)
+{
+	vkDestroyImageView(device, vk_imageView, nullptr);
+	vkDestroyImage(device, vk_image, nullptr);
+	vkFreeMemory(device, vk_memory, nullptr);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "VulkanDevice.h"
+
+/*************************************************************
+* Holds the depth image shared by every swapchain framebuffer *
+* and the image view used to attach it to the render pass     *
+*************************************************************/
+class VulkanDepthBufferHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanDepthBufferHandle();
+
+	//Picks a depth format the GPU can render to and creates an image of the swapchain's size with it
+	void CreateDepthBuffer(const VulkanDeviceHandle& device, const VkExtent2D& swapchainExtent);
+
+	void Cleanup(const VkDevice& device);
+
+	//Returns the first depth format that can be used as a depth attachment with optimal tiling
+	static VkFormat FindDepthFormat(const VkPhysicalDevice& physicalDevice);
+
+	/* Member variable getters */
+	inline const VkImageView& GetVulkanSDKImageView() const { return vk_imageView; }
+
+	inline VkFormat GetDepthFormat() const { return vk_format; }
+	/* End member variable getters */
+private:
+	VkImage vk_image;
+
+	VkDeviceMemory vk_memory;
+
+	VkImageView vk_imageView;
+
+	VkFormat vk_format;
+};
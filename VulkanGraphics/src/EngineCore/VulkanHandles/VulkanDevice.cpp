@@ -2,8 +2,9 @@
 
 VulkanDeviceHandle::VulkanDeviceHandle()
 	:vk_GraphicsCard{VK_NULL_HANDLE}, m_GPUQueueFamilyIndices(),
-	m_GPUSwapchainSupportDetails(), vk_device(), vk_graphicsQueue(),
-	vk_presentQueue()
+	m_GPUSwapchainSupportDetails(), m_GPUProperties(), m_GPUFeatures(), m_GPUMemoryProperties(), m_enabledFeatures(),
+	m_graphicsQueueTimestampValidBits{0}, m_graphicsQueueSupportsCompute{false},
+	m_timelineSemaphoresEnabled{false}, m_maxMultiviewViewCount{0}, vk_device(), vk_graphicsQueue(), vk_presentQueue()
 {
 
 }
@@ -15,13 +16,47 @@ VulkanDeviceHandle::VulkanDeviceHandle()
 void VulkanDeviceHandle::CreateVulkanLogicalDevice(const VulkanInstanceHandle & instance, const VkSurfaceKHR& vk_surface)
 {
 	ChoosePhysicalDevice(instance.GetVulkanSDKInstance(), vk_surface);
-	SetupLogicalDevice(instance.GetVulkanSDKInstance());
+	SetupLogicalDevice(instance);
+}
+
+/**********************************************************************************************
+* Function Argument 1: The instance handle is needed to check the instance extensions that    *
+*					   some of the optional device extensions depend on						  *
+**********************************************************************************************/
+void VulkanDeviceHandle::FindOptionalDeviceExtensions(const VulkanInstanceHandle& instance)
+{
+	/* Getting all the extensions supported by the chosen GPU */
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(vk_GraphicsCard, nullptr, &extensionCount, nullptr);
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(vk_GraphicsCard, nullptr, &extensionCount, availableExtensions.data());
+	/* GPU extensions saved */
+
+	for (const char* optionalExtension : optionalDeviceExtensions)
+	{
+		//Calibrated timestamps, timeline semaphores and multiview need physical device properties 2 on a Vulkan 1.0 instance
+		if ((!strcmp(optionalExtension, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) ||
+			!strcmp(optionalExtension, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) ||
+			!strcmp(optionalExtension, VK_KHR_MULTIVIEW_EXTENSION_NAME)) &&
+			!instance.IsExtensionEnabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+		{
+			continue;
+		}
+
+		for (const VkExtensionProperties& extension : availableExtensions)
+		{
+			if (!strcmp(extension.extensionName, optionalExtension))
+			{
+				m_enabledExtensions.insert(optionalExtension);
+			}
+		}
+	}
 }
 
 /*********************************************************************************************************
-* Function Argument 1: The Vulkan SDK's instance object is needed for the creation of the logical device *
+* Function Argument 1: The instance handle is needed to decide which optional extensions can be enabled *
 *********************************************************************************************************/
-void VulkanDeviceHandle::SetupLogicalDevice(const VkInstance& vk_instance)
+void VulkanDeviceHandle::SetupLogicalDevice(const VulkanInstanceHandle& instance)
 {
 	/*Initializing an array of create info sturcts for all queue families chosen from the GPU*/
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
@@ -42,6 +77,9 @@ void VulkanDeviceHandle::SetupLogicalDevice(const VkInstance& vk_instance)
 
 	/* Initializing device features struct that enables the device features needed for the application */
 	VkPhysicalDeviceFeatures deviceFeatures{};
+	//Pipeline statistics are optional, they are only used by the GPU profiler
+	deviceFeatures.pipelineStatisticsQuery = m_GPUFeatures.pipelineStatisticsQuery;
+	m_enabledFeatures = deviceFeatures;
 	/* Device Features struct complete */
 
 	/* Initializing create info struct for device */
@@ -52,9 +90,35 @@ void VulkanDeviceHandle::SetupLogicalDevice(const VkInstance& vk_instance)
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	//Passing the previously defined device features struct to enable the features defined
 	createInfo.pEnabledFeatures = &deviceFeatures;
-	//Passing the constant deviceExtensions array to enable the extensions needed for the application
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+	//Passing the constant deviceExtensions array to enable the extensions needed for the application,
+	//along with any optional extensions that the GPU supports
+	m_enabledExtensions.insert(deviceExtensions.begin(), deviceExtensions.end());
+	FindOptionalDeviceExtensions(instance);
+	//The timeline semaphore and multiview features have to be enabled on top of their extensions
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+	timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+	timelineFeatures.timelineSemaphore = VK_TRUE;
+	m_timelineSemaphoresEnabled = CheckTimelineSemaphoreSupport(instance);
+	if (m_timelineSemaphoresEnabled)
+	{
+		timelineFeatures.pNext = const_cast<void*>(createInfo.pNext);
+		createInfo.pNext = &timelineFeatures;
+	}
+	VkPhysicalDeviceMultiviewFeaturesKHR multiviewFeatures{};
+	multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES_KHR;
+	multiviewFeatures.multiview = VK_TRUE;
+	if (CheckMultiviewSupport(instance))
+	{
+		multiviewFeatures.pNext = const_cast<void*>(createInfo.pNext);
+		createInfo.pNext = &multiviewFeatures;
+	}
+	std::vector<const char*> enabledExtensions;
+	for (const std::string& extension : m_enabledExtensions)
+	{
+		enabledExtensions.push_back(extension.c_str());
+	}
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+	createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 	/* Create info struct complete */
 
 	//Creating the device and checking if its creation was succesful
@@ -68,6 +132,77 @@ void VulkanDeviceHandle::SetupLogicalDevice(const VkInstance& vk_instance)
 
 }
 
+/*******************************************************************************************************
+* Function Argument 1: The instance handle is needed to load the physical device features 2 function *
+*******************************************************************************************************/
+bool VulkanDeviceHandle::CheckTimelineSemaphoreSupport(const VulkanInstanceHandle& instance)
+{
+	if (!IsExtensionEnabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+	{
+		return false;
+	}
+
+	//The extension being listed does not mean the GPU supports the feature
+	PFN_vkGetPhysicalDeviceFeatures2KHR getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+		vkGetInstanceProcAddr(instance.GetVulkanSDKInstance(), "vkGetPhysicalDeviceFeatures2KHR"));
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+	timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+	VkPhysicalDeviceFeatures2KHR features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+	features.pNext = &timelineFeatures;
+	if (getFeatures2)
+	{
+		getFeatures2(vk_GraphicsCard, &features);
+	}
+
+	if (!timelineFeatures.timelineSemaphore)
+	{
+		m_enabledExtensions.erase(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		return false;
+	}
+	return true;
+}
+
+/*******************************************************************************************************
+* Function Argument 1: The instance handle is needed to load the physical device features 2 and	   *
+*					   properties 2 functions														   *
+*******************************************************************************************************/
+bool VulkanDeviceHandle::CheckMultiviewSupport(const VulkanInstanceHandle& instance)
+{
+	if (!IsExtensionEnabled(VK_KHR_MULTIVIEW_EXTENSION_NAME))
+	{
+		return false;
+	}
+
+	PFN_vkGetPhysicalDeviceFeatures2KHR getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+		vkGetInstanceProcAddr(instance.GetVulkanSDKInstance(), "vkGetPhysicalDeviceFeatures2KHR"));
+	PFN_vkGetPhysicalDeviceProperties2KHR getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+		vkGetInstanceProcAddr(instance.GetVulkanSDKInstance(), "vkGetPhysicalDeviceProperties2KHR"));
+	VkPhysicalDeviceMultiviewFeaturesKHR multiviewFeatures{};
+	multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES_KHR;
+	VkPhysicalDeviceFeatures2KHR features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+	features.pNext = &multiviewFeatures;
+	VkPhysicalDeviceMultiviewPropertiesKHR multiviewProperties{};
+	multiviewProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES_KHR;
+	VkPhysicalDeviceProperties2KHR properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+	properties.pNext = &multiviewProperties;
+	if (getFeatures2 && getProperties2)
+	{
+		getFeatures2(vk_GraphicsCard, &features);
+		getProperties2(vk_GraphicsCard, &properties);
+	}
+
+	if (!multiviewFeatures.multiview || multiviewProperties.maxMultiviewViewCount < 2)
+	{
+		m_enabledExtensions.erase(VK_KHR_MULTIVIEW_EXTENSION_NAME);
+		return false;
+	}
+	m_maxMultiviewViewCount = multiviewProperties.maxMultiviewViewCount;
+	return true;
+}
+
 /*****************************************************************************************************************
 * Function Argument 1: The Vulkan SDK's instance object is needed to find the available GPUs                     *
 * Function Argument 2: The Vulkan SDK's surface object is needed to find the device's swapchain support details, *
@@ -96,6 +231,11 @@ void VulkanDeviceHandle::ChoosePhysicalDevice(const VkInstance& vk_instance, con
 	//If no suitable graphics card is found, the application cannot continue
 	if (vk_GraphicsCard == VK_NULL_HANDLE)
 		__debugbreak();
+
+	//Saving the chosen GPU's properties and features, so that optional features can be enabled later
+	vkGetPhysicalDeviceProperties(vk_GraphicsCard, &m_GPUProperties);
+	vkGetPhysicalDeviceFeatures(vk_GraphicsCard, &m_GPUFeatures);
+	vkGetPhysicalDeviceMemoryProperties(vk_GraphicsCard, &m_GPUMemoryProperties);
 }
 
 /****************************************************************************************************************
@@ -156,14 +296,30 @@ void VulkanDeviceHandle::FindDeviceQueueFamilyIndices(const VkPhysicalDevice& de
 	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 	/* GPU queue families found */
 
-	//Checking all of the queue families for graphics support
+	//Checking all of the queue families for graphics support, preferring one that can also run compute shaders
+	//so compute work can be recorded into the frame's command buffer
+	bool graphicsFound = false;
+	m_graphicsQueueSupportsCompute = false;
 	for (uint32_t i = 0; i < queueFamilies.size(); ++i)
 	{
-		//If a queue family with graphics support is found, its index is saved and the loop breaks
-		if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+		if (!(queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+		{
+			continue;
+		}
+
+		bool supportsCompute = (queueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+		if (!graphicsFound || (supportsCompute && !m_graphicsQueueSupportsCompute))
 		{
 			m_GPUQueueFamilyIndices.graphics.index = i;
 			m_GPUQueueFamilyIndices.graphics.indexFound = true;
+			graphicsFound = true;
+			m_graphicsQueueTimestampValidBits = queueFamilies[i].timestampValidBits;
+			m_graphicsQueueSupportsCompute = supportsCompute;
+		}
+
+		//The first family with both is the one used
+		if (m_graphicsQueueSupportsCompute)
+		{
 			break;
 		}
 	}
@@ -213,19 +369,28 @@ bool VulkanDeviceHandle::CheckDeviceExtensionSupport(const VkPhysicalDevice& dev
 * Function Argument 2: The Vulkan SDK's surface object is needed to find the device's swapchain support details *
 ****************************************************************************************************************/
 void VulkanDeviceHandle::GetDeviceSwapchainSupportDetails(const VkPhysicalDevice& device, const VkSurfaceKHR& surface)
+{
+	FillSwapchainSupportDetails(device, surface, m_GPUSwapchainSupportDetails);
+}
+
+/*****************************************************************
+* Function Argument 1: The graphics card the surface is used by  *
+* Function Argument 2: The surface the details are queried for   *
+* Function Argument 3: Filled with the surface's support details *
+*****************************************************************/
+void VulkanDeviceHandle::FillSwapchainSupportDetails(const VkPhysicalDevice& device, const VkSurfaceKHR& surface,
+	SwapchainSupportDetails& details)
 {
 	//The GPU's surface capabilities (min/max number of images in swap chain, min/max width and height of images) are saved
-	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, 
-		&m_GPUSwapchainSupportDetails.surfaceCapabilities);
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.surfaceCapabilities);
 
 	/* Looking for all supported surface formats (pixel format, color space) */
 	uint32_t formatCount;
 	vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
 	if (formatCount)
 	{
-		m_GPUSwapchainSupportDetails.formats.resize(formatCount);
-		vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, 
-			m_GPUSwapchainSupportDetails.formats.data());
+		details.formats.resize(formatCount);
+		vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, details.formats.data());
 	}
 	/* Saved all supported formats, if any were found */
 
@@ -234,13 +399,61 @@ void VulkanDeviceHandle::GetDeviceSwapchainSupportDetails(const VkPhysicalDevice
 	vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, nullptr);
 	if (presentModeCount)
 	{
-		m_GPUSwapchainSupportDetails.presentModes.resize(presentModeCount);
-		vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, 
-			m_GPUSwapchainSupportDetails.presentModes.data());
+		details.presentModes.resize(presentModeCount);
+		vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, details.presentModes.data());
 	}
 	/* Saved all supported presentation modes, if any were found */
 }
 
+SwapchainSupportDetails VulkanDeviceHandle::QuerySurfaceSupportDetails(const VkSurfaceKHR& surface) const
+{
+	SwapchainSupportDetails details;
+	FillSwapchainSupportDetails(vk_GraphicsCard, surface, details);
+	return details;
+}
+
+bool VulkanDeviceHandle::CanPresentToSurface(const VkSurfaceKHR& surface) const
+{
+	VkBool32 presentSupport = VK_FALSE;
+	vkGetPhysicalDeviceSurfaceSupportKHR(vk_GraphicsCard, m_GPUQueueFamilyIndices.present.index, surface, &presentSupport);
+	return presentSupport == VK_TRUE;
+}
+
+/*****************************************************************************************************
+* Function Argument 1: The memory type bits of a buffer or image's memory requirements				 *
+* Function Argument 2: The properties the memory type needs to have (device local, host visible etc) *
+*****************************************************************************************************/
+uint32_t VulkanDeviceHandle::FindMemoryTypeIndex(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const
+{
+	uint32_t memoryTypeIndex = 0;
+	//If no memory type has the requested properties, the resource cannot be created
+	if (!TryFindMemoryTypeIndex(memoryTypeBits, properties, memoryTypeIndex))
+	{
+		__debugbreak();
+	}
+	return memoryTypeIndex;
+}
+
+/*****************************************************************************************************
+* Function Argument 1: The memory type bits of a buffer or image's memory requirements				 *
+* Function Argument 2: The properties the memory type needs to have (device local, host visible etc) *
+* Function Argument 3: Set to the index of the memory type if one is found							 *
+*****************************************************************************************************/
+bool VulkanDeviceHandle::TryFindMemoryTypeIndex(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties,
+	uint32_t& memoryTypeIndex) const
+{
+	for (uint32_t i = 0; i < m_GPUMemoryProperties.memoryTypeCount; ++i)
+	{
+		if ((memoryTypeBits & (1 << i)) && 
+			(m_GPUMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+		{
+			memoryTypeIndex = i;
+			return true;
+		}
+	}
+	return false;
+}
+
 void VulkanDeviceHandle::Cleanup()
 {
 	vkDestroyDevice(vk_device, nullptr);
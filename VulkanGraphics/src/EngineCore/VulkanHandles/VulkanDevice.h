@@ -7,6 +7,10 @@
 //Holds the extensions that we are going to need for the device to have
 const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
+//Holds device extensions that are enabled only if the GPU supports them
+const std::vector<const char*> optionalDeviceExtensions = {VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME,
+	VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME, VK_KHR_MULTIVIEW_EXTENSION_NAME};
+
 //Used to hold the index of a queue family and a boolean that is true if the queue family is found
 struct QueueFamilyIndexChecker
 {
@@ -50,6 +54,30 @@ public:
 	/* Member variable getters */
 	inline const VkDevice& GetVulkanSDKLogicalDevice() const { return vk_device; }
 
+	inline const VkPhysicalDevice& GetVulkanSDKPhysicalDevice() const { return vk_GraphicsCard; }
+
+	inline const VkPhysicalDeviceProperties& GetPhysicalDeviceProperties() const { return m_GPUProperties; }
+
+	inline const VkPhysicalDeviceFeatures& GetEnabledDeviceFeatures() const { return m_enabledFeatures; }
+
+	inline uint32_t GetGraphicsQueueTimestampValidBits() const { return m_graphicsQueueTimestampValidBits; }
+
+	inline bool IsComputeSupportedOnGraphicsQueue() const { return m_graphicsQueueSupportsCompute; }
+
+	inline bool AreTimelineSemaphoresEnabled() const { return m_timelineSemaphoresEnabled; }
+
+	inline bool IsMultiviewEnabled() const { return m_maxMultiviewViewCount != 0; }
+
+	//0 if the logical device was created without the multiview feature
+	inline uint32_t GetMaxMultiviewViewCount() const { return m_maxMultiviewViewCount; }
+
+	inline bool IsExtensionEnabled(const char* extensionName) const
+	{
+		return m_enabledExtensions.count(extensionName) != 0;
+	}
+
+	inline const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const { return m_GPUMemoryProperties; }
+
 	inline uint32_t GetQueueFamilyGraphicsIndex() const { return m_GPUQueueFamilyIndices.graphics.index; }
 
 	inline uint32_t GetQueueFamilyPresentIndex() const { return m_GPUQueueFamilyIndices.present.index; }
@@ -62,6 +90,18 @@ public:
 
 	inline const VkQueue& GetVulkanSDKPresentQueue() const { return vk_presentQueue; }
 	/* End member variable getters */
+
+	//Returns the index of a memory type allowed by memoryTypeBits that has all the requested properties
+	uint32_t FindMemoryTypeIndex(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const;
+
+	//Same as FindMemoryTypeIndex, but returns false instead of stopping if no memory type has the properties
+	bool TryFindMemoryTypeIndex(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties, uint32_t& memoryTypeIndex) const;
+
+	//Returns the chosen GPU's swapchain support details for any surface, not only the one it was chosen with
+	SwapchainSupportDetails QuerySurfaceSupportDetails(const VkSurfaceKHR& surface) const;
+
+	//Returns true if the present queue can present to the surface, every window after the first has to be checked
+	bool CanPresentToSurface(const VkSurfaceKHR& surface) const;
 private:
 	//Finds all the available graphics cards and checks which one is suitable and saves it for logical device creation
 	void ChoosePhysicalDevice(const VkInstance& vk_instance, const VkSurfaceKHR& vk_surface);
@@ -78,9 +118,24 @@ private:
 	//Called by the CheckDeviceSuitability function to save the device's swapchain support details
 	void GetDeviceSwapchainSupportDetails(const VkPhysicalDevice& device, const VkSurfaceKHR& surface);
 
+	//Called by GetDeviceSwapchainSupportDetails and QuerySurfaceSupportDetails to fill the details of a surface
+	static void FillSwapchainSupportDetails(const VkPhysicalDevice& device, const VkSurfaceKHR& surface,
+		SwapchainSupportDetails& details);
+
+
+	//Called by SetupLogicalDevice to add the optional extensions that the chosen GPU supports to the enabled ones
+	void FindOptionalDeviceExtensions(const VulkanInstanceHandle& instance);
+
+	//Called by SetupLogicalDevice to check that the timeline semaphore extension also has its feature,
+	//the extension is dropped if it does not
+	bool CheckTimelineSemaphoreSupport(const VulkanInstanceHandle& instance);
+
+	//Called by SetupLogicalDevice to check that the multiview extension also has its feature and to save how many
+	//views a render pass can have, the extension is dropped if the feature is missing
+	bool CheckMultiviewSupport(const VulkanInstanceHandle& instance);
 
 	//Called after a GPU has been chosen and creates the logical device to interface with it
-	void SetupLogicalDevice(const VkInstance& vk_instance);
+	void SetupLogicalDevice(const VulkanInstanceHandle& instance);
 private:
 	//Vulkan SDK physical device object, used to represent the chosen GPU that the app will interface with
 	VkPhysicalDevice vk_GraphicsCard;
@@ -91,6 +146,33 @@ private:
 	//Holds the chosen GPU's swaphcain support details
 	SwapchainSupportDetails m_GPUSwapchainSupportDetails;
 
+	//Holds the chosen GPU's properties (limits, timestamp period etc)
+	VkPhysicalDeviceProperties m_GPUProperties;
+
+	//Holds the features supported by the chosen GPU
+	VkPhysicalDeviceFeatures m_GPUFeatures;
+
+	//Holds the memory types and heaps of the chosen GPU
+	VkPhysicalDeviceMemoryProperties m_GPUMemoryProperties;
+
+	//Holds the subset of the supported features that was enabled on the logical device
+	VkPhysicalDeviceFeatures m_enabledFeatures;
+
+	//Number of meaningful bits in timestamps written on the graphics queue, 0 if timestamps are not supported
+	uint32_t m_graphicsQueueTimestampValidBits;
+
+	//Set if the graphics queue family can also run compute shaders
+	bool m_graphicsQueueSupportsCompute;
+
+	//Set if the logical device was created with the timeline semaphore feature
+	bool m_timelineSemaphoresEnabled;
+
+	//The most views a multiview render pass can have, only set if the device was created with the multiview feature
+	uint32_t m_maxMultiviewViewCount;
+
+	//Holds the names of the required and optional extensions that the logical device was created with
+	std::set<std::string> m_enabledExtensions;
+
 	//Device class of the vulkan SDK, used to interface with the chosen GPU
 	VkDevice vk_device;
 
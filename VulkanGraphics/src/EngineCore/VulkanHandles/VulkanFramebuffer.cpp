@@ -2,21 +2,24 @@
 
 
 void VulkanFramebufferHandle::CreateFramebuffers(const std::vector<VkImageView>& imageViews, 
-    const VkRenderPass& renderPass, const VkExtent2D& swapchainExtent, const VkDevice& device)
+    const std::vector<VkImageView>& sharedAttachments, const VkRenderPass& renderPass, const VkExtent2D& swapchainExtent,
+    const VkDevice& device)
 {
     //Iterating through all image view to create a framebuffer for each one
 	vk_framebuffers.resize(imageViews.size());
 	for (size_t i = 0; i < imageViews.size(); ++i)
 	{
-		VkImageView attachments[] = { imageViews[i] };
+		//Every framebuffer shares the same depth buffer or G-buffer, the render pass orders the frames using it
+		std::vector<VkImageView> attachments = { imageViews[i] };
+		attachments.insert(attachments.end(), sharedAttachments.begin(), sharedAttachments.end());
         VkFramebufferCreateInfo framebufferInfo{};
         framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
         //The render pass needs to be compatible with the framebuffer,
         //meaning they need to have the same number and type of attachments
         framebufferInfo.renderPass = renderPass;
         //Passing the image views
-        framebufferInfo.attachmentCount = 1;
-        framebufferInfo.pAttachments = attachments;
+        framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        framebufferInfo.pAttachments = attachments.data();
         framebufferInfo.width = swapchainExtent.width;
         framebufferInfo.height = swapchainExtent.height;
         //Our swapchain images are single images, so layers should be 1
@@ -0,0 +1,184 @@
+#include "VulkanGBuffer.h"
+
+#include "VulkanDepthBuffer.h"
+
+VulkanGBufferHandle::VulkanGBufferHandle()
+	:vk_images(), vk_memories(), vk_imageViews(), vk_descriptorPool{VK_NULL_HANDLE}, vk_descriptorSet{VK_NULL_HANDLE},
+	m_lazilyAllocated{true}
+{
+
+}
+
+/*************************************************************************************
+* Function Argument 1: The device handle is needed to create the images and find a	 *
+*					   memory type for them											 *
+* Function Argument 2: The G-buffer has to be the size of the images it is drawn	 *
+*					   next to														 *
+* Function Argument 3: The layout of the lighting subpass's input attachment set	 *
+*************************************************************************************/
+void VulkanGBufferHandle::CreateGBuffer(const VulkanDeviceHandle& device, const VkExtent2D& extent,
+	const VkDescriptorSetLayout& inputSetLayout)
+{
+	vk_images.resize(GBUFFER_ATTACHMENT_COUNT, VK_NULL_HANDLE);
+	vk_memories.resize(GBUFFER_ATTACHMENT_COUNT, VK_NULL_HANDLE);
+	vk_imageViews.resize(GBUFFER_ATTACHMENT_COUNT, VK_NULL_HANDLE);
+
+	//Transient images can only be used as attachments, which is all the G-buffer is ever used as
+	const VkImageUsageFlags inputUsage = VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+	CreateAttachment(device, extent, VulkanDepthBufferHandle::FindDepthFormat(device.GetVulkanSDKPhysicalDevice()),
+		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | inputUsage, VK_IMAGE_ASPECT_DEPTH_BIT, 0);
+	CreateAttachment(device, extent, GBUFFER_ALBEDO_FORMAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | inputUsage,
+		VK_IMAGE_ASPECT_COLOR_BIT, 1);
+	CreateAttachment(device, extent, GBUFFER_NORMAL_FORMAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | inputUsage,
+		VK_IMAGE_ASPECT_COLOR_BIT, 2);
+
+	CreateDescriptorSet(device.GetVulkanSDKLogicalDevice(), inputSetLayout);
+}
+
+/*************************************************************************************
+* Function Argument 1: The device handle is needed to create the image and find a	 *
+*					   memory type for it											 *
+* Function Argument 2: The size of the image										 *
+* Function Argument 3: The format of the image										 *
+* Function Argument 4: How the image is used, always as a transient attachment		 *
+* Function Argument 5: Whether the image holds colour or depth						 *
+* Function Argument 6: Where the image goes in the arrays, its order in the			 *
+*					   framebuffer													 *
+*************************************************************************************/
+void VulkanGBufferHandle::CreateAttachment(const VulkanDeviceHandle& device, const VkExtent2D& extent, VkFormat format,
+	VkImageUsageFlags usage, VkImageAspectFlags aspect, uint32_t index)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+
+	/* Initializing create info struct for the image */
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = format;
+	imageInfo.extent = { extent.width, extent.height, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = usage;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	/* Create info struct complete */
+
+	VkResult imageResult = vkCreateImage(vk_device, &imageInfo, nullptr, &vk_images[index]);
+	if (imageResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	/* Allocating the image's memory */
+	//Lazily allocated memory is only committed if the render pass has to spill the attachment out of tile memory.
+	//Desktop GPUs have no such memory type, the images then live in device local memory like any other attachment
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(vk_device, vk_images[index], &memoryRequirements);
+
+	VkMemoryAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = memoryRequirements.size;
+	if (!device.TryFindMemoryTypeIndex(memoryRequirements.memoryTypeBits,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, allocateInfo.memoryTypeIndex))
+	{
+		allocateInfo.memoryTypeIndex = device.FindMemoryTypeIndex(memoryRequirements.memoryTypeBits,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		m_lazilyAllocated = false;
+	}
+
+	VkResult allocateResult = vkAllocateMemory(vk_device, &allocateInfo, nullptr, &vk_memories[index]);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	vkBindImageMemory(vk_device, vk_images[index], vk_memories[index], 0);
+	/* Memory allocated */
+
+	/* Initializing create info struct for the image view */
+	//An input attachment's view can only have a single aspect, so the depth view leaves out any stencil
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = vk_images[index];
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = format;
+	viewInfo.subresourceRange = { aspect, 0, 1, 0, 1 };
+	/* Create info struct complete */
+
+	VkResult viewResult = vkCreateImageView(vk_device, &viewInfo, nullptr, &vk_imageViews[index]);
+	if (viewResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+}
+
+/*******************************************************************************
+* Function Argument 1: The Vulkan SDK device is needed to create the pool and  *
+*					   write the set										   *
+* Function Argument 2: The layout of the lighting subpass's input attachments  *
+*******************************************************************************/
+void VulkanGBufferHandle::CreateDescriptorSet(const VkDevice& device, const VkDescriptorSetLayout& inputSetLayout)
+{
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+	poolSize.descriptorCount = GBUFFER_ATTACHMENT_COUNT;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = 1;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+
+	VkResult poolResult = vkCreateDescriptorPool(device, &poolInfo, nullptr, &vk_descriptorPool);
+	if (poolResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	VkDescriptorSetAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = vk_descriptorPool;
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts = &inputSetLayout;
+
+	VkResult allocateResult = vkAllocateDescriptorSets(device, &allocateInfo, &vk_descriptorSet);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	//The layouts are the ones the lighting subpass has the attachments in while it reads them
+	VkDescriptorImageInfo imageInfos[GBUFFER_ATTACHMENT_COUNT]{};
+	VkWriteDescriptorSet writes[GBUFFER_ATTACHMENT_COUNT]{};
+	for (uint32_t i = 0; i < GBUFFER_ATTACHMENT_COUNT; ++i)
+	{
+		imageInfos[i].sampler = VK_NULL_HANDLE;
+		imageInfos[i].imageView = vk_imageViews[i];
+		imageInfos[i].imageLayout = i == 0 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL :
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = vk_descriptorSet;
+		writes[i].dstBinding = i;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		writes[i].pImageInfo = &imageInfos[i];
+	}
+	vkUpdateDescriptorSets(device, GBUFFER_ATTACHMENT_COUNT, writes, 0, nullptr);
+}
+
+void VulkanGBufferHandle::Cleanup(const VkDevice& device)
+{
+	vkDestroyDescriptorPool(device, vk_descriptorPool, nullptr);
+	vk_descriptorSet = VK_NULL_HANDLE;
+	for (size_t i = 0; i < vk_images.size(); ++i)
+	{
+		vkDestroyImageView(device, vk_imageViews[i], nullptr);
+		vkDestroyImage(device, vk_images[i], nullptr);
+		vkFreeMemory(device, vk_memories[i], nullptr);
+	}
+	vk_images.clear();
+	vk_memories.clear();
+	vk_imageViews.clear();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include "VulkanDevice.h"
+
+//The formats of the G-buffer's colour attachments. The normal is stored as 10 bits per component, half the size of
+//a float format, as every byte of every pixel of the G-buffer has to fit in the GPU's tile memory
+#define GBUFFER_ALBEDO_FORMAT VK_FORMAT_R8G8B8A8_UNORM
+#define GBUFFER_NORMAL_FORMAT VK_FORMAT_A2B10G10R10_UNORM_PACK32
+
+//Depth, albedo and normal, in the order they follow the colour attachment of the deferred render pass, and the order
+//of the input attachments and bindings the lighting subpass reads them through
+#define GBUFFER_ATTACHMENT_COUNT 3u
+
+/*****************************************************************
+* Holds the depth, albedo and normal images the deferred render  *
+* pass writes in its first subpass and reads as input			 *
+* attachments in its second. They never leave the render pass,	 *
+* so they are transient and, where the GPU has it, in lazily	 *
+* allocated memory that tile based GPUs never back with real	 *
+* memory. Also holds the descriptor set of the input attachments *
+*****************************************************************/
+class VulkanGBufferHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanGBufferHandle();
+
+	//Creates the images with the given extent, and the descriptor set of the lighting subpass reading them
+	void CreateGBuffer(const VulkanDeviceHandle& device, const VkExtent2D& extent,
+		const VkDescriptorSetLayout& inputSetLayout);
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline bool IsCreated() const { return vk_descriptorSet != VK_NULL_HANDLE; }
+
+	//True if the images are in lazily allocated memory, false if the GPU has none and they are in device local memory
+	inline bool IsLazilyAllocated() const { return m_lazilyAllocated; }
+
+	//Depth, albedo and normal, attached after the colour image of each framebuffer
+	inline const std::vector<VkImageView>& GetVulkanSDKImageViews() const { return vk_imageViews; }
+
+	inline const VkDescriptorSet& GetVulkanSDKDescriptorSet() const { return vk_descriptorSet; }
+	/* End member variable getters */
+private:
+	//Creates a transient attachment of the G-buffer's extent, its memory and its view
+	void CreateAttachment(const VulkanDeviceHandle& device, const VkExtent2D& extent, VkFormat format,
+		VkImageUsageFlags usage, VkImageAspectFlags aspect, uint32_t index);
+
+	//Called by CreateGBuffer once the images exist, to point the input attachment set at them
+	void CreateDescriptorSet(const VkDevice& device, const VkDescriptorSetLayout& inputSetLayout);
+private:
+	std::vector<VkImage> vk_images;
+	std::vector<VkDeviceMemory> vk_memories;
+	std::vector<VkImageView> vk_imageViews;
+
+	//Every frame reads the same images, so a single set is written once
+	VkDescriptorPool vk_descriptorPool;
+	VkDescriptorSet vk_descriptorSet;
+
+	bool m_lazilyAllocated;
+};
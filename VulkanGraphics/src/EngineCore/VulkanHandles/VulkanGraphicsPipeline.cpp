@@ -1,11 +1,92 @@
 #include "VulkanGraphicsPipeline.h"
 
+#include <algorithm>
+#include <iostream>
+#include "VulkanGBuffer.h"
+
+//The shader files every launch creates pipelines from, the triangle, the mesh and the particles
+static const char* const pipelineShaderFiles[] = { "Shaders/vert.spv", "Shaders/meshVert.spv", "Shaders/frag.spv",
+	"Shaders/particleVert.spv", "Shaders/particleFrag.spv", "Shaders/particleInit.spv", "Shaders/particleBegin.spv",
+	"Shaders/particleEmit.spv", "Shaders/particleSimulate.spv", "Shaders/particleFinish.spv" };
+
+VulkanGraphicsPipelineHandle::VulkanGraphicsPipelineHandle()
+	:vk_graphicsPipeline{VK_NULL_HANDLE}, vk_pipelineLayout{VK_NULL_HANDLE}, vk_meshPipeline{VK_NULL_HANDLE},
+	vk_meshPipelineLayout{VK_NULL_HANDLE}, vk_particlePipeline{VK_NULL_HANDLE}, vk_particlePipelineLayout{VK_NULL_HANDLE},
+	vk_overlayPipeline{VK_NULL_HANDLE}, vk_additiveOverlayPipeline{VK_NULL_HANDLE}, vk_overlayPipelineLayout{VK_NULL_HANDLE},
+	vk_multiviewRenderPass{VK_NULL_HANDLE}, vk_multiviewSetLayout{VK_NULL_HANDLE}, vk_multiviewPipeline{VK_NULL_HANDLE},
+	vk_multiviewPipelineLayout{VK_NULL_HANDLE}, vk_multiviewMeshPipeline{VK_NULL_HANDLE},
+	vk_multiviewMeshPipelineLayout{VK_NULL_HANDLE}, vk_multiviewParticlePipeline{VK_NULL_HANDLE},
+	vk_multiviewParticlePipelineLayout{VK_NULL_HANDLE}, vk_deferredRenderPass{VK_NULL_HANDLE},
+	vk_gbufferSetLayout{VK_NULL_HANDLE}, vk_deferredPipeline{VK_NULL_HANDLE}, vk_deferredPipelineLayout{VK_NULL_HANDLE},
+	vk_gbufferMeshPipeline{VK_NULL_HANDLE}, vk_gbufferMeshPipelineLayout{VK_NULL_HANDLE},
+	vk_deferredLightingPipeline{VK_NULL_HANDLE}, vk_deferredLightingPipelineLayout{VK_NULL_HANDLE},
+	vk_deferredParticlePipeline{VK_NULL_HANDLE}, vk_deferredParticlePipelineLayout{VK_NULL_HANDLE},
+	vk_deferredOverlayPipeline{VK_NULL_HANDLE}, vk_deferredAdditiveOverlayPipeline{VK_NULL_HANDLE},
+	vk_deferredOverlayPipelineLayout{VK_NULL_HANDLE},
+	vk_shadowRenderPass{VK_NULL_HANDLE}, vk_shadowMeshPipeline{VK_NULL_HANDLE}, vk_shadowMeshPipelineLayout{VK_NULL_HANDLE},
+	m_shaderCode(), m_mutex(), m_pipelineRecords(), m_pendingSwaps(), m_reflectedLayouts(),
+	m_layoutCache(), vk_renderPass{VK_NULL_HANDLE}
+{
+
+}
+
+/****************************************************************************
+* Function Argument 1: The optional features whose shaders are read as well *
+****************************************************************************/
+void VulkanGraphicsPipelineHandle::ReadShaderFiles(const ShaderFileGroups& groups)
+{
+	std::vector<const char*> filenames(std::begin(pipelineShaderFiles), std::end(pipelineShaderFiles));
+	if (groups.multiview)
+	{
+		filenames.insert(filenames.end(), { "Shaders/meshMultiviewVert.spv", "Shaders/particleMultiviewVert.spv" });
+	}
+	if (groups.clusteredLighting)
+	{
+		filenames.insert(filenames.end(), { "Shaders/clusterBinning.spv", "Shaders/meshClusteredFrag.spv" });
+	}
+	if (groups.shadows)
+	{
+		filenames.push_back(groups.clusteredLighting ? "Shaders/meshClusteredShadowedFrag.spv" : "Shaders/meshShadowedFrag.spv");
+	}
+	//The lighting subpass has a variant for every combination of lights and shadows, only the one used is read
+	if (groups.deferred)
+	{
+		filenames.insert(filenames.end(), { "Shaders/meshGBufferFrag.spv", "Shaders/deferredLightingVert.spv" });
+		if (groups.clusteredLighting)
+		{
+			filenames.push_back(groups.shadows ? "Shaders/deferredLightingClusteredShadowedFrag.spv" :
+				"Shaders/deferredLightingClusteredFrag.spv");
+		}
+		else
+		{
+			filenames.push_back(groups.shadows ? "Shaders/deferredLightingShadowedFrag.spv" : "Shaders/deferredLightingFrag.spv");
+		}
+	}
+	if (groups.overlay)
+	{
+		filenames.insert(filenames.end(), { "Shaders/overlayVert.spv", "Shaders/overlayFrag.spv" });
+	}
+
+	//The SPIR-V is not committed, it is compiled by the pre-build step running the script in the shader directory
+	for (const char* filename : filenames)
+	{
+		if (!ReadFile(filename, m_shaderCode[filename]))
+		{
+			std::cout << "Shader file " << filename << " is missing, compile the shaders with Shaders/compileShaders.bat or Shaders/compileShaders.sh\n";
+			__debugbreak();
+		}
+	}
+}
+
 /*************************************************************************************************
 * Function argument 1: The swapchain format needs to be passed in the description struct for the * 
 *					   attachment(s)															 *
-* Function argument 2: The Vulkan SDK device is needed for the creation of the render pass		 *
+* Function argument 2: The format of the depth buffer attached next to the swapchain image		 *
+* Function argument 3: The Vulkan SDK device is needed for the creation of the render pass		 *
+* Function argument 4: The layout the colour image is left in, to be presented or copied from	 *
 *************************************************************************************************/
-void VulkanGraphicsPipelineHandle::CreateRenderPass(const VkFormat& swapchainFormat, const VkDevice& device)
+void VulkanGraphicsPipelineHandle::CreateRenderPass(const VkFormat& swapchainFormat, const VkFormat& depthFormat,
+	const VkDevice& device, VkImageLayout colorFinalLayout)
 {
 	/* Initializing attachment description struct */
 	VkAttachmentDescription colorAttachment{};
@@ -21,9 +102,23 @@ void VulkanGraphicsPipelineHandle::CreateRenderPass(const VkFormat& swapchainFor
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	//Setting up how pixels are treated(important for texturing)
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	//Layouts do not affect render pass compatibility, so the pipelines work with either final layout
+	colorAttachment.finalLayout = colorFinalLayout;
 	/* Attachment description struct complete */
 
+	/* Initializing the depth attachment description struct */
+	VkAttachmentDescription depthAttachment{};
+	depthAttachment.format = depthFormat;
+	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	//Depth is only needed while drawing, so it is never written back to memory
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	/* Depth attachment description struct complete */
+
 	/* Initializing attachment reference struct, needed to pass an attachment to a render pass */
 	VkAttachmentReference colorAttachmentRef{};
 	//Specifying the index of the attachment that this references 
@@ -33,37 +128,45 @@ void VulkanGraphicsPipelineHandle::CreateRenderPass(const VkFormat& swapchainFor
 	colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 	/* Attachment reference struct complete */
 
+	VkAttachmentReference depthAttachmentRef{};
+	depthAttachmentRef.attachment = 1;
+	depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
 	/* Initializing subpass description struct */
 	VkSubpassDescription subpass{};
 	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 	//Passing the color attachment reference(s) for the struct
 	subpass.colorAttachmentCount = 1;
 	subpass.pColorAttachments = &colorAttachmentRef;
+	subpass.pDepthStencilAttachment = &depthAttachmentRef;
 	/* Subpass description struct complete */
 
+	//Creating a subpass dependency for the render pass
+	VkSubpassDependency dependency{};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	//The depth buffer is shared by every frame, so the previous frame's depth writes must finish before it is cleared
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	VkAttachmentDescription attachments[] = { colorAttachment, depthAttachment };
+
 	/* Initializing render pass create info struct */
 	VkRenderPassCreateInfo renderPassInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
 	//Passing the attachemnt(s)
-	renderPassInfo.attachmentCount = 1;
-	renderPassInfo.pAttachments = &colorAttachment;
+	renderPassInfo.attachmentCount = 2;
+	renderPassInfo.pAttachments = attachments;
 	//Passing the subpass(es)
 	renderPassInfo.subpassCount = 1;
 	renderPassInfo.pSubpasses = &subpass;
+	//Passing the dependency, so that the image is acquired before the render pass writes to it
+	renderPassInfo.dependencyCount = 1;
+	renderPassInfo.pDependencies = &dependency;
 	/* Render pass create info complete */
 
-	//Creating a subpass dependency for the render pass
-	VkSubpassDependency dependency{};
-	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-	dependency.dstSubpass = 0;
-	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.srcAccessMask = 0;
-	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.srcAccessMask = 0;
-
 	//Creating the render pass and checking if its creation was succesful
 	VkResult renderPassResult = vkCreateRenderPass(device, &renderPassInfo, nullptr, &vk_renderPass);
 	if (renderPassResult != VK_SUCCESS)
@@ -72,26 +175,660 @@ void VulkanGraphicsPipelineHandle::CreateRenderPass(const VkFormat& swapchainFor
 	}
 }
 
+/*************************************************************************************
+* Function argument 1: The format of the layered colour image the views render into *
+* Function argument 2: The format of the layered depth image						*
+* Function argument 3: The Vulkan SDK device is needed for the creation				*
+* Function argument 4: How many views, and layers of the attachments, there are	    *
+*************************************************************************************/
+void VulkanGraphicsPipelineHandle::CreateMultiviewRenderPass(const VkFormat& colorFormat, const VkFormat& depthFormat,
+	const VkDevice& device, uint32_t viewCount)
+{
+	/* Describing the attachments */
+	//The views are blitted to the presented images afterwards, so the colour is left ready to be copied from
+	VkAttachmentDescription attachments[2]{};
+	attachments[0].format = colorFormat;
+	attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+	attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[0].finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+	attachments[1].format = depthFormat;
+	attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+	attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	/* Attachments described */
+
+	VkAttachmentReference colorAttachmentRef{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+	VkAttachmentReference depthAttachmentRef{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colorAttachmentRef;
+	subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+	/* Ordering the render pass against the blits */
+	//The layered images are shared by every frame, so the previous frame's blit has to finish reading the colour
+	//before it is cleared, and this frame's writes have to finish before its blit reads them
+	VkSubpassDependency dependencies[2]{};
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	dependencies[1].srcSubpass = 0;
+	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	/* Render pass ordered */
+
+	/* Setting up the views */
+	//Every view renders into the layer of its index, and they are all rendered from nearly the same place,
+	//which lets the implementation share work between them
+	uint32_t viewMask = (1u << viewCount) - 1;
+	uint32_t correlationMask = viewMask;
+	VkRenderPassMultiviewCreateInfoKHR multiviewInfo{};
+	multiviewInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO_KHR;
+	multiviewInfo.subpassCount = 1;
+	multiviewInfo.pViewMasks = &viewMask;
+	multiviewInfo.correlationMaskCount = 1;
+	multiviewInfo.pCorrelationMasks = &correlationMask;
+	/* Views set up */
+
+	VkRenderPassCreateInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.pNext = &multiviewInfo;
+	renderPassInfo.attachmentCount = 2;
+	renderPassInfo.pAttachments = attachments;
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = 2;
+	renderPassInfo.pDependencies = dependencies;
+
+	VkResult renderPassResult = vkCreateRenderPass(device, &renderPassInfo, nullptr, &vk_multiviewRenderPass);
+	if (renderPassResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	//A single uniform buffer holding the matrix of every view. It is the set the multiview shaders declare, so the
+	//multiview pipelines reflect the same layout out of the cache
+	VkDescriptorSetLayoutBinding binding{};
+	binding.binding = 0;
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	binding.descriptorCount = 1;
+	binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	vk_multiviewSetLayout = m_layoutCache.GetDescriptorSetLayout(device, { binding });
+}
+
+/*************************************************************************************************
+* Function argument 1: The format of the colour image the lighting subpass writes				 *
+* Function argument 2: The format of the G-buffer's depth image									 *
+* Function argument 3: The Vulkan SDK device is needed for the creation of the render pass		 *
+* Function argument 4: The layout the colour image is left in, to be presented or copied from	 *
+*************************************************************************************************/
+void VulkanGraphicsPipelineHandle::CreateDeferredRenderPass(const VkFormat& swapchainFormat, const VkFormat& depthFormat,
+	const VkDevice& device, VkImageLayout colorFinalLayout)
+{
+	/* Describing the attachments */
+	//The colour image comes first, as in the main render pass, then the G-buffer in the order of GBUFFER_ATTACHMENT_COUNT.
+	//Only the colour image is stored, the G-buffer is cleared and thrown away inside the pass, so on a tile based GPU
+	//it never leaves tile memory
+	VkAttachmentDescription attachments[1 + GBUFFER_ATTACHMENT_COUNT]{};
+	const VkFormat formats[] = { swapchainFormat, depthFormat, GBUFFER_ALBEDO_FORMAT, GBUFFER_NORMAL_FORMAT };
+	for (uint32_t i = 0; i < 1 + GBUFFER_ATTACHMENT_COUNT; ++i)
+	{
+		attachments[i].format = formats[i];
+		attachments[i].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachments[i].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachments[i].storeOp = i == 0 ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[i].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachments[i].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+	attachments[0].finalLayout = colorFinalLayout;
+	attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+	/* Attachments described */
+
+	/* Describing the subpasses */
+	//The G-buffer subpass writes the mesh's albedo and normal, and its depth
+	VkAttachmentReference gbufferColorRefs[] = { { 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+		{ 3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL } };
+	VkAttachmentReference gbufferDepthRef{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+	//The lighting subpass reads the pixel it shades out of the G-buffer. The depth stays attached read only next to
+	//being an input, so the unlit draws after the lighting are still hidden behind the mesh
+	VkAttachmentReference lightingColorRef{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+	VkAttachmentReference lightingInputRefs[] = { { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL },
+		{ 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, { 3, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL } };
+	VkAttachmentReference lightingDepthRef{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+
+	VkSubpassDescription subpasses[2]{};
+	subpasses[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpasses[0].colorAttachmentCount = GBUFFER_ATTACHMENT_COUNT - 1;
+	subpasses[0].pColorAttachments = gbufferColorRefs;
+	subpasses[0].pDepthStencilAttachment = &gbufferDepthRef;
+
+	subpasses[1].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpasses[1].inputAttachmentCount = GBUFFER_ATTACHMENT_COUNT;
+	subpasses[1].pInputAttachments = lightingInputRefs;
+	subpasses[1].colorAttachmentCount = 1;
+	subpasses[1].pColorAttachments = &lightingColorRef;
+	subpasses[1].pDepthStencilAttachment = &lightingDepthRef;
+	/* Subpasses described */
+
+	/* Ordering the subpasses */
+	//The G-buffer is shared by every frame, so the previous frame has to be done writing and reading it before it is
+	//cleared. The colour image is first used by the lighting subpass, which waits for it to be acquired
+	VkSubpassDependency dependencies[3]{};
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	dependencies[1].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].dstSubpass = 1;
+	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[1].srcAccessMask = 0;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[1].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	//A pixel is only ever lit from its own G-buffer texel, so the dependency is by region and a tile based GPU can
+	//light each tile as soon as its G-buffer is written, without the whole G-buffer going through memory
+	dependencies[2].srcSubpass = 0;
+	dependencies[2].dstSubpass = 1;
+	dependencies[2].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[2].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[2].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+		VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[2].dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+	dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+	/* Subpasses ordered */
+
+	VkRenderPassCreateInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = 1 + GBUFFER_ATTACHMENT_COUNT;
+	renderPassInfo.pAttachments = attachments;
+	renderPassInfo.subpassCount = 2;
+	renderPassInfo.pSubpasses = subpasses;
+	renderPassInfo.dependencyCount = 3;
+	renderPassInfo.pDependencies = dependencies;
+
+	VkResult renderPassResult = vkCreateRenderPass(device, &renderPassInfo, nullptr, &vk_deferredRenderPass);
+	if (renderPassResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	//The G-buffer's input attachments, at the bindings of their input attachment indices. Every G-buffer allocates
+	//its set with it, and the lighting pipelines reflect the same layout out of the cache
+	std::vector<VkDescriptorSetLayoutBinding> bindings(GBUFFER_ATTACHMENT_COUNT);
+	for (uint32_t i = 0; i < GBUFFER_ATTACHMENT_COUNT; ++i)
+	{
+		bindings[i].binding = i;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	}
+	vk_gbufferSetLayout = m_layoutCache.GetDescriptorSetLayout(device, bindings);
+}
+
+/*************************************************************************************
+* Function argument 1: The format of the shadow map									 *
+* Function argument 2: The Vulkan SDK device is needed for the creation				 *
+*************************************************************************************/
+void VulkanGraphicsPipelineHandle::CreateShadowRenderPass(const VkFormat& depthFormat, const VkDevice& device)
+{
+	//A cascade is cleared and drawn whole every time it is rendered, then left ready to be sampled by the lit passes
+	VkAttachmentDescription depthAttachment{};
+	depthAttachment.format = depthFormat;
+	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+	VkAttachmentReference depthAttachmentRef{ 0, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 0;
+	subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+	/* Ordering the render pass against the lit passes */
+	//The shadow map is shared by every frame, so the fragments of earlier frames have to be done sampling a cascade
+	//before it is cleared, and its depth has to be written before this frame's fragments sample it
+	VkSubpassDependency dependencies[2]{};
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	dependencies[1].srcSubpass = 0;
+	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	/* Render pass ordered */
+
+	VkRenderPassCreateInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = 1;
+	renderPassInfo.pAttachments = &depthAttachment;
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = 2;
+	renderPassInfo.pDependencies = dependencies;
+
+	VkResult renderPassResult = vkCreateRenderPass(device, &renderPassInfo, nullptr, &vk_shadowRenderPass);
+	if (renderPassResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+}
+
 /*******************************************************************************
 * Function Argument 1: The Vulkan SDK device object is needed for the creation *
 *					   of both the pipeline layout and the graphics pipeline   *
-* Function Argument 2: The swapchain extent is needed for setting viewport and *
-*					   scissor values										   *
+* Function Argument 2: The cache the pipeline is compiled through			   *
 *******************************************************************************/
 void VulkanGraphicsPipelineHandle::CreateGraphicsPipeline(const VkDevice& device, 
-	const VkExtent2D& swapchainExtent)
+	const VkPipelineCache& pipelineCache)
+{
+	//The triangle's vertices are constants in its vertex shader, so it has no vertex input
+	GraphicsPipelineDescription description;
+	description.vertexShaderFile = "Shaders/vert.spv";
+	description.fragmentShaderFile = "Shaders/frag.spv";
+
+	CreatePipeline(device, pipelineCache, description, vk_pipelineLayout, vk_graphicsPipeline);
+
+	//The triangle is not transformed, so every view draws it in the same place with the same shader
+	if (vk_multiviewRenderPass != VK_NULL_HANDLE)
+	{
+		description.multiview = true;
+		CreatePipeline(device, pipelineCache, description, vk_multiviewPipelineLayout, vk_multiviewPipeline);
+	}
+
+	//The triangle is unlit, so the deferred render pass draws it in the lighting subpass like the main render pass does
+	if (vk_deferredRenderPass != VK_NULL_HANDLE)
+	{
+		description.multiview = false;
+		description.deferred = true;
+		description.subpass = 1;
+		CreatePipeline(device, pipelineCache, description, vk_deferredPipelineLayout, vk_deferredPipeline);
+	}
+}
+
+/***************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for pipeline creation    *
+* Function Argument 2: The cache the pipeline is compiled through					   *
+* Function Argument 3: The vertex buffer bindings of the mesh's vertex format		   *
+* Function Argument 4: The attributes read from those bindings						   *
+* Function Argument 5: The constants that compile the decoding of the vertex format	   *
+* Function Argument 6: The layout of the clustered lighting's set, VK_NULL_HANDLE	   *
+*					   draws the mesh unlit											   *
+* Function Argument 7: The layout of the shadow cascades' set, VK_NULL_HANDLE draws	   *
+*					   the mesh unshadowed											   *
+***************************************************************************************/
+void VulkanGraphicsPipelineHandle::CreateMeshPipeline(const VkDevice& device, const VkPipelineCache& pipelineCache,
+	const std::vector<VkVertexInputBindingDescription>& vertexBindings,
+	const std::vector<VkVertexInputAttributeDescription>& vertexAttributes, const ShaderVariantKey& variant,
+	const VkDescriptorSetLayout& lightingSetLayout, const VkDescriptorSetLayout& shadowSetLayout)
+{
+	const bool lit = lightingSetLayout != VK_NULL_HANDLE;
+	const bool shadowed = shadowSetLayout != VK_NULL_HANDLE;
+
+	GraphicsPipelineDescription description;
+	description.vertexShaderFile = "Shaders/meshVert.spv";
+	description.fragmentShaderFile = "Shaders/frag.spv";
+	description.vertexBindings = vertexBindings;
+	description.vertexAttributes = vertexAttributes;
+	description.variant = variant;
+	description.depthTest = true;
+	description.depthWrite = true;
+	//Mesh files use counter clockwise front faces, and the projection's y flip keeps them counter clockwise on screen
+	description.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	//The lighting set is shared with the binning pass, so it is not reflected from the fragment shader alone.
+	//The cascades' set comes after it
+	if (lit)
+	{
+		description.fragmentShaderFile = shadowed ? "Shaders/meshClusteredShadowedFrag.spv" : "Shaders/meshClusteredFrag.spv";
+		description.setLayouts.push_back(lightingSetLayout);
+	}
+	else if (shadowed)
+	{
+		description.fragmentShaderFile = "Shaders/meshShadowedFrag.spv";
+	}
+	if (shadowed)
+	{
+		description.setLayouts.push_back(shadowSetLayout);
+	}
+
+	CreatePipeline(device, pipelineCache, description, vk_meshPipelineLayout, vk_meshPipeline);
+
+	/* Creating the deferred pipelines */
+	//The mesh only writes its surface into the G-buffer, the lighting pipeline then shades every pixel once, with
+	//the clustered lights if there are any. It covers the screen with a single triangle, which needs no vertex input
+	if (vk_deferredRenderPass != VK_NULL_HANDLE)
+	{
+		GraphicsPipelineDescription gbufferDescription = description;
+		gbufferDescription.fragmentShaderFile = "Shaders/meshGBufferFrag.spv";
+		gbufferDescription.setLayouts.clear();
+		gbufferDescription.deferred = true;
+		gbufferDescription.colorAttachmentCount = GBUFFER_ATTACHMENT_COUNT - 1;
+		CreatePipeline(device, pipelineCache, gbufferDescription, vk_gbufferMeshPipelineLayout, vk_gbufferMeshPipeline);
+
+		GraphicsPipelineDescription lightingDescription;
+		lightingDescription.vertexShaderFile = "Shaders/deferredLightingVert.spv";
+		lightingDescription.fragmentShaderFile = shadowed ? "Shaders/deferredLightingShadowedFrag.spv" :
+			"Shaders/deferredLightingFrag.spv";
+		lightingDescription.cullMode = VK_CULL_MODE_NONE;
+		lightingDescription.deferred = true;
+		lightingDescription.subpass = 1;
+		//The clustered variant reads the lights from set 0 like the forward mesh, the G-buffer set comes after it
+		//and the cascades' set after that
+		if (lit)
+		{
+			lightingDescription.fragmentShaderFile = shadowed ? "Shaders/deferredLightingClusteredShadowedFrag.spv" :
+				"Shaders/deferredLightingClusteredFrag.spv";
+			lightingDescription.setLayouts.push_back(lightingSetLayout);
+		}
+		lightingDescription.setLayouts.push_back(vk_gbufferSetLayout);
+		if (shadowed)
+		{
+			lightingDescription.setLayouts.push_back(shadowSetLayout);
+		}
+		CreatePipeline(device, pipelineCache, lightingDescription, vk_deferredLightingPipelineLayout,
+			vk_deferredLightingPipeline);
+	}
+	/* Deferred pipelines created */
+
+	//The shadow map only needs the mesh's depth, so the vertex stage and vertex input of the main variant are drawn
+	//without a fragment stage, biased away from the light
+	if (vk_shadowRenderPass != VK_NULL_HANDLE)
+	{
+		GraphicsPipelineDescription shadowDescription = description;
+		shadowDescription.fragmentShaderFile.clear();
+		shadowDescription.setLayouts.clear();
+		shadowDescription.shadow = true;
+		shadowDescription.colorAttachmentCount = 0;
+		shadowDescription.depthBiasConstant = SHADOW_DEPTH_BIAS_CONSTANT;
+		shadowDescription.depthBiasSlope = SHADOW_DEPTH_BIAS_SLOPE;
+		CreatePipeline(device, pipelineCache, shadowDescription, vk_shadowMeshPipelineLayout, vk_shadowMeshPipeline);
+	}
+
+	//Keeps the push constants for the decoding parameters, the view projection matrix comes from the reflected set.
+	//The clusters are only binned for the single view camera, so the views are drawn unlit
+	if (vk_multiviewRenderPass != VK_NULL_HANDLE)
+	{
+		description.vertexShaderFile = "Shaders/meshMultiviewVert.spv";
+		description.fragmentShaderFile = "Shaders/frag.spv";
+		description.setLayouts.clear();
+		description.multiview = true;
+		CreatePipeline(device, pipelineCache, description, vk_multiviewMeshPipelineLayout, vk_multiviewMeshPipeline);
+	}
+}
+
+/***************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for pipeline creation    *
+* Function Argument 2: The cache the pipeline is compiled through					   *
+* Function Argument 3: The layout of the descriptor set holding the particle buffers   *
+***************************************************************************************/
+void VulkanGraphicsPipelineHandle::CreateParticlePipeline(const VkDevice& device, const VkPipelineCache& pipelineCache,
+	const VkDescriptorSetLayout& particleSetLayout)
+{
+	//The vertices are generated from the particle buffers, so there is no vertex input
+	GraphicsPipelineDescription description;
+	description.vertexShaderFile = "Shaders/particleVert.spv";
+	description.fragmentShaderFile = "Shaders/particleFrag.spv";
+	//The particle set is shared with the compute shaders, so it is not reflected from the vertex shader alone
+	description.setLayouts.push_back(particleSetLayout);
+	//Particles are hidden behind the mesh but do not hide each other, and are added up so they need no sorting
+	description.depthTest = true;
+	description.additiveBlend = true;
+	//The quads always face the camera
+	description.cullMode = VK_CULL_MODE_NONE;
+
+	CreatePipeline(device, pipelineCache, description, vk_particlePipelineLayout, vk_particlePipeline);
+
+	if (vk_multiviewRenderPass != VK_NULL_HANDLE)
+	{
+		description.vertexShaderFile = "Shaders/particleMultiviewVert.spv";
+		description.multiview = true;
+		CreatePipeline(device, pipelineCache, description, vk_multiviewParticlePipelineLayout,
+			vk_multiviewParticlePipeline);
+	}
+
+	//Drawn after the lighting, tested against the G-buffer's depth which stays attached read only
+	if (vk_deferredRenderPass != VK_NULL_HANDLE)
+	{
+		description.vertexShaderFile = "Shaders/particleVert.spv";
+		description.multiview = false;
+		description.deferred = true;
+		description.subpass = 1;
+		CreatePipeline(device, pipelineCache, description, vk_deferredParticlePipelineLayout,
+			vk_deferredParticlePipeline);
+	}
+}
+
+/*****************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for pipeline creation	     *
+* Function Argument 2: The cache the pipelines are compiled through					     *
+* Function Argument 3: The per instance binding the quads are read from				     *
+* Function Argument 4: The attributes of a quad, matching the inputs of Overlay.vert     *
+* Function Argument 5: The layout of the set every atlas is bound through			     *
+*****************************************************************************************/
+void VulkanGraphicsPipelineHandle::CreateOverlayPipelines(const VkDevice& device, const VkPipelineCache& pipelineCache,
+	const std::vector<VkVertexInputBindingDescription>& vertexBindings,
+	const std::vector<VkVertexInputAttributeDescription>& vertexAttributes,
+	const VkDescriptorSetLayout& atlasSetLayout)
+{
+	GraphicsPipelineDescription description;
+	description.vertexShaderFile = "Shaders/overlayVert.spv";
+	description.fragmentShaderFile = "Shaders/overlayFrag.spv";
+	description.vertexBindings = vertexBindings;
+	description.vertexAttributes = vertexAttributes;
+	description.setLayouts.push_back(atlasSetLayout);
+	//Drawn over everything in the order it was batched, whichever way the quads wind
+	description.cullMode = VK_CULL_MODE_NONE;
+
+	CreatePipeline(device, pipelineCache, description, vk_overlayPipelineLayout, vk_overlayPipeline);
+	description.additiveBlend = true;
+	CreatePipeline(device, pipelineCache, description, vk_overlayPipelineLayout, vk_additiveOverlayPipeline);
+
+	//Drawn last in the lighting subpass, after the particles
+	if (vk_deferredRenderPass != VK_NULL_HANDLE)
+	{
+		description.deferred = true;
+		description.subpass = 1;
+		description.additiveBlend = false;
+		CreatePipeline(device, pipelineCache, description, vk_deferredOverlayPipelineLayout, vk_deferredOverlayPipeline);
+		description.additiveBlend = true;
+		CreatePipeline(device, pipelineCache, description, vk_deferredOverlayPipelineLayout,
+			vk_deferredAdditiveOverlayPipeline);
+	}
+}
+
+/***************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for pipeline creation    *
+* Function Argument 2: The cache the pipeline is compiled through					   *
+* Function Argument 3: The compute shader, one of the files in pipelineShaderFiles	   *
+* Function Argument 4: The layout the pipeline is created with						   *
+* Function Argument 5: The pipeline that gets created								   *
+* Function Argument 6: The specialization constants of the shader					   *
+***************************************************************************************/
+void VulkanGraphicsPipelineHandle::CreateComputePipeline(const VkDevice& device, const VkPipelineCache& pipelineCache,
+	const std::string& shaderFile, const VkPipelineLayout& pipelineLayout, VkPipeline& pipeline,
+	const ShaderVariantKey& variant)
 {
-	//Reading and loading the shader code in memory
+	VkResult computePipelineResult = BuildComputePipeline(device, pipelineCache, shaderFile, variant, pipelineLayout,
+		pipeline);
+	if (computePipelineResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	PipelineRecord record{};
+	record.computeShaderFile = shaderFile;
+	record.description.variant = variant;
+	record.vk_pipelineLayout = pipelineLayout;
+	record.pipeline = &pipeline;
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	//A layout the caller did not reflect is checked against the compute shader alone
+	auto reflectedLayout = m_reflectedLayouts.find(pipelineLayout);
+	if (reflectedLayout != m_reflectedLayouts.end())
+	{
+		record.layoutSource = reflectedLayout->second;
+	}
+	std::vector<std::string>& layoutShaderFiles = record.layoutSource.shaderFiles;
+	if (std::find(layoutShaderFiles.begin(), layoutShaderFiles.end(), shaderFile) == layoutShaderFiles.end())
+	{
+		layoutShaderFiles.push_back(shaderFile);
+	}
+	m_pipelineRecords.push_back(record);
+}
+
+/****************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation		    *
+* Function Argument 2: The cache the pipeline is compiled through					    *
+* Function Argument 3: The compute shader											    *
+* Function Argument 4: The specialization constants of the shader					    *
+* Function Argument 5: The layout the pipeline is created with						    *
+* Function Argument 6: The pipeline that gets created, left untouched if creation fails *
+****************************************************************************************/
+VkResult VulkanGraphicsPipelineHandle::BuildComputePipeline(const VkDevice& device, const VkPipelineCache& pipelineCache,
+	const std::string& shaderFile, const ShaderVariantKey& variant, const VkPipelineLayout& pipelineLayout,
+	VkPipeline& pipeline)
+{
+	std::vector<char> shaderCode;
+	if (!GetShaderCode(shaderFile, shaderCode))
+	{
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+
+	VkShaderModule shaderModule;
+	CreateShaderModule(shaderCode, device, shaderModule);
+
+	VkSpecializationInfo specializationInfo{};
+	VkSpecializationMapEntry specializationEntries[SHADER_VARIANT_MAX_CONSTANTS];
+	variant.FillSpecializationInfo(specializationInfo, specializationEntries);
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = shaderModule;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.stage.pSpecializationInfo = &specializationInfo;
+	pipelineInfo.layout = pipelineLayout;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineInfo.basePipelineIndex = -1;
+
+	VkPipeline createdPipeline = VK_NULL_HANDLE;
+	VkResult computePipelineResult = vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr,
+		&createdPipeline);
+	if (computePipelineResult == VK_SUCCESS)
+	{
+		pipeline = createdPipeline;
+	}
+
+	vkDestroyShaderModule(device, shaderModule, nullptr);
+	return computePipelineResult;
+}
+
+/*******************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation *
+*					   of both the pipeline layout and the graphics pipeline   *
+* Function Argument 2: The cache the pipeline is compiled through, pipelines   *
+*					   it already holds are not compiled again				   *
+* Function Argument 3: The shaders, vertex input and state of the pipeline	   *
+* Function Argument 4: The pipeline layout, reflected from the shaders		   *
+* Function Argument 5: The pipeline that gets created						   *
+*******************************************************************************/
+void VulkanGraphicsPipelineHandle::CreatePipeline(const VkDevice& device, const VkPipelineCache& pipelineCache,
+	const GraphicsPipelineDescription& description, VkPipelineLayout& pipelineLayout, VkPipeline& pipeline)
+{
+	//Setting up uniform variables layouts from what the shaders declare
+	std::vector<std::string> shaderFiles = { description.vertexShaderFile };
+	if (!description.fragmentShaderFile.empty())
+	{
+		shaderFiles.push_back(description.fragmentShaderFile);
+	}
+	pipelineLayout = GetReflectedPipelineLayout(device, shaderFiles, description.setLayouts);
+
+	if (!CheckVertexInputs(description))
+	{
+		__debugbreak();
+	}
+
+	VkResult graphicsPipelineResult = BuildGraphicsPipeline(device, pipelineCache, description, pipelineLayout, pipeline);
+	if (graphicsPipelineResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	//A rebuilt pipeline is only swapped in if its recompiled shaders still reflect to this layout and vertex input,
+	//as the code binding and pushing for it was written against them
+	PipelineRecord record{};
+	record.description = description;
+	record.vk_pipelineLayout = pipelineLayout;
+	record.layoutSource = { shaderFiles, description.setLayouts };
+	record.pipeline = &pipeline;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pipelineRecords.push_back(record);
+}
+
+/****************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation		    *
+* Function Argument 2: The cache the pipeline is compiled through, pipelines		    *
+*					   it already holds are not compiled again						    *
+* Function Argument 3: The shaders, vertex input and state of the pipeline			    *
+* Function Argument 4: The pipeline layout the pipeline is created with				    *
+* Function Argument 5: The pipeline that gets created, left untouched if creation fails *
+****************************************************************************************/
+VkResult VulkanGraphicsPipelineHandle::BuildGraphicsPipeline(const VkDevice& device, const VkPipelineCache& pipelineCache,
+	const GraphicsPipelineDescription& description, const VkPipelineLayout& pipelineLayout, VkPipeline& pipeline)
+{
+	//The shader code is normally already in memory, read by ReadShaderFiles. A depth only pipeline has no fragment stage
+	const bool hasFragmentStage = !description.fragmentShaderFile.empty();
 	std::vector<char> vertShaderCode;
 	std::vector<char> fragShaderCode;
-	ReadFile("Shaders/vert.spv", vertShaderCode);
-	ReadFile("Shaders/frag.spv", fragShaderCode);
+	if (!GetShaderCode(description.vertexShaderFile, vertShaderCode) ||
+		(hasFragmentStage && !GetShaderCode(description.fragmentShaderFile, fragShaderCode)))
+	{
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
 
 	//The code needs to be wrapped in a shader module before being passed to the graphics pipeline
 	VkShaderModule vertexShaderModule;
-	VkShaderModule fragmentShaderModule;
+	VkShaderModule fragmentShaderModule = VK_NULL_HANDLE;
 	CreateShaderModule(vertShaderCode, device, vertexShaderModule);
-	CreateShaderModule(fragShaderCode, device, fragmentShaderModule);
+	if (hasFragmentStage)
+	{
+		CreateShaderModule(fragShaderCode, device, fragmentShaderModule);
+	}
 
 	/* Create info struct for shader stage (specifies for what stage the shader will be used) */
 	VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
@@ -109,6 +846,13 @@ void VulkanGraphicsPipelineHandle::CreateGraphicsPipeline(const VkDevice& device
 	fragShaderStageInfo.pName = "main";
 	/* Create info struct complete */
 
+	//Both stages read the constants they declare from the same values
+	VkSpecializationInfo specializationInfo{};
+	VkSpecializationMapEntry specializationEntries[SHADER_VARIANT_MAX_CONSTANTS];
+	description.variant.FillSpecializationInfo(specializationInfo, specializationEntries);
+	vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
+	fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
 	//Saving the shader stages to an array, so that they can be passed to the pipeline
 	VkPipelineShaderStageCreateInfo shaderStageInfos[] = { vertShaderStageInfo, fragShaderStageInfo };
 
@@ -126,10 +870,10 @@ void VulkanGraphicsPipelineHandle::CreateGraphicsPipeline(const VkDevice& device
 	//Setting up the vertex data that will passed on to the vertex shader
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 0;
-	vertexInputInfo.pVertexBindingDescriptions = nullptr;
-	vertexInputInfo.vertexAttributeDescriptionCount = 0;
-	vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+	vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(description.vertexBindings.size());
+	vertexInputInfo.pVertexBindingDescriptions = description.vertexBindings.data();
+	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(description.vertexAttributes.size());
+	vertexInputInfo.pVertexAttributeDescriptions = description.vertexAttributes.data();
 
 	//Setting up what kind of geometry will be drawn from the vertices and if primitive restart should be enabled
 	VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
@@ -137,18 +881,6 @@ void VulkanGraphicsPipelineHandle::CreateGraphicsPipeline(const VkDevice& device
 	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-	//Setting up viewport values(this is unnecessary since it's specified as dynamic state)
-	VkViewport viewport{};
-	viewport.x = 0.0f;
-	viewport.y = 0.0f;
-	viewport.width = (float)swapchainExtent.width;
-	viewport.height = (float)swapchainExtent.height;
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
-	//Setting up scissor values for the viewport(this is unnecessary since it's specified as dynamic state)
-	VkRect2D scissor{};
-	scissor.offset = { 0, 0 };
-	scissor.extent = swapchainExtent;
 	//Specifying the scissor and viewport count only since they are specified as dynamic states
 	VkPipelineViewportStateCreateInfo viewportState{};
 	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -165,10 +897,13 @@ void VulkanGraphicsPipelineHandle::CreateGraphicsPipeline(const VkDevice& device
 	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
 	rasterizer.lineWidth = 1.0f;
 	//Setting the type of face culling to use
-	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-	rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-	//Depth can be used for shadow mapping sometimes
-	rasterizer.depthBiasEnable = VK_FALSE;
+	rasterizer.cullMode = description.cullMode;
+	rasterizer.frontFace = description.frontFace;
+	//Pushes the shadow map's depth away from the light, so the surfaces it was drawn from do not shadow themselves
+	rasterizer.depthBiasEnable = description.depthBiasConstant != 0.0f || description.depthBiasSlope != 0.0f ?
+		VK_TRUE : VK_FALSE;
+	rasterizer.depthBiasConstantFactor = description.depthBiasConstant;
+	rasterizer.depthBiasSlopeFactor = description.depthBiasSlope;
 
 	//Setting up multisampling
 	VkPipelineMultisampleStateCreateInfo multisampling{};
@@ -177,50 +912,45 @@ void VulkanGraphicsPipelineHandle::CreateGraphicsPipeline(const VkDevice& device
 	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
 	//Setting up depth and stencil buffers
+	VkPipelineDepthStencilStateCreateInfo depthStencil{};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = description.depthTest ? VK_TRUE : VK_FALSE;
+	depthStencil.depthWriteEnable = description.depthWrite ? VK_TRUE : VK_FALSE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+	depthStencil.depthBoundsTestEnable = VK_FALSE;
+	depthStencil.stencilTestEnable = VK_FALSE;
 
-	//Configuring color blending for the framebuffer(s)
+	//Configuring color blending for the framebuffer(s). Every attachment blends the same way, the G-buffer shaders
+	//write an alpha of 1 so their values are stored as written
 	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
 	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 	colorBlendAttachment.blendEnable = VK_TRUE;
 	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	colorBlendAttachment.dstColorBlendFactor = description.additiveBlend ? VK_BLEND_FACTOR_ONE : VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
 	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
 	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
 	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
 	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments(description.colorAttachmentCount,
+		colorBlendAttachment);
 
 	//Configuring global color blending
 	VkPipelineColorBlendStateCreateInfo colorBlending{};
 	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 	colorBlending.logicOpEnable = VK_FALSE;
 	colorBlending.logicOp = VK_LOGIC_OP_COPY;
-	colorBlending.attachmentCount = 1;
-	colorBlending.pAttachments = &colorBlendAttachment;
+	colorBlending.attachmentCount = static_cast<uint32_t>(colorBlendAttachments.size());
+	colorBlending.pAttachments = colorBlendAttachments.data();
 	colorBlending.blendConstants[0] = 0.0f; 
 	colorBlending.blendConstants[1] = 0.0f; 
 	colorBlending.blendConstants[2] = 0.0f; 
 	colorBlending.blendConstants[3] = 0.0f; 
-	
-	//Setting up uniform variables layouts
-	VkPipelineLayoutCreateInfo createInfo{};
-	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	createInfo.setLayoutCount = 0;
-	createInfo.pSetLayouts = nullptr;
-	createInfo.pushConstantRangeCount = 0;
-	createInfo.pPushConstantRanges = nullptr;
-
-	//Creating the pipeline layout
-	VkResult pipelineLayoutResult = vkCreatePipelineLayout(device, &createInfo, nullptr, &vk_pipelineLayout);
-	if (pipelineLayoutResult != VK_SUCCESS)
-	{
-		__debugbreak();
-	}
 
 	/* Initializing Graphics pipeline create info struct */
 	VkGraphicsPipelineCreateInfo pipelineInfo{};
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	//Passing the shader stage array
-	pipelineInfo.stageCount = 2;
+	pipelineInfo.stageCount = hasFragmentStage ? 2 : 1;
 	pipelineInfo.pStages = shaderStageInfos;
 	//Passing all the fixed function states
 	pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -228,49 +958,288 @@ void VulkanGraphicsPipelineHandle::CreateGraphicsPipeline(const VkDevice& device
 	pipelineInfo.pViewportState = &viewportState;
 	pipelineInfo.pRasterizationState = &rasterizer;
 	pipelineInfo.pMultisampleState = &multisampling;
-	pipelineInfo.pDepthStencilState = nullptr;
+	pipelineInfo.pDepthStencilState = &depthStencil;
 	pipelineInfo.pColorBlendState = &colorBlending;
 	pipelineInfo.pDynamicState = &dynamicState;
 	//Passing the pipeline layout object
-	pipelineInfo.layout = vk_pipelineLayout;
+	pipelineInfo.layout = pipelineLayout;
 	//Passing the render pass
-	pipelineInfo.renderPass = vk_renderPass;
+	pipelineInfo.renderPass = description.multiview ? vk_multiviewRenderPass :
+		description.deferred ? vk_deferredRenderPass : description.shadow ? vk_shadowRenderPass : vk_renderPass;
 	//Passing the index of the subpass where the graphics pipeline will be used
-	pipelineInfo.subpass = 0;
+	pipelineInfo.subpass = description.subpass;
 
 	//This is used if we want to have more than one pipeline
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; 
 	pipelineInfo.basePipelineIndex = -1; 
 
-	//Creating the graphics pipeline and checking if its creation was succesful
-	VkResult graphicsPipelineResult = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, 
-		nullptr, &vk_graphicsPipeline);
-	if (graphicsPipelineResult != VK_SUCCESS)
+	//Creating the graphics pipeline, the caller checks if its creation was succesful
+	VkPipeline createdPipeline = VK_NULL_HANDLE;
+	VkResult graphicsPipelineResult = vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, 
+		nullptr, &createdPipeline);
+	if (graphicsPipelineResult == VK_SUCCESS)
 	{
-		__debugbreak();
+		pipeline = createdPipeline;
 	}
 
 	//We don't need the shader module wrappers after the graphics pipeline has been created
 	vkDestroyShaderModule(device, vertexShaderModule, nullptr);
 	vkDestroyShaderModule(device, fragmentShaderModule, nullptr);
+	return graphicsPipelineResult;
+}
+
+/**************************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for pipeline creation   *
+* Function Argument 2: The cache the pipelines are compiled through, shared with the  *
+*					   frames being rendered as the cache guards itself				  *
+* Function Argument 3: The SPIR-V files that have been written again				  *
+**************************************************************************************/
+uint32_t VulkanGraphicsPipelineHandle::RebuildPipelines(const VkDevice& device, const VkPipelineCache& pipelineCache,
+	const std::vector<std::string>& shaderFiles)
+{
+	/* Reading the new shader code */
+	std::vector<PipelineRecord> affectedRecords;
+	for (const std::string& shaderFile : shaderFiles)
+	{
+		//Read outside the lock, nothing else has to wait for the disk. A file that cannot be read, removed or still
+		//being written, leaves the code and pipelines as they are
+		std::vector<char> byteCode;
+		if (!ReadFile(shaderFile, byteCode))
+		{
+			std::cout << "Shader hot reload: " << shaderFile << " could not be read, keeping the previous pipelines\n";
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shaderCode[shaderFile] = std::move(byteCode);
+		for (const PipelineRecord& record : m_pipelineRecords)
+		{
+			bool usesShader = record.computeShaderFile == shaderFile || record.description.vertexShaderFile == shaderFile ||
+				record.description.fragmentShaderFile == shaderFile;
+			bool alreadyAffected = false;
+			for (const PipelineRecord& affected : affectedRecords)
+			{
+				alreadyAffected = alreadyAffected || affected.pipeline == record.pipeline;
+			}
+			if (usesShader && !alreadyAffected)
+			{
+				affectedRecords.push_back(record);
+			}
+		}
+	}
+	/* Shader code read */
+
+	/* Creating the new pipelines */
+	//A pipeline that fails to build keeps its old version, so a shader with a mistake never stops the frames
+	uint32_t rebuiltCount = 0;
+	for (const PipelineRecord& record : affectedRecords)
+	{
+		//The layout cache hands back the same layout for the same interface, anything else would be bound and pushed
+		//wrongly by the code that drives the pipeline
+		const bool graphics = record.computeShaderFile.empty();
+		VkPipelineLayout reflectedLayout = VK_NULL_HANDLE;
+		bool sameInterface = ReflectPipelineLayout(device, record.layoutSource.shaderFiles,
+			record.layoutSource.setLayouts, reflectedLayout) && reflectedLayout == record.vk_pipelineLayout;
+		if (!sameInterface || (graphics && !CheckVertexInputs(record.description)))
+		{
+			std::cout << "Shader hot reload: the interface of " <<
+				(graphics ? record.description.vertexShaderFile : record.computeShaderFile) <<
+				"'s pipeline changed or could not be reflected, keeping its previous version until a restart\n";
+			continue;
+		}
+
+		VkPipeline rebuiltPipeline = VK_NULL_HANDLE;
+		VkResult result = graphics ?
+			BuildGraphicsPipeline(device, pipelineCache, record.description, record.vk_pipelineLayout, rebuiltPipeline) :
+			BuildComputePipeline(device, pipelineCache, record.computeShaderFile, record.description.variant,
+				record.vk_pipelineLayout, rebuiltPipeline);
+		if (result != VK_SUCCESS)
+		{
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingSwaps.push_back({ record.pipeline, rebuiltPipeline });
+		++rebuiltCount;
+	}
+	/* New pipelines created */
+
+	return rebuiltCount;
 }
 
-void VulkanGraphicsPipelineHandle::ReadFile(const std::string& filename, 
+/*********************************************************************************
+* Function Argument 1: Destroys the replaced pipelines once the frames submitted *
+*					   before the swap have finished							 *
+*********************************************************************************/
+void VulkanGraphicsPipelineHandle::SwapRebuiltPipelines(VulkanDeletionQueue& deletionQueue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (const PipelineSwap& swap : m_pendingSwaps)
+	{
+		deletionQueue.Release<VkPipeline, vkDestroyPipeline>(*swap.pipeline);
+		*swap.pipeline = swap.vk_rebuiltPipeline;
+	}
+	m_pendingSwaps.clear();
+}
+
+/**********************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation	  *
+* Function Argument 2: The shaders of every stage of the pipeline				  *
+* Function Argument 3: Set layouts owned elsewhere, in set order, used instead of *
+*					   the reflected ones for the sets that are not null		  *
+**********************************************************************************/
+VkPipelineLayout VulkanGraphicsPipelineHandle::GetReflectedPipelineLayout(const VkDevice& device,
+	const std::vector<std::string>& shaderFiles, const std::vector<VkDescriptorSetLayout>& setLayouts)
+{
+	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+	if (!ReflectPipelineLayout(device, shaderFiles, setLayouts, pipelineLayout))
+	{
+		__debugbreak();
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_reflectedLayouts.emplace(pipelineLayout, ReflectedLayoutSource{ shaderFiles, setLayouts });
+	return pipelineLayout;
+}
+
+/**********************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation	  *
+* Function Argument 2: The shaders of every stage of the pipeline				  *
+* Function Argument 3: Set layouts owned elsewhere, in set order, used instead of *
+*					   the reflected ones for the sets that are not null		  *
+* Function Argument 4: The layout from the cache, set only if true is returned	  *
+**********************************************************************************/
+bool VulkanGraphicsPipelineHandle::ReflectPipelineLayout(const VkDevice& device,
+	const std::vector<std::string>& shaderFiles, const std::vector<VkDescriptorSetLayout>& setLayouts,
+	VkPipelineLayout& pipelineLayout)
+{
+	/* Combining the interface of every stage */
+	//A binding used by several stages is a single binding visible to all of them
+	std::vector<std::vector<VkDescriptorSetLayoutBinding>> setBindings(setLayouts.size());
+	VkPushConstantRange pushConstantRange{ 0, 0, 0 };
+	for (const std::string& shaderFile : shaderFiles)
+	{
+		ShaderReflection reflection;
+		if (!ReflectShaderFile(shaderFile, reflection))
+		{
+			return false;
+		}
+
+		for (const ShaderDescriptorBinding& descriptor : reflection.descriptors)
+		{
+			if (setBindings.size() <= descriptor.set)
+			{
+				setBindings.resize(descriptor.set + 1);
+			}
+
+			std::vector<VkDescriptorSetLayoutBinding>& bindings = setBindings[descriptor.set];
+			auto existing = std::find_if(bindings.begin(), bindings.end(),
+				[&descriptor](const VkDescriptorSetLayoutBinding& binding) { return binding.binding == descriptor.binding.binding; });
+			if (existing == bindings.end())
+			{
+				bindings.push_back(descriptor.binding);
+			}
+			else if (existing->descriptorType != descriptor.binding.descriptorType ||
+				existing->descriptorCount != descriptor.binding.descriptorCount)
+			{
+				//Two stages declare different resources at the same binding
+				return false;
+			}
+			else
+			{
+				existing->stageFlags |= descriptor.binding.stageFlags;
+			}
+		}
+
+		if (reflection.pushConstantSize > 0)
+		{
+			pushConstantRange.stageFlags |= reflection.stage;
+			pushConstantRange.size = std::max(pushConstantRange.size, reflection.pushConstantSize);
+		}
+	}
+	/* Interface combined */
+
+	std::vector<VkDescriptorSetLayout> pipelineSetLayouts(setBindings.size());
+	for (size_t set = 0; set < setBindings.size(); ++set)
+	{
+		bool given = set < setLayouts.size() && setLayouts[set] != VK_NULL_HANDLE;
+		pipelineSetLayouts[set] = given ? setLayouts[set] : m_layoutCache.GetDescriptorSetLayout(device, setBindings[set]);
+	}
+
+	std::vector<VkPushConstantRange> pushConstantRanges;
+	if (pushConstantRange.size > 0)
+	{
+		pushConstantRanges.push_back(pushConstantRange);
+	}
+
+	pipelineLayout = m_layoutCache.GetPipelineLayout(device, pipelineSetLayouts, pushConstantRanges);
+	return true;
+}
+
+bool VulkanGraphicsPipelineHandle::CheckVertexInputs(const GraphicsPipelineDescription& description)
+{
+	//Every input the vertex shader reads has to be fed by an attribute, the buffers can store it in any format the
+	//fetch hardware expands to the shader's type
+	ShaderReflection vertexReflection;
+	if (!ReflectShaderFile(description.vertexShaderFile, vertexReflection))
+	{
+		return false;
+	}
+	for (const ShaderVertexInput& input : vertexReflection.vertexInputs)
+	{
+		bool fed = std::any_of(description.vertexAttributes.begin(), description.vertexAttributes.end(),
+			[&input](const VkVertexInputAttributeDescription& attribute) { return attribute.location == input.location; });
+		if (!fed)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool VulkanGraphicsPipelineHandle::ReflectShaderFile(const std::string& filename, ShaderReflection& reflection)
+{
+	std::vector<char> shaderCode;
+	return GetShaderCode(filename, shaderCode) && ReflectSpirv(shaderCode, reflection);
+}
+
+bool VulkanGraphicsPipelineHandle::GetShaderCode(const std::string& filename, std::vector<char>& byteCode)
+{
+	//Copied under the lock, as the hot reload thread may be replacing it
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto code = m_shaderCode.find(filename);
+		if (code != m_shaderCode.end())
+		{
+			byteCode = code->second;
+			return true;
+		}
+	}
+	return ReadFile(filename, byteCode);
+}
+
+bool VulkanGraphicsPipelineHandle::ReadFile(const std::string& filename, 
 	std::vector<char>& byteCode)
 {
 	std::ifstream file(filename, std::ios::ate | std::ios::binary);
-
 	if (!file.is_open())
 	{
-		__debugbreak();
+		return false;
 	}
 
-	size_t fileSize = file.tellg();
-	byteCode.resize(fileSize);
+	std::streamoff fileSize = file.tellg();
+	if (fileSize < 0)
+	{
+		return false;
+	}
+	byteCode.resize(static_cast<size_t>(fileSize));
 	file.seekg(0);
 	file.read(byteCode.data(), fileSize);
 
+	//Shorter than it was when opened, the compiler replaced it meanwhile
+	bool readWhole = static_cast<bool>(file);
 	file.close();
+	return readWhole;
 }
 
 /************************************************************************************
@@ -300,7 +1269,34 @@ void VulkanGraphicsPipelineHandle::CreateShaderModule(const std::vector<char>& c
 
 void VulkanGraphicsPipelineHandle::Cleanup(const VkDevice& device)
 {
+	//Rebuilt after the last frame was recorded, they were never used
+	for (const PipelineSwap& swap : m_pendingSwaps)
+	{
+		vkDestroyPipeline(device, swap.vk_rebuiltPipeline, nullptr);
+	}
+	m_pendingSwaps.clear();
+	m_pipelineRecords.clear();
+	m_reflectedLayouts.clear();
+
 	vkDestroyPipeline(device, vk_graphicsPipeline, nullptr);
-	vkDestroyPipelineLayout(device, vk_pipelineLayout, nullptr);
+	vkDestroyPipeline(device, vk_meshPipeline, nullptr);
+	vkDestroyPipeline(device, vk_particlePipeline, nullptr);
+	vkDestroyPipeline(device, vk_overlayPipeline, nullptr);
+	vkDestroyPipeline(device, vk_additiveOverlayPipeline, nullptr);
+	vkDestroyPipeline(device, vk_multiviewPipeline, nullptr);
+	vkDestroyPipeline(device, vk_multiviewMeshPipeline, nullptr);
+	vkDestroyPipeline(device, vk_multiviewParticlePipeline, nullptr);
+	vkDestroyPipeline(device, vk_deferredPipeline, nullptr);
+	vkDestroyPipeline(device, vk_gbufferMeshPipeline, nullptr);
+	vkDestroyPipeline(device, vk_deferredLightingPipeline, nullptr);
+	vkDestroyPipeline(device, vk_deferredParticlePipeline, nullptr);
+	vkDestroyPipeline(device, vk_deferredOverlayPipeline, nullptr);
+	vkDestroyPipeline(device, vk_deferredAdditiveOverlayPipeline, nullptr);
+	vkDestroyPipeline(device, vk_shadowMeshPipeline, nullptr);
+	//Destroys the layouts of the pipelines above, and the set layouts made through it for other stages
+	m_layoutCache.Cleanup(device);
+	vkDestroyRenderPass(device, vk_multiviewRenderPass, nullptr);
+	vkDestroyRenderPass(device, vk_deferredRenderPass, nullptr);
+	vkDestroyRenderPass(device, vk_shadowRenderPass, nullptr);
 	vkDestroyRenderPass(device, vk_renderPass, nullptr);
 }
\ No newline at end of file
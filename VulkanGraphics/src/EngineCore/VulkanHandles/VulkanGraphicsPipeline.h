@@ -3,29 +3,309 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <mutex>
+#include <unordered_map>
 #include "VulkanDevice.h"
+#include "VulkanDeletionQueue.h"
+#include "ShaderVariant.h"
+#include "SpirvReflection.h"
+#include "VulkanLayoutCache.h"
+
+//The most views the multiview render pass can render at once, matches MULTIVIEW_MAX_VIEWS in Multiview.glsl
+#define MULTIVIEW_MAX_VIEWS 4
+
+//The depth bias the shadow map pipelines draw with, in units of the depth format's precision and of the depth slope,
+//so lit surfaces do not shadow themselves where the map's texels are coarser than the surface
+#define SHADOW_DEPTH_BIAS_CONSTANT 1.25f
+#define SHADOW_DEPTH_BIAS_SLOPE 1.75f
+
+//Holds everything that differs between the pipelines drawn in the main render pass
+struct GraphicsPipelineDescription
+{
+	std::string vertexShaderFile;
+	//Left empty for a depth only pipeline, which has no fragment stage
+	std::string fragmentShaderFile;
+
+	std::vector<VkVertexInputBindingDescription> vertexBindings;
+	std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+
+	//The pipeline layout is reflected from the shaders. Sets shared with stages outside the pipeline are given here,
+	//in set order, and replace the reflected ones. Sets left out or VK_NULL_HANDLE are reflected
+	std::vector<VkDescriptorSetLayout> setLayouts;
+
+	bool depthTest = false;
+	bool depthWrite = false;
+
+	//Adds the color to the framebuffer instead of blending it over, so overlapping transparent draws need no sorting
+	bool additiveBlend = false;
+
+	VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+	VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+	//Creates the pipeline for the multiview render pass instead of the main one
+	bool multiview = false;
+
+	//Creates the pipeline for the deferred render pass instead of the main one, in the given subpass. The subpass
+	//decides how many colour attachments the pipeline writes, the G-buffer subpass writes GBUFFER_ATTACHMENT_COUNT - 1
+	bool deferred = false;
+	uint32_t subpass = 0;
+	uint32_t colorAttachmentCount = 1;
+
+	//Creates the pipeline for the shadow render pass instead of the main one, which has no colour attachment
+	bool shadow = false;
+
+	//Added to the depth of every fragment, a constant of 0 and a slope of 0 leave depth bias disabled
+	float depthBiasConstant = 0.0f;
+	float depthBiasSlope = 0.0f;
+
+	//The specialization constants given to both shader stages
+	ShaderVariantKey variant;
+};
+
+//The optional features whose shaders ReadShaderFiles reads, the shaders every launch draws with are always read
+struct ShaderFileGroups
+{
+	bool multiview = false;
+	bool clusteredLighting = false;
+	bool deferred = false;
+	bool shadows = false;
+	bool overlay = false;
+};
 
 class VulkanGraphicsPipelineHandle
 {
 public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanGraphicsPipelineHandle();
+
+	//Reads the SPIR-V of every shader the pipelines of the enabled features use into memory, it needs no device so it
+	//can run before one exists. The shaders of a feature that is off are neither read nor required to be compiled
+	void ReadShaderFiles(const ShaderFileGroups& groups);
+
 	//Creates the render pass needed for pipeline creation
-	void CreateRenderPass(const VkFormat& swapchainFormat, const VkDevice& device);
+	void CreateRenderPass(const VkFormat& swapchainFormat, const VkFormat& depthFormat, const VkDevice& device,
+		VkImageLayout colorFinalLayout);
+
+	//Creates a render pass whose single subpass renders into every layer of its attachments at once, one view per
+	//layer, and the layout of the descriptor set holding the matrix of every view. Once it exists, the functions
+	//below also create the multiview variant of their pipeline
+	void CreateMultiviewRenderPass(const VkFormat& colorFormat, const VkFormat& depthFormat, const VkDevice& device,
+		uint32_t viewCount);
+
+	//Creates a render pass whose first subpass draws the mesh into the G-buffer and whose second lights every pixel
+	//once from the G-buffer, read as input attachments, and draws the unlit geometry over the result. Also creates
+	//the layout of the input attachments' set. Once it exists, the functions below also create the deferred variant
+	//of their pipeline
+	void CreateDeferredRenderPass(const VkFormat& swapchainFormat, const VkFormat& depthFormat, const VkDevice& device,
+		VkImageLayout colorFinalLayout);
+
+	//Creates a depth only render pass for one cascade of the shadow map. Once it exists, CreateMeshPipeline also
+	//creates the pipeline drawing the mesh into it
+	void CreateShadowRenderPass(const VkFormat& depthFormat, const VkDevice& device);
 
-	//Creates the graphics pipeline after reading shader code, specifying fixed functions,
-	//and creating the pipeline layout
-	void CreateGraphicsPipeline(const VkDevice& device, const VkExtent2D& swapchainExtent);
+	//Creates the graphics pipeline from the shader code read, specifying fixed functions,
+	//and creating the pipeline layout. Viewport and scissor are dynamic, so it does not depend on the swapchain
+	void CreateGraphicsPipeline(const VkDevice& device, const VkPipelineCache& pipelineCache);
+
+	//Creates the pipeline that draws meshes loaded from mesh files, with vertex input and shader variant matching
+	//their vertex format. Given the clustered lighting's set layout, the mesh is lit by the lights of its clusters,
+	//and given the shadow cascades' set layout, its fixed light is shadowed. With the deferred render pass, also
+	//creates the pipelines writing the mesh's G-buffer and lighting it, and with the shadow render pass the pipeline
+	//drawing its depth into the shadow map
+	void CreateMeshPipeline(const VkDevice& device, const VkPipelineCache& pipelineCache, 
+		const std::vector<VkVertexInputBindingDescription>& vertexBindings,
+		const std::vector<VkVertexInputAttributeDescription>& vertexAttributes, const ShaderVariantKey& variant,
+		const VkDescriptorSetLayout& lightingSetLayout, const VkDescriptorSetLayout& shadowSetLayout);
+
+	//Creates the pipeline that draws the particles straight out of the particle buffers, which it reads through
+	//a descriptor set of the given layout
+	void CreateParticlePipeline(const VkDevice& device, const VkPipelineCache& pipelineCache,
+		const VkDescriptorSetLayout& particleSetLayout);
+
+	//Creates the pipelines that draw the overlay's quads over everything else, one blending them over the frame and
+	//one adding them to it. Every quad is an instance of the given vertex input, and its atlas is read through a set
+	//of the given layout. With the deferred render pass, also creates their variants for its lighting subpass
+	void CreateOverlayPipelines(const VkDevice& device, const VkPipelineCache& pipelineCache,
+		const std::vector<VkVertexInputBindingDescription>& vertexBindings,
+		const std::vector<VkVertexInputAttributeDescription>& vertexAttributes,
+		const VkDescriptorSetLayout& atlasSetLayout);
+
+	//Creates a compute pipeline from one of the shaders ReadShaderFiles read, the layout is created and owned by the caller.
+	//The caller has to keep the pipeline where it is, as a rebuilt pipeline is swapped in there
+	void CreateComputePipeline(const VkDevice& device, const VkPipelineCache& pipelineCache, const std::string& shaderFile,
+		const VkPipelineLayout& pipelineLayout, VkPipeline& pipeline, const ShaderVariantKey& variant = ShaderVariantKey());
+
+	//Reflects the descriptors and push constants of the shaders and returns the pipeline layout of their combined
+	//interface from the layout cache. The set layouts given replace the reflected ones of the same set. What the layout
+	//was reflected from is kept, so a compute pipeline created with it can be checked against it once rebuilt
+	VkPipelineLayout GetReflectedPipelineLayout(const VkDevice& device, const std::vector<std::string>& shaderFiles,
+		const std::vector<VkDescriptorSetLayout>& setLayouts);
+
+	//Reads the given shader files again and creates a new version of every pipeline using one of them, on the calling
+	//thread and while frames are being rendered. A pipeline is only rebuilt if its shaders still reflect to its layout
+	//and vertex inputs, as its owner binds and pushes for those. The new pipelines wait for SwapRebuiltPipelines,
+	//returns how many were created
+	uint32_t RebuildPipelines(const VkDevice& device, const VkPipelineCache& pipelineCache,
+		const std::vector<std::string>& shaderFiles);
+
+	//Called between frames, before the next one is recorded, to put the rebuilt pipelines in place of the old ones.
+	//The old ones go to the deletion queue, so the frames in flight that use them finish first
+	void SwapRebuiltPipelines(VulkanDeletionQueue& deletionQueue);
 
 	void Cleanup(const VkDevice& device);
 
 	/* Member variable getters */
+	//Set layouts shared with other stages, like those of compute pipelines, are made through it too so they match
+	inline VulkanLayoutCache& GetLayoutCache() { return m_layoutCache; }
+
 	inline const VkPipelineLayout& GetVulkanSDKPipelineLayout() const { return vk_pipelineLayout; }
 
 	inline const VkRenderPass& GetVulkanSDKRenderPass() const { return vk_renderPass; }
 
 	inline const VkPipeline& GetVulkanSDKGraphicsPipeline() const { return vk_graphicsPipeline; }
+
+	inline const VkPipelineLayout& GetVulkanSDKMeshPipelineLayout() const { return vk_meshPipelineLayout; }
+
+	//VK_NULL_HANDLE until CreateMeshPipeline has been called
+	inline const VkPipeline& GetVulkanSDKMeshPipeline() const { return vk_meshPipeline; }
+
+	inline const VkPipelineLayout& GetVulkanSDKParticlePipelineLayout() const { return vk_particlePipelineLayout; }
+
+	//VK_NULL_HANDLE until CreateParticlePipeline has been called
+	inline const VkPipeline& GetVulkanSDKParticlePipeline() const { return vk_particlePipeline; }
+
+	//Shared by both overlay pipelines, which are VK_NULL_HANDLE until CreateOverlayPipelines has been called
+	inline const VkPipelineLayout& GetVulkanSDKOverlayPipelineLayout() const { return vk_overlayPipelineLayout; }
+
+	inline const VkPipeline& GetVulkanSDKOverlayPipeline() const { return vk_overlayPipeline; }
+
+	inline const VkPipeline& GetVulkanSDKAdditiveOverlayPipeline() const { return vk_additiveOverlayPipeline; }
+
+	//VK_NULL_HANDLE unless CreateMultiviewRenderPass has been called
+	inline const VkRenderPass& GetVulkanSDKMultiviewRenderPass() const { return vk_multiviewRenderPass; }
+
+	inline const VkDescriptorSetLayout& GetVulkanSDKMultiviewSetLayout() const { return vk_multiviewSetLayout; }
+
+	inline const VkPipelineLayout& GetVulkanSDKMultiviewPipelineLayout() const { return vk_multiviewPipelineLayout; }
+
+	inline const VkPipeline& GetVulkanSDKMultiviewPipeline() const { return vk_multiviewPipeline; }
+
+	inline const VkPipelineLayout& GetVulkanSDKMultiviewMeshPipelineLayout() const { return vk_multiviewMeshPipelineLayout; }
+
+	inline const VkPipeline& GetVulkanSDKMultiviewMeshPipeline() const { return vk_multiviewMeshPipeline; }
+
+	inline const VkPipelineLayout& GetVulkanSDKMultiviewParticlePipelineLayout() const
+	{
+		return vk_multiviewParticlePipelineLayout;
+	}
+
+	inline const VkPipeline& GetVulkanSDKMultiviewParticlePipeline() const { return vk_multiviewParticlePipeline; }
+
+	//VK_NULL_HANDLE unless CreateDeferredRenderPass has been called
+	inline const VkRenderPass& GetVulkanSDKDeferredRenderPass() const { return vk_deferredRenderPass; }
+
+	inline const VkDescriptorSetLayout& GetVulkanSDKGBufferSetLayout() const { return vk_gbufferSetLayout; }
+
+	inline const VkPipelineLayout& GetVulkanSDKDeferredPipelineLayout() const { return vk_deferredPipelineLayout; }
+
+	inline const VkPipeline& GetVulkanSDKDeferredPipeline() const { return vk_deferredPipeline; }
+
+	inline const VkPipelineLayout& GetVulkanSDKGBufferMeshPipelineLayout() const { return vk_gbufferMeshPipelineLayout; }
+
+	inline const VkPipeline& GetVulkanSDKGBufferMeshPipeline() const { return vk_gbufferMeshPipeline; }
+
+	inline const VkPipelineLayout& GetVulkanSDKDeferredLightingPipelineLayout() const
+	{
+		return vk_deferredLightingPipelineLayout;
+	}
+
+	inline const VkPipeline& GetVulkanSDKDeferredLightingPipeline() const { return vk_deferredLightingPipeline; }
+
+	inline const VkPipelineLayout& GetVulkanSDKDeferredParticlePipelineLayout() const
+	{
+		return vk_deferredParticlePipelineLayout;
+	}
+
+	inline const VkPipeline& GetVulkanSDKDeferredParticlePipeline() const { return vk_deferredParticlePipeline; }
+
+	inline const VkPipelineLayout& GetVulkanSDKDeferredOverlayPipelineLayout() const
+	{
+		return vk_deferredOverlayPipelineLayout;
+	}
+
+	inline const VkPipeline& GetVulkanSDKDeferredOverlayPipeline() const { return vk_deferredOverlayPipeline; }
+
+	inline const VkPipeline& GetVulkanSDKDeferredAdditiveOverlayPipeline() const
+	{
+		return vk_deferredAdditiveOverlayPipeline;
+	}
+
+	//VK_NULL_HANDLE unless CreateShadowRenderPass has been called
+	inline const VkRenderPass& GetVulkanSDKShadowRenderPass() const { return vk_shadowRenderPass; }
+
+	inline const VkPipelineLayout& GetVulkanSDKShadowMeshPipelineLayout() const { return vk_shadowMeshPipelineLayout; }
+
+	inline const VkPipeline& GetVulkanSDKShadowMeshPipeline() const { return vk_shadowMeshPipeline; }
 	/* End member variable getters */
 private:
-	void ReadFile(const std::string& filename, std::vector<char>& byteCode);
+	//The shaders and set layouts a pipeline layout was reflected from
+	struct ReflectedLayoutSource
+	{
+		std::vector<std::string> shaderFiles;
+		std::vector<VkDescriptorSetLayout> setLayouts;
+	};
+
+	//Everything needed to create a pipeline again once one of its shaders has been recompiled
+	struct PipelineRecord
+	{
+		//Only the variant is used by compute pipelines
+		GraphicsPipelineDescription description;
+		//Empty for graphics pipelines
+		std::string computeShaderFile;
+		VkPipelineLayout vk_pipelineLayout;
+		//Reflected again from the recompiled shaders, which must give back the same layout
+		ReflectedLayoutSource layoutSource;
+		//Where the pipeline is kept, which its owner reads every time it binds it
+		VkPipeline* pipeline;
+	};
+
+	//A rebuilt pipeline waiting to replace the one at the same place
+	struct PipelineSwap
+	{
+		VkPipeline* pipeline;
+		VkPipeline vk_rebuiltPipeline;
+	};
+
+	//Called by the pipeline creation functions to build a pipeline for the render pass from its description
+	void CreatePipeline(const VkDevice& device, const VkPipelineCache& pipelineCache, 
+		const GraphicsPipelineDescription& description, VkPipelineLayout& pipelineLayout, VkPipeline& pipeline);
+
+	//Called by CreatePipeline and RebuildPipelines to create the pipeline object with an existing layout
+	VkResult BuildGraphicsPipeline(const VkDevice& device, const VkPipelineCache& pipelineCache,
+		const GraphicsPipelineDescription& description, const VkPipelineLayout& pipelineLayout, VkPipeline& pipeline);
+
+	//Called by CreateComputePipeline and RebuildPipelines to create the pipeline object
+	VkResult BuildComputePipeline(const VkDevice& device, const VkPipelineCache& pipelineCache,
+		const std::string& shaderFile, const ShaderVariantKey& variant, const VkPipelineLayout& pipelineLayout,
+		VkPipeline& pipeline);
+
+	//Called by GetReflectedPipelineLayout and RebuildPipelines, returns false without a layout if a shader cannot be
+	//read or reflected, or if two of them declare different resources at the same binding
+	bool ReflectPipelineLayout(const VkDevice& device, const std::vector<std::string>& shaderFiles,
+		const std::vector<VkDescriptorSetLayout>& setLayouts, VkPipelineLayout& pipelineLayout);
+
+	//Returns false if an input the vertex shader reads is not fed by an attribute of the description
+	bool CheckVertexInputs(const GraphicsPipelineDescription& description);
+
+	//Returns the code ReadShaderFiles read for a shader file, or reads the file if it was not one of them. Returns false
+	//if the file could not be read
+	bool GetShaderCode(const std::string& filename, std::vector<char>& byteCode);
+
+	//Returns false if the code could not be read or is not valid SPIR-V, like a file caught while being written
+	bool ReflectShaderFile(const std::string& filename, ShaderReflection& reflection);
+
+	//Returns false if the file could not be opened or read whole
+	bool ReadFile(const std::string& filename, std::vector<char>& byteCode);
 
 	//Creates the shader module used to wrap around the code of the shaders
 	void CreateShaderModule(const std::vector<char>& code, const VkDevice& device, 
@@ -34,9 +314,75 @@ private:
 	//Holds the graphics pipeline object 
 	VkPipeline vk_graphicsPipeline;
 
-	//Used to specify the layouts used to pass uniform variables to shaders
+	//Used to specify the layouts used to pass uniform variables to shaders. Every pipeline layout and descriptor set
+	//layout below is owned by the layout cache, and pipelines with the same interface share one
 	VkPipelineLayout vk_pipelineLayout;
 
+	//The mesh pipeline takes its transform as a push constant, and the clustered lights through a set if they are drawn
+	VkPipeline vk_meshPipeline;
+	VkPipelineLayout vk_meshPipelineLayout;
+
+	//The particle pipeline reads the particle buffers through a descriptor set and takes the camera as a push constant
+	VkPipeline vk_particlePipeline;
+	VkPipelineLayout vk_particlePipelineLayout;
+
+	//The overlay pipelines only differ in how they blend, so they share a layout taking the framebuffer's size as a
+	//push constant and the atlas through a set
+	VkPipeline vk_overlayPipeline;
+	VkPipeline vk_additiveOverlayPipeline;
+	VkPipelineLayout vk_overlayPipelineLayout;
+
+	//The multiview variants read the matrix of their view from a uniform buffer instead of the push constants,
+	//the set holding it comes after the sets of the main variant
+	VkRenderPass vk_multiviewRenderPass;
+	VkDescriptorSetLayout vk_multiviewSetLayout;
+	VkPipeline vk_multiviewPipeline;
+	VkPipelineLayout vk_multiviewPipelineLayout;
+	VkPipeline vk_multiviewMeshPipeline;
+	VkPipelineLayout vk_multiviewMeshPipelineLayout;
+	VkPipeline vk_multiviewParticlePipeline;
+	VkPipelineLayout vk_multiviewParticlePipelineLayout;
+
+	//The deferred variants: the mesh writes the G-buffer in the first subpass, and the lighting pipeline shades it
+	//in the second, where the triangle and the particles are drawn unlit as in the main render pass
+	VkRenderPass vk_deferredRenderPass;
+	VkDescriptorSetLayout vk_gbufferSetLayout;
+	VkPipeline vk_deferredPipeline;
+	VkPipelineLayout vk_deferredPipelineLayout;
+	VkPipeline vk_gbufferMeshPipeline;
+	VkPipelineLayout vk_gbufferMeshPipelineLayout;
+	VkPipeline vk_deferredLightingPipeline;
+	VkPipelineLayout vk_deferredLightingPipelineLayout;
+	VkPipeline vk_deferredParticlePipeline;
+	VkPipelineLayout vk_deferredParticlePipelineLayout;
+	VkPipeline vk_deferredOverlayPipeline;
+	VkPipeline vk_deferredAdditiveOverlayPipeline;
+	VkPipelineLayout vk_deferredOverlayPipelineLayout;
+
+	//The shadow variant only has the mesh's vertex stage, it reads the same vertex input and push constants with the
+	//matrix of a cascade in place of the camera's
+	VkRenderPass vk_shadowRenderPass;
+	VkPipeline vk_shadowMeshPipeline;
+	VkPipelineLayout vk_shadowMeshPipelineLayout;
+
+	//The SPIR-V read by ReadShaderFiles, replaced when a shader is recompiled
+	std::unordered_map<std::string, std::vector<char>> m_shaderCode;
+
+	//Pipelines are created by several startup stages at once and rebuilt on the hot reload thread, so the shader code
+	//and the lists below are guarded
+	std::mutex m_mutex;
+
+	//Every pipeline created so far, so that the ones using a recompiled shader can be found and created again
+	std::vector<PipelineRecord> m_pipelineRecords;
+
+	//Rebuilt pipelines that have not been swapped in yet
+	std::vector<PipelineSwap> m_pendingSwaps;
+
+	//What every layout GetReflectedPipelineLayout returned was first reflected from
+	std::unordered_map<VkPipelineLayout, ReflectedLayoutSource> m_reflectedLayouts;
+
+	VulkanLayoutCache m_layoutCache;
+
 	//Holds important information about rendering operations
 	//( color and depth buffers, samples to use for them)
 	VkRenderPass vk_renderPass;
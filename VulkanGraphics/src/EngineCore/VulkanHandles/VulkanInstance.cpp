@@ -19,26 +19,34 @@ void VulkanInstanceHandle::CreateVulkanInstance(const GlfwWindowHandle& window)
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     //Passing the application info stuct to the instance
     createInfo.pApplicationInfo = &appInfo;
-    //Passing the required extensions for glfw to the instance
-    createInfo.enabledExtensionCount = window.GetExtensionCount();
-    createInfo.ppEnabledExtensionNames = window.GetExtensionNames();
-    //Setting up Validation layers
-    createInfo.enabledLayerCount = 0;
-    /* Create info struct for vulkan instance complete */
+    //The required extensions for glfw are always enabled
+    m_enabledExtensions.assign(window.GetExtensionNames(), window.GetExtensionNames() + window.GetExtensionCount());
 
     /* Checking for available extensions */
     uint32_t extensionCount = 0;
     vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
     std::vector<VkExtensionProperties> extensions(extensionCount);
     vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
-    uint32_t currentExtension = 1;
     for (const VkExtensionProperties& extension : extensions)
     {
-        std::cout << "-Extension " << currentExtension << " : " << extension.extensionName << '\n';
-        ++currentExtension;
+        //Optional extensions are enabled if they are found
+        for (const char* optionalExtension : optionalInstanceExtensions)
+        {
+            if (!strcmp(extension.extensionName, optionalExtension))
+            {
+                m_enabledExtensions.push_back(optionalExtension);
+            }
+        }
     }
     /* Available extension check complete */
 
+    //Passing the required extensions for glfw and the optional ones found above to the instance
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(m_enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = m_enabledExtensions.data();
+    //Setting up Validation layers
+    createInfo.enabledLayerCount = 0;
+    /* Create info struct for vulkan instance complete */
+
     //Creating the vulkan instance and checking if its creation was succesful
     VkResult instanceResult = vkCreateInstance(&createInfo, nullptr, &vk_instance);
     if (instanceResult != VK_SUCCESS)
@@ -47,6 +55,18 @@ void VulkanInstanceHandle::CreateVulkanInstance(const GlfwWindowHandle& window)
     }
 }
 
+bool VulkanInstanceHandle::IsExtensionEnabled(const char* extensionName) const
+{
+    for (const char* enabledExtension : m_enabledExtensions)
+    {
+        if (!strcmp(enabledExtension, extensionName))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void VulkanInstanceHandle::Cleanup()
 {
     vkDestroyInstance(vk_instance, nullptr);
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <iostream>
+#include <cstring>
 #include "EngineCore/Window/GlfwWindowHandle.h"
 
+//Holds instance extensions that are enabled only if they are available, features that depend on them are skipped otherwise
+const std::vector<const char*> optionalInstanceExtensions = { VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
+	VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME };
 
 /**********************************************
 * Holds the instance class of the vulkan SDK, * 
@@ -22,10 +26,17 @@ public:
 	{
 		return vk_instance;
 	}
+
 	/* End member variable getters */
+
+	//Returns true if the extension was enabled when the instance was created
+	bool IsExtensionEnabled(const char* extensionName) const;
 private:
 
 private:
 	//The instance class of the vuklan SDK
 	VkInstance vk_instance;
+
+	//Names of all the extensions the instance was created with
+	std::vector<const char*> m_enabledExtensions;
 };
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "VulkanLayoutCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+//Non-dispatchable handles are pointers on 64 bit builds and integers on 32 bit ones, copying covers both
+template<typename Handle>
+static uint64_t GetHandleKey(const Handle& handle)
+{
+	uint64_t key = 0;
+	std::memcpy(&key, &handle, sizeof(handle));
+	return key;
+}
+
+VulkanLayoutCache::VulkanLayoutCache()
+	:m_mutex(), m_setLayouts(), m_pipelineLayouts(), m_createdCount{0}, m_reusedCount{0}
+{
+
+}
+
+size_t VulkanLayoutCache::LayoutKeyHash::operator()(const std::vector<uint64_t>& key) const
+{
+	//FNV-1a over the words
+	uint64_t hash = 14695981039346656037ull;
+	for (uint64_t word : key)
+	{
+		hash ^= word;
+		hash *= 1099511628211ull;
+	}
+	return static_cast<size_t>(hash);
+}
+
+/**********************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation	  *
+* Function Argument 2: The bindings of the set, each with the stages that use it  *
+**********************************************************************************/
+VkDescriptorSetLayout VulkanLayoutCache::GetDescriptorSetLayout(const VkDevice& device,
+	const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+{
+	//Sorted, so the same bindings listed in another order find the same layout
+	std::vector<VkDescriptorSetLayoutBinding> sortedBindings = bindings;
+	std::sort(sortedBindings.begin(), sortedBindings.end(),
+		[](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) { return a.binding < b.binding; });
+
+	std::vector<uint64_t> key;
+	key.reserve(sortedBindings.size() * 2);
+	for (const VkDescriptorSetLayoutBinding& binding : sortedBindings)
+	{
+		if (binding.pImmutableSamplers)
+		{
+			__debugbreak();
+		}
+		key.push_back((static_cast<uint64_t>(binding.binding) << 32) | static_cast<uint32_t>(binding.descriptorType));
+		key.push_back((static_cast<uint64_t>(binding.descriptorCount) << 32) | binding.stageFlags);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto existing = m_setLayouts.find(key);
+	if (existing != m_setLayouts.end())
+	{
+		++m_reusedCount;
+		return existing->second;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(sortedBindings.size());
+	layoutInfo.pBindings = sortedBindings.data();
+
+	VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+	VkResult layoutResult = vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout);
+	if (layoutResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	m_setLayouts.emplace(std::move(key), setLayout);
+	++m_createdCount;
+	return setLayout;
+}
+
+/*******************************************************************************
+* Function Argument 1: The Vulkan SDK device object is needed for the creation *
+* Function Argument 2: The layout of every set, in set order				   *
+* Function Argument 3: The push constant ranges, in the order given			   *
+*******************************************************************************/
+VkPipelineLayout VulkanLayoutCache::GetPipelineLayout(const VkDevice& device,
+	const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges)
+{
+	//The set count leads, so set layouts can not be mistaken for push constant ranges
+	std::vector<uint64_t> key;
+	key.reserve(1 + setLayouts.size() + pushConstantRanges.size() * 2);
+	key.push_back(setLayouts.size());
+	for (const VkDescriptorSetLayout& setLayout : setLayouts)
+	{
+		key.push_back(GetHandleKey(setLayout));
+	}
+	for (const VkPushConstantRange& range : pushConstantRanges)
+	{
+		key.push_back(range.stageFlags);
+		key.push_back((static_cast<uint64_t>(range.offset) << 32) | range.size);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto existing = m_pipelineLayouts.find(key);
+	if (existing != m_pipelineLayouts.end())
+	{
+		++m_reusedCount;
+		return existing->second;
+	}
+
+	VkPipelineLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+	layoutInfo.pSetLayouts = setLayouts.data();
+	layoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+	layoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+	VkResult layoutResult = vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipelineLayout);
+	if (layoutResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	m_pipelineLayouts.emplace(std::move(key), pipelineLayout);
+	++m_createdCount;
+	return pipelineLayout;
+}
+
+void VulkanLayoutCache::Cleanup(const VkDevice& device)
+{
+	//Pipeline layouts first, as they were created from the set layouts
+	for (const auto& pipelineLayout : m_pipelineLayouts)
+	{
+		vkDestroyPipelineLayout(device, pipelineLayout.second, nullptr);
+	}
+	for (const auto& setLayout : m_setLayouts)
+	{
+		vkDestroyDescriptorSetLayout(device, setLayout.second, nullptr);
+	}
+	m_pipelineLayouts.clear();
+	m_setLayouts.clear();
+}
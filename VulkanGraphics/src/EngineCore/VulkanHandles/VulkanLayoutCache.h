@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "VulkanDevice.h"
+
+/******************************************************************
+* Owns every descriptor set layout and pipeline layout, and hands *
+* out the same object for identical descriptions. Pipelines with  *
+* the same interface then share a layout, so the descriptor sets  *
+* bound for one stay bound when the next is bound				  *
+******************************************************************/
+class VulkanLayoutCache
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanLayoutCache();
+
+	//Returns the set layout of the bindings, creating it the first time they are asked for. The bindings may be in any
+	//order, and immutable samplers are not supported
+	VkDescriptorSetLayout GetDescriptorSetLayout(const VkDevice& device, const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+	//Returns the pipeline layout of the set layouts and push constant ranges, creating it the first time it is asked for
+	VkPipelineLayout GetPipelineLayout(const VkDevice& device, const std::vector<VkDescriptorSetLayout>& setLayouts,
+		const std::vector<VkPushConstantRange>& pushConstantRanges);
+
+	//Destroys every layout handed out, after everything using them is gone
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	//How many distinct layouts were created, and how many requests were answered with an existing one
+	inline uint32_t GetCreatedCount() const { return m_createdCount; }
+
+	inline uint32_t GetReusedCount() const { return m_reusedCount; }
+	/* End member variable getters */
+private:
+	//The words of a layout description, compared whole so the hash only has to spread them
+	struct LayoutKeyHash
+	{
+		size_t operator()(const std::vector<uint64_t>& key) const;
+	};
+private:
+	//Guards the maps, pipelines are created from several startup jobs at once
+	std::mutex m_mutex;
+
+	std::unordered_map<std::vector<uint64_t>, VkDescriptorSetLayout, LayoutKeyHash> m_setLayouts;
+	std::unordered_map<std::vector<uint64_t>, VkPipelineLayout, LayoutKeyHash> m_pipelineLayouts;
+
+	uint32_t m_createdCount;
+	uint32_t m_reusedCount;
+};
@@ -0,0 +1,273 @@
+#include "VulkanMultiviewTargets.h"
+
+#include <cstring>
+
+VulkanMultiviewTargetsHandle::VulkanMultiviewTargetsHandle()
+	:vk_colorImage{VK_NULL_HANDLE}, vk_colorMemory{VK_NULL_HANDLE}, vk_colorImageView{VK_NULL_HANDLE},
+	vk_depthImage{VK_NULL_HANDLE}, vk_depthMemory{VK_NULL_HANDLE}, vk_depthImageView{VK_NULL_HANDLE},
+	vk_framebuffer{VK_NULL_HANDLE}, m_viewBuffers(), vk_descriptorPool{VK_NULL_HANDLE}, vk_descriptorSets(),
+	vk_viewExtent(), m_viewCount{0}
+{
+
+}
+
+/*******************************************************************************************
+* Function Argument 1: The device handle is needed to create the images and buffers		   *
+* Function Argument 2: Holds the multiview render pass and the layout of the views' set	   *
+* Function Argument 3: The size of every view, and of every layer of the images			   *
+* Function Argument 4: The format of the colour image, the render pass has to match it	   *
+* Function Argument 5: The format of the depth image, the render pass has to match it	   *
+* Function Argument 6: How many views are rendered, one layer is created for each		   *
+* Function Argument 7: How many frames can be recorded before the GPU finishes the oldest  *
+*******************************************************************************************/
+void VulkanMultiviewTargetsHandle::CreateMultiviewTargets(const VulkanDeviceHandle& device,
+	const VulkanGraphicsPipelineHandle& pipelines, const VkExtent2D& viewExtent, VkFormat colorFormat,
+	VkFormat depthFormat, uint32_t viewCount, uint32_t framesInFlight)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	vk_viewExtent = viewExtent;
+	m_viewCount = viewCount;
+
+	//Every frame renders into the same images, the render pass orders each frame against the previous frame's blit
+	CreateLayeredImage(device, colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		VK_IMAGE_ASPECT_COLOR_BIT, vk_colorImage, vk_colorMemory, vk_colorImageView);
+	CreateLayeredImage(device, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT,
+		vk_depthImage, vk_depthMemory, vk_depthImageView);
+
+	/* Creating the framebuffer */
+	VkImageView attachments[] = { vk_colorImageView, vk_depthImageView };
+	VkFramebufferCreateInfo framebufferInfo{};
+	framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebufferInfo.renderPass = pipelines.GetVulkanSDKMultiviewRenderPass();
+	framebufferInfo.attachmentCount = 2;
+	framebufferInfo.pAttachments = attachments;
+	framebufferInfo.width = viewExtent.width;
+	framebufferInfo.height = viewExtent.height;
+	//The view mask picks the layers with multiview, so the framebuffer itself has a single layer
+	framebufferInfo.layers = 1;
+
+	VkResult framebufferResult = vkCreateFramebuffer(vk_device, &framebufferInfo, nullptr, &vk_framebuffer);
+	if (framebufferResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	/* Framebuffer created */
+
+	/* Creating the view buffers and their descriptor sets */
+	m_viewBuffers.resize(framesInFlight);
+	for (VulkanBufferHandle& buffer : m_viewBuffers)
+	{
+		//Written by the CPU every frame and read once per vertex batch, host visible memory is fast enough
+		buffer.CreateBuffer(device, sizeof(Mat4) * MULTIVIEW_MAX_VIEWS, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	}
+
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSize.descriptorCount = framesInFlight;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = framesInFlight;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+
+	VkResult poolResult = vkCreateDescriptorPool(vk_device, &poolInfo, nullptr, &vk_descriptorPool);
+	if (poolResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	std::vector<VkDescriptorSetLayout> setLayouts(framesInFlight, pipelines.GetVulkanSDKMultiviewSetLayout());
+	VkDescriptorSetAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = vk_descriptorPool;
+	allocateInfo.descriptorSetCount = framesInFlight;
+	allocateInfo.pSetLayouts = setLayouts.data();
+
+	vk_descriptorSets.resize(framesInFlight, VK_NULL_HANDLE);
+	VkResult allocateResult = vkAllocateDescriptorSets(vk_device, &allocateInfo, vk_descriptorSets.data());
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	//The buffers never change, so every set is written once
+	for (uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = m_viewBuffers[i].GetVulkanSDKBuffer();
+		bufferInfo.offset = 0;
+		bufferInfo.range = VK_WHOLE_SIZE;
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = vk_descriptorSets[i];
+		write.dstBinding = 0;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		write.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(vk_device, 1, &write, 0, nullptr);
+	}
+	/* View buffers and descriptor sets created */
+}
+
+/*************************************************************************************
+* Function Argument 1: The device handle is needed to create the image and find a	 *
+*					   device local memory type for it								 *
+* Function Argument 2: The format of the image									     *
+* Function Argument 3: How the image is used									     *
+* Function Argument 4: Whether the image holds colour or depth					     *
+* Function Arguments 5 to 7: Receive the image, its memory and its array view		 *
+*************************************************************************************/
+void VulkanMultiviewTargetsHandle::CreateLayeredImage(const VulkanDeviceHandle& device, VkFormat format,
+	VkImageUsageFlags usage, VkImageAspectFlags aspect, VkImage& image, VkDeviceMemory& memory,
+	VkImageView& imageView) const
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+
+	/* Initializing create info struct for the image */
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = format;
+	imageInfo.extent = { vk_viewExtent.width, vk_viewExtent.height, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = m_viewCount;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = usage;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	/* Create info struct complete */
+
+	VkResult imageResult = vkCreateImage(vk_device, &imageInfo, nullptr, &image);
+	if (imageResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(vk_device, image, &memoryRequirements);
+
+	VkMemoryAllocateInfo allocateInfo{};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = memoryRequirements.size;
+	allocateInfo.memoryTypeIndex = device.FindMemoryTypeIndex(memoryRequirements.memoryTypeBits,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	VkResult allocateResult = vkAllocateMemory(vk_device, &allocateInfo, nullptr, &memory);
+	if (allocateResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	vkBindImageMemory(vk_device, image, memory, 0);
+
+	/* Initializing create info struct for the image view */
+	//The multiview render pass needs every layer in a single array view
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	viewInfo.format = format;
+	viewInfo.subresourceRange = { aspect, 0, 1, 0, m_viewCount };
+	/* Create info struct complete */
+
+	VkResult viewResult = vkCreateImageView(vk_device, &viewInfo, nullptr, &imageView);
+	if (viewResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+}
+
+/************************************************************************
+* Function Argument 1: The index of the frame being recorded			*
+* Function Argument 2: The view projection matrix of every view		    *
+* Function Argument 3: How many matrices there are, at most the views	*
+************************************************************************/
+void VulkanMultiviewTargetsHandle::WriteViewMatrices(uint32_t frameIndex, const Mat4* viewProjections, uint32_t count)
+{
+	//The memory is coherent, so the write is visible once the frame is submitted
+	memcpy(m_viewBuffers[frameIndex].GetMappedData(), viewProjections, sizeof(Mat4) * count);
+}
+
+/***************************************************************************
+* Function Argument 1: The command buffer the blits are recorded into	   *
+* Function Argument 2: The image the views are shown in					   *
+* Function Argument 3: The size of the destination image				   *
+* Function Argument 4: The layout the image is left in, for presenting or  *
+*					   for the frame capture copying it					   *
+***************************************************************************/
+void VulkanMultiviewTargetsHandle::RecordPresentBlit(const VkCommandBuffer& commandBuffer, const VkImage& dstImage,
+	const VkExtent2D& dstExtent, VkImageLayout finalLayout) const
+{
+	/* Preparing the image to be blitted to */
+	//Waits for the acquire semaphore, which the submit waits on at the colour output stage
+	VkImageMemoryBarrier toTransfer{};
+	toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	toTransfer.srcAccessMask = 0;
+	toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.image = dstImage;
+	toTransfer.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toTransfer);
+	/* Image prepared */
+
+	/* Blitting the views */
+	//Each view gets an equal column of the image, scaled if the image is not exactly the views side by side
+	for (uint32_t view = 0; view < m_viewCount; ++view)
+	{
+		VkImageBlit blit{};
+		blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, view, 1 };
+		blit.srcOffsets[0] = { 0, 0, 0 };
+		blit.srcOffsets[1] = { static_cast<int32_t>(vk_viewExtent.width), static_cast<int32_t>(vk_viewExtent.height), 1 };
+		blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		blit.dstOffsets[0] = { static_cast<int32_t>(dstExtent.width * view / m_viewCount), 0, 0 };
+		blit.dstOffsets[1] = { static_cast<int32_t>(dstExtent.width * (view + 1) / m_viewCount),
+			static_cast<int32_t>(dstExtent.height), 1 };
+		vkCmdBlitImage(commandBuffer, vk_colorImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dstImage,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+	}
+	/* Views blitted */
+
+	/* Moving the image into its final layout */
+	//The frame capture waits on the colour output stage before copying the image, so that stage is included for its
+	//barrier to be ordered after the blits
+	VkImageMemoryBarrier toFinal{};
+	toFinal.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	toFinal.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	toFinal.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	toFinal.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	toFinal.newLayout = finalLayout;
+	toFinal.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toFinal.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toFinal.image = dstImage;
+	toFinal.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 1,
+		&toFinal);
+	/* Image moved */
+}
+
+void VulkanMultiviewTargetsHandle::Cleanup(const VkDevice& device)
+{
+	for (VulkanBufferHandle& buffer : m_viewBuffers)
+	{
+		buffer.Cleanup(device);
+	}
+	m_viewBuffers.clear();
+	vkDestroyDescriptorPool(device, vk_descriptorPool, nullptr);
+	vk_descriptorSets.clear();
+	vkDestroyFramebuffer(device, vk_framebuffer, nullptr);
+	vkDestroyImageView(device, vk_colorImageView, nullptr);
+	vkDestroyImage(device, vk_colorImage, nullptr);
+	vkFreeMemory(device, vk_colorMemory, nullptr);
+	vkDestroyImageView(device, vk_depthImageView, nullptr);
+	vkDestroyImage(device, vk_depthImage, nullptr);
+	vkFreeMemory(device, vk_depthMemory, nullptr);
+	vk_framebuffer = VK_NULL_HANDLE;
+}
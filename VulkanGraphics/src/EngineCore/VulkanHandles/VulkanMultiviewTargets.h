@@ -0,0 +1,76 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "VulkanGraphicsPipeline.h"
+#include "EngineCore/Math/VectorMath.h"
+
+/**************************************************************
+* Holds the layered colour and depth images the multiview	  *
+* render pass renders every view into, one layer per view,	  *
+* the framebuffer attaching them, and a uniform buffer with	  *
+* the matrix of every view for each frame in flight. After	  *
+* the pass, the layers are blitted side by side into the	  *
+* image that is presented or captured						  *
+**************************************************************/
+class VulkanMultiviewTargetsHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanMultiviewTargetsHandle();
+
+	//Creates the layered images with a layer of the given extent for every view, the framebuffer for the multiview
+	//render pass, and a uniform buffer and descriptor set for every frame in flight
+	void CreateMultiviewTargets(const VulkanDeviceHandle& device, const VulkanGraphicsPipelineHandle& pipelines,
+		const VkExtent2D& viewExtent, VkFormat colorFormat, VkFormat depthFormat, uint32_t viewCount,
+		uint32_t framesInFlight);
+
+	//Copies the matrix of every view into the uniform buffer of the frame, which the GPU is done reading
+	void WriteViewMatrices(uint32_t frameIndex, const Mat4* viewProjections, uint32_t count);
+
+	//Blits every view into its own column of the destination image, then moves the image into its final layout.
+	//The image's previous contents are discarded
+	void RecordPresentBlit(const VkCommandBuffer& commandBuffer, const VkImage& dstImage, const VkExtent2D& dstExtent,
+		VkImageLayout finalLayout) const;
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline bool IsCreated() const { return vk_framebuffer != VK_NULL_HANDLE; }
+
+	inline uint32_t GetViewCount() const { return m_viewCount; }
+
+	inline const VkExtent2D& GetViewExtent() const { return vk_viewExtent; }
+
+	inline const VkFramebuffer& GetVulkanSDKFramebuffer() const { return vk_framebuffer; }
+
+	inline const VkDescriptorSet& GetVulkanSDKDescriptorSet(uint32_t frameIndex) const
+	{
+		return vk_descriptorSets[frameIndex];
+	}
+	/* End member variable getters */
+private:
+	//Creates an image with a layer per view in device local memory, and the array view the framebuffer attaches
+	void CreateLayeredImage(const VulkanDeviceHandle& device, VkFormat format, VkImageUsageFlags usage,
+		VkImageAspectFlags aspect, VkImage& image, VkDeviceMemory& memory, VkImageView& imageView) const;
+
+	VkImage vk_colorImage;
+	VkDeviceMemory vk_colorMemory;
+	VkImageView vk_colorImageView;
+
+	VkImage vk_depthImage;
+	VkDeviceMemory vk_depthMemory;
+	VkImageView vk_depthImageView;
+
+	VkFramebuffer vk_framebuffer;
+
+	//A buffer for every frame in flight, so the matrices of a frame are never written while the GPU reads them
+	std::vector<VulkanBufferHandle> m_viewBuffers;
+
+	VkDescriptorPool vk_descriptorPool;
+
+	std::vector<VkDescriptorSet> vk_descriptorSets;
+
+	VkExtent2D vk_viewExtent;
+
+	uint32_t m_viewCount;
+};
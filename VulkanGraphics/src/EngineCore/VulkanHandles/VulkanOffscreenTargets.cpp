@@ -0,0 +1,93 @@
+#include "VulkanOffscreenTargets.h"
+
+VulkanOffscreenTargetsHandle::VulkanOffscreenTargetsHandle()
+	:vk_images(), vk_memories(), vk_imageViews(), vk_extent()
+{
+
+}
+
+/**********************************************************************************
+* Function Argument 1: The device handle is needed to create the images and find  *
+*					   a device local memory type for them						  *
+* Function Argument 2: The size of every image									  *
+* Function Argument 3: The format of every image, the render pass has to match it *
+* Function Argument 4: How many images are created								  *
+**********************************************************************************/
+void VulkanOffscreenTargetsHandle::CreateOffscreenTargets(const VulkanDeviceHandle& device, const VkExtent2D& extent,
+	VkFormat format, uint32_t count)
+{
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	vk_extent = extent;
+	vk_images.resize(count, VK_NULL_HANDLE);
+	vk_memories.resize(count, VK_NULL_HANDLE);
+	vk_imageViews.resize(count, VK_NULL_HANDLE);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		/* Initializing create info struct for the image */
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = format;
+		imageInfo.extent = { extent.width, extent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		//Rendered to by the render pass, or blitted to from the multiview targets, then copied into a readback buffer
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		/* Create info struct complete */
+
+		VkResult imageResult = vkCreateImage(vk_device, &imageInfo, nullptr, &vk_images[i]);
+		if (imageResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(vk_device, vk_images[i], &memoryRequirements);
+
+		VkMemoryAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocateInfo.allocationSize = memoryRequirements.size;
+		allocateInfo.memoryTypeIndex = device.FindMemoryTypeIndex(memoryRequirements.memoryTypeBits,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		VkResult allocateResult = vkAllocateMemory(vk_device, &allocateInfo, nullptr, &vk_memories[i]);
+		if (allocateResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+		vkBindImageMemory(vk_device, vk_images[i], vk_memories[i], 0);
+
+		/* Initializing create info struct for the image view */
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = vk_images[i];
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = format;
+		viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		/* Create info struct complete */
+
+		VkResult viewResult = vkCreateImageView(vk_device, &viewInfo, nullptr, &vk_imageViews[i]);
+		if (viewResult != VK_SUCCESS)
+		{
+			__debugbreak();
+		}
+	}
+}
+
+void VulkanOffscreenTargetsHandle::Cleanup(const VkDevice& device)
+{
+	for (size_t i = 0; i < vk_images.size(); ++i)
+	{
+		vkDestroyImageView(device, vk_imageViews[i], nullptr);
+		vkDestroyImage(device, vk_images[i], nullptr);
+		vkFreeMemory(device, vk_memories[i], nullptr);
+	}
+	vk_images.clear();
+	vk_memories.clear();
+	vk_imageViews.clear();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "VulkanDevice.h"
+
+/*************************************************************
+* Holds colour images that frames render into instead of	 *
+* swapchain images, used when frames are never presented.	 *
+* Each image can be rendered to and copied from, and has the *
+* image view its framebuffer attaches						 *
+*************************************************************/
+class VulkanOffscreenTargetsHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanOffscreenTargetsHandle();
+
+	//Creates the images in device local memory and their views
+	void CreateOffscreenTargets(const VulkanDeviceHandle& device, const VkExtent2D& extent, VkFormat format,
+		uint32_t count);
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline const std::vector<VkImage>& GetVulkanSDKImages() const { return vk_images; }
+
+	inline const std::vector<VkImageView>& GetVulkanSDKImageViews() const { return vk_imageViews; }
+
+	inline const VkExtent2D& GetExtent() const { return vk_extent; }
+	/* End member variable getters */
+private:
+	std::vector<VkImage> vk_images;
+
+	std::vector<VkDeviceMemory> vk_memories;
+
+	std::vector<VkImageView> vk_imageViews;
+
+	VkExtent2D vk_extent;
+};
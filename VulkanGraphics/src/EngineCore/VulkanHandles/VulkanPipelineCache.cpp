@@ -0,0 +1,97 @@
+#include "VulkanPipelineCache.h"
+
+#include <cstring>
+#include <fstream>
+
+VulkanPipelineCacheHandle::VulkanPipelineCacheHandle()
+	:vk_pipelineCache{VK_NULL_HANDLE}, m_fileData(), m_warm{false}
+{
+
+}
+
+void VulkanPipelineCacheHandle::ReadCacheFile(const std::string& filename)
+{
+	m_fileData.clear();
+
+	std::ifstream file(filename, std::ios::ate | std::ios::binary);
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	size_t fileSize = file.tellg();
+	m_fileData.resize(fileSize);
+	file.seekg(0);
+	if (!file.read(m_fileData.data(), fileSize))
+	{
+		m_fileData.clear();
+	}
+}
+
+/********************************************************************************
+* Function Argument 1: The device handle is needed to create the cache and to   *
+*					   check the data was written by the same GPU and driver	*
+********************************************************************************/
+void VulkanPipelineCacheHandle::CreatePipelineCache(const VulkanDeviceHandle& device)
+{
+	//Drivers are meant to reject data they did not write, but not every driver checks, so the header is checked here too
+	m_warm = IsDataCompatible(device.GetPhysicalDeviceProperties());
+
+	/* Initializing create info struct for the pipeline cache */
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = m_warm ? m_fileData.size() : 0;
+	createInfo.pInitialData = m_warm ? m_fileData.data() : nullptr;
+	/* Create info struct complete */
+
+	VkResult cacheResult = vkCreatePipelineCache(device.GetVulkanSDKLogicalDevice(), &createInfo, nullptr, &vk_pipelineCache);
+	if (cacheResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+
+	//The cache copied the data, the file's copy is not needed anymore
+	m_fileData.clear();
+	m_fileData.shrink_to_fit();
+}
+
+bool VulkanPipelineCacheHandle::IsDataCompatible(const VkPhysicalDeviceProperties& properties) const
+{
+	if (m_fileData.size() < PIPELINE_CACHE_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	//The header is a list of 32 bit values followed by the cache UUID, all in the GPU's byte order
+	uint32_t header[4];
+	std::memcpy(header, m_fileData.data(), sizeof(header));
+	uint32_t headerSize = header[0];
+	uint32_t headerVersion = header[1];
+	uint32_t vendorId = header[2];
+	uint32_t deviceId = header[3];
+
+	return headerSize >= PIPELINE_CACHE_HEADER_SIZE && headerSize <= m_fileData.size() &&
+		headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && vendorId == properties.vendorID &&
+		deviceId == properties.deviceID &&
+		std::memcmp(m_fileData.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void VulkanPipelineCacheHandle::WriteCacheFile(const VkDevice& device, const std::string& filename) const
+{
+	size_t dataSize = 0;
+	vkGetPipelineCacheData(device, vk_pipelineCache, &dataSize, nullptr);
+	std::vector<char> data(dataSize);
+	if (dataSize == 0 || vkGetPipelineCacheData(device, vk_pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+	{
+		return;
+	}
+
+	//A write that fails only costs the next launch a cold cache
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	file.write(data.data(), dataSize);
+}
+
+void VulkanPipelineCacheHandle::Cleanup(const VkDevice& device)
+{
+	vkDestroyPipelineCache(device, vk_pipelineCache, nullptr);
+}
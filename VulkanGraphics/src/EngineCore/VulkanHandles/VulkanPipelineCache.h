@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "VulkanDevice.h"
+
+//Size of the header every pipeline cache starts with: its size, version, vendor id, device id and cache UUID
+#define PIPELINE_CACHE_HEADER_SIZE (16 + VK_UUID_SIZE)
+
+/******************************************************************
+* Holds the pipeline cache every pipeline is compiled through.    *
+* Its data is written to a file on shutdown and read back on the  *
+* next launch, so pipelines compiled before are only looked up	  *
+* rather than compiled again. The file is read before the device  *
+* exists, so the disk read overlaps the device creation			  *
+******************************************************************/
+class VulkanPipelineCacheHandle
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanPipelineCacheHandle();
+
+	//Reads the cache file into memory, a missing file leaves the cache empty
+	void ReadCacheFile(const std::string& filename);
+
+	//Creates the pipeline cache from the data read, the data is dropped if another GPU or driver wrote it
+	void CreatePipelineCache(const VulkanDeviceHandle& device);
+
+	//Writes the data of every pipeline compiled so far, to be read by the next launch
+	void WriteCacheFile(const VkDevice& device, const std::string& filename) const;
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline const VkPipelineCache& GetVulkanSDKPipelineCache() const { return vk_pipelineCache; }
+
+	//True if the cache was created from the file's data, so the pipelines should not need compiling
+	inline bool IsWarm() const { return m_warm; }
+	/* End member variable getters */
+private:
+	//Called by CreatePipelineCache, returns false if the data's header does not match the GPU and its driver
+	bool IsDataCompatible(const VkPhysicalDeviceProperties& properties) const;
+private:
+	VkPipelineCache vk_pipelineCache;
+
+	//The file's data, only kept until the cache is created
+	std::vector<char> m_fileData;
+
+	bool m_warm;
+};
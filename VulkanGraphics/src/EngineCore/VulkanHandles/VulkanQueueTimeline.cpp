@@ -0,0 +1,98 @@
+#include "VulkanQueueTimeline.h"
+
+VulkanQueueTimeline::VulkanQueueTimeline()
+	:vk_semaphore{VK_NULL_HANDLE}, m_waitSemaphores{nullptr}, m_getSemaphoreCounterValue{nullptr}, m_lastSignalValue{0},
+	m_completedValue{0}
+{
+
+}
+
+/**************************************************************************************************
+* Function Argument 1: The device handle is needed to check for timeline semaphores and to create *
+**************************************************************************************************/
+void VulkanQueueTimeline::CreateQueueTimeline(const VulkanDeviceHandle& device)
+{
+	if (!device.AreTimelineSemaphoresEnabled())
+	{
+		return;
+	}
+
+	const VkDevice& vk_device = device.GetVulkanSDKLogicalDevice();
+	m_waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(vk_device, "vkWaitSemaphoresKHR"));
+	m_getSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+		vkGetDeviceProcAddr(vk_device, "vkGetSemaphoreCounterValueKHR"));
+	//The device was created with the extension, so its functions are always there
+	if (!m_waitSemaphores || !m_getSemaphoreCounterValue)
+	{
+		__debugbreak();
+	}
+
+	/* Initializing create info struct for the timeline semaphore */
+	VkSemaphoreTypeCreateInfoKHR typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+	//Nothing has been submitted yet, so value 0 is already reached
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+	/* Create info struct complete */
+
+	VkResult semaphoreResult = vkCreateSemaphore(vk_device, &semaphoreInfo, nullptr, &vk_semaphore);
+	if (semaphoreResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+}
+
+uint64_t VulkanQueueTimeline::NextSignalValue()
+{
+	return ++m_lastSignalValue;
+}
+
+/***********************************************************************
+* Function Argument 1: The logical device the semaphore was created on *
+* Function Argument 2: The value signalled by the submit being checked *
+***********************************************************************/
+bool VulkanQueueTimeline::IsComplete(const VkDevice& device, uint64_t value)
+{
+	if (value > m_completedValue)
+	{
+		m_getSemaphoreCounterValue(device, vk_semaphore, &m_completedValue);
+	}
+	return value <= m_completedValue;
+}
+
+/*************************************************************************
+* Function Argument 1: The logical device the semaphore was created on   *
+* Function Argument 2: The value signalled by the submit being waited on *
+*************************************************************************/
+void VulkanQueueTimeline::Wait(const VkDevice& device, uint64_t value)
+{
+	if (value <= m_completedValue)
+	{
+		return;
+	}
+
+	VkSemaphoreWaitInfoKHR waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &vk_semaphore;
+	waitInfo.pValues = &value;
+	VkResult waitResult = m_waitSemaphores(device, &waitInfo, UINT64_MAX);
+	if (waitResult != VK_SUCCESS)
+	{
+		__debugbreak();
+	}
+	m_completedValue = value;
+}
+
+void VulkanQueueTimeline::Cleanup(const VkDevice& device)
+{
+	if (vk_semaphore != VK_NULL_HANDLE)
+	{
+		vkDestroySemaphore(device, vk_semaphore, nullptr);
+		vk_semaphore = VK_NULL_HANDLE;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include "VulkanDevice.h"
+
+/********************************************************************
+* Holds a timeline semaphore that counts the work submitted to one  *
+* queue. Every submit signals the next value, so waiting for any	*
+* earlier submit, a frame or an upload, is waiting for its value.   *
+* Nothing has to be reset, unlike a fence per submit. Only created  *
+* if the device has timeline semaphores, callers fall back to		*
+* fences otherwise													*
+********************************************************************/
+class VulkanQueueTimeline
+{
+public:
+	//Constructor explicitly defined to give initial values to the member variables
+	VulkanQueueTimeline();
+
+	//Creates the semaphore at value 0 and loads the timeline functions, does nothing without timeline semaphores
+	void CreateQueueTimeline(const VulkanDeviceHandle& device);
+
+	//Returns the value the next submit to the queue has to signal, submits must signal their values in this order
+	uint64_t NextSignalValue();
+
+	//Returns true if the GPU has reached the value, without waiting
+	bool IsComplete(const VkDevice& device, uint64_t value);
+
+	//Blocks until the GPU has reached the value
+	void Wait(const VkDevice& device, uint64_t value);
+
+	void Cleanup(const VkDevice& device);
+
+	/* Member variable getters */
+	inline bool IsCreated() const { return vk_semaphore != VK_NULL_HANDLE; }
+
+	inline const VkSemaphore& GetVulkanSDKSemaphore() const { return vk_semaphore; }
+
+	inline uint64_t GetLastSignalValue() const { return m_lastSignalValue; }
+	/* End member variable getters */
+private:
+	VkSemaphore vk_semaphore;
+
+	//The timeline functions come from the extension, as the instance targets Vulkan 1.0
+	PFN_vkWaitSemaphoresKHR m_waitSemaphores;
+	PFN_vkGetSemaphoreCounterValueKHR m_getSemaphoreCounterValue;
+
+	//The value the last submit signals
+	uint64_t m_lastSignalValue;
+
+	//The highest value the GPU was seen to reach, so completed values are not queried again
+	uint64_t m_completedValue;
+};
@@ -1,7 +1,7 @@
 #include "VulkanSwapchain.h"
 
 VulkanSwapchainHandle::VulkanSwapchainHandle()
-	:vk_swapchain(), vk_images(), vk_extent(), vk_imageFormat()
+	:vk_swapchain(), vk_images(), vk_extent(), vk_imageFormat(), m_imageUsage{0}
 {
 
 }
@@ -18,8 +18,8 @@ VulkanSwapchainHandle::VulkanSwapchainHandle()
 void VulkanSwapchainHandle::CreateSwapchain(const VkSurfaceKHR& surface,
 	const VulkanDeviceHandle& device, const GlfwWindowHandle& window)
 {
-	//Retrieving the GPU's swaphcain support details
-	SwapchainSupportDetails swapchainSupport = device.GetSwapchainSupportDetails();
+	//Retrieving the GPU's swaphcain support details for this surface, the GPU was only chosen with the first window's
+	SwapchainSupportDetails swapchainSupport = device.QuerySurfaceSupportDetails(surface);
 
 	/* Choosing the best settings for the swapchain */
 	VkSurfaceFormatKHR format = ChooseSwapchainSurfaceFormat(swapchainSupport.formats);
@@ -49,7 +49,11 @@ void VulkanSwapchainHandle::CreateSwapchain(const VkSurfaceKHR& surface,
 	createInfo.imageColorSpace = format.colorSpace;
 	//This should be 1, unless it's a stereoscopic 3D application
 	createInfo.imageArrayLayers = 1;
-	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	//Copying the images out is only needed to capture frames, and blitting into them to show multiview rendering,
+	//so neither is required from the surface
+	m_imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (swapchainSupport.surfaceCapabilities.supportedUsageFlags &
+		(VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+	createInfo.imageUsage = m_imageUsage;
 
 	//Different settings should be chosen depending on if 
 	//all operations are excecuted on the same queue family or not
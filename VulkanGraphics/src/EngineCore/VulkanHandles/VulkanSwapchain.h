@@ -21,6 +21,10 @@ public:
 	//Used to destroy the swaphcain
 	void Cleanup(const VkDevice& device);
 
+	//Chooses the optimal surface format(color depth) for the swapchain. It only needs the device's support details,
+	//so the render pass and the pipelines can be created with it before the swapchain exists
+	static VkSurfaceFormatKHR ChooseSwapchainSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
+
 	/* Member variable getters */
 	inline const VkSwapchainKHR& GetVulkanSDKSwapchain() const { return vk_swapchain; }
 
@@ -29,12 +33,11 @@ public:
 	inline const VkExtent2D& GetSwapchainExtent() const { return vk_extent; }
 
 	inline const VkFormat& GetSwapchainImageFormat() const { return vk_imageFormat; }
+
+	inline VkImageUsageFlags GetSwapchainImageUsage() const { return m_imageUsage; }
 	/* Member variable getters end */
 
 private:
-	//Called by CreateSwapchain, to choose the optimal surface format(color depth) for the swapchain
-	VkSurfaceFormatKHR ChooseSwapchainSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
-
 	//Called by CreateSwapchain, to choose the optimal presentation mode
 	// (conditions for "swapping" images to the screen) for the swapchain
 	VkPresentModeKHR ChooseSwapchainPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
@@ -55,4 +58,7 @@ private:
 
 	//Holds the chosen image format 
 	VkFormat vk_imageFormat;
+
+	//How the swapchain images can be used, transfer source is added if the surface allows it so frames can be captured
+	VkImageUsageFlags m_imageUsage;
 };
\ No newline at end of file
@@ -7,9 +7,9 @@ GlfwWindowHandle::GlfwWindowHandle()
 
 }
 
-void GlfwWindowHandle::CreateGlfwWindow()
+void GlfwWindowHandle::CreateGlfwWindow(bool visible, uint32_t windowIndex)
 {
-	//Initializing glfw and checking if it was succesful
+	//Initializing glfw and checking if it was succesful, this returns right away once the first window has done it
 	int glfwSuccess = glfwInit();
 	if (!glfwSuccess)
 		__debugbreak();
@@ -19,13 +19,27 @@ void GlfwWindowHandle::CreateGlfwWindow()
 
 	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
 
+	//A hidden window still gives vulkan a surface to choose the GPU with
+	glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+
 	//Creating the window and checking if its creation was succesful
-	glfw_window = glfwCreateWindow(WINDOW_STANDARD_WIDTH, WINDOW_STANDARD_HEIGHT, "Vulkan", nullptr, nullptr);
+	std::string title = windowIndex == 0 ? "Vulkan" : "Vulkan (view " + std::to_string(windowIndex + 1) + ")";
+	glfw_window = glfwCreateWindow(WINDOW_STANDARD_WIDTH, WINDOW_STANDARD_HEIGHT, title.c_str(), nullptr, nullptr);
 	if (!glfw_window)
 	{
 		__debugbreak();
 	}
 
+	//Cascading the windows from the first one, so none of them hides another completely
+	if (windowIndex != 0)
+	{
+		int x = 0;
+		int y = 0;
+		glfwGetWindowPos(glfw_window, &x, &y);
+		int offset = static_cast<int>(windowIndex) * WINDOW_CASCADE_OFFSET;
+		glfwSetWindowPos(glfw_window, x + offset, y + offset);
+	}
+
 	//Using glfw's built in function to get required extension names and count
 	m_extensionNames = glfwGetRequiredInstanceExtensions(&m_extensionCount);
 }
@@ -48,8 +62,26 @@ bool GlfwWindowHandle::CheckIfWindowShouldClose() const
 	return glfwWindowShouldClose(glfw_window);
 }
 
+void GlfwWindowHandle::WaitWhileMinimized() const
+{
+	//A window closed while minimized stops waiting too, so the main loop can see it
+	while (glfwGetWindowAttrib(glfw_window, GLFW_ICONIFIED) && !glfwWindowShouldClose(glfw_window))
+	{
+		glfwWaitEvents();
+	}
+}
+
+bool GlfwWindowHandle::IsKeyPressed(int key) const
+{
+	return glfwGetKey(glfw_window, key) == GLFW_PRESS;
+}
+
 void GlfwWindowHandle::Cleanup()
 {
 	glfwDestroyWindow(glfw_window);
+}
+
+void GlfwWindowHandle::TerminateGlfw()
+{
 	glfwTerminate();
 }
\ No newline at end of file
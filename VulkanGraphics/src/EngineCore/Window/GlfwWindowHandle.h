@@ -5,12 +5,16 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 #include <vector>
+#include <string>
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
 
 #define WINDOW_STANDARD_WIDTH		720
 #define WINDOW_STANDARD_HEIGHT		560
 
+//Every window after the first is moved this many pixels right and down from the previous one
+#define WINDOW_CASCADE_OFFSET		48
+
 
 /***************************************************************
 * Holds the window opened with glfw and handles its operations *
@@ -21,12 +25,16 @@ public:
 	//Constructor, explicitly defined to initialize member variables
 	GlfwWindowHandle();
 
-	//Initializes glfw and creates the primary window
-	void CreateGlfwWindow();
+	//Initializes glfw if no window has yet and creates a window, hidden if nothing is going to be presented to it.
+	//Window 0 is the primary window, the others are cascaded from it
+	void CreateGlfwWindow(bool visible, uint32_t windowIndex);
 
-	//Terminates glfw after destroying the window
+	//Destroys the window, glfw stays initialized for the other windows
 	void Cleanup();
 
+	//Terminates glfw, once every window has been destroyed
+	static void TerminateGlfw();
+
 	/* Class getters */
 	const GLFWwindow* const GetGlfwWindow() const
 	{ 
@@ -54,6 +62,12 @@ public:
 	//Wrapper for the window should close glfw function
 	bool CheckIfWindowShouldClose() const;
 
+	//Blocks on glfw's events while the window is minimized, as its surface has no size to create a swapchain of
+	void WaitWhileMinimized() const;
+
+	//Wrapper for the get key glfw function, returns true if the key is currently held down
+	bool IsKeyPressed(int key) const;
+
 	//Creates the abstract window surface used for vulkan to interact with the window system
 	void CreateVulkanWindowSurface(const VkInstance& vk_instance, VkSurfaceKHR& vk_surface) const;
 
@@ -1,9 +1,130 @@
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 #include "EngineCore/VulkanCore.h"
 
-int main()
+int main(int argc, char** argv)
 {
+	ApplicationOptions options;
+	bool validArguments = true;
+	for (int i = 1; i < argc && validArguments; ++i)
+	{
+		if (std::strcmp(argv[i], PARTICLE_STRESS_ARGUMENT) == 0)
+		{
+			options.particleStress = true;
+		}
+		else if (std::strcmp(argv[i], LIGHT_COUNT_ARGUMENT) == 0 && i + 1 < argc)
+		{
+			options.lightCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+			validArguments = options.lightCount > 0 && options.lightCount <= CLUSTERED_LIGHTING_MAX_LIGHTS;
+		}
+		else if (std::strcmp(argv[i], LIGHT_BENCHMARK_ARGUMENT) == 0)
+		{
+			options.lightBenchmark = true;
+		}
+		else if (std::strcmp(argv[i], SHADER_HOT_RELOAD_ARGUMENT) == 0)
+		{
+			options.shaderHotReload = true;
+		}
+		else if (std::strcmp(argv[i], WINDOW_COUNT_ARGUMENT) == 0 && i + 1 < argc)
+		{
+			options.windowCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+			validArguments = options.windowCount > 0 && options.windowCount <= MAX_WINDOW_COUNT;
+		}
+		else if (std::strcmp(argv[i], MULTIVIEW_ARGUMENT) == 0 && i + 1 < argc)
+		{
+			options.multiviewCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+			validArguments = options.multiviewCount >= 2 && options.multiviewCount <= MULTIVIEW_MAX_VIEWS;
+		}
+		else if (std::strcmp(argv[i], DEFERRED_ARGUMENT) == 0)
+		{
+			options.deferred = true;
+		}
+		else if (std::strcmp(argv[i], SHADOWS_ARGUMENT) == 0)
+		{
+			options.shadows = true;
+		}
+		else if (std::strcmp(argv[i], HUD_ARGUMENT) == 0)
+		{
+			options.hud = true;
+		}
+		else if (std::strcmp(argv[i], HUD_STRESS_ARGUMENT) == 0)
+		{
+			//The stress scene is drawn over the HUD, so it needs the overlay too
+			options.hud = true;
+			options.hudStress = true;
+		}
+		else if (std::strcmp(argv[i], BATCH_ARGUMENT) == 0 && i + 1 < argc)
+		{
+			options.batchFrameCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+			validArguments = options.batchFrameCount > 0;
+		}
+		else if (std::strcmp(argv[i], BATCH_FORMAT_ARGUMENT) == 0 && i + 1 < argc)
+		{
+			const char* format = argv[++i];
+			if (std::strcmp(format, "png") == 0)
+			{
+				options.batchFormat = FrameWriterFormat::Png;
+			}
+			else if (std::strcmp(format, "raw") == 0)
+			{
+				options.batchFormat = FrameWriterFormat::Raw;
+			}
+			else if (std::strcmp(format, "y4m") == 0)
+			{
+				options.batchFormat = FrameWriterFormat::Y4m;
+			}
+			else
+			{
+				validArguments = false;
+			}
+		}
+		else if (std::strcmp(argv[i], BATCH_OUTPUT_ARGUMENT) == 0 && i + 1 < argc)
+		{
+			options.batchOutput = argv[++i];
+		}
+		else
+		{
+			validArguments = false;
+		}
+	}
+
+	if (!validArguments)
+	{
+		std::cout << "Usage: VulkanGraphics [" << PARTICLE_STRESS_ARGUMENT << "] [" << LIGHT_COUNT_ARGUMENT << " <count>] ["
+			<< LIGHT_BENCHMARK_ARGUMENT << "] [" << SHADER_HOT_RELOAD_ARGUMENT << "] ["
+			<< WINDOW_COUNT_ARGUMENT << " <count>] ["
+			<< MULTIVIEW_ARGUMENT << " <views>] [" << DEFERRED_ARGUMENT << "] [" << SHADOWS_ARGUMENT << "] [" << HUD_ARGUMENT << "] ["
+			<< HUD_STRESS_ARGUMENT << "] [" << BATCH_ARGUMENT << " <frames> [" << BATCH_FORMAT_ARGUMENT << " png|raw|y4m] [" << BATCH_OUTPUT_ARGUMENT
+			<< " <path>]]\n";
+		std::cout << "  " << PARTICLE_STRESS_ARGUMENT << "  keeps " << PARTICLE_STRESS_COUNT
+			<< " particles alive and prints their timings\n";
+		std::cout << "  " << LIGHT_COUNT_ARGUMENT << "  lights the mesh with up to " << CLUSTERED_LIGHTING_MAX_LIGHTS
+			<< " clustered point and spot lights\n";
+		std::cout << "  " << LIGHT_BENCHMARK_ARGUMENT << "  lights " << LIGHT_BENCHMARK_FIRST_COUNT << " to "
+			<< CLUSTERED_LIGHTING_MAX_LIGHTS << " lights in turn and prints the GPU time of each count\n";
+		std::cout << "  " << SHADER_HOT_RELOAD_ARGUMENT << "  recompiles saved shaders in " << SHADER_DIRECTORY
+			<< " and swaps in their rebuilt pipelines\n";
+		std::cout << "  " << WINDOW_COUNT_ARGUMENT << "  shows the scene in up to " << MAX_WINDOW_COUNT
+			<< " windows, presented together\n";
+		std::cout << "  " << MULTIVIEW_ARGUMENT << "  renders 2 to " << MULTIVIEW_MAX_VIEWS
+			<< " side by side cameras in one multiview pass, 2 is a stereo pair\n";
+		std::cout << "  " << DEFERRED_ARGUMENT << "  writes the mesh into a G-buffer and lights it in a second subpass\n";
+		std::cout << "  " << SHADOWS_ARGUMENT << "  shadows the mesh from the sun with " << SHADOW_CASCADE_COUNT
+			<< " cascaded shadow maps\n";
+		std::cout << "  " << HUD_ARGUMENT << "  draws frame statistics and a streamed texture over the scene with the batched sprite and"
+			<< " text overlay\n";
+		std::cout << "  " << HUD_STRESS_ARGUMENT << "  also draws " << HUD_STRESS_TEXT_LINES << " lines of text and "
+			<< HUD_STRESS_GLOW_SPRITES << " glowing sprites every frame and prints the overlay's timings\n";
+		std::cout << "  " << BATCH_ARGUMENT << "  renders the frames offscreen at " << BATCH_FRAME_WIDTH << 'x'
+			<< BATCH_FRAME_HEIGHT << " and " << BATCH_FRAME_RATE << " frames/s of scene time, writes them to disk"
+			<< " and prints the sustained throughput\n";
+		std::cout << "  " << BATCH_FORMAT_ARGUMENT << "  PNG sequence (default), raw pixels or a Y4M video\n";
+		std::cout << "  " << BATCH_OUTPUT_ARGUMENT << "  the directory for PNGs or the file for raw and Y4M\n";
+		return 1;
+	}
+
 	VulkanTriangle* app = new VulkanTriangle;
-	app->RunTriangle();
+	app->RunTriangle(options);
 	delete app;
-}
\ No newline at end of file
+}